@@ -170,6 +170,36 @@ std::uintmax_t file_size(std::string const& path,
   return static_cast<std::uintmax_t>(stat.st_size);
 }
 
+// NOLINTNEXTLINE(readability-identifier-naming)
+std::chrono::system_clock::time_point last_write_time(std::string const& path) {
+  std::error_code ec;
+  auto t = last_write_time(path, ec);
+  if (ec) {
+    std::string msg = __func__;
+    msg += ": getting modification time of file=";
+    msg += path;
+    ThrowSystemError(ec, msg);
+  }
+  return t;
+}
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+std::chrono::system_clock::time_point last_write_time(
+    std::string const& path, std::error_code& ec) noexcept {
+  os_stat_type stat;
+  ec.clear();
+#if _WIN32
+  int r = ::_stat(path.c_str(), &stat);
+#else
+  int r = ::stat(path.c_str(), &stat);
+#endif  // _WIN32
+  if (r != 0) {
+    ec.assign(errno, std::generic_category());
+    return (std::chrono::system_clock::time_point::min)();
+  }
+  return std::chrono::system_clock::from_time_t(stat.st_mtime);
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
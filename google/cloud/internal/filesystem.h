@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_FILESYSTEM_H
 
 #include "google/cloud/version.h"
+#include <chrono>
 #include <cinttypes>
 #include <system_error>
 
@@ -166,6 +167,11 @@ inline bool is_other(file_status s) noexcept {
 std::uintmax_t file_size(std::string const& path);
 std::uintmax_t file_size(std::string const& path, std::error_code& ec) noexcept;
 
+/// The time of the last modification of @p path, with one second resolution.
+std::chrono::system_clock::time_point last_write_time(std::string const& path);
+std::chrono::system_clock::time_point last_write_time(
+    std::string const& path, std::error_code& ec) noexcept;
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -318,6 +318,27 @@ TEST(FilesystemTest, FileSizeNotFoundDoesThrow) {
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 }
 
+TEST(FilesystemTest, LastWriteTime) {
+  auto file_name = CreateRandomFileName();
+  auto const before =
+      std::chrono::system_clock::now() - std::chrono::seconds(2);
+  std::ofstream(file_name).close();
+  std::error_code ec;
+  auto const actual = last_write_time(file_name, ec);
+  EXPECT_FALSE(static_cast<bool>(ec));
+  EXPECT_LE(before, actual);
+  EXPECT_GE(std::chrono::system_clock::now(), actual);
+  EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+TEST(FilesystemTest, LastWriteTimeNotFound) {
+  auto file_name = CreateRandomFileName();
+  std::error_code ec;
+  auto const actual = last_write_time(file_name, ec);
+  EXPECT_TRUE(static_cast<bool>(ec));
+  EXPECT_EQ((std::chrono::system_clock::time_point::min)(), actual);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -40,6 +40,11 @@ std::ostream& operator<<(std::ostream& os, Config const& config) {
             << "\n# Query Size: " << config.query_size
             << "\n# Use Only Stubs: " << config.use_only_stubs
             << "\n# Use Only Clients: " << config.use_only_clients
+            << "\n# Use Embedded Server: " << config.use_embedded_server
+            << "\n# Embedded Server Latency: "
+            << config.embedded_server_latency.count() << "us"
+            << "\n# Embedded Server Error Period: "
+            << config.embedded_server_error_period
             << "\n# Compiler: " << google::cloud::internal::CompilerId() << "-"
             << google::cloud::internal::CompilerVersion()
             << "\n# Build Flags: " << google::cloud::internal::compiler_flags()
@@ -119,6 +124,17 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
        [](Config& c, std::string const&) { c.use_only_stubs = true; }},
       {"--use-only-clients",
        [](Config& c, std::string const&) { c.use_only_clients = true; }},
+
+      {"--embedded-server-latency=",
+       [](Config& c, std::string const& v) {
+         c.embedded_server_latency = std::chrono::microseconds(std::stoi(v));
+       }},
+      {"--embedded-server-error-period=",
+       [](Config& c, std::string const& v) {
+         c.embedded_server_error_period = std::stoi(v);
+       }},
+      {"--embedded-server",
+       [](Config& c, std::string const&) { c.use_embedded_server = true; }},
   };
 
   auto invalid_argument = [](std::string msg) {
@@ -145,6 +161,12 @@ google::cloud::StatusOr<Config> ParseArgs(std::vector<std::string> args) {
     return invalid_argument("Missing value for --experiment flag");
   }
 
+  if (config.use_embedded_server) {
+    // The embedded server accepts any database name.
+    if (config.project_id.empty()) config.project_id = "embedded-project";
+    if (config.instance_id.empty()) config.instance_id = "embedded-instance";
+  }
+
   if (config.project_id.empty()) {
     return invalid_argument(
         "The project id is not set, provide a value in the --project flag,"
@@ -47,6 +47,12 @@ struct Config {
 
   bool use_only_clients = false;
   bool use_only_stubs = false;
+
+  // Run the benchmark against an in-process fake server, see
+  // `EmbeddedServer` for details.
+  bool use_embedded_server = false;
+  std::chrono::microseconds embedded_server_latency{0};
+  int embedded_server_error_period = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, Config const& config);
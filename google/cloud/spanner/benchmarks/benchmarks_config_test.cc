@@ -134,6 +134,20 @@ TEST(BenchmarkConfigTest, OnlyClients) {
   EXPECT_TRUE(config->use_only_clients);
 }
 
+TEST(BenchmarkConfigTest, EmbeddedServer) {
+  testing_util::ScopedEnvironment env("GOOGLE_CLOUD_PROJECT", {});
+  auto config = ParseArgs({"placeholder", "--embedded-server",
+                           "--embedded-server-latency=250",
+                           "--embedded-server-error-period=10"});
+  ASSERT_STATUS_OK(config);
+
+  EXPECT_TRUE(config->use_embedded_server);
+  EXPECT_EQ(250, config->embedded_server_latency.count());
+  EXPECT_EQ(10, config->embedded_server_error_period);
+  EXPECT_FALSE(config->project_id.empty());
+  EXPECT_FALSE(config->instance_id.empty());
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner_benchmarks
@@ -0,0 +1,530 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/embedded_server.h"
+#include "google/cloud/internal/random.h"
+#include <google/spanner/v1/spanner.grpc.pb.h>
+#include <grpcpp/grpcpp.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+/// The type of each column, for each table.
+using Schema =
+    std::map<std::string, std::map<std::string, spanner_proto::TypeCode>>;
+
+spanner_proto::TypeCode ParseTypeCode(std::string type) {
+  // Discard the length in types like `STRING(1024)`, the arrays (or any other
+  // unknown type) are returned as strings.
+  auto const pos = type.find('(');
+  if (pos != std::string::npos) type.resize(pos);
+  spanner_proto::TypeCode code;
+  if (!spanner_proto::TypeCode_Parse(type, &code)) return spanner_proto::STRING;
+  return code;
+}
+
+/// Add the columns in a `CREATE TABLE` statement to @p schema.
+void AddTable(Schema& schema, std::string const& statement) {
+  std::istringstream is(statement);
+  std::string create;
+  std::string table;
+  std::string name;
+  if (!(is >> create >> table >> name)) return;
+  if (create != "CREATE" || table != "TABLE") return;
+  name.resize(std::min(name.size(), name.find('(')));
+  auto const begin = statement.find('(');
+  auto const end = statement.rfind(')', statement.rfind("PRIMARY KEY"));
+  if (begin == std::string::npos || end == std::string::npos || end < begin) {
+    return;
+  }
+  auto& columns = schema[name];
+  std::istringstream definitions(statement.substr(begin + 1, end - begin - 1));
+  for (std::string d; std::getline(definitions, d, ',');) {
+    std::istringstream definition(d);
+    std::string column;
+    std::string type;
+    if (definition >> column >> type) columns[column] = ParseTypeCode(type);
+  }
+}
+
+/// A simple `SELECT` statement.
+struct SelectStatement {
+  std::string table;
+  std::vector<std::string> columns;
+  /// The parameter in a `WHERE Key = @param` predicate, empty if none.
+  std::string key_param;
+};
+
+/**
+ * Parse a simple `SELECT` statement.
+ *
+ * Only the `WHERE Key = @param` predicate is recognized, any other `WHERE`
+ * clause is ignored.
+ */
+bool ParseSelect(std::string const& sql, SelectStatement& select) {
+  std::istringstream is(sql);
+  std::string token;
+  if (!(is >> token) || token != "SELECT") return false;
+  std::string list;
+  while (is >> token && token != "FROM") list += token;
+  if (!(is >> select.table)) return false;
+  std::istringstream names(list);
+  for (std::string c; std::getline(names, c, ',');) {
+    if (!c.empty()) select.columns.push_back(std::move(c));
+  }
+  if (!(is >> token) || token != "WHERE") return true;
+  std::string predicate;
+  while (is >> token) predicate += token;
+  auto constexpr kKeyPredicate = "Key=@";
+  if (predicate.rfind(kKeyPredicate, 0) == 0) {
+    select.key_param = predicate.substr(std::strlen(kKeyPredicate));
+  }
+  return true;
+}
+
+/// The shape (and the values) of the rows returned by a query or read.
+struct ResultShape {
+  spanner_proto::StructType row_type;
+  std::vector<google::protobuf::Value> row;
+  // The `Key` column is set to `first_key` plus the row number, all other
+  // values are repeated.
+  int key_column = -1;
+  std::int64_t first_key = 0;
+  std::int64_t rows = 0;
+};
+
+/**
+ * Implement the portions of the `google.spanner.v1.Spanner` interface
+ * necessary for the benchmarks.
+ *
+ * This is neither a Mock (use `spanner_testing::MockSpannerStub` for that),
+ * nor a Fake implementation (use the Cloud Spanner Emulator for that), this is
+ * an implementation of the interface that returns synthetic results. It is
+ * suitable for the benchmarks, but for nothing else.
+ */
+class SpannerImpl final : public spanner_proto::Spanner::Service {
+ public:
+  explicit SpannerImpl(EmbeddedServerOptions options)
+      : options_(std::move(options)) {
+    for (auto const& statement : options_.ddl_statements) {
+      AddTable(schema_, statement);
+    }
+    // Prepare a list of random values to use at run-time. This is because we
+    // want the overhead of this implementation to be as small as possible.
+    // The values are also valid base64 strings, as long as their size is a
+    // multiple of 4, so they can be used for `BYTES` columns too.
+    auto generator = google::cloud::internal::MakeDefaultPRNG();
+    auto const size = (std::max)(4, options_.value_size / 4 * 4);
+    strings_.resize(16);
+    std::generate(strings_.begin(), strings_.end(), [&generator, size] {
+      return google::cloud::internal::Sample(
+          generator, size,
+          "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789");
+    });
+  }
+
+  grpc::Status CreateSession(grpc::ServerContext*,
+                             spanner_proto::CreateSessionRequest const* request,
+                             spanner_proto::Session* response) override {
+    ++create_session_count_;
+    if (StartRpc()) return Unavailable();
+    response->set_name(NewSessionName(request->database()));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status BatchCreateSessions(
+      grpc::ServerContext*,
+      spanner_proto::BatchCreateSessionsRequest const* request,
+      spanner_proto::BatchCreateSessionsResponse* response) override {
+    create_session_count_ += request->session_count();
+    if (StartRpc()) return Unavailable();
+    for (int i = 0; i != request->session_count(); ++i) {
+      response->add_session()->set_name(NewSessionName(request->database()));
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status GetSession(grpc::ServerContext*,
+                          spanner_proto::GetSessionRequest const* request,
+                          spanner_proto::Session* response) override {
+    if (StartRpc()) return Unavailable();
+    response->set_name(request->name());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status DeleteSession(grpc::ServerContext*,
+                             spanner_proto::DeleteSessionRequest const*,
+                             google::protobuf::Empty*) override {
+    StartRpc();  // never fail, the client does not retry this
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ExecuteSql(grpc::ServerContext*,
+                          spanner_proto::ExecuteSqlRequest const* request,
+                          spanner_proto::ResultSet* response) override {
+    ++execute_sql_count_;
+    if (StartRpc()) return Unavailable();
+    SetTransaction(request->transaction(), *response->mutable_metadata());
+    SelectStatement select;
+    if (!ParseSelect(request->sql(), select)) {
+      // Any other statement is treated as a single-row DML statement.
+      response->mutable_stats()->set_row_count_exact(1);
+      return grpc::Status::OK;
+    }
+    auto const shape = MakeShape(select, *request);
+    *response->mutable_metadata()->mutable_row_type() = shape.row_type;
+    for (std::int64_t r = 0; r != shape.rows; ++r) {
+      auto& row = *response->add_rows();
+      for (int c = 0; c != static_cast<int>(shape.row.size()); ++c) {
+        *row.add_values() = ValueAt(shape, r, c);
+      }
+    }
+    row_count_ += shape.rows;
+    return grpc::Status::OK;
+  }
+
+  grpc::Status ExecuteStreamingSql(
+      grpc::ServerContext*, spanner_proto::ExecuteSqlRequest const* request,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) override {
+    ++execute_sql_count_;
+    auto const fail = StartRpc();
+    SelectStatement select;
+    if (!ParseSelect(request->sql(), select)) {
+      if (fail) return Unavailable();
+      spanner_proto::PartialResultSet response;
+      SetTransaction(request->transaction(), *response.mutable_metadata());
+      response.mutable_stats()->set_row_count_exact(1);
+      writer->WriteLast(response, grpc::WriteOptions());
+      return grpc::Status::OK;
+    }
+    return WriteResults(MakeShape(select, *request), request->transaction(),
+                        request->resume_token(), fail, writer);
+  }
+
+  grpc::Status ExecuteBatchDml(
+      grpc::ServerContext*,
+      spanner_proto::ExecuteBatchDmlRequest const* request,
+      spanner_proto::ExecuteBatchDmlResponse* response) override {
+    ++execute_sql_count_;
+    if (StartRpc()) return Unavailable();
+    for (int i = 0; i != request->statements_size(); ++i) {
+      auto& result = *response->add_result_sets();
+      if (i == 0) {
+        SetTransaction(request->transaction(), *result.mutable_metadata());
+      }
+      result.mutable_stats()->set_row_count_exact(1);
+    }
+    return grpc::Status::OK;
+  }
+
+  grpc::Status StreamingRead(
+      grpc::ServerContext*, spanner_proto::ReadRequest const* request,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) override {
+    ++read_count_;
+    auto const fail = StartRpc();
+    auto const& key_set = request->key_set();
+    std::int64_t rows = options_.rows_per_query;
+    if (!key_set.all()) {
+      rows = key_set.keys_size() + key_set.ranges_size() * rows;
+    }
+    if (request->limit() > 0) rows = (std::min)(rows, request->limit());
+    std::vector<std::string> columns(request->columns().begin(),
+                                     request->columns().end());
+    return WriteResults(MakeShape(request->table(), columns, rows),
+                        request->transaction(), request->resume_token(), fail,
+                        writer);
+  }
+
+  grpc::Status BeginTransaction(
+      grpc::ServerContext*, spanner_proto::BeginTransactionRequest const*,
+      spanner_proto::Transaction* response) override {
+    if (StartRpc()) return Unavailable();
+    response->set_id(NewTransactionId());
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Commit(grpc::ServerContext*, spanner_proto::CommitRequest const*,
+                      spanner_proto::CommitResponse* response) override {
+    ++commit_count_;
+    if (StartRpc()) return Unavailable();
+    auto const now = std::chrono::system_clock::now().time_since_epoch();
+    auto const s = std::chrono::duration_cast<std::chrono::seconds>(now);
+    auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now);
+    auto& timestamp = *response->mutable_commit_timestamp();
+    timestamp.set_seconds(s.count());
+    timestamp.set_nanos(static_cast<std::int32_t>((ns - s).count()));
+    return grpc::Status::OK;
+  }
+
+  grpc::Status Rollback(grpc::ServerContext*,
+                        spanner_proto::RollbackRequest const*,
+                        google::protobuf::Empty*) override {
+    StartRpc();  // never fail, the client does not retry this
+    return grpc::Status::OK;
+  }
+
+  int create_session_count() const { return create_session_count_.load(); }
+  int execute_sql_count() const { return execute_sql_count_.load(); }
+  int read_count() const { return read_count_.load(); }
+  int commit_count() const { return commit_count_.load(); }
+  std::int64_t row_count() const { return row_count_.load(); }
+
+ private:
+  /// Simulate the latency of the RPC, returns true if the RPC should fail.
+  bool StartRpc() {
+    if (options_.latency.count() > 0) {
+      std::this_thread::sleep_for(options_.latency);
+    }
+    return options_.error_period > 0 &&
+           ++rpc_count_ % options_.error_period == 0;
+  }
+
+  static grpc::Status Unavailable() {
+    return grpc::Status(grpc::StatusCode::UNAVAILABLE, "injected error");
+  }
+
+  std::string NewSessionName(std::string const& database) {
+    return database + "/sessions/session-" + std::to_string(++session_id_);
+  }
+
+  std::string NewTransactionId() {
+    return "transaction-" + std::to_string(++transaction_id_);
+  }
+
+  /// Return the id of a new transaction if @p selector begins one.
+  void SetTransaction(spanner_proto::TransactionSelector const& selector,
+                      spanner_proto::ResultSetMetadata& metadata) {
+    if (!selector.has_begin()) return;
+    metadata.mutable_transaction()->set_id(NewTransactionId());
+  }
+
+  /// The shape of the results for @p select, a point lookup returns one row.
+  ResultShape MakeShape(SelectStatement const& select,
+                        spanner_proto::ExecuteSqlRequest const& request) const {
+    if (select.key_param.empty()) {
+      return MakeShape(select.table, select.columns, options_.rows_per_query);
+    }
+    auto shape = MakeShape(select.table, select.columns, 1);
+    auto const& params = request.params().fields();
+    auto const p = params.find(select.key_param);
+    if (p != params.end() && p->second.has_string_value()) {
+      shape.first_key =
+          std::strtoll(p->second.string_value().c_str(), nullptr, 10);
+    }
+    return shape;
+  }
+
+  ResultShape MakeShape(std::string const& table,
+                        std::vector<std::string> const& columns,
+                        std::int64_t rows) const {
+    ResultShape shape;
+    shape.rows = rows;
+    auto const t = schema_.find(table);
+    for (auto const& name : columns) {
+      auto code = spanner_proto::STRING;
+      if (t != schema_.end()) {
+        auto const c = t->second.find(name);
+        if (c != t->second.end()) code = c->second;
+      }
+      auto& field = *shape.row_type.add_fields();
+      field.set_name(name);
+      field.mutable_type()->set_code(code);
+      if (name == "Key" && code == spanner_proto::INT64) {
+        shape.key_column = static_cast<int>(shape.row.size());
+      }
+      shape.row.push_back(MakeValue(code, shape.row.size()));
+    }
+    return shape;
+  }
+
+  google::protobuf::Value MakeValue(spanner_proto::TypeCode code,
+                                    std::size_t column) const {
+    google::protobuf::Value v;
+    switch (code) {
+      case spanner_proto::BOOL:
+        v.set_bool_value(column % 2 == 0);
+        break;
+      case spanner_proto::INT64:
+        v.set_string_value(std::to_string(column * 1000 + 42));
+        break;
+      case spanner_proto::FLOAT64:
+        v.set_number_value(static_cast<double>(column) + 0.5);
+        break;
+      case spanner_proto::TIMESTAMP:
+        v.set_string_value("2020-02-29T12:34:56.789012345Z");
+        break;
+      case spanner_proto::DATE:
+        v.set_string_value("2020-02-29");
+        break;
+      case spanner_proto::NUMERIC:
+        v.set_string_value("12345.6789");
+        break;
+      default:
+        v.set_string_value(strings_[column % strings_.size()]);
+        break;
+    }
+    return v;
+  }
+
+  static google::protobuf::Value ValueAt(ResultShape const& shape,
+                                       std::int64_t row, int column) {
+    if (column != shape.key_column) return shape.row[column];
+    google::protobuf::Value v;
+    v.set_string_value(std::to_string(shape.first_key + row));
+    return v;
+  }
+
+  /**
+   * Stream the rows described by @p shape.
+   *
+   * The resume token of each message is its position in the stream, which is
+   * used to skip the messages already received by the client. Only the rows
+   * completed by the messages actually written are counted in `row_count()`.
+   */
+  grpc::Status WriteResults(
+      ResultShape const& shape,
+      spanner_proto::TransactionSelector const& selector,
+      std::string const& resume_token, bool fail,
+      grpc::ServerWriter<spanner_proto::PartialResultSet>* writer) {
+    std::int64_t const skip =
+        resume_token.empty() ? 0 : std::stoll(resume_token);
+    auto const columns = static_cast<std::int64_t>(shape.row.size());
+    auto const total = shape.rows * columns;
+    auto const per_message = (std::max)(1, options_.values_per_message);
+    auto const message_count = (total + per_message - 1) / per_message;
+    std::int64_t const fail_at = fail ? message_count / 2 : -1;
+
+    spanner_proto::PartialResultSet response;
+    *response.mutable_metadata()->mutable_row_type() = shape.row_type;
+    SetTransaction(selector, *response.mutable_metadata());
+    std::int64_t index = 0;
+    std::int64_t rows_done = 0;
+    for (std::int64_t v = 0; v != total; ++v) {
+      auto const column = static_cast<int>(v % columns);
+      auto& value = *response.add_values();
+      value = ValueAt(shape, v / columns, column);
+      auto const last = v + 1 == total;
+      if (!last && response.values_size() < per_message) continue;
+
+      // Split the last value in two chunks, the second chunk starts the next
+      // message.
+      google::protobuf::Value chunk;
+      auto const code = shape.row_type.fields(column).type().code();
+      if (!last && options_.chunk_values &&
+          (code == spanner_proto::STRING || code == spanner_proto::BYTES)) {
+        auto const& s = value.string_value();
+        chunk.set_string_value(s.substr(s.size() / 2));
+        value.set_string_value(s.substr(0, s.size() / 2));
+        response.set_chunked_value(true);
+      }
+      if (index == fail_at) return Unavailable();
+      response.set_resume_token(std::to_string(++index));
+      auto const rows_before = rows_done;
+      rows_done = (chunk.has_string_value() ? v : v + 1) / columns;
+      if (index > skip) {
+        writer->Write(response);
+        row_count_ += rows_done - rows_before;
+      }
+      response.Clear();
+      if (chunk.has_string_value()) *response.add_values() = std::move(chunk);
+    }
+    if (fail) return Unavailable();
+    if (total == 0) writer->Write(response);
+    return grpc::Status::OK;
+  }
+
+  EmbeddedServerOptions const options_;
+  Schema schema_;
+  std::vector<std::string> strings_;
+  std::atomic<std::int64_t> rpc_count_{0};
+  std::atomic<std::int64_t> session_id_{0};
+  std::atomic<std::int64_t> transaction_id_{0};
+  std::atomic<int> create_session_count_{0};
+  std::atomic<int> execute_sql_count_{0};
+  std::atomic<int> read_count_{0};
+  std::atomic<int> commit_count_{0};
+  std::atomic<std::int64_t> row_count_{0};
+};
+
+/// The implementation of EmbeddedServer.
+class DefaultEmbeddedServer : public EmbeddedServer {
+ public:
+  explicit DefaultEmbeddedServer(EmbeddedServerOptions options)
+      : spanner_service_(std::move(options)) {
+    int port;
+    std::string server_address("[::]:0");
+    builder_.AddListeningPort(server_address, grpc::InsecureServerCredentials(),
+                              &port);
+    builder_.RegisterService(&spanner_service_);
+    server_ = builder_.BuildAndStart();
+    address_ = "localhost:" + std::to_string(port);
+  }
+
+  std::string address() const override { return address_; }
+  void Shutdown() override { server_->Shutdown(); }
+  void Wait() override { server_->Wait(); }
+
+  int create_session_count() const override {
+    return spanner_service_.create_session_count();
+  }
+  int execute_sql_count() const override {
+    return spanner_service_.execute_sql_count();
+  }
+  int read_count() const override { return spanner_service_.read_count(); }
+  int commit_count() const override { return spanner_service_.commit_count(); }
+  std::int64_t row_count() const override {
+    return spanner_service_.row_count();
+  }
+
+ private:
+  SpannerImpl spanner_service_;
+  grpc::ServerBuilder builder_;
+  std::unique_ptr<grpc::Server> server_;
+  std::string address_;
+};
+
+}  // namespace
+
+std::unique_ptr<EmbeddedServer> CreateEmbeddedServer(
+    EmbeddedServerOptions options) {
+  return std::unique_ptr<EmbeddedServer>(
+      new DefaultEmbeddedServer(std::move(options)));
+}
+
+EmbeddedServerOptions MakeEmbeddedServerOptions(
+    Config const& config, std::vector<std::string> ddl_statements) {
+  EmbeddedServerOptions options;
+  options.ddl_statements = std::move(ddl_statements);
+  options.rows_per_query = config.query_size;
+  options.latency = config.embedded_server_latency;
+  options.error_period = config.embedded_server_error_period;
+  return options;
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
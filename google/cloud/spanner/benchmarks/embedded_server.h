@@ -0,0 +1,108 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_EMBEDDED_SERVER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_EMBEDDED_SERVER_H
+
+#include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/version.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+
+/// Configure the results and the failures of the embedded server.
+struct EmbeddedServerOptions {
+  /**
+   * The `CREATE TABLE` statements for the tables used in the benchmarks.
+   *
+   * The server only uses them to find the type of each column. Columns in
+   * unknown tables are returned as `STRING`.
+   */
+  std::vector<std::string> ddl_statements;
+
+  /**
+   * The number of rows returned by each query, and by each key range read.
+   *
+   * Queries with a `WHERE Key = @param` predicate return a single row, with
+   * the requested key.
+   */
+  std::int64_t rows_per_query = 1000;
+
+  /// The maximum number of values in each `PartialResultSet`.
+  int values_per_message = 1000;
+
+  /// If true, string values at the end of a message are split in two chunks.
+  bool chunk_values = false;
+
+  /// The size of the `STRING` and `BYTES` values.
+  int value_size = 1024;
+
+  /// The delay before the server handles each RPC.
+  std::chrono::microseconds latency = std::chrono::microseconds(0);
+
+  /**
+   * If positive, every n-th RPC fails with `UNAVAILABLE`.
+   *
+   * Streaming RPCs fail after returning half of their results, so the client
+   * must resume them.
+   */
+  int error_period = 0;
+};
+
+/**
+ * An abstract class to run and stop the embedded Spanner server.
+ *
+ * Sometimes it is interesting to run performance benchmarks against an
+ * embedded server, as this eliminates the network and the service from the
+ * measurements, and isolates the costs in the client library. This class is
+ * used to run (using Wait()) and stop (using Shutdown()) such a server,
+ * without exposing the implementation details to the application.
+ */
+class EmbeddedServer {
+ public:
+  virtual ~EmbeddedServer() = default;
+
+  virtual std::string address() const = 0;
+  virtual void Shutdown() = 0;
+  virtual void Wait() = 0;
+
+  virtual int create_session_count() const = 0;
+  virtual int execute_sql_count() const = 0;
+  virtual int read_count() const = 0;
+  virtual int commit_count() const = 0;
+  /// The number of rows sent to the clients, including partial streams.
+  virtual std::int64_t row_count() const = 0;
+};
+
+/// Create an embedded server.
+std::unique_ptr<EmbeddedServer> CreateEmbeddedServer(
+    EmbeddedServerOptions options = {});
+
+/// The embedded server options for the tables in @p ddl_statements.
+EmbeddedServerOptions MakeEmbeddedServerOptions(
+    Config const& config, std::vector<std::string> ddl_statements);
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_BENCHMARKS_EMBEDDED_SERVER_H
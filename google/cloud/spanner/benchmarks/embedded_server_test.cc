@@ -0,0 +1,174 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/benchmarks/embedded_server.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <tuple>
+
+namespace google {
+namespace cloud {
+namespace spanner_benchmarks {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+
+auto constexpr kTable = R"sql(CREATE TABLE KeyValue (
+                                Key   INT64 NOT NULL,
+                                Data  STRING(1024),
+                             ) PRIMARY KEY (Key))sql";
+
+spanner::Client MakeClient(EmbeddedServer const& server) {
+  auto options = spanner::ConnectionOptions(grpc::InsecureChannelCredentials())
+                     .set_endpoint(server.address());
+  return spanner::Client(spanner::MakeConnection(
+      spanner::Database("test-project", "test-instance", "test-database"),
+      options));
+}
+
+EmbeddedServerOptions TestOptions() {
+  EmbeddedServerOptions options;
+  options.ddl_statements = {kTable};
+  options.rows_per_query = 100;
+  options.values_per_message = 7;
+  options.chunk_values = true;
+  options.value_size = 64;
+  return options;
+}
+
+using RowType = std::tuple<std::int64_t, std::string>;
+
+TEST(EmbeddedServer, WaitAndShutdown) {
+  auto server = CreateEmbeddedServer();
+  EXPECT_FALSE(server->address().empty());
+
+  std::thread wait_thread([&server]() { server->Wait(); });
+  EXPECT_TRUE(wait_thread.joinable());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_TRUE(wait_thread.joinable());
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(EmbeddedServer, ExecuteQuery) {
+  auto server = CreateEmbeddedServer(TestOptions());
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  auto client = MakeClient(*server);
+  auto rows = client.ExecuteQuery(
+      spanner::SqlStatement("SELECT Key, Data FROM KeyValue"));
+  std::int64_t expected_key = 0;
+  for (auto& row : spanner::StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    EXPECT_EQ(expected_key++, std::get<0>(*row));
+    EXPECT_EQ(64, std::get<1>(*row).size());
+  }
+  EXPECT_EQ(100, expected_key);
+  EXPECT_EQ(1, server->execute_sql_count());
+  EXPECT_EQ(100, server->row_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(EmbeddedServer, ExecuteQueryPointLookup) {
+  auto server = CreateEmbeddedServer(TestOptions());
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  auto client = MakeClient(*server);
+  auto rows = client.ExecuteQuery(
+      spanner::SqlStatement("SELECT Key, Data FROM KeyValue WHERE Key = @key",
+                            {{"key", spanner::Value(std::int64_t{1234})}}));
+  int count = 0;
+  for (auto& row : spanner::StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    EXPECT_EQ(1234, std::get<0>(*row));
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(1, server->row_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(EmbeddedServer, Read) {
+  auto server = CreateEmbeddedServer(TestOptions());
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  auto client = MakeClient(*server);
+  auto rows =
+      client.Read("KeyValue", spanner::KeySet().AddKey(spanner::MakeKey(1)),
+                  {"Key", "Data"});
+  int count = 0;
+  for (auto& row : spanner::StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    ++count;
+  }
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(1, server->read_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(EmbeddedServer, Commit) {
+  auto server = CreateEmbeddedServer(TestOptions());
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  auto client = MakeClient(*server);
+  auto commit = client.Commit(spanner::Mutations{
+      spanner::MakeInsertOrUpdateMutation("KeyValue", {"Key", "Data"},
+                                          std::int64_t{1}, "value")});
+  EXPECT_STATUS_OK(commit);
+  EXPECT_EQ(1, server->commit_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+TEST(EmbeddedServer, InjectedErrorsAreResumed) {
+  auto options = TestOptions();
+  // Creating the sessions succeeds, the query fails half-way through.
+  options.error_period = 2;
+  auto server = CreateEmbeddedServer(options);
+  std::thread wait_thread([&server]() { server->Wait(); });
+
+  auto client = MakeClient(*server);
+  auto rows = client.ExecuteQuery(
+      spanner::SqlStatement("SELECT Key, Data FROM KeyValue"));
+  std::int64_t expected_key = 0;
+  for (auto& row : spanner::StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    EXPECT_EQ(expected_key++, std::get<0>(*row));
+  }
+  EXPECT_EQ(100, expected_key);
+  EXPECT_EQ(2, server->execute_sql_count());
+  // The resumed stream only sends the rows not received by the client.
+  EXPECT_EQ(100, server->row_count());
+
+  server->Shutdown();
+  wait_thread.join();
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner_benchmarks
+}  // namespace cloud
+}  // namespace google
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/benchmarks/embedded_server.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/database_admin_client.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
@@ -21,6 +22,7 @@
 #include "google/cloud/grpc_error_delegate.h"
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/internal/random.h"
+#include "google/cloud/internal/setenv.h"
 #include "google/cloud/testing_util/timer.h"
 #include "absl/memory/memory.h"
 #include "absl/time/civil_time.h"
@@ -174,6 +176,31 @@ int main(int argc, char* argv[]) {
     return statements;
   }();
 
+  std::cout << "ClientCount,ThreadCount,UsingStub"
+            << ",RowCount,ElapsedTime,CpuTime,StatusCode\n"
+            << std::flush;
+
+  if (config.use_embedded_server) {
+    auto server = google::cloud::spanner_benchmarks::CreateEmbeddedServer(
+        google::cloud::spanner_benchmarks::MakeEmbeddedServerOptions(
+            config, additional_statements));
+    std::thread wait_thread([&server] { server->Wait(); });
+    // The client library connects to the emulator (here, the embedded server)
+    // when this variable is set.
+    google::cloud::internal::SetEnv("SPANNER_EMULATOR_HOST",
+                                    server->address());
+
+    // The embedded server synthesizes the rows, there is no need to SetUp()
+    // the database.
+    auto run_status = e->second(generator)->Run(config, database);
+    std::cout << "# Experiment finished, embedded server rows: "
+              << server->row_count()
+              << ", commits: " << server->commit_count() << "\n";
+    server->Shutdown();
+    wait_thread.join();
+    return run_status.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   std::cout << "# Waiting for database creation to complete " << std::flush;
   google::cloud::StatusOr<google::spanner::admin::database::v1::Database> db;
   int constexpr kMaxCreateDatabaseRetries = 3;
@@ -204,10 +231,6 @@ int main(int argc, char* argv[]) {
     }
   }
 
-  std::cout << "ClientCount,ThreadCount,UsingStub"
-            << ",RowCount,ElapsedTime,CpuTime,StatusCode\n"
-            << std::flush;
-
   int exit_status = EXIT_SUCCESS;
 
   auto experiment = e->second(generator);
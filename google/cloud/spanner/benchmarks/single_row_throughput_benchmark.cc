@@ -13,12 +13,14 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/benchmarks/benchmarks_config.h"
+#include "google/cloud/spanner/benchmarks/embedded_server.h"
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/database_admin_client.h"
 #include "google/cloud/spanner/testing/pick_random_instance.h"
 #include "google/cloud/spanner/testing/random_database_name.h"
 #include "google/cloud/internal/getenv.h"
 #include "google/cloud/internal/random.h"
+#include "google/cloud/internal/setenv.h"
 #include <algorithm>
 #include <future>
 #include <random>
@@ -51,6 +53,18 @@ class Experiment {
 
 std::map<std::string, std::shared_ptr<Experiment>> AvailableExperiments();
 
+SampleSink MakeCoutSink() {
+  auto cout_mu = std::make_shared<std::mutex>();
+  return [cout_mu](std::vector<SingleRowThroughputSample> const& samples) {
+    std::unique_lock<std::mutex> lk(*cout_mu);
+    for (auto const& s : samples) {
+      std::cout << s.client_count << ',' << s.thread_count << ','
+                << s.event_count << ',' << s.elapsed.count() << '\n'
+                << std::flush;
+    }
+  };
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -98,6 +112,34 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  auto constexpr kCreateTableStatement = R"sql(CREATE TABLE KeyValue (
+                                Key   INT64 NOT NULL,
+                                Data  STRING(1024),
+                             ) PRIMARY KEY (Key))sql";
+
+  if (config.use_embedded_server) {
+    auto server = google::cloud::spanner_benchmarks::CreateEmbeddedServer(
+        google::cloud::spanner_benchmarks::MakeEmbeddedServerOptions(
+            config, {kCreateTableStatement}));
+    std::thread wait_thread([&server] { server->Wait(); });
+    // The client library connects to the emulator (here, the embedded server)
+    // when this variable is set.
+    google::cloud::internal::SetEnv("SPANNER_EMULATOR_HOST",
+                                    server->address());
+
+    std::cout << "ChannelCount,ThreadCount,EventCount,ElapsedTime\n"
+              << std::flush;
+    // The embedded server synthesizes the rows, there is no need to SetUp()
+    // the database.
+    e->second->Run(config, database, MakeCoutSink());
+    std::cout << "# Experiment finished, embedded server rows: "
+              << server->row_count()
+              << ", commits: " << server->commit_count() << "\n";
+    server->Shutdown();
+    wait_thread.join();
+    return 0;
+  }
+
   google::cloud::spanner::DatabaseAdminClient admin_client;
 
   std::cout << "# Waiting for database creation to complete " << std::flush;
@@ -105,10 +147,7 @@ int main(int argc, char* argv[]) {
   int constexpr kMaxCreateDatabaseRetries = 3;
   for (int retry = 0; retry <= kMaxCreateDatabaseRetries; ++retry) {
     auto create_future =
-        admin_client.CreateDatabase(database, {R"sql(CREATE TABLE KeyValue (
-                                Key   INT64 NOT NULL,
-                                Data  STRING(1024),
-                             ) PRIMARY KEY (Key))sql"});
+        admin_client.CreateDatabase(database, {kCreateTableStatement});
     for (;;) {
       auto status = create_future.wait_for(std::chrono::seconds(1));
       if (status == std::future_status::ready) break;
@@ -136,23 +175,11 @@ int main(int argc, char* argv[]) {
   std::cout << "ChannelCount,ThreadCount,EventCount,ElapsedTime\n"
             << std::flush;
 
-  std::mutex cout_mu;
-  auto cout_sink =
-      [&cout_mu](
-          std::vector<SingleRowThroughputSample> const& samples) mutable {
-        std::unique_lock<std::mutex> lk(cout_mu);
-        for (auto const& s : samples) {
-          std::cout << s.client_count << ',' << s.thread_count << ','
-                    << s.event_count << ',' << s.elapsed.count() << '\n'
-                    << std::flush;
-        }
-      };
-
   auto experiment = e->second;
   if (database_created) {
     experiment->SetUp(config, database);
   }
-  experiment->Run(config, database, cout_sink);
+  experiment->Run(config, database, MakeCoutSink());
 
   if (!user_specified_database) {
     auto drop = admin_client.DropDatabase(database);
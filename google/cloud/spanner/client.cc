@@ -14,6 +14,7 @@
 
 #include "google/cloud/spanner/client.h"
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/partition_executor.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/internal/status_utils.h"
 #include "google/cloud/spanner/retry_policy.h"
@@ -152,6 +153,56 @@ StatusOr<std::vector<QueryPartition>> Client::PartitionQuery(
       {std::move(transaction), std::move(statement), partition_options});
 }
 
+Status Client::ExecutePartitions(
+    std::vector<QueryPartition> const& partitions,
+    std::function<Status(Row)> const& callback,
+    ExecutePartitionsOptions const& options,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy) {
+  // Resolve the query options once, the workers only use the connection.
+  auto const query_options = OverlayQueryOptions(options.query_options);
+  auto conn = conn_;
+  return internal::ExecutePartitions(
+      partitions.size(),
+      [&partitions, &query_options, conn](std::size_t i) {
+        auto params = internal::MakeSqlParams(partitions[i]);
+        params.query_options = query_options;
+        return conn->ExecuteQuery(std::move(params));
+      },
+      callback, options, *retry_policy, *backoff_policy);
+}
+
+Status Client::ExecutePartitions(
+    std::vector<ReadPartition> const& partitions,
+    std::function<Status(Row)> const& callback,
+    ExecutePartitionsOptions const& options,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy) {
+  auto conn = conn_;
+  return internal::ExecutePartitions(
+      partitions.size(),
+      [&partitions, conn](std::size_t i) {
+        return conn->Read(internal::MakeReadParams(partitions[i]));
+      },
+      callback, options, *retry_policy, *backoff_policy);
+}
+
+Status Client::ExecutePartitions(std::vector<QueryPartition> const& partitions,
+                                 std::function<Status(Row)> const& callback,
+                                 ExecutePartitionsOptions const& options) {
+  return ExecutePartitions(partitions, callback, options,
+                           internal::DefaultConnectionRetryPolicy(),
+                           internal::DefaultConnectionBackoffPolicy());
+}
+
+Status Client::ExecutePartitions(std::vector<ReadPartition> const& partitions,
+                                 std::function<Status(Row)> const& callback,
+                                 ExecutePartitionsOptions const& options) {
+  return ExecutePartitions(partitions, callback, options,
+                           internal::DefaultConnectionRetryPolicy(),
+                           internal::DefaultConnectionBackoffPolicy());
+}
+
 StatusOr<DmlResult> Client::ExecuteDml(Transaction transaction,
                                        SqlStatement statement,
                                        QueryOptions const& opts) {
@@ -292,6 +343,66 @@ StatusOr<PartitionedDmlResult> Client::ExecutePartitionedDml(
   return conn_->ExecutePartitionedDml({std::move(statement)});
 }
 
+future<AsyncRowStream> Client::AsyncRead(std::string table, KeySet keys,
+                                         std::vector<std::string> columns,
+                                         ReadOptions read_options) {
+  return conn_->AsyncRead(
+      {internal::MakeSingleUseTransaction(Transaction::ReadOnlyOptions()),
+       std::move(table),
+       std::move(keys),
+       std::move(columns),
+       std::move(read_options),
+       {}});
+}
+
+future<AsyncRowStream> Client::AsyncRead(Transaction transaction,
+                                         std::string table, KeySet keys,
+                                         std::vector<std::string> columns,
+                                         ReadOptions read_options) {
+  return conn_->AsyncRead({std::move(transaction),
+                           std::move(table),
+                           std::move(keys),
+                           std::move(columns),
+                           std::move(read_options),
+                           {}});
+}
+
+future<AsyncRowStream> Client::AsyncExecuteQuery(SqlStatement statement,
+                                                 QueryOptions const& opts) {
+  return conn_->AsyncExecuteQuery(
+      {internal::MakeSingleUseTransaction(Transaction::ReadOnlyOptions()),
+       std::move(statement),
+       OverlayQueryOptions(opts),
+       {}});
+}
+
+future<AsyncRowStream> Client::AsyncExecuteQuery(Transaction transaction,
+                                                 SqlStatement statement,
+                                                 QueryOptions const& opts) {
+  return conn_->AsyncExecuteQuery({std::move(transaction),
+                                   std::move(statement),
+                                   OverlayQueryOptions(opts),
+                                   {}});
+}
+
+future<StatusOr<DmlResult>> Client::AsyncExecuteDml(Transaction transaction,
+                                                    SqlStatement statement,
+                                                    QueryOptions const& opts) {
+  return conn_->AsyncExecuteDml({std::move(transaction),
+                                 std::move(statement),
+                                 OverlayQueryOptions(opts),
+                                 {}});
+}
+
+future<StatusOr<CommitResult>> Client::AsyncCommit(Transaction transaction,
+                                                   Mutations mutations) {
+  return conn_->AsyncCommit({std::move(transaction), std::move(mutations)});
+}
+
+future<Status> Client::AsyncRollback(Transaction transaction) {
+  return conn_->AsyncRollback({std::move(transaction)});
+}
+
 // Returns a QueryOptions struct that has each field set according to the
 // hierarchy that options specified as to the function call (i.e., `preferred`)
 // are preferred, followed by options set at the Client level, followed by an
@@ -315,6 +426,13 @@ QueryOptions Client::OverlayQueryOptions(QueryOptions const& preferred) {
     opts.set_optimizer_version(*kOptimizerVersionEnvValue);
   }
 
+  // Choose the `prefetch_depth` option.
+  if (preferred.prefetch_depth().has_value()) {
+    opts.set_prefetch_depth(preferred.prefetch_depth());
+  } else if (fallback.prefetch_depth().has_value()) {
+    opts.set_prefetch_depth(fallback.prefetch_depth());
+  }
+
   return opts;
 }
 
@@ -338,9 +456,14 @@ std::shared_ptr<Connection> MakeConnection(
     stubs.push_back(
         internal::CreateDefaultSpannerStub(db, connection_options, channel_id));
   }
+  auto stub_factory = [db, connection_options](int channel_id) {
+    return internal::CreateDefaultSpannerStub(db, connection_options,
+                                              channel_id);
+  };
   return internal::MakeConnection(
       db, std::move(stubs), connection_options, std::move(session_pool_options),
-      std::move(retry_policy), std::move(backoff_policy));
+      std::move(retry_policy), std::move(backoff_policy),
+      std::move(stub_factory));
 }
 
 }  // namespace SPANNER_CLIENT_NS
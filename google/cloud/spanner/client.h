@@ -21,6 +21,7 @@
 #include "google/cloud/spanner/connection.h"
 #include "google/cloud/spanner/connection_options.h"
 #include "google/cloud/spanner/database.h"
+#include "google/cloud/spanner/execute_partitions_options.h"
 #include "google/cloud/spanner/keys.h"
 #include "google/cloud/spanner/mutations.h"
 #include "google/cloud/spanner/partition_options.h"
@@ -395,6 +396,87 @@ class Client {
       Transaction transaction, SqlStatement statement,
       PartitionOptions const& partition_options = PartitionOptions{});
 
+  //@{
+  /**
+   * Executes @p partitions concurrently, passing every row to @p callback.
+   *
+   * This runs up to `options.max_parallelism` partitions at a time, each one
+   * from its own thread, spreading the requests over the channels of the
+   * `Connection`. The rows are returned in no particular order, except that
+   * rows from the same partition keep their relative order.
+   *
+   * @p callback is always called from the calling thread, so it needs no
+   * synchronization. Up to `options.max_buffered_rows` rows are buffered
+   * while @p callback runs; once the buffer is full, reading from the
+   * partitions is suspended until @p callback catches up.
+   *
+   * A partition whose execution fails with a transient error before
+   * returning any row is executed again, as allowed by @p retry_policy and
+   * @p backoff_policy. A partition cannot be restarted once some of its rows
+   * were delivered (though the underlying stream is still resumed as usual).
+   * On any other error, or if @p callback returns a non-OK status, the
+   * remaining partitions are cancelled and the error is returned.
+   *
+   * The partitions can be created by `PartitionQuery` (or `PartitionRead`) in
+   * a different process, serialized with `SerializeQueryPartition` (or
+   * `SerializeReadPartition`), and executed by a worker process after
+   * deserializing them.
+   *
+   * @param partitions the partitions to execute.
+   * @param callback called with each row, returning a non-OK status stops
+   *     the execution.
+   * @param options controls the parallelism and buffering of the execution,
+   *     and the `QueryOptions` of each query.
+   * @param retry_policy controls how many times (or for how long) each
+   *     partition is executed again after a transient failure.
+   * @param backoff_policy controls how long to wait before executing a
+   *     partition again.
+   *
+   * @return the first error encountered, or OK once all the rows of all the
+   *     partitions were passed to @p callback.
+   */
+  Status ExecutePartitions(std::vector<QueryPartition> const& partitions,
+                           std::function<Status(Row)> const& callback,
+                           ExecutePartitionsOptions const& options,
+                           std::unique_ptr<RetryPolicy> retry_policy,
+                           std::unique_ptr<BackoffPolicy> backoff_policy);
+
+  /**
+   * Executes the @p partitions of a read concurrently, passing every row to
+   * @p callback.
+   *
+   * See the `QueryPartition` overload for details, `options.query_options` is
+   * ignored.
+   */
+  Status ExecutePartitions(std::vector<ReadPartition> const& partitions,
+                           std::function<Status(Row)> const& callback,
+                           ExecutePartitionsOptions const& options,
+                           std::unique_ptr<RetryPolicy> retry_policy,
+                           std::unique_ptr<BackoffPolicy> backoff_policy);
+
+  /**
+   * Executes @p partitions concurrently, passing every row to @p callback.
+   *
+   * Same as above, but uses the default retry and backoff policies.
+   *
+   * @par Example
+   * @snippet samples.cc execute-partitions
+   */
+  Status ExecutePartitions(std::vector<QueryPartition> const& partitions,
+                           std::function<Status(Row)> const& callback,
+                           ExecutePartitionsOptions const& options = {});
+
+  /**
+   * Executes the @p partitions of a read concurrently, passing every row to
+   * @p callback.
+   *
+   * Same as above, but uses the default retry and backoff policies.
+   */
+  Status ExecutePartitions(std::vector<ReadPartition> const& partitions,
+                           std::function<Status(Row)> const& callback,
+                           ExecutePartitionsOptions const& options = {});
+  //@}
+
   /**
    * Executes a SQL DML statement.
    *
@@ -622,6 +704,76 @@ class Client {
    */
   StatusOr<PartitionedDmlResult> ExecutePartitionedDml(SqlStatement statement);
 
+  //@{
+  /**
+   * Asynchronously reads rows from the database, see `Read()`.
+   *
+   * The operation runs on the `CompletionQueue` of the connection's background
+   * threads, and does not block the calling thread waiting for a `Session`.
+   * The returned future is satisfied once the first response arrives, the
+   * rows are then retrieved with `AsyncRowStream::Next()`.
+   *
+   * Operations in the same read-write transaction may be started without
+   * waiting for the previous ones, they are sent to the service in the order
+   * required by the transaction.
+   */
+  future<AsyncRowStream> AsyncRead(std::string table, KeySet keys,
+                                   std::vector<std::string> columns,
+                                   ReadOptions read_options = {});
+
+  /**
+   * @copydoc AsyncRead
+   *
+   * @param transaction Execute this read as part of an existing transaction.
+   */
+  future<AsyncRowStream> AsyncRead(Transaction transaction, std::string table,
+                                   KeySet keys,
+                                   std::vector<std::string> columns,
+                                   ReadOptions read_options = {});
+  //@}
+
+  //@{
+  /**
+   * Asynchronously executes a SQL query, see `ExecuteQuery()` and
+   * `AsyncRead()`.
+   */
+  future<AsyncRowStream> AsyncExecuteQuery(SqlStatement statement,
+                                           QueryOptions const& opts = {});
+
+  /**
+   * @copydoc AsyncExecuteQuery
+   *
+   * @param transaction Execute this query as part of an existing transaction.
+   */
+  future<AsyncRowStream> AsyncExecuteQuery(Transaction transaction,
+                                           SqlStatement statement,
+                                           QueryOptions const& opts = {});
+  //@}
+
+  /**
+   * Asynchronously executes a SQL DML statement, see `ExecuteDml()` and
+   * `AsyncRead()`.
+   */
+  future<StatusOr<DmlResult>> AsyncExecuteDml(Transaction transaction,
+                                              SqlStatement statement,
+                                              QueryOptions const& opts = {});
+
+  /**
+   * Asynchronously commits a read-write transaction, see
+   * `Commit(Transaction, Mutations)` and `AsyncRead()`.
+   *
+   * @note Unlike `Commit(std::function<>)` this function does not rerun the
+   *     transaction on `kAborted` errors.
+   */
+  future<StatusOr<CommitResult>> AsyncCommit(Transaction transaction,
+                                             Mutations mutations);
+
+  /**
+   * Asynchronously rolls back a read-write transaction, see `Rollback()` and
+   * `AsyncRead()`.
+   */
+  future<Status> AsyncRollback(Transaction transaction);
+
  private:
   QueryOptions OverlayQueryOptions(QueryOptions const&);
 
@@ -31,7 +31,9 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <string>
 #include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -41,6 +43,7 @@ namespace {
 
 namespace spanner_proto = ::google::spanner::v1;
 
+using ::google::cloud::spanner_mocks::MockAsyncResultSetSource;
 using ::google::cloud::spanner_mocks::MockConnection;
 using ::google::cloud::spanner_mocks::MockResultSetSource;
 using ::google::cloud::testing_util::IsProtoEqual;
@@ -56,6 +59,7 @@ using ::testing::Field;
 using ::testing::HasSubstr;
 using ::testing::Return;
 using ::testing::SaveArg;
+using ::testing::UnorderedElementsAre;
 
 TEST(ClientTest, CopyAndMove) {
   auto conn1 = std::make_shared<MockConnection>();
@@ -256,6 +260,65 @@ TEST(ClientTest, ExecuteQueryFailure) {
   EXPECT_THAT(*iter, StatusIs(StatusCode::kDeadlineExceeded));
 }
 
+/// Returns a stream with a single row holding @p value.
+RowStream MakeSingleRowStream(std::string value) {
+  auto source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(MakeTestRow(std::move(value))))
+      .WillOnce(Return(Row()));
+  return RowStream(std::move(source));
+}
+
+TEST(ClientTest, ExecutePartitionsQuery) {
+  auto conn = std::make_shared<MockConnection>();
+  Client client(conn);
+
+  EXPECT_CALL(*conn, ExecuteQuery(_))
+      .Times(3)
+      .WillRepeatedly([](Connection::SqlParams const& params) {
+        EXPECT_EQ("select * from table;", params.statement.sql());
+        return MakeSingleRowStream(params.partition_token.value_or(""));
+      });
+
+  std::vector<QueryPartition> partitions;
+  for (auto const* token : {"p0", "p1", "p2"}) {
+    partitions.push_back(internal::MakeQueryPartition(
+        "txn", "session", token, SqlStatement("select * from table;")));
+  }
+  ExecutePartitionsOptions options;
+  options.max_parallelism = 2;
+  std::vector<std::string> tokens;
+  auto status = client.ExecutePartitions(
+      partitions,
+      [&tokens](Row const& row) {
+        auto token = row.get<std::string>(0);
+        if (!token) return std::move(token).status();
+        tokens.push_back(*std::move(token));
+        return Status();
+      },
+      options);
+  ASSERT_STATUS_OK(status);
+  EXPECT_THAT(tokens, UnorderedElementsAre("p0", "p1", "p2"));
+}
+
+TEST(ClientTest, ExecutePartitionsReadFailure) {
+  auto conn = std::make_shared<MockConnection>();
+  Client client(conn);
+
+  EXPECT_CALL(*conn, Read(_)).WillOnce([](Connection::ReadParams const&) {
+    auto source = absl::make_unique<MockResultSetSource>();
+    EXPECT_CALL(*source, NextRow())
+        .WillOnce(Return(Status(StatusCode::kPermissionDenied, "uh-oh")));
+    return RowStream(std::move(source));
+  });
+
+  std::vector<ReadPartition> partitions{internal::MakeReadPartition(
+      "txn", "session", "p0", "table", KeySet::All(), {"col"})};
+  auto status = client.ExecutePartitions(
+      partitions, [](Row const&) { return Status(); });
+  EXPECT_THAT(status, StatusIs(StatusCode::kPermissionDenied));
+}
+
 TEST(ClientTest, ExecuteBatchDmlSuccess) {
   auto request = {
       SqlStatement("UPDATE Foo SET Bar = 1"),
@@ -381,6 +444,67 @@ TEST(ClientTest, RollbackError) {
               StatusIs(StatusCode::kInvalidArgument, HasSubstr("oops")));
 }
 
+TEST(ClientTest, AsyncExecuteQuerySuccess) {
+  auto conn = std::make_shared<MockConnection>();
+
+  auto source = absl::make_unique<MockAsyncResultSetSource>();
+  EXPECT_CALL(*source, NextRow())
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<Row>(MakeTestRow({{"Name", Value("Steve")}}))))))
+      .WillOnce(Return(ByMove(make_ready_future(StatusOr<Row>(Row())))));
+
+  Client client(conn);
+  SqlStatement const stmt("select * from table;");
+  auto* source_ptr = source.release();
+  EXPECT_CALL(*conn, AsyncExecuteQuery(Field(&Connection::SqlParams::statement,
+                                             Eq(stmt))))
+      .WillOnce([source_ptr](Connection::SqlParams const&) {
+        return make_ready_future(AsyncRowStream(
+            std::unique_ptr<internal::AsyncResultSourceInterface>(
+                source_ptr)));
+      });
+
+  auto rows = client.AsyncExecuteQuery(stmt).get();
+  auto row = rows.Next().get();
+  ASSERT_STATUS_OK(row);
+  ASSERT_TRUE(row->has_value());
+  EXPECT_EQ("Steve", (*row)->get<std::string>(0).value());
+  row = rows.Next().get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_FALSE(row->has_value());
+}
+
+TEST(ClientTest, AsyncCommitSuccess) {
+  auto conn = std::make_shared<MockConnection>();
+
+  auto ts = MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value();
+  CommitResult result;
+  result.commit_timestamp = ts;
+
+  Client client(conn);
+  EXPECT_CALL(*conn, AsyncCommit(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          StatusOr<CommitResult>(result)))));
+
+  auto txn = MakeReadWriteTransaction();
+  auto commit = client.AsyncCommit(txn, {}).get();
+  ASSERT_STATUS_OK(commit);
+  EXPECT_EQ(ts, commit->commit_timestamp);
+}
+
+TEST(ClientTest, AsyncRollbackError) {
+  auto conn = std::make_shared<MockConnection>();
+
+  Client client(conn);
+  EXPECT_CALL(*conn, AsyncRollback(_))
+      .WillOnce(Return(ByMove(make_ready_future(
+          Status(StatusCode::kInvalidArgument, "oops")))));
+
+  auto txn = MakeReadWriteTransaction();
+  EXPECT_THAT(client.AsyncRollback(txn).get(),
+              StatusIs(StatusCode::kInvalidArgument, HasSubstr("oops")));
+}
+
 TEST(ClientTest, MakeConnectionOptionalArguments) {
   Database db("foo", "bar", "baz");
   auto conn = MakeConnection(db);
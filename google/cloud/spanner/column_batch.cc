@@ -0,0 +1,200 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/column_batch.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+bool IsStoredAsString(spanner_proto::TypeCode code) {
+  switch (code) {
+    case spanner_proto::TypeCode::STRING:
+    case spanner_proto::TypeCode::BYTES:
+    case spanner_proto::TypeCode::NUMERIC:
+    case spanner_proto::TypeCode::DATE:
+    case spanner_proto::TypeCode::TIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+Status BadValue(std::string const& type, google::protobuf::Value const& v) {
+  return Status(StatusCode::kInternal,
+                "bad " + type + " value: " + v.ShortDebugString());
+}
+
+}  // namespace
+
+ColumnBatch::Column::Column(spanner_proto::Type type) : type_(std::move(type)) {
+  if (IsStoredAsString(type_.code())) string_offsets_.push_back(0);
+}
+
+Status ColumnBatch::Column::Append(google::protobuf::Value&& v) {
+  bool const is_null = v.kind_case() == google::protobuf::Value::kNullValue;
+  // Only count the row once the value is stored, so a bad value leaves all
+  // the vectors with the same size.
+  auto status = AppendValue(std::move(v), is_null);
+  if (status.ok()) nulls_.push_back(is_null);
+  return status;
+}
+
+Status ColumnBatch::Column::AppendValue(google::protobuf::Value&& v,
+                                        bool is_null) {
+  switch (type_.code()) {
+    case spanner_proto::TypeCode::INT64: {
+      std::int64_t x = 0;
+      if (!is_null) {
+        if (v.kind_case() != google::protobuf::Value::kStringValue) {
+          return BadValue("INT64", v);
+        }
+        auto const& s = v.string_value();
+        char* end = nullptr;
+        errno = 0;
+        x = std::strtoll(s.c_str(), &end, 10);
+        if (errno != 0 || end == s.c_str() || *end != '\0') {
+          return BadValue("INT64", v);
+        }
+      }
+      int64s_.push_back(x);
+      return {};
+    }
+
+    case spanner_proto::TypeCode::FLOAT64: {
+      double x = 0;
+      if (v.kind_case() == google::protobuf::Value::kNumberValue) {
+        x = v.number_value();
+      } else if (v.kind_case() == google::protobuf::Value::kStringValue) {
+        auto const& s = v.string_value();
+        auto const inf = std::numeric_limits<double>::infinity();
+        if (s == "-Infinity") {
+          x = -inf;
+        } else if (s == "Infinity") {
+          x = inf;
+        } else if (s == "NaN") {
+          x = std::nan("");
+        } else {
+          return BadValue("FLOAT64", v);
+        }
+      } else if (!is_null) {
+        return BadValue("FLOAT64", v);
+      }
+      float64s_.push_back(x);
+      return {};
+    }
+
+    case spanner_proto::TypeCode::BOOL:
+      if (!is_null && v.kind_case() != google::protobuf::Value::kBoolValue) {
+        return BadValue("BOOL", v);
+      }
+      bools_.push_back(!is_null && v.bool_value());
+      return {};
+
+    default:
+      break;
+  }
+
+  if (!IsStoredAsString(type_.code())) {
+    others_.push_back(std::move(v));
+    return {};
+  }
+  if (!is_null) {
+    if (v.kind_case() != google::protobuf::Value::kStringValue) {
+      return BadValue(spanner_proto::TypeCode_Name(type_.code()), v);
+    }
+    string_data_ += v.string_value();
+  }
+  string_offsets_.push_back(string_data_.size());
+  return {};
+}
+
+Value ColumnBatch::Column::value(std::size_t row) const {
+  google::protobuf::Value v;
+  if (nulls_[row]) {
+    v.set_null_value(google::protobuf::NullValue::NULL_VALUE);
+    return internal::FromProto(type_, std::move(v));
+  }
+  switch (type_.code()) {
+    case spanner_proto::TypeCode::INT64:
+      v.set_string_value(std::to_string(int64s_[row]));
+      break;
+    case spanner_proto::TypeCode::FLOAT64:
+      v.set_number_value(float64s_[row]);
+      break;
+    case spanner_proto::TypeCode::BOOL:
+      v.set_bool_value(bools_[row]);
+      break;
+    default:
+      if (IsStoredAsString(type_.code())) {
+        auto const s = string_value(row);
+        v.set_string_value(s.data(), s.size());
+      } else {
+        v = others_[row];
+      }
+      break;
+  }
+  return internal::FromProto(type_, std::move(v));
+}
+
+namespace internal {
+
+ColumnBatchBuilder::ColumnBatchBuilder(
+    spanner_proto::StructType const& row_type,
+    std::shared_ptr<std::vector<std::string> const> names) {
+  batch_.names_ = std::move(names);
+  batch_.columns_.reserve(row_type.fields_size());
+  for (auto const& field : row_type.fields()) {
+    batch_.columns_.push_back(ColumnBatch::Column(field.type()));
+  }
+}
+
+void ColumnBatchBuilder::Reserve(std::size_t rows) {
+  for (auto& column : batch_.columns_) {
+    column.nulls_.reserve(rows);
+    switch (column.type_.code()) {
+      case spanner_proto::TypeCode::INT64:
+        column.int64s_.reserve(rows);
+        break;
+      case spanner_proto::TypeCode::FLOAT64:
+        column.float64s_.reserve(rows);
+        break;
+      case spanner_proto::TypeCode::BOOL:
+        column.bools_.reserve(rows);
+        break;
+      default:
+        if (IsStoredAsString(column.type_.code())) {
+          column.string_offsets_.reserve(rows + 1);
+        } else {
+          column.others_.reserve(rows);
+        }
+        break;
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
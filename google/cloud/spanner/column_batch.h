@@ -0,0 +1,187 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COLUMN_BATCH_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COLUMN_BATCH_H
+
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/status.h"
+#include "absl/strings/string_view.h"
+#include <google/protobuf/struct.pb.h>
+#include <google/spanner/v1/type.pb.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace internal {
+class ColumnBatchBuilder;
+}  // namespace internal
+
+/**
+ * A batch of rows returned by `RowStream::NextBatch()`, stored by column.
+ *
+ * Iterating a `RowStream` creates a `Row`, holding a `Value` for each cell.
+ * A `ColumnBatch` instead decodes the values received from the service
+ * directly into one vector per column, which is much cheaper when scanning
+ * many rows of simple types.
+ *
+ * - `INT64`, `FLOAT64`, and `BOOL` columns are stored in `int64_values()`,
+ *   `float64_values()`, and `bool_values()` respectively.
+ * - `STRING` columns, and the columns of other types that Spanner sends as
+ *   strings (`BYTES` as base64, `NUMERIC`, `DATE`, and `TIMESTAMP`), are
+ *   stored in a single character buffer per column, see `string_value()`.
+ * - Other columns (`ARRAY` and `STRUCT`) are kept as received.
+ *
+ * Any cell can be converted to a `Value` using `Column::value()`. Null cells
+ * are marked in a bitmap, their entries in the typed vectors are zero or
+ * empty.
+ *
+ * @par Example
+ * @code
+ * auto rows = client.ExecuteQuery(SqlStatement("SELECT Id FROM Singers"));
+ * std::int64_t sum = 0;
+ * for (;;) {
+ *   auto batch = rows.NextBatch();
+ *   if (!batch) throw std::runtime_error(batch.status().message());
+ *   if (!batch->has_value()) break;  // end of stream
+ *   auto const& ids = (*batch)->column(0);
+ *   for (std::size_t i = 0; i != ids.size(); ++i) {
+ *     if (!ids.IsNull(i)) sum += ids.int64_values()[i];
+ *   }
+ * }
+ * @endcode
+ */
+class ColumnBatch {
+ public:
+  /// The values of one column in a `ColumnBatch`.
+  class Column {
+   public:
+    /// The Spanner type of the values in this column.
+    google::spanner::v1::Type const& type() const { return type_; }
+
+    /// The number of values (rows) in this column.
+    std::size_t size() const { return nulls_.size(); }
+
+    /// Returns true if the value in @p row is null.
+    bool IsNull(std::size_t row) const { return nulls_[row]; }
+
+    /// The values of an `INT64` column, empty for other types.
+    std::vector<std::int64_t> const& int64_values() const { return int64s_; }
+
+    /// The values of a `FLOAT64` column, empty for other types.
+    std::vector<double> const& float64_values() const { return float64s_; }
+
+    /// The values of a `BOOL` column, empty for other types.
+    std::vector<bool> const& bool_values() const { return bools_; }
+
+    /**
+     * The value in @p row of a column stored as strings.
+     *
+     * The returned view is valid while the batch is. It is empty for null
+     * values and for the columns not stored as strings.
+     */
+    absl::string_view string_value(std::size_t row) const {
+      if (string_offsets_.empty()) return {};
+      return absl::string_view(string_data_)
+          .substr(string_offsets_[row],
+                  string_offsets_[row + 1] - string_offsets_[row]);
+    }
+
+    /// Returns the value in @p row as a `Value`, for any column type.
+    Value value(std::size_t row) const;
+
+   private:
+    friend class internal::ColumnBatchBuilder;
+    explicit Column(google::spanner::v1::Type type);
+
+    Status Append(google::protobuf::Value&& v);
+    // Appends @p v to the typed storage, without updating `nulls_`.
+    Status AppendValue(google::protobuf::Value&& v, bool is_null);
+
+    google::spanner::v1::Type type_;
+    std::vector<bool> nulls_;
+    std::vector<std::int64_t> int64s_;
+    std::vector<double> float64s_;
+    std::vector<bool> bools_;
+    // The characters of all the values, `string_offsets_[i]` is the start of
+    // the i-th value, and there is a final entry with the total size.
+    std::string string_data_;
+    std::vector<std::size_t> string_offsets_;
+    std::vector<google::protobuf::Value> others_;
+  };
+
+  /// Default constructs an empty batch, with no columns nor rows.
+  ColumnBatch() = default;
+
+  /// The number of rows in this batch.
+  std::size_t num_rows() const {
+    return columns_.empty() ? 0 : columns_.front().size();
+  }
+
+  /// The number of columns in this batch.
+  std::size_t num_columns() const { return columns_.size(); }
+
+  /// The names of the columns in this batch.
+  std::vector<std::string> const& column_names() const {
+    static auto const* const kEmpty = new std::vector<std::string>;
+    return names_ ? *names_ : *kEmpty;
+  }
+
+  /// Returns the column at position @p index, which must be valid.
+  Column const& column(std::size_t index) const { return columns_[index]; }
+
+ private:
+  friend class internal::ColumnBatchBuilder;
+
+  std::shared_ptr<std::vector<std::string> const> names_;
+  std::vector<Column> columns_;
+};
+
+namespace internal {
+
+/// Decodes the values of a result set into a `ColumnBatch`.
+class ColumnBatchBuilder {
+ public:
+  ColumnBatchBuilder(google::spanner::v1::StructType const& row_type,
+                     std::shared_ptr<std::vector<std::string> const> names);
+
+  /// Appends @p value to the column at position @p index.
+  Status Append(std::size_t index, google::protobuf::Value&& value) {
+    return batch_.columns_[index].Append(std::move(value));
+  }
+
+  /// Reserves space for @p rows rows in every column.
+  void Reserve(std::size_t rows);
+
+  ColumnBatch Build() && { return std::move(batch_); }
+
+ private:
+  ColumnBatch batch_;
+};
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_COLUMN_BATCH_H
@@ -0,0 +1,209 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/column_batch.h"
+#include "google/cloud/spanner/bytes.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include <google/protobuf/text_format.h>
+#include <gmock/gmock.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+using ::google::cloud::testing_util::StatusIs;
+using ::google::protobuf::TextFormat;
+using ::testing::ElementsAre;
+
+auto constexpr kRowType = R"pb(
+  fields: {
+    name: "I"
+    type: { code: INT64 }
+  }
+  fields: {
+    name: "F"
+    type: { code: FLOAT64 }
+  }
+  fields: {
+    name: "B"
+    type: { code: BOOL }
+  }
+  fields: {
+    name: "S"
+    type: { code: STRING }
+  }
+  fields: {
+    name: "Y"
+    type: { code: BYTES }
+  }
+  fields: {
+    name: "A"
+    type: {
+      code: ARRAY
+      array_element_type: { code: INT64 }
+    }
+  }
+)pb";
+
+internal::ColumnBatchBuilder MakeBuilder() {
+  spanner_proto::StructType row_type;
+  EXPECT_TRUE(TextFormat::ParseFromString(kRowType, &row_type));
+  auto names = std::make_shared<std::vector<std::string>>(
+      std::vector<std::string>{"I", "F", "B", "S", "Y", "A"});
+  return internal::ColumnBatchBuilder(row_type, std::move(names));
+}
+
+Status AppendRow(internal::ColumnBatchBuilder& builder,
+                 std::vector<Value> const& row) {
+  for (std::size_t i = 0; i != row.size(); ++i) {
+    auto status = builder.Append(i, internal::ToProto(row[i]).second);
+    if (!status.ok()) return status;
+  }
+  return {};
+}
+
+TEST(ColumnBatch, Empty) {
+  ColumnBatch batch;
+  EXPECT_EQ(0, batch.num_rows());
+  EXPECT_EQ(0, batch.num_columns());
+  EXPECT_TRUE(batch.column_names().empty());
+}
+
+TEST(ColumnBatch, TypedColumns) {
+  auto builder = MakeBuilder();
+  builder.Reserve(2);
+  ASSERT_STATUS_OK(AppendRow(
+      builder, {Value(42), Value(1.5), Value(true), Value("hello"),
+                Value(Bytes("raw")), Value(std::vector<std::int64_t>{1, 2})}));
+  ASSERT_STATUS_OK(AppendRow(
+      builder,
+      {Value(-7), Value(-2.0), Value(false), Value(""), Value(Bytes("")),
+       Value(std::vector<std::int64_t>{})}));
+  auto batch = std::move(builder).Build();
+
+  EXPECT_EQ(2, batch.num_rows());
+  EXPECT_EQ(6, batch.num_columns());
+  EXPECT_THAT(batch.column_names(), ElementsAre("I", "F", "B", "S", "Y", "A"));
+  EXPECT_THAT(batch.column(0).int64_values(), ElementsAre(42, -7));
+  EXPECT_THAT(batch.column(1).float64_values(), ElementsAre(1.5, -2.0));
+  EXPECT_THAT(batch.column(2).bool_values(), ElementsAre(true, false));
+  EXPECT_EQ("hello", batch.column(3).string_value(0));
+  EXPECT_EQ("", batch.column(3).string_value(1));
+  EXPECT_EQ(spanner_proto::TypeCode::ARRAY, batch.column(5).type().code());
+
+  // Every column converts back to the original values.
+  EXPECT_EQ(Value(42), batch.column(0).value(0));
+  EXPECT_EQ(Value(-2.0), batch.column(1).value(1));
+  EXPECT_EQ(Value(true), batch.column(2).value(0));
+  EXPECT_EQ(Value("hello"), batch.column(3).value(0));
+  EXPECT_EQ(Value(Bytes("raw")), batch.column(4).value(0));
+  EXPECT_EQ(Value(std::vector<std::int64_t>{1, 2}), batch.column(5).value(0));
+  EXPECT_EQ(Value(std::vector<std::int64_t>{}), batch.column(5).value(1));
+}
+
+TEST(ColumnBatch, NullValues) {
+  auto builder = MakeBuilder();
+  ASSERT_STATUS_OK(AppendRow(
+      builder, {MakeNullValue<std::int64_t>(), MakeNullValue<double>(),
+                MakeNullValue<bool>(), MakeNullValue<std::string>(),
+                MakeNullValue<Bytes>(),
+                MakeNullValue<std::vector<std::int64_t>>()}));
+  ASSERT_STATUS_OK(AppendRow(
+      builder, {Value(1), Value(2.0), Value(true), Value("s"),
+                Value(Bytes("b")), Value(std::vector<std::int64_t>{3})}));
+  auto batch = std::move(builder).Build();
+
+  ASSERT_EQ(2, batch.num_rows());
+  for (std::size_t i = 0; i != batch.num_columns(); ++i) {
+    SCOPED_TRACE("Testing column " + std::to_string(i));
+    auto const& column = batch.column(i);
+    EXPECT_TRUE(column.IsNull(0));
+    EXPECT_FALSE(column.IsNull(1));
+  }
+  EXPECT_THAT(batch.column(0).int64_values(), ElementsAre(0, 1));
+  EXPECT_EQ("", batch.column(3).string_value(0));
+  EXPECT_EQ("s", batch.column(3).string_value(1));
+  EXPECT_EQ(MakeNullValue<std::int64_t>(), batch.column(0).value(0));
+  EXPECT_EQ(MakeNullValue<std::string>(), batch.column(3).value(0));
+  EXPECT_EQ(MakeNullValue<std::vector<std::int64_t>>(),
+            batch.column(5).value(0));
+}
+
+TEST(ColumnBatch, SpecialFloat64Values) {
+  spanner_proto::StructType row_type;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(fields: {
+             name: "F"
+             type: { code: FLOAT64 }
+           })pb",
+      &row_type));
+  auto names = std::make_shared<std::vector<std::string>>(
+      std::vector<std::string>{"F"});
+  internal::ColumnBatchBuilder builder(row_type, std::move(names));
+  auto const inf = std::numeric_limits<double>::infinity();
+  for (auto v : {inf, -inf}) {
+    ASSERT_STATUS_OK(builder.Append(0, internal::ToProto(Value(v)).second));
+  }
+  google::protobuf::Value nan;
+  nan.set_string_value("NaN");
+  ASSERT_STATUS_OK(builder.Append(0, std::move(nan)));
+  auto batch = std::move(builder).Build();
+
+  auto const& values = batch.column(0).float64_values();
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(inf, values[0]);
+  EXPECT_EQ(-inf, values[1]);
+  EXPECT_TRUE(std::isnan(values[2]));
+}
+
+TEST(ColumnBatch, MalformedValues) {
+  auto builder = MakeBuilder();
+  google::protobuf::Value v;
+  v.set_string_value("not-a-number");
+  EXPECT_THAT(builder.Append(0, google::protobuf::Value(v)),
+              StatusIs(StatusCode::kInternal));
+  EXPECT_THAT(builder.Append(1, google::protobuf::Value(v)),
+              StatusIs(StatusCode::kInternal));
+  EXPECT_THAT(builder.Append(2, google::protobuf::Value(v)),
+              StatusIs(StatusCode::kInternal));
+  v.set_bool_value(true);
+  EXPECT_THAT(builder.Append(3, google::protobuf::Value(v)),
+              StatusIs(StatusCode::kInternal));
+
+  // The rejected values are not counted as rows.
+  auto batch = std::move(builder).Build();
+  for (std::size_t i = 0; i != batch.num_columns(); ++i) {
+    EXPECT_EQ(0, batch.column(i).size()) << "column=" << i;
+  }
+  EXPECT_TRUE(batch.column(0).int64_values().empty());
+  EXPECT_TRUE(batch.column(1).float64_values().empty());
+  EXPECT_TRUE(batch.column(2).bool_values().empty());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,56 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/connection.h"
+#include "google/cloud/spanner/internal/async_partial_result_set_source.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+namespace {
+Status AsyncUnimplemented(char const* func) {
+  return Status(StatusCode::kUnimplemented,
+                std::string(func) + "() is not implemented by this Connection");
+}
+}  // namespace
+
+future<AsyncRowStream> Connection::AsyncRead(ReadParams) {
+  return make_ready_future(AsyncRowStream(
+      internal::MakeStatusOnlyAsyncResultSource(AsyncUnimplemented(__func__))));
+}
+
+future<AsyncRowStream> Connection::AsyncExecuteQuery(SqlParams) {
+  return make_ready_future(AsyncRowStream(
+      internal::MakeStatusOnlyAsyncResultSource(AsyncUnimplemented(__func__))));
+}
+
+future<StatusOr<DmlResult>> Connection::AsyncExecuteDml(SqlParams) {
+  return make_ready_future(StatusOr<DmlResult>(AsyncUnimplemented(__func__)));
+}
+
+future<StatusOr<CommitResult>> Connection::AsyncCommit(CommitParams) {
+  return make_ready_future(
+      StatusOr<CommitResult>(AsyncUnimplemented(__func__)));
+}
+
+future<Status> Connection::AsyncRollback(RollbackParams) {
+  return make_ready_future(AsyncUnimplemented(__func__));
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -28,6 +28,7 @@
 #include "google/cloud/spanner/sql_statement.h"
 #include "google/cloud/spanner/transaction.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
 #include "absl/types/optional.h"
@@ -52,6 +53,10 @@ class QueryPartition;
  * inject custom behavior (e.g., with a Google Mock object) in a `Client`
  * object for use in their own tests.
  *
+ * The asynchronous member functions (`AsyncRead()`, `AsyncExecuteQuery()`,
+ * etc.) are not pure-virtual, so existing derived classes continue to compile.
+ * Their default implementations fail with `StatusCode::kUnimplemented`.
+ *
  * To create a concrete instance that connects you to a real Spanner database,
  * see `MakeConnection()`.
  */
@@ -162,6 +167,21 @@ class Connection {
 
   /// Defines the interface for `Client::Rollback()`
   virtual Status Rollback(RollbackParams) = 0;
+
+  /// Defines the interface for `Client::AsyncRead()`
+  virtual future<AsyncRowStream> AsyncRead(ReadParams);
+
+  /// Defines the interface for `Client::AsyncExecuteQuery()`
+  virtual future<AsyncRowStream> AsyncExecuteQuery(SqlParams);
+
+  /// Defines the interface for `Client::AsyncExecuteDml()`
+  virtual future<StatusOr<DmlResult>> AsyncExecuteDml(SqlParams);
+
+  /// Defines the interface for `Client::AsyncCommit()`
+  virtual future<StatusOr<CommitResult>> AsyncCommit(CommitParams);
+
+  /// Defines the interface for `Client::AsyncRollback()`
+  virtual future<Status> AsyncRollback(RollbackParams);
 };
 
 }  // namespace SPANNER_CLIENT_NS
@@ -0,0 +1,56 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_EXECUTE_PARTITIONS_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_EXECUTE_PARTITIONS_OPTIONS_H
+
+#include "google/cloud/spanner/query_options.h"
+#include "google/cloud/spanner/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Options passed to `Client::ExecutePartitions`.
+ */
+struct ExecutePartitionsOptions {
+  /**
+   * The maximum number of partitions executed at the same time.
+   *
+   * Each partition in execution uses its own thread. If zero, the number of
+   * threads supported by the hardware is used.
+   */
+  std::size_t max_parallelism = 0;
+
+  /**
+   * The maximum number of rows received, but not yet passed to the callback.
+   *
+   * When this many rows are buffered, the partitions in execution stop
+   * reading from their streams until the callback catches up.
+   */
+  std::size_t max_buffered_rows = 1024;
+
+  /// The options used to execute each `QueryPartition`, ignored for reads.
+  QueryOptions query_options;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_EXECUTE_PARTITIONS_OPTIONS_H
@@ -0,0 +1,288 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/async_partial_result_set_source.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * The state shared between an `AsyncPartialResultSetSource` and the callbacks
+ * of its streaming RPCs.
+ *
+ * The callbacks hold a reference to this object, so it remains valid until the
+ * last streaming RPC finishes, even if the source is deleted.
+ */
+class AsyncPartialResultSetSource::Stream
+    : public std::enable_shared_from_this<AsyncPartialResultSetSource::Stream> {
+ public:
+  Stream(CompletionQueue cq, AsyncPartialResultSetReaderFactory factory,
+         std::unique_ptr<RetryPolicy> retry_policy,
+         std::unique_ptr<BackoffPolicy> backoff_policy)
+      : cq_(std::move(cq)),
+        factory_(std::move(factory)),
+        retry_policy_(std::move(retry_policy)),
+        backoff_policy_(std::move(backoff_policy)) {}
+
+  /// Starts the first streaming RPC, satisfied with its first response.
+  future<Status> Start() {
+    std::unique_lock<std::mutex> lk(mu_);
+    ready_.emplace();
+    auto f = ready_->get_future();
+    StartStream(std::move(lk));
+    return f;
+  }
+
+  future<StatusOr<Row>> NextRow() {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (assembler_.HasRow()) {
+      auto row = assembler_.PopRow();
+      // Only request more data once all the buffered rows are consumed.
+      absl::optional<promise<bool>> continue_reading;
+      if (!assembler_.HasRow()) continue_reading.swap(continue_reading_);
+      lk.unlock();
+      if (continue_reading) continue_reading->set_value(true);
+      return make_ready_future(std::move(row));
+    }
+    if (final_status_) return make_ready_future(EndOfStream());
+    next_row_.emplace();
+    return next_row_->get_future();
+  }
+
+  void Cancel() {
+    std::unique_lock<std::mutex> lk(mu_);
+    cancelled_ = true;
+    auto op = op_;
+    absl::optional<promise<bool>> continue_reading;
+    continue_reading.swap(continue_reading_);
+    lk.unlock();
+    // Returning `false` from the `on_read` callback cancels the stream.
+    if (continue_reading) continue_reading->set_value(false);
+    if (op) op->Cancel();
+  }
+
+  bool finished() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return final_status_.has_value();
+  }
+
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return assembler_.metadata();
+  }
+
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return assembler_.stats();
+  }
+
+ private:
+  void StartStream(std::unique_lock<std::mutex> lk) {
+    auto self = shared_from_this();
+    auto const resume_token = resume_token_;
+    auto const finished_streams = finished_streams_;
+    lk.unlock();
+    auto op = factory_(
+        resume_token,
+        [self](google::spanner::v1::PartialResultSet result_set) {
+          return self->OnRead(std::move(result_set));
+        },
+        [self](Status status) { self->OnFinish(std::move(status)); });
+    lk.lock();
+    // The callbacks own a reference to `*this`, do not keep `op` (and create a
+    // cycle) if the stream has already finished.
+    if (finished_streams == finished_streams_) op_ = std::move(op);
+  }
+
+  future<bool> OnRead(google::spanner::v1::PartialResultSet result_set) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!result_set.resume_token().empty()) {
+      resume_token_ = result_set.resume_token();
+    }
+    auto status = assembler_.Append(std::move(result_set));
+    if (!status.ok()) {
+      // The stream is malformed, cancel it and report this error in
+      // `OnFinish()`.
+      error_ = std::move(status);
+      return make_ready_future(false);
+    }
+    absl::optional<promise<Status>> ready;
+    ready.swap(ready_);
+    absl::optional<promise<StatusOr<Row>>> next_row;
+    StatusOr<Row> row;
+    if (next_row_ && assembler_.HasRow()) {
+      next_row.swap(next_row_);
+      row = assembler_.PopRow();
+    }
+    auto continue_reading = make_ready_future(true);
+    if (assembler_.HasRow()) {
+      continue_reading_.emplace();
+      continue_reading = continue_reading_->get_future();
+    }
+    lk.unlock();
+    if (ready) ready->set_value(Status());
+    if (next_row) next_row->set_value(std::move(row));
+    return continue_reading;
+  }
+
+  void OnFinish(Status status) {
+    std::unique_lock<std::mutex> lk(mu_);
+    ++finished_streams_;
+    op_.reset();
+    if (!error_.ok()) return Finish(std::move(lk), error_);
+    if (status.ok() || cancelled_ || !retry_policy_->OnFailure(status)) {
+      return Finish(std::move(lk), std::move(status));
+    }
+    auto delay = backoff_policy_->OnCompletion();
+    auto self = shared_from_this();
+    lk.unlock();
+    cq_.MakeRelativeTimer(delay).then(
+        [self](future<StatusOr<std::chrono::system_clock::time_point>> f) {
+          self->OnBackoff(f.get().status());
+        });
+  }
+
+  void OnBackoff(Status status) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (cancelled_) {
+      return Finish(std::move(lk),
+                    Status(StatusCode::kCancelled, "stream cancelled"));
+    }
+    if (!status.ok()) return Finish(std::move(lk), std::move(status));
+    StartStream(std::move(lk));
+  }
+
+  void Finish(std::unique_lock<std::mutex> lk, Status status) {
+    final_status_ = std::move(status);
+    absl::optional<promise<Status>> ready;
+    ready.swap(ready_);
+    absl::optional<promise<StatusOr<Row>>> next_row;
+    next_row.swap(next_row_);
+    StatusOr<Row> row;
+    if (next_row) row = EndOfStream();
+    auto const final_status = *final_status_;
+    lk.unlock();
+    if (ready) ready->set_value(final_status);
+    if (next_row) next_row->set_value(std::move(row));
+  }
+
+  // The result of `NextRow()` once the stream has finished and all the
+  // buffered rows are consumed.
+  StatusOr<Row> EndOfStream() const {
+    if (!final_status_->ok()) return *final_status_;
+    auto status = assembler_.Finish();
+    if (!status.ok()) return status;
+    return Row();
+  }
+
+  mutable std::mutex mu_;
+  CompletionQueue cq_;
+  AsyncPartialResultSetReaderFactory factory_;
+  std::unique_ptr<RetryPolicy> retry_policy_;
+  std::unique_ptr<BackoffPolicy> backoff_policy_;
+  PartialResultSetAssembler assembler_;
+  std::string resume_token_;
+  std::shared_ptr<AsyncOperation> op_;
+  std::int64_t finished_streams_ = 0;
+  bool cancelled_ = false;
+  Status error_;
+  absl::optional<Status> final_status_;
+  absl::optional<promise<Status>> ready_;
+  absl::optional<promise<StatusOr<Row>>> next_row_;
+  absl::optional<promise<bool>> continue_reading_;
+};
+
+future<StatusOr<std::unique_ptr<AsyncResultSourceInterface>>>
+AsyncPartialResultSetSource::Create(
+    CompletionQueue cq, AsyncPartialResultSetReaderFactory factory,
+    std::unique_ptr<RetryPolicy> retry_policy,
+    std::unique_ptr<BackoffPolicy> backoff_policy) {
+  auto stream = std::make_shared<Stream>(std::move(cq), std::move(factory),
+                                         std::move(retry_policy),
+                                         std::move(backoff_policy));
+  return stream->Start().then(
+      [stream](future<Status> f)
+          -> StatusOr<std::unique_ptr<AsyncResultSourceInterface>> {
+        auto status = f.get();
+        if (!status.ok()) return status;
+        // The first response must contain metadata.
+        if (!stream->Metadata()) {
+          stream->Cancel();
+          return Status(StatusCode::kInternal,
+                        "response contained no metadata");
+        }
+        return std::unique_ptr<AsyncResultSourceInterface>(
+            new AsyncPartialResultSetSource(stream));
+      });
+}
+
+AsyncPartialResultSetSource::~AsyncPartialResultSetSource() {
+  // The user didn't iterate over all the data, there is no way to report the
+  // final status of the stream.
+  if (!stream_->finished()) stream_->Cancel();
+}
+
+future<StatusOr<Row>> AsyncPartialResultSetSource::NextRow() {
+  return stream_->NextRow();
+}
+
+absl::optional<google::spanner::v1::ResultSetMetadata>
+AsyncPartialResultSetSource::Metadata() {
+  return stream_->Metadata();
+}
+
+absl::optional<google::spanner::v1::ResultSetStats>
+AsyncPartialResultSetSource::Stats() const {
+  return stream_->Stats();
+}
+
+namespace {
+class StatusOnlyAsyncResultSource : public AsyncResultSourceInterface {
+ public:
+  explicit StatusOnlyAsyncResultSource(Status status)
+      : status_(std::move(status)) {}
+  ~StatusOnlyAsyncResultSource() override = default;
+
+  future<StatusOr<Row>> NextRow() override {
+    return make_ready_future(StatusOr<Row>(status_));
+  }
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return {};
+  }
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  Status status_;
+};
+}  // namespace
+
+std::unique_ptr<AsyncResultSourceInterface> MakeStatusOnlyAsyncResultSource(
+    Status status) {
+  return std::unique_ptr<AsyncResultSourceInterface>(
+      new StatusOnlyAsyncResultSource(std::move(status)));
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,98 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_ASYNC_PARTIAL_RESULT_SET_SOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_ASYNC_PARTIAL_RESULT_SET_SOURCE_H
+
+#include "google/cloud/spanner/internal/partial_result_set_source.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/async_operation.h"
+#include "google/cloud/backoff_policy.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "absl/types/optional.h"
+#include <google/spanner/v1/spanner.pb.h>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * Starts a streaming RPC returning `PartialResultSet` messages.
+ *
+ * The factory receives the resume token for the new stream and the callbacks
+ * for `CompletionQueue::MakeStreamingReadRpc()`.
+ */
+using AsyncPartialResultSetReaderFactory =
+    std::function<std::shared_ptr<AsyncOperation>(
+        std::string const& resume_token,
+        std::function<future<bool>(google::spanner::v1::PartialResultSet)>
+            on_read,
+        std::function<void(Status)> on_finish)>;
+
+/**
+ * The asynchronous version of `PartialResultSetSource`.
+ *
+ * The stream is read ahead by at most one row, the next message is not
+ * requested until the application consumes the buffered rows. On retryable
+ * errors the stream is resumed from the last resume token, after waiting
+ * (asynchronously) for the backoff period.
+ */
+class AsyncPartialResultSetSource : public AsyncResultSourceInterface {
+ public:
+  /**
+   * Factory method to create a AsyncPartialResultSetSource.
+   *
+   * The returned future is satisfied once the first response arrives, so the
+   * metadata is immediately available.
+   */
+  static future<StatusOr<std::unique_ptr<AsyncResultSourceInterface>>> Create(
+      CompletionQueue cq, AsyncPartialResultSetReaderFactory factory,
+      std::unique_ptr<RetryPolicy> retry_policy,
+      std::unique_ptr<BackoffPolicy> backoff_policy);
+
+  ~AsyncPartialResultSetSource() override;
+
+  future<StatusOr<Row>> NextRow() override;
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override;
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override;
+
+ private:
+  class Stream;
+  explicit AsyncPartialResultSetSource(std::shared_ptr<Stream> stream)
+      : stream_(std::move(stream)) {}
+
+  std::shared_ptr<Stream> stream_;
+};
+
+/// Returns a source that fails every `NextRow()` call with @p status.
+std::unique_ptr<AsyncResultSourceInterface> MakeStatusOnlyAsyncResultSource(
+    Status status);
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_ASYNC_PARTIAL_RESULT_SET_SOURCE_H
@@ -0,0 +1,277 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/async_partial_result_set_source.h"
+#include "google/cloud/spanner/backoff_policy.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/fake_completion_queue_impl.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include <google/protobuf/text_format.h>
+#include <gmock/gmock.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+using ::google::cloud::testing_util::FakeCompletionQueueImpl;
+using ::google::cloud::testing_util::StatusIs;
+using ::google::protobuf::TextFormat;
+using ::testing::HasSubstr;
+
+class FakeOperation : public AsyncOperation {
+ public:
+  void Cancel() override { ++cancel_count; }
+  int cancel_count = 0;
+};
+
+/// Records the streams started by an `AsyncPartialResultSetSource`.
+struct FakeStream {
+  std::string resume_token;
+  std::function<future<bool>(spanner_proto::PartialResultSet)> on_read;
+  std::function<void(Status)> on_finish;
+  std::shared_ptr<FakeOperation> op = std::make_shared<FakeOperation>();
+};
+
+class AsyncPartialResultSetSourceTest : public ::testing::Test {
+ protected:
+  AsyncPartialResultSetSourceTest()
+      : impl_(std::make_shared<FakeCompletionQueueImpl>()), cq_(impl_) {}
+
+  future<StatusOr<std::unique_ptr<AsyncResultSourceInterface>>> Create() {
+    auto factory =
+        [this](std::string const& resume_token,
+               std::function<future<bool>(spanner_proto::PartialResultSet)>
+                   on_read,
+               std::function<void(Status)> on_finish)
+        -> std::shared_ptr<AsyncOperation> {
+      streams_.push_back(
+          {resume_token, std::move(on_read), std::move(on_finish)});
+      return streams_.back().op;
+    };
+    return AsyncPartialResultSetSource::Create(
+        cq_, std::move(factory),
+        LimitedErrorCountRetryPolicy(/*maximum_failures=*/2).clone(),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)
+            .clone());
+  }
+
+  static spanner_proto::PartialResultSet Parse(char const* text) {
+    spanner_proto::PartialResultSet response;
+    EXPECT_TRUE(TextFormat::ParseFromString(text, &response));
+    return response;
+  }
+
+  std::shared_ptr<FakeCompletionQueueImpl> impl_;
+  CompletionQueue cq_;
+  std::vector<FakeStream> streams_;
+};
+
+auto constexpr kMetadata = R"pb(
+  metadata: {
+    row_type: {
+      fields: {
+        name: "AnInt",
+        type: { code: INT64 }
+      }
+    }
+  }
+)pb";
+
+/// @test Verify the behavior when the stream fails before any response.
+TEST_F(AsyncPartialResultSetSourceTest, InitialFailure) {
+  auto source = Create();
+  ASSERT_EQ(1, streams_.size());
+  EXPECT_EQ("", streams_[0].resume_token);
+  streams_[0].on_finish(Status(StatusCode::kInvalidArgument, "invalid"));
+  EXPECT_THAT(source.get(), StatusIs(StatusCode::kInvalidArgument));
+}
+
+/// @test Verify that the first response must contain the metadata.
+TEST_F(AsyncPartialResultSetSourceTest, MissingMetadata) {
+  auto source = Create();
+  ASSERT_EQ(1, streams_.size());
+  auto continue_reading =
+      streams_[0].on_read(Parse(R"pb(values: { string_value: "1" })pb"));
+  EXPECT_THAT(source.get(),
+              StatusIs(StatusCode::kInternal,
+                       HasSubstr("response contained no metadata")));
+  EXPECT_EQ(1, streams_[0].op->cancel_count);
+  streams_[0].on_finish(Status(StatusCode::kCancelled, "cancelled"));
+}
+
+/// @test Verify the stream is not read ahead of the application.
+TEST_F(AsyncPartialResultSetSourceTest, ReadRowsWithBackpressure) {
+  auto pending = Create();
+  ASSERT_EQ(1, streams_.size());
+  auto response = Parse(kMetadata);
+  response.add_values()->set_string_value("1");
+  response.add_values()->set_string_value("2");
+  auto continue_reading = streams_[0].on_read(std::move(response));
+  auto source = pending.get();
+  ASSERT_STATUS_OK(source);
+  ASSERT_TRUE((*source)->Metadata().has_value());
+
+  // Both rows are buffered, so no more data is requested until they are used.
+  auto const timeout = std::chrono::milliseconds(0);
+  EXPECT_EQ(std::future_status::timeout, continue_reading.wait_for(timeout));
+  auto row = (*source)->NextRow().get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"AnInt", Value(1)}}), *row);
+  EXPECT_EQ(std::future_status::timeout, continue_reading.wait_for(timeout));
+  row = (*source)->NextRow().get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"AnInt", Value(2)}}), *row);
+  EXPECT_TRUE(continue_reading.get());
+
+  auto next = (*source)->NextRow();
+  EXPECT_EQ(std::future_status::timeout, next.wait_for(timeout));
+  response = Parse(R"pb(values: { string_value: "3" })pb");
+  EXPECT_TRUE(streams_[0].on_read(std::move(response)).get());
+  row = next.get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"AnInt", Value(3)}}), *row);
+
+  next = (*source)->NextRow();
+  streams_[0].on_finish(Status());
+  row = next.get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(0, row->size());
+}
+
+/// @test Verify the stream is resumed after a transient failure.
+TEST_F(AsyncPartialResultSetSourceTest, ResumeAfterTransientFailure) {
+  auto pending = Create();
+  ASSERT_EQ(1, streams_.size());
+  auto response = Parse(kMetadata);
+  response.set_resume_token("token-1");
+  response.add_values()->set_string_value("1");
+  auto continue_reading = streams_[0].on_read(std::move(response));
+  auto source = pending.get();
+  ASSERT_STATUS_OK(source);
+  ASSERT_STATUS_OK((*source)->NextRow().get());
+  EXPECT_TRUE(continue_reading.get());
+
+  auto next = (*source)->NextRow();
+  streams_[0].on_finish(Status(StatusCode::kUnavailable, "try-again"));
+  // The stream is restarted after the backoff timer expires.
+  EXPECT_EQ(1, streams_.size());
+  impl_->SimulateCompletion(true);
+  ASSERT_EQ(2, streams_.size());
+  EXPECT_EQ("token-1", streams_[1].resume_token);
+
+  response = Parse(R"pb(values: { string_value: "2" })pb");
+  EXPECT_TRUE(streams_[1].on_read(std::move(response)).get());
+  auto row = next.get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(MakeTestRow({{"AnInt", Value(2)}}), *row);
+
+  next = (*source)->NextRow();
+  streams_[1].on_finish(Status());
+  row = next.get();
+  ASSERT_STATUS_OK(row);
+  EXPECT_EQ(0, row->size());
+}
+
+/// @test Verify the stream fails once the retry policy is exhausted.
+TEST_F(AsyncPartialResultSetSourceTest, TooManyTransientFailures) {
+  auto pending = Create();
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_EQ(i + 1, streams_.size());
+    streams_.back().on_finish(Status(StatusCode::kUnavailable, "try-again"));
+    if (i != 2) impl_->SimulateCompletion(true);
+  }
+  EXPECT_EQ(3, streams_.size());
+  EXPECT_THAT(pending.get(), StatusIs(StatusCode::kUnavailable));
+}
+
+/// @test Verify that deleting the source cancels the stream.
+TEST_F(AsyncPartialResultSetSourceTest, DeleteCancelsStream) {
+  auto pending = Create();
+  auto response = Parse(kMetadata);
+  response.add_values()->set_string_value("1");
+  response.add_values()->set_string_value("2");
+  auto continue_reading = streams_[0].on_read(std::move(response));
+  auto source = pending.get();
+  ASSERT_STATUS_OK(source);
+  source->reset();
+  // The pending read is cancelled, and so is the stream.
+  EXPECT_FALSE(continue_reading.get());
+  EXPECT_EQ(1, streams_[0].op->cancel_count);
+  streams_[0].on_finish(Status(StatusCode::kCancelled, "cancelled"));
+}
+
+/// @test Verify malformed responses are reported and not retried.
+TEST_F(AsyncPartialResultSetSourceTest, MalformedResponse) {
+  auto pending = Create();
+  auto response = Parse(kMetadata);
+  response.add_values()->set_string_value("1");
+  auto continue_reading = streams_[0].on_read(std::move(response));
+  auto source = pending.get();
+  ASSERT_STATUS_OK(source);
+  ASSERT_STATUS_OK((*source)->NextRow().get());
+  EXPECT_TRUE(continue_reading.get());
+
+  // A response with `chunked_value` set must contain some values.
+  auto next = (*source)->NextRow();
+  EXPECT_FALSE(
+      streams_[0].on_read(Parse(R"pb(chunked_value: true)pb")).get());
+  streams_[0].on_finish(Status(StatusCode::kCancelled, "cancelled"));
+  EXPECT_THAT(next.get(), StatusIs(StatusCode::kInternal));
+  EXPECT_EQ(1, streams_.size());
+}
+
+/// @test Verify the stream reports values left over at the end of the stream.
+TEST_F(AsyncPartialResultSetSourceTest, IncompleteRow) {
+  auto pending = Create();
+  auto response = Parse(R"pb(
+    metadata: {
+      row_type: {
+        fields: {
+          name: "A",
+          type: { code: INT64 }
+        }
+        fields: {
+          name: "B",
+          type: { code: INT64 }
+        }
+      }
+    }
+    values: { string_value: "1" }
+  )pb");
+  EXPECT_TRUE(streams_[0].on_read(std::move(response)).get());
+  auto source = pending.get();
+  ASSERT_STATUS_OK(source);
+  auto next = (*source)->NextRow();
+  streams_[0].on_finish(Status());
+  EXPECT_THAT(next.get(), StatusIs(StatusCode::kInternal,
+                                   HasSubstr("incomplete row")));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_CHANNEL_H
 
+#include "google/cloud/spanner/internal/counting_spanner_stub.h"
 #include "google/cloud/spanner/internal/spanner_stub.h"
 #include "google/cloud/spanner/version.h"
 #include <memory>
@@ -27,17 +28,19 @@ namespace internal {
 
 /**
  * `Channel` represents a single gRPC Channel/Stub.
+ *
+ * The RPCs made using `stub` are counted, see `CountingSpannerStub`.
  */
 struct Channel {
   /// @p stub_param must not be nullptr
   explicit Channel(std::shared_ptr<SpannerStub> stub_param)
-      : stub(std::move(stub_param)) {}
+      : stub(std::make_shared<CountingSpannerStub>(std::move(stub_param))) {}
 
   // This class is not copyable or movable.
   Channel(Channel const&) = delete;
   Channel& operator=(Channel const&) = delete;
 
-  std::shared_ptr<SpannerStub> const stub;
+  std::shared_ptr<CountingSpannerStub> const stub;
   int session_count = 0;
 };
 
@@ -13,13 +13,16 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/connection_impl.h"
+#include "google/cloud/spanner/internal/async_partial_result_set_source.h"
 #include "google/cloud/spanner/internal/logging_result_set_reader.h"
 #include "google/cloud/spanner/internal/partial_result_set_resume.h"
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
 #include "google/cloud/spanner/internal/status_utils.h"
 #include "google/cloud/spanner/query_partition.h"
 #include "google/cloud/spanner/read_partition.h"
 #include "google/cloud/grpc_error_delegate.h"
+#include "google/cloud/internal/async_retry_unary_rpc.h"
 #include "google/cloud/internal/retry_loop.h"
 #include "google/cloud/internal/retry_policy.h"
 #include "absl/memory/memory.h"
@@ -83,10 +86,12 @@ std::shared_ptr<ConnectionImpl> MakeConnection(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     ConnectionOptions const& options, SessionPoolOptions session_pool_options,
     std::unique_ptr<RetryPolicy> retry_policy,
-    std::unique_ptr<BackoffPolicy> backoff_policy) {
+    std::unique_ptr<BackoffPolicy> backoff_policy,
+    SpannerStubFactory stub_factory) {
   return std::shared_ptr<ConnectionImpl>(new ConnectionImpl(
       std::move(db), std::move(stubs), options, std::move(session_pool_options),
-      std::move(retry_policy), std::move(backoff_policy)));
+      std::move(retry_policy), std::move(backoff_policy),
+      std::move(stub_factory)));
 }
 
 spanner_proto::TransactionOptions PartitionedDmlTransactionOptions() {
@@ -105,12 +110,55 @@ Status MissingTransactionStatus(std::string const& operation) {
                     operation + ")");
 }
 
+// Builds the `ReadRequest` for `params`, the caller sets the transaction.
+spanner_proto::ReadRequest MakeReadRequest(std::string session_name,
+                                           Connection::ReadParams params) {
+  spanner_proto::ReadRequest request;
+  request.set_session(std::move(session_name));
+  request.set_table(std::move(params.table));
+  request.set_index(std::move(params.read_options.index_name));
+  for (auto&& column : params.columns) {
+    request.add_columns(std::move(column));
+  }
+  *request.mutable_key_set() = internal::ToProto(std::move(params.keys));
+  request.set_limit(params.read_options.limit);
+  if (params.partition_token) {
+    request.set_partition_token(*std::move(params.partition_token));
+  }
+  return request;
+}
+
+// Builds the `ExecuteSqlRequest` for `params`, the caller sets the
+// transaction.
+spanner_proto::ExecuteSqlRequest MakeExecuteSqlRequest(
+    std::string session_name, std::int64_t seqno, Connection::SqlParams params,
+    spanner_proto::ExecuteSqlRequest::QueryMode query_mode) {
+  spanner_proto::ExecuteSqlRequest request;
+  request.set_session(std::move(session_name));
+  auto sql_statement = internal::ToProto(std::move(params.statement));
+  request.set_sql(std::move(*sql_statement.mutable_sql()));
+  *request.mutable_params() = std::move(*sql_statement.mutable_params());
+  *request.mutable_param_types() =
+      std::move(*sql_statement.mutable_param_types());
+  request.set_seqno(seqno);
+  request.set_query_mode(query_mode);
+  if (params.partition_token) {
+    request.set_partition_token(*std::move(params.partition_token));
+  }
+  if (params.query_options.optimizer_version()) {
+    request.mutable_query_options()->set_optimizer_version(
+        *params.query_options.optimizer_version());
+  }
+  return request;
+}
+
 ConnectionImpl::ConnectionImpl(Database db,
                                std::vector<std::shared_ptr<SpannerStub>> stubs,
                                ConnectionOptions const& options,
                                SessionPoolOptions session_pool_options,
                                std::unique_ptr<RetryPolicy> retry_policy,
-                               std::unique_ptr<BackoffPolicy> backoff_policy)
+                               std::unique_ptr<BackoffPolicy> backoff_policy,
+                               SpannerStubFactory stub_factory)
     : db_(std::move(db)),
       retry_policy_prototype_(std::move(retry_policy)),
       backoff_policy_prototype_(std::move(backoff_policy)),
@@ -118,7 +166,11 @@ ConnectionImpl::ConnectionImpl(Database db,
       session_pool_(MakeSessionPool(
           db_, std::move(stubs), std::move(session_pool_options),
           background_threads_->cq(), retry_policy_prototype_->clone(),
-          backoff_policy_prototype_->clone())),
+          backoff_policy_prototype_->clone(),
+          std::make_shared<Session::Clock>(), std::move(stub_factory))),
+      async_state_(std::make_shared<AsyncState>(
+          AsyncState{background_threads_->cq(), session_pool_,
+                     retry_policy_prototype_, backoff_policy_prototype_})),
       rpc_stream_tracing_enabled_(options.tracing_enabled("rpc-streams")),
       tracing_options_(options.tracing_options()) {}
 
@@ -245,6 +297,65 @@ Status ConnectionImpl::Rollback(RollbackParams params) {
              std::int64_t) { return this->RollbackImpl(session, s); });
 }
 
+future<AsyncRowStream> ConnectionImpl::AsyncRead(ReadParams params) {
+  auto transaction = std::move(params.transaction);
+  auto state = async_state_;
+  return internal::AsyncVisit(
+      std::move(transaction),
+      [state, params](SessionHolder& session,
+                      StatusOr<spanner_proto::TransactionSelector>& s,
+                      std::int64_t) mutable {
+        return AsyncReadImpl(state, session, s, std::move(params));
+      });
+}
+
+future<AsyncRowStream> ConnectionImpl::AsyncExecuteQuery(SqlParams params) {
+  auto transaction = std::move(params.transaction);
+  auto state = async_state_;
+  return internal::AsyncVisit(
+      std::move(transaction),
+      [state, params](SessionHolder& session,
+                      StatusOr<spanner_proto::TransactionSelector>& s,
+                      std::int64_t seqno) mutable {
+        return AsyncExecuteQueryImpl(state, session, s, seqno,
+                                     std::move(params));
+      });
+}
+
+future<StatusOr<DmlResult>> ConnectionImpl::AsyncExecuteDml(SqlParams params) {
+  auto transaction = std::move(params.transaction);
+  auto state = async_state_;
+  return internal::AsyncVisit(
+      std::move(transaction),
+      [state, params](SessionHolder& session,
+                      StatusOr<spanner_proto::TransactionSelector>& s,
+                      std::int64_t seqno) mutable {
+        return AsyncExecuteDmlImpl(state, session, s, seqno, std::move(params));
+      });
+}
+
+future<StatusOr<CommitResult>> ConnectionImpl::AsyncCommit(
+    CommitParams params) {
+  auto transaction = std::move(params.transaction);
+  auto state = async_state_;
+  return internal::AsyncVisit(
+      std::move(transaction),
+      [state, params](SessionHolder& session,
+                      StatusOr<spanner_proto::TransactionSelector>& s,
+                      std::int64_t) mutable {
+        return AsyncCommitImpl(state, session, s, std::move(params));
+      });
+}
+
+future<Status> ConnectionImpl::AsyncRollback(RollbackParams params) {
+  auto state = async_state_;
+  return internal::AsyncVisit(
+      std::move(params.transaction),
+      [state](SessionHolder& session,
+              StatusOr<spanner_proto::TransactionSelector>& s,
+              std::int64_t) { return AsyncRollbackImpl(state, session, s); });
+}
+
 class StatusOnlyResultSetSource : public internal::ResultSourceInterface {
  public:
   explicit StatusOnlyResultSetSource(google::cloud::Status status)
@@ -351,6 +462,29 @@ Status ConnectionImpl::PrepareSession(SessionHolder& session,
   return Status();
 }
 
+/**
+ * Like `PrepareSession()` above, for the first operation in the transaction
+ * identified by `selector`.
+ *
+ * A read-write transaction that has not begun yet uses a write-prepared
+ * session when one is available, and adopts the transaction the pool already
+ * began on it, saving a `BeginTransaction` round trip.
+ */
+Status ConnectionImpl::PrepareSession(
+    SessionHolder& session, spanner_proto::TransactionSelector& selector) {
+  if (session || !selector.has_begin() || !selector.begin().has_read_write()) {
+    return PrepareSession(session);
+  }
+  auto session_or = session_pool_->AllocateForWrite();
+  if (!session_or) {
+    return std::move(session_or).status();
+  }
+  session = std::move(*session_or);
+  auto transaction_id = session->TakePreparedTransactionId();
+  if (!transaction_id.empty()) selector.set_id(std::move(transaction_id));
+  return Status();
+}
+
 /**
  * Performs an explicit `BeginTransaction` in cases where that is needed.
  *
@@ -390,32 +524,22 @@ RowStream ConnectionImpl::ReadImpl(
     return MakeStatusOnlyResult<RowStream>(s.status());
   }
 
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return MakeStatusOnlyResult<RowStream>(std::move(prepare_status));
   }
 
-  spanner_proto::ReadRequest request;
-  request.set_session(session->session_name());
+  auto const prefetch_depth = params.read_options.prefetch_depth;
+  auto request = MakeReadRequest(session->session_name(), std::move(params));
   *request.mutable_transaction() = *s;
-  request.set_table(std::move(params.table));
-  request.set_index(std::move(params.read_options.index_name));
-  for (auto&& column : params.columns) {
-    request.add_columns(std::move(column));
-  }
-  *request.mutable_key_set() = internal::ToProto(std::move(params.keys));
-  request.set_limit(params.read_options.limit);
-  if (params.partition_token) {
-    request.set_partition_token(*std::move(params.partition_token));
-  }
 
   // Capture a copy of `stub` to ensure the `shared_ptr<>` remains valid through
   // the lifetime of the lambda.
   auto stub = session_pool_->GetStub(*session);
   auto const tracing_enabled = rpc_stream_tracing_enabled_;
   auto const tracing_options = tracing_options_;
-  auto factory = [stub, &request, tracing_enabled,
-                  tracing_options](std::string const& resume_token) mutable {
+  auto factory = [stub, &request, tracing_enabled, tracing_options,
+                  prefetch_depth](std::string const& resume_token) mutable {
     request.set_resume_token(resume_token);
     auto context = absl::make_unique<grpc::ClientContext>();
     std::unique_ptr<PartialResultSetReader> reader =
@@ -425,6 +549,10 @@ RowStream ConnectionImpl::ReadImpl(
       reader = absl::make_unique<LoggingResultSetReader>(std::move(reader),
                                                          tracing_options);
     }
+    if (prefetch_depth > 0) {
+      reader = absl::make_unique<PrefetchingResultSetReader>(std::move(reader),
+                                                             prefetch_depth);
+    }
     return reader;
   };
   for (;;) {
@@ -543,23 +671,9 @@ StatusOr<ResultType> ConnectionImpl::ExecuteSqlImpl(
     return s.status();
   }
 
-  spanner_proto::ExecuteSqlRequest request;
-  request.set_session(session->session_name());
+  auto request = MakeExecuteSqlRequest(session->session_name(), seqno,
+                                       std::move(params), query_mode);
   *request.mutable_transaction() = *s;
-  auto sql_statement = internal::ToProto(std::move(params.statement));
-  request.set_sql(std::move(*sql_statement.mutable_sql()));
-  *request.mutable_params() = std::move(*sql_statement.mutable_params());
-  *request.mutable_param_types() =
-      std::move(*sql_statement.mutable_param_types());
-  request.set_seqno(seqno);
-  request.set_query_mode(query_mode);
-  if (params.partition_token) {
-    request.set_partition_token(*std::move(params.partition_token));
-  }
-  if (params.query_options.optimizer_version()) {
-    request.mutable_query_options()->set_optimizer_version(
-        *params.query_options.optimizer_version());
-  }
 
   for (;;) {
     auto reader = retry_resume_fn(request);
@@ -597,7 +711,7 @@ ResultType ConnectionImpl::CommonQueryImpl(
     return MakeStatusOnlyResult<ResultType>(s.status());
   }
 
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return MakeStatusOnlyResult<ResultType>(std::move(prepare_status));
   }
@@ -609,12 +723,13 @@ ResultType ConnectionImpl::CommonQueryImpl(
   auto const& backoff_policy = backoff_policy_prototype_;
   auto const tracing_enabled = rpc_stream_tracing_enabled_;
   auto const tracing_options = tracing_options_;
+  auto const prefetch_depth = params.query_options.prefetch_depth().value_or(0);
   auto retry_resume_fn =
-      [stub, retry_policy, backoff_policy, tracing_enabled,
-       tracing_options](spanner_proto::ExecuteSqlRequest& request) mutable
+      [stub, retry_policy, backoff_policy, tracing_enabled, tracing_options,
+       prefetch_depth](spanner_proto::ExecuteSqlRequest& request) mutable
       -> StatusOr<std::unique_ptr<ResultSourceInterface>> {
-    auto factory = [stub, request, tracing_enabled,
-                    tracing_options](std::string const& resume_token) mutable {
+    auto factory = [stub, request, tracing_enabled, tracing_options,
+                    prefetch_depth](std::string const& resume_token) mutable {
       request.set_resume_token(resume_token);
       auto context = absl::make_unique<grpc::ClientContext>();
       std::unique_ptr<PartialResultSetReader> reader =
@@ -624,6 +739,10 @@ ResultType ConnectionImpl::CommonQueryImpl(
         reader = absl::make_unique<LoggingResultSetReader>(std::move(reader),
                                                            tracing_options);
       }
+      if (prefetch_depth > 0) {
+        reader = absl::make_unique<PrefetchingResultSetReader>(
+            std::move(reader), prefetch_depth);
+      }
       return reader;
     };
     auto rpc = absl::make_unique<PartialResultSetResume>(
@@ -668,7 +787,7 @@ StatusOr<ResultType> ConnectionImpl::CommonDmlImpl(
     return s.status();
   }
   auto function_name = __func__;
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return prepare_status;
   }
@@ -804,7 +923,7 @@ StatusOr<BatchDmlResult> ConnectionImpl::ExecuteBatchDmlImpl(
     return s.status();
   }
 
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return prepare_status;
   }
@@ -903,7 +1022,7 @@ StatusOr<CommitResult> ConnectionImpl::CommitImpl(
     return s.status();
   }
 
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return prepare_status;
   }
@@ -956,7 +1075,7 @@ Status ConnectionImpl::RollbackImpl(
                   "Cannot rollback a single-use transaction");
   }
 
-  auto prepare_status = PrepareSession(session);
+  auto prepare_status = PrepareSession(session, *s);
   if (!prepare_status.ok()) {
     return prepare_status;
   }
@@ -986,6 +1105,384 @@ Status ConnectionImpl::RollbackImpl(
   return status;
 }
 
+future<Status> ConnectionImpl::AsyncPrepareSession(AsyncStatePtr const& state,
+                                                   SessionHolder& session) {
+  if (session) return make_ready_future(Status());
+  return state->session_pool->AsyncAllocate().then(
+      [&session](future<StatusOr<SessionHolder>> f) {
+        auto session_or = f.get();
+        if (!session_or) return std::move(session_or).status();
+        session = std::move(*session_or);
+        return Status();
+      });
+}
+
+future<StatusOr<spanner_proto::Transaction>>
+ConnectionImpl::AsyncBeginTransaction(AsyncStatePtr const& state,
+                                      SessionHolder& session,
+                                      spanner_proto::TransactionOptions options,
+                                      char const* func) {
+  spanner_proto::BeginTransactionRequest begin;
+  begin.set_session(session->session_name());
+  *begin.mutable_options() = std::move(options);
+
+  auto stub = state->session_pool->GetStub(*session);
+  return google::cloud::internal::StartRetryAsyncUnaryRpc(
+             state->cq, func, state->retry_policy_prototype->clone(),
+             state->backoff_policy_prototype->clone(), Idempotency::kIdempotent,
+             [stub](grpc::ClientContext* context,
+                    spanner_proto::BeginTransactionRequest const& request,
+                    grpc::CompletionQueue* cq) {
+               return stub->AsyncBeginTransaction(*context, request, cq);
+             },
+             std::move(begin))
+      .then([&session](future<StatusOr<spanner_proto::Transaction>> f) {
+        auto response = f.get();
+        if (!response && internal::IsSessionNotFound(response.status())) {
+          session->set_bad();
+        }
+        return response;
+      });
+}
+
+/**
+ * Assigns a transaction ID to `s`, using an explicit `BeginTransaction` if
+ * needed. Invalidates the transaction if that fails.
+ */
+future<Status> ConnectionImpl::AsyncEnsureTransactionId(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, char const* func) {
+  if (s->selector_case() == spanner_proto::TransactionSelector::kId) {
+    return make_ready_future(Status());
+  }
+  return AsyncBeginTransaction(state, session,
+                               s->has_begin() ? s->begin() : s->single_use(),
+                               func)
+      .then([&s](future<StatusOr<spanner_proto::Transaction>> f) {
+        auto begin = f.get();
+        if (!begin.ok()) {
+          s = begin.status();  // invalidate the transaction
+          return begin.status();
+        }
+        s->set_id(begin->id());
+        return Status();
+      });
+}
+
+// Start the asynchronous version of the streaming RPC for each request type.
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+PrepareAsyncStreamingRpc(SpannerStub& stub, grpc::ClientContext& context,
+                         spanner_proto::ReadRequest const& request,
+                         grpc::CompletionQueue* cq) {
+  return stub.PrepareAsyncStreamingRead(context, request, cq);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+PrepareAsyncStreamingRpc(SpannerStub& stub, grpc::ClientContext& context,
+                         spanner_proto::ExecuteSqlRequest const& request,
+                         grpc::CompletionQueue* cq) {
+  return stub.PrepareAsyncExecuteStreamingSql(context, request, cq);
+}
+
+template <typename Request>
+future<AsyncRowStream> ConnectionImpl::AsyncStreamingImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, Request request,
+    char const* func) {
+  *request.mutable_transaction() = *s;
+  auto stub = state->session_pool->GetStub(*session);
+  auto cq = state->cq;
+  auto stream_request = request;
+  AsyncPartialResultSetReaderFactory factory =
+      [stub, cq, stream_request](
+          std::string const& resume_token,
+          std::function<future<bool>(spanner_proto::PartialResultSet)>
+              on_read,
+          std::function<void(Status)> on_finish) mutable {
+        stream_request.set_resume_token(resume_token);
+        return cq.MakeStreamingReadRpc(
+            [stub](grpc::ClientContext* context, Request const& request,
+                   grpc::CompletionQueue* cq) {
+              return PrepareAsyncStreamingRpc(*stub, *context, request, cq);
+            },
+            stream_request, absl::make_unique<grpc::ClientContext>(),
+            std::move(on_read), std::move(on_finish));
+      };
+
+  auto make_error = [](Status status) {
+    return make_ready_future(
+        AsyncRowStream(MakeStatusOnlyAsyncResultSource(std::move(status))));
+  };
+  return AsyncPartialResultSetSource::Create(
+             state->cq, std::move(factory),
+             state->retry_policy_prototype->clone(),
+             state->backoff_policy_prototype->clone())
+      .then([state, &session, &s, request, func, make_error](
+                future<StatusOr<std::unique_ptr<AsyncResultSourceInterface>>>
+                    f) mutable -> future<AsyncRowStream> {
+        auto source = f.get();
+        if (s->has_begin()) {
+          if (source.ok()) {
+            auto metadata = (*source)->Metadata();
+            if (!metadata || !metadata->has_transaction()) {
+              s = MissingTransactionStatus(func);
+              return make_error(s.status());
+            }
+            s->set_id(metadata->transaction().id());
+          } else {
+            auto status = std::move(source).status();
+            return AsyncBeginTransaction(state, session, s->begin(), func)
+                .then([state, &session, &s, request, func, make_error,
+                       status](future<StatusOr<spanner_proto::Transaction>>
+                                   f) mutable -> future<AsyncRowStream> {
+                  auto begin = f.get();
+                  if (begin.ok()) {
+                    s->set_id(begin->id());
+                    return AsyncStreamingImpl(state, session, s,
+                                              std::move(request), func);
+                  }
+                  s = begin.status();  // invalidate the transaction
+                  if (internal::IsSessionNotFound(status)) session->set_bad();
+                  return make_error(std::move(status));
+                });
+          }
+        }
+        if (!source.ok()) {
+          auto status = std::move(source).status();
+          if (internal::IsSessionNotFound(status)) session->set_bad();
+          return make_error(std::move(status));
+        }
+        return make_ready_future(AsyncRowStream(*std::move(source)));
+      });
+}
+
+future<AsyncRowStream> ConnectionImpl::AsyncReadImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, ReadParams params) {
+  if (!s.ok()) {
+    return make_ready_future(
+        AsyncRowStream(MakeStatusOnlyAsyncResultSource(s.status())));
+  }
+  char const* func = __func__;
+  return AsyncPrepareSession(state, session)
+      .then([state, &session, &s, params,
+             func](future<Status> f) mutable -> future<AsyncRowStream> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(
+              AsyncRowStream(MakeStatusOnlyAsyncResultSource(status)));
+        }
+        return AsyncStreamingImpl(
+            state, session, s,
+            MakeReadRequest(session->session_name(), std::move(params)), func);
+      });
+}
+
+future<AsyncRowStream> ConnectionImpl::AsyncExecuteQueryImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, std::int64_t seqno,
+    SqlParams params) {
+  if (!s.ok()) {
+    return make_ready_future(
+        AsyncRowStream(MakeStatusOnlyAsyncResultSource(s.status())));
+  }
+  char const* func = __func__;
+  return AsyncPrepareSession(state, session)
+      .then([state, &session, &s, seqno, params,
+             func](future<Status> f) mutable -> future<AsyncRowStream> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(
+              AsyncRowStream(MakeStatusOnlyAsyncResultSource(status)));
+        }
+        return AsyncStreamingImpl(
+            state, session, s,
+            MakeExecuteSqlRequest(session->session_name(), seqno,
+                                  std::move(params),
+                                  spanner_proto::ExecuteSqlRequest::NORMAL),
+            func);
+      });
+}
+
+future<StatusOr<DmlResult>> ConnectionImpl::AsyncExecuteDmlImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, std::int64_t seqno,
+    SqlParams params) {
+  if (!s.ok()) {
+    return make_ready_future(StatusOr<DmlResult>(s.status()));
+  }
+  return AsyncPrepareSession(state, session)
+      .then([state, &session, &s, seqno, params](
+                future<Status> f) mutable -> future<StatusOr<DmlResult>> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(StatusOr<DmlResult>(std::move(status)));
+        }
+        return AsyncExecuteSqlRpc(
+            state, session, s,
+            MakeExecuteSqlRequest(session->session_name(), seqno,
+                                  std::move(params),
+                                  spanner_proto::ExecuteSqlRequest::NORMAL));
+      });
+}
+
+future<StatusOr<DmlResult>> ConnectionImpl::AsyncExecuteSqlRpc(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s,
+    spanner_proto::ExecuteSqlRequest request) {
+  char const* func = __func__;
+  *request.mutable_transaction() = *s;
+  auto stub = state->session_pool->GetStub(*session);
+  return google::cloud::internal::StartRetryAsyncUnaryRpc(
+             state->cq, func, state->retry_policy_prototype->clone(),
+             state->backoff_policy_prototype->clone(), Idempotency::kIdempotent,
+             [stub](grpc::ClientContext* context,
+                    spanner_proto::ExecuteSqlRequest const& request,
+                    grpc::CompletionQueue* cq) {
+               return stub->AsyncExecuteSql(*context, request, cq);
+             },
+             request)
+      .then([state, &session, &s, request,
+             func](future<StatusOr<spanner_proto::ResultSet>> f) mutable
+            -> future<StatusOr<DmlResult>> {
+        auto response = f.get();
+        if (s->has_begin()) {
+          if (response.ok()) {
+            if (!response->metadata().has_transaction()) {
+              s = MissingTransactionStatus(func);
+              return make_ready_future(StatusOr<DmlResult>(s.status()));
+            }
+            s->set_id(response->metadata().transaction().id());
+          } else {
+            auto status = std::move(response).status();
+            return AsyncBeginTransaction(state, session, s->begin(), func)
+                .then([state, &session, &s, request,
+                       status](future<StatusOr<spanner_proto::Transaction>>
+                                   f) mutable -> future<StatusOr<DmlResult>> {
+                  auto begin = f.get();
+                  if (begin.ok()) {
+                    s->set_id(begin->id());
+                    return AsyncExecuteSqlRpc(state, session, s,
+                                              std::move(request));
+                  }
+                  s = begin.status();  // invalidate the transaction
+                  if (internal::IsSessionNotFound(status)) session->set_bad();
+                  return make_ready_future(StatusOr<DmlResult>(status));
+                });
+          }
+        }
+        if (!response) {
+          auto status = std::move(response).status();
+          if (internal::IsSessionNotFound(status)) session->set_bad();
+          return make_ready_future(StatusOr<DmlResult>(std::move(status)));
+        }
+        return make_ready_future(StatusOr<DmlResult>(DmlResult(
+            absl::make_unique<DmlResultSetSource>(*std::move(response)))));
+      });
+}
+
+future<StatusOr<CommitResult>> ConnectionImpl::AsyncCommitImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s, CommitParams params) {
+  if (!s.ok()) {
+    // Fail the commit if the transaction has been invalidated.
+    return make_ready_future(StatusOr<CommitResult>(s.status()));
+  }
+  char const* func = __func__;
+  return AsyncPrepareSession(state, session)
+      .then([state, &session, &s,
+             func](future<Status> f) -> future<Status> {
+        auto status = f.get();
+        if (!status.ok()) return make_ready_future(std::move(status));
+        return AsyncEnsureTransactionId(state, session, s, func);
+      })
+      .then([state, &session, &s, params,
+             func](future<Status> f) mutable -> future<StatusOr<CommitResult>> {
+        auto status = f.get();
+        if (!status.ok()) {
+          return make_ready_future(StatusOr<CommitResult>(std::move(status)));
+        }
+        spanner_proto::CommitRequest request;
+        request.set_session(session->session_name());
+        for (auto&& m : params.mutations) {
+          *request.add_mutations() = std::move(m).as_proto();
+        }
+        request.set_transaction_id(s->id());
+        auto stub = state->session_pool->GetStub(*session);
+        return google::cloud::internal::StartRetryAsyncUnaryRpc(
+                   state->cq, func, state->retry_policy_prototype->clone(),
+                   state->backoff_policy_prototype->clone(),
+                   Idempotency::kIdempotent,
+                   [stub](grpc::ClientContext* context,
+                          spanner_proto::CommitRequest const& request,
+                          grpc::CompletionQueue* cq) {
+                     return stub->AsyncCommit(*context, request, cq);
+                   },
+                   std::move(request))
+            .then([&session](future<StatusOr<spanner_proto::CommitResponse>> f)
+                      -> StatusOr<CommitResult> {
+              auto response = f.get();
+              if (!response) {
+                auto status = std::move(response).status();
+                if (internal::IsSessionNotFound(status)) session->set_bad();
+                return status;
+              }
+              auto timestamp =
+                  internal::TimestampFromProto(response->commit_timestamp());
+              if (!timestamp) return std::move(timestamp).status();
+              CommitResult r;
+              r.commit_timestamp = *std::move(timestamp);
+              return r;
+            });
+      });
+}
+
+future<Status> ConnectionImpl::AsyncRollbackImpl(
+    AsyncStatePtr const& state, SessionHolder& session,
+    StatusOr<spanner_proto::TransactionSelector>& s) {
+  if (!s.ok()) {
+    return make_ready_future(s.status());
+  }
+  if (s->has_single_use()) {
+    return make_ready_future(
+        Status(StatusCode::kInvalidArgument,
+               "Cannot rollback a single-use transaction"));
+  }
+  char const* func = __func__;
+  return AsyncPrepareSession(state, session)
+      .then([state, &session, &s,
+             func](future<Status> f) -> future<Status> {
+        auto status = f.get();
+        if (!status.ok()) return make_ready_future(std::move(status));
+        return AsyncEnsureTransactionId(state, session, s, func);
+      })
+      .then([state, &session, &s, func](future<Status> f) -> future<Status> {
+        auto status = f.get();
+        if (!status.ok()) return make_ready_future(std::move(status));
+        spanner_proto::RollbackRequest request;
+        request.set_session(session->session_name());
+        request.set_transaction_id(s->id());
+        auto stub = state->session_pool->GetStub(*session);
+        return google::cloud::internal::StartRetryAsyncUnaryRpc(
+                   state->cq, func, state->retry_policy_prototype->clone(),
+                   state->backoff_policy_prototype->clone(),
+                   Idempotency::kIdempotent,
+                   [stub](grpc::ClientContext* context,
+                          spanner_proto::RollbackRequest const& request,
+                          grpc::CompletionQueue* cq) {
+                     return stub->AsyncRollback(*context, request, cq);
+                   },
+                   std::move(request))
+            .then([&session](future<StatusOr<google::protobuf::Empty>> f) {
+              auto status = f.get().status();
+              if (internal::IsSessionNotFound(status)) session->set_bad();
+              return status;
+            });
+      });
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
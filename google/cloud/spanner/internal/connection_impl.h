@@ -25,6 +25,8 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/background_threads.h"
 #include "google/cloud/backoff_policy.h"
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/future.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
@@ -49,6 +51,9 @@ std::unique_ptr<BackoffPolicy> DefaultConnectionBackoffPolicy();
 /**
  * Factory method to construct a `ConnectionImpl`.
  *
+ * If set, @p stub_factory creates the stubs for the channels added by the
+ * session pool, see `SessionPoolOptions::set_max_channels()`.
+ *
  * @note In tests we can use mock stubs and custom (or mock) policies.
  */
 class ConnectionImpl;
@@ -58,7 +63,8 @@ std::shared_ptr<ConnectionImpl> MakeConnection(
     SessionPoolOptions session_pool_options = SessionPoolOptions{},
     std::unique_ptr<RetryPolicy> retry_policy = DefaultConnectionRetryPolicy(),
     std::unique_ptr<BackoffPolicy> backoff_policy =
-        DefaultConnectionBackoffPolicy());
+        DefaultConnectionBackoffPolicy(),
+    SpannerStubFactory stub_factory = {});
 
 /**
  * A concrete `Connection` subclass that uses gRPC to actually talk to a real
@@ -82,21 +88,30 @@ class ConnectionImpl : public Connection {
   StatusOr<BatchDmlResult> ExecuteBatchDml(ExecuteBatchDmlParams) override;
   StatusOr<CommitResult> Commit(CommitParams) override;
   Status Rollback(RollbackParams) override;
+  future<AsyncRowStream> AsyncRead(ReadParams) override;
+  future<AsyncRowStream> AsyncExecuteQuery(SqlParams) override;
+  future<StatusOr<DmlResult>> AsyncExecuteDml(SqlParams) override;
+  future<StatusOr<CommitResult>> AsyncCommit(CommitParams) override;
+  future<Status> AsyncRollback(RollbackParams) override;
 
  private:
   // Only the factory method can construct instances of this class.
   friend std::shared_ptr<ConnectionImpl> MakeConnection(
       Database, std::vector<std::shared_ptr<SpannerStub>>,
       ConnectionOptions const&, SessionPoolOptions,
-      std::unique_ptr<RetryPolicy>, std::unique_ptr<BackoffPolicy>);
+      std::unique_ptr<RetryPolicy>, std::unique_ptr<BackoffPolicy>,
+      SpannerStubFactory);
   ConnectionImpl(Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
                  ConnectionOptions const& options,
                  SessionPoolOptions session_pool_options,
                  std::unique_ptr<RetryPolicy> retry_policy,
-                 std::unique_ptr<BackoffPolicy> backoff_policy);
+                 std::unique_ptr<BackoffPolicy> backoff_policy,
+                 SpannerStubFactory stub_factory);
 
   Status PrepareSession(SessionHolder& session,
                         bool dissociate_from_pool = false);
+  Status PrepareSession(SessionHolder& session,
+                        google::spanner::v1::TransactionSelector& selector);
 
   StatusOr<google::spanner::v1::Transaction> BeginTransaction(
       SessionHolder& session, google::spanner::v1::TransactionOptions options,
@@ -182,11 +197,68 @@ class ConnectionImpl : public Connection {
       SqlParams params,
       google::spanner::v1::ExecuteSqlRequest::QueryMode query_mode);
 
+  // The asynchronous operations may outlive `*this`, so they use (a shared
+  // copy of) the members they need instead of `this`.
+  struct AsyncState {
+    CompletionQueue cq;
+    std::shared_ptr<SessionPool> session_pool;
+    std::shared_ptr<RetryPolicy const> retry_policy_prototype;
+    std::shared_ptr<BackoffPolicy const> backoff_policy_prototype;
+  };
+  using AsyncStatePtr = std::shared_ptr<AsyncState const>;
+
+  static future<Status> AsyncPrepareSession(AsyncStatePtr const& state,
+                                            SessionHolder& session);
+
+  static future<StatusOr<google::spanner::v1::Transaction>>
+  AsyncBeginTransaction(AsyncStatePtr const& state, SessionHolder& session,
+                        google::spanner::v1::TransactionOptions options,
+                        char const* func);
+
+  static future<Status> AsyncEnsureTransactionId(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s, char const* func);
+
+  template <typename Request>
+  static future<AsyncRowStream> AsyncStreamingImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s, Request request,
+      char const* func);
+
+  static future<AsyncRowStream> AsyncReadImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s, ReadParams params);
+
+  static future<AsyncRowStream> AsyncExecuteQueryImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s, std::int64_t seqno,
+      SqlParams params);
+
+  static future<StatusOr<DmlResult>> AsyncExecuteDmlImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s, std::int64_t seqno,
+      SqlParams params);
+
+  static future<StatusOr<DmlResult>> AsyncExecuteSqlRpc(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s,
+      google::spanner::v1::ExecuteSqlRequest request);
+
+  static future<StatusOr<CommitResult>> AsyncCommitImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s,
+      CommitParams params);
+
+  static future<Status> AsyncRollbackImpl(
+      AsyncStatePtr const& state, SessionHolder& session,
+      StatusOr<google::spanner::v1::TransactionSelector>& s);
+
   Database db_;
   std::shared_ptr<RetryPolicy const> retry_policy_prototype_;
   std::shared_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::unique_ptr<BackgroundThreads> background_threads_;
   std::shared_ptr<SessionPool> session_pool_;
+  AsyncStatePtr async_state_;
   bool rpc_stream_tracing_enabled_ = false;
   TracingOptions tracing_options_;
 };
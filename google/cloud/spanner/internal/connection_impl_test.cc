@@ -19,7 +19,9 @@
 #include "google/cloud/spanner/testing/mock_spanner_stub.h"
 #include "google/cloud/log.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/fake_completion_queue_impl.h"
 #include "google/cloud/testing_util/is_proto_equal.h"
+#include "google/cloud/testing_util/mock_async_response_reader.h"
 #include "google/cloud/testing_util/status_matchers.h"
 #include "absl/memory/memory.h"
 #include "absl/types/optional.h"
@@ -57,7 +59,9 @@ namespace {
 #endif
 
 using ::google::cloud::spanner_testing::HasSessionAndTransactionId;
+using ::google::cloud::testing_util::FakeCompletionQueueImpl;
 using ::google::cloud::testing_util::IsProtoEqual;
+using ::google::cloud::testing_util::MockAsyncResponseReader;
 using ::google::cloud::testing_util::StatusIs;
 using ::google::protobuf::TextFormat;
 using ::testing::_;
@@ -1472,6 +1476,53 @@ TEST(ConnectionImplTest, CommitBeginTransactionRetry) {
   EXPECT_EQ(commit_timestamp, commit->commit_timestamp);
 }
 
+TEST(ConnectionImplTest, CommitWithWritePreparedSession) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock, BatchCreateSessions(_, HasDatabase(db)))
+      .WillOnce(Return(MakeSessionsResponse({"test-session-name"})));
+  auto reader = absl::make_unique<
+      MockAsyncResponseReader<spanner_proto::Transaction>>();
+  EXPECT_CALL(*mock, AsyncBeginTransaction(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::BeginTransactionRequest const&,
+                          grpc::CompletionQueue*) {
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::Transaction>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::Transaction* transaction,
+                   grpc::Status* status, void*) {
+        transaction->set_id("prepared-txn");
+        *status = grpc::Status::OK;
+      });
+  // The transaction begun by the session pool is used, so there is no need
+  // for a `BeginTransaction()` call before the `Commit()`.
+  EXPECT_CALL(*mock, BeginTransaction(_, _)).Times(0);
+  auto const commit_timestamp =
+      MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value();
+  EXPECT_CALL(*mock, Commit(_, AllOf(HasSession("test-session-name"),
+                                     HasNakedTransactionId("prepared-txn"))))
+      .WillOnce(Return(MakeCommitResponse(commit_timestamp)));
+
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto conn = MakeConnection(
+      db, {mock},
+      ConnectionOptions{grpc::InsecureChannelCredentials()}
+          .DisableBackgroundThreads(CompletionQueue(impl)),
+      SessionPoolOptions{}.set_min_sessions(1).set_write_sessions_fraction(
+          1.0));
+  // Run the session pool background work, and complete the
+  // `AsyncBeginTransaction()` call it starts.
+  impl->SimulateCompletion(true);
+  impl->SimulateCompletion(true);
+
+  auto commit = conn->Commit({MakeReadWriteTransaction()});
+  ASSERT_STATUS_OK(commit);
+  EXPECT_EQ(commit_timestamp, commit->commit_timestamp);
+}
+
 TEST(ConnectionImplTest, CommitBeginTransactionSessionNotFound) {
   auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
   auto db = Database("dummy_project", "dummy_instance", "dummy_database_id");
@@ -2413,6 +2464,123 @@ TEST(ConnectionImplTest, OperationsFailOnInvalidatedTransaction) {
                        HasSubstr("BeginTransaction failed")));
 }
 
+TEST(ConnectionImplTest, AsyncReadGetSessionFailure) {
+  auto db = Database("project", "instance", "database");
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto reader = absl::make_unique<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>();
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::BatchCreateSessionsRequest const&,
+                          grpc::CompletionQueue*) {
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::BatchCreateSessionsResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::BatchCreateSessionsResponse*,
+                   grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::PERMISSION_DENIED,
+                               "uh-oh in GetSession");
+      });
+  EXPECT_CALL(*mock, PrepareAsyncStreamingRead(_, _, _)).Times(0);
+
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto conn = MakeConnection(
+      db, {mock},
+      ConnectionOptions{grpc::InsecureChannelCredentials()}
+          .DisableBackgroundThreads(CompletionQueue(impl)));
+  auto rows = conn->AsyncRead(
+      {MakeSingleUseTransaction(Transaction::ReadOnlyOptions()),
+       "table",
+       KeySet::All(),
+       {"column1"}});
+  impl->SimulateCompletion(true);
+  auto row = rows.get().Next().get();
+  EXPECT_THAT(row, StatusIs(StatusCode::kPermissionDenied,
+                            HasSubstr("uh-oh in GetSession")));
+}
+
+TEST(ConnectionImplTest, AsyncCommitSuccess) {
+  auto db = Database("project", "instance", "database");
+  std::string const session_name = "test-session-name";
+  std::string const transaction_id = "test-txn-id";
+  auto const commit_timestamp =
+      MakeTimestamp(std::chrono::system_clock::from_time_t(123)).value();
+
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, HasDatabase(db)))
+      .WillOnce(Return(MakeSessionsResponse({session_name})));
+  auto reader = absl::make_unique<
+      MockAsyncResponseReader<spanner_proto::CommitResponse>>();
+  EXPECT_CALL(*mock, AsyncCommit(_, _, _))
+      .WillOnce([&](grpc::ClientContext&,
+                    spanner_proto::CommitRequest const& request,
+                    grpc::CompletionQueue*) {
+        EXPECT_EQ(session_name, request.session());
+        EXPECT_EQ(transaction_id, request.transaction_id());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::CommitResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([&](spanner_proto::CommitResponse* response,
+                    grpc::Status* status, void*) {
+        *response = MakeCommitResponse(commit_timestamp);
+        *status = grpc::Status::OK;
+      });
+
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto conn = MakeConnection(
+      db, {mock},
+      ConnectionOptions{grpc::InsecureChannelCredentials()}
+          .DisableBackgroundThreads(CompletionQueue(impl)),
+      SessionPoolOptions{}.set_min_sessions(1));
+  auto txn = MakeReadWriteTransaction();
+  SetTransactionId(txn, transaction_id);
+  auto commit = conn->AsyncCommit({txn});
+  // The commit does not block the calling thread.
+  EXPECT_EQ(std::future_status::timeout,
+            commit.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  auto result = commit.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(commit_timestamp, result->commit_timestamp);
+}
+
+TEST(ConnectionImplTest, AsyncCommitInvalidatedTransaction) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _)).Times(0);
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, _, _)).Times(0);
+  EXPECT_CALL(*mock, AsyncCommit(_, _, _)).Times(0);
+
+  auto db = Database("project", "instance", "database");
+  auto conn = MakeConnection(
+      db, {mock}, ConnectionOptions{grpc::InsecureChannelCredentials()});
+  auto txn = MakeReadWriteTransaction();
+  SetTransactionInvalid(txn,
+                        Status(StatusCode::kAlreadyExists, "constraint error"));
+  auto commit = conn->AsyncCommit({txn}).get();
+  EXPECT_THAT(commit, StatusIs(StatusCode::kAlreadyExists,
+                               HasSubstr("constraint error")));
+}
+
+TEST(ConnectionImplTest, AsyncRollbackSingleUseTransaction) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _)).Times(0);
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, _, _)).Times(0);
+  EXPECT_CALL(*mock, AsyncRollback(_, _, _)).Times(0);
+
+  auto db = Database("project", "instance", "database");
+  auto conn = MakeConnection(
+      db, {mock}, ConnectionOptions{grpc::InsecureChannelCredentials()});
+  auto txn = internal::MakeSingleUseTransaction(
+      Transaction::SingleUseOptions{Transaction::ReadOnlyOptions{}});
+  auto rollback = conn->AsyncRollback({txn}).get();
+  EXPECT_THAT(rollback, StatusIs(StatusCode::kInvalidArgument,
+                                 HasSubstr("Cannot rollback")));
+}
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic pop
 #endif
@@ -0,0 +1,318 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/counting_spanner_stub.h"
+#include "absl/memory/memory.h"
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+void RpcCounters::Start() {
+  ++total;
+  auto const count = ++outstanding;
+  auto max = max_outstanding.load();
+  while (count > max && !max_outstanding.compare_exchange_weak(max, count)) {
+  }
+}
+
+namespace {
+
+// Counts a unary RPC while it is in scope.
+class UnaryRpc {
+ public:
+  explicit UnaryRpc(RpcCounters& counters) : counters_(counters) {
+    counters_.Start();
+  }
+  ~UnaryRpc() { counters_.Done(); }
+
+  UnaryRpc(UnaryRpc const&) = delete;
+  UnaryRpc& operator=(UnaryRpc const&) = delete;
+
+ private:
+  RpcCounters& counters_;
+};
+
+// Counts a streaming RPC until it is finished, or the stream is destroyed.
+class StreamingRpc {
+ public:
+  explicit StreamingRpc(std::shared_ptr<RpcCounters> counters)
+      : counters_(std::move(counters)) {
+    counters_->Start();
+  }
+  ~StreamingRpc() { Done(); }
+
+  StreamingRpc(StreamingRpc const&) = delete;
+  StreamingRpc& operator=(StreamingRpc const&) = delete;
+
+  void Done() {
+    if (!counters_) return;
+    counters_->Done();
+    counters_.reset();
+  }
+
+ private:
+  std::shared_ptr<RpcCounters> counters_;
+};
+
+template <typename Response>
+class CountingReader : public grpc::ClientReaderInterface<Response> {
+ public:
+  CountingReader(std::unique_ptr<grpc::ClientReaderInterface<Response>> child,
+                 std::shared_ptr<RpcCounters> counters)
+      : child_(std::move(child)), rpc_(std::move(counters)) {}
+
+  bool NextMessageSize(std::uint32_t* sz) override {
+    return child_->NextMessageSize(sz);
+  }
+  bool Read(Response* msg) override { return child_->Read(msg); }
+  void WaitForInitialMetadata() override { child_->WaitForInitialMetadata(); }
+  grpc::Status Finish() override {
+    auto status = child_->Finish();
+    rpc_.Done();
+    return status;
+  }
+
+ private:
+  std::unique_ptr<grpc::ClientReaderInterface<Response>> child_;
+  StreamingRpc rpc_;
+};
+
+// `Finish()` completes on the completion queue, so the RPC is counted until
+// the owner of the stream destroys it.
+template <typename Response>
+class CountingAsyncReader : public grpc::ClientAsyncReaderInterface<Response> {
+ public:
+  CountingAsyncReader(
+      std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> child,
+      std::shared_ptr<RpcCounters> counters)
+      : child_(std::move(child)), rpc_(std::move(counters)) {}
+
+  void StartCall(void* tag) override { child_->StartCall(tag); }
+  void ReadInitialMetadata(void* tag) override {
+    child_->ReadInitialMetadata(tag);
+  }
+  void Read(Response* msg, void* tag) override { child_->Read(msg, tag); }
+  void Finish(grpc::Status* status, void* tag) override {
+    child_->Finish(status, tag);
+  }
+
+ private:
+  std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> child_;
+  StreamingRpc rpc_;
+};
+
+template <typename Response>
+std::unique_ptr<grpc::ClientReaderInterface<Response>> CountStream(
+    std::unique_ptr<grpc::ClientReaderInterface<Response>> child,
+    std::shared_ptr<RpcCounters> counters) {
+  if (!child) return child;
+  return absl::make_unique<CountingReader<Response>>(std::move(child),
+                                                     std::move(counters));
+}
+
+template <typename Response>
+std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> CountStream(
+    std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> child,
+    std::shared_ptr<RpcCounters> counters) {
+  if (!child) return child;
+  return absl::make_unique<CountingAsyncReader<Response>>(std::move(child),
+                                                          std::move(counters));
+}
+
+}  // namespace
+
+StatusOr<spanner_proto::Session> CountingSpannerStub::CreateSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::CreateSessionRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->CreateSession(client_context, request);
+}
+
+StatusOr<spanner_proto::BatchCreateSessionsResponse>
+CountingSpannerStub::BatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->BatchCreateSessions(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+    spanner_proto::BatchCreateSessionsResponse>>
+CountingSpannerStub::AsyncBatchCreateSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::BatchCreateSessionsRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncBatchCreateSessions(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::Session> CountingSpannerStub::GetSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::GetSessionRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->GetSession(client_context, request);
+}
+
+StatusOr<spanner_proto::ListSessionsResponse> CountingSpannerStub::ListSessions(
+    grpc::ClientContext& client_context,
+    spanner_proto::ListSessionsRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->ListSessions(client_context, request);
+}
+
+Status CountingSpannerStub::DeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->DeleteSession(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+CountingSpannerStub::AsyncDeleteSession(
+    grpc::ClientContext& client_context,
+    spanner_proto::DeleteSessionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncDeleteSession(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::ResultSet> CountingSpannerStub::ExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->ExecuteSql(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+CountingSpannerStub::AsyncExecuteSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncExecuteSql(client_context, request, cq);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+CountingSpannerStub::ExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request) {
+  return CountStream(child_->ExecuteStreamingSql(client_context, request),
+                     counters_);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+CountingSpannerStub::PrepareAsyncExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return CountStream(
+      child_->PrepareAsyncExecuteStreamingSql(client_context, request, cq),
+      counters_);
+}
+
+StatusOr<spanner_proto::ExecuteBatchDmlResponse>
+CountingSpannerStub::ExecuteBatchDml(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteBatchDmlRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->ExecuteBatchDml(client_context, request);
+}
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+CountingSpannerStub::StreamingRead(grpc::ClientContext& client_context,
+                                   spanner_proto::ReadRequest const& request) {
+  return CountStream(child_->StreamingRead(client_context, request),
+                     counters_);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+CountingSpannerStub::PrepareAsyncStreamingRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::ReadRequest const& request, grpc::CompletionQueue* cq) {
+  return CountStream(
+      child_->PrepareAsyncStreamingRead(client_context, request, cq),
+      counters_);
+}
+
+StatusOr<spanner_proto::Transaction> CountingSpannerStub::BeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->BeginTransaction(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::Transaction>>
+CountingSpannerStub::AsyncBeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return child_->AsyncBeginTransaction(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::CommitResponse> CountingSpannerStub::Commit(
+    grpc::ClientContext& client_context,
+    spanner_proto::CommitRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->Commit(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+CountingSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  return child_->AsyncCommit(client_context, request, cq);
+}
+
+Status CountingSpannerStub::Rollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->Rollback(client_context, request);
+}
+
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+CountingSpannerStub::AsyncRollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request, grpc::CompletionQueue* cq) {
+  return child_->AsyncRollback(client_context, request, cq);
+}
+
+StatusOr<spanner_proto::PartitionResponse> CountingSpannerStub::PartitionQuery(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionQueryRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->PartitionQuery(client_context, request);
+}
+
+StatusOr<spanner_proto::PartitionResponse> CountingSpannerStub::PartitionRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::PartitionReadRequest const& request) {
+  UnaryRpc rpc(*counters_);
+  return child_->PartitionRead(client_context, request);
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,143 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/counting_spanner_stub.h"
+#include "google/cloud/spanner/testing/mock_spanner_stub.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::StatusIs;
+using ::testing::_;
+using ::testing::ByMove;
+using ::testing::Return;
+
+namespace spanner_proto = ::google::spanner::v1;
+
+class FakeReader
+    : public grpc::ClientReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  bool NextMessageSize(std::uint32_t*) override { return false; }
+  bool Read(spanner_proto::PartialResultSet*) override { return false; }
+  void WaitForInitialMetadata() override {}
+  grpc::Status Finish() override { return grpc::Status::OK; }
+};
+
+class FakeAsyncReader
+    : public grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet> {
+ public:
+  void StartCall(void*) override {}
+  void ReadInitialMetadata(void*) override {}
+  void Read(spanner_proto::PartialResultSet*, void*) override {}
+  void Finish(grpc::Status*, void*) override {}
+};
+
+std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+MakeReader() {
+  return absl::make_unique<FakeReader>();
+}
+
+TEST(CountingSpannerStub, UnaryRpc) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  CountingSpannerStub stub(mock);
+  EXPECT_CALL(*mock, Commit(_, _))
+      .WillOnce([&stub](grpc::ClientContext&,
+                        spanner_proto::CommitRequest const&) {
+        EXPECT_EQ(1, stub.outstanding_rpcs());
+        return Status(StatusCode::kUnavailable, "try-again");
+      });
+
+  grpc::ClientContext context;
+  auto response = stub.Commit(context, spanner_proto::CommitRequest());
+  EXPECT_THAT(response, StatusIs(StatusCode::kUnavailable));
+  EXPECT_EQ(0, stub.outstanding_rpcs());
+  EXPECT_EQ(1, stub.max_outstanding_rpcs());
+  EXPECT_EQ(1, stub.total_rpcs());
+}
+
+TEST(CountingSpannerStub, StreamingRpc) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, ExecuteStreamingSql(_, _))
+      .WillOnce(Return(ByMove(MakeReader())))
+      .WillOnce(Return(ByMove(MakeReader())));
+  CountingSpannerStub stub(mock);
+
+  grpc::ClientContext c1;
+  auto s1 = stub.ExecuteStreamingSql(c1, spanner_proto::ExecuteSqlRequest());
+  grpc::ClientContext c2;
+  auto s2 = stub.ExecuteStreamingSql(c2, spanner_proto::ExecuteSqlRequest());
+  EXPECT_EQ(2, stub.outstanding_rpcs());
+
+  // A stream is counted until it is finished, or destroyed.
+  EXPECT_TRUE(s1->Finish().ok());
+  EXPECT_EQ(1, stub.outstanding_rpcs());
+  s1.reset();
+  EXPECT_EQ(1, stub.outstanding_rpcs());
+  s2.reset();
+  EXPECT_EQ(0, stub.outstanding_rpcs());
+  EXPECT_EQ(2, stub.max_outstanding_rpcs());
+  EXPECT_EQ(2, stub.total_rpcs());
+}
+
+TEST(CountingSpannerStub, AsyncStreamingRpc) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, PrepareAsyncStreamingRead(_, _, _))
+      .WillOnce([](grpc::ClientContext&, spanner_proto::ReadRequest const&,
+                   grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>(
+            absl::make_unique<FakeAsyncReader>());
+      });
+  CountingSpannerStub stub(mock);
+
+  grpc::ClientContext context;
+  auto stream = stub.PrepareAsyncStreamingRead(
+      context, spanner_proto::ReadRequest(), nullptr);
+  ASSERT_NE(nullptr, stream);
+  EXPECT_EQ(1, stub.outstanding_rpcs());
+  stream.reset();
+  EXPECT_EQ(0, stub.outstanding_rpcs());
+  EXPECT_EQ(1, stub.total_rpcs());
+}
+
+TEST(CountingSpannerStub, NullStream) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, StreamingRead(_, _))
+      .WillOnce([](grpc::ClientContext&, spanner_proto::ReadRequest const&) {
+        return std::unique_ptr<
+            grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>{};
+      });
+  CountingSpannerStub stub(mock);
+
+  grpc::ClientContext context;
+  auto stream = stub.StreamingRead(context, spanner_proto::ReadRequest());
+  EXPECT_EQ(nullptr, stream);
+  EXPECT_EQ(0, stub.outstanding_rpcs());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
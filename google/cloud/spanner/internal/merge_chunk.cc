@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "google/cloud/spanner/internal/merge_chunk.h"
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -52,18 +53,23 @@ Status MergeChunk(google::protobuf::Value& value,  // NOLINT(misc-no-recursion)
 
       // Recursively merge the last element of value_list with the first
       // element of chunk_list if necessary.
-      auto value_it = value_list.rbegin();
-      auto chunk_it = chunk_list.begin();
-      if (value_it->kind_case() == google::protobuf::Value::kStringValue ||
-          value_it->kind_case() == google::protobuf::Value::kListValue) {
-        auto status = MergeChunk(*value_it, std::move(*chunk_it++));
+      int first = 0;
+      auto& last = *value_list.rbegin();
+      if (last.kind_case() == google::protobuf::Value::kStringValue ||
+          last.kind_case() == google::protobuf::Value::kListValue) {
+        auto status = MergeChunk(last, std::move(chunk_list[first++]));
         if (!status.ok()) return status;
       }
 
-      // Moves all the remaining elements over.
-      while (chunk_it != chunk_list.end()) {
-        *value.mutable_list_value()->add_values() = std::move(*chunk_it++);
-      }
+      // Splices the remaining elements over. Releasing them from chunk_list
+      // and adding them to value_list only moves pointers, no elements are
+      // allocated nor copied.
+      auto const count = chunk_list.size() - first;
+      if (count == 0) return Status();
+      std::vector<google::protobuf::Value*> elements(count);
+      chunk_list.ExtractSubrange(first, count, elements.data());
+      value_list.Reserve(value_list.size() + count);
+      for (auto* e : elements) value_list.AddAllocated(e);
 
       return Status();
     }
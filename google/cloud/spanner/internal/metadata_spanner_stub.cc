@@ -112,6 +112,16 @@ MetadataSpannerStub::ExecuteStreamingSql(
   return child_->ExecuteStreamingSql(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+MetadataSpannerStub::PrepareAsyncExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->PrepareAsyncExecuteStreamingSql(client_context, request, cq);
+}
+
 StatusOr<spanner_proto::ExecuteBatchDmlResponse>
 MetadataSpannerStub::ExecuteBatchDml(
     grpc::ClientContext& client_context,
@@ -127,6 +137,15 @@ MetadataSpannerStub::StreamingRead(grpc::ClientContext& client_context,
   return child_->StreamingRead(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+MetadataSpannerStub::PrepareAsyncStreamingRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::ReadRequest const& request, grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->PrepareAsyncStreamingRead(client_context, request, cq);
+}
+
 StatusOr<spanner_proto::Transaction> MetadataSpannerStub::BeginTransaction(
     grpc::ClientContext& client_context,
     spanner_proto::BeginTransactionRequest const& request) {
@@ -134,6 +153,16 @@ StatusOr<spanner_proto::Transaction> MetadataSpannerStub::BeginTransaction(
   return child_->BeginTransaction(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::Transaction>>
+MetadataSpannerStub::AsyncBeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->AsyncBeginTransaction(client_context, request, cq);
+}
+
 StatusOr<spanner_proto::CommitResponse> MetadataSpannerStub::Commit(
     grpc::ClientContext& client_context,
     spanner_proto::CommitRequest const& request) {
@@ -141,6 +170,15 @@ StatusOr<spanner_proto::CommitResponse> MetadataSpannerStub::Commit(
   return child_->Commit(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+MetadataSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                 spanner_proto::CommitRequest const& request,
+                                 grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->AsyncCommit(client_context, request, cq);
+}
+
 Status MetadataSpannerStub::Rollback(
     grpc::ClientContext& client_context,
     spanner_proto::RollbackRequest const& request) {
@@ -148,6 +186,15 @@ Status MetadataSpannerStub::Rollback(
   return child_->Rollback(client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+MetadataSpannerStub::AsyncRollback(
+    grpc::ClientContext& client_context,
+    spanner_proto::RollbackRequest const& request, grpc::CompletionQueue* cq) {
+  SetMetadata(client_context, "session=" + request.session());
+  return child_->AsyncRollback(client_context, request, cq);
+}
+
 StatusOr<spanner_proto::PartitionResponse> MetadataSpannerStub::PartitionQuery(
     grpc::ClientContext& client_context,
     spanner_proto::PartitionQueryRequest const& request) {
@@ -15,6 +15,9 @@
 #include "google/cloud/spanner/internal/partial_result_set_source.h"
 #include "google/cloud/spanner/internal/merge_chunk.h"
 #include "google/cloud/log.h"
+#include <cstddef>
+#include <iterator>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -34,7 +37,7 @@ StatusOr<std::unique_ptr<ResultSourceInterface>> PartialResultSetSource::Create(
   }
 
   // The first response must contain metadata.
-  if (!source->metadata_) {
+  if (!source->assembler_.metadata()) {
     return Status(StatusCode::kInternal, "response contained no metadata");
   }
 
@@ -46,38 +49,53 @@ StatusOr<Row> PartialResultSetSource::NextRow() {
     return Row();
   }
 
-  while (buffer_.empty() || buffer_.size() < columns_->size()) {
+  while (!assembler_.HasRow()) {
     auto status = ReadFromStream();
     if (!status.ok()) {
       return status;
     }
     if (finished_) {
-      if (chunk_) {
-        return Status(StatusCode::kInternal,
-                      "incomplete chunked_value at end of stream");
-      }
-      if (!buffer_.empty()) {
-        return Status(StatusCode::kInternal, "incomplete row at end of stream");
-      }
+      status = assembler_.Finish();
+      if (!status.ok()) return status;
       return Row();
     }
   }
+  return assembler_.PopRow();
+}
 
-  auto const& fields = metadata_->row_type().fields();
-  if (fields.empty()) {
-    return Status(StatusCode::kInternal,
-                  "response metadata is missing row type information");
+StatusOr<absl::optional<ColumnBatch>> PartialResultSetSource::NextBatch() {
+  if (finished_) return absl::optional<ColumnBatch>();
+
+  while (!assembler_.HasRow()) {
+    auto status = ReadFromStream();
+    if (!status.ok()) return status;
+    if (finished_) {
+      status = assembler_.Finish();
+      if (!status.ok()) return status;
+      return absl::optional<ColumnBatch>();
+    }
   }
+  auto batch = assembler_.PopBatch();
+  if (!batch) return std::move(batch).status();
+  return absl::optional<ColumnBatch>(*std::move(batch));
+}
 
-  std::vector<Value> values;
-  values.reserve(fields.size());
-  auto iter = buffer_.begin();
-  for (auto const& field : fields) {
-    values.push_back(FromProto(field.type(), std::move(*iter)));
-    ++iter;
+StatusOr<bool> PartialResultSetSource::NextRowValues(
+    std::vector<google::protobuf::Value>& values) {
+  if (finished_) return false;
+
+  while (!assembler_.HasRow()) {
+    auto status = ReadFromStream();
+    if (!status.ok()) return status;
+    if (finished_) {
+      status = assembler_.Finish();
+      if (!status.ok()) return status;
+      return false;
+    }
   }
-  buffer_.erase(buffer_.begin(), iter);
-  return internal::MakeRow(std::move(values), columns_);
+  auto status = assembler_.PopRowValues(values);
+  if (!status.ok()) return status;
+  return true;
 }
 
 PartialResultSetSource::~PartialResultSetSource() {
@@ -103,31 +121,37 @@ Status PartialResultSetSource::ReadFromStream() {
     finished_ = true;
     return reader_->Finish();
   }
+  return assembler_.Append(*std::move(result_set));
+}
 
-  if (result_set->has_metadata()) {
+Status PartialResultSetAssembler::Append(
+    google::spanner::v1::PartialResultSet result_set) {
+  if (result_set.has_metadata()) {
     // If we got metadata more than once, log it, but use the first one.
     if (metadata_) {
       GCP_LOG(WARNING) << "Unexpectedly received two sets of metadata";
     } else {
-      metadata_ = std::move(*result_set->mutable_metadata());
+      metadata_ = std::move(*result_set.mutable_metadata());
       // Copies the column names into a shared_ptr that will be shared with
-      // every Row object returned from NextRow().
-      columns_ = std::make_shared<std::vector<std::string>>();
+      // every Row object returned from PopRow(). The names are indexed once
+      // here, so `Row::get(name)` does not need to search them.
+      std::vector<std::string> names;
       for (auto const& field : metadata_->row_type().fields()) {
-        columns_->push_back(field.name());
+        names.push_back(field.name());
       }
+      columns_ = std::make_shared<IndexedColumns>(std::move(names));
     }
   }
 
-  if (result_set->has_stats()) {
+  if (result_set.has_stats()) {
     // If we got stats more than once, log it, but use the last one.
     if (stats_) {
       GCP_LOG(WARNING) << "Unexpectedly received two sets of stats";
     }
-    stats_ = std::move(*result_set->mutable_stats());
+    stats_ = std::move(*result_set.mutable_stats());
   }
 
-  auto& new_values = *result_set->mutable_values();
+  auto& new_values = *result_set.mutable_values();
 
   // Merge values if necessary, as described in:
   // https://cloud.google.com/spanner/docs/reference/rpc/google.spanner.v1#google.spanner.v1.PartialResultSet
@@ -162,7 +186,7 @@ Status PartialResultSetSource::ReadFromStream() {
     chunk_ = {};
   }
 
-  if (result_set->chunked_value()) {
+  if (result_set.chunked_value()) {
     if (new_values.empty()) {
       return Status(StatusCode::kInternal,
                     "PartialResultSet had chunked_value "
@@ -172,14 +196,89 @@ Status PartialResultSetSource::ReadFromStream() {
     new_values.RemoveLast();
   }
 
-  // Moves all the remaining in new_values to buffer_
-  for (auto& value_proto : new_values) {
-    buffer_.push_back(std::move(value_proto));
+  // Moves all the remaining in new_values to buffer_. In the common case
+  // every value already in the buffer has been consumed, and the new values
+  // simply replace them.
+  if (head_ == buffer_.size()) {
+    buffer_.Swap(&new_values);
+    head_ = 0;
+    return {};  // OK
   }
+  buffer_.DeleteSubrange(0, head_);
+  head_ = 0;
+  if (new_values.empty()) return {};  // OK
+  std::vector<google::protobuf::Value*> released(new_values.size());
+  new_values.ExtractSubrange(0, new_values.size(), released.data());
+  buffer_.Reserve(buffer_.size() + static_cast<int>(released.size()));
+  for (auto* v : released) buffer_.AddAllocated(v);
 
   return {};  // OK
 }
 
+StatusOr<Row> PartialResultSetAssembler::PopRow() {
+  auto const& fields = metadata_->row_type().fields();
+  if (fields.empty()) {
+    return Status(StatusCode::kInternal,
+                  "response metadata is missing row type information");
+  }
+
+  std::vector<Value> values;
+  values.reserve(fields.size());
+  for (auto const& field : fields) {
+    values.push_back(FromProto(field.type(), std::move(buffer_[head_++])));
+  }
+  return internal::MakeRow(std::move(values), columns_);
+}
+
+StatusOr<ColumnBatch> PartialResultSetAssembler::PopBatch() {
+  auto const& row_type = metadata_->row_type();
+  auto const columns = static_cast<std::size_t>(row_type.fields_size());
+  if (columns == 0) {
+    return Status(StatusCode::kInternal,
+                  "response metadata is missing row type information");
+  }
+
+  auto const rows = static_cast<std::size_t>(buffer_.size() - head_) / columns;
+  ColumnBatchBuilder builder(
+      row_type,
+      std::shared_ptr<std::vector<std::string> const>(columns_,
+                                                      &columns_->names));
+  builder.Reserve(rows);
+  auto const end = head_ + static_cast<int>(rows * columns);
+  std::size_t index = 0;
+  for (; head_ != end; ++head_) {
+    auto status = builder.Append(index, std::move(buffer_[head_]));
+    if (!status.ok()) return status;
+    if (++index == columns) index = 0;
+  }
+  return std::move(builder).Build();
+}
+
+Status PartialResultSetAssembler::PopRowValues(
+    std::vector<google::protobuf::Value>& values) {
+  auto const columns = columns_->names.size();
+  if (columns == 0) {
+    return Status(StatusCode::kInternal,
+                  "response metadata is missing row type information");
+  }
+  auto const begin = buffer_.begin() + head_;
+  head_ += static_cast<int>(columns);
+  values.assign(std::make_move_iterator(begin),
+                std::make_move_iterator(buffer_.begin() + head_));
+  return {};
+}
+
+Status PartialResultSetAssembler::Finish() const {
+  if (chunk_) {
+    return Status(StatusCode::kInternal,
+                  "incomplete chunked_value at end of stream");
+  }
+  if (head_ != buffer_.size()) {
+    return Status(StatusCode::kInternal, "incomplete row at end of stream");
+  }
+  return {};
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTIAL_RESULT_SET_SOURCE_H
 
 #include "google/cloud/spanner/internal/partial_result_set_reader.h"
+#include "google/cloud/spanner/column_batch.h"
 #include "google/cloud/spanner/results.h"
 #include "google/cloud/spanner/value.h"
 #include "google/cloud/spanner/version.h"
@@ -24,9 +25,12 @@
 #include "absl/types/optional.h"
 #include <google/spanner/v1/spanner.grpc.pb.h>
 #include <google/spanner/v1/spanner.pb.h>
+#include <google/protobuf/repeated_field.h>
 #include <grpcpp/grpcpp.h>
-#include <deque>
+#include <cstddef>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -34,6 +38,59 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 namespace internal {
 
+/**
+ * Assembles the values in a sequence of `PartialResultSet` messages into rows.
+ *
+ * This class performs no I/O. It is shared by the synchronous and the
+ * asynchronous result sources, which differ only in how they obtain the
+ * `PartialResultSet` messages.
+ */
+class PartialResultSetAssembler {
+ public:
+  /// Consumes @p result_set, merging any chunked values.
+  Status Append(google::spanner::v1::PartialResultSet result_set);
+
+  /// Returns true if `PopRow()` can return a row (or a malformed row error).
+  bool HasRow() const {
+    auto const available = static_cast<std::size_t>(buffer_.size() - head_);
+    return available != 0 &&
+           available >= (columns_ ? columns_->names.size() : 0);
+  }
+
+  /// Removes the next row from the buffer, requires `HasRow()`.
+  StatusOr<Row> PopRow();
+
+  /// Removes all the complete rows from the buffer, requires `HasRow()`.
+  StatusOr<ColumnBatch> PopBatch();
+
+  /// Moves the values of the next row into @p values, requires `HasRow()`.
+  Status PopRowValues(std::vector<google::protobuf::Value>& values);
+
+  /// Validates that no partial values or rows remain at the end of a stream.
+  Status Finish() const;
+
+  absl::optional<google::spanner::v1::ResultSetMetadata> const& metadata()
+      const {
+    return metadata_;
+  }
+  absl::optional<google::spanner::v1::ResultSetStats> const& stats() const {
+    return stats_;
+  }
+
+ private:
+  absl::optional<google::spanner::v1::ResultSetMetadata> metadata_;
+  absl::optional<google::spanner::v1::ResultSetStats> stats_;
+  // The values received, but not yet returned, are `buffer_[head_]` and
+  // onwards. The consumed values are only removed when the next response is
+  // appended, which avoids shifting the buffer for each row. If all of them
+  // were consumed the buffer is simply swapped with the values in the new
+  // response.
+  google::protobuf::RepeatedPtrField<google::protobuf::Value> buffer_;
+  int head_ = 0;
+  absl::optional<google::protobuf::Value> chunk_;
+  std::shared_ptr<IndexedColumns const> columns_;
+};
+
 /**
  * This class serves as a bridge between the gRPC `PartialResultSet` streaming
  * reader and the spanner `ResultSet`, which is used to iterate over the rows
@@ -48,13 +105,16 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
   ~PartialResultSetSource() override;
 
   StatusOr<Row> NextRow() override;
+  StatusOr<absl::optional<ColumnBatch>> NextBatch() override;
+  StatusOr<bool> NextRowValues(
+      std::vector<google::protobuf::Value>& values) override;
 
   absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
-    return metadata_;
+    return assembler_.metadata();
   }
 
   absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
-    return stats_;
+    return assembler_.stats();
   }
 
  private:
@@ -65,11 +125,7 @@ class PartialResultSetSource : public internal::ResultSourceInterface {
   Status ReadFromStream();
 
   std::unique_ptr<PartialResultSetReader> reader_;
-  absl::optional<google::spanner::v1::ResultSetMetadata> metadata_;
-  absl::optional<google::spanner::v1::ResultSetStats> stats_;
-  std::deque<google::protobuf::Value> buffer_;
-  absl::optional<google::protobuf::Value> chunk_;
-  std::shared_ptr<std::vector<std::string>> columns_;
+  PartialResultSetAssembler assembler_;
   bool finished_ = false;
 };
 
@@ -25,6 +25,7 @@
 #include <array>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -39,6 +40,7 @@ using ::google::cloud::spanner_testing::MockPartialResultSetReader;
 using ::google::cloud::testing_util::IsProtoEqual;
 using ::google::cloud::testing_util::StatusIs;
 using ::google::protobuf::TextFormat;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::Return;
 
@@ -343,6 +345,192 @@ TEST(PartialResultSetSourceTest, MultipleResponses) {
   EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(Row{}));
 }
 
+/// @test Verify rows that start in a partially consumed response.
+TEST(PartialResultSetSourceTest, RowsSpanResponses) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<char const*, 3> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "22" }
+      )pb",
+      R"pb(
+        values: { string_value: "user22" }
+        values: { string_value: "33" }
+        values: { string_value: "user33" }
+        values: { string_value: "44" }
+      )pb",
+      R"pb(
+        values: { string_value: "user44" }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(response[2]))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  for (auto id : {10, 22, 33, 44}) {
+    SCOPED_TRACE("Reading row " + std::to_string(id));
+    EXPECT_THAT((*reader)->NextRow(),
+                IsValidAndEquals(MakeTestRow({
+                    {"UserId", Value(id)},
+                    {"UserName", Value("user" + std::to_string(id))},
+                })));
+  }
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(Row{}));
+}
+
+/// @test Verify rows can be read in batches, mixed with `NextRow()`.
+TEST(PartialResultSetSourceTest, NextBatch) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  std::array<char const*, 3> text{{
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "22" }
+        values: { string_value: "user22" }
+        values: { string_value: "99" }
+        values: { string_value: "user" }
+        chunked_value: true
+      )pb",
+      R"pb(
+        values: { string_value: "99" }
+        values: { string_value: "100" }
+        values: { null_value: NULL_VALUE }
+      )pb",
+      R"pb(
+        values: { string_value: "101" }
+        values: { string_value: "user101" }
+      )pb",
+  }};
+  std::array<spanner_proto::PartialResultSet, text.size()> response;
+  for (std::size_t i = 0; i != text.size(); ++i) {
+    SCOPED_TRACE("Converting text to proto [" + std::to_string(i) + "]");
+    ASSERT_TRUE(TextFormat::ParseFromString(text[i], &response[i]));
+  }
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response[0]))
+      .WillOnce(Return(response[1]))
+      .WillOnce(Return(response[2]))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  // The first batch has the complete rows in the first response.
+  auto batch = (*reader)->NextBatch();
+  ASSERT_STATUS_OK(batch);
+  ASSERT_TRUE(batch->has_value());
+  auto const& b1 = **batch;
+  EXPECT_THAT(b1.column_names(), ElementsAre("UserId", "UserName"));
+  EXPECT_THAT(b1.column(0).int64_values(), ElementsAre(10, 22));
+  EXPECT_EQ("user10", b1.column(1).string_value(0));
+  EXPECT_EQ("user22", b1.column(1).string_value(1));
+
+  // The chunked value is merged before the next batch is returned.
+  batch = (*reader)->NextBatch();
+  ASSERT_STATUS_OK(batch);
+  ASSERT_TRUE(batch->has_value());
+  auto const& b2 = **batch;
+  ASSERT_EQ(2, b2.num_rows());
+  EXPECT_THAT(b2.column(0).int64_values(), ElementsAre(99, 100));
+  EXPECT_EQ("user99", b2.column(1).string_value(0));
+  EXPECT_TRUE(b2.column(1).IsNull(1));
+
+  EXPECT_THAT((*reader)->NextRow(), IsValidAndEquals(MakeTestRow({
+                                        {"UserId", Value(101)},
+                                        {"UserName", Value("user101")},
+                                    })));
+
+  // At end of stream, we get an 'ok' response with no batch.
+  batch = (*reader)->NextBatch();
+  ASSERT_STATUS_OK(batch);
+  EXPECT_FALSE(batch->has_value());
+  batch = (*reader)->NextBatch();
+  ASSERT_STATUS_OK(batch);
+  EXPECT_FALSE(batch->has_value());
+}
+
+/// @test Verify the values of each row can be moved out of the source.
+TEST(PartialResultSetSourceTest, NextRowValues) {
+  auto grpc_reader = absl::make_unique<MockPartialResultSetReader>();
+  spanner_proto::PartialResultSet response;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      R"pb(
+        metadata: {
+          row_type: {
+            fields: {
+              name: "UserId",
+              type: { code: INT64 }
+            }
+            fields: {
+              name: "UserName",
+              type: { code: STRING }
+            }
+          }
+        }
+        values: { string_value: "10" }
+        values: { string_value: "user10" }
+        values: { string_value: "22" }
+        values: { string_value: "user22" }
+      )pb",
+      &response));
+  EXPECT_CALL(*grpc_reader, Read())
+      .WillOnce(Return(response))
+      .WillOnce(Return(absl::optional<spanner_proto::PartialResultSet>{}));
+  EXPECT_CALL(*grpc_reader, Finish()).WillOnce(Return(Status()));
+
+  auto reader = PartialResultSetSource::Create(std::move(grpc_reader));
+  ASSERT_STATUS_OK(reader);
+
+  std::vector<google::protobuf::Value> values;
+  std::vector<std::string> actual;
+  for (;;) {
+    auto more = (*reader)->NextRowValues(values);
+    ASSERT_STATUS_OK(more);
+    if (!*more) break;
+    ASSERT_EQ(2, values.size());
+    actual.push_back(values[0].string_value() + "/" +
+                     values[1].string_value());
+  }
+  EXPECT_THAT(actual, ElementsAre("10/user10", "22/user22"));
+}
+
 /**
  * @test Verify the behavior when a response with no values is received.
  */
@@ -0,0 +1,196 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/partition_executor.h"
+#include "google/cloud/internal/port_platform.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+/// The state shared by the worker threads and the calling thread.
+class RowQueue {
+ public:
+  RowQueue(std::size_t capacity, std::size_t workers)
+      : capacity_(std::max<std::size_t>(capacity, 1)), workers_(workers) {}
+
+  /// Waits for space in the queue, returns false if execution was cancelled.
+  bool Push(Row row) {
+    std::unique_lock<std::mutex> lk(mu_);
+    not_full_.wait(lk,
+                   [this] { return cancelled_ || rows_.size() < capacity_; });
+    if (cancelled_) return false;
+    rows_.push_back(std::move(row));
+    if (rows_.size() == 1) not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * Waits for rows, and moves all the queued rows into @p rows.
+   *
+   * Returns false once all the workers are done, or execution was cancelled.
+   */
+  bool PopAll(std::deque<Row>& rows) {
+    std::unique_lock<std::mutex> lk(mu_);
+    not_empty_.wait(lk, [this] {
+      return cancelled_ || !rows_.empty() || workers_ == 0;
+    });
+    if (cancelled_ || rows_.empty()) return false;
+    rows.swap(rows_);
+    not_full_.notify_all();
+    return true;
+  }
+
+  bool cancelled() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return cancelled_;
+  }
+
+  /// Cancels the execution, the first error is the one reported.
+  void Cancel(Status status) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!cancelled_) status_ = std::move(status);
+    cancelled_ = true;
+    not_full_.notify_all();
+    not_empty_.notify_all();
+  }
+
+  void WorkerDone() {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (--workers_ == 0) not_empty_.notify_all();
+  }
+
+  Status status() const {
+    std::lock_guard<std::mutex> lk(mu_);
+    return status_;
+  }
+
+ private:
+  std::size_t const capacity_;
+  mutable std::mutex mu_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<Row> rows_;
+  std::size_t workers_;
+  bool cancelled_ = false;
+  Status status_;
+};
+
+/// Executes one partition, executing it again after early transient errors.
+Status ExecuteOne(std::size_t index,
+                  std::function<RowStream(std::size_t)> const& execute,
+                  RowQueue& queue, RetryPolicy const& retry_policy_prototype,
+                  BackoffPolicy const& backoff_policy_prototype) {
+  auto retry_policy = retry_policy_prototype.clone();
+  auto backoff_policy = backoff_policy_prototype.clone();
+  for (;;) {
+    bool has_rows = false;
+    Status status;
+    auto stream = execute(index);
+    for (auto& row : stream) {
+      if (!row) {
+        status = std::move(row).status();
+        break;
+      }
+      has_rows = true;
+      // Destroying `stream` cancels the request.
+      if (!queue.Push(*std::move(row))) return {};
+    }
+    if (status.ok()) return status;
+    // Once rows were delivered the partition cannot be restarted, as that
+    // would deliver them again.
+    if (has_rows || !retry_policy->OnFailure(status)) return status;
+    std::this_thread::sleep_for(backoff_policy->OnCompletion());
+    if (queue.cancelled()) return {};
+  }
+}
+
+/// Passes the queued rows to @p callback, until the queue is exhausted.
+void Drain(RowQueue& queue, std::function<Status(Row)> const& callback) {
+  // Taking all the queued rows at once keeps the lock out of the per-row path.
+  std::deque<Row> rows;
+  while (queue.PopAll(rows)) {
+    for (auto& row : rows) {
+      auto status = callback(std::move(row));
+      if (!status.ok()) {
+        queue.Cancel(std::move(status));
+        return;
+      }
+    }
+    rows.clear();
+  }
+}
+
+}  // namespace
+
+Status ExecutePartitions(std::size_t partition_count,
+                         std::function<RowStream(std::size_t)> const& execute,
+                         std::function<Status(Row)> const& callback,
+                         ExecutePartitionsOptions const& options,
+                         RetryPolicy const& retry_policy,
+                         BackoffPolicy const& backoff_policy) {
+  if (partition_count == 0) return {};
+  auto parallelism = options.max_parallelism;
+  if (parallelism == 0) parallelism = std::thread::hardware_concurrency();
+  parallelism =
+      std::max<std::size_t>(1, std::min(parallelism, partition_count));
+
+  RowQueue queue(options.max_buffered_rows, parallelism);
+  std::atomic<std::size_t> next_partition{0};
+  auto worker = [&] {
+    while (!queue.cancelled()) {
+      auto const index = next_partition.fetch_add(1);
+      if (index >= partition_count) break;
+      auto status =
+          ExecuteOne(index, execute, queue, retry_policy, backoff_policy);
+      if (!status.ok()) queue.Cancel(std::move(status));
+    }
+    queue.WorkerDone();
+  };
+  std::vector<std::thread> workers;
+  workers.reserve(parallelism);
+  for (std::size_t i = 0; i != parallelism; ++i) workers.emplace_back(worker);
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  try {
+#endif
+    Drain(queue, callback);
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  } catch (...) {
+    // The workers may be blocked on a full queue, stop them before unwinding.
+    queue.Cancel(Status(StatusCode::kCancelled, "callback threw"));
+    for (auto& t : workers) t.join();
+    throw;
+  }
+#endif
+  for (auto& t : workers) t.join();
+  return queue.status();
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,60 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTITION_EXECUTOR_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTITION_EXECUTOR_H
+
+#include "google/cloud/spanner/execute_partitions_options.h"
+#include "google/cloud/spanner/results.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/row.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/backoff_policy.h"
+#include "google/cloud/status.h"
+#include <cstddef>
+#include <functional>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * Executes @p partition_count partitions concurrently, passing all their rows
+ * to @p callback.
+ *
+ * `execute(i)` starts the i-th partition, it is called from a worker thread.
+ * The rows are queued, up to `options.max_buffered_rows`, and @p callback is
+ * called with them from the calling thread, so it needs no synchronization.
+ *
+ * A partition that fails before returning any row is executed again, as
+ * allowed by (clones of) @p retry_policy and @p backoff_policy. Any other
+ * error, or a non-OK status from @p callback, cancels the remaining
+ * partitions and is returned.
+ */
+Status ExecutePartitions(std::size_t partition_count,
+                         std::function<RowStream(std::size_t)> const& execute,
+                         std::function<Status(Row)> const& callback,
+                         ExecutePartitionsOptions const& options,
+                         RetryPolicy const& retry_policy,
+                         BackoffPolicy const& backoff_policy);
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PARTITION_EXECUTOR_H
@@ -0,0 +1,215 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/partition_executor.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::testing_util::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
+/// A result source returning a fixed sequence of rows (or errors).
+class FakeSource : public ResultSourceInterface {
+ public:
+  explicit FakeSource(std::vector<StatusOr<Row>> rows)
+      : rows_(std::move(rows)) {}
+
+  StatusOr<Row> NextRow() override {
+    if (next_ == rows_.size()) return Row();
+    return rows_[next_++];
+  }
+  absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() override {
+    return {};
+  }
+  absl::optional<google::spanner::v1::ResultSetStats> Stats() const override {
+    return {};
+  }
+
+ private:
+  std::vector<StatusOr<Row>> rows_;
+  std::size_t next_ = 0;
+};
+
+RowStream MakeStream(std::vector<StatusOr<Row>> rows) {
+  return RowStream(absl::make_unique<FakeSource>(std::move(rows)));
+}
+
+Row MakeRow(std::int64_t partition, std::int64_t row) {
+  return MakeTestRow({{"P", Value(partition)}, {"R", Value(row)}});
+}
+
+std::int64_t PartitionOf(Row const& row) {
+  return *row.get<std::int64_t>("P");
+}
+
+Status Execute(std::size_t partition_count,
+               std::function<RowStream(std::size_t)> const& execute,
+               std::function<Status(Row)> const& callback,
+               ExecutePartitionsOptions const& options = {}) {
+  return ExecutePartitions(
+      partition_count, execute, callback, options,
+      LimitedErrorCountRetryPolicy(/*maximum_failures=*/2),
+      ExponentialBackoffPolicy(std::chrono::microseconds(1),
+                               std::chrono::microseconds(1), 2.0));
+}
+
+TEST(PartitionExecutor, NoPartitions) {
+  auto status = Execute(
+      0, [](std::size_t) { return MakeStream({}); },
+      [](Row const&) { return Status(); });
+  EXPECT_STATUS_OK(status);
+}
+
+TEST(PartitionExecutor, AllRows) {
+  auto constexpr kPartitions = 7;
+  auto constexpr kRows = 50;
+  std::vector<Row> expected;
+  for (int p = 0; p != kPartitions; ++p) {
+    for (int r = 0; r != kRows; ++r) expected.push_back(MakeRow(p, r));
+  }
+
+  ExecutePartitionsOptions options;
+  options.max_parallelism = 3;
+  options.max_buffered_rows = 4;  // forces the workers to wait
+  std::vector<Row> actual;
+  auto status = Execute(
+      kPartitions,
+      [](std::size_t p) {
+        std::vector<StatusOr<Row>> rows;
+        for (int r = 0; r != kRows; ++r) {
+          rows.emplace_back(MakeRow(static_cast<std::int64_t>(p), r));
+        }
+        return MakeStream(std::move(rows));
+      },
+      [&actual](Row row) {
+        actual.push_back(std::move(row));
+        return Status();
+      },
+      options);
+  ASSERT_STATUS_OK(status);
+  EXPECT_THAT(actual, UnorderedElementsAreArray(expected));
+}
+
+TEST(PartitionExecutor, RetryBeforeFirstRow) {
+  std::atomic<int> attempts{0};
+  std::vector<Row> actual;
+  auto status = Execute(
+      1,
+      [&attempts](std::size_t) {
+        if (++attempts == 1) {
+          return MakeStream({Status(StatusCode::kUnavailable, "try-again")});
+        }
+        return MakeStream({MakeRow(0, 0), MakeRow(0, 1)});
+      },
+      [&actual](Row row) {
+        actual.push_back(std::move(row));
+        return Status();
+      });
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(2, attempts.load());
+  EXPECT_THAT(actual, ElementsAre(MakeRow(0, 0), MakeRow(0, 1)));
+}
+
+TEST(PartitionExecutor, NoRetryAfterFirstRow) {
+  std::atomic<int> attempts{0};
+  auto status = Execute(
+      1,
+      [&attempts](std::size_t) {
+        ++attempts;
+        return MakeStream(
+            {MakeRow(0, 0), Status(StatusCode::kUnavailable, "try-again")});
+      },
+      [](Row const&) { return Status(); });
+  EXPECT_THAT(status, StatusIs(StatusCode::kUnavailable));
+  EXPECT_EQ(1, attempts.load());
+}
+
+TEST(PartitionExecutor, PermanentError) {
+  std::atomic<int> attempts{0};
+  auto status = Execute(
+      1,
+      [&attempts](std::size_t) {
+        ++attempts;
+        return MakeStream({Status(StatusCode::kPermissionDenied, "uh-oh")});
+      },
+      [](Row const&) { return Status(); });
+  EXPECT_THAT(status, StatusIs(StatusCode::kPermissionDenied));
+  EXPECT_EQ(1, attempts.load());
+}
+
+TEST(PartitionExecutor, TooManyTransientErrors) {
+  std::atomic<int> attempts{0};
+  auto status = Execute(
+      1,
+      [&attempts](std::size_t) {
+        ++attempts;
+        return MakeStream({Status(StatusCode::kUnavailable, "try-again")});
+      },
+      [](Row const&) { return Status(); });
+  EXPECT_THAT(status, StatusIs(StatusCode::kUnavailable));
+  EXPECT_EQ(3, attempts.load());
+}
+
+TEST(PartitionExecutor, CallbackErrorStopsExecution) {
+  auto constexpr kPartitions = 100;
+  std::atomic<int> started{0};
+  ExecutePartitionsOptions options;
+  options.max_parallelism = 2;
+  options.max_buffered_rows = 1;
+  int calls = 0;
+  auto status = Execute(
+      kPartitions,
+      [&started](std::size_t p) {
+        ++started;
+        std::vector<StatusOr<Row>> rows;
+        for (int r = 0; r != 10; ++r) {
+          rows.emplace_back(MakeRow(static_cast<std::int64_t>(p), r));
+        }
+        return MakeStream(std::move(rows));
+      },
+      [&calls](Row const& row) {
+        if (++calls == 3) {
+          return Status(StatusCode::kCancelled,
+                        "stop at partition " +
+                            std::to_string(PartitionOf(row)));
+        }
+        return Status();
+      },
+      options);
+  EXPECT_THAT(status, StatusIs(StatusCode::kCancelled));
+  EXPECT_EQ(3, calls);
+  EXPECT_LT(started.load(), kPartitions);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,93 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
+#include <algorithm>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+PrefetchingResultSetReader::PrefetchingResultSetReader(
+    std::unique_ptr<PartialResultSetReader> impl, std::size_t depth)
+    : impl_(std::move(impl)), depth_(std::max<std::size_t>(depth, 1)) {
+  reader_thread_ = std::thread([this] { ReadAhead(); });
+}
+
+PrefetchingResultSetReader::~PrefetchingResultSetReader() {
+  if (!reader_thread_.joinable()) return;
+  // The stream was not finished, cancel it so the background thread is not
+  // blocked waiting for data that nobody will consume.
+  Stop();
+  impl_->TryCancel();
+  reader_thread_.join();
+}
+
+void PrefetchingResultSetReader::TryCancel() {
+  Stop();
+  // This is safe to call while the background thread is blocked in `Read()`.
+  impl_->TryCancel();
+}
+
+absl::optional<google::spanner::v1::PartialResultSet>
+PrefetchingResultSetReader::Read() {
+  std::unique_lock<std::mutex> lk(mu_);
+  not_empty_.wait(lk, [this] { return done_ || !buffer_.empty(); });
+  if (buffer_.empty()) return {};
+  auto result = std::move(buffer_.front());
+  buffer_.pop_front();
+  not_full_.notify_one();
+  return result;
+}
+
+Status PrefetchingResultSetReader::Finish() {
+  Stop();
+  if (reader_thread_.joinable()) reader_thread_.join();
+  return impl_->Finish();
+}
+
+void PrefetchingResultSetReader::ReadAhead() {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      not_full_.wait(lk,
+                     [this] { return stopped_ || buffer_.size() < depth_; });
+      if (stopped_) break;
+    }
+    // Do not hold the lock while blocked on the network.
+    auto result = impl_->Read();
+    std::lock_guard<std::mutex> lk(mu_);
+    if (!result) break;
+    buffer_.push_back(*std::move(result));
+    not_empty_.notify_one();
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  done_ = true;
+  not_empty_.notify_all();
+}
+
+void PrefetchingResultSetReader::Stop() {
+  std::lock_guard<std::mutex> lk(mu_);
+  stopped_ = true;
+  not_full_.notify_all();
+}
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,78 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
+
+#include "google/cloud/spanner/internal/partial_result_set_reader.h"
+#include "google/cloud/spanner/version.h"
+#include "absl/types/optional.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+
+/**
+ * A `PartialResultSetReader` decorator that reads ahead of its caller.
+ *
+ * A background thread reads from the wrapped reader while the caller is busy
+ * with the previous messages, so the network transfer overlaps with decoding
+ * the rows. At most @p depth messages are buffered, plus the message the
+ * background thread is receiving.
+ *
+ * The messages are returned in the order they were received, and none are
+ * dropped before the wrapped reader is exhausted, so the resume tokens seen by
+ * `PartialResultSetResume` are unchanged.
+ */
+class PrefetchingResultSetReader : public PartialResultSetReader {
+ public:
+  PrefetchingResultSetReader(std::unique_ptr<PartialResultSetReader> impl,
+                             std::size_t depth);
+  ~PrefetchingResultSetReader() override;
+
+  void TryCancel() override;
+  absl::optional<google::spanner::v1::PartialResultSet> Read() override;
+  Status Finish() override;
+
+ private:
+  void ReadAhead();
+  void Stop();
+
+  std::unique_ptr<PartialResultSetReader> impl_;
+  std::size_t const depth_;
+
+  std::mutex mu_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<google::spanner::v1::PartialResultSet> buffer_;
+  bool done_ = false;     // the wrapped reader is exhausted
+  bool stopped_ = false;  // the background thread must stop reading
+  std::thread reader_thread_;
+};
+
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_INTERNAL_PREFETCHING_RESULT_SET_READER_H
@@ -0,0 +1,185 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/prefetching_result_set_reader.h"
+#include "google/cloud/spanner/internal/partial_result_set_resume.h"
+#include "google/cloud/spanner/testing/mock_partial_result_set_reader.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+using ::google::cloud::internal::Idempotency;
+using ::google::cloud::spanner_testing::MockPartialResultSetReader;
+using ::google::cloud::testing_util::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Return;
+
+using ReadReturn = absl::optional<spanner_proto::PartialResultSet>;
+
+ReadReturn MakeResponse(std::string const& token) {
+  spanner_proto::PartialResultSet response;
+  response.set_resume_token(token);
+  return response;
+}
+
+/// A mock reader returning @p tokens, counting the calls to `Read()`.
+std::unique_ptr<MockPartialResultSetReader> MakeMock(
+    std::vector<std::string> const& tokens, std::atomic<int>& reads) {
+  auto mock = absl::make_unique<MockPartialResultSetReader>();
+  auto& expectation = EXPECT_CALL(*mock, Read());
+  for (auto const& t : tokens) {
+    expectation.WillOnce([t, &reads] {
+      ++reads;
+      return MakeResponse(t);
+    });
+  }
+  expectation.WillOnce([&reads] {
+    ++reads;
+    return ReadReturn{};
+  });
+  return mock;
+}
+
+std::vector<std::string> ReadAll(PartialResultSetReader& reader) {
+  std::vector<std::string> tokens;
+  for (auto r = reader.Read(); r.has_value(); r = reader.Read()) {
+    tokens.push_back(r->resume_token());
+  }
+  return tokens;
+}
+
+TEST(PrefetchingResultSetReader, ReadsInOrder) {
+  std::atomic<int> reads{0};
+  auto mock = MakeMock({"t0", "t1", "t2", "t3", "t4"}, reads);
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(Status()));
+
+  PrefetchingResultSetReader reader(std::move(mock), 2);
+  EXPECT_THAT(ReadAll(reader), ElementsAre("t0", "t1", "t2", "t3", "t4"));
+  EXPECT_FALSE(reader.Read().has_value());
+  EXPECT_STATUS_OK(reader.Finish());
+  EXPECT_EQ(6, reads.load());
+}
+
+TEST(PrefetchingResultSetReader, BoundedReadAhead) {
+  std::atomic<int> reads{0};
+  auto mock = MakeMock({"t0", "t1", "t2", "t3"}, reads);
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(Status()));
+
+  PrefetchingResultSetReader reader(std::move(mock), 2);
+  // The background thread fills the buffer, and then waits for space.
+  for (int i = 0; i != 1000 && reads.load() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, reads.load());
+
+  auto r = reader.Read();
+  ASSERT_TRUE(r.has_value());
+  EXPECT_EQ("t0", r->resume_token());
+  EXPECT_THAT(ReadAll(reader), ElementsAre("t1", "t2", "t3"));
+  EXPECT_STATUS_OK(reader.Finish());
+}
+
+TEST(PrefetchingResultSetReader, FinishReturnsError) {
+  std::atomic<int> reads{0};
+  auto mock = MakeMock({"t0"}, reads);
+  EXPECT_CALL(*mock, Finish())
+      .WillOnce(Return(Status(StatusCode::kPermissionDenied, "uh-oh")));
+
+  PrefetchingResultSetReader reader(std::move(mock), 4);
+  EXPECT_THAT(ReadAll(reader), ElementsAre("t0"));
+  EXPECT_THAT(reader.Finish(), StatusIs(StatusCode::kPermissionDenied));
+}
+
+TEST(PrefetchingResultSetReader, TryCancelUnblocksReader) {
+  std::promise<void> blocked;
+  std::promise<void> cancelled;
+  auto cancelled_future = cancelled.get_future().share();
+  auto mock = absl::make_unique<MockPartialResultSetReader>();
+  EXPECT_CALL(*mock, Read())
+      .WillOnce([] { return MakeResponse("t0"); })
+      .WillOnce([&blocked, cancelled_future] {
+        // Simulate a stream that has no more data until it is cancelled.
+        blocked.set_value();
+        cancelled_future.wait();
+        return ReadReturn{};
+      });
+  EXPECT_CALL(*mock, TryCancel()).WillOnce([&cancelled] {
+    cancelled.set_value();
+  });
+  EXPECT_CALL(*mock, Finish())
+      .WillOnce(Return(Status(StatusCode::kCancelled, "cancelled")));
+
+  PrefetchingResultSetReader reader(std::move(mock), 2);
+  auto r = reader.Read();
+  ASSERT_TRUE(r.has_value());
+  EXPECT_EQ("t0", r->resume_token());
+  blocked.get_future().wait();
+  reader.TryCancel();
+  EXPECT_FALSE(reader.Read().has_value());
+  EXPECT_THAT(reader.Finish(), StatusIs(StatusCode::kCancelled));
+}
+
+TEST(PrefetchingResultSetReader, ResumeUsesLastDeliveredToken) {
+  std::atomic<int> reads{0};
+  std::vector<std::string> resume_tokens;
+  auto factory = [&reads, &resume_tokens](std::string const& token) {
+    resume_tokens.push_back(token);
+    std::unique_ptr<MockPartialResultSetReader> mock;
+    if (token.empty()) {
+      mock = MakeMock({"t0", "t1"}, reads);
+      EXPECT_CALL(*mock, Finish())
+          .WillOnce(Return(Status(StatusCode::kUnavailable, "try-again")));
+    } else {
+      mock = MakeMock({"t2", "t3"}, reads);
+      EXPECT_CALL(*mock, Finish()).WillOnce(Return(Status()));
+    }
+    return std::unique_ptr<PartialResultSetReader>(
+        absl::make_unique<PrefetchingResultSetReader>(std::move(mock), 3));
+  };
+  PartialResultSetResume reader(
+      factory, Idempotency::kIdempotent,
+      LimitedErrorCountRetryPolicy(/*maximum_failures=*/2).clone(),
+      ExponentialBackoffPolicy(/*initial_delay=*/std::chrono::microseconds(1),
+                               /*maximum_delay=*/std::chrono::microseconds(1),
+                               /*scaling=*/2.0)
+          .clone());
+
+  EXPECT_THAT(ReadAll(reader), ElementsAre("t0", "t1", "t2", "t3"));
+  EXPECT_STATUS_OK(reader.Finish());
+  EXPECT_THAT(resume_tokens, ElementsAre("", "t1"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -58,6 +58,19 @@ class Session {
   void set_bad() { is_bad_.store(true, std::memory_order_relaxed); }
   bool is_bad() const { return is_bad_.load(std::memory_order_relaxed); }
 
+  /**
+   * Returns the id of the read-write transaction the pool began on this
+   * session, or an empty string if there is none. The transaction is no
+   * longer associated with the session after this call.
+   *
+   * Only the current owner of the session may call this method.
+   */
+  std::string TakePreparedTransactionId() {
+    std::string id;
+    id.swap(prepared_transaction_id_);
+    return id;
+  }
+
  private:
   // Give `SessionPool` access to the private methods below.
   friend class SessionPool;
@@ -68,11 +81,23 @@ class Session {
   Clock::time_point last_use_time() const { return last_use_time_; }
   void update_last_use_time() { last_use_time_ = clock_->Now(); }
 
+  bool has_prepared_transaction() const {
+    return !prepared_transaction_id_.empty();
+  }
+  Clock::time_point prepare_time() const { return prepare_time_; }
+  void set_prepared_transaction(std::string id) {
+    prepared_transaction_id_ = std::move(id);
+    prepare_time_ = clock_->Now();
+  }
+  void clear_prepared_transaction() { prepared_transaction_id_.clear(); }
+
   std::string const session_name_;
   std::shared_ptr<Channel> const channel_;
   std::atomic<bool> is_bad_;
   std::shared_ptr<Clock> clock_;
   Clock::time_point last_use_time_;
+  std::string prepared_transaction_id_;
+  Clock::time_point prepare_time_;
 };
 
 /**
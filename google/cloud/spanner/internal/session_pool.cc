@@ -15,6 +15,7 @@
 #include "google/cloud/spanner/internal/session_pool.h"
 #include "google/cloud/spanner/internal/connection_impl.h"
 #include "google/cloud/spanner/internal/session.h"
+#include "google/cloud/spanner/internal/status_utils.h"
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/internal/async_retry_unary_rpc.h"
 #include "google/cloud/internal/retry_loop.h"
@@ -22,8 +23,11 @@
 #include "google/cloud/status.h"
 #include "absl/memory/memory.h"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
-#include <random>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -38,15 +42,36 @@ namespace spanner_proto = ::google::spanner::v1;
 
 using google::cloud::internal::Idempotency;
 
+namespace {
+
+// Each thread gets a stable index, used to choose its home shard. Threads
+// are numbered in the order they first use any pool, so consecutive threads
+// (e.g. in a thread pool) have different home shards.
+std::size_t ThreadIndex() {
+  static std::atomic<std::size_t> next_index{0};
+  thread_local std::size_t const kIndex = next_index.fetch_add(1);
+  return kIndex;
+}
+
+// The service may abort read-write transactions that are idle for more than
+// 10 seconds. Write-prepared sessions older than this are not handed out as
+// such, and the background work (which runs every 5 seconds) begins a new
+// transaction on the ones that would be too old before it runs again.
+auto constexpr kPreparedTransactionMaxAge = std::chrono::seconds(8);
+auto constexpr kPreparedTransactionRefreshAge = std::chrono::seconds(3);
+
+}  // namespace
+
 std::shared_ptr<SessionPool> MakeSessionPool(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     SessionPoolOptions options, google::cloud::CompletionQueue cq,
     std::unique_ptr<RetryPolicy> retry_policy,
     std::unique_ptr<BackoffPolicy> backoff_policy,
-    std::shared_ptr<Session::Clock> clock) {
+    std::shared_ptr<Session::Clock> clock, SpannerStubFactory stub_factory) {
   auto pool = std::make_shared<SessionPool>(
       std::move(db), std::move(stubs), std::move(options), std::move(cq),
-      std::move(retry_policy), std::move(backoff_policy), std::move(clock));
+      std::move(retry_policy), std::move(backoff_policy), std::move(clock),
+      std::move(stub_factory));
   pool->Initialize();
   return pool;
 }
@@ -57,7 +82,8 @@ SessionPool::SessionPool(Database db,
                          google::cloud::CompletionQueue cq,
                          std::unique_ptr<RetryPolicy> retry_policy,
                          std::unique_ptr<BackoffPolicy> backoff_policy,
-                         std::shared_ptr<Session::Clock> clock)
+                         std::shared_ptr<Session::Clock> clock,
+                         SpannerStubFactory stub_factory)
     : db_(std::move(db)),
       options_(std::move(
           options.EnforceConstraints(static_cast<int>(stubs.size())))),
@@ -65,10 +91,14 @@ SessionPool::SessionPool(Database db,
       retry_policy_prototype_(std::move(retry_policy)),
       backoff_policy_prototype_(std::move(backoff_policy)),
       clock_(std::move(clock)),
+      stub_factory_(std::move(stub_factory)),
       max_pool_size_(options_.max_sessions_per_channel() *
                      static_cast<int>(stubs.size())),
-      random_generator_(std::random_device()()),
-      channels_(stubs.size()) {
+      channels_(stub_factory_
+                    ? static_cast<std::size_t>(options_.max_channels())
+                    : stubs.size()),
+      channel_count_(stubs.size()),
+      shards_(channels_.size()) {
   if (stubs.empty()) {
     google::cloud::internal::ThrowInvalidArgument(
         "SessionPool requires a non-empty set of stubs");
@@ -77,8 +107,6 @@ SessionPool::SessionPool(Database db,
   for (auto i = 0U; i < stubs.size(); ++i) {
     channels_[i] = std::make_shared<Channel>(std::move(stubs[i]));
   }
-  // `channels_` is never resized after this point.
-  next_dissociated_stub_channel_ = channels_.begin();
 }
 
 void SessionPool::Initialize() {
@@ -101,6 +129,12 @@ SessionPool::~SessionPool() {
   // must return `nullptr`, and the lambda will not do any work nor reschedule
   // the timer.
   current_timer_.cancel();
+
+  // There is no pool to satisfy any pending `AsyncAllocate()` requests.
+  for (auto& waiter : async_waiters_) {
+    waiter.result.set_value(
+        Status(StatusCode::kCancelled, "session pool destroyed"));
+  }
 }
 
 void SessionPool::ScheduleBackgroundWork(std::chrono::seconds relative_time) {
@@ -121,6 +155,7 @@ void SessionPool::ScheduleBackgroundWork(std::chrono::seconds relative_time) {
 void SessionPool::DoBackgroundWork() {
   MaintainPoolSize();
   RefreshExpiringSessions();
+  PrepareWriteSessions();
   ScheduleBackgroundWork(std::chrono::seconds(5));
 }
 
@@ -146,14 +181,19 @@ void SessionPool::RefreshExpiringSessions() {
     std::unique_lock<std::mutex> lk(mu_);
     if (last_use_time_lower_bound_ <= refresh_limit) {
       last_use_time_lower_bound_ = now;
-      for (auto const& session : sessions_) {
-        auto last_use_time = session->last_use_time();
-        if (last_use_time <= refresh_limit) {
-          sessions_to_refresh.emplace_back(session->channel()->stub,
-                                           session->session_name());
-          session->update_last_use_time();
-        } else if (last_use_time < last_use_time_lower_bound_) {
-          last_use_time_lower_bound_ = last_use_time;
+      for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> shard_lk(shard.mu);
+        for (auto const* list : {&shard.sessions, &shard.write_sessions}) {
+          for (auto const& session : *list) {
+            auto last_use_time = session->last_use_time();
+            if (last_use_time <= refresh_limit) {
+              sessions_to_refresh.emplace_back(session->channel()->stub,
+                                               session->session_name());
+              session->update_last_use_time();
+            } else if (last_use_time < last_use_time_lower_bound_) {
+              last_use_time_lower_bound_ = last_use_time;
+            }
+          }
         }
       }
     }
@@ -212,20 +252,35 @@ SessionPool::ComputeCreateCounts(int sessions_to_create) {
   int target_total_sessions =
       (std::min)(total_sessions_ + sessions_to_create, max_pool_size_);
 
-  // Sort the channels in *descending* order of session count.
-  absl::FixedArray<std::shared_ptr<Channel>> channels_by_count = channels_;
+  // Sort the channels in *descending* order of session count. Channels with
+  // the same count are sorted by their (snapshotted) outstanding RPCs, so the
+  // least loaded channels get the sessions left over by the rounding below.
+  struct ChannelLoad {
+    std::shared_ptr<Channel> channel;
+    int outstanding_rpcs;
+  };
+  auto const n = channel_count();
+  std::vector<ChannelLoad> channels_by_count;
+  channels_by_count.reserve(n);
+  for (std::size_t i = 0; i != n; ++i) {
+    channels_by_count.push_back(
+        {channels_[i], channels_[i]->stub->outstanding_rpcs()});
+  }
   std::sort(channels_by_count.begin(), channels_by_count.end(),
-            [](std::shared_ptr<Channel> const& lhs,
-               std::shared_ptr<Channel> const& rhs) {
-              // Use `>` to sort in descending order.
-              return lhs->session_count > rhs->session_count;
+            [](ChannelLoad const& lhs, ChannelLoad const& rhs) {
+              if (lhs.channel->session_count != rhs.channel->session_count) {
+                // Use `>` to sort in descending order.
+                return lhs.channel->session_count > rhs.channel->session_count;
+              }
+              return lhs.outstanding_rpcs < rhs.outstanding_rpcs;
             });
 
   // Compute the number of new Sessions to create on each channel.
   int sessions_remaining = target_total_sessions;
-  int channels_remaining = static_cast<int>(channels_.size());
+  int channels_remaining = static_cast<int>(n);
   std::vector<CreateCount> create_counts;
-  for (auto& channel : channels_by_count) {
+  for (auto& load : channels_by_count) {
+    auto const& channel = load.channel;
     // The target number of sessions for this channel, rounded up.
     int target =
         (sessions_remaining + channels_remaining - 1) / channels_remaining;
@@ -267,21 +322,104 @@ Status SessionPool::CreateSessions(
   return return_status;
 }
 
+// Begin read-write transactions on the configured fraction of the idle
+// sessions, and begin new ones on write-prepared sessions that would
+// otherwise be too old to use before this runs again.
+void SessionPool::PrepareWriteSessions() {
+  if (options_.write_sessions_fraction() <= 0.0) return;
+  // Wait for the previous round to finish, its sessions are not in the pool.
+  if (prepares_in_progress_.load() != 0) return;
+  auto const refresh_limit = clock_->Now() - kPreparedTransactionRefreshAge;
+  std::vector<std::unique_ptr<Session>> to_prepare;
+  std::size_t idle = 0;
+  std::size_t prepared = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    idle += shard.sessions.size() + shard.write_sessions.size();
+    auto& write_sessions = shard.write_sessions;
+    auto stale = std::stable_partition(
+        write_sessions.begin(), write_sessions.end(),
+        [refresh_limit](std::unique_ptr<Session> const& session) {
+          return session->prepare_time() > refresh_limit;
+        });
+    prepared += static_cast<std::size_t>(stale - write_sessions.begin());
+    std::move(stale, write_sessions.end(), std::back_inserter(to_prepare));
+    write_sessions.erase(stale, write_sessions.end());
+  }
+  auto const target = static_cast<std::size_t>(std::ceil(
+      options_.write_sessions_fraction() * static_cast<double>(idle)));
+  for (auto& shard : shards_) {
+    if (prepared + to_prepare.size() >= target) break;
+    std::lock_guard<std::mutex> lk(shard.mu);
+    // Prepare the least recently used sessions, at the front of the list.
+    auto const count = (std::min)(shard.sessions.size(),
+                                  target - prepared - to_prepare.size());
+    auto const end = std::next(shard.sessions.begin(),
+                               static_cast<std::ptrdiff_t>(count));
+    std::move(shard.sessions.begin(), end, std::back_inserter(to_prepare));
+    shard.sessions.erase(shard.sessions.begin(), end);
+  }
+  prepares_in_progress_ += static_cast<int>(to_prepare.size());
+  for (auto& session : to_prepare) {
+    session->clear_prepared_transaction();
+    PrepareWriteSession(MakeSessionHolder(std::move(session), false));
+  }
+}
+
+void SessionPool::PrepareWriteSession(SessionHolder session) {
+  spanner_proto::BeginTransactionRequest request;
+  request.set_session(session->session_name());
+  request.mutable_options()->mutable_read_write();
+  auto stub = GetStub(*session);
+  std::weak_ptr<SessionPool> pool = shared_from_this();
+  // The session returns to the pool (as a write-prepared session, if the
+  // call succeeds) when `session` is released by the callback.
+  google::cloud::internal::StartRetryAsyncUnaryRpc(
+      cq_, __func__, retry_policy_prototype_->clone(),
+      backoff_policy_prototype_->clone(), Idempotency::kIdempotent,
+      [stub](grpc::ClientContext* context,
+             spanner_proto::BeginTransactionRequest const& request,
+             grpc::CompletionQueue* cq) {
+        return stub->AsyncBeginTransaction(*context, request, cq);
+      },
+      std::move(request))
+      .then([pool, session](
+                future<StatusOr<spanner_proto::Transaction>> f) mutable {
+        auto transaction = f.get();
+        if (transaction) {
+          session->set_prepared_transaction(
+              std::move(*transaction->mutable_id()));
+        } else if (IsSessionNotFound(transaction.status())) {
+          session->set_bad();
+        }
+        session.reset();
+        if (auto p = pool.lock()) --p->prepares_in_progress_;
+      });
+}
+
 StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
+  return AllocateImpl(dissociate_from_pool, /*for_write=*/false);
+}
+
+StatusOr<SessionHolder> SessionPool::AllocateForWrite() {
+  return AllocateImpl(/*dissociate_from_pool=*/false, /*for_write=*/true);
+}
+
+StatusOr<SessionHolder> SessionPool::AllocateImpl(bool dissociate_from_pool,
+                                                  bool for_write) {
+  MaybeAddChannel();
+  // Fast path: take an idle session without touching `mu_`. Dissociated
+  // sessions change the pool counters, so they always use the slow path.
+  if (!dissociate_from_pool) {
+    if (auto session = TryTakeSession(for_write)) {
+      return MakeSessionHolder(std::move(session), false);
+    }
+  }
+
   std::unique_lock<std::mutex> lk(mu_);
   for (;;) {
-    if (!sessions_.empty()) {
-      // return the most recently used session.
-      auto session = std::move(sessions_.back());
-      sessions_.pop_back();
-      if (dissociate_from_pool) {
-        --total_sessions_;
-        auto const& channel = session->channel();
-        if (channel) {
-          --channel->session_count;
-        }
-      }
-      return {MakeSessionHolder(std::move(session), dissociate_from_pool)};
+    if (auto session = TryTakeSession(for_write)) {
+      return {TakeSession(std::move(session), dissociate_from_pool)};
     }
 
     // If the pool is at its max size, fail or wait until someone returns a
@@ -291,7 +429,7 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
         return Status(StatusCode::kResourceExhausted, "session pool exhausted");
       }
       Wait(lk, [this] {
-        return !sessions_.empty() || total_sessions_ < max_pool_size_;
+        return HasIdleSessions() || total_sessions_ < max_pool_size_;
       });
       continue;
     }
@@ -304,7 +442,7 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
     // number of waiters in the `sessions_to_create` calculation below.
     if (create_calls_in_progress_ > 0) {
       Wait(lk, [this] {
-        return !sessions_.empty() || create_calls_in_progress_ == 0;
+        return HasIdleSessions() || create_calls_in_progress_ == 0;
       });
       continue;
     }
@@ -319,6 +457,181 @@ StatusOr<SessionHolder> SessionPool::Allocate(bool dissociate_from_pool) {
   }
 }
 
+future<StatusOr<SessionHolder>> SessionPool::AsyncAllocate(
+    bool dissociate_from_pool) {
+  MaybeAddChannel();
+  if (!dissociate_from_pool) {
+    if (auto session = TryTakeSession()) {
+      return make_ready_future(StatusOr<SessionHolder>(
+          MakeSessionHolder(std::move(session), false)));
+    }
+  }
+
+  std::unique_lock<std::mutex> lk(mu_);
+  if (auto session = TryTakeSession()) {
+    return make_ready_future(StatusOr<SessionHolder>(
+        TakeSession(std::move(session), dissociate_from_pool)));
+  }
+  if (total_sessions_ >= max_pool_size_ &&
+      options_.action_on_exhaustion() == ActionOnExhaustion::kFail) {
+    return make_ready_future(StatusOr<SessionHolder>(
+        Status(StatusCode::kResourceExhausted, "session pool exhausted")));
+  }
+
+  async_waiters_.push_back(AsyncWaiter{{}, dissociate_from_pool});
+  ++num_waiters_;
+  auto f = async_waiters_.back().result.get_future();
+  // A session released since the last `TryTakeSession()` call may not have
+  // seen this waiter, so check again. Unless some sessions are already being
+  // created, this also creates enough sessions for all the waiters.
+  // `HandleBatchCreateSessionsDone()` (or `Release()`) hands the sessions to
+  // the waiters.
+  ServeAsyncWaiters(std::move(lk));
+  return f;
+}
+
+SessionPool::Shard& SessionPool::ShardFor(Channel const& channel) {
+  // There are only a handful of channels, a linear search is fast enough.
+  auto const begin = channels_.begin();
+  auto const end =
+      std::next(begin, static_cast<std::ptrdiff_t>(channel_count()));
+  auto i = std::distance(
+      begin, std::find_if(begin, end,
+                          [&channel](std::shared_ptr<Channel> const& c) {
+                            return c.get() == &channel;
+                          }));
+  return shards_[static_cast<std::size_t>(i)];
+}
+
+std::size_t SessionPool::LeastLoadedChannel(std::size_t start,
+                                            std::size_t n) const {
+  auto best = start;
+  auto best_load = channels_[start]->stub->outstanding_rpcs();
+  for (std::size_t i = 1; i != n && best_load != 0; ++i) {
+    auto const index = (start + i) % n;
+    auto const load = channels_[index]->stub->outstanding_rpcs();
+    if (load < best_load) {
+      best = index;
+      best_load = load;
+    }
+  }
+  return best;
+}
+
+void SessionPool::MaybeAddChannel() {
+  if (!stub_factory_ || channel_count() == channels_.size()) return;
+  auto const busy = options_.busy_channel_rpcs();
+  auto all_busy = [this, busy] {
+    auto const n = channel_count();
+    for (std::size_t i = 0; i != n; ++i) {
+      if (channels_[i]->stub->outstanding_rpcs() < busy) return false;
+    }
+    return true;
+  };
+  if (!all_busy()) return;
+
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const n = channel_count();
+  // Another thread may have added a channel while we waited for the lock.
+  if (n == channels_.size() || !all_busy()) return;
+  channels_[n] = std::make_shared<Channel>(stub_factory_(static_cast<int>(n)));
+  channel_count_.store(n + 1, std::memory_order_release);
+  max_pool_size_ += options_.max_sessions_per_channel();
+
+  // Give the new channel its share of the sessions, so the load moves to it.
+  auto const share = (std::max)(
+      1, (std::min)(total_sessions_ / static_cast<int>(n),
+                    options_.max_sessions_per_channel()));
+  ++create_calls_in_progress_;
+  auto channel = channels_[n];
+  lk.unlock();
+  CreateSessionsAsync(channel, options_.labels(), share);
+}
+
+std::unique_ptr<Session> SessionPool::TryTakeSession(bool for_write) {
+  auto const n = channel_count();
+  // Start at the home shard, unless another channel is less loaded.
+  auto const start = LeastLoadedChannel(ThreadIndex() % n, n);
+  // The first pass only considers the preferred kind of session.
+  for (auto any_kind : {false, true}) {
+    for (std::size_t i = 0; i != n; ++i) {
+      auto& shard = shards_[(start + i) % n];
+      std::lock_guard<std::mutex> lk(shard.mu);
+      auto* list = for_write ? &shard.write_sessions : &shard.sessions;
+      if (list->empty() && any_kind) {
+        list = for_write ? &shard.sessions : &shard.write_sessions;
+      }
+      if (list->empty()) continue;
+      // return the most recently used session.
+      auto session = std::move(list->back());
+      list->pop_back();
+      // Only writers use the prepared transaction, and only if the service
+      // is unlikely to have aborted it.
+      if (!for_write || session->prepare_time() <
+                            clock_->Now() - kPreparedTransactionMaxAge) {
+        session->clear_prepared_transaction();
+      }
+      return session;
+    }
+  }
+  return nullptr;
+}
+
+bool SessionPool::HasIdleSessions() {
+  return std::any_of(shards_.begin(), shards_.end(), [](Shard& shard) {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    return !shard.sessions.empty() || !shard.write_sessions.empty();
+  });
+}
+
+SessionHolder SessionPool::TakeSession(std::unique_ptr<Session> session,
+                                       bool dissociate_from_pool) {
+  if (dissociate_from_pool) {
+    --total_sessions_;
+    auto const& channel = session->channel();
+    if (channel) {
+      --channel->session_count;
+    }
+  }
+  return MakeSessionHolder(std::move(session), dissociate_from_pool);
+}
+
+void SessionPool::ServeAsyncWaiters(std::unique_lock<std::mutex> lk,
+                                    Status const& status) {
+  std::vector<std::pair<promise<StatusOr<SessionHolder>>,
+                        StatusOr<SessionHolder>>>
+      ready;
+  while (!async_waiters_.empty()) {
+    auto session = TryTakeSession();
+    if (!session) break;
+    auto& waiter = async_waiters_.front();
+    ready.emplace_back(
+        std::move(waiter.result),
+        TakeSession(std::move(session), waiter.dissociate_from_pool));
+    async_waiters_.pop_front();
+    --num_waiters_;
+  }
+  if (!async_waiters_.empty() && create_calls_in_progress_ == 0) {
+    if (!status.ok()) {
+      // Creating sessions failed, and there are no other calls in progress.
+      // Like `Allocate()`, report the error to the callers.
+      for (auto& waiter : async_waiters_) {
+        ready.emplace_back(std::move(waiter.result), status);
+      }
+      num_waiters_ -= static_cast<int>(async_waiters_.size());
+      async_waiters_.clear();
+    } else if (total_sessions_ < max_pool_size_) {
+      auto const waiting = static_cast<int>(async_waiters_.size());
+      (void)Grow(lk, options_.min_sessions() + waiting,
+                 WaitForSessionAllocation::kNoWait);
+    }
+  }
+  // Satisfy the promises without holding the lock, their continuations may
+  // call back into the pool.
+  lk.unlock();
+  for (auto& r : ready) r.first.set_value(std::move(r.second));
+}
+
 std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
   auto const& channel = session.channel();
   if (channel) {
@@ -326,19 +639,33 @@ std::shared_ptr<SpannerStub> SessionPool::GetStub(Session const& session) {
   }
 
   // Sessions that were created for partitioned Reads/Queries do not have
-  // their own channel/stub; return a stub to use by round-robining between
-  // the channels.
+  // their own channel/stub; return the stub of the least loaded channel,
+  // round-robining between the channels with the same load.
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const n = channel_count();
+  auto const index =
+      LeastLoadedChannel(next_dissociated_stub_channel_ % n, n);
+  next_dissociated_stub_channel_ = index + 1;
+  return channels_[index]->stub;
+}
+
+std::vector<ChannelStats> SessionPool::GetChannelStats() {
   std::unique_lock<std::mutex> lk(mu_);
-  auto stub = (*next_dissociated_stub_channel_)->stub;
-  if (++next_dissociated_stub_channel_ == channels_.end()) {
-    next_dissociated_stub_channel_ = channels_.begin();
+  auto const n = channel_count();
+  std::vector<ChannelStats> stats;
+  stats.reserve(n);
+  for (std::size_t i = 0; i != n; ++i) {
+    auto const& channel = *channels_[i];
+    stats.push_back({channel.session_count, channel.stub->outstanding_rpcs(),
+                     channel.stub->max_outstanding_rpcs(),
+                     channel.stub->total_rpcs()});
   }
-  return stub;
+  return stats;
 }
 
 void SessionPool::Release(std::unique_ptr<Session> session) {
-  std::unique_lock<std::mutex> lk(mu_);
   if (session->is_bad()) {
+    std::unique_lock<std::mutex> lk(mu_);
     // Once we have support for background processing, we may want to signal
     // that to replenish this bad session.
     --total_sessions_;
@@ -346,14 +673,27 @@ void SessionPool::Release(std::unique_ptr<Session> session) {
     if (channel) {
       --channel->session_count;
     }
+    if (!async_waiters_.empty()) ServeAsyncWaiters(std::move(lk));
     return;
   }
   session->update_last_use_time();
-  sessions_.push_back(std::move(session));
-  if (num_waiting_for_session_ > 0) {
-    lk.unlock();
-    cond_.notify_one();
+  auto& shard = ShardFor(*session->channel());
+  {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    auto& list = session->has_prepared_transaction() ? shard.write_sessions
+                                                     : shard.sessions;
+    list.push_back(std::move(session));
+  }
+  // See the comments in `Wait()`: if a waiter has not registered yet it will
+  // find this session when it (re)checks the shards.
+  if (num_waiters_.load() == 0) return;
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!async_waiters_.empty()) {
+    ServeAsyncWaiters(std::move(lk));
+    return;
   }
+  lk.unlock();
+  cond_.notify_one();
 }
 
 // Creates `num_sessions` on `channel` and adds them to the pool.
@@ -468,22 +808,27 @@ Status SessionPool::HandleBatchCreateSessionsDone(
   std::unique_lock<std::mutex> lk(mu_);
   --create_calls_in_progress_;
   if (!response.ok()) {
-    return response.status();
+    auto status = std::move(response).status();
+    ServeAsyncWaiters(std::move(lk), status);
+    cond_.notify_all();
+    return status;
   }
   // Add sessions to the pool and update counters for `channel` and the pool.
   auto const sessions_created = response->session_size();
   channel->session_count += sessions_created;
   total_sessions_ += sessions_created;
-  sessions_.reserve(sessions_.size() + sessions_created);
-  for (auto& session : *response->mutable_session()) {
-    sessions_.push_back(absl::make_unique<Session>(
-        std::move(*session.mutable_name()), channel, clock_));
+  {
+    auto& shard = ShardFor(*channel);
+    std::lock_guard<std::mutex> shard_lk(shard.mu);
+    shard.sessions.reserve(shard.sessions.size() + sessions_created);
+    for (auto& session : *response->mutable_session()) {
+      shard.sessions.push_back(absl::make_unique<Session>(
+          std::move(*session.mutable_name()), channel, clock_));
+    }
   }
-  // Shuffle the pool so we distribute returned sessions across channels.
-  std::shuffle(sessions_.begin(), sessions_.end(), random_generator_);
 
   // Wake up anyone who was waiting for a `Session`.
-  lk.unlock();
+  ServeAsyncWaiters(std::move(lk));
   cond_.notify_all();
   return Status();
 }
@@ -28,13 +28,15 @@
 #include "google/cloud/status_or.h"
 #include "absl/container/fixed_array.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <random>
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,6 +48,14 @@ inline namespace SPANNER_CLIENT_NS {
 namespace internal {
 struct SessionPoolFriendForTest;
 
+/// The usage of one channel in a `SessionPool`.
+struct ChannelStats {
+  int session_count;
+  int outstanding_rpcs;
+  int max_outstanding_rpcs;
+  std::int64_t total_rpcs;
+};
+
 /**
  * Maintains a pool of `Session` objects.
  *
@@ -58,6 +68,23 @@ struct SessionPoolFriendForTest;
  * Allocation from the pool is LIFO to take advantage of the fact the Spanner
  * backends maintain a cache of sessions which is valid for 30 seconds, so
  * re-using Sessions as quickly as possible has performance advantages.
+ *
+ * The idle sessions are kept in one shard per channel, each with its own
+ * mutex. Each thread starts its search at a fixed "home" shard and steals
+ * from the other shards when that is empty, so `Allocate()` and `Release()`
+ * on different threads rarely contend. The pool-wide mutex is only used to
+ * create sessions, to wait for them, and for (rare) dissociated sessions.
+ *
+ * If `SessionPoolOptions::write_sessions_fraction()` is set, the background
+ * work begins read-write transactions on that fraction of the idle sessions.
+ * `AllocateForWrite()` prefers these "write-prepared" sessions, while
+ * `Allocate()` prefers sessions without a prepared transaction.
+ *
+ * The pool counts the RPCs in progress on each channel. Threads start their
+ * search at the least loaded channel instead of their home shard when the
+ * loads differ, and the sessions without a channel use the least loaded
+ * stub. If `SessionPoolOptions::max_channels()` allows it, the pool adds a
+ * channel (and creates sessions on it) when all the channels are busy.
  */
 class SessionPool : public std::enable_shared_from_this<SessionPool> {
  public:
@@ -71,7 +98,8 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
               SessionPoolOptions options, google::cloud::CompletionQueue cq,
               std::unique_ptr<RetryPolicy> retry_policy,
               std::unique_ptr<BackoffPolicy> backoff_policy,
-              std::shared_ptr<Session::Clock> clock);
+              std::shared_ptr<Session::Clock> clock,
+              SpannerStubFactory stub_factory = {});
 
   ~SessionPool();
 
@@ -95,11 +123,34 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
    */
   StatusOr<SessionHolder> Allocate(bool dissociate_from_pool = false);
 
+  /**
+   * Allocate a `Session` for a read-write transaction.
+   *
+   * Prefers sessions with a prepared read-write transaction, see
+   * `Session::TakePreparedTransactionId()`. Otherwise it is equivalent to
+   * `Allocate()`.
+   */
+  StatusOr<SessionHolder> AllocateForWrite();
+
+  /**
+   * Asynchronously allocate a `Session` from the pool.
+   *
+   * This is the non-blocking version of `Allocate()`. If no `Session` is
+   * available the request is queued, and satisfied when a `Session` is
+   * released to the pool or created asynchronously. The calling thread never
+   * blocks.
+   */
+  future<StatusOr<SessionHolder>> AsyncAllocate(
+      bool dissociate_from_pool = false);
+
   /**
    * Return a `SpannerStub` to be used when making calls using `session`.
    */
   std::shared_ptr<SpannerStub> GetStub(Session const& session);
 
+  /// Return the usage of each channel, in the order they were added.
+  std::vector<ChannelStats> GetChannelStats();
+
  private:
   // Represents a request to create `session_count` sessions on `channel`
   // See `ComputeCreateCounts` and `CreateSessions`.
@@ -109,16 +160,67 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   };
   enum class WaitForSessionAllocation { kWait, kNoWait };
 
+  // A pending `AsyncAllocate()` request.
+  struct AsyncWaiter {
+    promise<StatusOr<SessionHolder>> result;
+    bool dissociate_from_pool;
+  };
+
+  // The idle sessions for one channel. Sessions with a prepared read-write
+  // transaction are kept apart, so they are easy to find.
+  struct Shard {
+    std::mutex mu;
+    std::vector<std::unique_ptr<Session>> sessions;        // GUARDED_BY(mu)
+    std::vector<std::unique_ptr<Session>> write_sessions;  // GUARDED_BY(mu)
+  };
+
+  Shard& ShardFor(Channel const& channel);
+
+  // The number of channels in use. Slots beyond it in `channels_` are empty.
+  std::size_t channel_count() const {
+    return channel_count_.load(std::memory_order_acquire);
+  }
+
+  // Return the index of the channel with the fewest outstanding RPCs. Ties
+  // are broken in favor of @p start, and then the channels following it.
+  std::size_t LeastLoadedChannel(std::size_t start, std::size_t n) const;
+
+  // Add a channel if all the channels are busy and the options allow it.
+  void MaybeAddChannel();
+
+  // Remove the most recently used session from the least loaded channel's
+  // shard (the calling thread's home shard on ties), or from any other shard
+  // if that is empty. Sessions of the preferred kind (write-prepared or not,
+  // per @p for_write) are taken first. Returns `nullptr` if there are no idle
+  // sessions.
+  std::unique_ptr<Session> TryTakeSession(bool for_write = false);
+  bool HasIdleSessions();
+
+  // Wrap a session removed from the shards in a `SessionHolder`.
+  SessionHolder TakeSession(
+      std::unique_ptr<Session> session,
+      bool dissociate_from_pool);  // EXCLUSIVE_LOCKS_REQUIRED(mu_)
+
+  // Satisfy as many `AsyncAllocate()` requests as possible. Releases `lk`.
+  void ServeAsyncWaiters(std::unique_lock<std::mutex> lk,
+                         Status const& status = {});
+
+  StatusOr<SessionHolder> AllocateImpl(bool dissociate_from_pool,
+                                       bool for_write);
+
   // Release session back to the pool.
   void Release(std::unique_ptr<Session> session);
 
   // Called when a thread needs to wait for a `Session` to become available.
   // @p specifies the condition to wait for.
+  // `num_waiters_` is incremented before `p` is (first) evaluated, so a
+  // concurrent `Release()` either makes its session visible to `p`, or sees
+  // the waiter and notifies `cond_`.
   template <typename Predicate>
   void Wait(std::unique_lock<std::mutex>& lk, Predicate&& p) {
-    ++num_waiting_for_session_;
+    ++num_waiters_;
     cond_.wait(lk, std::forward<Predicate>(p));
-    --num_waiting_for_session_;
+    --num_waiters_;
   }
 
   Status Grow(std::unique_lock<std::mutex>& lk, int sessions_to_create,
@@ -161,6 +263,8 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   void DoBackgroundWork();
   void MaintainPoolSize();
   void RefreshExpiringSessions();
+  void PrepareWriteSessions();
+  void PrepareWriteSession(SessionHolder session);
 
   Database const db_;
   SessionPoolOptions const options_;
@@ -168,28 +272,41 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
   std::unique_ptr<RetryPolicy const> retry_policy_prototype_;
   std::unique_ptr<BackoffPolicy const> backoff_policy_prototype_;
   std::shared_ptr<Session::Clock> clock_;
-  int const max_pool_size_;
-  std::mt19937 random_generator_;
+  SpannerStubFactory const stub_factory_;
 
   std::mutex mu_;
   std::condition_variable cond_;
-  std::vector<std::unique_ptr<Session>> sessions_;  // GUARDED_BY(mu_)
-  int total_sessions_ = 0;                          // GUARDED_BY(mu_)
-  int create_calls_in_progress_ = 0;                // GUARDED_BY(mu_)
-  int num_waiting_for_session_ = 0;                 // GUARDED_BY(mu_)
+  int max_pool_size_;                      // GUARDED_BY(mu_)
+  int total_sessions_ = 0;                 // GUARDED_BY(mu_)
+  int create_calls_in_progress_ = 0;       // GUARDED_BY(mu_)
+  std::deque<AsyncWaiter> async_waiters_;  // GUARDED_BY(mu_)
 
-  // Lower bound on all `sessions_[i]->last_use_time()` values.
+  // The number of threads blocked in `Allocate()` plus the size of
+  // `async_waiters_`. Modified with `mu_` held, but read without it so
+  // `Release()` only acquires `mu_` when somebody is waiting.
+  std::atomic<int> num_waiters_{0};
+
+  // The number of `BeginTransaction()` calls started by
+  // `PrepareWriteSessions()` that have not completed.
+  std::atomic<int> prepares_in_progress_{0};
+
+  // Lower bound on the `last_use_time()` of all the idle sessions.
   Session::Clock::time_point last_use_time_lower_bound_ =
       clock_->Now();  // GUARDED_BY(mu_)
 
   future<void> current_timer_;
 
-  // `channels_` is guaranteed to be non-empty and will not be resized after
-  // the constructor runs.
-  // n.b. `FixedArray` iterators are never invalidated.
-  using ChannelVec = absl::FixedArray<std::shared_ptr<Channel>>;
-  ChannelVec channels_;                                 // GUARDED_BY(mu_)
-  ChannelVec::iterator next_dissociated_stub_channel_;  // GUARDED_BY(mu_)
+  // `channels_` has room for `SessionPoolOptions::max_channels()` (if there is
+  // a `stub_factory_`) and is never resized. Channels are only added (with
+  // `mu_` held) by storing the channel in the next slot and then incrementing
+  // `channel_count_`, so the first `channel_count()` slots may be read without
+  // holding `mu_`.
+  absl::FixedArray<std::shared_ptr<Channel>> channels_;
+  std::atomic<std::size_t> channel_count_;
+  std::size_t next_dissociated_stub_channel_ = 0;  // GUARDED_BY(mu_)
+
+  // `shards_[i]` holds the idle sessions for `channels_[i]`.
+  absl::FixedArray<Shard> shards_;
 };
 
 /**
@@ -197,14 +314,16 @@ class SessionPool : public std::enable_shared_from_this<SessionPool> {
  *
  * The parameters allow the `SessionPool` to make remote calls needed to manage
  * the pool, and to associate `Session`s with the stubs used to create them.
- * `stubs` must not be empty.
+ * `stubs` must not be empty. If set, `stub_factory` creates the stubs for the
+ * channels added when all the channels are busy.
  */
 std::shared_ptr<SessionPool> MakeSessionPool(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     SessionPoolOptions options, google::cloud::CompletionQueue cq,
     std::unique_ptr<RetryPolicy> retry_policy,
     std::unique_ptr<BackoffPolicy> backoff_policy,
-    std::shared_ptr<Session::Clock> clock = std::make_shared<Session::Clock>());
+    std::shared_ptr<Session::Clock> clock = std::make_shared<Session::Clock>(),
+    SpannerStubFactory stub_factory = {});
 
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
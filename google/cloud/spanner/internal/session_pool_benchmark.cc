@@ -0,0 +1,219 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/internal/session_pool.h"
+#include "google/cloud/spanner/backoff_policy.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/internal/background_threads_impl.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace internal {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+// This benchmark measures the cost of `SessionPool::Allocate()` and the
+// release of the session, as the number of threads using the pool grows. The
+// pool is pre-populated with enough sessions for all the threads, so no RPCs
+// are made while measuring.
+
+/// A stub that can only create sessions, all other RPCs fail.
+class FakeStub : public SpannerStub {
+ public:
+  StatusOr<spanner_proto::Session> CreateSession(
+      grpc::ClientContext&,
+      spanner_proto::CreateSessionRequest const&) override {
+    return Unimplemented();
+  }
+  StatusOr<spanner_proto::BatchCreateSessionsResponse> BatchCreateSessions(
+      grpc::ClientContext&,
+      spanner_proto::BatchCreateSessionsRequest const& request) override {
+    spanner_proto::BatchCreateSessionsResponse response;
+    for (int i = 0; i != request.session_count(); ++i) {
+      response.add_session()->set_name("session-" +
+                                        std::to_string(++session_id_));
+    }
+    return response;
+  }
+  std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+      spanner_proto::BatchCreateSessionsResponse>>
+  AsyncBatchCreateSessions(grpc::ClientContext&,
+                           spanner_proto::BatchCreateSessionsRequest const&,
+                           grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::Session> GetSession(
+      grpc::ClientContext&, spanner_proto::GetSessionRequest const&) override {
+    return Unimplemented();
+  }
+  StatusOr<spanner_proto::ListSessionsResponse> ListSessions(
+      grpc::ClientContext&,
+      spanner_proto::ListSessionsRequest const&) override {
+    return Unimplemented();
+  }
+  Status DeleteSession(grpc::ClientContext&,
+                       spanner_proto::DeleteSessionRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+  AsyncDeleteSession(grpc::ClientContext&,
+                     spanner_proto::DeleteSessionRequest const&,
+                     grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::ResultSet> ExecuteSql(
+      grpc::ClientContext&, spanner_proto::ExecuteSqlRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::ResultSet>>
+  AsyncExecuteSql(grpc::ClientContext&, spanner_proto::ExecuteSqlRequest const&,
+                  grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+  ExecuteStreamingSql(grpc::ClientContext&,
+                      spanner_proto::ExecuteSqlRequest const&) override {
+    return nullptr;
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+  PrepareAsyncExecuteStreamingSql(grpc::ClientContext&,
+                                  spanner_proto::ExecuteSqlRequest const&,
+                                  grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::ExecuteBatchDmlResponse> ExecuteBatchDml(
+      grpc::ClientContext&,
+      spanner_proto::ExecuteBatchDmlRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
+  StreamingRead(grpc::ClientContext&,
+                spanner_proto::ReadRequest const&) override {
+    return nullptr;
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+  PrepareAsyncStreamingRead(grpc::ClientContext&,
+                            spanner_proto::ReadRequest const&,
+                            grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::Transaction> BeginTransaction(
+      grpc::ClientContext&,
+      spanner_proto::BeginTransactionRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::Transaction>>
+  AsyncBeginTransaction(grpc::ClientContext&,
+                        spanner_proto::BeginTransactionRequest const&,
+                        grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::CommitResponse> Commit(
+      grpc::ClientContext&, spanner_proto::CommitRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+  AsyncCommit(grpc::ClientContext&, spanner_proto::CommitRequest const&,
+              grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  Status Rollback(grpc::ClientContext&,
+                  spanner_proto::RollbackRequest const&) override {
+    return Unimplemented();
+  }
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+  AsyncRollback(grpc::ClientContext&, spanner_proto::RollbackRequest const&,
+                grpc::CompletionQueue*) override {
+    return nullptr;
+  }
+  StatusOr<spanner_proto::PartitionResponse> PartitionQuery(
+      grpc::ClientContext&,
+      spanner_proto::PartitionQueryRequest const&) override {
+    return Unimplemented();
+  }
+  StatusOr<spanner_proto::PartitionResponse> PartitionRead(
+      grpc::ClientContext&,
+      spanner_proto::PartitionReadRequest const&) override {
+    return Unimplemented();
+  }
+
+ private:
+  static Status Unimplemented() {
+    return Status(StatusCode::kUnimplemented, "not implemented by FakeStub");
+  }
+
+  std::atomic<int> session_id_{0};
+};
+
+auto constexpr kChannels = 4;
+auto constexpr kMaxThreads = 32;
+
+std::shared_ptr<SessionPool> GetPool() {
+  static auto* const kThreads =
+      new google::cloud::internal::AutomaticallyCreatedBackgroundThreads;
+  static auto* const kPool = [] {
+    std::vector<std::shared_ptr<SpannerStub>> stubs;
+    for (int i = 0; i != kChannels; ++i) {
+      stubs.push_back(std::make_shared<FakeStub>());
+    }
+    // Create enough sessions so no thread ever waits for one.
+    SessionPoolOptions options;
+    options.set_min_sessions(2 * kMaxThreads)
+        .set_max_sessions_per_channel(2 * kMaxThreads);
+    return new std::shared_ptr<SessionPool>(MakeSessionPool(
+        Database("project", "instance", "database"), std::move(stubs),
+        std::move(options), kThreads->cq(),
+        LimitedErrorCountRetryPolicy(/*maximum_failures=*/0).clone(),
+        ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                 std::chrono::milliseconds(1), 2.0)
+            .clone()));
+  }();
+  return *kPool;
+}
+
+void BM_AllocateRelease(benchmark::State& state) {
+  auto pool = GetPool();
+  for (auto _ : state) {
+    auto session = pool->Allocate();
+    if (!session) {
+      state.SkipWithError(session.status().message().c_str());
+      break;
+    }
+    benchmark::DoNotOptimize(session);
+  }
+}
+BENCHMARK(BM_AllocateRelease)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+}  // namespace
+}  // namespace internal
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -27,7 +27,9 @@
 #include <google/protobuf/text_format.h>
 #include <gmock/gmock.h>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -46,7 +48,9 @@ using ::google::cloud::testing_util::StatusIs;
 using ::google::protobuf::TextFormat;
 using ::testing::_;
 using ::testing::ByMove;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsSubsetOf;
 using ::testing::Return;
 using ::testing::StrictMock;
 using ::testing::UnorderedElementsAre;
@@ -78,13 +82,49 @@ spanner_proto::BatchCreateSessionsResponse MakeSessionsResponse(
 std::shared_ptr<SessionPool> MakeSessionPool(
     Database db, std::vector<std::shared_ptr<SpannerStub>> stubs,
     SessionPoolOptions options, CompletionQueue cq,
-    std::shared_ptr<SteadyClock> clock = std::make_shared<SteadyClock>()) {
+    std::shared_ptr<SteadyClock> clock = std::make_shared<SteadyClock>(),
+    SpannerStubFactory stub_factory = {}) {
   return MakeSessionPool(
       std::move(db), std::move(stubs), std::move(options), std::move(cq),
       absl::make_unique<LimitedTimeRetryPolicy>(std::chrono::minutes(10)),
       absl::make_unique<ExponentialBackoffPolicy>(
           std::chrono::milliseconds(100), std::chrono::minutes(1), 2.0),
-      std::move(clock));
+      std::move(clock), std::move(stub_factory));
+}
+
+using PartialResultSetStream =
+    grpc::ClientReaderInterface<spanner_proto::PartialResultSet>;
+
+class FakeStream : public PartialResultSetStream {
+ public:
+  bool NextMessageSize(std::uint32_t*) override { return false; }
+  bool Read(spanner_proto::PartialResultSet*) override { return false; }
+  void WaitForInitialMetadata() override {}
+  grpc::Status Finish() override { return grpc::Status::OK; }
+};
+
+// Start a streaming RPC on `stub`, which @p mock accepts. The RPC is
+// outstanding until the returned stream is destroyed.
+std::unique_ptr<PartialResultSetStream> StartStream(
+    spanner_testing::MockSpannerStub& mock, SpannerStub& stub) {
+  EXPECT_CALL(mock, ExecuteStreamingSql(_, _))
+      .WillOnce([](grpc::ClientContext&,
+                   spanner_proto::ExecuteSqlRequest const&) {
+        return std::unique_ptr<PartialResultSetStream>(
+            absl::make_unique<FakeStream>());
+      });
+  grpc::ClientContext context;
+  return stub.ExecuteStreamingSql(context, spanner_proto::ExecuteSqlRequest());
+}
+
+// Expect that RPCs made using `stub` are handled by @p mock.
+void ExpectStubUses(std::shared_ptr<SpannerStub> const& stub,
+                    spanner_testing::MockSpannerStub& mock) {
+  EXPECT_CALL(mock, GetSession(_, _))
+      .WillOnce(Return(Status(StatusCode::kNotFound, "not-found")));
+  grpc::ClientContext context;
+  EXPECT_THAT(stub->GetSession(context, spanner_proto::GetSessionRequest()),
+              StatusIs(StatusCode::kNotFound));
 }
 
 TEST(SessionPool, Allocate) {
@@ -104,7 +144,7 @@ TEST(SessionPool, Allocate) {
   auto session = pool->Allocate();
   ASSERT_STATUS_OK(session);
   EXPECT_EQ((*session)->session_name(), "session1");
-  EXPECT_EQ(pool->GetStub(**session), mock);
+  ExpectStubUses(pool->GetStub(**session), *mock);
 }
 
 TEST(SessionPool, ReleaseBadSession) {
@@ -392,7 +432,140 @@ TEST(SessionPool, GetStubForStublessSession) {
   auto pool = MakeSessionPool(db, {mock}, {}, threads.cq());
   // ensure we get a stub even if we didn't allocate from the pool.
   auto session = MakeDissociatedSessionHolder("session_id");
-  EXPECT_EQ(pool->GetStub(*session), mock);
+  ExpectStubUses(pool->GetStub(*session), *mock);
+}
+
+TEST(SessionPool, GetStubPrefersLeastLoadedChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, {}, threads.cq());
+  auto session = MakeDissociatedSessionHolder("session_id");
+
+  // The stubs are used round-robin while their loads are equal.
+  auto busy = pool->GetStub(*session);
+  auto idle = pool->GetStub(*session);
+  EXPECT_NE(busy, idle);
+  ExpectStubUses(busy, *mock1);
+  auto stream = StartStream(*mock1, *busy);
+  for (int i = 0; i != 3; ++i) {
+    EXPECT_EQ(idle, pool->GetStub(*session));
+  }
+  stream.reset();
+  EXPECT_EQ(busy, pool->GetStub(*session));
+}
+
+TEST(SessionPool, AllocatePrefersLeastLoadedChannel) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto db = Database("project", "instance", "database");
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1"}))));
+
+  SessionPoolOptions options;
+  options.set_min_sessions(2);
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options, threads.cq());
+
+  // Start a streaming RPC on the channel of "c1s1".
+  std::unique_ptr<PartialResultSetStream> stream;
+  {
+    auto s1 = pool->Allocate();
+    ASSERT_STATUS_OK(s1);
+    auto s2 = pool->Allocate();
+    ASSERT_STATUS_OK(s2);
+    auto const& c1 = (*s1)->session_name() == "c1s1" ? *s1 : *s2;
+    stream = StartStream(*mock1, *pool->GetStub(*c1));
+  }
+
+  for (int i = 0; i != 3; ++i) {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    EXPECT_EQ("c2s1", (*session)->session_name());
+  }
+
+  auto stats = pool->GetChannelStats();
+  ASSERT_EQ(2, stats.size());
+  EXPECT_EQ(1, stats[0].session_count);
+  EXPECT_EQ(1, stats[0].outstanding_rpcs);
+  EXPECT_EQ(1, stats[0].max_outstanding_rpcs);
+  // `BatchCreateSessions()` and `ExecuteStreamingSql()`.
+  EXPECT_EQ(2, stats[0].total_rpcs);
+  EXPECT_EQ(1, stats[1].session_count);
+  EXPECT_EQ(0, stats[1].outstanding_rpcs);
+  EXPECT_EQ(1, stats[1].total_rpcs);
+
+  stream.reset();
+  EXPECT_EQ(0, pool->GetChannelStats()[0].outstanding_rpcs);
+}
+
+TEST(SessionPool, AddChannelWhenBusy) {
+  auto mock1 = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  auto mock2 = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1"}))));
+  auto reader = absl::make_unique<StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>>();
+  EXPECT_CALL(*mock2, AsyncBatchCreateSessions(_, _, _))
+      .WillOnce([&reader](
+                    grpc::ClientContext&,
+                    spanner_proto::BatchCreateSessionsRequest const& request,
+                    grpc::CompletionQueue*) {
+        EXPECT_EQ(1, request.session_count());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::BatchCreateSessionsResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::BatchCreateSessionsResponse* response,
+                   grpc::Status* status, void*) {
+        *response = MakeSessionsResponse({"c2s1"});
+        *status = grpc::Status::OK;
+      });
+
+  std::vector<int> channel_ids;
+  auto stub_factory = [&channel_ids, mock2](int channel_id) {
+    channel_ids.push_back(channel_id);
+    return mock2;
+  };
+  SessionPoolOptions options;
+  options.set_min_sessions(1).set_max_channels(2).set_busy_channel_rpcs(1);
+  auto db = Database("project", "instance", "database");
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto pool = MakeSessionPool(db, {mock1}, options, CompletionQueue(impl),
+                              std::make_shared<SteadyClock>(), stub_factory);
+
+  // A channel is added when all the channels are busy.
+  std::unique_ptr<PartialResultSetStream> stream;
+  {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    EXPECT_EQ("c1s1", (*session)->session_name());
+    stream = StartStream(*mock1, *pool->GetStub(**session));
+  }
+  EXPECT_TRUE(channel_ids.empty());
+  {
+    // The new channel has no sessions until `BatchCreateSessions` completes.
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+    EXPECT_EQ("c1s1", (*session)->session_name());
+  }
+  EXPECT_THAT(channel_ids, ElementsAre(1));
+  impl->SimulateCompletion(true);
+
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("c2s1", (*session)->session_name());
+  EXPECT_EQ(2, pool->GetChannelStats().size());
+
+  // No more channels are added once `max_channels()` is reached.
+  auto busy = StartStream(*mock2, *pool->GetStub(**session));
+  session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_THAT(channel_ids, ElementsAre(1));
 }
 
 TEST(SessionPool, SessionRefresh) {
@@ -462,6 +635,218 @@ TEST(SessionPool, SessionRefresh) {
   impl->SimulateCompletion(true);
 }
 
+// Create a pool with two sessions, "s1" and "s2", and use the background work
+// to begin a transaction ("txn-1") on "s1".
+std::shared_ptr<SessionPool> MakeWritePreparedPool(
+    std::shared_ptr<spanner_testing::MockSpannerStub> const& mock,
+    std::unique_ptr<MockAsyncResponseReader<spanner_proto::Transaction>>&
+        reader,
+    std::shared_ptr<FakeCompletionQueueImpl> const& impl,
+    std::shared_ptr<FakeSteadyClock> const& clock) {
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1", "s2"}))));
+  EXPECT_CALL(*mock, AsyncBeginTransaction(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext&,
+                          spanner_proto::BeginTransactionRequest const& request,
+                          grpc::CompletionQueue*) {
+        EXPECT_EQ("s1", request.session());
+        EXPECT_TRUE(request.options().has_read_write());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::Transaction>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::Transaction* transaction,
+                   grpc::Status* status, void*) {
+        transaction->set_id("txn-1");
+        *status = grpc::Status::OK;
+      });
+
+  auto db = Database("project", "instance", "database");
+  SessionPoolOptions options;
+  options.set_min_sessions(2).set_write_sessions_fraction(0.5);
+  auto pool = MakeSessionPool(db, {mock}, options, CompletionQueue(impl),
+                              LimitedErrorCountRetryPolicy(2).clone(),
+                              ExponentialBackoffPolicy(
+                                  std::chrono::milliseconds(1),
+                                  std::chrono::milliseconds(1), 2.0)
+                                  .clone(),
+                              clock);
+  // Run the background work, which begins the transaction, then complete
+  // the `BeginTransaction()` call.
+  impl->SimulateCompletion(true);
+  impl->SimulateCompletion(true);
+  return pool;
+}
+
+TEST(SessionPool, WritePreparedSessions) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  std::unique_ptr<MockAsyncResponseReader<spanner_proto::Transaction>> reader(
+      new StrictMock<MockAsyncResponseReader<spanner_proto::Transaction>>);
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto clock = std::make_shared<FakeSteadyClock>();
+  auto pool = MakeWritePreparedPool(mock, reader, impl, clock);
+
+  // Readers prefer the session without a prepared transaction.
+  auto read = pool->Allocate();
+  ASSERT_STATUS_OK(read);
+  EXPECT_EQ("s2", (*read)->session_name());
+  EXPECT_EQ("", (*read)->TakePreparedTransactionId());
+
+  // Writers get the prepared transaction.
+  auto write = pool->AllocateForWrite();
+  ASSERT_STATUS_OK(write);
+  EXPECT_EQ("s1", (*write)->session_name());
+  EXPECT_EQ("txn-1", (*write)->TakePreparedTransactionId());
+}
+
+TEST(SessionPool, WritePreparedSessionExpires) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  std::unique_ptr<MockAsyncResponseReader<spanner_proto::Transaction>> reader(
+      new StrictMock<MockAsyncResponseReader<spanner_proto::Transaction>>);
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto clock = std::make_shared<FakeSteadyClock>();
+  auto pool = MakeWritePreparedPool(mock, reader, impl, clock);
+
+  // The service may have aborted the transaction, so it is not used.
+  clock->AdvanceTime(std::chrono::seconds(20));
+  auto write = pool->AllocateForWrite();
+  ASSERT_STATUS_OK(write);
+  EXPECT_EQ("s1", (*write)->session_name());
+  EXPECT_EQ("", (*write)->TakePreparedTransactionId());
+}
+
+TEST(SessionPool, AsyncAllocateFromPool) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, {}, threads.cq());
+  {
+    auto session = pool->Allocate();
+    ASSERT_STATUS_OK(session);
+  }
+  auto f = pool->AsyncAllocate();
+  ASSERT_EQ(std::future_status::ready, f.wait_for(std::chrono::seconds(0)));
+  auto session = f.get();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("s1", (*session)->session_name());
+}
+
+TEST(SessionPool, AsyncAllocateCreatesSessions) {
+  auto mock = std::make_shared<StrictMock<spanner_testing::MockSpannerStub>>();
+  auto reader = absl::make_unique<StrictMock<
+      MockAsyncResponseReader<spanner_proto::BatchCreateSessionsResponse>>>();
+  EXPECT_CALL(*mock, AsyncBatchCreateSessions(_, _, _))
+      .WillOnce([&reader](
+                    grpc::ClientContext&,
+                    spanner_proto::BatchCreateSessionsRequest const& request,
+                    grpc::CompletionQueue*) {
+        EXPECT_EQ(1, request.session_count());
+        // This is safe. See comments in MockAsyncResponseReader.
+        return std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<
+            spanner_proto::BatchCreateSessionsResponse>>(reader.get());
+      });
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce([](spanner_proto::BatchCreateSessionsResponse* response,
+                   grpc::Status* status, void*) {
+        *response = MakeSessionsResponse({"s1"});
+        *status = grpc::Status::OK;
+      });
+
+  auto db = Database("project", "instance", "database");
+  auto impl = std::make_shared<FakeCompletionQueueImpl>();
+  auto pool = MakeSessionPool(db, {mock}, {}, CompletionQueue(impl));
+
+  // The session is created without blocking the calling thread.
+  auto f = pool->AsyncAllocate();
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  impl->SimulateCompletion(true);
+  auto session = f.get();
+  ASSERT_STATUS_OK(session);
+  EXPECT_EQ("s1", (*session)->session_name());
+}
+
+TEST(SessionPool, AsyncAllocateFailOnExhaustion) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  SessionPoolOptions options;
+  options.set_max_sessions_per_channel(1).set_action_on_exhaustion(
+      ActionOnExhaustion::kFail);
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, options, threads.cq());
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+  EXPECT_THAT(pool->AsyncAllocate().get(),
+              StatusIs(StatusCode::kResourceExhausted,
+                       "session pool exhausted"));
+}
+
+TEST(SessionPool, AsyncAllocateWaitsForRelease) {
+  auto mock = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"s1"}))));
+
+  SessionPoolOptions options;
+  options.set_max_sessions_per_channel(1).set_action_on_exhaustion(
+      ActionOnExhaustion::kBlock);
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock}, options, threads.cq());
+  auto session = pool->Allocate();
+  ASSERT_STATUS_OK(session);
+
+  auto f = pool->AsyncAllocate();
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  session->reset();
+  auto next = f.get();
+  ASSERT_STATUS_OK(next);
+  EXPECT_EQ("s1", (*next)->session_name());
+}
+
+TEST(SessionPool, ConcurrentAllocateRelease) {
+  auto mock1 = std::make_shared<spanner_testing::MockSpannerStub>();
+  auto mock2 = std::make_shared<spanner_testing::MockSpannerStub>();
+  EXPECT_CALL(*mock1, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c1s1", "c1s2"}))));
+  EXPECT_CALL(*mock2, BatchCreateSessions(_, _))
+      .WillOnce(Return(ByMove(MakeSessionsResponse({"c2s1", "c2s2"}))));
+
+  // More threads than sessions, so some threads must steal sessions from
+  // other shards, and some must wait for a session to be released.
+  SessionPoolOptions options;
+  options.set_min_sessions(4)
+      .set_max_sessions_per_channel(2)
+      .set_action_on_exhaustion(ActionOnExhaustion::kBlock);
+  auto db = Database("project", "instance", "database");
+  google::cloud::internal::AutomaticallyCreatedBackgroundThreads threads;
+  auto pool = MakeSessionPool(db, {mock1, mock2}, options, threads.cq());
+
+  auto constexpr kThreadCount = 8;
+  auto constexpr kIterations = 200;
+  std::vector<std::set<std::string>> names(kThreadCount);
+  std::vector<std::thread> workers;
+  for (int i = 0; i != kThreadCount; ++i) {
+    workers.emplace_back([&pool, &names, i] {
+      for (int j = 0; j != kIterations; ++j) {
+        auto session = pool->Allocate();
+        ASSERT_STATUS_OK(session);
+        names[i].insert((*session)->session_name());
+      }
+    });
+  }
+  for (auto& t : workers) t.join();
+
+  std::set<std::string> all;
+  for (auto const& n : names) all.insert(n.begin(), n.end());
+  EXPECT_THAT(all, IsSubsetOf({"c1s1", "c1s2", "c2s1", "c2s2"}));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
@@ -77,20 +77,47 @@ class DefaultSpannerStub : public SpannerStub {
   std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
   ExecuteStreamingSql(grpc::ClientContext& client_context,
                       spanner_proto::ExecuteSqlRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+  PrepareAsyncExecuteStreamingSql(
+      grpc::ClientContext& client_context,
+      spanner_proto::ExecuteSqlRequest const& request,
+      grpc::CompletionQueue* cq) override;
   StatusOr<spanner_proto::ExecuteBatchDmlResponse> ExecuteBatchDml(
       grpc::ClientContext& client_context,
       spanner_proto::ExecuteBatchDmlRequest const& request) override;
   std::unique_ptr<grpc::ClientReaderInterface<spanner_proto::PartialResultSet>>
   StreamingRead(grpc::ClientContext& client_context,
                 spanner_proto::ReadRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+  PrepareAsyncStreamingRead(grpc::ClientContext& client_context,
+                            spanner_proto::ReadRequest const& request,
+                            grpc::CompletionQueue* cq) override;
   StatusOr<spanner_proto::Transaction> BeginTransaction(
       grpc::ClientContext& client_context,
       spanner_proto::BeginTransactionRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::Transaction>>
+  AsyncBeginTransaction(
+      grpc::ClientContext& client_context,
+      spanner_proto::BeginTransactionRequest const& request,
+      grpc::CompletionQueue* cq) override;
   StatusOr<spanner_proto::CommitResponse> Commit(
       grpc::ClientContext& client_context,
       spanner_proto::CommitRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+  AsyncCommit(grpc::ClientContext& client_context,
+              spanner_proto::CommitRequest const& request,
+              grpc::CompletionQueue* cq) override;
   Status Rollback(grpc::ClientContext& client_context,
                   spanner_proto::RollbackRequest const& request) override;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+  AsyncRollback(grpc::ClientContext& client_context,
+                spanner_proto::RollbackRequest const& request,
+                grpc::CompletionQueue* cq) override;
   StatusOr<spanner_proto::PartitionResponse> PartitionQuery(
       grpc::ClientContext& client_context,
       spanner_proto::PartitionQueryRequest const& request) override;
@@ -206,6 +233,16 @@ DefaultSpannerStub::ExecuteStreamingSql(
   return grpc_stub_->ExecuteStreamingSql(&client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+DefaultSpannerStub::PrepareAsyncExecuteStreamingSql(
+    grpc::ClientContext& client_context,
+    spanner_proto::ExecuteSqlRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return grpc_stub_->PrepareAsyncExecuteStreamingSql(&client_context, request,
+                                                     cq);
+}
+
 StatusOr<spanner_proto::ExecuteBatchDmlResponse>
 DefaultSpannerStub::ExecuteBatchDml(
     grpc::ClientContext& client_context,
@@ -225,6 +262,14 @@ DefaultSpannerStub::StreamingRead(grpc::ClientContext& client_context,
   return grpc_stub_->StreamingRead(&client_context, request);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncReaderInterface<spanner_proto::PartialResultSet>>
+DefaultSpannerStub::PrepareAsyncStreamingRead(
+    grpc::ClientContext& client_context,
+    spanner_proto::ReadRequest const& request, grpc::CompletionQueue* cq) {
+  return grpc_stub_->PrepareAsyncStreamingRead(&client_context, request, cq);
+}
+
 StatusOr<spanner_proto::Transaction> DefaultSpannerStub::BeginTransaction(
     grpc::ClientContext& client_context,
     spanner_proto::BeginTransactionRequest const& request) {
@@ -237,6 +282,15 @@ StatusOr<spanner_proto::Transaction> DefaultSpannerStub::BeginTransaction(
   return response;
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::Transaction>>
+DefaultSpannerStub::AsyncBeginTransaction(
+    grpc::ClientContext& client_context,
+    spanner_proto::BeginTransactionRequest const& request,
+    grpc::CompletionQueue* cq) {
+  return grpc_stub_->AsyncBeginTransaction(&client_context, request, cq);
+}
+
 StatusOr<spanner_proto::CommitResponse> DefaultSpannerStub::Commit(
     grpc::ClientContext& client_context,
     spanner_proto::CommitRequest const& request) {
@@ -249,6 +303,14 @@ StatusOr<spanner_proto::CommitResponse> DefaultSpannerStub::Commit(
   return response;
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<spanner_proto::CommitResponse>>
+DefaultSpannerStub::AsyncCommit(grpc::ClientContext& client_context,
+                                spanner_proto::CommitRequest const& request,
+                                grpc::CompletionQueue* cq) {
+  return grpc_stub_->AsyncCommit(&client_context, request, cq);
+}
+
 Status DefaultSpannerStub::Rollback(
     grpc::ClientContext& client_context,
     spanner_proto::RollbackRequest const& request) {
@@ -258,6 +320,14 @@ Status DefaultSpannerStub::Rollback(
   return google::cloud::MakeStatusFromRpcError(grpc_status);
 }
 
+std::unique_ptr<
+    grpc::ClientAsyncResponseReaderInterface<google::protobuf::Empty>>
+DefaultSpannerStub::AsyncRollback(grpc::ClientContext& client_context,
+                                  spanner_proto::RollbackRequest const& request,
+                                  grpc::CompletionQueue* cq) {
+  return grpc_stub_->AsyncRollback(&client_context, request, cq);
+}
+
 StatusOr<spanner_proto::PartitionResponse> DefaultSpannerStub::PartitionQuery(
     grpc::ClientContext& client_context,
     spanner_proto::PartitionQueryRequest const& request) {
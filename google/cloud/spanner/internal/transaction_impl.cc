@@ -22,6 +22,33 @@ namespace internal {
 
 TransactionImpl::~TransactionImpl() = default;
 
+void TransactionImpl::FinishPendingVisit(bool failed) {
+  std::unique_lock<std::mutex> lock(mu_);
+  state_ = !failed && !(selector_ && selector_->has_begin()) ? State::kDone
+                                                             : State::kBegin;
+  if (state_ == State::kDone) {
+    // All the queued visitors can now run concurrently.
+    auto visitors = std::move(async_visitors_);
+    async_visitors_.clear();
+    lock.unlock();
+    cond_.notify_all();
+    for (auto& visitor : visitors) visitor(/*pending=*/false);
+    return;
+  }
+  if (!async_visitors_.empty()) {
+    // Hand the "begin" over to the oldest queued visitor, any synchronous
+    // visitors keep waiting.
+    auto visitor = std::move(async_visitors_.front());
+    async_visitors_.pop_front();
+    state_ = State::kPending;
+    lock.unlock();
+    visitor(/*pending=*/true);
+    return;
+  }
+  lock.unlock();
+  cond_.notify_one();
+}
+
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
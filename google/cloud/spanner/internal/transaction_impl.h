@@ -17,14 +17,18 @@
 
 #include "google/cloud/spanner/internal/session.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/internal/invoke_result.h"
 #include "google/cloud/internal/port_platform.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/transaction.pb.h>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <type_traits>
 
 namespace google {
 namespace cloud {
@@ -37,10 +41,18 @@ using VisitInvokeResult = ::google::cloud::internal::invoke_result_t<
     Functor, SessionHolder&,
     StatusOr<google::spanner::v1::TransactionSelector>&, std::int64_t>;
 
+// Extracts `T` from the `future<T>` returned by an `AsyncVisit()` functor.
+template <typename T>
+struct AsyncVisitValue {};
+template <typename T>
+struct AsyncVisitValue<future<T>> {
+  using type = T;
+};
+
 /**
  * The internal representation of a google::cloud::spanner::Transaction.
  */
-class TransactionImpl {
+class TransactionImpl : public std::enable_shared_from_this<TransactionImpl> {
  public:
   explicit TransactionImpl(google::spanner::v1::TransactionSelector selector)
       : TransactionImpl(/*session=*/{}, std::move(selector)) {}
@@ -100,32 +112,91 @@ class TransactionImpl {
     try {
 #endif
       auto r = f(session_, selector_, seqno);
-      bool done = false;
-      {
-        std::lock_guard<std::mutex> lock(mu_);
-        state_ =
-            selector_ && selector_->has_begin() ? State::kBegin : State::kDone;
-        done = (state_ == State::kDone);
-      }
-      if (done) {
-        cond_.notify_all();
-      } else {
-        cond_.notify_one();
-      }
+      FinishPendingVisit(/*failed=*/false);
       return r;
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
     } catch (...) {
-      {
-        std::lock_guard<std::mutex> lock(mu_);
-        state_ = State::kBegin;
-      }
-      cond_.notify_one();
+      FinishPendingVisit(/*failed=*/true);
       throw;
     }
 #endif
   }
 
+  // Visit the transaction asynchronously. The functor has the same contract
+  // as in `Visit()`, but it returns a `future<T>`, and it may keep using the
+  // SessionHolder and TransactionSelector until that future is satisfied.
+  //
+  // Visitors that must wait for another visitor to assign a transaction ID
+  // are queued, rather than blocking the calling thread. They run on the
+  // thread that completes the visitor they were waiting for.
+  template <typename Functor>
+  VisitInvokeResult<Functor> AsyncVisit(Functor&& f) {
+    using ResultType =
+        typename AsyncVisitValue<VisitInvokeResult<Functor>>::type;
+    std::unique_lock<std::mutex> lock(mu_);
+    std::int64_t const seqno = ++seqno_;
+    if (state_ == State::kDone) {
+      lock.unlock();
+      // Keep `*this` alive while `f` uses `session_` and `selector_`.
+      auto self = shared_from_this();
+      return f(session_, selector_, seqno)
+          .then([self](VisitInvokeResult<Functor> r) { return r.get(); });
+    }
+    if (state_ == State::kBegin) {
+      state_ = State::kPending;
+      lock.unlock();
+      return AsyncVisitPending(f, seqno);
+    }
+    // Another visitor is assigning the transaction ID, queue this one.
+    auto p = std::make_shared<promise<ResultType>>();
+    auto fut = p->get_future();
+    auto self = shared_from_this();
+    auto functor = std::make_shared<typename std::decay<Functor>::type>(
+        std::forward<Functor>(f));
+    async_visitors_.emplace_back([self, p, functor, seqno](bool pending) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      try {
+#endif
+        auto r = pending
+                     ? self->AsyncVisitPending(*functor, seqno)
+                     : (*functor)(self->session_, self->selector_, seqno);
+        r.then([self, p](VisitInvokeResult<Functor> result) {
+          p->set_value(result.get());
+        });
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+      } catch (...) {
+        p->set_exception(std::current_exception());
+      }
+#endif
+    });
+    return fut;
+  }
+
  private:
+  // Run `f` as the only active visitor of a transaction in the "begin" state.
+  template <typename Functor>
+  VisitInvokeResult<Functor> AsyncVisitPending(Functor& f, std::int64_t seqno) {
+    auto self = shared_from_this();
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+#endif
+      return f(session_, selector_, seqno)
+          .then([self](VisitInvokeResult<Functor> r) {
+            self->FinishPendingVisit(/*failed=*/false);
+            return r.get();
+          });
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    } catch (...) {
+      FinishPendingVisit(/*failed=*/true);
+      throw;
+    }
+#endif
+  }
+
+  // Called when the active visitor of a transaction in the "begin" state
+  // finishes, hands the transaction over to the waiting visitors.
+  void FinishPendingVisit(bool failed);
+
   enum class State {
     kBegin,    // waiting for a future visitor to assign a transaction ID
     kPending,  // waiting for an active visitor to assign a transaction ID
@@ -135,6 +206,7 @@ class TransactionImpl {
 
   std::mutex mu_;
   std::condition_variable cond_;
+  std::deque<std::function<void(bool)>> async_visitors_;  // GUARDED_BY(mu_)
   SessionHolder session_;
   StatusOr<google::spanner::v1::TransactionSelector> selector_;
   std::int64_t seqno_;
@@ -250,6 +250,77 @@ TEST(InternalTransaction, ReadFailsAndTxnInvalidated) {
   EXPECT_EQ(128, MultiThreadedRead(128, &client, 1562361252, "sess2", "txn2"));
 }
 
+TEST(InternalTransaction, AsyncVisitWaitsForTransactionId) {
+  Transaction txn = MakeReadWriteTransaction();
+
+  // The first visitor starts the transaction, and completes asynchronously.
+  promise<int> first_done;
+  StatusOr<TransactionSelector>* first_selector = nullptr;
+  auto first = internal::AsyncVisit(
+      txn, [&](SessionHolder&, StatusOr<TransactionSelector>& s,
+               std::int64_t) {
+        EXPECT_TRUE(s->has_begin());
+        first_selector = &s;
+        return first_done.get_future();
+      });
+  ASSERT_THAT(first_selector, NotNull());
+
+  // The second visitor must wait for the transaction ID.
+  int second_calls = 0;
+  auto second = internal::AsyncVisit(
+      txn, [&](SessionHolder&, StatusOr<TransactionSelector>& s,
+               std::int64_t) {
+        ++second_calls;
+        EXPECT_EQ("txn-id", s->id());
+        return make_ready_future(2);
+      });
+  EXPECT_EQ(0, second_calls);
+
+  (*first_selector)->set_id("txn-id");
+  first_done.set_value(1);
+  EXPECT_EQ(1, first.get());
+  EXPECT_EQ(1, second_calls);
+  EXPECT_EQ(2, second.get());
+}
+
+TEST(InternalTransaction, AsyncVisitRetriesBegin) {
+  Transaction txn = MakeReadWriteTransaction();
+
+  // The first visitor fails without assigning a transaction ID.
+  promise<int> first_done;
+  auto first = internal::AsyncVisit(
+      txn, [&](SessionHolder&, StatusOr<TransactionSelector>& s,
+               std::int64_t) {
+        EXPECT_TRUE(s->has_begin());
+        return first_done.get_future();
+      });
+
+  // So the second visitor must start the transaction itself.
+  int second_calls = 0;
+  auto second = internal::AsyncVisit(
+      txn, [&](SessionHolder&, StatusOr<TransactionSelector>& s,
+               std::int64_t) {
+        ++second_calls;
+        EXPECT_TRUE(s->has_begin());
+        s->set_id("txn-id");
+        return make_ready_future(2);
+      });
+  EXPECT_EQ(0, second_calls);
+
+  first_done.set_value(1);
+  EXPECT_EQ(1, first.get());
+  EXPECT_EQ(1, second_calls);
+  EXPECT_EQ(2, second.get());
+
+  // Later visitors run immediately.
+  auto third = internal::AsyncVisit(
+      txn, [](SessionHolder&, StatusOr<TransactionSelector>& s, std::int64_t) {
+        EXPECT_EQ("txn-id", s->id());
+        return make_ready_future(3);
+      });
+  EXPECT_EQ(3, third.get());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace SPANNER_CLIENT_NS
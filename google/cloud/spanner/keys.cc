@@ -26,7 +26,7 @@ namespace {
 // Appends the values in the given `key` to the `lv` proto.
 void AppendKey(google::protobuf::ListValue& lv, Key&& key) {
   for (auto& v : key) {
-    *lv.add_values() = internal::ToProto(std::move(v)).second;
+    internal::ToProto(std::move(v), *lv.add_values());
   }
 }
 }  // namespace
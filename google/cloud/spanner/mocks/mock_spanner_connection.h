@@ -57,6 +57,13 @@ class MockConnection : public spanner::Connection {
                StatusOr<spanner::BatchDmlResult>(ExecuteBatchDmlParams));
   MOCK_METHOD1(Commit, StatusOr<spanner::CommitResult>(CommitParams));
   MOCK_METHOD1(Rollback, Status(RollbackParams));
+  MOCK_METHOD1(AsyncRead, future<spanner::AsyncRowStream>(ReadParams));
+  MOCK_METHOD1(AsyncExecuteQuery, future<spanner::AsyncRowStream>(SqlParams));
+  MOCK_METHOD1(AsyncExecuteDml,
+               future<StatusOr<spanner::DmlResult>>(SqlParams));
+  MOCK_METHOD1(AsyncCommit,
+               future<StatusOr<spanner::CommitResult>>(CommitParams));
+  MOCK_METHOD1(AsyncRollback, future<Status>(RollbackParams));
 };
 
 /**
@@ -73,6 +80,19 @@ class MockResultSetSource : public spanner::internal::ResultSourceInterface {
                      absl::optional<google::spanner::v1::ResultSetStats>());
 };
 
+/**
+ * Mock the results of a AsyncExecuteQuery() or AsyncRead() operation.
+ */
+class MockAsyncResultSetSource
+    : public spanner::internal::AsyncResultSourceInterface {
+ public:
+  MOCK_METHOD0(NextRow, future<StatusOr<spanner::Row>>());
+  MOCK_METHOD0(Metadata,
+               absl::optional<google::spanner::v1::ResultSetMetadata>());
+  MOCK_CONST_METHOD0(Stats,
+                     absl::optional<google::spanner::v1::ResultSetStats>());
+};
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner_mocks
 }  // namespace cloud
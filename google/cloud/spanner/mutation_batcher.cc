@@ -0,0 +1,314 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/mutation_batcher.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/connection_options.h"
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+namespace spanner_proto = ::google::spanner::v1;
+
+// Cloud Spanner doesn't accept more than this many mutations in a commit.
+auto constexpr kSpannerMutationLimit = 20000;
+// Commits can be much larger, but very large commits take longer and hold
+// their locks for longer, so the batches are kept moderate by default.
+auto constexpr kDefaultMaxSizePerBatch = 4 * 1024 * 1024;
+auto constexpr kDefaultMaxBatches = 8;
+auto constexpr kDefaultMaxOutstandingSize =
+    kDefaultMaxSizePerBatch * kDefaultMaxBatches;
+
+spanner_proto::Mutation::Write const* WriteOf(
+    spanner_proto::Mutation const& m) {
+  switch (m.operation_case()) {
+    case spanner_proto::Mutation::kInsert:
+      return &m.insert();
+    case spanner_proto::Mutation::kUpdate:
+      return &m.update();
+    case spanner_proto::Mutation::kInsertOrUpdate:
+      return &m.insert_or_update();
+    case spanner_proto::Mutation::kReplace:
+      return &m.replace();
+    default:
+      return nullptr;
+  }
+}
+
+/// The number of mutations in @p m, as counted by Cloud Spanner.
+std::size_t CountMutations(spanner_proto::Mutation const& m) {
+  if (auto const* write = WriteOf(m)) {
+    auto const cells = static_cast<std::size_t>(write->columns_size()) *
+                       static_cast<std::size_t>(write->values_size());
+    return cells == 0 ? 1 : cells;
+  }
+  if (m.operation_case() != spanner_proto::Mutation::kDelete) return 0;
+  auto const& key_set = m.delete_().key_set();
+  auto const keys =
+      static_cast<std::size_t>(key_set.keys_size() + key_set.ranges_size());
+  return keys == 0 ? 1 : keys;
+}
+
+std::string const& TableOf(spanner_proto::Mutation const& m) {
+  if (auto const* write = WriteOf(m)) return write->table();
+  return m.delete_().table();
+}
+
+}  // namespace
+
+MutationBatcher::Options::Options()
+    : max_mutations_per_batch(kSpannerMutationLimit),
+      max_size_per_batch(kDefaultMaxSizePerBatch),
+      max_batches(kDefaultMaxBatches),
+      max_outstanding_size(kDefaultMaxOutstandingSize),
+      group_by_table(false),
+      // Use the same defaults as `Client::Commit(Mutations)`.
+      rerun_policy(
+          LimitedTimeTransactionRerunPolicy(std::chrono::minutes(10)).clone()),
+      backoff_policy(ExponentialBackoffPolicy(std::chrono::milliseconds(100),
+                                              std::chrono::minutes(5), 2.0)
+                         .clone()) {}
+
+std::pair<future<void>, future<StatusOr<CommitResult>>>
+MutationBatcher::AsyncApply(Mutation mut) {
+  AdmissionPromise admission_promise;
+  CompletionPromise completion_promise;
+  auto res = std::make_pair(admission_promise.get_future(),
+                            completion_promise.get_future());
+  PendingMutation pending(std::move(mut), std::move(completion_promise),
+                          std::move(admission_promise));
+  std::unique_lock<std::mutex> lk(mu_);
+
+  auto mutation_status = IsValid(pending);
+  if (!mutation_status.ok()) {
+    lk.unlock();
+    // Destroy the mutation before satisfying the admission promise so that we
+    // can limit the memory usage.
+    pending.mut = Mutation();
+    pending.completion_promise.set_value(std::move(mutation_status));
+    // No need to consider no_more_pending_promises because this operation
+    // didn't lower the number of pending operations.
+    pending.admission_promise.set_value();
+    return res;
+  }
+  ++num_requests_pending_;
+
+  if (!CanAppendToBatch(pending)) {
+    pending_mutations_.push(std::move(pending));
+    return res;
+  }
+  std::vector<AdmissionPromise> admission_promises_to_satisfy;
+  admission_promises_to_satisfy.emplace_back(
+      std::move(pending.admission_promise));
+  Admit(std::move(pending));
+  std::vector<Batch> batches;
+  TakeBatches(batches);
+  SatisfyPromises(std::move(admission_promises_to_satisfy), lk);
+  Send(std::move(batches));
+  return res;
+}
+
+future<void> MutationBatcher::AsyncWaitForNoPendingRequests() {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (num_requests_pending_ == 0) {
+    return make_ready_future();
+  }
+  no_more_pending_promises_.emplace_back();
+  return no_more_pending_promises_.back().get_future();
+}
+
+future<StatusOr<CommitResult>> MutationBatcher::AsyncCommitImpl(
+    Client client, Mutations mutations) {
+  return client.AsyncCommit(MakeReadWriteTransaction(), std::move(mutations));
+}
+
+future<void> MutationBatcher::AsyncSleep(std::chrono::milliseconds delay) {
+  std::unique_lock<std::mutex> lk(mu_);
+  if (!background_threads_) {
+    background_threads_ = google::cloud::internal::DefaultBackgroundThreads(1);
+  }
+  auto cq = background_threads_->cq();
+  lk.unlock();
+  return cq.MakeRelativeTimer(delay).then(
+      [](future<StatusOr<std::chrono::system_clock::time_point>>) {});
+}
+
+MutationBatcher::PendingMutation::PendingMutation(
+    Mutation mut_arg, CompletionPromise completion_promise,
+    AdmissionPromise admission_promise)
+    : mut(std::move(mut_arg)),
+      completion_promise(std::move(completion_promise)),
+      admission_promise(std::move(admission_promise)) {
+  auto const& proto = internal::MutationProto(mut);
+  // These operations might not be cheap, so let's cache them.
+  table = TableOf(proto);
+  num_mutations = CountMutations(proto);
+  request_size = proto.ByteSizeLong();
+}
+
+Status MutationBatcher::IsValid(PendingMutation const& mut) const {
+  // Objects of this class need to be aware of the maximum allowed number of
+  // mutations in a batch because it should not pack more. If we have this
+  // knowledge, we might as well simplify everything and not admit larger
+  // mutations.
+  if (mut.num_mutations > options_.max_mutations_per_batch) {
+    std::stringstream stream;
+    stream << "Too many (" << mut.num_mutations
+           << ") mutations in a Mutation. " << options_.max_mutations_per_batch
+           << " is the limit.";
+    return Status(StatusCode::kInvalidArgument, stream.str());
+  }
+  if (mut.num_mutations == 0) {
+    return Status(StatusCode::kInvalidArgument, "Supplied Mutation is empty");
+  }
+  if (mut.request_size > options_.max_size_per_batch) {
+    std::stringstream stream;
+    stream << "Too large (" << mut.request_size << " bytes) Mutation. "
+           << options_.max_size_per_batch << " bytes is the limit.";
+    return Status(StatusCode::kInvalidArgument, stream.str());
+  }
+  return Status();
+}
+
+bool MutationBatcher::HasSpaceFor(PendingMutation const& mut) const {
+  if (outstanding_size_ + mut.request_size > options_.max_outstanding_size) {
+    return false;
+  }
+  auto const b = cur_batches_.find(BatchKey(mut));
+  if (b == cur_batches_.end()) return true;
+  return b->second.requests_size + mut.request_size <=
+             options_.max_size_per_batch &&
+         b->second.num_mutations + mut.num_mutations <=
+             options_.max_mutations_per_batch;
+}
+
+void MutationBatcher::Admit(PendingMutation mut) {
+  auto& batch = cur_batches_[BatchKey(mut)];
+  outstanding_size_ += mut.request_size;
+  batch.requests_size += mut.request_size;
+  batch.num_mutations += mut.num_mutations;
+  batch.mutations.push_back(std::move(mut.mut));
+  batch.completion_promises.push_back(std::move(mut.completion_promise));
+}
+
+bool MutationBatcher::TakeBatches(std::vector<Batch>& batches) {
+  bool taken = false;
+  while (!cur_batches_.empty() &&
+         num_outstanding_batches_ < options_.max_batches) {
+    ++num_outstanding_batches_;
+    // Take the batches in turns, so no table is starved.
+    auto b = cur_batches_.upper_bound(last_batch_key_);
+    if (b == cur_batches_.end()) b = cur_batches_.begin();
+    last_batch_key_ = b->first;
+    batches.push_back(std::move(b->second));
+    cur_batches_.erase(b);
+    taken = true;
+  }
+  return taken;
+}
+
+std::vector<MutationBatcher::AdmissionPromise> MutationBatcher::TryAdmit(
+    std::vector<Batch>& batches) {
+  // Defer satisfying promises until we release the lock.
+  std::vector<AdmissionPromise> admission_promises;
+
+  do {
+    while (!pending_mutations_.empty() &&
+           HasSpaceFor(pending_mutations_.front())) {
+      auto& mut = pending_mutations_.front();
+      admission_promises.emplace_back(std::move(mut.admission_promise));
+      Admit(std::move(mut));
+      pending_mutations_.pop();
+    }
+  } while (TakeBatches(batches));
+  return admission_promises;
+}
+
+void MutationBatcher::Send(std::vector<Batch> batches) {
+  for (auto& b : batches) {
+    CommitBatch(std::make_shared<Batch>(std::move(b)),
+                options_.rerun_policy->clone(),
+                options_.backoff_policy->clone());
+  }
+}
+
+void MutationBatcher::CommitBatch(
+    std::shared_ptr<Batch> batch,
+    std::shared_ptr<TransactionRerunPolicy> rerun_policy,
+    std::shared_ptr<BackoffPolicy> backoff_policy) {
+  // The commit may complete immediately, calling `OnCommitDone()` from this
+  // thread, which is why `mu_` must not be held here. The batch keeps its
+  // mutations in case the commit needs to be rerun.
+  AsyncCommitImpl(client_, batch->mutations)
+      .then([this, batch, rerun_policy,
+             backoff_policy](future<StatusOr<CommitResult>> f) {
+        auto result = f.get();
+        if (result || !rerun_policy->OnFailure(result.status())) {
+          batch->mutations = {};
+          OnCommitDone(std::move(*batch), result);
+          return;
+        }
+        AsyncSleep(backoff_policy->OnCompletion())
+            .then([this, batch, rerun_policy, backoff_policy](future<void>) {
+              CommitBatch(batch, rerun_policy, backoff_policy);
+            });
+      });
+}
+
+void MutationBatcher::OnCommitDone(Batch batch,
+                                   StatusOr<CommitResult> const& result) {
+  // All the mutations in a batch are committed (or not) together.
+  for (auto& promise : batch.completion_promises) {
+    promise.set_value(result);
+  }
+  auto const num_mutations = batch.completion_promises.size();
+  batch.completion_promises.clear();
+
+  std::unique_lock<std::mutex> lk(mu_);
+  outstanding_size_ -= batch.requests_size;
+  num_requests_pending_ -= num_mutations;
+  num_outstanding_batches_--;
+  std::vector<Batch> batches;
+  auto admission_promises = TryAdmit(batches);
+  SatisfyPromises(std::move(admission_promises), lk);  // unlocks the lock
+  Send(std::move(batches));
+}
+
+void MutationBatcher::SatisfyPromises(
+    std::vector<AdmissionPromise> admission_promises,
+    std::unique_lock<std::mutex>& lk) {
+  std::vector<NoMorePendingPromise> no_more_pending_promises;
+  if (num_requests_pending_ == 0 && num_outstanding_batches_ == 0) {
+    no_more_pending_promises_.swap(no_more_pending_promises);
+  }
+  lk.unlock();
+
+  // Inform the user that we've admitted these mutations and there might be some
+  // space in the buffer finally.
+  for (auto& promise : admission_promises) {
+    promise.set_value();
+  }
+  for (auto& promise : no_more_pending_promises) {
+    promise.set_value();
+  }
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
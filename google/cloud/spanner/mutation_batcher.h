@@ -0,0 +1,346 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
+
+#include "google/cloud/spanner/backoff_policy.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/commit_result.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/retry_policy.h"
+#include "google/cloud/spanner/version.h"
+#include "google/cloud/background_threads.h"
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * Objects of this class pack individual mutations into commits.
+ *
+ * In order to maximize throughput when writing a lot of data with blind
+ * writes (i.e., mutations that do not depend on any reads), one should pack
+ * many mutations in each commit, stay under the per-commit limits of Cloud
+ * Spanner, and keep several commits in flight. This class helps in doing so.
+ * Create a `MutationBatcher` and use `MutationBatcher::AsyncApply()` to apply
+ * a large stream of mutations. Each batch of mutations is committed in its
+ * own read-write transaction, using the sessions of the `Client`. Like
+ * `Client::Commit(Mutations)`, a batch whose commit is aborted is committed
+ * again in a new transaction, see `Options::SetRerunPolicy()`.
+ *
+ * Because the mutations in a batch are committed atomically, all of them
+ * fail or succeed together, and report the same commit timestamp. The
+ * mutations applied through the same `MutationBatcher` have no ordering
+ * guarantees between them, unless they are committed in the same batch.
+ *
+ * This class also offers an easy-to-use flow control mechanism to avoid
+ * unbounded growth in its internal buffers.
+ *
+ * @par Thread-safety
+ * Instances of this class are guaranteed to work when accessed concurrently
+ * from multiple threads. Applications must not destroy a `MutationBatcher`
+ * until the future returned by `AsyncWaitForNoPendingRequests()` is
+ * satisfied.
+ */
+class MutationBatcher {
+ public:
+  /// Configuration for `MutationBatcher`.
+  struct Options {
+    Options();
+
+    /**
+     * A single commit will not have more mutations than this.
+     *
+     * Mutations are counted as Cloud Spanner does: each inserted or updated
+     * cell, and each deleted key or key range, counts as one mutation. Note
+     * that Cloud Spanner also counts the changes to secondary indexes.
+     */
+    Options& SetMaxMutationsPerBatch(std::size_t max_mutations_per_batch_arg) {
+      max_mutations_per_batch = max_mutations_per_batch_arg;
+      return *this;
+    }
+
+    /// Sum of mutations' sizes in a single commit will not be larger than this.
+    Options& SetMaxSizePerBatch(std::size_t max_size_per_batch_arg) {
+      max_size_per_batch = max_size_per_batch_arg;
+      return *this;
+    }
+
+    /// There will be no more commits outstanding than this.
+    Options& SetMaxBatches(std::size_t max_batches_arg) {
+      max_batches = max_batches_arg;
+      return *this;
+    }
+
+    /// MutationBatcher will at most admit mutations of this total size.
+    Options& SetMaxOutstandingSize(std::size_t max_outstanding_size_arg) {
+      max_outstanding_size = max_outstanding_size_arg;
+      return *this;
+    }
+
+    /**
+     * Only mutations on the same table are committed together.
+     *
+     * Commits that change a single table usually involve fewer splits, and
+     * are therefore cheaper for Cloud Spanner.
+     */
+    Options& SetGroupByTable(bool group_by_table_arg) {
+      group_by_table = group_by_table_arg;
+      return *this;
+    }
+
+    /**
+     * Controls how often a batch is committed again after the commit fails
+     * with a transient error, such as `kAborted`.
+     *
+     * The default policy reruns the commit for up to 10 minutes, as
+     * `Client::Commit(Mutations)` does.
+     */
+    Options& SetRerunPolicy(TransactionRerunPolicy const& rerun_policy_arg) {
+      rerun_policy = rerun_policy_arg.clone();
+      return *this;
+    }
+
+    /// Controls how long to wait before committing an aborted batch again.
+    Options& SetBackoffPolicy(BackoffPolicy const& backoff_policy_arg) {
+      backoff_policy = backoff_policy_arg.clone();
+      return *this;
+    }
+
+    std::size_t max_mutations_per_batch;
+    std::size_t max_size_per_batch;
+    std::size_t max_batches;
+    std::size_t max_outstanding_size;
+    bool group_by_table;
+    std::shared_ptr<TransactionRerunPolicy const> rerun_policy;
+    std::shared_ptr<BackoffPolicy const> backoff_policy;
+  };
+
+  explicit MutationBatcher(Client client, Options options = Options())
+      : client_(std::move(client)), options_(options) {}
+
+  virtual ~MutationBatcher() = default;
+
+  /**
+   * Asynchronously apply a mutation.
+   *
+   * The mutation will most likely be batched together with others to optimize
+   * for throughput. As a result, latency is likely to be worse than
+   * `Client::Commit()`.
+   *
+   * @param mut the mutation.
+   *
+   * @return *admission* and *completion* futures
+   *
+   * The *completion* future will report the result of the commit including
+   * the mutation, with its commit timestamp, once it completes.
+   *
+   * The *admission* future should be used for flow control. In order to bound
+   * the memory usage used by `MutationBatcher`, one should not submit more
+   * mutations before the *admission* future is satisfied. Note that while the
+   * future is often already satisfied when the function returns, applications
+   * should not assume that this is always the case.
+   *
+   * One should not make assumptions on which future will be satisfied first.
+   *
+   * This quasi-synchronous example shows the intended use:
+   * @code
+   * spanner::MutationBatcher batcher(spanner::Client(...args...));
+   *
+   * while (HasMoreMutations()) {
+   *   auto admission_completion = batcher.AsyncApply(GenerateMutation());
+   *   auto& admission_future = admission_completion.first;
+   *   auto& completion_future = admission_completion.second;
+   *   completion_future.then([](future<StatusOr<CommitResult>> f) {
+   *       // handle mutation completion asynchronously
+   *       });
+   *   // Potentially slow down submission not to make buffers in
+   *   // MutationBatcher grow unbounded.
+   *   admission_future.get();
+   * }
+   * // Wait for all mutations to complete
+   * batcher.AsyncWaitForNoPendingRequests().get();
+   * @endcode
+   */
+  std::pair<future<void>, future<StatusOr<CommitResult>>> AsyncApply(
+      Mutation mut);
+
+  /**
+   * Asynchronously wait until all submitted mutations complete.
+   *
+   * @return a future which will be satisfied once all mutations submitted
+   *     before calling this function finish; if there are no such operations,
+   *     the returned future is already satisfied.
+   */
+  future<void> AsyncWaitForNoPendingRequests();
+
+ protected:
+  // Wrap calling underlying operation in a virtual function to ease testing.
+  virtual future<StatusOr<CommitResult>> AsyncCommitImpl(Client client,
+                                                         Mutations mutations);
+  // Wait before rerunning an aborted commit, virtual to ease testing.
+  virtual future<void> AsyncSleep(std::chrono::milliseconds delay);
+
+ private:
+  using CompletionPromise = promise<StatusOr<CommitResult>>;
+  using AdmissionPromise = promise<void>;
+  using NoMorePendingPromise = promise<void>;
+
+  /**
+   * This structure represents a single mutation before it is admitted.
+   */
+  struct PendingMutation {
+    PendingMutation(Mutation mut_arg, CompletionPromise completion_promise,
+                    AdmissionPromise admission_promise);
+
+    Mutation mut;
+    std::string table;
+    std::size_t num_mutations;
+    std::size_t request_size;
+    CompletionPromise completion_promise;
+    AdmissionPromise admission_promise;
+  };
+
+  /**
+   * This class represents a single batch of mutations sent in one commit.
+   *
+   * Objects of this class hold the accumulated mutations, their completion
+   * promises and basic statistics.
+   */
+  struct Batch {
+    std::size_t num_mutations = 0;
+    std::size_t requests_size = 0;
+    Mutations mutations;
+    std::vector<CompletionPromise> completion_promises;
+  };
+
+  /// Check if a mutation doesn't exceed allowed limits.
+  Status IsValid(PendingMutation const& mut) const;
+
+  /// The key in `cur_batches_` of the batch for @p mut.
+  std::string const& BatchKey(PendingMutation const& mut) const {
+    static auto const* const kNoKey = new std::string;
+    return options_.group_by_table ? mut.table : *kNoKey;
+  }
+
+  /**
+   * Check whether there is space for the passed mutation in the batch
+   * currently constructed for it.
+   */
+  bool HasSpaceFor(PendingMutation const& mut) const;
+
+  /**
+   * Check if one can append a mutation to the currently constructed batch.
+   * Even if there is space for the mutation, we shouldn't append mutations if
+   * some other are not admitted yet.
+   */
+  bool CanAppendToBatch(PendingMutation const& mut) const {
+    // If some mutations are already subject to flow control, don't admit any
+    // new, even if there's space for them. Otherwise we might starve big
+    // mutations.
+    return pending_mutations_.empty() && HasSpaceFor(mut);
+  }
+
+  /// Append mutation @p mut to the batch currently constructed for it.
+  void Admit(PendingMutation mut);
+
+  /**
+   * Removes the batches that can be sent, if there are not too many
+   * outstanding already, and moves them to @p batches.
+   *
+   * @return true if any batch was removed.
+   */
+  bool TakeBatches(std::vector<Batch>& batches);
+
+  /**
+   * Try to move mutations waiting in `pending_mutations_` to the currently
+   * constructed batches, taking the batches that can be sent.
+   *
+   * @return the admission promises of the newly admitted mutations.
+   */
+  std::vector<AdmissionPromise> TryAdmit(std::vector<Batch>& batches);
+
+  /// Commits @p batches, must be called without holding `mu_`.
+  void Send(std::vector<Batch> batches);
+
+  /// Commits @p batch, and commits it again while @p rerun_policy allows it.
+  void CommitBatch(std::shared_ptr<Batch> batch,
+                   std::shared_ptr<TransactionRerunPolicy> rerun_policy,
+                   std::shared_ptr<BackoffPolicy> backoff_policy);
+
+  /// Handle a completed batch.
+  void OnCommitDone(Batch batch, StatusOr<CommitResult> const& result);
+
+  /**
+   * Satisfies passed admission promises and potentially the promises of no more
+   * pending requests. Unlocks `lk`.
+   */
+  void SatisfyPromises(std::vector<AdmissionPromise>,
+                       std::unique_lock<std::mutex>& lk);
+
+  std::mutex mu_;
+  Client const client_;
+  Options const options_;
+
+  /// Num batches sent but not completed.
+  std::size_t num_outstanding_batches_ = 0;
+  /// Size of admitted but uncompleted mutations.
+  std::size_t outstanding_size_ = 0;
+  /// Number of uncompleted mutations (including not admitted).
+  std::size_t num_requests_pending_ = 0;
+
+  /// Currently constructed batches of mutations, by `BatchKey()`.
+  std::map<std::string, Batch> cur_batches_;
+  /// The key of the last batch sent.
+  std::string last_batch_key_;
+
+  /**
+   * These are the mutations which have not been admitted yet. If the user is
+   * properly reacting to `admission_promise`s, there should be very few of
+   * these (likely no more than one).
+   */
+  std::queue<PendingMutation> pending_mutations_;
+
+  /**
+   * The list of promises made to this point.
+   *
+   * These promises are satisfied as part of calling
+   * `AsyncWaitForNoPendingRequests()`.
+   */
+  std::vector<NoMorePendingPromise> no_more_pending_promises_;
+
+  /// Runs the backoff timers, created when the first commit is aborted.
+  std::unique_ptr<BackgroundThreads> background_threads_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_MUTATION_BATCHER_H
@@ -0,0 +1,252 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/mutation_batcher.h"
+#include "google/cloud/spanner/mocks/mock_spanner_connection.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::spanner_mocks::MockConnection;
+using ::google::cloud::testing_util::StatusIs;
+using ::testing::ElementsAre;
+
+/// A batcher that records its commits, to be completed by the test.
+class TestBatcher : public MutationBatcher {
+ public:
+  explicit TestBatcher(MutationBatcher::Options options)
+      : MutationBatcher(Client(std::make_shared<MockConnection>()), options) {}
+
+  struct Commit {
+    Mutations mutations;
+    promise<StatusOr<CommitResult>> result;
+  };
+
+  std::vector<std::unique_ptr<Commit>> commits;
+  std::vector<std::chrono::milliseconds> sleeps;
+
+  /// Completes the commit at position @p index with @p result.
+  void Complete(std::size_t index, StatusOr<CommitResult> result) {
+    commits.at(index)->result.set_value(std::move(result));
+  }
+
+ protected:
+  future<StatusOr<CommitResult>> AsyncCommitImpl(Client,
+                                                 Mutations mutations) override {
+    commits.emplace_back(new Commit{std::move(mutations), {}});
+    return commits.back()->result.get_future();
+  }
+
+  future<void> AsyncSleep(std::chrono::milliseconds delay) override {
+    sleeps.push_back(delay);
+    return make_ready_future();
+  }
+};
+
+Mutation MakeInsert(std::string const& table, std::int64_t id) {
+  return MakeInsertMutation(table, {"Id", "Name"}, id,
+                            "name-" + std::to_string(id));
+}
+
+CommitResult MakeCommitResult(std::int64_t seconds) {
+  return CommitResult{
+      MakeTimestamp(std::chrono::system_clock::from_time_t(seconds)).value()};
+}
+
+TEST(MutationBatcherTest, Trivial) {
+  TestBatcher batcher(MutationBatcher::Options{});
+  auto res = batcher.AsyncApply(MakeInsert("T", 1));
+  EXPECT_TRUE(res.first.is_ready());
+  ASSERT_EQ(1, batcher.commits.size());
+  EXPECT_THAT(batcher.commits[0]->mutations, ElementsAre(MakeInsert("T", 1)));
+
+  auto no_more_pending = batcher.AsyncWaitForNoPendingRequests();
+  EXPECT_FALSE(no_more_pending.is_ready());
+  batcher.Complete(0, MakeCommitResult(42));
+  auto result = res.second.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(MakeCommitResult(42).commit_timestamp, result->commit_timestamp);
+  EXPECT_TRUE(no_more_pending.is_ready());
+}
+
+TEST(MutationBatcherTest, BatchesWhileCommitsAreOutstanding) {
+  TestBatcher batcher(MutationBatcher::Options{}.SetMaxBatches(1));
+  std::vector<future<StatusOr<CommitResult>>> results;
+  for (std::int64_t id = 0; id != 4; ++id) {
+    results.push_back(batcher.AsyncApply(MakeInsert("T", id)).second);
+  }
+  // The first mutation is sent immediately, the rest wait for a free slot.
+  ASSERT_EQ(1, batcher.commits.size());
+  batcher.Complete(0, MakeCommitResult(1));
+  ASSERT_EQ(2, batcher.commits.size());
+  EXPECT_THAT(batcher.commits[1]->mutations,
+              ElementsAre(MakeInsert("T", 1), MakeInsert("T", 2),
+                          MakeInsert("T", 3)));
+  batcher.Complete(1, MakeCommitResult(2));
+
+  std::vector<Timestamp> timestamps;
+  for (auto& r : results) {
+    auto result = r.get();
+    ASSERT_STATUS_OK(result);
+    timestamps.push_back(result->commit_timestamp);
+  }
+  auto const t1 = MakeCommitResult(1).commit_timestamp;
+  auto const t2 = MakeCommitResult(2).commit_timestamp;
+  EXPECT_THAT(timestamps, ElementsAre(t1, t2, t2, t2));
+}
+
+TEST(MutationBatcherTest, MaxMutationsPerBatch) {
+  // Each mutation changes 2 cells.
+  TestBatcher batcher(MutationBatcher::Options{}
+                          .SetMaxBatches(1)
+                          .SetMaxMutationsPerBatch(4));
+  for (std::int64_t id = 0; id != 4; ++id) {
+    batcher.AsyncApply(MakeInsert("T", id));
+  }
+  ASSERT_EQ(1, batcher.commits.size());
+  batcher.Complete(0, MakeCommitResult(1));
+  ASSERT_EQ(2, batcher.commits.size());
+  EXPECT_EQ(2, batcher.commits[1]->mutations.size());
+  batcher.Complete(1, MakeCommitResult(2));
+  ASSERT_EQ(3, batcher.commits.size());
+  EXPECT_EQ(1, batcher.commits[2]->mutations.size());
+  batcher.Complete(2, MakeCommitResult(3));
+}
+
+TEST(MutationBatcherTest, InvalidMutations) {
+  TestBatcher batcher(MutationBatcher::Options{}.SetMaxMutationsPerBatch(3));
+  auto empty = batcher.AsyncApply(Mutation());
+  EXPECT_TRUE(empty.first.is_ready());
+  EXPECT_THAT(empty.second.get(), StatusIs(StatusCode::kInvalidArgument));
+
+  auto too_many = batcher.AsyncApply(InsertMutationBuilder("T", {"Id", "Name"})
+                                        .EmplaceRow(1, "a")
+                                        .EmplaceRow(2, "b")
+                                        .Build());
+  EXPECT_THAT(too_many.second.get(), StatusIs(StatusCode::kInvalidArgument));
+
+  TestBatcher small(MutationBatcher::Options{}.SetMaxSizePerBatch(8));
+  auto too_large = small.AsyncApply(MakeInsert("T", 1));
+  EXPECT_THAT(too_large.second.get(), StatusIs(StatusCode::kInvalidArgument));
+
+  EXPECT_TRUE(batcher.commits.empty());
+  EXPECT_TRUE(small.commits.empty());
+}
+
+TEST(MutationBatcherTest, FlowControl) {
+  auto const size = internal::MutationProto(MakeInsert("T", 1)).ByteSizeLong();
+  TestBatcher batcher(MutationBatcher::Options{}.SetMaxOutstandingSize(size));
+  auto first = batcher.AsyncApply(MakeInsert("T", 1));
+  EXPECT_TRUE(first.first.is_ready());
+  auto second = batcher.AsyncApply(MakeInsert("T", 2));
+  EXPECT_FALSE(second.first.is_ready());
+  ASSERT_EQ(1, batcher.commits.size());
+
+  batcher.Complete(0, MakeCommitResult(1));
+  EXPECT_TRUE(second.first.is_ready());
+  ASSERT_EQ(2, batcher.commits.size());
+  batcher.Complete(1, MakeCommitResult(2));
+  EXPECT_STATUS_OK(second.second.get());
+}
+
+TEST(MutationBatcherTest, GroupByTable) {
+  TestBatcher batcher(
+      MutationBatcher::Options{}.SetMaxBatches(1).SetGroupByTable(true));
+  batcher.AsyncApply(MakeInsert("A", 0));
+  batcher.AsyncApply(MakeInsert("A", 1));
+  batcher.AsyncApply(MakeInsert("B", 2));
+  batcher.AsyncApply(MakeInsert("A", 3));
+  ASSERT_EQ(1, batcher.commits.size());
+  batcher.Complete(0, MakeCommitResult(1));
+  ASSERT_EQ(2, batcher.commits.size());
+  batcher.Complete(1, MakeCommitResult(2));
+  ASSERT_EQ(3, batcher.commits.size());
+  batcher.Complete(2, MakeCommitResult(3));
+
+  // The batches alternate between tables, starting after the last one sent.
+  EXPECT_THAT(batcher.commits[1]->mutations, ElementsAre(MakeInsert("B", 2)));
+  EXPECT_THAT(batcher.commits[2]->mutations,
+              ElementsAre(MakeInsert("A", 1), MakeInsert("A", 3)));
+}
+
+TEST(MutationBatcherTest, CommitFailure) {
+  TestBatcher batcher(MutationBatcher::Options{}.SetMaxBatches(1));
+  auto first = batcher.AsyncApply(MakeInsert("T", 1));
+  auto second = batcher.AsyncApply(MakeInsert("T", 2));
+  auto third = batcher.AsyncApply(MakeInsert("T", 3));
+  batcher.Complete(0, MakeCommitResult(1));
+  batcher.Complete(1, Status(StatusCode::kPermissionDenied, "uh-oh"));
+  EXPECT_STATUS_OK(first.second.get());
+  EXPECT_THAT(second.second.get(), StatusIs(StatusCode::kPermissionDenied));
+  EXPECT_THAT(third.second.get(), StatusIs(StatusCode::kPermissionDenied));
+  EXPECT_TRUE(batcher.AsyncWaitForNoPendingRequests().is_ready());
+  EXPECT_TRUE(batcher.sleeps.empty());
+}
+
+TEST(MutationBatcherTest, RerunAbortedCommit) {
+  TestBatcher batcher(
+      MutationBatcher::Options{}.SetMaxBatches(1).SetBackoffPolicy(
+          ExponentialBackoffPolicy(std::chrono::milliseconds(10),
+                                   std::chrono::milliseconds(10), 2.0)));
+  auto first = batcher.AsyncApply(MakeInsert("T", 1));
+  auto second = batcher.AsyncApply(MakeInsert("T", 2));
+  batcher.Complete(0, Status(StatusCode::kAborted, "aborted"));
+
+  // The aborted batch is committed again, before any other batch.
+  ASSERT_EQ(2, batcher.commits.size());
+  EXPECT_THAT(batcher.commits[1]->mutations, ElementsAre(MakeInsert("T", 1)));
+  EXPECT_THAT(batcher.sleeps, ElementsAre(std::chrono::milliseconds(10)));
+  EXPECT_FALSE(first.second.is_ready());
+  batcher.Complete(1, MakeCommitResult(1));
+  auto result = first.second.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ(MakeCommitResult(1).commit_timestamp, result->commit_timestamp);
+
+  ASSERT_EQ(3, batcher.commits.size());
+  EXPECT_THAT(batcher.commits[2]->mutations, ElementsAre(MakeInsert("T", 2)));
+  batcher.Complete(2, MakeCommitResult(2));
+  EXPECT_STATUS_OK(second.second.get());
+  EXPECT_TRUE(batcher.AsyncWaitForNoPendingRequests().is_ready());
+}
+
+TEST(MutationBatcherTest, RerunExhausted) {
+  TestBatcher batcher(MutationBatcher::Options{}.SetRerunPolicy(
+      LimitedErrorCountTransactionRerunPolicy(1)));
+  auto res = batcher.AsyncApply(MakeInsert("T", 1));
+  batcher.Complete(0, Status(StatusCode::kAborted, "aborted"));
+  ASSERT_EQ(2, batcher.commits.size());
+  batcher.Complete(1, Status(StatusCode::kAborted, "aborted again"));
+  EXPECT_THAT(res.second.get(), StatusIs(StatusCode::kAborted));
+  EXPECT_EQ(2, batcher.commits.size());
+  EXPECT_EQ(1, batcher.sleeps.size());
+  EXPECT_TRUE(batcher.AsyncWaitForNoPendingRequests().is_ready());
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
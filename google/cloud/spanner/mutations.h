@@ -26,10 +26,13 @@ namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
+class Mutation;
+
 namespace internal {
 template <typename Op>
 class WriteMutationBuilder;
 class DeleteMutationBuilder;
+google::spanner::v1::Mutation const& MutationProto(Mutation const& m);
 }  // namespace internal
 
 /**
@@ -84,6 +87,8 @@ class Mutation {
   template <typename Op>
   friend class internal::WriteMutationBuilder;
   friend class internal::DeleteMutationBuilder;
+  friend google::spanner::v1::Mutation const& internal::MutationProto(
+      Mutation const&);
   explicit Mutation(google::spanner::v1::Mutation m) : m_(std::move(m)) {}
 
   google::spanner::v1::Mutation m_;
@@ -99,6 +104,11 @@ using Mutations = std::vector<Mutation>;
 // API, and subject to change without notice.
 namespace internal {
 
+/// Returns the proto held by @p m, without copying it.
+inline google::spanner::v1::Mutation const& MutationProto(Mutation const& m) {
+  return m.m_;
+}
+
 template <typename Op>
 class WriteMutationBuilder {
  public:
@@ -118,7 +128,7 @@ class WriteMutationBuilder {
   WriteMutationBuilder& AddRow(std::vector<Value> values) & {
     auto& lv = *Op::mutable_field(m_.proto()).add_values();
     for (auto& v : values) {
-      std::tie(std::ignore, *lv.add_values()) = internal::ToProto(std::move(v));
+      internal::ToProto(std::move(v), *lv.add_values());
     }
     return *this;
   }
@@ -0,0 +1,48 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+PreparedStatement::PreparedStatement(std::string sql,
+                                     std::vector<std::string> param_names) {
+  auto prepared = std::make_shared<internal::PreparedSql>();
+  prepared->sql = std::move(sql);
+  prepared->param_names = std::move(param_names);
+  prepared_ = std::move(prepared);
+}
+
+SqlStatement PreparedStatement::Bind(std::vector<Value> values) const {
+  if (values.size() != prepared_->param_names.size()) {
+    std::ostringstream os;
+    os << "PreparedStatement::Bind() expects "
+       << prepared_->param_names.size() << " values, got " << values.size();
+    google::cloud::internal::ThrowInvalidArgument(os.str());
+  }
+  auto bound = std::make_shared<internal::BoundParams>();
+  bound->prepared = prepared_;
+  bound->values = std::move(values);
+  return SqlStatement(std::move(bound));
+}
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,116 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
+
+#include "google/cloud/spanner/sql_statement.h"
+#include "google/cloud/spanner/value.h"
+#include "google/cloud/spanner/version.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+
+/**
+ * A SQL statement, and the names of its parameters, to execute many times.
+ *
+ * Applications that execute the same statement many times, with different
+ * parameter values, can create a `PreparedStatement` once and use `Bind()` to
+ * create each `SqlStatement`. The SQL text and the parameter names are shared
+ * by all the bound statements, instead of being copied into each one, and the
+ * parameter values are kept in a vector instead of a map. The bound statements
+ * can be used anywhere a `SqlStatement` is accepted.
+ *
+ * The object also counts the requests built from the statements it bound,
+ * which gives applications client-side statistics for each statement.
+ *
+ * @note The statement is prepared on the client only, Cloud Spanner still
+ *     receives (and caches) the full SQL text with each request.
+ *
+ * @par Example
+ * @code
+ * spanner::PreparedStatement select_singer(
+ *     "SELECT FirstName, LastName FROM Singers WHERE SingerId = @id",
+ *     {"id"});
+ * for (std::int64_t id : singer_ids) {
+ *   auto rows = client.ExecuteQuery(select_singer.Bind({spanner::Value(id)}));
+ *   ...
+ * }
+ * @endcode
+ *
+ * @par Thread-safety
+ * `PreparedStatement` objects are immutable (the statistics are updated
+ * atomically), and can be used from multiple threads concurrently.
+ */
+class PreparedStatement {
+ public:
+  /**
+   * Prepares the statement @p sql, with the parameters @p param_names.
+   *
+   * Parameter placeholders are specified by `@<param name>` in @p sql, in the
+   * same way as for `SqlStatement`.
+   */
+  explicit PreparedStatement(std::string sql,
+                             std::vector<std::string> param_names = {});
+
+  /// Copy and move.
+  PreparedStatement(PreparedStatement const&) = default;
+  PreparedStatement(PreparedStatement&&) = default;
+  PreparedStatement& operator=(PreparedStatement const&) = default;
+  PreparedStatement& operator=(PreparedStatement&&) = default;
+
+  /// Returns the SQL statement.
+  std::string const& sql() const { return prepared_->sql; }
+
+  /// Returns the names of the parameters, in the order used by `Bind()`.
+  std::vector<std::string> const& param_names() const {
+    return prepared_->param_names;
+  }
+
+  /**
+   * Returns a `SqlStatement` with the parameter @p values.
+   *
+   * @param values the value of each parameter, in the same order as
+   *     `param_names()`.
+   *
+   * @throw std::invalid_argument if the number of values does not match the
+   *     number of parameters. If exceptions are disabled the program is
+   *     terminated instead.
+   */
+  SqlStatement Bind(std::vector<Value> values) const;
+
+  /**
+   * Returns the number of requests built from the statements bound by this
+   * object, or by its copies.
+   */
+  std::int64_t execution_count() const {
+    return prepared_->execution_count.load();
+  }
+
+ private:
+  std::shared_ptr<internal::PreparedSql const> prepared_;
+};
+
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_PREPARED_STATEMENT_H
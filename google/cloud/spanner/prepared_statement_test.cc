@@ -0,0 +1,118 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/internal/port_platform.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/is_proto_equal.h"
+#include "google/cloud/testing_util/status_matchers.h"
+#include <gmock/gmock.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+using ::google::cloud::testing_util::IsProtoEqual;
+using ::google::cloud::testing_util::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+auto constexpr kSql =
+    "SELECT * FROM Singers WHERE FirstName = @first AND LastName = @last";
+
+TEST(PreparedStatementTest, Accessors) {
+  PreparedStatement prepared(kSql, {"first", "last"});
+  EXPECT_EQ(kSql, prepared.sql());
+  EXPECT_THAT(prepared.param_names(), ElementsAre("first", "last"));
+  EXPECT_EQ(0, prepared.execution_count());
+}
+
+TEST(PreparedStatementTest, BoundStatement) {
+  PreparedStatement prepared(kSql, {"first", "last"});
+  auto const stmt = prepared.Bind({Value("Marc"), Value("Richards")});
+  SqlStatement const expected(
+      kSql, {{"first", Value("Marc")}, {"last", Value("Richards")}});
+
+  EXPECT_EQ(kSql, stmt.sql());
+  EXPECT_EQ(expected.params(), stmt.params());
+  EXPECT_THAT(stmt.ParameterNames(), ElementsAre("first", "last"));
+  auto last = stmt.GetParameter("last");
+  ASSERT_STATUS_OK(last);
+  EXPECT_EQ(Value("Richards"), *last);
+  EXPECT_THAT(stmt.GetParameter("middle"), StatusIs(StatusCode::kNotFound));
+  EXPECT_EQ(expected, stmt);
+  EXPECT_NE(prepared.Bind({Value("Marc"), Value("Other")}), stmt);
+
+  std::ostringstream os;
+  os << stmt;
+  EXPECT_THAT(os.str(), HasSubstr(kSql));
+  EXPECT_THAT(os.str(), HasSubstr("[param]: {last=Richards}"));
+}
+
+TEST(PreparedStatementTest, ToProto) {
+  PreparedStatement prepared(kSql, {"first", "last"});
+  SqlStatement const expected(
+      kSql, {{"first", Value("Marc")}, {"last", Value("Richards")}});
+
+  auto const stmt = prepared.Bind({Value("Marc"), Value("Richards")});
+  auto copy = stmt;
+  EXPECT_THAT(internal::ToProto(std::move(copy)),
+              IsProtoEqual(internal::ToProto(expected)));
+  EXPECT_EQ(1, prepared.execution_count());
+
+  // The values shared with `copy` are still there.
+  EXPECT_EQ(expected, stmt);
+  EXPECT_THAT(internal::ToProto(stmt),
+              IsProtoEqual(internal::ToProto(expected)));
+  EXPECT_EQ(2, prepared.execution_count());
+
+  // Copies of the prepared statement share the statistics.
+  auto prepared_copy = prepared;
+  internal::ToProto(prepared_copy.Bind({Value("a"), Value("b")}));
+  EXPECT_EQ(3, prepared.execution_count());
+}
+
+TEST(PreparedStatementTest, NoParameters) {
+  PreparedStatement prepared("SELECT 1");
+  auto const stmt = prepared.Bind({});
+  EXPECT_EQ(SqlStatement("SELECT 1"), stmt);
+  EXPECT_THAT(internal::ToProto(stmt),
+              IsProtoEqual(internal::ToProto(SqlStatement("SELECT 1"))));
+}
+
+TEST(PreparedStatementTest, BindWrongNumberOfValues) {
+  PreparedStatement prepared(kSql, {"first", "last"});
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(
+      try { prepared.Bind({Value("Marc")}); } catch (
+          std::invalid_argument const& ex) {
+        EXPECT_THAT(ex.what(), HasSubstr("expects 2 values, got 1"));
+        throw;
+      },
+      std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(prepared.Bind({Value("Marc")}),
+                            "expects 2 values, got 1");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
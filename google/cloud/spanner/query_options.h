@@ -18,6 +18,7 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/optional.h"
 #include "absl/types/optional.h"
+#include <cstddef>
 #include <string>
 
 namespace google {
@@ -29,6 +30,9 @@ inline namespace SPANNER_CLIENT_NS {
  * These QueryOptions allow users to configure features about how their SQL
  * queries executes on the server.
  *
+ * The `prefetch_depth` option is the exception, it only changes how the
+ * client library receives the results.
+ *
  * @see https://cloud.google.com/spanner/docs/reference/rest/v1/QueryOptions
  */
 class QueryOptions {
@@ -54,8 +58,28 @@ class QueryOptions {
     return *this;
   }
 
+  /// Returns the number of result messages to read ahead.
+  absl::optional<std::size_t> const& prefetch_depth() const {
+    return prefetch_depth_;
+  }
+
+  /**
+   * Sets the number of result messages to read ahead of the application.
+   *
+   * When this is positive, a background thread keeps receiving up to this many
+   * result messages from Cloud Spanner while the application consumes the
+   * rows, so large queries can overlap the network transfer with the row
+   * processing. Each message holds up to about 1MiB of row data. Setting this
+   * to 0 (the default) disables the read-ahead.
+   */
+  QueryOptions& set_prefetch_depth(absl::optional<std::size_t> depth) {
+    prefetch_depth_ = std::move(depth);
+    return *this;
+  }
+
   friend bool operator==(QueryOptions const& a, QueryOptions const& b) {
-    return a.optimizer_version_ == b.optimizer_version_;
+    return a.optimizer_version_ == b.optimizer_version_ &&
+           a.prefetch_depth_ == b.prefetch_depth_;
   }
 
   friend bool operator!=(QueryOptions const& a, QueryOptions const& b) {
@@ -64,6 +88,7 @@ class QueryOptions {
 
  private:
   absl::optional<std::string> optimizer_version_;
+  absl::optional<std::size_t> prefetch_depth_;
 };
 
 }  // namespace SPANNER_CLIENT_NS
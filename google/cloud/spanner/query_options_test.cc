@@ -38,6 +38,19 @@ TEST(QueryOptionsTest, OptimizerVersion) {
   EXPECT_EQ(copy, default_constructed);
 }
 
+TEST(QueryOptionsTest, PrefetchDepth) {
+  QueryOptions const default_constructed{};
+  EXPECT_FALSE(default_constructed.prefetch_depth().has_value());
+
+  auto copy = default_constructed;
+  copy.set_prefetch_depth(4);
+  EXPECT_NE(copy, default_constructed);
+  EXPECT_EQ(4, *copy.prefetch_depth());
+
+  copy.set_prefetch_depth(absl::optional<std::size_t>{});
+  EXPECT_EQ(copy, default_constructed);
+}
+
 }  // namespace
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
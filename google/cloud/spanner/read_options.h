@@ -17,6 +17,7 @@
 
 #include "google/cloud/spanner/version.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <cstddef>
 #include <string>
 
 namespace google {
@@ -38,10 +39,22 @@ struct ReadOptions {
    * A limit cannot be specified when calling `PartitionRead`.
    */
   std::int64_t limit = 0;
+
+  /**
+   * The number of result messages to read ahead of the application, or 0 to
+   * disable the read-ahead.
+   *
+   * When this is positive, a background thread keeps receiving up to this many
+   * result messages while the application consumes the rows, so large reads
+   * can overlap the network transfer with the row processing. This option is
+   * not sent to Cloud Spanner, and it is not preserved by `PartitionRead`.
+   */
+  std::size_t prefetch_depth = 0;
 };
 
 inline bool operator==(ReadOptions const& lhs, ReadOptions const& rhs) {
-  return lhs.limit == rhs.limit && lhs.index_name == rhs.index_name;
+  return lhs.limit == rhs.limit && lhs.index_name == rhs.index_name &&
+         lhs.prefetch_depth == rhs.prefetch_depth;
 }
 
 inline bool operator!=(ReadOptions const& lhs, ReadOptions const& rhs) {
@@ -18,6 +18,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -25,8 +27,9 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 namespace {
 
+template <typename Source>
 absl::optional<Timestamp> GetReadTimestamp(
-    std::unique_ptr<internal::ResultSourceInterface> const& source) {
+    std::unique_ptr<Source> const& source) {
   auto metadata = source->Metadata();
   absl::optional<Timestamp> timestamp;
   if (metadata.has_value() && metadata->has_transaction() &&
@@ -67,10 +70,58 @@ absl::optional<spanner::ExecutionPlan> GetExecutionPlan(
 }
 }  // namespace
 
+namespace internal {
+StatusOr<absl::optional<ColumnBatch>> ResultSourceInterface::NextBatch() {
+  auto row = NextRow();
+  if (!row) return std::move(row).status();
+  if (row->size() == 0) return absl::optional<ColumnBatch>();
+  auto names = std::make_shared<std::vector<std::string>>(row->columns());
+  google::spanner::v1::StructType row_type;
+  std::vector<google::protobuf::Value> values;
+  for (auto& value : std::move(*row).values()) {
+    auto p = ToProto(std::move(value));
+    *row_type.add_fields()->mutable_type() = std::move(p.first);
+    values.push_back(std::move(p.second));
+  }
+  ColumnBatchBuilder builder(row_type, std::move(names));
+  for (std::size_t i = 0; i != values.size(); ++i) {
+    auto status = builder.Append(i, std::move(values[i]));
+    if (!status.ok()) return status;
+  }
+  return absl::optional<ColumnBatch>(std::move(builder).Build());
+}
+
+StatusOr<bool> ResultSourceInterface::NextRowValues(
+    std::vector<google::protobuf::Value>& values) {
+  auto row = NextRow();
+  if (!row) return std::move(row).status();
+  if (row->size() == 0) return false;
+  values.clear();
+  for (auto& value : std::move(*row).values()) {
+    values.emplace_back();
+    ToProto(std::move(value), values.back());
+  }
+  return true;
+}
+}  // namespace internal
+
 absl::optional<Timestamp> RowStream::ReadTimestamp() const {
   return GetReadTimestamp(source_);
 }
 
+future<StatusOr<absl::optional<Row>>> AsyncRowStream::Next() {
+  return source_->NextRow().then([](future<StatusOr<Row>> f) {
+    auto row = f.get();
+    if (!row) return StatusOr<absl::optional<Row>>(std::move(row).status());
+    if (row->size() == 0) return StatusOr<absl::optional<Row>>(absl::nullopt);
+    return StatusOr<absl::optional<Row>>(*std::move(row));
+  });
+}
+
+absl::optional<Timestamp> AsyncRowStream::ReadTimestamp() const {
+  return GetReadTimestamp(source_);
+}
+
 absl::optional<Timestamp> ProfileQueryResult::ReadTimestamp() const {
   return GetReadTimestamp(source_);
 }
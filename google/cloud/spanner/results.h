@@ -15,15 +15,19 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_RESULTS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_SPANNER_RESULTS_H
 
+#include "google/cloud/spanner/column_batch.h"
 #include "google/cloud/spanner/row.h"
 #include "google/cloud/spanner/timestamp.h"
 #include "google/cloud/spanner/version.h"
+#include "google/cloud/future.h"
 #include "google/cloud/optional.h"
 #include "absl/types/optional.h"
 #include <google/spanner/v1/spanner.pb.h>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -49,6 +53,52 @@ class ResultSourceInterface {
   virtual StatusOr<Row> NextRow() = 0;
   virtual absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() = 0;
   virtual absl::optional<google::spanner::v1::ResultSetStats> Stats() const = 0;
+  // Returns an empty optional to indicate end-of-stream. The default
+  // implementation returns each row from `NextRow()` in its own batch.
+  virtual StatusOr<absl::optional<ColumnBatch>> NextBatch();
+  // Moves the values of the next row, with the types in `Metadata()`, into
+  // `values`. Returns false to indicate end-of-stream. The default
+  // implementation uses `NextRow()`.
+  virtual StatusOr<bool> NextRowValues(
+      std::vector<google::protobuf::Value>& values);
+};
+
+// Checks that the types in a `StructType` match the elements of a tuple.
+struct TupleMatchesRowType {
+  bool& ok;
+  template <typename T>
+  void operator()(T const&, google::spanner::v1::StructType const& row_type,
+                  int& field) const {
+    ok = ok && TypeProtoIs<T>(row_type.fields(field++).type());
+  }
+};
+
+// Converts the values of a row into the elements of a tuple.
+struct ExtractTupleElement {
+  Status& status;
+  template <typename T>
+  void operator()(T& t, google::spanner::v1::StructType const& row_type,
+                  std::vector<google::protobuf::Value>& values,
+                  int& field) const {
+    auto const i = field++;
+    if (!status.ok()) return;
+    auto x = FromProtoAs<T>(row_type.fields(i).type(),
+                            std::move(values[static_cast<std::size_t>(i)]));
+    if (!x) {
+      status = std::move(x).status();
+    } else {
+      t = *std::move(x);
+    }
+  }
+};
+
+class AsyncResultSourceInterface {
+ public:
+  virtual ~AsyncResultSourceInterface() = default;
+  // Satisfied with an OK Status and an empty Row to indicate end-of-stream.
+  virtual future<StatusOr<Row>> NextRow() = 0;
+  virtual absl::optional<google::spanner::v1::ResultSetMetadata> Metadata() = 0;
+  virtual absl::optional<google::spanner::v1::ResultSetStats> Stats() const = 0;
 };
 }  // namespace internal
 
@@ -86,6 +136,23 @@ class RowStream {
   // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
   RowStreamIterator end() { return {}; }
 
+  /**
+   * Returns the next rows in the stream, stored by column.
+   *
+   * The batch contains all the complete rows received from the service that
+   * have not been returned yet, waiting for more data only if there are none.
+   * The values are decoded directly into the columns of the batch, without
+   * creating a `Row` or a `Value` for each of them, see `ColumnBatch` for
+   * details.
+   *
+   * Returns an empty `absl::optional<ColumnBatch>` at the end of the stream.
+   * The rows returned in a batch are not returned by the iterators, and vice
+   * versa.
+   */
+  StatusOr<absl::optional<ColumnBatch>> NextBatch() {
+    return source_->NextBatch();
+  }
+
   /**
    * Retrieves the timestamp at which the read occurred.
    *
@@ -94,9 +161,123 @@ class RowStream {
   absl::optional<Timestamp> ReadTimestamp() const;
 
  private:
+  template <typename Tuple>
+  friend TupleStream<Tuple> StreamOf(RowStream& range);
+
+  // Returns a function that decodes each row directly into a `Tuple`, or
+  // `nullptr` if the metadata is not available or does not match `Tuple`.
+  template <typename Tuple>
+  typename TupleStreamIterator<Tuple>::Source TupleSource() {
+    auto metadata = source_->Metadata();
+    if (!metadata) return nullptr;
+    auto const& row_type = metadata->row_type();
+    auto const size = static_cast<std::size_t>(row_type.fields_size());
+    if (size != std::tuple_size<Tuple>::value) return nullptr;
+    bool ok = true;
+    int field = 0;
+    internal::ForEach(Tuple{}, internal::TupleMatchesRowType{ok}, row_type,
+                      field);
+    if (!ok) return nullptr;
+
+    struct State {
+      google::spanner::v1::StructType row_type;
+      std::vector<google::protobuf::Value> values;
+    };
+    auto state = std::make_shared<State>();
+    state->row_type = std::move(*metadata->mutable_row_type());
+    auto* source = source_.get();
+    return [source, state]() -> absl::optional<StatusOr<Tuple>> {
+      auto more = source->NextRowValues(state->values);
+      if (!more) return StatusOr<Tuple>(std::move(more).status());
+      if (!*more) return absl::nullopt;
+      Tuple tup;
+      Status status;
+      int field = 0;
+      internal::ForEach(tup, internal::ExtractTupleElement{status},
+                        state->row_type, state->values, field);
+      if (!status.ok()) return StatusOr<Tuple>(std::move(status));
+      return StatusOr<Tuple>(std::move(tup));
+    };
+  }
+
   std::unique_ptr<internal::ResultSourceInterface> source_;
 };
 
+/**
+ * A factory that creates a `TupleStream<Tuple>` from the rows in @p range.
+ *
+ * This overload is chosen for `RowStream` ranges. When the types in the result
+ * set metadata match `Tuple`, which is checked once, each row is decoded
+ * directly into a `Tuple`, without creating a `Row` or any `Value` objects.
+ * Otherwise it behaves like the generic version (above), which returns an
+ * error for each row that cannot be converted.
+ *
+ * @note ownership of the @p range is not transferred, so it must outlive the
+ *     returned `TupleStream`.
+ */
+template <typename Tuple>
+TupleStream<Tuple> StreamOf(RowStream& range) {
+  auto source = range.TupleSource<Tuple>();
+  if (!source) return TupleStream<Tuple>(range.begin(), range.end());
+  return TupleStream<Tuple>(std::move(source));
+}
+
+/**
+ * Represents the stream of `Rows` returned from `spanner::Client::AsyncRead()`
+ * or `spanner::Client::AsyncExecuteQuery()`.
+ *
+ * The rows are retrieved one at a time with `Next()`. The library reads ahead
+ * of the application by at most one row, and resumes the stream on transient
+ * failures, just like `RowStream`.
+ *
+ * @note The futures returned by `Next()` are satisfied by the threads running
+ *     the client's `CompletionQueue`. Callbacks attached to these futures must
+ *     not block waiting for another row of the same stream.
+ *
+ * @par Example
+ * @code
+ * void PrintAll(spanner::AsyncRowStream& rows) {
+ *   rows.Next().then([&rows](future<StatusOr<absl::optional<Row>>> f) {
+ *     auto row = f.get();
+ *     if (!row) throw std::runtime_error(row.status().message());
+ *     if (!row->has_value()) return;  // end of stream
+ *     std::cout << (*row)->size() << " columns\n";
+ *     PrintAll(rows);
+ *   });
+ * }
+ * @endcode
+ */
+class AsyncRowStream {
+ public:
+  AsyncRowStream() = default;
+  explicit AsyncRowStream(
+      std::unique_ptr<internal::AsyncResultSourceInterface> source)
+      : source_(std::move(source)) {}
+
+  // This class is movable but not copyable.
+  AsyncRowStream(AsyncRowStream&&) = default;
+  AsyncRowStream& operator=(AsyncRowStream&&) = default;
+
+  /**
+   * Returns the next row in the stream.
+   *
+   * The future is satisfied with an empty `absl::optional<Row>` at the end of
+   * the stream, or with an error if the stream fails. Applications should not
+   * call `Next()` again until the previous future is satisfied.
+   */
+  future<StatusOr<absl::optional<Row>>> Next();
+
+  /**
+   * Retrieves the timestamp at which the read occurred.
+   *
+   * @note Only available if a read-only transaction was used.
+   */
+  absl::optional<Timestamp> ReadTimestamp() const;
+
+ private:
+  std::unique_ptr<internal::AsyncResultSourceInterface> source_;
+};
+
 /**
  * Represents the result of a data modifying operation using
  * `spanner::Client::ExecuteDml()`.
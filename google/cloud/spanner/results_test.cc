@@ -24,6 +24,8 @@
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <tuple>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -37,6 +39,7 @@ using ::google::cloud::spanner_mocks::MockResultSetSource;
 using ::google::cloud::testing_util::IsProtoEqual;
 using ::google::cloud::testing_util::StatusIs;
 using ::google::protobuf::TextFormat;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Return;
 using ::testing::UnorderedPointwise;
@@ -118,6 +121,109 @@ TEST(RowStream, IterateError) {
   EXPECT_EQ(num_rows, 2);
 }
 
+spanner_proto::ResultSetMetadata MakeMetadata(char const* row_type) {
+  spanner_proto::ResultSetMetadata metadata;
+  EXPECT_TRUE(
+      TextFormat::ParseFromString(row_type, metadata.mutable_row_type()));
+  return metadata;
+}
+
+auto constexpr kRowType = R"pb(
+  fields: {
+    name: "I"
+    type: { code: INT64 }
+  }
+  fields: {
+    name: "B"
+    type: { code: BOOL }
+  }
+  fields: {
+    name: "S"
+    type: { code: STRING }
+  }
+)pb";
+
+TEST(RowStream, StreamOfMatchingMetadata) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, Metadata())
+      .WillOnce(Return(MakeMetadata(kRowType)));
+  EXPECT_CALL(*mock_source, NextRow())
+      .WillOnce(Return(MakeTestRow(5, true, "foo")))
+      .WillOnce(Return(MakeTestRow(MakeNullValue<std::int64_t>(), false, "")))
+      .WillOnce(Return(MakeTestRow(10, false, "bar")))
+      .WillOnce(Return(Row()));
+
+  RowStream rows(std::move(mock_source));
+  using RowType = std::tuple<absl::optional<std::int64_t>, bool, std::string>;
+  std::vector<RowType> actual;
+  for (auto& row : StreamOf<RowType>(rows)) {
+    ASSERT_STATUS_OK(row);
+    actual.push_back(*std::move(row));
+  }
+  EXPECT_THAT(actual,
+              ElementsAre(RowType(5, true, "foo"), RowType({}, false, ""),
+                          RowType(10, false, "bar")));
+}
+
+TEST(RowStream, StreamOfDecodeError) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, Metadata())
+      .WillOnce(Return(MakeMetadata(kRowType)));
+  EXPECT_CALL(*mock_source, NextRow())
+      .WillOnce(Return(MakeTestRow(MakeNullValue<std::int64_t>(), true, "")));
+
+  RowStream rows(std::move(mock_source));
+  using RowType = std::tuple<std::int64_t, bool, std::string>;
+  auto stream = StreamOf<RowType>(rows);
+  auto it = stream.begin();
+  ASSERT_NE(it, stream.end());
+  EXPECT_THAT(*it, StatusIs(StatusCode::kUnknown, "null value"));
+  ++it;
+  EXPECT_EQ(it, stream.end());
+}
+
+TEST(RowStream, StreamOfMismatchedMetadata) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, Metadata())
+      .WillOnce(Return(MakeMetadata(kRowType)));
+  EXPECT_CALL(*mock_source, NextRow())
+      .WillOnce(Return(MakeTestRow(5, true, "foo")));
+
+  // The types do not match, so each row fails to convert, exactly as it did
+  // before the metadata was checked.
+  RowStream rows(std::move(mock_source));
+  using RowType = std::tuple<std::int64_t, std::string, std::string>;
+  auto stream = StreamOf<RowType>(rows);
+  auto it = stream.begin();
+  ASSERT_NE(it, stream.end());
+  EXPECT_THAT(*it, StatusIs(StatusCode::kUnknown, "wrong type"));
+  ++it;
+  EXPECT_EQ(it, stream.end());
+}
+
+TEST(RowStream, NextBatch) {
+  auto mock_source = absl::make_unique<MockResultSetSource>();
+  EXPECT_CALL(*mock_source, NextRow())
+      .WillOnce(Return(MakeTestRow({{"A", Value(5)}, {"B", Value("foo")}})))
+      .WillOnce(Return(Status(StatusCode::kUnknown, "oops")))
+      .WillOnce(Return(Row()));
+
+  RowStream rows(std::move(mock_source));
+  auto batch = rows.NextBatch();
+  ASSERT_STATUS_OK(batch);
+  ASSERT_TRUE(batch->has_value());
+  EXPECT_EQ(1, (*batch)->num_rows());
+  EXPECT_THAT((*batch)->column_names(), ElementsAre("A", "B"));
+  EXPECT_THAT((*batch)->column(0).int64_values(), ElementsAre(5));
+  EXPECT_EQ("foo", (*batch)->column(1).string_value(0));
+
+  EXPECT_THAT(rows.NextBatch(), StatusIs(StatusCode::kUnknown, "oops"));
+
+  batch = rows.NextBatch();
+  ASSERT_STATUS_OK(batch);
+  EXPECT_FALSE(batch->has_value());
+}
+
 TEST(RowStream, TimestampNoTransaction) {
   auto mock_source = absl::make_unique<MockResultSetSource>();
   spanner_proto::ResultSetMetadata no_transaction;
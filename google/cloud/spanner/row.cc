@@ -26,10 +26,26 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 namespace internal {
+IndexedColumns::IndexedColumns(std::vector<std::string> n)
+    : names(std::move(n)) {
+  index.reserve(names.size());
+  for (std::size_t i = 0; i != names.size(); ++i) index.emplace(names[i], i);
+}
+
 Row MakeRow(std::vector<Value> values,
             std::shared_ptr<const std::vector<std::string>> columns) {
   return Row(std::move(values), std::move(columns));
 }
+
+Row MakeRow(std::vector<Value> values,
+            std::shared_ptr<IndexedColumns const> columns) {
+  auto const* index = &columns->index;
+  auto const* names = &columns->names;
+  Row row(std::move(values), std::shared_ptr<const std::vector<std::string>>(
+                                 std::move(columns), names));
+  row.index_ = index;
+  return row;
+}
 }  // namespace internal
 
 Row MakeTestRow(std::vector<std::pair<std::string, Value>> pairs) {
@@ -61,6 +77,11 @@ StatusOr<Value> Row::get(std::size_t pos) const {
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 StatusOr<Value> Row::get(std::string const& name) const {
+  if (index_ != nullptr) {
+    auto it = index_->find(name);
+    if (it != index_->end()) return get(it->second);
+    return Status(StatusCode::kInvalidArgument, "column name not found");
+  }
   auto it = std::find(columns_->begin(), columns_->end(), name);
   if (it != columns_->end()) return get(std::distance(columns_->begin(), it));
   return Status(StatusCode::kInvalidArgument, "column name not found");
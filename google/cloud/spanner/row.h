@@ -20,12 +20,14 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/status.h"
 #include "google/cloud/status_or.h"
+#include "absl/types/optional.h"
 #include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -35,9 +37,24 @@ namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
 class Row;
+class RowStream;
 namespace internal {
+
+/**
+ * The column names of a result set, with an index to find them by name.
+ *
+ * The index maps each name to its first position in `names`.
+ */
+struct IndexedColumns {
+  explicit IndexedColumns(std::vector<std::string> n);
+
+  std::vector<std::string> names;
+  std::unordered_map<std::string, std::size_t> index;
+};
+
 Row MakeRow(std::vector<Value>,
             std::shared_ptr<const std::vector<std::string>>);
+Row MakeRow(std::vector<Value>, std::shared_ptr<IndexedColumns const>);
 }  // namespace internal
 
 /**
@@ -168,6 +185,8 @@ class Row {
  private:
   friend Row internal::MakeRow(std::vector<Value>,
                                std::shared_ptr<const std::vector<std::string>>);
+  friend Row internal::MakeRow(std::vector<Value>,
+                               std::shared_ptr<internal::IndexedColumns const>);
   struct ExtractValue {
     Status& status;
     template <typename T, typename It>
@@ -192,6 +211,9 @@ class Row {
 
   std::vector<Value> values_;
   std::shared_ptr<const std::vector<std::string>> columns_;
+  // Set if `columns_` points into an `internal::IndexedColumns`, which it
+  // keeps alive.
+  std::unordered_map<std::string, std::size_t> const* index_ = nullptr;
 };
 
 /**
@@ -319,6 +341,12 @@ class TupleStreamIterator {
   using const_reference = value_type const&;
   ///@}
 
+  /**
+   * A function that returns a sequence of `StatusOr<Tuple>` objects.
+   * Returning an empty optional indicates that there are no more tuples.
+   */
+  using Source = std::function<absl::optional<StatusOr<Tuple>>()>;
+
   /// Default constructs an "end" iterator.
   TupleStreamIterator() = default;
 
@@ -328,6 +356,14 @@ class TupleStreamIterator {
     ParseTuple();
   }
 
+  /**
+   * Creates an iterator that returns the tuples from @p source, which must not
+   * be `nullptr`.
+   */
+  explicit TupleStreamIterator(Source source) : source_(std::move(source)) {
+    ParseTuple();
+  }
+
   reference operator*() { return tup_; }
   pointer operator->() { return &tup_; }
 
@@ -337,9 +373,10 @@ class TupleStreamIterator {
   TupleStreamIterator& operator++() {
     if (!tup_) {
       it_ = end_;
+      source_ = nullptr;
       return *this;
     }
-    ++it_;
+    if (!source_) ++it_;
     ParseTuple();
     return *this;
   }
@@ -352,7 +389,7 @@ class TupleStreamIterator {
 
   friend bool operator==(TupleStreamIterator const& a,
                          TupleStreamIterator const& b) {
-    return a.it_ == b.it_;
+    return a.AtEnd() == b.AtEnd();
   }
 
   friend bool operator!=(TupleStreamIterator const& a,
@@ -361,7 +398,18 @@ class TupleStreamIterator {
   }
 
  private:
+  bool AtEnd() const { return !source_ && it_ == end_; }
+
   void ParseTuple() {
+    if (source_) {
+      auto tup = source_();
+      if (tup) {
+        tup_ = *std::move(tup);
+      } else {
+        source_ = nullptr;  // No more tuples to consume; become "end"
+      }
+      return;
+    }
     if (it_ == end_) return;
     tup_ = *it_ ? std::move(*it_)->template get<Tuple>() : it_->status();
   }
@@ -369,6 +417,7 @@ class TupleStreamIterator {
   value_type tup_;
   RowStreamIterator it_;
   RowStreamIterator end_;
+  Source source_;  // if set, used instead of `it_`
 };
 
 /**
@@ -411,11 +460,16 @@ class TupleStream {
  private:
   template <typename T, typename RowRange>
   friend TupleStream<T> StreamOf(RowRange&& range);
+  template <typename T>
+  friend TupleStream<T> StreamOf(RowStream& range);
 
   template <typename It>
   explicit TupleStream(It&& start, It&& end)
       : begin_(std::forward<It>(start), std::forward<It>(end)) {}
 
+  explicit TupleStream(typename iterator::Source source)
+      : begin_(std::move(source)) {}
+
   iterator begin_;
   iterator end_;
 };
@@ -16,8 +16,11 @@
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/status_matchers.h"
 #include <gmock/gmock.h>
+#include <memory>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -26,6 +29,7 @@ inline namespace SPANNER_CLIENT_NS {
 namespace {
 
 using ::google::cloud::testing_util::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 // Given a `vector<StatusOr<Row>>` creates a 'Row::Source' object. This is
@@ -124,6 +128,27 @@ TEST(Row, GetByColumnName) {
   EXPECT_EQ(Value(true), *row.get("c"));
 }
 
+TEST(Row, GetByIndexedColumnName) {
+  auto columns = std::make_shared<internal::IndexedColumns>(
+      std::vector<std::string>{"a", "b", "a"});
+  auto row = internal::MakeRow({Value(1), Value("blah"), Value(2)}, columns);
+  EXPECT_THAT(row.columns(), ElementsAre("a", "b", "a"));
+
+  // Duplicate names find the first column, like an unindexed row.
+  EXPECT_EQ(Value(1), *row.get("a"));
+  EXPECT_EQ(Value("blah"), *row.get("b"));
+  EXPECT_FALSE(row.get("not a column name").ok());
+  EXPECT_EQ(MakeTestRow({{"a", Value(1)}, {"b", Value("blah")},
+                         {"a", Value(2)}}),
+            row);
+
+  // The index remains valid in copies, after the original row is gone.
+  columns.reset();
+  Row copy = row;
+  row = Row();
+  EXPECT_EQ(Value("blah"), *copy.get("b"));
+}
+
 TEST(Row, TemplatedGetByPosition) {
   Row row = MakeTestRow(1, "blah", true);
 
@@ -403,6 +428,39 @@ TEST(TupleStreamIterator, Error) {
   EXPECT_EQ(it, end);
 }
 
+TEST(TupleStreamIterator, FromSource) {
+  using RowType = std::tuple<std::int64_t, std::string>;
+  using TupleIterator = TupleStreamIterator<RowType>;
+  std::vector<StatusOr<RowType>> tuples = {
+      RowType(1, "foo"), Status(StatusCode::kUnknown, "oops"),
+      RowType(2, "bar")};
+  std::size_t index = 0;
+  auto source = [&]() -> absl::optional<StatusOr<RowType>> {
+    if (index == tuples.size()) return absl::nullopt;
+    return tuples[index++];
+  };
+
+  auto end = TupleIterator();
+  auto it = TupleIterator(source);
+  EXPECT_NE(it, end);
+  ASSERT_STATUS_OK(*it);
+  EXPECT_EQ(std::make_tuple(1, "foo"), **it);
+
+  ++it;
+  EXPECT_NE(it, end);
+  EXPECT_FALSE(it->ok());
+
+  ++it;  // Due to the previous error, jumps straight to "end"
+  EXPECT_EQ(it, end);
+
+  index = 2;
+  it = TupleIterator(source);
+  EXPECT_NE(it, end);
+  EXPECT_EQ(std::make_tuple(2, "bar"), **it);
+  ++it;
+  EXPECT_EQ(it, end);
+}
+
 TEST(TupleStream, Basics) {
   std::vector<Row> rows;
   rows.emplace_back(MakeTestRow(1, "foo", true));
@@ -2849,6 +2849,16 @@ void PartitionQuery(google::cloud::spanner::Client client) {
     ProcessRow(*row);
   }
   //! [execute-sql-query-partition]
+
+  //! [execute-partitions]
+  // Executes all the partitions in this process, using several threads.
+  google::cloud::Status status = client.ExecutePartitions(
+      *partitions, [](spanner::Row const& row) {
+        ProcessRow(row);
+        return google::cloud::Status();
+      });
+  if (!status.ok()) throw std::runtime_error(status.message());
+  //! [execute-partitions]
 }
 
 int RunOneCommand(std::vector<std::string> argv) {
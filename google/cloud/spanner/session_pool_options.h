@@ -61,6 +61,10 @@ class SessionPoolOptions {
     min_sessions_ =
         (std::min)(min_sessions_, max_sessions_per_channel_ * num_channels);
     max_idle_sessions_ = (std::max)(max_idle_sessions_, 0);
+    write_sessions_fraction_ =
+        (std::min)((std::max)(write_sessions_fraction_, 0.0), 1.0);
+    max_channels_ = (std::max)(max_channels_, num_channels);
+    busy_channel_rpcs_ = (std::max)(busy_channel_rpcs_, 1);
     return *this;
   }
 
@@ -102,6 +106,55 @@ class SessionPoolOptions {
   /// Return the maximum number of idle sessions to keep in the pool.
   int max_idle_sessions() const { return max_idle_sessions_; }
 
+  /**
+   * Set the fraction of idle sessions to keep prepared for read-write
+   * transactions. Values are clamped to the [0.0, 1.0] range.
+   *
+   * The pool begins a read-write transaction on these sessions in the
+   * background. The first operation in a read-write transaction uses one of
+   * them when available, which saves a round trip to begin the transaction
+   * (e.g. a `Commit()` that only applies mutations needs a single RPC).
+   */
+  SessionPoolOptions& set_write_sessions_fraction(double fraction) {
+    write_sessions_fraction_ = fraction;
+    return *this;
+  }
+
+  /// Return the fraction of idle sessions to keep prepared for writes.
+  double write_sessions_fraction() const { return write_sessions_fraction_; }
+
+  /**
+   * Set the maximum number of channels used by the pool.
+   *
+   * The pool adds a channel when all of its channels are busy (see
+   * `set_busy_channel_rpcs()`), until it has this many channels. Values
+   * below the number of channels of the connection (see
+   * `ConnectionOptions::set_num_channels()`) disable adding channels.
+   */
+  SessionPoolOptions& set_max_channels(int count) {
+    max_channels_ = count;
+    return *this;
+  }
+
+  /// Return the maximum number of channels used by the pool.
+  int max_channels() const { return max_channels_; }
+
+  /**
+   * Set the number of outstanding RPCs that make a channel busy.
+   * Values <= 1 are treated as 1.
+   *
+   * The pool prefers the channels with the fewest outstanding RPCs. Each
+   * HTTP/2 connection typically allows 100 concurrent streams, RPCs beyond
+   * that wait for a stream to become available.
+   */
+  SessionPoolOptions& set_busy_channel_rpcs(int count) {
+    busy_channel_rpcs_ = count;
+    return *this;
+  }
+
+  /// Return the number of outstanding RPCs that make a channel busy.
+  int busy_channel_rpcs() const { return busy_channel_rpcs_; }
+
   /// Set whether to block or fail on pool exhaustion.
   SessionPoolOptions& set_action_on_exhaustion(ActionOnExhaustion action) {
     action_on_exhaustion_ = action;
@@ -150,6 +203,9 @@ class SessionPoolOptions {
   int min_sessions_ = 0;
   int max_sessions_per_channel_ = 100;
   int max_idle_sessions_ = 0;
+  double write_sessions_fraction_ = 0.0;
+  int max_channels_ = 0;
+  int busy_channel_rpcs_ = 90;
   ActionOnExhaustion action_on_exhaustion_ = ActionOnExhaustion::kBlock;
   std::chrono::seconds keep_alive_interval_ = std::chrono::minutes(55);
   std::map<std::string, std::string> labels_;
@@ -42,6 +42,36 @@ TEST(SessionPoolOptionsTest, MaxIdleSessions) {
   EXPECT_EQ(0, options.max_idle_sessions());
 }
 
+TEST(SessionPoolOptionsTest, WriteSessionsFraction) {
+  SessionPoolOptions options;
+  EXPECT_EQ(0.0, options.write_sessions_fraction());
+  options.set_write_sessions_fraction(-0.5).EnforceConstraints(
+      /*num_channels=*/1);
+  EXPECT_EQ(0.0, options.write_sessions_fraction());
+  options.set_write_sessions_fraction(1.5).EnforceConstraints(
+      /*num_channels=*/1);
+  EXPECT_EQ(1.0, options.write_sessions_fraction());
+  options.set_write_sessions_fraction(0.25).EnforceConstraints(
+      /*num_channels=*/1);
+  EXPECT_EQ(0.25, options.write_sessions_fraction());
+}
+
+TEST(SessionPoolOptionsTest, MaxChannels) {
+  SessionPoolOptions options;
+  EXPECT_EQ(0, options.max_channels());
+  options.EnforceConstraints(/*num_channels=*/4);
+  EXPECT_EQ(4, options.max_channels());
+  options.set_max_channels(8).EnforceConstraints(/*num_channels=*/4);
+  EXPECT_EQ(8, options.max_channels());
+}
+
+TEST(SessionPoolOptionsTest, BusyChannelRpcs) {
+  SessionPoolOptions options;
+  EXPECT_EQ(90, options.busy_channel_rpcs());
+  options.set_busy_channel_rpcs(0).EnforceConstraints(/*num_channels=*/1);
+  EXPECT_EQ(1, options.busy_channel_rpcs());
+}
+
 TEST(SessionPoolOptionsTest, MaxMinSessionsConflict) {
   SessionPoolOptions options;
   options.set_min_sessions(10)
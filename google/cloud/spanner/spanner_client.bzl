@@ -23,6 +23,7 @@ spanner_client_hdrs = [
     "bytes.h",
     "client.h",
     "client_options.h",
+    "column_batch.h",
     "commit_result.h",
     "connection.h",
     "connection_options.h",
@@ -31,13 +32,16 @@ spanner_client_hdrs = [
     "database_admin_client.h",
     "database_admin_connection.h",
     "date.h",
+    "execute_partitions_options.h",
     "iam_updater.h",
     "instance.h",
     "instance_admin_client.h",
     "instance_admin_connection.h",
+    "internal/async_partial_result_set_source.h",
     "internal/channel.h",
     "internal/clock.h",
     "internal/connection_impl.h",
+    "internal/counting_spanner_stub.h",
     "internal/database_admin_logging.h",
     "internal/database_admin_metadata.h",
     "internal/database_admin_stub.h",
@@ -51,6 +55,8 @@ spanner_client_hdrs = [
     "internal/partial_result_set_reader.h",
     "internal/partial_result_set_resume.h",
     "internal/partial_result_set_source.h",
+    "internal/partition_executor.h",
+    "internal/prefetching_result_set_reader.h",
     "internal/session.h",
     "internal/session_pool.h",
     "internal/spanner_stub.h",
@@ -58,11 +64,13 @@ spanner_client_hdrs = [
     "internal/transaction_impl.h",
     "internal/tuple_utils.h",
     "keys.h",
+    "mutation_batcher.h",
     "mutations.h",
     "numeric.h",
     "partition_options.h",
     "partitioned_dml_result.h",
     "polling_policy.h",
+    "prepared_statement.h",
     "query_options.h",
     "query_partition.h",
     "read_options.h",
@@ -85,6 +93,8 @@ spanner_client_srcs = [
     "backup.cc",
     "bytes.cc",
     "client.cc",
+    "column_batch.cc",
+    "connection.cc",
     "connection_options.cc",
     "database.cc",
     "database_admin_client.cc",
@@ -92,7 +102,9 @@ spanner_client_srcs = [
     "instance.cc",
     "instance_admin_client.cc",
     "instance_admin_connection.cc",
+    "internal/async_partial_result_set_source.cc",
     "internal/connection_impl.cc",
+    "internal/counting_spanner_stub.cc",
     "internal/database_admin_logging.cc",
     "internal/database_admin_metadata.cc",
     "internal/database_admin_stub.cc",
@@ -105,15 +117,19 @@ spanner_client_srcs = [
     "internal/metadata_spanner_stub.cc",
     "internal/partial_result_set_resume.cc",
     "internal/partial_result_set_source.cc",
+    "internal/partition_executor.cc",
+    "internal/prefetching_result_set_reader.cc",
     "internal/session.cc",
     "internal/session_pool.cc",
     "internal/spanner_stub.cc",
     "internal/status_utils.cc",
     "internal/transaction_impl.cc",
     "keys.cc",
+    "mutation_batcher.cc",
     "mutations.cc",
     "numeric.cc",
     "partition_options.cc",
+    "prepared_statement.cc",
     "query_partition.cc",
     "read_partition.cc",
     "results.cc",
@@ -19,6 +19,9 @@
 spanner_client_benchmarks = [
     "bytes_benchmark.cc",
     "internal/merge_chunk_benchmark.cc",
+    "internal/session_pool_benchmark.cc",
     "numeric_benchmark.cc",
     "row_benchmark.cc",
+    "sql_statement_benchmark.cc",
+    "value_benchmark.cc",
 ]
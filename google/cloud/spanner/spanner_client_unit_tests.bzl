@@ -21,6 +21,7 @@ spanner_client_unit_tests = [
     "bytes_test.cc",
     "client_options_test.cc",
     "client_test.cc",
+    "column_batch_test.cc",
     "connection_options_test.cc",
     "create_instance_request_builder_test.cc",
     "database_admin_client_test.cc",
@@ -29,8 +30,10 @@ spanner_client_unit_tests = [
     "instance_admin_client_test.cc",
     "instance_admin_connection_test.cc",
     "instance_test.cc",
+    "internal/async_partial_result_set_source_test.cc",
     "internal/clock_test.cc",
     "internal/connection_impl_test.cc",
+    "internal/counting_spanner_stub_test.cc",
     "internal/database_admin_logging_test.cc",
     "internal/database_admin_metadata_test.cc",
     "internal/instance_admin_logging_test.cc",
@@ -41,15 +44,19 @@ spanner_client_unit_tests = [
     "internal/metadata_spanner_stub_test.cc",
     "internal/partial_result_set_resume_test.cc",
     "internal/partial_result_set_source_test.cc",
+    "internal/partition_executor_test.cc",
+    "internal/prefetching_result_set_reader_test.cc",
     "internal/session_pool_test.cc",
     "internal/spanner_stub_test.cc",
     "internal/status_utils_test.cc",
     "internal/transaction_impl_test.cc",
     "internal/tuple_utils_test.cc",
     "keys_test.cc",
+    "mutation_batcher_test.cc",
     "mutations_test.cc",
     "numeric_test.cc",
     "partition_options_test.cc",
+    "prepared_statement_test.cc",
     "query_options_test.cc",
     "query_partition_test.cc",
     "read_options_test.cc",
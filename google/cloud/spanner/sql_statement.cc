@@ -23,6 +23,24 @@ inline namespace SPANNER_CLIENT_NS {
 namespace internal {
 SqlStatementProto ToProto(SqlStatement s) {
   SqlStatementProto statement_proto;
+  if (s.bound_) {
+    auto const& prepared = *s.bound_->prepared;
+    ++prepared.execution_count;
+    statement_proto.set_sql(prepared.sql);
+    if (prepared.param_names.empty()) return statement_proto;
+    auto& values = *statement_proto.mutable_params()->mutable_fields();
+    auto& types = *statement_proto.mutable_param_types();
+    // The values may be shared with copies of `s`, which must not change.
+    bool const owned = s.bound_.use_count() == 1;
+    for (std::size_t i = 0; i != prepared.param_names.size(); ++i) {
+      auto& value = s.bound_->values[i];
+      auto type_and_value =
+          internal::ToProto(owned ? std::move(value) : value);
+      values[prepared.param_names[i]] = std::move(type_and_value.second);
+      types[prepared.param_names[i]] = std::move(type_and_value.first);
+    }
+    return statement_proto;
+  }
   statement_proto.set_sql(std::move(s.statement_));
   if (!s.params_.empty()) {
     auto& values = *statement_proto.mutable_params()->mutable_fields();
@@ -37,7 +55,25 @@ SqlStatementProto ToProto(SqlStatement s) {
 }
 }  // namespace internal
 
+std::string const& SqlStatement::sql() const {
+  if (bound_) return bound_->prepared->sql;
+  return statement_;
+}
+
+SqlStatement::ParamType const& SqlStatement::params() const {
+  if (!bound_) return params_;
+  auto& bound = *bound_;
+  std::call_once(bound.params_once, [&bound] {
+    auto const& names = bound.prepared->param_names;
+    for (std::size_t i = 0; i != names.size(); ++i) {
+      bound.params.emplace(names[i], bound.values[i]);
+    }
+  });
+  return bound.params;
+}
+
 std::vector<std::string> SqlStatement::ParameterNames() const {
+  if (bound_) return bound_->prepared->param_names;
   std::vector<std::string> keys;
   keys.reserve(params_.size());
   for (auto const& p : params_) {
@@ -48,6 +84,15 @@ std::vector<std::string> SqlStatement::ParameterNames() const {
 
 google::cloud::StatusOr<Value> SqlStatement::GetParameter(
     std::string const& parameter_name) const {
+  if (bound_) {
+    auto const& names = bound_->prepared->param_names;
+    auto const i = std::find(names.begin(), names.end(), parameter_name);
+    if (i != names.end()) {
+      return bound_->values[static_cast<std::size_t>(i - names.begin())];
+    }
+    return Status(StatusCode::kNotFound,
+                  "No such parameter: " + parameter_name);
+  }
   auto iter = params_.find(parameter_name);
   if (iter != params_.end()) {
     return iter->second;
@@ -56,8 +101,8 @@ google::cloud::StatusOr<Value> SqlStatement::GetParameter(
 }
 
 std::ostream& operator<<(std::ostream& os, SqlStatement const& stmt) {
-  os << stmt.statement_;
-  for (auto const& param : stmt.params_) {
+  os << stmt.sql();
+  for (auto const& param : stmt.params()) {
     os << "\n[param]: {" << param.first << "=" << param.second << "}";
   }
   return os;
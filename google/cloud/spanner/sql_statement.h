@@ -19,18 +19,26 @@
 #include "google/cloud/spanner/version.h"
 #include "google/cloud/status_or.h"
 #include <google/spanner/v1/spanner.pb.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
 namespace spanner {
 inline namespace SPANNER_CLIENT_NS {
 
-class SqlStatement;  // Defined later in this file.
+class SqlStatement;       // Defined later in this file.
+class PreparedStatement;  // Defined in prepared_statement.h
 
 // Internal implementation details that callers should not use.
 namespace internal {
+struct BoundParams;  // Defined later in this file.
+
 // Use this proto type because it conveniently wraps all three attributes
 // required to represent a SQL statement.
 using SqlStatementProto =
@@ -76,13 +84,13 @@ class SqlStatement {
    * Returns the SQL statement.
    * No parameter substitution is performed in the statement string.
    */
-  std::string const& sql() const { return statement_; }
+  std::string const& sql() const;
 
   /**
    * Returns the collection of parameters.
    * @return If no parameters were specified, the container will be empty.
    */
-  ParamType const& params() const { return params_; }
+  ParamType const& params() const;
 
   /**
    * Returns the names of all the parameters.
@@ -98,7 +106,7 @@ class SqlStatement {
       std::string const& parameter_name) const;
 
   friend bool operator==(SqlStatement const& a, SqlStatement const& b) {
-    return a.statement_ == b.statement_ && a.params_ == b.params_;
+    return a.sql() == b.sql() && a.params() == b.params();
   }
   friend bool operator!=(SqlStatement const& a, SqlStatement const& b) {
     return !(a == b);
@@ -113,12 +121,41 @@ class SqlStatement {
   friend std::ostream& operator<<(std::ostream& os, SqlStatement const& stmt);
 
  private:
+  friend class PreparedStatement;
   friend internal::SqlStatementProto internal::ToProto(SqlStatement s);
 
+  explicit SqlStatement(std::shared_ptr<internal::BoundParams> bound)
+      : bound_(std::move(bound)) {}
+
   std::string statement_;
   ParamType params_;
+  // Set, instead of `statement_` and `params_`, in the statements created by
+  // `PreparedStatement::Bind()`.
+  std::shared_ptr<internal::BoundParams> bound_;
+};
+
+namespace internal {
+
+/// The state shared by a `PreparedStatement` and the statements it binds.
+struct PreparedSql {
+  std::string sql;
+  std::vector<std::string> param_names;
+  // Number of requests built from the statements bound by this object.
+  mutable std::atomic<std::int64_t> execution_count{0};
+};
+
+/// The parameter values of a statement created by `PreparedStatement::Bind()`.
+struct BoundParams {
+  std::shared_ptr<PreparedSql const> prepared;
+  // In the same order as `prepared->param_names`.
+  std::vector<Value> values;
+  // `SqlStatement::params()` is rarely needed, so it is built on demand.
+  std::once_flag params_once;
+  SqlStatement::ParamType params;
 };
 
+}  // namespace internal
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
@@ -0,0 +1,69 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/prepared_statement.h"
+#include "google/cloud/spanner/sql_statement.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+// Run on (1 X 2000 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 107520 KiB (x1)
+// Load Average: 0.95, 0.92, 0.92
+// ----------------------------------------------------------------------
+// Benchmark                            Time             CPU   Iterations
+// ----------------------------------------------------------------------
+// BM_SqlStatementToProto            2896 ns         2849 ns       235566
+// BM_PreparedStatementToProto       2361 ns         2273 ns       342008
+
+std::string const kSql =
+    "SELECT SingerId, FirstName, LastName FROM Singers"
+    " WHERE SingerId = @id AND FirstName = @first AND LastName = @last";
+
+void BM_SqlStatementToProto(benchmark::State& state) {
+  std::int64_t id = 0;
+  for (auto _ : state) {
+    SqlStatement stmt(kSql, {{"id", Value(++id)},
+                             {"first", Value("Marc")},
+                             {"last", Value("Richards")}});
+    benchmark::DoNotOptimize(internal::ToProto(std::move(stmt)));
+  }
+}
+BENCHMARK(BM_SqlStatementToProto);
+
+void BM_PreparedStatementToProto(benchmark::State& state) {
+  PreparedStatement prepared(kSql, {"id", "first", "last"});
+  std::int64_t id = 0;
+  for (auto _ : state) {
+    auto stmt = prepared.Bind({Value(++id), Value("Marc"), Value("Richards")});
+    benchmark::DoNotOptimize(internal::ToProto(std::move(stmt)));
+  }
+}
+BENCHMARK(BM_PreparedStatementToProto);
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
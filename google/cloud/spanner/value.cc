@@ -183,6 +183,44 @@ std::ostream& StreamHelper(std::ostream& os,  // NOLINT(misc-no-recursion)
 
 }  // namespace
 
+struct Value::NativeTypeProto {
+  google::spanner::v1::Type operator()(absl::monostate) const { return {}; }
+  template <typename T>
+  google::spanner::v1::Type operator()(T const& v) const {
+    return MakeTypeProto(v);
+  }
+  // The elements of these arrays always have the same type, so there is no
+  // need to check each one of them, as `MakeTypeProto()` does.
+  template <typename T>
+  google::spanner::v1::Type operator()(std::vector<T> const&) const {
+    google::spanner::v1::Type t;
+    t.set_code(google::spanner::v1::TypeCode::ARRAY);
+    *t.mutable_array_element_type() = MakeTypeProto(T{});
+    return t;
+  }
+};
+
+struct Value::NativeValueProto {
+  google::protobuf::Value& pv;
+
+  void operator()(absl::monostate) const {}
+  template <typename T>
+  void operator()(T& v) const {
+    pv = MakeValueProto(std::move(v));
+  }
+  template <typename T>
+  void operator()(std::vector<T>& v) const {
+    auto& values = *pv.mutable_list_value()->mutable_values();
+    values.Reserve(static_cast<int>(v.size()));
+    for (auto&& e : v) *values.Add() = MakeValueProto(std::move(e));
+  }
+};
+
+Value Value::Encoded() const {
+  auto p = internal::ToProto(*this);
+  return Value(std::move(p.first), std::move(p.second));
+}
+
 namespace internal {
 
 Value FromProto(google::spanner::v1::Type t, google::protobuf::Value v) {
@@ -190,16 +228,40 @@ Value FromProto(google::spanner::v1::Type t, google::protobuf::Value v) {
 }
 
 std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v) {
-  return std::make_pair(std::move(v.type_), std::move(v.value_));
+  if (absl::holds_alternative<absl::monostate>(v.native_)) {
+    return std::make_pair(std::move(v.type_), std::move(v.value_));
+  }
+  auto t = absl::visit(Value::NativeTypeProto{}, v.native_);
+  google::protobuf::Value pv;
+  absl::visit(Value::NativeValueProto{pv}, v.native_);
+  return std::make_pair(std::move(t), std::move(pv));
+}
+
+void ToProto(Value v, google::protobuf::Value& pv) {
+  if (absl::holds_alternative<absl::monostate>(v.native_)) {
+    pv = std::move(v.value_);
+    return;
+  }
+  absl::visit(Value::NativeValueProto{pv}, v.native_);
 }
 
 }  // namespace internal
 
 bool operator==(Value const& a, Value const& b) {
+  auto const a_native = !absl::holds_alternative<absl::monostate>(a.native_);
+  auto const b_native = !absl::holds_alternative<absl::monostate>(b.native_);
+  // The alternatives map to distinct Spanner types, and their `operator==`
+  // matches the comparison of their protos, including NaN != NaN.
+  if (a_native && b_native) return a.native_ == b.native_;
+  if (a_native) return a.Encoded() == b;
+  if (b_native) return a == b.Encoded();
   return Equal(a.type_, a.value_, b.type_, b.value_);
 }
 
 std::ostream& operator<<(std::ostream& os, Value const& v) {
+  if (!absl::holds_alternative<absl::monostate>(v.native_)) {
+    return os << v.Encoded();
+  }
   return StreamHelper(os, v.value_, v.type_, StreamMode::kScalar);
 }
 
@@ -393,7 +455,7 @@ google::protobuf::Value Value::MakeValueProto(char const* s) {
 // Value::GetValue
 //
 
-StatusOr<bool> Value::GetValue(bool, google::protobuf::Value const& pv,
+StatusOr<bool> Value::GetValue(Tag<bool>, google::protobuf::Value const& pv,
                                google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kBoolValue) {
     return Status(StatusCode::kUnknown, "missing BOOL");
@@ -401,7 +463,7 @@ StatusOr<bool> Value::GetValue(bool, google::protobuf::Value const& pv,
   return pv.bool_value();
 }
 
-StatusOr<std::int64_t> Value::GetValue(std::int64_t,
+StatusOr<std::int64_t> Value::GetValue(Tag<std::int64_t>,
                                        google::protobuf::Value const& pv,
                                        google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -424,7 +486,7 @@ StatusOr<std::int64_t> Value::GetValue(std::int64_t,
   return x;
 }
 
-StatusOr<double> Value::GetValue(double, google::protobuf::Value const& pv,
+StatusOr<double> Value::GetValue(Tag<double>, google::protobuf::Value const& pv,
                                  google::spanner::v1::Type const&) {
   if (pv.kind_case() == google::protobuf::Value::kNumberValue) {
     return pv.number_value();
@@ -440,7 +502,7 @@ StatusOr<double> Value::GetValue(double, google::protobuf::Value const& pv,
   return Status(StatusCode::kUnknown, "bad FLOAT64 data: \"" + s + "\"");
 }
 
-StatusOr<std::string> Value::GetValue(std::string const&,
+StatusOr<std::string> Value::GetValue(Tag<std::string>,
                                       google::protobuf::Value const& pv,
                                       google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -449,7 +511,7 @@ StatusOr<std::string> Value::GetValue(std::string const&,
   return pv.string_value();
 }
 
-StatusOr<std::string> Value::GetValue(std::string const&,
+StatusOr<std::string> Value::GetValue(Tag<std::string>,
                                       google::protobuf::Value&& pv,
                                       google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -458,7 +520,7 @@ StatusOr<std::string> Value::GetValue(std::string const&,
   return std::move(*pv.mutable_string_value());
 }
 
-StatusOr<Bytes> Value::GetValue(Bytes const&, google::protobuf::Value const& pv,
+StatusOr<Bytes> Value::GetValue(Tag<Bytes>, google::protobuf::Value const& pv,
                                 google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
     return Status(StatusCode::kUnknown, "missing BYTES");
@@ -468,7 +530,7 @@ StatusOr<Bytes> Value::GetValue(Bytes const&, google::protobuf::Value const& pv,
   return *decoded;
 }
 
-StatusOr<Numeric> Value::GetValue(Numeric const&,
+StatusOr<Numeric> Value::GetValue(Tag<Numeric>,
                                   google::protobuf::Value const& pv,
                                   google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -479,7 +541,7 @@ StatusOr<Numeric> Value::GetValue(Numeric const&,
   return *decoded;
 }
 
-StatusOr<Timestamp> Value::GetValue(Timestamp,
+StatusOr<Timestamp> Value::GetValue(Tag<Timestamp>,
                                     google::protobuf::Value const& pv,
                                     google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -488,7 +550,7 @@ StatusOr<Timestamp> Value::GetValue(Timestamp,
   return internal::TimestampFromRFC3339(pv.string_value());
 }
 
-StatusOr<CommitTimestamp> Value::GetValue(CommitTimestamp,
+StatusOr<CommitTimestamp> Value::GetValue(Tag<CommitTimestamp>,
                                           google::protobuf::Value const& pv,
                                           google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue ||
@@ -498,7 +560,7 @@ StatusOr<CommitTimestamp> Value::GetValue(CommitTimestamp,
   return CommitTimestamp{};
 }
 
-StatusOr<absl::CivilDay> Value::GetValue(absl::CivilDay,
+StatusOr<absl::CivilDay> Value::GetValue(Tag<absl::CivilDay>,
                                          google::protobuf::Value const& pv,
                                          google::spanner::v1::Type const&) {
   if (pv.kind_case() != google::protobuf::Value::kStringValue) {
@@ -24,8 +24,10 @@
 #include "google/cloud/internal/throw_delegate.h"
 #include "google/cloud/optional.h"
 #include "google/cloud/status_or.h"
+#include "absl/meta/type_traits.h"
 #include "absl/time/civil_time.h"
 #include "absl/types/optional.h"
+#include "absl/types/variant.h"
 #include <google/protobuf/struct.pb.h>
 #include <google/protobuf/util/message_differencer.h>
 #include <google/spanner/v1/type.pb.h>
@@ -34,6 +36,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -46,6 +49,12 @@ class Value;  // Defined later in this file.
 namespace internal {
 Value FromProto(google::spanner::v1::Type t, google::protobuf::Value v);
 std::pair<google::spanner::v1::Type, google::protobuf::Value> ToProto(Value v);
+void ToProto(Value v, google::protobuf::Value& pv);
+template <typename T>
+bool TypeProtoIs(google::spanner::v1::Type const& t);
+template <typename T>
+StatusOr<T> FromProtoAs(google::spanner::v1::Type const& t,
+                        google::protobuf::Value&& v);
 }  // namespace internal
 
 /**
@@ -217,9 +226,9 @@ class Value {
    * assert("hello" == *v2.get<std::string>());
    * @endcode
    */
-  explicit Value(int v) : Value(PrivateConstructor{}, v) {}
+  explicit Value(int v) : Value(std::int64_t{v}) {}
   /// @copydoc Value(int)
-  explicit Value(char const* v) : Value(PrivateConstructor{}, v) {}
+  explicit Value(char const* v) : Value(std::string(v)) {}
 
   /**
    * Constructs a non-null instance if `opt` has a value, otherwise constructs
@@ -292,26 +301,33 @@ class Value {
    */
   template <typename T>
   StatusOr<T> get() const& {
+    if (auto const* p = GetNativeIf<T>(native_)) return T(*p);
+    if (!absl::holds_alternative<absl::monostate>(native_)) {
+      return Encoded().get<T>();
+    }
     if (!TypeProtoIs(T{}, type_))
       return Status(StatusCode::kUnknown, "wrong type");
     if (value_.kind_case() == google::protobuf::Value::kNullValue) {
       if (IsOptional<T>::value) return T{};
       return Status(StatusCode::kUnknown, "null value");
     }
-    return GetValue(T{}, value_, type_);
+    return GetValue(Tag<T>{}, value_, type_);
   }
 
   /// @copydoc get()
   template <typename T>
   StatusOr<T> get() && {
+    if (auto* p = GetNativeIf<T>(native_)) return T(std::move(*p));
+    if (!absl::holds_alternative<absl::monostate>(native_)) {
+      return Encoded().get<T>();
+    }
     if (!TypeProtoIs(T{}, type_))
       return Status(StatusCode::kUnknown, "wrong type");
     if (value_.kind_case() == google::protobuf::Value::kNullValue) {
       if (IsOptional<T>::value) return T{};
       return Status(StatusCode::kUnknown, "null value");
     }
-    auto tag = T{};  // Works around an odd msvc issue
-    return GetValue(std::move(tag), std::move(value_), type_);
+    return GetValue(Tag<T>{}, std::move(value_), type_);
   }
 
   /**
@@ -510,46 +526,51 @@ class Value {
   };
 
   // Tag-dispatch overloads to extract a C++ value from a `Value` protobuf. The
-  // first argument type is the tag, its value is ignored.
-  static StatusOr<bool> GetValue(bool, google::protobuf::Value const&,
+  // first argument is the tag, an empty `Tag<T>` for the requested type `T`.
+  // Using a distinct tag type, instead of a `T` value, means each call matches
+  // exactly one overload, without any implicit conversions of the tag.
+  template <typename T>
+  struct Tag {};
+  static StatusOr<bool> GetValue(Tag<bool>, google::protobuf::Value const&,
                                  google::spanner::v1::Type const&);
-  static StatusOr<std::int64_t> GetValue(std::int64_t,
+  static StatusOr<std::int64_t> GetValue(Tag<std::int64_t>,
                                          google::protobuf::Value const&,
                                          google::spanner::v1::Type const&);
-  static StatusOr<double> GetValue(double, google::protobuf::Value const&,
+  static StatusOr<double> GetValue(Tag<double>, google::protobuf::Value const&,
                                    google::spanner::v1::Type const&);
-  static StatusOr<std::string> GetValue(std::string const&,
+  static StatusOr<std::string> GetValue(Tag<std::string>,
                                         google::protobuf::Value const&,
                                         google::spanner::v1::Type const&);
-  static StatusOr<std::string> GetValue(std::string const&,
+  static StatusOr<std::string> GetValue(Tag<std::string>,
                                         google::protobuf::Value&&,
                                         google::spanner::v1::Type const&);
-  static StatusOr<Bytes> GetValue(Bytes const&, google::protobuf::Value const&,
+  static StatusOr<Bytes> GetValue(Tag<Bytes>, google::protobuf::Value const&,
                                   google::spanner::v1::Type const&);
-  static StatusOr<Numeric> GetValue(Numeric const&,
+  static StatusOr<Numeric> GetValue(Tag<Numeric>,
                                     google::protobuf::Value const&,
                                     google::spanner::v1::Type const&);
-  static StatusOr<Timestamp> GetValue(Timestamp, google::protobuf::Value const&,
+  static StatusOr<Timestamp> GetValue(Tag<Timestamp>,
+                                      google::protobuf::Value const&,
                                       google::spanner::v1::Type const&);
-  static StatusOr<CommitTimestamp> GetValue(CommitTimestamp,
+  static StatusOr<CommitTimestamp> GetValue(Tag<CommitTimestamp>,
                                             google::protobuf::Value const&,
                                             google::spanner::v1::Type const&);
-  static StatusOr<absl::CivilDay> GetValue(absl::CivilDay,
+  static StatusOr<absl::CivilDay> GetValue(Tag<absl::CivilDay>,
                                            google::protobuf::Value const&,
                                            google::spanner::v1::Type const&);
   template <typename T, typename V>
   static StatusOr<absl::optional<T>> GetValue(
-      absl::optional<T> const&, V&& pv, google::spanner::v1::Type const& pt) {
+      Tag<absl::optional<T>>, V&& pv, google::spanner::v1::Type const& pt) {
     if (pv.kind_case() == google::protobuf::Value::kNullValue) {
       return absl::optional<T>{};
     }
-    auto value = GetValue(T{}, std::forward<V>(pv), pt);
+    auto value = GetValue(Tag<T>{}, std::forward<V>(pv), pt);
     if (!value) return std::move(value).status();
     return absl::optional<T>{*std::move(value)};
   }
   template <typename T, typename V>
   static StatusOr<std::vector<T>> GetValue(
-      std::vector<T> const&, V&& pv, google::spanner::v1::Type const& pt) {
+      Tag<std::vector<T>>, V&& pv, google::spanner::v1::Type const& pt) {
     if (pv.kind_case() != google::protobuf::Value::kListValue) {
       return Status(StatusCode::kUnknown, "missing ARRAY");
     }
@@ -557,7 +578,8 @@ class Value {
     for (int i = 0; i < pv.list_value().values().size(); ++i) {
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), pt.array_element_type());
+      auto value =
+          GetValue(Tag<T>{}, std::forward<ET>(e), pt.array_element_type());
       if (!value) return std::move(value).status();
       v.push_back(*std::move(value));
     }
@@ -565,7 +587,7 @@ class Value {
   }
   template <typename V, typename... Ts>
   static StatusOr<std::tuple<Ts...>> GetValue(
-      std::tuple<Ts...> const&, V&& pv, google::spanner::v1::Type const& pt) {
+      Tag<std::tuple<Ts...>>, V&& pv, google::spanner::v1::Type const& pt) {
     if (pv.kind_case() != google::protobuf::Value::kListValue) {
       return Status(StatusCode::kUnknown, "missing STRUCT");
     }
@@ -589,7 +611,7 @@ class Value {
     void operator()(T& t) {
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), type);
+      auto value = GetValue(Tag<T>{}, std::forward<ET>(e), type);
       ++i;
       if (!value) {
         status = std::move(value).status();
@@ -602,7 +624,7 @@ class Value {
       p.first = type.struct_type().fields(i).name();
       auto&& e = GetProtoListValueElement(std::forward<V>(pv), i);
       using ET = decltype(e);
-      auto value = GetValue(T{}, std::forward<ET>(e), type);
+      auto value = GetValue(Tag<T>{}, std::forward<ET>(e), type);
       ++i;
       if (!value) {
         status = std::move(value).status();
@@ -634,18 +656,90 @@ class Value {
   struct PrivateConstructor {};
   template <typename T>
   Value(PrivateConstructor, T&& t)
+      : Value(PrivateConstructor{}, std::forward<T>(t),
+              IsAlternative<typename std::decay<T>::type, Native>{}) {}
+  template <typename T>
+  Value(PrivateConstructor, T&& t, std::true_type)
+      : native_(std::forward<T>(t)) {}
+  template <typename T>
+  Value(PrivateConstructor, T&& t, std::false_type)
       : type_(MakeTypeProto(t)), value_(MakeValueProto(std::forward<T>(t))) {}
 
   Value(google::spanner::v1::Type t, google::protobuf::Value v)
       : type_(std::move(t)), value_(std::move(v)) {}
 
+  // The most common types are stored in their C++ representation, and only
+  // encoded as protos when needed, typically when they are added to a request.
+  // Formatting (and parsing) the protos is expensive, and many values, e.g.,
+  // the ones in mutations, are never read back. All other values, including
+  // the values received from Spanner and all null values, are stored in
+  // `type_` and `value_`, and `native_` holds `absl::monostate`.
+  using Native =
+      absl::variant<absl::monostate, bool, std::int64_t, double, std::string,
+                    Timestamp, absl::CivilDay, std::vector<bool>,
+                    std::vector<std::int64_t>, std::vector<double>,
+                    std::vector<std::string>, std::vector<Timestamp>,
+                    std::vector<absl::CivilDay>>;
+
+  // Metafunction that returns true if `T` is one of the alternatives in `V`.
+  template <typename T, typename V>
+  struct IsAlternative;
+  template <typename T, typename... Ts>
+  struct IsAlternative<T, absl::variant<Ts...>>
+      : absl::disjunction<std::is_same<T, Ts>...> {};
+
+  // Metafunction that returns the type in `native_` for a `get<T>()` call.
+  template <typename T>
+  struct NativeType {
+    using type = T;
+  };
+  template <typename T>
+  struct NativeType<absl::optional<T>> {
+    using type = T;
+  };
+
+  // Returns a pointer to the native value for a `get<T>()` call, or nullptr
+  // if `native` does not hold one.
+  template <typename T, typename N = typename NativeType<T>::type,
+            typename std::enable_if<IsAlternative<N, Native>::value,
+                                    int>::type = 0>
+  static N const* GetNativeIf(Native const& native) {
+    return absl::get_if<N>(&native);
+  }
+  template <typename T, typename N = typename NativeType<T>::type,
+            typename std::enable_if<IsAlternative<N, Native>::value,
+                                    int>::type = 0>
+  static N* GetNativeIf(Native& native) {
+    return absl::get_if<N>(&native);
+  }
+  template <typename T, typename N = typename NativeType<T>::type,
+            typename std::enable_if<!IsAlternative<N, Native>::value,
+                                    int>::type = 0>
+  static N* GetNativeIf(Native const&) {
+    return nullptr;
+  }
+
+  // Returns a copy of this object with the value stored as protos.
+  Value Encoded() const;
+
+  // Visitors to encode the alternatives in `native_`.
+  struct NativeTypeProto;
+  struct NativeValueProto;
+
   friend Value internal::FromProto(google::spanner::v1::Type,
                                    google::protobuf::Value);
   friend std::pair<google::spanner::v1::Type, google::protobuf::Value>
       internal::ToProto(Value);
+  friend void internal::ToProto(Value, google::protobuf::Value&);
+  template <typename T>
+  friend bool internal::TypeProtoIs(google::spanner::v1::Type const&);
+  template <typename T>
+  friend StatusOr<T> internal::FromProtoAs(google::spanner::v1::Type const&,
+                                           google::protobuf::Value&&);
 
   google::spanner::v1::Type type_;
   google::protobuf::Value value_;
+  Native native_;
 };
 
 /**
@@ -660,6 +754,32 @@ Value MakeNullValue() {
   return Value(absl::optional<T>{});
 }
 
+namespace internal {
+
+/// Returns true if @p t is the Spanner type for the C++ type `T`.
+template <typename T>
+bool TypeProtoIs(google::spanner::v1::Type const& t) {
+  return Value::TypeProtoIs(T{}, t);
+}
+
+/**
+ * Converts @p v, of type @p t, directly to the C++ type `T`.
+ *
+ * This is equivalent to `FromProto(t, v).get<T>()`, without creating a `Value`
+ * and assuming that `TypeProtoIs<T>(t)` has already been verified.
+ */
+template <typename T>
+StatusOr<T> FromProtoAs(google::spanner::v1::Type const& t,
+                        google::protobuf::Value&& v) {
+  if (v.kind_case() == google::protobuf::Value::kNullValue) {
+    if (Value::IsOptional<T>::value) return T{};
+    return Status(StatusCode::kUnknown, "null value");
+  }
+  return Value::GetValue(Value::Tag<T>{}, std::move(v), t);
+}
+
+}  // namespace internal
+
 }  // namespace SPANNER_CLIENT_NS
 }  // namespace spanner
 }  // namespace cloud
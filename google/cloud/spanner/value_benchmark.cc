@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/timestamp.h"
+#include "google/cloud/spanner/value.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace spanner {
+inline namespace SPANNER_CLIENT_NS {
+namespace {
+
+// Run on (1 X 2000 MHz CPU )
+// CPU Caches:
+//   L1 Data 48 KiB (x1)
+//   L1 Instruction 32 KiB (x1)
+//   L2 Unified 2048 KiB (x1)
+//   L3 Unified 107520 KiB (x1)
+// Load Average: 0.92, 0.98, 0.98
+// -------------------------------------------------------------------
+// Benchmark                         Time             CPU   Iterations
+// -------------------------------------------------------------------
+// BM_ValueCtorInt64              33.3 ns         32.4 ns     20837245
+// BM_ValueGetInt64               3.67 ns         3.55 ns    242859811
+// BM_ValueCtorArrayOfInt64       69.9 ns         67.2 ns     10165921
+// BM_InsertMutationBuilder     342081 ns       321054 ns         2344
+
+void BM_ValueCtorInt64(benchmark::State& state) {
+  std::int64_t i = 1234567890;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value(++i));
+  }
+}
+BENCHMARK(BM_ValueCtorInt64);
+
+void BM_ValueGetInt64(benchmark::State& state) {
+  Value v(std::int64_t{1234567890});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(v.get<std::int64_t>());
+  }
+}
+BENCHMARK(BM_ValueGetInt64);
+
+void BM_ValueCtorArrayOfInt64(benchmark::State& state) {
+  std::vector<std::int64_t> a(100);
+  for (std::size_t i = 0; i != a.size(); ++i) a[i] = 1234567890 + i;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value(a));
+  }
+}
+BENCHMARK(BM_ValueCtorArrayOfInt64);
+
+void BM_InsertMutationBuilder(benchmark::State& state) {
+  auto const ts = MakeTimestamp(std::chrono::system_clock::from_time_t(0) +
+                                std::chrono::hours(24 * 365 * 50))
+                      .value();
+  std::string const name = "a-value-of-moderate-length";
+  for (auto _ : state) {
+    InsertMutationBuilder builder(
+        "Table", {"Id", "Name", "Score", "Active", "Updated", "Birthday"});
+    for (std::int64_t id = 0; id != 100; ++id) {
+      builder.EmplaceRow(id, name, 0.5 * static_cast<double>(id), id % 2 == 0,
+                         ts, absl::CivilDay(1970, 1, 1 + id % 28));
+    }
+    benchmark::DoNotOptimize(std::move(builder).Build());
+  }
+}
+BENCHMARK(BM_InsertMutationBuilder);
+
+}  // namespace
+}  // namespace SPANNER_CLIENT_NS
+}  // namespace spanner
+}  // namespace cloud
+}  // namespace google
@@ -23,6 +23,7 @@
 #include <cmath>
 #include <ios>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -304,10 +305,12 @@ TEST(Value, RvalueGetVectorString) {
   EXPECT_STATUS_OK(s);
   EXPECT_EQ(data, *s);
 
+  // The vector is stored as a `std::vector<std::string>`, and is moved as a
+  // whole.
   // NOLINTNEXTLINE(bugprone-use-after-move)
   s = v.get<Type>();
   EXPECT_STATUS_OK(s);
-  EXPECT_EQ(Type(data.size(), ""), *s);
+  EXPECT_EQ(Type{}, *s);
 }
 
 // NOTE: This test relies on unspecified behavior about the moved-from state
@@ -336,6 +339,53 @@ TEST(Value, RvalueGetStructString) {
   EXPECT_EQ(Type({"name", ""}, ""), *s);
 }
 
+TEST(Value, NativeAndProtoRepresentations) {
+  auto const ts = MakeTimestamp(MakeTimePoint(1561135942, 123)).value();
+  std::vector<Value> const values = {
+      Value(true),
+      Value(42),
+      Value(3.14),
+      Value("hello"),
+      Value(ts),
+      Value(absl::CivilDay(2020, 5, 13)),
+      Value(std::vector<bool>{true, false}),
+      Value(std::vector<std::int64_t>{1, 2}),
+      Value(std::vector<double>{1.5, -0.0}),
+      Value(std::vector<std::string>{"a", "b"}),
+      Value(std::vector<Timestamp>{ts}),
+      Value(std::vector<absl::CivilDay>{}),
+  };
+  for (auto const& v : values) {
+    // The values built from C++ values and the same values decoded from their
+    // protos are interchangeable.
+    auto const protos = internal::ToProto(v);
+    auto const decoded = internal::FromProto(protos.first, protos.second);
+    EXPECT_EQ(v, decoded);
+    EXPECT_EQ(decoded, v);
+    std::ostringstream v_os;
+    v_os << v;
+    std::ostringstream decoded_os;
+    decoded_os << decoded;
+    EXPECT_EQ(decoded_os.str(), v_os.str());
+
+    google::protobuf::Value pv;
+    internal::ToProto(v, pv);
+    EXPECT_THAT(pv, IsProtoEqual(protos.second));
+  }
+
+  Value const v(std::vector<std::int64_t>{1, 2});
+  auto const optionals = v.get<std::vector<absl::optional<std::int64_t>>>();
+  ASSERT_STATUS_OK(optionals);
+  EXPECT_EQ((std::vector<absl::optional<std::int64_t>>{1, 2}), *optionals);
+  auto const optional = v.get<absl::optional<std::vector<std::int64_t>>>();
+  ASSERT_STATUS_OK(optional);
+  EXPECT_EQ((std::vector<std::int64_t>{1, 2}), **optional);
+  EXPECT_THAT(v.get<std::vector<double>>(), StatusIs(StatusCode::kUnknown));
+  EXPECT_THAT(Value(42).get<double>(), StatusIs(StatusCode::kUnknown));
+  EXPECT_THAT(Value(ts).get<CommitTimestamp>(),
+              StatusIs(StatusCode::kUnknown));
+}
+
 TEST(Value, DoubleNaN) {
   double const nan = std::nan("NaN");
   Value v{nan};
@@ -15,13 +15,18 @@
 #include "google/cloud/storage/client.h"
 #include "google/cloud/storage/internal/curl_client.h"
 #include "google/cloud/storage/internal/curl_handle.h"
+#include "google/cloud/storage/internal/download_journal.h"
+#include "google/cloud/storage/internal/file_io.h"
+#include "google/cloud/storage/internal/hash_validator_impl.h"
 #include "google/cloud/storage/internal/openssl_util.h"
+#include "google/cloud/storage/internal/upload_chunk_sizer.h"
 #include "google/cloud/storage/oauth2/service_account_credentials.h"
 #include "google/cloud/internal/filesystem.h"
 #include "google/cloud/log.h"
 #include "absl/memory/memory.h"
 #include <openssl/md5.h>
-#include <fstream>
+#include <chrono>
+#include <cstdlib>
 #include <thread>
 
 namespace google {
@@ -33,6 +38,28 @@ static_assert(std::is_copy_constructible<storage::Client>::value,
 static_assert(std::is_copy_assignable<storage::Client>::value,
               "storage::Client must be assignable");
 
+namespace {
+std::shared_ptr<internal::FileIoBackend> FileIoBackend(
+    ClientOptions const& options) {
+  return internal::CreateFileIoBackend(options.file_io_options());
+}
+
+internal::UploadChunkSizer MakeUploadChunkSizer(ClientOptions const& options) {
+  if (options.enable_adaptive_upload_chunk_size()) {
+    return internal::UploadChunkSizer::Adaptive(options.upload_buffer_size());
+  }
+  return internal::UploadChunkSizer(options.upload_buffer_size());
+}
+
+/// Returns the generation of the object being read, or 0 if not known.
+std::int64_t GenerationFromHeaders(
+    std::multimap<std::string, std::string> const& headers) {
+  auto const i = headers.find("x-goog-generation");
+  if (i == headers.end()) return 0;
+  return std::strtoll(i->second.c_str(), nullptr, 10);
+}
+}  // namespace
+
 std::shared_ptr<internal::RawClient> Client::CreateDefaultInternalClient(
     ClientOptions options) {
   return internal::CurlClient::Create(std::move(options));
@@ -56,10 +83,17 @@ ObjectReadStream Client::ReadObjectImpl(
     error_stream.setstate(std::ios::badbit | std::ios::eofbit);
     return error_stream;
   }
+  // Stream positions are offsets in the object, except with `ReadLast`, where
+  // the starting offset is unknown.
+  auto const pos_in_stream =
+      request.HasOption<ReadLast>() ? 0 : request.StartingByte();
+  auto client = raw_client_;
+  auto reopen = [client](internal::ReadObjectRangeRequest const& r) {
+    return client->ReadObject(r);
+  };
   auto stream =
       ObjectReadStream(absl::make_unique<internal::ObjectReadStreambuf>(
-          request, *std::move(source),
-          request.GetOption<ReadFromOffset>().value_or(0)));
+          request, *std::move(source), pos_in_stream, std::move(reopen)));
   (void)stream.peek();
 #if !GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
   // Without exceptions the streambuf cannot report errors, so we have to
@@ -87,7 +121,7 @@ ObjectWriteStream Client::WriteObjectImpl(
     return error_stream;
   }
   return ObjectWriteStream(absl::make_unique<internal::ObjectWriteStreambuf>(
-      *std::move(session), raw_client_->client_options().upload_buffer_size(),
+      *std::move(session), MakeUploadChunkSizer(raw_client_->client_options()),
       internal::CreateHashValidator(request)));
 }
 
@@ -120,25 +154,27 @@ StatusOr<ObjectMetadata> Client::UploadFileSimple(
       request.GetOption<UploadLimit>().value_or(file_size - upload_offset),
       file_size - upload_offset);
 
-  std::ifstream is(file_name, std::ios::binary);
-  if (!is.is_open()) {
+  auto source = FileIoBackend(raw_client_->client_options())
+                    ->OpenForRead(file_name, upload_offset);
+  if (!source) {
     std::ostringstream os;
     os << __func__ << "(" << request << ", " << file_name
-       << "): cannot open upload file source";
+       << "): cannot open upload file source - "
+       << source.status().message();
     return Status(StatusCode::kNotFound, std::move(os).str());
   }
 
   std::string payload(static_cast<std::size_t>(upload_size), char{});
-  is.seekg(upload_offset, std::ios::beg);
-  is.read(&payload[0], payload.size());
-  if (static_cast<std::size_t>(is.gcount()) < payload.size()) {
+  auto gcount = (*source)->Read(&payload[0], payload.size());
+  if (!gcount) return std::move(gcount).status();
+  if (*gcount < payload.size()) {
     std::ostringstream os;
     os << __func__ << "(" << request << ", " << file_name << "): Actual read ("
-       << is.gcount() << ") is smaller than upload_size (" << payload.size()
+       << *gcount << ") is smaller than upload_size (" << payload.size()
        << ")";
     return Status(StatusCode::kInternal, std::move(os).str());
   }
-  is.close();
+  source->reset();
   request.set_contents(std::move(payload));
 
   return raw_client_->InsertObjectMedia(request);
@@ -181,22 +217,24 @@ integrity checks using the DisableMD5Hash() and DisableCrc32cChecksum() options.
         file_size - upload_offset);
     request.set_option(UploadContentLength(upload_size));
   }
-  std::ifstream source(file_name, std::ios::binary);
-  if (!source.is_open()) {
+  // We set its offset before passing it to `UploadStreamResumable` so we don't
+  // need to compute `UploadFromOffset` again.
+  auto source = FileIoBackend(raw_client_->client_options())
+                    ->OpenForRead(file_name, upload_offset);
+  if (!source) {
     std::ostringstream os;
     os << __func__ << "(" << request << ", " << file_name
-       << "): cannot open upload file source";
+       << "): cannot open upload file source - "
+       << source.status().message();
     return Status(StatusCode::kNotFound, std::move(os).str());
   }
-  // We set its offset before passing it to `UploadStreamResumable` so we don't
-  // need to compute `UploadFromOffset` again.
-  source.seekg(upload_offset, std::ios::beg);
-  return UploadStreamResumable(source, request);
+  return UploadStreamResumable(**source, request);
 }
 
 // NOLINTNEXTLINE(readability-make-member-function-const)
 StatusOr<ObjectMetadata> Client::UploadStreamResumable(
-    std::istream& source, internal::ResumableUploadRequest const& request) {
+    internal::FileReader& source,
+    internal::ResumableUploadRequest const& request) {
   StatusOr<std::unique_ptr<internal::ResumableUploadSession>> session_status =
       raw_client()->CreateResumableSession(request);
   if (!session_status) {
@@ -216,33 +254,38 @@ StatusOr<ObjectMetadata> Client::UploadStreamResumable(
                       ") is not bigger than the uploaded size (" +
                       std::to_string(server_size) + ") on GCS server");
   }
-  source.seekg(server_size, std::ios::cur);
+  auto seek = source.Seek(source.offset() + server_size);
+  if (!seek.ok()) return seek;
 
   // GCS requires chunks to be a multiple of 256KiB.
-  auto chunk_size = internal::UploadChunkRequest::RoundUpToQuantum(
-      raw_client()->client_options().upload_buffer_size());
+  auto sizer = MakeUploadChunkSizer(raw_client()->client_options());
+  auto chunk_size = sizer.chunk_size();
 
   StatusOr<internal::ResumableUploadResponse> upload_response(
       internal::ResumableUploadResponse{});
-  // We iterate while `source` is good, the upload size does not reach the
-  // `UploadLimit` and the retry policy has not been exhausted.
+  // We iterate while `source` has more data, the upload size does not reach
+  // the `UploadLimit` and the retry policy has not been exhausted.
   bool reach_upload_limit = false;
+  bool eof = false;
   internal::ConstBufferSequence buffers(1);
   std::vector<char> buffer(chunk_size);
-  while (!source.eof() && upload_response &&
-         !upload_response->payload.has_value() && !reach_upload_limit) {
+  while (!eof && upload_response && !upload_response->payload.has_value() &&
+         !reach_upload_limit) {
     // Read a chunk of data from the source file.
     if (upload_limit - server_size <= chunk_size) {
       // We don't want the `source_size` to exceed `upload_limit`.
       chunk_size = static_cast<std::size_t>(upload_limit - server_size);
       reach_upload_limit = true;
     }
-    source.read(buffer.data(), buffer.size());
-    auto gcount = static_cast<std::size_t>(source.gcount());
-    bool final_chunk = (gcount < buffer.size()) || reach_upload_limit;
+    auto read = source.Read(buffer.data(), buffer.size());
+    if (!read) return std::move(read).status();
+    auto gcount = *read;
+    eof = gcount < buffer.size();
+    bool final_chunk = eof || reach_upload_limit;
     auto source_size = session->next_expected_byte() + gcount;
     auto expected = source_size;
     buffers[0] = internal::ConstBuffer{buffer.data(), gcount};
+    auto const start = std::chrono::steady_clock::now();
     if (final_chunk) {
       upload_response = session->UploadFinalChunk(buffers, source_size);
     } else {
@@ -264,6 +307,14 @@ StatusOr<ObjectMetadata> Client::UploadStreamResumable(
 
     // We only update `server_size` when uploading is successful.
     server_size = expected;
+
+    sizer.Update(gcount, std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start));
+    if (!reach_upload_limit && sizer.chunk_size() != chunk_size) {
+      chunk_size = sizer.chunk_size();
+      buffer.resize(chunk_size);
+      buffer.shrink_to_fit();
+    }
   }
 
   if (!upload_response) {
@@ -283,35 +334,191 @@ Status Client::DownloadFileImpl(internal::ReadObjectRangeRequest const& request,
     return Status(status.code(), std::move(msg).str());
   };
 
+  if (request.GetOption<ResumableDownload>().value_or(false)) {
+    return DownloadFileResumableImpl(request, file_name);
+  }
+
   auto stream = ReadObjectImpl(request);
   if (!stream.status().ok()) {
     return report_error(__func__, "cannot open download source object",
                         stream.status());
   }
 
-  // Open the destination file, and immediate raise an exception on failure.
-  std::ofstream os(file_name, std::ios::binary);
-  if (!os.is_open()) {
+  // Open the destination file, and immediately return on failure.
+  auto os =
+      FileIoBackend(raw_client_->client_options())->OpenForWrite(file_name, 0);
+  if (!os) {
+    return report_error(__func__, "cannot open download destination file",
+                        os.status());
+  }
+
+  // The writer may copy the data and write it in the background, so we can
+  // reuse the buffer for the next read while the previous block is written.
+  std::string buffer;
+  buffer.resize(raw_client_->client_options().download_buffer_size(), '\0');
+  Status write_status;
+  do {
+    stream.read(&buffer[0], buffer.size());
+    write_status = (*os)->Write(buffer.data(),
+                                static_cast<std::size_t>(stream.gcount()));
+  } while (write_status.ok() && stream.good());
+  auto close_status = (*os)->Close();
+  if (!write_status.ok()) {
+    return report_error(__func__, "cannot write download destination file",
+                        write_status);
+  }
+  if (!close_status.ok()) {
+    return report_error(__func__, "cannot close download destination file",
+                        close_status);
+  }
+  if (!stream.status().ok()) {
+    return report_error(__func__, "error reading download source object",
+                        stream.status());
+  }
+  return Status();
+}
+
+Status Client::DownloadFileResumableImpl(
+    internal::ReadObjectRangeRequest const& request,
+    std::string const& file_name) {
+  auto report_error = [&request, file_name](char const* func, char const* what,
+                                            Status const& status) {
+    std::ostringstream msg;
+    msg << func << "(" << request << ", " << file_name << "): " << what
+        << " - status.message=" << status.message();
+    return Status(status.code(), std::move(msg).str());
+  };
+  // Save the progress after this many bytes. Each checkpoint waits for any
+  // pending writes, so it should not be too frequent.
+  auto constexpr kCheckpointInterval = 64 * 1024 * 1024ULL;
+
+  if (request.HasOption<ReadFromOffset>() || request.HasOption<ReadRange>() ||
+      request.HasOption<ReadLast>()) {
     return report_error(
-        __func__, "cannot open download destination file",
-        Status(StatusCode::kInvalidArgument, "ofstream::open()"));
+        __func__, "invalid options",
+        Status(StatusCode::kInvalidArgument,
+               "ResumableDownload cannot be combined with ReadFromOffset,"
+               " ReadRange, or ReadLast"));
+  }
+
+  auto const journal_name = internal::DownloadJournalName(file_name);
+  internal::DownloadJournal const initial{
+      request.bucket_name(), request.object_name(), 0, 0, 0, {}};
+  auto journal = initial;
+  auto saved = internal::ReadDownloadJournal(journal_name);
+  if (saved && saved->bucket_name == initial.bucket_name &&
+      saved->object_name == initial.object_name) {
+    // The journal is only useful if the file has all the data it records.
+    std::error_code ec;
+    auto const size = google::cloud::internal::file_size(file_name, ec);
+    if (!ec && size >= saved->committed_bytes) journal = *std::move(saved);
+  }
+
+  // The CRC32C checksum is computed below, where it can be saved in the
+  // journal, there is no need to compute it in the stream too.
+  auto open = [this, &request](std::uint64_t offset, std::int64_t generation) {
+    auto r = request;
+    r.set_option(DisableCrc32cChecksum(true));
+    if (offset != 0) {
+      r.set_option(ReadFromOffset(static_cast<std::int64_t>(offset)));
+    }
+    // Only resume if the object is the one recorded in the journal, the
+    // service rejects the request otherwise.
+    if (generation != 0 && !r.HasOption<IfGenerationMatch>()) {
+      r.set_option(IfGenerationMatch(generation));
+    }
+    return ReadObjectImpl(r);
+  };
+  auto stream = open(journal.committed_bytes,
+                     journal.committed_bytes == 0 ? 0 : journal.generation);
+  if (journal.committed_bytes != 0 &&
+      (!stream.status().ok() ||
+       GenerationFromHeaders(stream.headers()) != journal.generation)) {
+    // The object has changed since the journal was written, or it cannot be
+    // read from the saved offset. Start again from the beginning.
+    stream.Close();
+    journal = initial;
+    stream = open(0, 0);
+  }
+  if (!stream.status().ok()) {
+    return report_error(__func__, "cannot open download source object",
+                        stream.status());
   }
+  journal.generation = GenerationFromHeaders(stream.headers());
+
+  internal::Crc32cHashValidator crc32c(journal.crc32c);
+  if (!journal.received_crc32c.empty()) {
+    crc32c.ProcessHeader("x-goog-hash", "crc32c=" + journal.received_crc32c);
+  }
+  for (auto const& kv : stream.headers()) {
+    crc32c.ProcessHeader(kv.first, kv.second);
+  }
+  journal.received_crc32c = crc32c.received_hash();
+
+  auto os = FileIoBackend(raw_client_->client_options())
+                ->OpenForWrite(file_name, journal.committed_bytes);
+  if (!os) {
+    return report_error(__func__, "cannot open download destination file",
+                        os.status());
+  }
+
+  auto offset = journal.committed_bytes;
+  // Wait until the data is in the file, and then record the progress.
+  auto checkpoint = [&] {
+    auto status = (*os)->Flush();
+    if (!status.ok()) return status;
+    journal.committed_bytes = offset;
+    journal.crc32c = crc32c.current();
+    status = internal::WriteDownloadJournal(journal_name, journal);
+    if (!status.ok()) {
+      // The download can continue, it just cannot be resumed from this point.
+      GCP_LOG(WARNING) << "cannot save download progress: " << status;
+    }
+    return Status();
+  };
 
   std::string buffer;
   buffer.resize(raw_client_->client_options().download_buffer_size(), '\0');
+  auto next_checkpoint = offset + kCheckpointInterval;
+  Status write_status;
   do {
     stream.read(&buffer[0], buffer.size());
-    os.write(buffer.data(), stream.gcount());
-  } while (os.good() && stream.good());
-  os.close();
-  if (!os.good()) {
+    auto const n = static_cast<std::size_t>(stream.gcount());
+    crc32c.Update(buffer.data(), n);
+    write_status = (*os)->Write(buffer.data(), n);
+    offset += n;
+    if (write_status.ok() && offset >= next_checkpoint) {
+      write_status = checkpoint();
+      next_checkpoint = offset + kCheckpointInterval;
+    }
+  } while (write_status.ok() && stream.good());
+  // The data received before an error is valid, save it for the next attempt.
+  if (write_status.ok() && !stream.status().ok()) write_status = checkpoint();
+  auto close_status = (*os)->Close();
+  if (!write_status.ok()) {
+    return report_error(__func__, "cannot write download destination file",
+                        write_status);
+  }
+  if (!close_status.ok()) {
     return report_error(__func__, "cannot close download destination file",
-                        Status(StatusCode::kUnknown, "ofstream::close()"));
+                        close_status);
   }
   if (!stream.status().ok()) {
     return report_error(__func__, "error reading download source object",
                         stream.status());
   }
+
+  // The download is complete, the journal is no longer needed, even if the
+  // checksums do not match: the next attempt should start from scratch.
+  (void)internal::RemoveDownloadJournal(journal_name);
+  auto result = std::move(crc32c).Finish();
+  if (result.is_mismatch &&
+      !request.GetOption<DisableCrc32cChecksum>().value_or(false)) {
+    return report_error(
+        __func__, "mismatched checksums in download",
+        Status(StatusCode::kDataLoss, "computed=" + result.computed +
+                                          ", received=" + result.received));
+  }
   return Status();
 }
 
@@ -16,11 +16,14 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_H
 
 #include "google/cloud/storage/hmac_key_metadata.h"
+#include "google/cloud/storage/internal/file_io.h"
 #include "google/cloud/storage/internal/logging_client.h"
+#include "google/cloud/storage/internal/metrics_client.h"
 #include "google/cloud/storage/internal/parameter_pack_validation.h"
 #include "google/cloud/storage/internal/policy_document_request.h"
 #include "google/cloud/storage/internal/retry_client.h"
 #include "google/cloud/storage/internal/signed_url_requests.h"
+#include "google/cloud/storage/internal/single_flight_client.h"
 #include "google/cloud/storage/internal/tuple_filter.h"
 #include "google/cloud/storage/list_buckets_reader.h"
 #include "google/cloud/storage/list_hmac_keys_reader.h"
@@ -1284,7 +1287,7 @@ class Client {
    *   Valid types for this operation include `IfGenerationMatch`,
    *   `IfGenerationNotMatch`, `IfMetagenerationMatch`,
    *   `IfMetagenerationNotMatch`, `Generation`, `ReadFromOffset`, `ReadRange`,
-   *   and `UserProject`.
+   *   `ResumableDownload`, and `UserProject`.
    *
    * @par Idempotency
    * This is a read-only operation and is always idempotent.
@@ -3113,9 +3116,23 @@ class Client {
     if (client->client_options().enable_raw_client_tracing()) {
       client = std::make_shared<internal::LoggingClient>(std::move(client));
     }
-    auto retry = std::make_shared<internal::RetryClient>(
+    auto metrics = client->client_options().client_metrics();
+    if (metrics) {
+      client = std::make_shared<internal::MetricsClient>(
+          std::move(client), metrics, internal::MetricsClient::Layer::kAttempt);
+    }
+    client = std::make_shared<internal::RetryClient>(
         std::move(client), std::forward<Policies>(policies)...);
-    return retry;
+    if (client->client_options().enable_request_coalescing()) {
+      client =
+          std::make_shared<internal::SingleFlightClient>(std::move(client));
+    }
+    if (metrics) {
+      return std::make_shared<internal::MetricsClient>(
+          std::move(client), std::move(metrics),
+          internal::MetricsClient::Layer::kOperation);
+    }
+    return client;
   }
 
   ObjectReadStream ReadObjectImpl(
@@ -3168,11 +3185,16 @@ class Client {
       std::string const& file_name, internal::ResumableUploadRequest request);
 
   StatusOr<ObjectMetadata> UploadStreamResumable(
-      std::istream& source, internal::ResumableUploadRequest const& request);
+      internal::FileReader& source,
+      internal::ResumableUploadRequest const& request);
 
   Status DownloadFileImpl(internal::ReadObjectRangeRequest const& request,
                           std::string const& file_name);
 
+  Status DownloadFileResumableImpl(
+      internal::ReadObjectRangeRequest const& request,
+      std::string const& file_name);
+
   /// Determine the email used to sign a blob.
   std::string SigningEmail(SigningAccount const& signing_account);
 
@@ -0,0 +1,161 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+
+char const* MetricsOperationName(MetricsOperation op) {
+  static std::array<char const*,
+                    static_cast<std::size_t>(
+                        MetricsOperation::kOperationCount)> const kNames{{
+      "ListBuckets",
+      "CreateBucket",
+      "GetBucketMetadata",
+      "DeleteBucket",
+      "UpdateBucket",
+      "PatchBucket",
+      "GetBucketIamPolicy",
+      "GetNativeBucketIamPolicy",
+      "SetBucketIamPolicy",
+      "SetNativeBucketIamPolicy",
+      "TestBucketIamPermissions",
+      "LockBucketRetentionPolicy",
+      "InsertObjectMedia",
+      "CopyObject",
+      "GetObjectMetadata",
+      "ReadObject",
+      "ListObjects",
+      "DeleteObject",
+      "UpdateObject",
+      "PatchObject",
+      "ComposeObject",
+      "RewriteObject",
+      "CreateResumableSession",
+      "RestoreResumableSession",
+      "DeleteResumableUpload",
+      "CreateMultipartUpload",
+      "UploadPart",
+      "CompleteMultipartUpload",
+      "AbortMultipartUpload",
+      "ListBucketAcl",
+      "GetBucketAcl",
+      "CreateBucketAcl",
+      "DeleteBucketAcl",
+      "UpdateBucketAcl",
+      "PatchBucketAcl",
+      "ListObjectAcl",
+      "CreateObjectAcl",
+      "DeleteObjectAcl",
+      "GetObjectAcl",
+      "UpdateObjectAcl",
+      "PatchObjectAcl",
+      "ListDefaultObjectAcl",
+      "CreateDefaultObjectAcl",
+      "DeleteDefaultObjectAcl",
+      "GetDefaultObjectAcl",
+      "UpdateDefaultObjectAcl",
+      "PatchDefaultObjectAcl",
+      "GetServiceAccount",
+      "ListHmacKeys",
+      "CreateHmacKey",
+      "DeleteHmacKey",
+      "GetHmacKey",
+      "UpdateHmacKey",
+      "SignBlob",
+      "ListNotifications",
+      "CreateNotification",
+      "GetNotification",
+      "DeleteNotification",
+      "UploadChunk",
+  }};
+  auto const index = static_cast<std::size_t>(op);
+  if (index >= kNames.size()) return "unknown";
+  return kNames[index];
+}
+
+LatencySnapshot::LatencySnapshot(std::vector<std::uint64_t> buckets,
+                                 std::chrono::microseconds sum)
+    : buckets_(std::move(buckets)), sum_(sum) {
+  for (auto c : buckets_) count_ += c;
+}
+
+std::chrono::microseconds LatencySnapshot::Mean() const {
+  if (count_ == 0) return std::chrono::microseconds(0);
+  return sum_ / static_cast<std::chrono::microseconds::rep>(count_);
+}
+
+std::chrono::microseconds LatencySnapshot::Percentile(double percentile) const {
+  if (count_ == 0) return std::chrono::microseconds(0);
+  percentile = (std::max)(0.0, (std::min)(100.0, percentile));
+  auto const rank = static_cast<std::uint64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(count_)));
+  std::uint64_t accumulated = 0;
+  for (std::size_t i = 0; i != buckets_.size(); ++i) {
+    accumulated += buckets_[i];
+    if (accumulated >= rank && accumulated != 0) return BucketLowerBound(i);
+  }
+  return BucketLowerBound(buckets_.size() - 1);
+}
+
+std::chrono::microseconds LatencySnapshot::BucketLowerBound(std::size_t index) {
+  return std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(
+      internal::LatencyHistogram::BucketLowerBound(index)));
+}
+
+std::vector<OperationMetricsSnapshot> ClientMetrics::Snapshot() const {
+  std::vector<OperationMetricsSnapshot> result;
+  for (std::size_t i = 0; i != operations_.size(); ++i) {
+    auto const& m = operations_[i];
+    if (m.calls.load(std::memory_order_relaxed) == 0 &&
+        m.attempts.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+    result.push_back(Snapshot(static_cast<MetricsOperation>(i)));
+  }
+  return result;
+}
+
+OperationMetricsSnapshot ClientMetrics::Snapshot(MetricsOperation op) const {
+  auto const& m = operations_[static_cast<std::size_t>(op)];
+  OperationMetricsSnapshot snapshot;
+  snapshot.operation = MetricsOperationName(op);
+  snapshot.calls = m.calls.load(std::memory_order_relaxed);
+  snapshot.attempts = m.attempts.load(std::memory_order_relaxed);
+  snapshot.bytes_uploaded = m.bytes_uploaded.load(std::memory_order_relaxed);
+  snapshot.bytes_downloaded =
+      m.bytes_downloaded.load(std::memory_order_relaxed);
+  snapshot.transfer_time =
+      std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(
+          m.transfer_time_us.load(std::memory_order_relaxed)));
+  for (std::size_t code = 0; code != m.errors.size(); ++code) {
+    auto const count = m.errors[code].load(std::memory_order_relaxed);
+    if (count == 0) continue;
+    snapshot.errors[static_cast<StatusCode>(code)] = count;
+  }
+  snapshot.latency = LatencySnapshot(m.latency.Counts(), m.latency.Sum());
+  snapshot.time_to_first_byte = LatencySnapshot(
+      m.time_to_first_byte.Counts(), m.time_to_first_byte.Sum());
+  return snapshot;
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
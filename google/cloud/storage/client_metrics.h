@@ -0,0 +1,245 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
+
+#include "google/cloud/storage/internal/operation_metrics.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * The operations tracked by `ClientMetrics`.
+ *
+ * There is one value for each `internal::RawClient` member function, plus
+ * `kUploadChunk` which tracks the `ResumableUploadSession::UploadChunk()` and
+ * `ResumableUploadSession::UploadFinalChunk()` calls.
+ */
+enum class MetricsOperation {
+  kListBuckets,
+  kCreateBucket,
+  kGetBucketMetadata,
+  kDeleteBucket,
+  kUpdateBucket,
+  kPatchBucket,
+  kGetBucketIamPolicy,
+  kGetNativeBucketIamPolicy,
+  kSetBucketIamPolicy,
+  kSetNativeBucketIamPolicy,
+  kTestBucketIamPermissions,
+  kLockBucketRetentionPolicy,
+  kInsertObjectMedia,
+  kCopyObject,
+  kGetObjectMetadata,
+  kReadObject,
+  kListObjects,
+  kDeleteObject,
+  kUpdateObject,
+  kPatchObject,
+  kComposeObject,
+  kRewriteObject,
+  kCreateResumableSession,
+  kRestoreResumableSession,
+  kDeleteResumableUpload,
+  kCreateMultipartUpload,
+  kUploadPart,
+  kCompleteMultipartUpload,
+  kAbortMultipartUpload,
+  kListBucketAcl,
+  kGetBucketAcl,
+  kCreateBucketAcl,
+  kDeleteBucketAcl,
+  kUpdateBucketAcl,
+  kPatchBucketAcl,
+  kListObjectAcl,
+  kCreateObjectAcl,
+  kDeleteObjectAcl,
+  kGetObjectAcl,
+  kUpdateObjectAcl,
+  kPatchObjectAcl,
+  kListDefaultObjectAcl,
+  kCreateDefaultObjectAcl,
+  kDeleteDefaultObjectAcl,
+  kGetDefaultObjectAcl,
+  kUpdateDefaultObjectAcl,
+  kPatchDefaultObjectAcl,
+  kGetServiceAccount,
+  kListHmacKeys,
+  kCreateHmacKey,
+  kDeleteHmacKey,
+  kGetHmacKey,
+  kUpdateHmacKey,
+  kSignBlob,
+  kListNotifications,
+  kCreateNotification,
+  kGetNotification,
+  kDeleteNotification,
+  kUploadChunk,
+  // Not an operation, used to size the arrays holding the metrics.
+  kOperationCount,
+};
+
+/// Returns the name of @p op, as used in `OperationMetricsSnapshot`.
+char const* MetricsOperationName(MetricsOperation op);
+
+/**
+ * A point-in-time copy of a latency histogram.
+ *
+ * The histogram uses log-linear buckets: values below 32 microseconds have
+ * their own bucket, and each power of two above that is split into 16
+ * sub-buckets. Any value reported by this class is within 1/16 of the actual
+ * value.
+ */
+class LatencySnapshot {
+ public:
+  LatencySnapshot() = default;
+  LatencySnapshot(std::vector<std::uint64_t> buckets,
+                  std::chrono::microseconds sum);
+
+  /// The number of values recorded in the histogram.
+  std::uint64_t count() const { return count_; }
+
+  /// The sum of all the values recorded in the histogram.
+  std::chrono::microseconds sum() const { return sum_; }
+
+  /// The mean of all the values, zero if the histogram is empty.
+  std::chrono::microseconds Mean() const;
+
+  /**
+   * Returns an estimate for the @p percentile (between 0 and 100) value.
+   *
+   * The estimate is the lower bound of the bucket containing the requested
+   * value, zero if the histogram is empty.
+   */
+  std::chrono::microseconds Percentile(double percentile) const;
+
+  /// The number of values recorded in each bucket.
+  std::vector<std::uint64_t> const& buckets() const { return buckets_; }
+
+  /// The smallest value recorded in the bucket at @p index.
+  static std::chrono::microseconds BucketLowerBound(std::size_t index);
+
+ private:
+  std::vector<std::uint64_t> buckets_;
+  std::uint64_t count_ = 0;
+  std::chrono::microseconds sum_ = std::chrono::microseconds(0);
+};
+
+/**
+ * The metrics for a single operation type.
+ *
+ * Operations are named after the member functions in `internal::RawClient`,
+ * with the addition of `UploadChunk`, which reports the individual chunks
+ * uploaded by a resumable upload.
+ *
+ * Streaming downloads are reported as part of the `ReadObject` operation: the
+ * `latency` histogram reports the time to open the stream, while
+ * `time_to_first_byte` reports the time from the start of the `ReadObject`
+ * call until the first byte is received. The `transfer_time` field is the
+ * total time spent in calls to receive data, and together with
+ * `bytes_downloaded` can be used to compute the stream throughput.
+ */
+struct OperationMetricsSnapshot {
+  /// The name of the operation, for example `GetObjectMetadata`.
+  std::string operation;
+
+  /// The number of calls made by the application, including failed calls.
+  std::uint64_t calls = 0;
+
+  /// The number of attempts to complete the calls, including retries.
+  std::uint64_t attempts = 0;
+
+  std::uint64_t bytes_uploaded = 0;
+  std::uint64_t bytes_downloaded = 0;
+  std::chrono::microseconds transfer_time = std::chrono::microseconds(0);
+
+  /// The number of failed calls, grouped by their error code.
+  std::map<StatusCode, std::uint64_t> errors;
+
+  /// The latency for each call, including any retries.
+  LatencySnapshot latency;
+
+  /// The time to receive the first byte in streaming downloads.
+  LatencySnapshot time_to_first_byte;
+
+  /// The number of attempts that were retries.
+  std::uint64_t retries() const {
+    return attempts > calls ? attempts - calls : 0;
+  }
+};
+
+/**
+ * Collects latency and throughput metrics for a `storage::Client`.
+ *
+ * Applications enable the metrics by setting an instance of this class in the
+ * `ClientOptions` used to create the client (see
+ * `ClientOptions::set_client_metrics()`), and then periodically calling
+ * `Snapshot()` to export the values to their monitoring system. A single
+ * `ClientMetrics` object may be shared by several clients.
+ *
+ * The metrics are recorded without locks, so enabling them has little impact
+ * on the client performance, even with many threads.
+ *
+ * @par Example
+ * @code
+ * auto metrics = std::make_shared<gcs::ClientMetrics>();
+ * gcs::Client client(gcs::ClientOptions(credentials)
+ *                        .set_client_metrics(metrics));
+ * // ... use the client ...
+ * for (auto const& op : metrics->Snapshot()) {
+ *   std::cout << op.operation << " p99="
+ *             << op.latency.Percentile(99).count() << "us\n";
+ * }
+ * @endcode
+ */
+class ClientMetrics {
+ public:
+  ClientMetrics() = default;
+
+  ClientMetrics(ClientMetrics const&) = delete;
+  ClientMetrics& operator=(ClientMetrics const&) = delete;
+
+  /// Returns the current metrics for all the operations used at least once.
+  std::vector<OperationMetricsSnapshot> Snapshot() const;
+
+  /// Returns the metrics for a single operation.
+  OperationMetricsSnapshot Snapshot(MetricsOperation op) const;
+
+  /// Used by the library to record metrics, applications should not need it.
+  internal::OperationMetrics& operation(MetricsOperation op) {
+    return operations_[static_cast<std::size_t>(op)];
+  }
+
+ private:
+  std::array<internal::OperationMetrics,
+             static_cast<std::size_t>(MetricsOperation::kOperationCount)>
+      operations_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_METRICS_H
@@ -0,0 +1,89 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_metrics.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using std::chrono::microseconds;
+
+TEST(ClientMetricsTest, EmptySnapshot) {
+  ClientMetrics metrics;
+  EXPECT_THAT(metrics.Snapshot(), IsEmpty());
+}
+
+TEST(ClientMetricsTest, Snapshot) {
+  ClientMetrics metrics;
+  auto& m = metrics.operation(MetricsOperation::kGetObjectMetadata);
+  m.RecordAttempt();
+  m.RecordAttempt();
+  m.RecordAttempt();
+  m.RecordCall(microseconds(100), Status());
+  m.RecordCall(microseconds(200), Status(StatusCode::kNotFound, "uh-oh"));
+
+  auto const snapshot = metrics.Snapshot();
+  ASSERT_EQ(1, snapshot.size());
+  auto const& s = snapshot.front();
+  EXPECT_EQ("GetObjectMetadata", s.operation);
+  EXPECT_EQ(2, s.calls);
+  EXPECT_EQ(3, s.attempts);
+  EXPECT_EQ(1, s.retries());
+  EXPECT_THAT(s.errors, ElementsAre(Pair(StatusCode::kNotFound, 1)));
+  EXPECT_EQ(2, s.latency.count());
+  EXPECT_EQ(microseconds(300), s.latency.sum());
+  EXPECT_EQ(microseconds(150), s.latency.Mean());
+  EXPECT_EQ(0, s.time_to_first_byte.count());
+}
+
+TEST(ClientMetricsTest, OperationNames) {
+  ClientMetrics metrics;
+  EXPECT_EQ("ListBuckets",
+            metrics.Snapshot(MetricsOperation::kListBuckets).operation);
+  EXPECT_EQ("UploadChunk",
+            metrics.Snapshot(MetricsOperation::kUploadChunk).operation);
+}
+
+TEST(LatencySnapshotTest, Percentile) {
+  std::vector<std::uint64_t> buckets(64);
+  buckets[1] = 50;
+  buckets[10] = 40;
+  buckets[20] = 10;
+  LatencySnapshot snapshot(buckets, microseconds(0));
+  EXPECT_EQ(100, snapshot.count());
+  EXPECT_EQ(microseconds(1), snapshot.Percentile(0));
+  EXPECT_EQ(microseconds(1), snapshot.Percentile(50));
+  EXPECT_EQ(microseconds(10), snapshot.Percentile(90));
+  EXPECT_EQ(microseconds(20), snapshot.Percentile(99));
+  EXPECT_EQ(microseconds(20), snapshot.Percentile(100));
+}
+
+TEST(LatencySnapshotTest, EmptyPercentile) {
+  LatencySnapshot snapshot;
+  EXPECT_EQ(microseconds(0), snapshot.Percentile(50));
+  EXPECT_EQ(microseconds(0), snapshot.Mean());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -23,6 +23,7 @@ namespace google {
 namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
+class ClientMetrics;
 class ClientOptions;
 namespace internal {
 std::string JsonEndpoint(ClientOptions const&);
@@ -55,6 +56,56 @@ class ChannelOptions {
   std::string ssl_root_path_;
 };
 
+/**
+ * Configure how `DownloadToFile()` and `UploadFile()` access local files.
+ *
+ * By default the client uses blocking `pread(2)` and `pwrite(2)` calls, which
+ * work with any file system and file type. On Linux kernels that support it,
+ * applications can enable `io_uring(7)` to overlap the disk I/O with the
+ * network transfer. The client falls back to blocking I/O if `io_uring` is not
+ * available, or the file is not a regular file.
+ */
+class FileIoOptions {
+ public:
+  bool enable_io_uring() const { return enable_io_uring_; }
+  FileIoOptions& set_enable_io_uring(bool enable) {
+    enable_io_uring_ = enable;
+    return *this;
+  }
+
+  /// The size of each I/O buffer. Rounded up to a multiple of 4KiB.
+  std::size_t buffer_size() const { return buffer_size_; }
+  FileIoOptions& set_buffer_size(std::size_t v) {
+    buffer_size_ = v;
+    return *this;
+  }
+
+  /// The maximum number of buffers with `io_uring` operations in flight.
+  std::size_t queue_depth() const { return queue_depth_; }
+  FileIoOptions& set_queue_depth(std::size_t v) {
+    queue_depth_ = v;
+    return *this;
+  }
+
+  /**
+   * Bypass the page cache (`O_DIRECT`) when using `io_uring`.
+   *
+   * This option is ignored by the blocking implementation, and for files
+   * whose file system does not support direct I/O.
+   */
+  bool direct_io() const { return direct_io_; }
+  FileIoOptions& set_direct_io(bool enable) {
+    direct_io_ = enable;
+    return *this;
+  }
+
+ private:
+  bool enable_io_uring_ = false;
+  std::size_t buffer_size_ = 1024 * 1024;
+  std::size_t queue_depth_ = 4;
+  bool direct_io_ = false;
+};
+
 /**
  * Describes the configuration for a `storage::Client` object.
  *
@@ -147,6 +198,27 @@ class ClientOptions {
   std::size_t upload_buffer_size() const { return upload_buffer_size_; }
   ClientOptions& SetUploadBufferSize(std::size_t size);
 
+  //@{
+  /**
+   * Adapt the chunk size of resumable uploads to the measured throughput.
+   *
+   * By default `WriteObject()` and `UploadFile()` upload the data in chunks of
+   * `upload_buffer_size()` bytes. When this option is enabled the uploads
+   * start with 256KiB chunks, and double the chunk size while the upload
+   * throughput improves. The chunk size is halved if a chunk is much slower
+   * than previous chunks, for example because it was retried. In this mode
+   * `upload_buffer_size()` is the maximum chunk size, which limits the memory
+   * used by each upload.
+   */
+  bool enable_adaptive_upload_chunk_size() const {
+    return enable_adaptive_upload_chunk_size_;
+  }
+  ClientOptions& set_enable_adaptive_upload_chunk_size(bool v) {
+    enable_adaptive_upload_chunk_size_ = v;
+    return *this;
+  }
+  //@}
+
   std::string const& user_agent_prefix() const { return user_agent_prefix_; }
   ClientOptions& add_user_agent_prefix(std::string prefix) {
     if (!user_agent_prefix_.empty()) {
@@ -225,6 +297,49 @@ class ClientOptions {
   }
   //@}
 
+  //@{
+  /**
+   * Collect latency and throughput metrics for each operation.
+   *
+   * By default no metrics are collected. Applications can set a
+   * `ClientMetrics` object and periodically call `ClientMetrics::Snapshot()`
+   * to export the metrics to their monitoring system.
+   */
+  std::shared_ptr<ClientMetrics> const& client_metrics() const {
+    return client_metrics_;
+  }
+  ClientOptions& set_client_metrics(std::shared_ptr<ClientMetrics> v) {
+    client_metrics_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /// Configure how `DownloadToFile()` and `UploadFile()` access local files.
+  FileIoOptions const& file_io_options() const { return file_io_options_; }
+  ClientOptions& set_file_io_options(FileIoOptions v) {
+    file_io_options_ = std::move(v);
+    return *this;
+  }
+  //@}
+
+  //@{
+  /**
+   * Share a single RPC between concurrent identical metadata requests.
+   *
+   * When enabled, calls to `GetObjectMetadata()` and `GetBucketMetadata()`
+   * with the same parameters and options that overlap in time are sent to the
+   * service only once, all the callers receive a copy of the result. This is
+   * useful in applications where many threads poll the same object, such as a
+   * configuration file. By default each call makes its own request.
+   */
+  bool enable_request_coalescing() const { return enable_request_coalescing_; }
+  ClientOptions& set_enable_request_coalescing(bool enable) {
+    enable_request_coalescing_ = enable;
+    return *this;
+  }
+  //@}
+
  private:
   friend std::string internal::JsonEndpoint(ClientOptions const&);
   friend std::string internal::JsonUploadEndpoint(ClientOptions const&);
@@ -243,6 +358,7 @@ class ClientOptions {
   std::size_t connection_pool_size_;
   std::size_t download_buffer_size_;
   std::size_t upload_buffer_size_;
+  bool enable_adaptive_upload_chunk_size_ = false;
   std::string user_agent_prefix_;
   std::size_t maximum_simple_upload_size_;
   bool enable_ssl_locking_callbacks_ = true;
@@ -250,6 +366,9 @@ class ClientOptions {
   std::size_t maximum_socket_recv_size_ = 0;
   std::size_t maximum_socket_send_size_ = 0;
   std::chrono::seconds download_stall_timeout_;
+  std::shared_ptr<ClientMetrics> client_metrics_;
+  FileIoOptions file_io_options_;
+  bool enable_request_coalescing_ = false;
   ChannelOptions channel_options_;
 };
 
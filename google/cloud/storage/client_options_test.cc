@@ -296,6 +296,16 @@ TEST_F(ClientOptionsTest, SetMaximumDownloadStall) {
   EXPECT_EQ(60, client_options.download_stall_timeout().count());
 }
 
+TEST_F(ClientOptionsTest, SetFileIoOptions) {
+  ClientOptions client_options(oauth2::CreateAnonymousCredentials());
+  EXPECT_FALSE(client_options.file_io_options().enable_io_uring());
+  EXPECT_FALSE(client_options.file_io_options().direct_io());
+  client_options.set_file_io_options(
+      FileIoOptions{}.set_enable_io_uring(true).set_queue_depth(8));
+  EXPECT_TRUE(client_options.file_io_options().enable_io_uring());
+  EXPECT_EQ(8, client_options.file_io_options().queue_depth());
+}
+
 }  // namespace
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
@@ -0,0 +1,177 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_side_encryption.h"
+#include "google/cloud/storage/internal/envelope_encryption.h"
+#include "google/cloud/storage/internal/hash_validator.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+
+std::size_t constexpr ClientSideEncryption::kDefaultChunkSize;
+std::size_t constexpr ClientSideEncryption::kMinChunkSize;
+std::size_t constexpr ClientSideEncryption::kMaxChunkSize;
+
+ClientSideEncryption::ClientSideEncryption(WrapKeyFunction wrap_key,
+                                           UnwrapKeyFunction unwrap_key)
+    : wrap_key_(std::move(wrap_key)),
+      unwrap_key_(std::move(unwrap_key)),
+      chunk_size_(kDefaultChunkSize),
+      thread_count_((std::max)(1U, std::thread::hardware_concurrency())) {}
+
+ClientSideEncryption& ClientSideEncryption::set_chunk_size(std::size_t v) {
+  chunk_size_ = (std::min)(kMaxChunkSize, (std::max)(kMinChunkSize, v));
+  return *this;
+}
+
+ClientSideEncryption& ClientSideEncryption::set_thread_count(std::size_t v) {
+  thread_count_ = (std::max<std::size_t>)(1, v);
+  return *this;
+}
+
+namespace internal {
+
+namespace {
+ObjectWriteStream WriteErrorStream(Status status) {
+  auto error =
+      absl::make_unique<ResumableUploadSessionError>(std::move(status));
+  ObjectWriteStream error_stream(absl::make_unique<ObjectWriteStreambuf>(
+      std::move(error), 0, absl::make_unique<NullHashValidator>()));
+  error_stream.setstate(std::ios::badbit | std::ios::eofbit);
+  error_stream.Close();
+  return error_stream;
+}
+
+ObjectReadStream ReadErrorStream(ReadObjectRangeRequest const& request,
+                                 Status status) {
+  ObjectReadStream error_stream(
+      absl::make_unique<ObjectReadStreambuf>(request, std::move(status)));
+  error_stream.setstate(std::ios::badbit | std::ios::eofbit);
+  return error_stream;
+}
+}  // namespace
+
+ObjectWriteStream WriteEncryptedObjectImpl(
+    std::shared_ptr<RawClient> const& client, ResumableUploadRequest request,
+    ClientSideEncryption const& encryption) {
+  if (request.HasOption<UseResumableUploadSession>() &&
+      !request.GetOption<UseResumableUploadSession>().value().empty()) {
+    return WriteErrorStream(Status(
+        StatusCode::kInvalidArgument,
+        "WriteEncryptedObject(): encrypted uploads cannot be resumed"));
+  }
+  if (request.HasOption<MD5HashValue>() ||
+      request.HasOption<Crc32cChecksumValue>()) {
+    return WriteErrorStream(Status(
+        StatusCode::kInvalidArgument,
+        "WriteEncryptedObject(): the service cannot verify the hashes of the"
+        " plaintext, MD5HashValue and Crc32cChecksumValue are not supported"));
+  }
+
+  auto key = CreateEnvelopeDataKey();
+  if (!key) return WriteErrorStream(std::move(key).status());
+  auto wrapped_key = encryption.wrap_key()(key->first);
+  if (!wrapped_key) return WriteErrorStream(std::move(wrapped_key).status());
+  EnvelopeEncryptionHeader header;
+  header.chunk_size = static_cast<std::uint32_t>(encryption.chunk_size());
+  header.nonce_prefix = key->second;
+  header.wrapped_key = *std::move(wrapped_key);
+  auto serialized = SerializeEnvelopeEncryptionHeader(header);
+  if (!serialized) return WriteErrorStream(std::move(serialized).status());
+
+  if (request.HasOption<UploadContentLength>()) {
+    request.set_option(UploadContentLength(EnvelopeEncryptedSize(
+        serialized->size(), encryption.chunk_size(),
+        request.GetOption<UploadContentLength>().value())));
+  }
+  auto session = client->CreateResumableSession(request);
+  if (!session) return WriteErrorStream(std::move(session).status());
+
+  ChunkCipher cipher(std::move(key->first), std::move(key->second),
+                     *serialized);
+  auto encrypting = absl::make_unique<EncryptingUploadSession>(
+      *std::move(session), *std::move(serialized), std::move(cipher),
+      encryption.chunk_size(), encryption.thread_count());
+  // The hashes computed by the service are for the ciphertext, there is
+  // nothing to compare them against.
+  return ObjectWriteStream(absl::make_unique<ObjectWriteStreambuf>(
+      std::move(encrypting), client->client_options().upload_buffer_size(),
+      absl::make_unique<NullHashValidator>()));
+}
+
+ObjectReadStream ReadEncryptedObjectImpl(
+    std::shared_ptr<RawClient> const& client, ReadObjectRangeRequest request,
+    ClientSideEncryption const& encryption) {
+  if (request.HasOption<ReadLast>()) {
+    return ReadErrorStream(
+        request, Status(StatusCode::kInvalidArgument,
+                        "ReadEncryptedObject(): ReadLast is not supported"));
+  }
+  // The tag in each chunk authenticates the data, the hashes reported by the
+  // service are for the ciphertext.
+  request.set_multiple_options(DisableCrc32cChecksum(true),
+                               DisableMD5Hash(true));
+
+  // Seeking in the stream reads the object header again, remember the last
+  // data key to avoid unwrapping it each time.
+  struct UnwrappedKey {
+    std::string wrapped;
+    std::string key;
+  };
+  auto cache = std::make_shared<UnwrappedKey>();
+  auto unwrap_key = encryption.unwrap_key();
+  UnwrapKeyFunction unwrap =
+      [cache, unwrap_key](std::string const& wrapped) -> StatusOr<std::string> {
+    if (!cache->key.empty() && cache->wrapped == wrapped) return cache->key;
+    auto key = unwrap_key(wrapped);
+    if (!key) return key;
+    cache->wrapped = wrapped;
+    cache->key = *key;
+    return key;
+  };
+  auto const thread_count = encryption.thread_count();
+  auto reopen = [client, unwrap,
+                 thread_count](ReadObjectRangeRequest const& r) {
+    return DecryptingObjectReadSource::Create(
+        [client](ReadObjectRangeRequest const& c) {
+          return client->ReadObject(c);
+        },
+        r, unwrap, thread_count);
+  };
+
+  auto source = reopen(request);
+  if (!source) return ReadErrorStream(request, std::move(source).status());
+  auto stream = ObjectReadStream(absl::make_unique<ObjectReadStreambuf>(
+      request, *std::move(source), request.StartingByte(), std::move(reopen)));
+  (void)stream.peek();
+#if !GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  // Without exceptions the streambuf cannot report errors, so we have to
+  // manually update the status bits.
+  if (!stream.status().ok()) {
+    stream.setstate(std::ios::badbit | std::ios::eofbit);
+  }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  return stream;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,178 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_SIDE_ENCRYPTION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_SIDE_ENCRYPTION_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/object_stream.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * Configures client-side (envelope) encryption for object data.
+ *
+ * With client-side encryption the object data is encrypted before it is
+ * uploaded to GCS, and decrypted after it is downloaded, the service never
+ * sees the plaintext or the keys. Each object is encrypted with a new random
+ * data key, using AES-256-GCM. The data key is stored in the object, wrapped
+ * (encrypted) by the application-provided @p wrap_key function, typically
+ * using a key management service. Reading the object calls @p unwrap_key to
+ * recover the data key.
+ *
+ * The data is split in chunks, each chunk is encrypted and authenticated
+ * independently, and the chunks are processed in parallel. This allows random
+ * access reads (using `ReadRange` or `ReadFromOffset`) without downloading the
+ * full object, and detects any modification of the object data, including
+ * truncation.
+ *
+ * @note Encrypted objects can only be read with `ReadEncryptedObject()`, the
+ *     metadata of the object (such as its size, or its hashes) describes the
+ *     encrypted data.
+ *
+ * @see `WriteEncryptedObject()` and `ReadEncryptedObject()`.
+ */
+class ClientSideEncryption {
+ public:
+  /// Wraps a data key, the result is stored with the object.
+  using WrapKeyFunction =
+      std::function<StatusOr<std::string>(std::string const& data_key)>;
+  /// Recovers a data key from the result of a `WrapKeyFunction`.
+  using UnwrapKeyFunction =
+      std::function<StatusOr<std::string>(std::string const& wrapped_key)>;
+
+  static std::size_t constexpr kDefaultChunkSize = 1024 * 1024;
+  static std::size_t constexpr kMinChunkSize = 4 * 1024;
+  static std::size_t constexpr kMaxChunkSize = 64 * 1024 * 1024;
+
+  ClientSideEncryption(WrapKeyFunction wrap_key, UnwrapKeyFunction unwrap_key);
+
+  WrapKeyFunction const& wrap_key() const { return wrap_key_; }
+  UnwrapKeyFunction const& unwrap_key() const { return unwrap_key_; }
+
+  /**
+   * The size of each encrypted chunk in new objects.
+   *
+   * Larger chunks have less overhead, smaller chunks make random access reads
+   * more efficient. The value is clamped to the
+   * [`kMinChunkSize`, `kMaxChunkSize`] range. Existing objects are always read
+   * using the chunk size recorded in the object.
+   */
+  std::size_t chunk_size() const { return chunk_size_; }
+  ClientSideEncryption& set_chunk_size(std::size_t v);
+
+  /// The number of threads used to encrypt or decrypt chunks in parallel.
+  std::size_t thread_count() const { return thread_count_; }
+  ClientSideEncryption& set_thread_count(std::size_t v);
+
+ private:
+  WrapKeyFunction wrap_key_;
+  UnwrapKeyFunction unwrap_key_;
+  std::size_t chunk_size_;
+  std::size_t thread_count_;
+};
+
+namespace internal {
+/// The implementation of `storage::WriteEncryptedObject()`.
+ObjectWriteStream WriteEncryptedObjectImpl(
+    std::shared_ptr<RawClient> const& client, ResumableUploadRequest request,
+    ClientSideEncryption const& encryption);
+
+/// The implementation of `storage::ReadEncryptedObject()`.
+ObjectReadStream ReadEncryptedObjectImpl(
+    std::shared_ptr<RawClient> const& client, ReadObjectRangeRequest request,
+    ClientSideEncryption const& encryption);
+}  // namespace internal
+
+/**
+ * Writes a new object, encrypting its contents on the client.
+ *
+ * This works like `Client::WriteObject()`, but the data is encrypted before
+ * it is uploaded, as described in `ClientSideEncryption`.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be written.
+ * @param encryption the encryption configuration.
+ * @param options a list of optional query parameters and/or request headers.
+ *   Valid types for this operation include `ContentEncoding`, `ContentType`,
+ *   `EncryptionKey`, `IfGenerationMatch`, `IfGenerationNotMatch`,
+ *   `IfMetagenerationMatch`, `IfMetagenerationNotMatch`, `KmsKeyName`,
+ *   `PredefinedAcl`, `Projection`, `UploadContentLength`, `UserProject`, and
+ *   `WithObjectMetadata`.
+ *
+ * @note Encrypted uploads cannot be resumed with `UseResumableUploadSession`,
+ *   and the `MD5HashValue` and `Crc32cChecksumValue` options are rejected, as
+ *   the service cannot verify them.
+ */
+template <typename... Options>
+ObjectWriteStream WriteEncryptedObject(Client client,
+                                       std::string const& bucket_name,
+                                       std::string const& object_name,
+                                       ClientSideEncryption const& encryption,
+                                       Options&&... options) {
+  internal::ResumableUploadRequest request(bucket_name, object_name);
+  request.set_multiple_options(std::forward<Options>(options)...);
+  return internal::WriteEncryptedObjectImpl(client.raw_client(),
+                                            std::move(request), encryption);
+}
+
+/**
+ * Reads the contents of an object encrypted with `WriteEncryptedObject()`.
+ *
+ * This works like `Client::ReadObject()`, but the data is decrypted after it
+ * is downloaded. With `ReadRange` or `ReadFromOffset`, and when seeking in the
+ * returned stream, only the chunks containing the requested data are
+ * downloaded.
+ *
+ * The stream reports an error with `StatusCode::kDataLoss` if the object data
+ * was modified or truncated.
+ *
+ * @param client the client on which to perform the operation.
+ * @param bucket_name the name of the bucket that contains the object.
+ * @param object_name the name of the object to be read.
+ * @param encryption the encryption configuration.
+ * @param options a list of optional query parameters and/or request headers.
+ *   Valid types for this operation include `EncryptionKey`, `Generation`,
+ *   `IfGenerationMatch`, `IfGenerationNotMatch`, `IfMetagenerationMatch`,
+ *   `IfMetagenerationNotMatch`, `ReadFromOffset`, `ReadRange`, and
+ *   `UserProject`.
+ */
+template <typename... Options>
+ObjectReadStream ReadEncryptedObject(Client client,
+                                     std::string const& bucket_name,
+                                     std::string const& object_name,
+                                     ClientSideEncryption const& encryption,
+                                     Options&&... options) {
+  internal::ReadObjectRangeRequest request(bucket_name, object_name);
+  request.set_multiple_options(std::forward<Options>(options)...);
+  return internal::ReadEncryptedObjectImpl(client.raw_client(),
+                                           std::move(request), encryption);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_CLIENT_SIDE_ENCRYPTION_H
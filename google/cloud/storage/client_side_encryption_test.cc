@@ -0,0 +1,330 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/client_side_encryption.h"
+#include "google/cloud/storage/internal/object_metadata_parser.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/random_names.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::ReturnRef;
+
+std::string const kBucketName = "test-bucket";
+std::string const kObjectName = "test-object";
+
+/// A reversible (and insecure) key wrapping function for the tests.
+StatusOr<std::string> WrapKey(std::string const& key) {
+  return "wrapped:" + key;
+}
+
+StatusOr<std::string> UnwrapKey(std::string const& wrapped) {
+  if (wrapped.compare(0, 8, "wrapped:") != 0) {
+    return Status(StatusCode::kInvalidArgument, "unknown key");
+  }
+  return wrapped.substr(8);
+}
+
+/// Serves a range of the object contents, in small pieces.
+class StringReadSource : public internal::ObjectReadSource {
+ public:
+  explicit StringReadSource(std::string data) : data_(std::move(data)) {}
+
+  bool IsOpen() const override { return offset_ < data_.size(); }
+  StatusOr<internal::HttpResponse> Close() override {
+    offset_ = data_.size();
+    return internal::HttpResponse{200, {}, {}};
+  }
+  StatusOr<internal::ReadSourceResult> Read(char* buf,
+                                            std::size_t n) override {
+    auto const count = (std::min)({n, data_.size() - offset_, kMaxRead});
+    std::copy(data_.data() + offset_, data_.data() + offset_ + count, buf);
+    offset_ += count;
+    internal::ReadSourceResult result{count, {100, {}, {}}};
+    if (offset_ == data_.size()) result.response.status_code = 200;
+    result.response.headers.emplace("x-goog-generation", "42");
+    return result;
+  }
+
+ private:
+  static std::size_t constexpr kMaxRead = 64 * 1024;
+  std::string data_;
+  std::size_t offset_ = 0;
+};
+
+class ClientSideEncryptionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock_ = std::make_shared<testing::MockClient>();
+    client_options_.SetUploadBufferSize(256 * 1024);
+    EXPECT_CALL(*mock_, client_options())
+        .WillRepeatedly(ReturnRef(client_options_));
+    client_.reset(new Client{std::shared_ptr<internal::RawClient>(mock_),
+                             Client::NoDecorations{}});
+  }
+
+  /// Store the uploaded data in `object_`.
+  void ExpectUpload() {
+    EXPECT_CALL(*mock_, CreateResumableSession(_))
+        .WillOnce(Invoke([this](internal::ResumableUploadRequest const& r) {
+          requests_.push_back(r);
+          object_.clear();
+          auto session =
+              absl::make_unique<testing::MockResumableUploadSession>();
+          EXPECT_CALL(*session, session_id())
+              .WillRepeatedly(ReturnRef(session_id_));
+          EXPECT_CALL(*session, done()).WillRepeatedly(Invoke([] {
+            return false;
+          }));
+          EXPECT_CALL(*session, UploadChunk(_))
+              .WillRepeatedly(
+                  Invoke([this](internal::ConstBufferSequence const& b) {
+                    return Append(b, false);
+                  }));
+          EXPECT_CALL(*session, UploadFinalChunk(_, _))
+              .WillOnce(Invoke([this](internal::ConstBufferSequence const& b,
+                                      std::uint64_t upload_size) {
+                EXPECT_EQ(object_.size() + internal::TotalBytes(b),
+                          upload_size);
+                return Append(b, true);
+              }));
+          return StatusOr<std::unique_ptr<internal::ResumableUploadSession>>(
+              std::move(session));
+        }));
+  }
+
+  StatusOr<internal::ResumableUploadResponse> Append(
+      internal::ConstBufferSequence const& buffers, bool final) {
+    for (auto const& b : buffers) object_.append(b.data(), b.size());
+    if (!final) {
+      return internal::ResumableUploadResponse{
+          session_id_, object_.size() - 1, {},
+          internal::ResumableUploadResponse::kInProgress, {}};
+    }
+    auto metadata = internal::ObjectMetadataParser::FromJson(nlohmann::json{
+        {"bucket", kBucketName},
+        {"name", kObjectName},
+        {"size", std::to_string(object_.size())}});
+    EXPECT_STATUS_OK(metadata);
+    return internal::ResumableUploadResponse{
+        session_id_, object_.size() - 1, *std::move(metadata),
+        internal::ResumableUploadResponse::kDone, {}};
+  }
+
+  /// Serve the contents of `object_`.
+  void ExpectDownloads() {
+    EXPECT_CALL(*mock_, ReadObject(_))
+        .WillRepeatedly(Invoke([this](internal::ReadObjectRangeRequest const&
+                                          r) {
+          auto const begin = static_cast<std::size_t>(r.StartingByte());
+          if (begin >= object_.size()) {
+            return StatusOr<std::unique_ptr<internal::ObjectReadSource>>(
+                Status(StatusCode::kOutOfRange, "past the end"));
+          }
+          auto end = object_.size();
+          if (r.HasOption<ReadRange>()) {
+            end = (std::min)(end, static_cast<std::size_t>(
+                                      r.GetOption<ReadRange>().value().end));
+          }
+          return StatusOr<std::unique_ptr<internal::ObjectReadSource>>(
+              absl::make_unique<StringReadSource>(
+                  object_.substr(begin, end - begin)));
+        }));
+  }
+
+  void WriteTestObject(std::string const& data,
+                       ClientSideEncryption const& encryption) {
+    ExpectUpload();
+    auto writer = WriteEncryptedObject(*client_, kBucketName, kObjectName,
+                                       encryption, ContentType("text/plain"));
+    writer.write(data.data(), static_cast<std::streamsize>(data.size()));
+    writer.Close();
+    ASSERT_STATUS_OK(writer.metadata());
+  }
+
+  std::shared_ptr<testing::MockClient> mock_;
+  std::unique_ptr<Client> client_;
+  ClientOptions client_options_ =
+      ClientOptions(oauth2::CreateAnonymousCredentials());
+  std::string const session_id_ = "test-session-id";
+  std::vector<internal::ResumableUploadRequest> requests_;
+  std::string object_;
+};
+
+std::string MakeData(std::size_t size) {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  return testing::MakeRandomData(generator, size);
+}
+
+std::string ReadAll(ObjectReadStream& reader) {
+  std::string result;
+  std::vector<char> buffer(10000);
+  while (reader.read(buffer.data(), buffer.size()).gcount() != 0) {
+    result.append(buffer.data(), static_cast<std::size_t>(reader.gcount()));
+  }
+  return result;
+}
+
+TEST(ClientSideEncryption, Configuration) {
+  ClientSideEncryption encryption(WrapKey, UnwrapKey);
+  EXPECT_EQ(ClientSideEncryption::kDefaultChunkSize, encryption.chunk_size());
+  EXPECT_LE(1, encryption.thread_count());
+
+  encryption.set_chunk_size(1).set_thread_count(0);
+  EXPECT_EQ(ClientSideEncryption::kMinChunkSize, encryption.chunk_size());
+  EXPECT_EQ(1, encryption.thread_count());
+  encryption.set_chunk_size(1024 * 1024 * 1024);
+  EXPECT_EQ(ClientSideEncryption::kMaxChunkSize, encryption.chunk_size());
+  encryption.set_chunk_size(64 * 1024).set_thread_count(8);
+  EXPECT_EQ(64 * 1024, encryption.chunk_size());
+  EXPECT_EQ(8, encryption.thread_count());
+}
+
+TEST_F(ClientSideEncryptionTest, RoundTrip) {
+  auto encryption = ClientSideEncryption(WrapKey, UnwrapKey)
+                        .set_chunk_size(16 * 1024)
+                        .set_thread_count(4);
+  auto const data = MakeData(1024 * 1024 + 123);
+  WriteTestObject(data, encryption);
+  ASSERT_EQ(1, requests_.size());
+  EXPECT_EQ("text/plain", requests_[0].GetOption<ContentType>().value());
+  EXPECT_EQ(std::string::npos, object_.find(data.substr(0, 64)));
+
+  ExpectDownloads();
+  auto reader =
+      ReadEncryptedObject(*client_, kBucketName, kObjectName, encryption);
+  auto actual = ReadAll(reader);
+  ASSERT_STATUS_OK(reader.status());
+  EXPECT_EQ(data, actual);
+}
+
+TEST_F(ClientSideEncryptionTest, UploadContentLength) {
+  ClientSideEncryption encryption(WrapKey, UnwrapKey);
+  auto const data = MakeData(3 * 1024 * 1024 + 5);
+  ExpectUpload();
+  auto writer = WriteEncryptedObject(*client_, kBucketName, kObjectName,
+                                     encryption,
+                                     UploadContentLength(data.size()));
+  writer.write(data.data(), static_cast<std::streamsize>(data.size()));
+  writer.Close();
+  ASSERT_STATUS_OK(writer.metadata());
+  ASSERT_EQ(1, requests_.size());
+  EXPECT_EQ(object_.size(),
+            requests_[0].GetOption<UploadContentLength>().value());
+}
+
+TEST_F(ClientSideEncryptionTest, RandomAccess) {
+  auto encryption = ClientSideEncryption(WrapKey, UnwrapKey)
+                        .set_chunk_size(4 * 1024)
+                        .set_thread_count(2);
+  auto const data = MakeData(100 * 1024 + 7);
+  WriteTestObject(data, encryption);
+  ExpectDownloads();
+
+  auto reader = ReadEncryptedObject(*client_, kBucketName, kObjectName,
+                                    encryption, ReadRange(5000, 9000));
+  auto actual = ReadAll(reader);
+  ASSERT_STATUS_OK(reader.status());
+  EXPECT_EQ(data.substr(5000, 4000), actual);
+
+  reader = ReadEncryptedObject(*client_, kBucketName, kObjectName, encryption,
+                               ReadFromOffset(90 * 1024));
+  actual = ReadAll(reader);
+  ASSERT_STATUS_OK(reader.status());
+  EXPECT_EQ(data.substr(90 * 1024), actual);
+
+  // Seeking backwards starts a new download, from the chunk containing the
+  // new position.
+  reader = ReadEncryptedObject(*client_, kBucketName, kObjectName, encryption);
+  std::vector<char> buffer(1000);
+  for (auto offset : {50 * 1024 + 3, 10, 99 * 1024}) {
+    SCOPED_TRACE("Testing with offset=" + std::to_string(offset));
+    reader.seekg(offset);
+    reader.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    ASSERT_STATUS_OK(reader.status());
+    EXPECT_EQ(data.substr(offset, buffer.size()),
+              std::string(buffer.data(), buffer.size()));
+  }
+}
+
+TEST_F(ClientSideEncryptionTest, DetectsCorruption) {
+  auto encryption = ClientSideEncryption(WrapKey, UnwrapKey)
+                        .set_chunk_size(4 * 1024)
+                        .set_thread_count(2);
+  auto const data = MakeData(64 * 1024);
+  WriteTestObject(data, encryption);
+  object_[object_.size() / 2] ^= 0x10;
+  ExpectDownloads();
+
+  auto reader =
+      ReadEncryptedObject(*client_, kBucketName, kObjectName, encryption);
+  auto actual = ReadAll(reader);
+  EXPECT_EQ(StatusCode::kDataLoss, reader.status().code());
+  EXPECT_GT(data.size(), actual.size());
+}
+
+TEST_F(ClientSideEncryptionTest, WrapKeyError) {
+  ClientSideEncryption encryption(
+      [](std::string const&) -> StatusOr<std::string> {
+        return PermanentError();
+      },
+      UnwrapKey);
+  auto writer =
+      WriteEncryptedObject(*client_, kBucketName, kObjectName, encryption);
+  EXPECT_TRUE(writer.bad());
+  EXPECT_EQ(PermanentError().code(), writer.metadata().status().code());
+}
+
+TEST_F(ClientSideEncryptionTest, RejectedOptions) {
+  ClientSideEncryption encryption(WrapKey, UnwrapKey);
+  auto writer = WriteEncryptedObject(*client_, kBucketName, kObjectName,
+                                     encryption, MD5HashValue("invalid"));
+  EXPECT_EQ(StatusCode::kInvalidArgument, writer.metadata().status().code());
+
+  writer = WriteEncryptedObject(*client_, kBucketName, kObjectName, encryption,
+                                RestoreResumableUploadSession("test-session"));
+  EXPECT_EQ(StatusCode::kInvalidArgument, writer.metadata().status().code());
+
+  auto reader = ReadEncryptedObject(*client_, kBucketName, kObjectName,
+                                    encryption, ReadLast(10));
+  EXPECT_EQ(StatusCode::kInvalidArgument, reader.status().code());
+}
+
+TEST_F(ClientSideEncryptionTest, ReadNotEncrypted) {
+  ClientSideEncryption encryption(WrapKey, UnwrapKey);
+  object_ = MakeData(1000);
+  ExpectDownloads();
+  auto reader =
+      ReadEncryptedObject(*client_, kBucketName, kObjectName, encryption);
+  EXPECT_TRUE(reader.bad());
+  EXPECT_EQ(StatusCode::kInvalidArgument, reader.status().code());
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -24,7 +24,6 @@
 #include "google/cloud/testing_util/status_matchers.h"
 #include "absl/memory/memory.h"
 #include <gmock/gmock.h>
-#include <fstream>
 
 namespace google {
 namespace cloud {
@@ -33,7 +32,7 @@ namespace testing {
 class ClientTester {
  public:
   static StatusOr<ObjectMetadata> UploadStreamResumable(
-      Client& client, std::istream& source,
+      Client& client, internal::FileReader& source,
       internal::ResumableUploadRequest const& request) {
     return client.UploadStreamResumable(source, request);
   }
@@ -170,30 +169,27 @@ TEST_F(WriteObjectTest, WriteObjectPermanentSessionFailurePropagates) {
   EXPECT_THAT(stream.metadata(), StatusIs(PermanentError().code()));
 }
 
-// A std::filebuf which allows to learn about seekpos calls.
-class MockFilebuf : public std::filebuf {
+// A internal::FileReader which allows to learn about Seek() calls.
+class MockFileReader : public internal::FileReader {
  public:
-  MOCK_METHOD1(SeekoffEvent, void(std::streamoff));
+  explicit MockFileReader(std::string const& file_name)
+      : reader_(internal::CreateBlockingFileIoBackend()
+                    ->OpenForRead(file_name, 0)
+                    .value()) {}
 
- protected:
-  std::streampos seekoff(std::streamoff off, std::ios_base::seekdir way,
-                         std::ios_base::openmode which) override {
-    SeekoffEvent(off);
-    return std::filebuf::seekoff(off, way, which);
-  }
-};
+  MOCK_METHOD1(SeekEvent, void(std::uint64_t));
 
-class MockFilebufStream : public std::ifstream {
- public:
-  explicit MockFilebufStream(std::string const& s) {
-    buf_.open(s.c_str(), std::ios_base::in);
-    init(&buf_);
-    clear();
-    std::cout << "OPEN? " << buf_.is_open() << std::endl;
+  StatusOr<std::size_t> Read(char* data, std::size_t size) override {
+    return reader_->Read(data, size);
+  }
+  Status Seek(std::uint64_t offset) override {
+    SeekEvent(offset);
+    return reader_->Seek(offset);
   }
+  std::uint64_t offset() const override { return reader_->offset(); }
 
  private:
-  MockFilebuf buf_;
+  std::unique_ptr<internal::FileReader> reader_;
 };
 
 TEST_F(WriteObjectTest, UploadStreamResumable) {
@@ -235,17 +231,14 @@ TEST_F(WriteObjectTest, UploadStreamResumable) {
             std::unique_ptr<internal::ResumableUploadSession>(std::move(mock)));
       });
 
-  MockFilebuf filebuf;
-  // Don't expect any seekoff events
-  EXPECT_CALL(filebuf, SeekoffEvent(_)).WillOnce([quantum](std::streamoff off) {
+  MockFileReader reader(temp_file.name());
+  // Expect a single seek, skipping the data already uploaded.
+  EXPECT_CALL(reader, SeekEvent(_)).WillOnce([quantum](std::uint64_t off) {
     EXPECT_EQ(quantum, off);
   });
-  ASSERT_NE(nullptr, filebuf.open(temp_file.name().c_str(), std::ios_base::in));
-  std::istream stream(&filebuf);
 
-  ASSERT_TRUE(stream);
   auto res = testing::ClientTester::UploadStreamResumable(
-      *client_, stream,
+      *client_, reader,
       internal::ResumableUploadRequest("test-bucket-name", "test-object-name"));
   ASSERT_STATUS_OK(res);
   EXPECT_EQ(expected, *res);
@@ -294,17 +287,14 @@ TEST_F(WriteObjectTest, UploadStreamResumableSimulateBug) {
             std::unique_ptr<internal::ResumableUploadSession>(std::move(mock)));
       });
 
-  MockFilebuf filebuf;
-  // Don't expect any seekoff events
-  EXPECT_CALL(filebuf, SeekoffEvent(_)).WillOnce([](std::streamoff off) {
+  MockFileReader reader(temp_file.name());
+  // Expect a single seek, nothing has been uploaded yet.
+  EXPECT_CALL(reader, SeekEvent(_)).WillOnce([](std::uint64_t off) {
     EXPECT_EQ(0, off);
   });
-  ASSERT_NE(nullptr, filebuf.open(temp_file.name().c_str(), std::ios_base::in));
-  std::istream stream(&filebuf);
 
-  ASSERT_TRUE(stream);
   auto res = testing::ClientTester::UploadStreamResumable(
-      *client_, stream,
+      *client_, reader,
       internal::ResumableUploadRequest("test-bucket-name", "test-object-name"));
   EXPECT_THAT(
       res,
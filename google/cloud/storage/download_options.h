@@ -71,6 +71,29 @@ struct ReadLast : public internal::ComplexOption<ReadLast, std::int64_t> {
   static char const* name() { return "read-last"; }
 };
 
+/**
+ * Make `Client::DownloadToFile()` resumable across application restarts.
+ *
+ * With this option `DownloadToFile()` periodically records its progress in a
+ * small journal file, next to the destination file. If the download is
+ * interrupted, for example because the application crashes or is restarted,
+ * calling `DownloadToFile()` again with the same object and destination file
+ * continues the download from the last recorded position, as long as the
+ * object has not changed. The full object checksum is validated even if the
+ * download is resumed. The journal is removed once the download completes.
+ *
+ * This option cannot be combined with `ReadFromOffset`, `ReadRange` or
+ * `ReadLast`, and it is ignored by other operations.
+ */
+struct ResumableDownload
+    : public internal::ComplexOption<ResumableDownload, bool> {
+  using ComplexOption::ComplexOption;
+  // GCC <= 7.0 does not use the inherited default constructor, redeclare it
+  // explicitly
+  ResumableDownload() = default;
+  static char const* name() { return "resumable-download"; }
+};
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage
 }  // namespace cloud
@@ -12,8 +12,11 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import base64
+import hashlib
 import json
 import logging
+from xml.etree import ElementTree
 
 import database
 import flask
@@ -88,6 +91,26 @@ def root_put_object_with_bucket(bucket_name, object_name):
     return xml_put_object(bucket_name, object_name)
 
 
+@root.route("/<path:object_name>", subdomain="<bucket_name>", methods=["POST"])
+def root_post_object(bucket_name, object_name):
+    return xml_post_object(bucket_name, object_name)
+
+
+@root.route("/<bucket_name>/<path:object_name>", subdomain="", methods=["POST"])
+def root_post_object_with_bucket(bucket_name, object_name):
+    return xml_post_object(bucket_name, object_name)
+
+
+@root.route("/<path:object_name>", subdomain="<bucket_name>", methods=["DELETE"])
+def root_delete_object(bucket_name, object_name):
+    return xml_delete_object(bucket_name, object_name)
+
+
+@root.route("/<bucket_name>/<path:object_name>", subdomain="", methods=["DELETE"])
+def root_delete_object_with_bucket(bucket_name, object_name):
+    return xml_delete_object(bucket_name, object_name)
+
+
 # === WSGI APP TO HANDLE JSON API === #
 GCS_HANDLER_PATH = "/storage/v1"
 gcs = flask.Flask(__name__)
@@ -770,6 +793,8 @@ def delete_resumable_upload(bucket_name):
 
 
 def xml_put_object(bucket_name, object_name):
+    if "uploadId" in flask.request.args:
+        return xml_upload_part(bucket_name, object_name)
     db.insert_test_bucket(None)
     bucket = db.get_bucket_without_generation(bucket_name, None).metadata
     blob, fake_request = gcs_type.object.Object.init_xml(
@@ -787,6 +812,98 @@ def xml_get_object(bucket_name, object_name):
     return blob.rest_media(fake_request)
 
 
+# === XML MULTIPART UPLOAD === #
+
+
+def xml_multipart_upload(bucket_name, object_name):
+    upload = db.get_upload(flask.request.args.get("uploadId"), None)
+    # Resumable uploads share the same table, but have no `parts`.
+    if (
+        getattr(upload, "parts", None) is None
+        or upload.bucket.name != bucket_name
+        or upload.metadata["name"] != object_name
+    ):
+        utils.error.notfound("Multipart upload %s" % upload.upload_id, None)
+    return upload
+
+
+def xml_post_object(bucket_name, object_name):
+    if "uploads" in flask.request.args:
+        db.insert_test_bucket(None)
+        bucket = db.get_bucket_without_generation(bucket_name, None).metadata
+        upload = gcs_type.holder.DataHolder.init_multipart_upload_xml(
+            flask.request, bucket, object_name
+        )
+        db.insert_upload(upload)
+        return flask.Response(
+            "<?xml version='1.0' encoding='UTF-8'?>"
+            "<InitiateMultipartUploadResult>"
+            "<Bucket>%s</Bucket><Key>%s</Key><UploadId>%s</UploadId>"
+            "</InitiateMultipartUploadResult>"
+            % (bucket_name, object_name, upload.upload_id),
+            content_type="application/xml",
+        )
+    if "uploadId" in flask.request.args:
+        return xml_complete_multipart_upload(bucket_name, object_name)
+    utils.error.missing("uploads or uploadId", None)
+
+
+def xml_upload_part(bucket_name, object_name):
+    upload = xml_multipart_upload(bucket_name, object_name)
+    part_number = int(flask.request.args.get("partNumber", "0"))
+    if part_number < 1 or part_number > 10000:
+        utils.error.invalid("partNumber %d" % part_number, None)
+    media = utils.common.extract_media(flask.request)
+    digest = hashlib.md5(media).digest()
+    expected = flask.request.headers.get("content-md5")
+    actual = base64.b64encode(digest).decode("utf-8")
+    if expected is not None and expected != actual:
+        utils.error.mismatch("Content-MD5", expected, actual, None)
+    etag = '"%s"' % digest.hex()
+    upload.parts[part_number] = (etag, media)
+    response = flask.make_response("")
+    response.headers["ETag"] = etag
+    return response
+
+
+def xml_complete_multipart_upload(bucket_name, object_name):
+    upload = xml_multipart_upload(bucket_name, object_name)
+    media = b""
+    etags = b""
+    last = 0
+    for part in ElementTree.fromstring(flask.request.data).iter("Part"):
+        part_number = int(part.findtext("PartNumber"))
+        etag = part.findtext("ETag")
+        if part_number <= last:
+            utils.error.invalid("part order", None)
+        last = part_number
+        if upload.parts.get(part_number, (None, b""))[0] != etag:
+            utils.error.invalid("part %d with ETag %s" % (part_number, etag), None)
+        media += upload.parts[part_number][1]
+        etags += etag.encode("utf-8")
+    blob, _ = gcs_type.object.Object.init_dict(
+        upload.request, upload.metadata, media, upload.bucket, False
+    )
+    db.insert_object(upload.request, bucket_name, blob, None)
+    db.delete_upload(upload.upload_id, None)
+    return flask.Response(
+        "<?xml version='1.0' encoding='UTF-8'?>"
+        "<CompleteMultipartUploadResult>"
+        "<Bucket>%s</Bucket><Key>%s</Key><ETag>&quot;%s-%d&quot;</ETag>"
+        "</CompleteMultipartUploadResult>"
+        % (bucket_name, object_name, hashlib.md5(etags).hexdigest(), last),
+        content_type="application/xml",
+    )
+
+
+def xml_delete_object(bucket_name, object_name):
+    if "uploadId" not in flask.request.args:
+        utils.error.missing("uploadId", None)
+    upload = xml_multipart_upload(bucket_name, object_name)
+    db.delete_upload(upload.upload_id, None)
+    return flask.make_response("", 204)
+
+
 # === SERVER === #
 
 # Define the WSGI application to handle HMAC key requests
@@ -17,6 +17,7 @@
 import hashlib
 import json
 import types
+import uuid
 
 import flask
 import utils
@@ -111,6 +112,30 @@ class DataHolder(types.SimpleNamespace):
         response.status_code = 308
         return response
 
+    # === XML MULTIPART UPLOAD === #
+
+    @classmethod
+    def init_multipart_upload_xml(cls, request, bucket, name):
+        metadata = {
+            "bucket": bucket.name,
+            "name": name,
+            "metadata": {"x_emulator_upload": "xml-multipart"},
+        }
+        if "content-type" in request.headers:
+            metadata["contentType"] = request.headers["content-type"]
+        # Unlike resumable uploads, each initiate request starts a new upload,
+        # even for the same object.
+        upload_id = hashlib.sha256(
+            ("%s/o/%s/%s" % (bucket.name, name, uuid.uuid4().hex)).encode("utf-8")
+        ).hexdigest()
+        return cls(
+            request=utils.common.FakeRequest.init_xml(request),
+            metadata=metadata,
+            bucket=bucket,
+            upload_id=upload_id,
+            parts={},
+        )
+
     # === REWRITE === #
 
     @classmethod
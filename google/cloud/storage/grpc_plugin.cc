@@ -29,6 +29,13 @@ bool UseGrpcForMetadata() {
           .value_or("");
   return v.find("metadata") != std::string::npos;
 }
+
+bool UseAdaptiveRouting() {
+  auto v =
+      google::cloud::internal::GetEnv("GOOGLE_CLOUD_CPP_STORAGE_GRPC_CONFIG")
+          .value_or("");
+  return v.find("adaptive") != std::string::npos;
+}
 }  // namespace
 
 StatusOr<google::cloud::storage::Client> DefaultGrpcClient() {
@@ -44,10 +51,27 @@ google::cloud::storage::Client DefaultGrpcClient(
     return storage::Client(
         std::make_shared<storage::internal::GrpcClient>(std::move(options)));
   }
+  if (UseAdaptiveRouting()) {
+    return DefaultGrpcClient(std::move(options),
+                             DefaultTransportRoutingPolicy());
+  }
   return storage::Client(
       std::make_shared<storage::internal::HybridClient>(std::move(options)));
 }
 
+google::cloud::storage::Client DefaultGrpcClient(
+    google::cloud::storage::ClientOptions options,
+    std::shared_ptr<TransportRoutingPolicy> routing_policy) {
+  return storage::Client(std::make_shared<storage::internal::HybridClient>(
+      std::move(options), std::move(routing_policy)));
+}
+
+std::shared_ptr<TransportRoutingPolicy> DefaultTransportRoutingPolicy() {
+  static auto* const kPolicy = new std::shared_ptr<TransportRoutingPolicy>(
+      std::make_shared<TransportRoutingPolicy>());
+  return *kPolicy;
+}
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage_experimental
 }  // namespace cloud
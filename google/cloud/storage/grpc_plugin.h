@@ -16,8 +16,10 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_GRPC_PLUGIN_H
 
 #include "google/cloud/storage/client.h"
+#include "google/cloud/storage/transport_routing_policy.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/status_or.h"
+#include <memory>
 
 namespace google {
 namespace cloud {
@@ -55,6 +57,38 @@ StatusOr<google::cloud::storage::Client> DefaultGrpcClient();
 google::cloud::storage::Client DefaultGrpcClient(
     google::cloud::storage::ClientOptions options);
 
+/**
+ * Create a `google::cloud::storage::Client` object with adaptive routing.
+ *
+ * The client uses JSON for metadata operations, and routes each media
+ * operation to the transport selected by @p routing_policy. Applications can
+ * call `routing_policy->Snapshot()` to export the routing statistics.
+ *
+ * @note the Credentials parameter in the configuration is ignored. The gRPC
+ *     client only supports Google Default Credentials.
+ *
+ * @param options the configuration parameters for the Client.
+ * @param routing_policy the policy used to route media operations.
+ *
+ * @warning this is an experimental feature, and subject to change without
+ *     notice.
+ */
+google::cloud::storage::Client DefaultGrpcClient(
+    google::cloud::storage::ClientOptions options,
+    std::shared_ptr<TransportRoutingPolicy> routing_policy);
+
+/**
+ * The routing policy shared by clients with adaptive routing enabled in the
+ * `GOOGLE_CLOUD_CPP_STORAGE_GRPC_CONFIG` environment variable.
+ *
+ * Applications can call `Snapshot()` on this policy to export the routing
+ * statistics of such clients.
+ *
+ * @warning this is an experimental feature, and subject to change without
+ *     notice.
+ */
+std::shared_ptr<TransportRoutingPolicy> DefaultTransportRoutingPolicy();
+
 }  // namespace STORAGE_CLIENT_NS
 }  // namespace storage_experimental
 }  // namespace cloud
@@ -49,8 +49,9 @@ std::shared_ptr<CurlHandleFactory> CreateHandleFactory(
 }
 
 std::string UrlEscapeString(std::string const& value) {
-  CurlHandle handle;
-  return std::string(handle.MakeEscapedString(value).get());
+  std::string result;
+  AppendUrlEscaped(result, value);
+  return result;
 }
 
 template <typename ReturnType>
@@ -119,6 +120,18 @@ Status CurlClient::SetupBuilderCommon(CurlRequestBuilder& builder,
   return Status();
 }
 
+Status CurlClient::SetupBuilderCommon(CurlRequestBuilder& builder,
+                                      CurlRequestTemplate& request_template,
+                                      char const* method) {
+  auto auth_header = options_.credentials()->AuthorizationHeader();
+  if (!auth_header.ok()) {
+    return std::move(auth_header).status();
+  }
+  builder.SetMethod(method).ApplyRequestTemplate(request_template,
+                                                 *auth_header);
+  return Status();
+}
+
 template <typename Request>
 void SetupBuilderUserIp(CurlRequestBuilder& builder, Request const& request) {
   if (request.template HasOption<UserIp>()) {
@@ -135,11 +148,10 @@ void SetupBuilderUserIp(CurlRequestBuilder& builder, Request const& request) {
 template <typename Request>
 Status CurlClient::SetupBuilder(CurlRequestBuilder& builder,
                                 Request const& request, char const* method) {
-  auto status = SetupBuilderCommon(builder, method);
+  auto status = SetupBuilderCommon(builder, json_template_, method);
   if (!status.ok()) {
     return status;
   }
-  builder.AddHeader("Host: " + storage_host_);
   request.AddOptionsToHttpRequest(builder);
   SetupBuilderUserIp(builder, request);
   return Status();
@@ -251,6 +263,10 @@ CurlClient::CurlClient(ClientOptions options)
       xml_host_(ExtractUrlHostpart(xml_endpoint_)),
       iam_endpoint_(IamEndpoint(options_)),
       xml_enabled_(XmlEnabled()),
+      json_template_(options_, storage_endpoint_, "/b/", "/o/",
+                     {x_goog_api_client_header_, "Host: " + storage_host_}),
+      xml_template_(options_, xml_endpoint_, "/", "/",
+                    {x_goog_api_client_header_, "Host: " + xml_host_}),
       generator_(google::cloud::internal::MakeDefaultPRNG()),
       storage_factory_(CreateHandleFactory(options_)),
       upload_factory_(CreateHandleFactory(options_)),
@@ -554,9 +570,9 @@ StatusOr<ObjectMetadata> CurlClient::CopyObject(
 
 StatusOr<ObjectMetadata> CurlClient::GetObjectMetadata(
     GetObjectMetadataRequest const& request) {
-  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
-                                 "/o/" + UrlEscapeString(request.object_name()),
-                             storage_factory_);
+  CurlRequestBuilder builder(
+      json_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      storage_factory_);
   auto status = SetupBuilder(builder, request, "GET");
   if (!status.ok()) {
     return status;
@@ -573,9 +589,9 @@ StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObject(
     return ReadObjectXml(request);
   }
   // Assume the bucket name is validated by the caller.
-  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
-                                 "/o/" + UrlEscapeString(request.object_name()),
-                             storage_factory_);
+  CurlRequestBuilder builder(
+      json_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      storage_factory_);
   auto status = SetupBuilder(builder, request, "GET");
   if (!status.ok()) {
     return status;
@@ -610,9 +626,9 @@ StatusOr<ListObjectsResponse> CurlClient::ListObjects(
 StatusOr<EmptyResponse> CurlClient::DeleteObject(
     DeleteObjectRequest const& request) {
   // Assume the bucket name is validated by the caller.
-  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
-                                 "/o/" + UrlEscapeString(request.object_name()),
-                             storage_factory_);
+  CurlRequestBuilder builder(
+      json_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      storage_factory_);
   auto status = SetupBuilder(builder, request, "DELETE");
   if (!status.ok()) {
     return status;
@@ -622,9 +638,9 @@ StatusOr<EmptyResponse> CurlClient::DeleteObject(
 
 StatusOr<ObjectMetadata> CurlClient::UpdateObject(
     UpdateObjectRequest const& request) {
-  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
-                                 "/o/" + UrlEscapeString(request.object_name()),
-                             storage_factory_);
+  CurlRequestBuilder builder(
+      json_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      storage_factory_);
   auto status = SetupBuilder(builder, request, "PUT");
   if (!status.ok()) {
     return status;
@@ -636,9 +652,9 @@ StatusOr<ObjectMetadata> CurlClient::UpdateObject(
 
 StatusOr<ObjectMetadata> CurlClient::PatchObject(
     PatchObjectRequest const& request) {
-  CurlRequestBuilder builder(storage_endpoint_ + "/b/" + request.bucket_name() +
-                                 "/o/" + UrlEscapeString(request.object_name()),
-                             storage_factory_);
+  CurlRequestBuilder builder(
+      json_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      storage_factory_);
   auto status = SetupBuilder(builder, request, "PATCH");
   if (!status.ok()) {
     return status;
@@ -731,6 +747,120 @@ StatusOr<EmptyResponse> CurlClient::DeleteResumableUpload(
   return EmptyResponse{};
 }
 
+StatusOr<CreateMultipartUploadResponse> CurlClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_upload_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "POST");
+  if (!status.ok()) {
+    return status;
+  }
+  builder.AddQueryParameter("uploads", "");
+
+  //
+  // Apply the options from CreateMultipartUploadRequest that are set,
+  // translating to the XML format for them.
+  //
+  builder.AddOption(request.GetOption<ContentEncoding>());
+  if (!request.HasOption<ContentType>()) {
+    builder.AddHeader("content-type: application/octet-stream");
+  } else {
+    builder.AddOption(request.GetOption<ContentType>());
+  }
+  builder.AddOption(request.GetOption<EncryptionKey>());
+  if (request.HasOption<IfGenerationMatch>()) {
+    builder.AddHeader(
+        "x-goog-if-generation-match: " +
+        std::to_string(request.GetOption<IfGenerationMatch>().value()));
+  }
+  if (request.HasOption<IfMetagenerationMatch>()) {
+    builder.AddHeader(
+        "x-goog-if-meta-generation-match: " +
+        std::to_string(request.GetOption<IfMetagenerationMatch>().value()));
+  }
+  if (request.HasOption<KmsKeyName>()) {
+    builder.AddHeader("x-goog-encryption-kms-key-name: " +
+                      request.GetOption<KmsKeyName>().value());
+  }
+  if (request.HasOption<PredefinedAcl>()) {
+    builder.AddHeader("x-goog-acl: " +
+                      request.GetOption<PredefinedAcl>().HeaderName());
+  }
+  builder.AddOption(request.GetOption<UserProject>());
+  builder.AddOption(request.GetOption<CustomHeader>());
+
+  return ParseFromHttpResponse<CreateMultipartUploadResponse>(
+      builder.BuildRequest().MakeRequest(std::string{}));
+}
+
+StatusOr<UploadPartResponse> CurlClient::UploadPart(
+    UploadPartRequest const& request) {
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_upload_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "PUT");
+  if (!status.ok()) {
+    return status;
+  }
+  builder.AddQueryParameter("partNumber",
+                            std::to_string(request.part_number()));
+  builder.AddQueryParameter("uploadId", request.upload_id());
+  builder.AddOption(request.GetOption<EncryptionKey>());
+  if (!request.GetOption<DisableMD5Hash>().value_or(false)) {
+    builder.AddHeader("Content-MD5: " + ComputeMD5Hash(request.payload()));
+  }
+  builder.AddOption(request.GetOption<UserProject>());
+  builder.AddOption(request.GetOption<CustomHeader>());
+  builder.AddHeader("Content-Length: " +
+                    std::to_string(request.payload().size()));
+
+  auto response = builder.BuildRequest().MakeRequest(request.payload());
+  if (!response.ok()) {
+    return std::move(response).status();
+  }
+  if (response->status_code >= HttpStatusCode::kMinNotSuccess) {
+    return AsStatus(*response);
+  }
+  return UploadPartResponse::FromHttpResponse(*response);
+}
+
+StatusOr<CompleteMultipartUploadResponse> CurlClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_upload_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "POST");
+  if (!status.ok()) {
+    return status;
+  }
+  builder.AddQueryParameter("uploadId", request.upload_id());
+  builder.AddOption(request.GetOption<EncryptionKey>());
+  builder.AddOption(request.GetOption<UserProject>());
+  builder.AddOption(request.GetOption<CustomHeader>());
+  builder.AddHeader("content-type: application/xml");
+
+  auto const payload = request.xml_payload();
+  builder.AddHeader("Content-Length: " + std::to_string(payload.size()));
+  return ParseFromHttpResponse<CompleteMultipartUploadResponse>(
+      builder.BuildRequest().MakeRequest(payload));
+}
+
+StatusOr<EmptyResponse> CurlClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_upload_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "DELETE");
+  if (!status.ok()) {
+    return status;
+  }
+  builder.AddQueryParameter("uploadId", request.upload_id());
+  builder.AddOption(request.GetOption<UserProject>());
+  builder.AddOption(request.GetOption<CustomHeader>());
+  return ReturnEmptyResponse(builder.BuildRequest().MakeRequest(std::string{}));
+}
+
 StatusOr<ListBucketAclResponse> CurlClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   CurlRequestBuilder builder(
@@ -1177,14 +1307,13 @@ StatusOr<EmptyResponse> CurlClient::DeleteNotification(
 
 StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
     InsertObjectMediaRequest const& request) {
-  CurlRequestBuilder builder(xml_endpoint_ + "/" + request.bucket_name() + "/" +
-                                 UrlEscapeString(request.object_name()),
-                             xml_upload_factory_);
-  auto status = SetupBuilderCommon(builder, "PUT");
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_upload_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "PUT");
   if (!status.ok()) {
     return status;
   }
-  builder.AddHeader("Host: " + xml_host_);
 
   //
   // Apply the options from InsertObjectMediaRequest that are set, translating
@@ -1262,14 +1391,13 @@ StatusOr<ObjectMetadata> CurlClient::InsertObjectMediaXml(
 
 StatusOr<std::unique_ptr<ObjectReadSource>> CurlClient::ReadObjectXml(
     ReadObjectRangeRequest const& request) {
-  CurlRequestBuilder builder(xml_endpoint_ + "/" + request.bucket_name() + "/" +
-                                 UrlEscapeString(request.object_name()),
-                             xml_download_factory_);
-  auto status = SetupBuilderCommon(builder, "GET");
+  CurlRequestBuilder builder(
+      xml_template_.ObjectUrl(request.bucket_name(), request.object_name()),
+      xml_download_factory_);
+  auto status = SetupBuilderCommon(builder, xml_template_, "GET");
   if (!status.ok()) {
     return status;
   }
-  builder.AddHeader("Host: " + xml_host_);
 
   //
   // Apply the options from ReadObjectMediaRequest that are set, translating
@@ -16,6 +16,7 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_CURL_CLIENT_H
 
 #include "google/cloud/storage/internal/curl_handle_factory.h"
+#include "google/cloud/storage/internal/curl_request_template.h"
 #include "google/cloud/storage/internal/raw_client.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
 #include "google/cloud/storage/oauth2/credentials.h"
@@ -115,6 +116,14 @@ class CurlClient : public RawClient,
       std::string const& session_id) override;
   StatusOr<EmptyResponse> DeleteResumableUpload(
       DeleteResumableUploadRequest const& request) override;
+  StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) override;
+  StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) override;
+  StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) override;
+  StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -188,6 +197,11 @@ class CurlClient : public RawClient,
   /// Setup the configuration parameters that do not depend on the request.
   Status SetupBuilderCommon(CurlRequestBuilder& builder, char const* method);
 
+  /// Same as above, using the values precomputed in @p request_template.
+  Status SetupBuilderCommon(CurlRequestBuilder& builder,
+                            CurlRequestTemplate& request_template,
+                            char const* method);
+
   /// Applies the common configuration parameters to @p builder.
   template <typename Request>
   Status SetupBuilder(CurlRequestBuilder& builder, Request const& request,
@@ -220,6 +234,8 @@ class CurlClient : public RawClient,
   std::string const xml_host_;
   std::string const iam_endpoint_;
   bool const xml_enabled_;
+  CurlRequestTemplate json_template_;
+  CurlRequestTemplate xml_template_;
 
   std::mutex mu_;
   google::cloud::internal::DefaultPRNG generator_;  // GUARDED_BY(mu_);
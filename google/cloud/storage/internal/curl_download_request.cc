@@ -55,8 +55,7 @@ extern "C" std::size_t CurlDownloadRequestHeader(char* contents,
                  << ", paused=" << paused_ << ", in_multi=" << in_multi_
 
 CurlDownloadRequest::CurlDownloadRequest()
-    : headers_(nullptr, &curl_slist_free_all),
-      download_stall_timeout_(0),
+    : download_stall_timeout_(0),
       multi_(nullptr, &curl_multi_cleanup),
       spill_(CURL_MAX_WRITE_SIZE) {}
 
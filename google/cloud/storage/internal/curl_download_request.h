@@ -106,7 +106,7 @@ class CurlDownloadRequest : public ObjectReadSource {
   static Status AsStatus(CURLMcode result, char const* where);
 
   std::string url_;
-  CurlHeaders headers_;
+  CurlRequestHeaders headers_;
   std::string payload_;
   std::string user_agent_;
   CurlReceivedHeaders received_headers_;
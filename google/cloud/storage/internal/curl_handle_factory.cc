@@ -13,6 +13,10 @@
 // limitations under the License.
 
 #include "google/cloud/storage/internal/curl_handle_factory.h"
+#include "absl/memory/memory.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -72,29 +76,52 @@ CurlMulti DefaultCurlHandleFactory::CreateMultiHandle() {
 
 void DefaultCurlHandleFactory::CleanupMultiHandle(CurlMulti&& m) { m.reset(); }
 
+namespace {
+std::size_t DefaultShardCount(std::size_t maximum_size) {
+  std::size_t n = std::thread::hardware_concurrency();
+  if (n == 0) n = 1;
+  return (std::min)(maximum_size, n);
+}
+}  // namespace
+
 PooledCurlHandleFactory::PooledCurlHandleFactory(std::size_t maximum_size,
-                                                 ChannelOptions options)
+                                                 ChannelOptions options,
+                                                 std::size_t shard_count)
     : maximum_size_(maximum_size), options_(std::move(options)) {
-  handles_.reserve(maximum_size);
-  multi_handles_.reserve(maximum_size);
+  // Never create more shards than handles, otherwise the per-shard capacity
+  // would round down to zero and nothing would be pooled.
+  shard_count = (std::max<std::size_t>)(
+      1, (std::min)(shard_count, maximum_size_));
+  shard_capacity_ = maximum_size_ / shard_count;
+  shards_.reserve(shard_count);
+  for (std::size_t i = 0; i != shard_count; ++i) {
+    shards_.push_back(absl::make_unique<Shard>());
+    shards_.back()->handles.reserve(shard_capacity_);
+    shards_.back()->multi_handles.reserve(shard_capacity_);
+  }
 }
 
+PooledCurlHandleFactory::PooledCurlHandleFactory(std::size_t maximum_size,
+                                                 ChannelOptions options)
+    : PooledCurlHandleFactory(maximum_size, std::move(options),
+                              DefaultShardCount(maximum_size)) {}
+
 PooledCurlHandleFactory::~PooledCurlHandleFactory() {
-  for (auto* h : handles_) {
-    curl_easy_cleanup(h);
-  }
-  for (auto* m : multi_handles_) {
-    curl_multi_cleanup(m);
+  for (auto& shard : shards_) {
+    for (auto* h : shard->handles) {
+      curl_easy_cleanup(h);
+    }
+    for (auto* m : shard->multi_handles) {
+      curl_multi_cleanup(m);
+    }
   }
 }
 
 CurlPtr PooledCurlHandleFactory::CreateHandle() {
-  std::unique_lock<std::mutex> lk(mu_);
-  if (!handles_.empty()) {
-    CURL* handle = handles_.back();
+  CURL* handle = TakeHandle();
+  if (handle != nullptr) {
     // Clear all the options in the handle so we do not leak its previous state.
     (void)curl_easy_reset(handle);
-    handles_.pop_back();
     CurlPtr curl(handle, &curl_easy_cleanup);
     SetCurlOptions(curl.get(), options_);
     return curl;
@@ -105,42 +132,131 @@ CurlPtr PooledCurlHandleFactory::CreateHandle() {
 }
 
 void PooledCurlHandleFactory::CleanupHandle(CurlHandle&& h) {
-  std::unique_lock<std::mutex> lk(mu_);
   char* ip;
   auto res = curl_easy_getinfo(GetHandle(h), CURLINFO_LOCAL_IP, &ip);
-  if (res == CURLE_OK && ip != nullptr) {
-    last_client_ip_address_ = ip;
-  }
-  if (handles_.size() >= maximum_size_) {
-    CURL* tmp = handles_.front();
-    handles_.erase(handles_.begin());
-    curl_easy_cleanup(tmp);
+  std::string ip_address;
+  if (res == CURLE_OK && ip != nullptr) ip_address = ip;
+
+  CURL* evicted = nullptr;
+  auto& shard = *shards_[PreferredShard()];
+  {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    if (!ip_address.empty()) {
+      shard.last_client_ip_address = std::move(ip_address);
+      shard.last_client_ip_sequence = ++ip_sequence_;
+    }
+    if (!shard.handles.empty() && shard.handles.size() >= shard_capacity_) {
+      evicted = shard.handles.front();
+      shard.handles.erase(shard.handles.begin());
+    }
+    if (shard_capacity_ != 0) {
+      shard.handles.push_back(GetHandle(h));
+      // The shard now has ownership, so release it.
+      ReleaseHandle(h);
+    }
   }
-  handles_.push_back(GetHandle(h));
-  // The handles_ vector now has ownership, so release it.
-  ReleaseHandle(h);
+  // Release the evicted handle outside the lock, it may close a connection.
+  if (evicted != nullptr) curl_easy_cleanup(evicted);
 }
 
 CurlMulti PooledCurlHandleFactory::CreateMultiHandle() {
-  std::unique_lock<std::mutex> lk(mu_);
-  if (!multi_handles_.empty()) {
-    CURL* m = multi_handles_.back();
-    multi_handles_.pop_back();
-    return CurlMulti(m, &curl_multi_cleanup);
-  }
+  CURLM* m = TakeMultiHandle();
+  if (m != nullptr) return CurlMulti(m, &curl_multi_cleanup);
   return CurlMulti(curl_multi_init(), &curl_multi_cleanup);
 }
 
 void PooledCurlHandleFactory::CleanupMultiHandle(CurlMulti&& m) {
-  std::unique_lock<std::mutex> lk(mu_);
-  if (multi_handles_.size() >= maximum_size_) {
-    CURLM* tmp = multi_handles_.front();
-    multi_handles_.erase(multi_handles_.begin());
-    curl_multi_cleanup(tmp);
+  CURLM* evicted = nullptr;
+  auto& shard = *shards_[PreferredShard()];
+  {
+    std::lock_guard<std::mutex> lk(shard.mu);
+    if (!shard.multi_handles.empty() &&
+        shard.multi_handles.size() >= shard_capacity_) {
+      evicted = shard.multi_handles.front();
+      shard.multi_handles.erase(shard.multi_handles.begin());
+    }
+    if (shard_capacity_ != 0) {
+      shard.multi_handles.push_back(m.get());
+      // The shard now has ownership, so release it.
+      (void)m.release();
+    }
+  }
+  if (evicted != nullptr) curl_multi_cleanup(evicted);
+}
+
+std::string PooledCurlHandleFactory::LastClientIpAddress() const {
+  std::string result;
+  std::uint64_t sequence = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    if (shard->last_client_ip_sequence > sequence) {
+      sequence = shard->last_client_ip_sequence;
+      result = shard->last_client_ip_address;
+    }
+  }
+  return result;
+}
+
+std::size_t PooledCurlHandleFactory::CurrentHandleCount() const {
+  std::size_t count = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    count += shard->handles.size();
+  }
+  return count;
+}
+
+std::size_t PooledCurlHandleFactory::CurrentMultiHandleCount() const {
+  std::size_t count = 0;
+  for (auto const& shard : shards_) {
+    std::lock_guard<std::mutex> lk(shard->mu);
+    count += shard->multi_handles.size();
+  }
+  return count;
+}
+
+std::size_t PooledCurlHandleFactory::PreferredShard() const {
+  if (shards_.size() == 1) return 0;
+  return std::hash<std::thread::id>{}(std::this_thread::get_id()) %
+         shards_.size();
+}
+
+CURL* PooledCurlHandleFactory::TakeHandle() {
+  auto const preferred = PreferredShard();
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    auto& shard = *shards_[(preferred + i) % shards_.size()];
+    std::unique_lock<std::mutex> lk(shard.mu, std::defer_lock);
+    // Wait for our own shard, but do not wait for busy shards when trying to
+    // steal from them, creating a new handle is cheaper than waiting.
+    if (i == 0) {
+      lk.lock();
+    } else if (!lk.try_lock()) {
+      continue;
+    }
+    if (shard.handles.empty()) continue;
+    CURL* handle = shard.handles.back();
+    shard.handles.pop_back();
+    return handle;
+  }
+  return nullptr;
+}
+
+CURLM* PooledCurlHandleFactory::TakeMultiHandle() {
+  auto const preferred = PreferredShard();
+  for (std::size_t i = 0; i < shards_.size(); ++i) {
+    auto& shard = *shards_[(preferred + i) % shards_.size()];
+    std::unique_lock<std::mutex> lk(shard.mu, std::defer_lock);
+    if (i == 0) {
+      lk.lock();
+    } else if (!lk.try_lock()) {
+      continue;
+    }
+    if (shard.multi_handles.empty()) continue;
+    CURLM* m = shard.multi_handles.back();
+    shard.multi_handles.pop_back();
+    return m;
   }
-  multi_handles_.push_back(m.get());
-  // The multi_handles_ vector now has ownership, so release it.
-  (void)m.release();
+  return nullptr;
 }
 
 }  // namespace internal
@@ -18,6 +18,9 @@
 #include "google/cloud/storage/internal/curl_handle.h"
 #include "google/cloud/storage/internal/curl_wrappers.h"
 #include "google/cloud/storage/version.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -47,6 +50,9 @@ class CurlHandleFactory {
                                    char const* value);
   void SetCurlOptions(CURL* handle, ChannelOptions const& options);
 
+  static CurlHandle MakeCurlHandle(CurlPtr ptr) {
+    return CurlHandle(std::move(ptr));
+  }
   static CURL* GetHandle(CurlHandle& h) { return h.handle_.get(); }
   static void ResetHandle(CurlHandle& h) { h.handle_.reset(); }
   static void ReleaseHandle(CurlHandle& h) { (void)h.handle_.release(); }
@@ -91,9 +97,19 @@ class DefaultCurlHandleFactory : public CurlHandleFactory {
  *
  * This implementation keeps up to N handles in memory, they are only released
  * when the factory is destructed.
+ *
+ * To avoid contention when many threads create and release handles, the pool
+ * is split into shards, each with its own mutex. A thread always starts with
+ * the same shard (selected by hashing its id), so with enough shards each
+ * thread effectively has its own small cache. If a thread's shard is empty the
+ * factory tries to steal a handle from the other shards, without blocking on
+ * any shard that is already locked. The total number of pooled handles never
+ * exceeds N: each shard holds at most `N / shard_count` handles.
  */
 class PooledCurlHandleFactory : public CurlHandleFactory {
  public:
+  PooledCurlHandleFactory(std::size_t maximum_size, ChannelOptions options,
+                          std::size_t shard_count);
   PooledCurlHandleFactory(std::size_t maximum_size, ChannelOptions options);
   explicit PooledCurlHandleFactory(std::size_t maximum_size)
       : PooledCurlHandleFactory(maximum_size, {}) {}
@@ -105,17 +121,39 @@ class PooledCurlHandleFactory : public CurlHandleFactory {
   CurlMulti CreateMultiHandle() override;
   void CleanupMultiHandle(CurlMulti&&) override;
 
-  std::string LastClientIpAddress() const override {
-    std::lock_guard<std::mutex> lk(mu_);
-    return last_client_ip_address_;
-  }
+  std::string LastClientIpAddress() const override;
+
+  /// The number of shards, exposed for testing and benchmarks.
+  std::size_t shard_count() const { return shards_.size(); }
+
+  /// The number of handles currently in the pool, for testing only.
+  std::size_t CurrentHandleCount() const;
+
+  /// The number of multi handles currently in the pool, for testing only.
+  std::size_t CurrentMultiHandleCount() const;
 
  private:
+  struct Shard {
+    mutable std::mutex mu;
+    std::vector<CURL*> handles;
+    std::vector<CURLM*> multi_handles;
+    std::string last_client_ip_address;
+    std::uint64_t last_client_ip_sequence = 0;
+  };
+
+  /// Returns the shard preferred by the calling thread.
+  std::size_t PreferredShard() const;
+
+  /// Remove a handle from the pool, stealing from other shards if needed.
+  CURL* TakeHandle();
+
+  /// Remove a multi handle from the pool, stealing from other shards if needed.
+  CURLM* TakeMultiHandle();
+
   std::size_t maximum_size_;
-  mutable std::mutex mu_;
-  std::vector<CURL*> handles_;
-  std::vector<CURLM*> multi_handles_;
-  std::string last_client_ip_address_;
+  std::size_t shard_capacity_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<std::uint64_t> ip_sequence_{0};
   ChannelOptions options_;
 };
 
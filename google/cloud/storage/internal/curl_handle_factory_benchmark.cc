@@ -0,0 +1,76 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_handle_factory.h"
+#include <benchmark/benchmark.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+// This benchmark measures the contention in `PooledCurlHandleFactory` as the
+// number of threads grows. Each iteration creates a handle and immediately
+// returns it to the pool, which is the worst case for the pool's locks. The
+// `SingleShard` variant behaves like a pool protected by a single mutex.
+//
+// Compare the `SingleShard` and `Sharded` results for the same thread count,
+// note that the results are only meaningful on machines with enough cores to
+// run all the threads in parallel.
+
+auto constexpr kPoolSize = 128;
+auto constexpr kMaxThreads = 64;
+
+class BenchmarkFactory : public PooledCurlHandleFactory {
+ public:
+  BenchmarkFactory(std::size_t maximum_size, std::size_t shard_count)
+      : PooledCurlHandleFactory(maximum_size, {}, shard_count) {}
+
+  void CreateAndCleanup() { CleanupHandle(MakeCurlHandle(CreateHandle())); }
+};
+
+BenchmarkFactory& SingleShardFactory() {
+  static auto* const kFactory = new BenchmarkFactory(kPoolSize, 1);
+  return *kFactory;
+}
+
+BenchmarkFactory& ShardedFactory() {
+  static auto* const kFactory = new BenchmarkFactory(kPoolSize, kMaxThreads);
+  return *kFactory;
+}
+
+void BM_PooledSingleShard(benchmark::State& state) {
+  auto& factory = SingleShardFactory();
+  for (auto _ : state) {
+    factory.CreateAndCleanup();
+  }
+}
+BENCHMARK(BM_PooledSingleShard)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+void BM_PooledSharded(benchmark::State& state) {
+  auto& factory = ShardedFactory();
+  for (auto _ : state) {
+    factory.CreateAndCleanup();
+  }
+}
+BENCHMARK(BM_PooledSharded)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -15,6 +15,8 @@
 #include "google/cloud/storage/internal/curl_handle_factory.h"
 #include <gmock/gmock.h>
 #include <map>
+#include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -110,6 +112,83 @@ TEST(CurlHandleFactoryTest, PooledFactoryChannelOptionsCallsSetOptions) {
   EXPECT_THAT(object_under_test.set_options_, testing::ElementsAre(expected));
 }
 
+TEST(CurlHandleFactoryTest, PooledFactoryReusesHandles) {
+  PooledCurlHandleFactory object_under_test(4, {}, 2);
+  EXPECT_EQ(2, object_under_test.shard_count());
+  EXPECT_EQ(0, object_under_test.CurrentHandleCount());
+
+  object_under_test.CleanupHandle(CurlHandle{});
+  EXPECT_EQ(1, object_under_test.CurrentHandleCount());
+
+  auto handle = object_under_test.CreateHandle();
+  EXPECT_NE(nullptr, handle.get());
+  EXPECT_EQ(0, object_under_test.CurrentHandleCount());
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryShardCountIsBounded) {
+  PooledCurlHandleFactory zero(0, {}, 8);
+  EXPECT_EQ(1, zero.shard_count());
+  PooledCurlHandleFactory small(2, {}, 8);
+  EXPECT_EQ(2, small.shard_count());
+  PooledCurlHandleFactory large(64, {}, 8);
+  EXPECT_EQ(8, large.shard_count());
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryStealsFromOtherShards) {
+  auto constexpr kThreads = 4;
+  // Each shard can hold a handle from every thread, so no handles are evicted
+  // regardless of the shard each thread picks.
+  PooledCurlHandleFactory object_under_test(4 * kThreads, {}, 4);
+
+  // Release handles from different threads, which may land in any shard.
+  std::vector<std::thread> tasks;
+  for (int i = 0; i != kThreads; ++i) {
+    tasks.emplace_back([&object_under_test] {
+      object_under_test.CleanupHandle(CurlHandle{});
+    });
+  }
+  for (auto& t : tasks) t.join();
+  EXPECT_EQ(kThreads, object_under_test.CurrentHandleCount());
+
+  // A single thread can reclaim all of them, regardless of their shard.
+  std::vector<CurlPtr> handles;
+  for (int i = 0; i != kThreads; ++i) {
+    handles.push_back(object_under_test.CreateHandle());
+  }
+  EXPECT_EQ(0, object_under_test.CurrentHandleCount());
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryTotalSizeIsBounded) {
+  auto constexpr kMaximumSize = 8;
+  PooledCurlHandleFactory object_under_test(kMaximumSize, {}, 4);
+
+  std::vector<std::thread> tasks;
+  for (int i = 0; i != 16; ++i) {
+    tasks.emplace_back([&object_under_test] {
+      for (int j = 0; j != 4; ++j) {
+        object_under_test.CleanupHandle(CurlHandle{});
+        object_under_test.CleanupMultiHandle(
+            object_under_test.CreateMultiHandle());
+      }
+    });
+  }
+  for (auto& t : tasks) t.join();
+  EXPECT_LE(object_under_test.CurrentHandleCount(), kMaximumSize);
+  EXPECT_LE(object_under_test.CurrentMultiHandleCount(), kMaximumSize);
+}
+
+TEST(CurlHandleFactoryTest, PooledFactoryMultiHandles) {
+  PooledCurlHandleFactory object_under_test(2, {}, 1);
+  auto m = object_under_test.CreateMultiHandle();
+  auto* const expected = m.get();
+  object_under_test.CleanupMultiHandle(std::move(m));
+  EXPECT_EQ(1, object_under_test.CurrentMultiHandleCount());
+
+  auto actual = object_under_test.CreateMultiHandle();
+  EXPECT_EQ(expected, actual.get());
+  EXPECT_EQ(0, object_under_test.CurrentMultiHandleCount());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -68,7 +68,7 @@ class CurlRequest {
                            std::size_t nitems);
 
   std::string url_;
-  CurlHeaders headers_ = CurlHeaders(nullptr, &curl_slist_free_all);
+  CurlRequestHeaders headers_;
   std::string user_agent_;
   std::string response_payload_;
   CurlReceivedHeaders received_headers_;
@@ -14,7 +14,6 @@
 
 #include "google/cloud/storage/internal/curl_request_builder.h"
 #include "google/cloud/storage/version.h"
-#include "google/cloud/internal/build_info.h"
 
 namespace google {
 namespace cloud {
@@ -30,7 +29,6 @@ CurlRequestBuilder::CurlRequestBuilder(
     std::string base_url, std::shared_ptr<CurlHandleFactory> factory)
     : factory_(std::move(factory)),
       handle_(factory_->CreateHandle()),
-      headers_(nullptr, &curl_slist_free_all),
       url_(std::move(base_url)),
       query_parameter_separator_("?"),
       logging_enabled_(false),
@@ -41,7 +39,7 @@ CurlRequest CurlRequestBuilder::BuildRequest() {
   CurlRequest request;
   request.url_ = std::move(url_);
   request.headers_ = std::move(headers_);
-  request.user_agent_ = user_agent_prefix_ + UserAgentSuffix();
+  request.user_agent_ = UserAgent();
   request.handle_ = std::move(handle_);
   request.factory_ = std::move(factory_);
   request.logging_enabled_ = logging_enabled_;
@@ -55,7 +53,7 @@ CurlDownloadRequest CurlRequestBuilder::BuildDownloadRequest(
   CurlDownloadRequest request;
   request.url_ = std::move(url_);
   request.headers_ = std::move(headers_);
-  request.user_agent_ = user_agent_prefix_ + UserAgentSuffix();
+  request.user_agent_ = UserAgent();
   request.payload_ = std::move(payload);
   request.handle_ = std::move(handle_);
   request.multi_ = factory_->CreateMultiHandle();
@@ -78,11 +76,21 @@ CurlRequestBuilder& CurlRequestBuilder::ApplyClientOptions(
   return *this;
 }
 
+CurlRequestBuilder& CurlRequestBuilder::ApplyRequestTemplate(
+    CurlRequestTemplate& request_template,
+    std::string const& authorization_header) {
+  ValidateBuilderState(__func__);
+  logging_enabled_ = request_template.logging_enabled();
+  socket_options_ = request_template.socket_options();
+  user_agent_ = request_template.user_agent();
+  download_stall_timeout_ = request_template.download_stall_timeout();
+  headers_.SetShared(request_template.CommonHeaders(authorization_header));
+  return *this;
+}
+
 CurlRequestBuilder& CurlRequestBuilder::AddHeader(std::string const& header) {
   ValidateBuilderState(__func__);
-  auto* new_header = curl_slist_append(headers_.get(), header.c_str());
-  (void)headers_.release();
-  headers_.reset(new_header);
+  headers_.Append(header);
   return *this;
 }
 
@@ -111,14 +119,13 @@ CurlRequestBuilder& CurlRequestBuilder::SetCurlShare(CURLSH* share) {
 
 std::string CurlRequestBuilder::UserAgentSuffix() const {
   ValidateBuilderState(__func__);
-  // Pre-compute and cache the user agent string:
-  static std::string const kUserAgentSuffix = [] {
-    std::string agent = "gcloud-cpp/" + storage::version_string() + " ";
-    agent += curl_version();
-    agent += " " + google::cloud::internal::compiler();
-    return agent;
-  }();
-  return kUserAgentSuffix;
+  return CurlUserAgentSuffix();
+}
+
+std::string CurlRequestBuilder::UserAgent() {
+  // Use the precomputed value if `ApplyRequestTemplate()` was called.
+  if (!user_agent_.empty()) return std::move(user_agent_);
+  return user_agent_prefix_ + CurlUserAgentSuffix();
 }
 
 void CurlRequestBuilder::ValidateBuilderState(char const* where) const {
@@ -19,6 +19,7 @@
 #include "google/cloud/storage/internal/curl_download_request.h"
 #include "google/cloud/storage/internal/curl_handle_factory.h"
 #include "google/cloud/storage/internal/curl_request.h"
+#include "google/cloud/storage/internal/curl_request_template.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/storage/well_known_headers.h"
 
@@ -163,6 +164,16 @@ class CurlRequestBuilder {
   /// Copy interesting configuration parameters from the client options.
   CurlRequestBuilder& ApplyClientOptions(ClientOptions const& options);
 
+  /**
+   * Copy the precomputed configuration parameters from @p request_template.
+   *
+   * This is an alternative to `ApplyClientOptions()`, it also adds the common
+   * headers, including @p authorization_header, without copying them.
+   */
+  CurlRequestBuilder& ApplyRequestTemplate(
+      CurlRequestTemplate& request_template,
+      std::string const& authorization_header);
+
   /// Sets the CURLSH* handle to share resources.
   CurlRequestBuilder& SetCurlShare(CURLSH* share);
 
@@ -181,16 +192,18 @@ class CurlRequestBuilder {
 
  private:
   void ValidateBuilderState(char const* where) const;
+  std::string UserAgent();
 
   std::shared_ptr<CurlHandleFactory> factory_;
 
   CurlHandle handle_;
-  CurlHeaders headers_;
+  CurlRequestHeaders headers_;
 
   std::string url_;
   char const* query_parameter_separator_;
 
   std::string user_agent_prefix_;
+  std::string user_agent_;
   bool logging_enabled_;
   CurlHandle::SocketOptions socket_options_;
   std::chrono::seconds download_stall_timeout_;
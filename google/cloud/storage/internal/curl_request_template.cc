@@ -0,0 +1,113 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_request_template.h"
+#include "google/cloud/internal/build_info.h"
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+namespace {
+bool IsUnreserved(char c) {
+  // Same characters as `curl_easy_escape()`, note that `std::isalnum()` depends
+  // on the locale.
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+         ('0' <= c && c <= '9') || c == '-' || c == '.' || c == '_' ||
+         c == '~';
+}
+
+std::size_t UrlEscapedSize(std::string const& value) {
+  std::size_t size = 0;
+  for (auto c : value) size += IsUnreserved(c) ? 1 : 3;
+  return size;
+}
+}  // namespace
+
+std::string const& CurlUserAgentSuffix() {
+  static std::string const kUserAgentSuffix = [] {
+    std::string agent = "gcloud-cpp/" + storage::version_string() + " ";
+    agent += curl_version();
+    agent += " " + google::cloud::internal::compiler();
+    return agent;
+  }();
+  return kUserAgentSuffix;
+}
+
+void AppendUrlEscaped(std::string& result, std::string const& value) {
+  static char const kHexDigits[] = "0123456789ABCDEF";
+  result.reserve(result.size() + UrlEscapedSize(value));
+  for (auto c : value) {
+    if (IsUnreserved(c)) {
+      result.push_back(c);
+      continue;
+    }
+    auto const u = static_cast<unsigned char>(c);
+    result.push_back('%');
+    result.push_back(kHexDigits[u >> 4]);
+    result.push_back(kHexDigits[u & 0xF]);
+  }
+}
+
+CurlRequestTemplate::CurlRequestTemplate(ClientOptions const& options,
+                                         std::string const& endpoint,
+                                         std::string const& bucket_prefix,
+                                         std::string object_prefix,
+                                         std::vector<std::string> headers)
+    : bucket_prefix_(endpoint + bucket_prefix),
+      object_prefix_(std::move(object_prefix)),
+      headers_(std::move(headers)),
+      user_agent_(options.user_agent_prefix() + CurlUserAgentSuffix()),
+      logging_enabled_(options.enable_http_tracing()),
+      download_stall_timeout_(options.download_stall_timeout()) {
+  socket_options_.recv_buffer_size_ = options.maximum_socket_recv_size();
+  socket_options_.send_buffer_size_ = options.maximum_socket_send_size();
+}
+
+std::string CurlRequestTemplate::ObjectUrl(
+    std::string const& bucket_name, std::string const& object_name) const {
+  // Leave room for a few query parameters, such as `alt=media`, to avoid
+  // reallocating the string in the common cases.
+  auto constexpr kQueryParametersSize = 64;
+  std::string url;
+  url.reserve(bucket_prefix_.size() + bucket_name.size() +
+              object_prefix_.size() + UrlEscapedSize(object_name) +
+              kQueryParametersSize);
+  url += bucket_prefix_;
+  url += bucket_name;
+  url += object_prefix_;
+  AppendUrlEscaped(url, object_name);
+  return url;
+}
+
+std::shared_ptr<CurlSharedHeaders const> CurlRequestTemplate::CommonHeaders(
+    std::string const& authorization_header) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (common_headers_ && authorization_header_ == authorization_header) {
+    return common_headers_;
+  }
+  std::vector<std::string> headers{authorization_header};
+  headers.insert(headers.end(), headers_.begin(), headers_.end());
+  authorization_header_ = authorization_header;
+  common_headers_ = std::make_shared<CurlSharedHeaders const>(headers);
+  return common_headers_;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,148 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_request_builder.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::int64_t> allocation_count{0};
+}  // namespace
+
+// Count the allocations made by the C++ code in this program. The allocations
+// made by libcurl (using `malloc()`) are not included.
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  if (void* p = std::malloc(size)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+// This benchmark measures the cost to create the requests for
+// `GetObjectMetadata()` and `ReadObject()` in `CurlClient`. The `Baseline`
+// variants format the URL and all the headers for each request, the `Template`
+// variants use a `CurlRequestTemplate`, as `CurlClient` does.
+//
+// The requests are created but never sent. The `allocations` counter reports
+// the number of memory allocations per request.
+
+auto constexpr kEndpoint = "https://storage.googleapis.com/storage/v1";
+auto constexpr kHost = "storage.googleapis.com";
+auto constexpr kAuthorization = "Authorization: Bearer test-only-token";
+auto constexpr kApiClient = "x-goog-api-client: gl-cpp/test gccl/test";
+auto constexpr kBucket = "test-bucket";
+auto constexpr kObject = "folder/test-object.txt";
+
+struct Fixture {
+  Fixture()
+      : options(oauth2::CreateAnonymousCredentials()),
+        factory(std::make_shared<PooledCurlHandleFactory>(4)),
+        request_template(options, kEndpoint, "/b/", "/o/",
+                         {kApiClient, std::string("Host: ") + kHost}) {}
+
+  ClientOptions options;
+  std::shared_ptr<CurlHandleFactory> factory;
+  CurlRequestTemplate request_template;
+};
+
+Fixture& GetFixture() {
+  static auto* const kFixture = new Fixture;
+  return *kFixture;
+}
+
+CurlRequestBuilder BaselineBuilder(Fixture& f) {
+  CurlHandle handle;
+  CurlRequestBuilder builder(
+      std::string(kEndpoint) + "/b/" + kBucket + "/o/" +
+          std::string(handle.MakeEscapedString(kObject).get()),
+      f.factory);
+  builder.SetMethod("GET")
+      .ApplyClientOptions(f.options)
+      .AddHeader(std::string(kAuthorization))
+      .AddHeader(kApiClient)
+      .AddHeader(std::string("Host: ") + kHost);
+  return builder;
+}
+
+CurlRequestBuilder TemplateBuilder(Fixture& f) {
+  CurlRequestBuilder builder(f.request_template.ObjectUrl(kBucket, kObject),
+                             f.factory);
+  builder.SetMethod("GET").ApplyRequestTemplate(f.request_template,
+                                                std::string(kAuthorization));
+  return builder;
+}
+
+CurlRequest ReadObjectRequest(CurlRequestBuilder builder) {
+  builder.AddQueryParameter("alt", "media");
+  builder.AddHeader("Range: bytes=0-1023");
+  return builder.BuildRequest();
+}
+
+template <typename Functor>
+void RunBenchmark(benchmark::State& state, Functor const& functor) {
+  auto& fixture = GetFixture();
+  // Populate the handle pool before measuring anything.
+  benchmark::DoNotOptimize(functor(fixture));
+  auto const start = allocation_count.load();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(functor(fixture));
+  }
+  state.counters["allocations"] =
+      benchmark::Counter(static_cast<double>(allocation_count.load() - start),
+                         benchmark::Counter::kAvgIterations);
+}
+
+void BM_GetObjectMetadataBaseline(benchmark::State& state) {
+  RunBenchmark(state,
+               [](Fixture& f) { return BaselineBuilder(f).BuildRequest(); });
+}
+BENCHMARK(BM_GetObjectMetadataBaseline);
+
+void BM_GetObjectMetadataTemplate(benchmark::State& state) {
+  RunBenchmark(state,
+               [](Fixture& f) { return TemplateBuilder(f).BuildRequest(); });
+}
+BENCHMARK(BM_GetObjectMetadataTemplate);
+
+void BM_ReadObjectBaseline(benchmark::State& state) {
+  RunBenchmark(
+      state, [](Fixture& f) { return ReadObjectRequest(BaselineBuilder(f)); });
+}
+BENCHMARK(BM_ReadObjectBaseline);
+
+void BM_ReadObjectTemplate(benchmark::State& state) {
+  RunBenchmark(
+      state, [](Fixture& f) { return ReadObjectRequest(TemplateBuilder(f)); });
+}
+BENCHMARK(BM_ReadObjectTemplate);
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,111 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/curl_request_template.h"
+#include "google/cloud/storage/oauth2/google_credentials.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+std::vector<std::string> AsVector(curl_slist const* list) {
+  std::vector<std::string> result;
+  for (auto const* p = list; p != nullptr; p = p->next) {
+    result.emplace_back(p->data);
+  }
+  return result;
+}
+
+std::unique_ptr<CurlRequestTemplate> MakeJsonTemplate() {
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  options.add_user_agent_prefix("test-prefix");
+  return absl::make_unique<CurlRequestTemplate>(
+      options, "https://storage.googleapis.com/v1", "/b/", "/o/",
+      std::vector<std::string>{"x-goog-api-client: test", "Host: test-host"});
+}
+
+TEST(CurlRequestTemplateTest, AppendUrlEscapedMatchesCurl) {
+  std::string all;
+  for (int i = 1; i != 256; ++i) all.push_back(static_cast<char>(i));
+  CurlHandle handle;
+  for (std::string const& input :
+       {std::string{}, std::string("plain-name_1.txt~"),
+        std::string("folder/file name+1"), std::string("\xC3\xA9t\xC3\xA9"),
+        all}) {
+    std::string actual = "prefix/";
+    AppendUrlEscaped(actual, input);
+    EXPECT_EQ("prefix/" + std::string(handle.MakeEscapedString(input).get()),
+              actual);
+  }
+}
+
+TEST(CurlRequestTemplateTest, ObjectUrl) {
+  auto tested = MakeJsonTemplate();
+  EXPECT_EQ("https://storage.googleapis.com/v1/b/test-bucket/o/a%2Fb%20c",
+            tested->ObjectUrl("test-bucket", "a/b c"));
+
+  ClientOptions options(oauth2::CreateAnonymousCredentials());
+  CurlRequestTemplate xml(options, "https://storage.googleapis.com", "/", "/",
+                          {});
+  EXPECT_EQ("https://storage.googleapis.com/test-bucket/a%2Fb",
+            xml.ObjectUrl("test-bucket", "a/b"));
+}
+
+TEST(CurlRequestTemplateTest, UserAgent) {
+  auto tested = MakeJsonTemplate();
+  EXPECT_THAT(tested->user_agent(), StartsWith("test-prefix"));
+  EXPECT_THAT(tested->user_agent(), HasSubstr(CurlUserAgentSuffix()));
+}
+
+TEST(CurlRequestTemplateTest, CommonHeadersInterned) {
+  auto tested = MakeJsonTemplate();
+  auto h1 = tested->CommonHeaders("Authorization: Bearer a");
+  ASSERT_NE(nullptr, h1);
+  EXPECT_THAT(AsVector(h1->get()),
+              ElementsAre("Authorization: Bearer a", "x-goog-api-client: test",
+                          "Host: test-host"));
+  auto h2 = tested->CommonHeaders("Authorization: Bearer a");
+  EXPECT_EQ(h1, h2);
+}
+
+TEST(CurlRequestTemplateTest, CommonHeadersRefreshed) {
+  auto tested = MakeJsonTemplate();
+  auto h1 = tested->CommonHeaders("Authorization: Bearer a");
+  auto h2 = tested->CommonHeaders("Authorization: Bearer b");
+  EXPECT_NE(h1, h2);
+  // The old list is unchanged, and still usable by requests in progress.
+  EXPECT_THAT(AsVector(h1->get()),
+              ElementsAre("Authorization: Bearer a", "x-goog-api-client: test",
+                          "Host: test-host"));
+  EXPECT_THAT(AsVector(h2->get()),
+              ElementsAre("Authorization: Bearer b", "x-goog-api-client: test",
+                          "Host: test-host"));
+  EXPECT_EQ(h2, tested->CommonHeaders("Authorization: Bearer b"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
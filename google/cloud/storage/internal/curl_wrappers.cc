@@ -236,6 +236,69 @@ std::size_t CurlAppendHeaderData(CurlReceivedHeaders& received_headers,
   return size;
 }
 
+CurlSharedHeaders::CurlSharedHeaders(std::vector<std::string> const& headers)
+    : headers_(nullptr, &curl_slist_free_all) {
+  for (auto const& h : headers) {
+    auto* list = curl_slist_append(headers_.get(), h.c_str());
+    if (list == nullptr) continue;
+    (void)headers_.release();
+    headers_.reset(list);
+  }
+}
+
+CurlRequestHeaders::~CurlRequestHeaders() { Reset(); }
+
+CurlRequestHeaders::CurlRequestHeaders(CurlRequestHeaders&& rhs) noexcept
+    : head_(rhs.head_), tail_(rhs.tail_), shared_(std::move(rhs.shared_)) {
+  rhs.head_ = nullptr;
+  rhs.tail_ = nullptr;
+}
+
+CurlRequestHeaders& CurlRequestHeaders::operator=(
+    CurlRequestHeaders&& rhs) noexcept {
+  if (this == &rhs) return *this;
+  Reset();
+  head_ = rhs.head_;
+  tail_ = rhs.tail_;
+  shared_ = std::move(rhs.shared_);
+  rhs.head_ = nullptr;
+  rhs.tail_ = nullptr;
+  return *this;
+}
+
+void CurlRequestHeaders::Append(std::string const& header) {
+  // Create a single-node list, appending to `head_` would walk (and modify)
+  // the shared nodes.
+  auto* node = curl_slist_append(nullptr, header.c_str());
+  if (node == nullptr) return;
+  node->next = shared_ ? shared_->get() : nullptr;
+  if (tail_ == nullptr) {
+    head_ = node;
+  } else {
+    tail_->next = node;
+  }
+  tail_ = node;
+}
+
+void CurlRequestHeaders::SetShared(
+    std::shared_ptr<CurlSharedHeaders const> shared) {
+  shared_ = std::move(shared);
+  if (tail_ != nullptr) tail_->next = shared_ ? shared_->get() : nullptr;
+}
+
+curl_slist* CurlRequestHeaders::get() const {
+  if (head_ != nullptr) return head_;
+  return shared_ ? shared_->get() : nullptr;
+}
+
+void CurlRequestHeaders::Reset() {
+  if (tail_ != nullptr) tail_->next = nullptr;
+  curl_slist_free_all(head_);
+  head_ = nullptr;
+  tail_ = nullptr;
+  shared_.reset();
+}
+
 void CurlInitializeOnce(ClientOptions const& options) {
   static CurlInitializer curl_initializer;
   std::call_once(ssl_locking_initialized, InitializeSslLocking,
@@ -23,6 +23,8 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -46,6 +48,57 @@ using CurlString = std::unique_ptr<char, decltype(&curl_free)>;
 
 using CurlHeaders = std::unique_ptr<curl_slist, decltype(&curl_slist_free_all)>;
 
+/**
+ * An immutable list of HTTP request headers, shared by many requests.
+ *
+ * libcurl never modifies the list set via `CURLOPT_HTTPHEADER`, the same
+ * nodes can be used by many requests, even concurrently.
+ */
+class CurlSharedHeaders {
+ public:
+  explicit CurlSharedHeaders(std::vector<std::string> const& headers);
+
+  curl_slist* get() const { return headers_.get(); }
+
+ private:
+  CurlHeaders headers_;
+};
+
+/**
+ * The list of HTTP headers for a single request.
+ *
+ * The list contains the headers added to this request, followed by the
+ * (optional) headers shared with other requests. The shared nodes are never
+ * modified, the nodes for this request are linked in front of them, and
+ * detached before they are released.
+ */
+class CurlRequestHeaders {
+ public:
+  CurlRequestHeaders() = default;
+  ~CurlRequestHeaders();
+
+  CurlRequestHeaders(CurlRequestHeaders&& rhs) noexcept;
+  CurlRequestHeaders& operator=(CurlRequestHeaders&& rhs) noexcept;
+  CurlRequestHeaders(CurlRequestHeaders const&) = delete;
+  CurlRequestHeaders& operator=(CurlRequestHeaders const&) = delete;
+
+  /// Adds a header for this request only.
+  void Append(std::string const& header);
+
+  /// Sets the headers shared with other requests.
+  void SetShared(std::shared_ptr<CurlSharedHeaders const> shared);
+
+  /// Returns the list to use with `CURLOPT_HTTPHEADER`.
+  curl_slist* get() const;
+
+ private:
+  void Reset();
+
+  curl_slist* head_ = nullptr;
+  curl_slist* tail_ = nullptr;
+  std::shared_ptr<CurlSharedHeaders const> shared_;
+};
+
 using CurlReceivedHeaders = std::multimap<std::string, std::string>;
 std::size_t CurlAppendHeaderData(CurlReceivedHeaders& received_headers,
                                  char const* data, std::size_t size);
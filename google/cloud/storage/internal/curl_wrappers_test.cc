@@ -22,6 +22,8 @@ inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 namespace {
 
+using ::testing::ElementsAre;
+
 TEST(CurlWrappersTest, ExtractUrlHostpart) {
   struct Test {
     std::string expected;
@@ -61,6 +63,74 @@ TEST(CurlWrappersTest, ExtractUrlHostpart) {
   }
 }
 
+std::vector<std::string> AsVector(curl_slist const* list) {
+  std::vector<std::string> result;
+  for (auto const* p = list; p != nullptr; p = p->next) {
+    result.emplace_back(p->data);
+  }
+  return result;
+}
+
+TEST(CurlWrappersTest, RequestHeadersEmpty) {
+  CurlRequestHeaders tested;
+  EXPECT_EQ(nullptr, tested.get());
+}
+
+TEST(CurlWrappersTest, RequestHeadersLocalOnly) {
+  CurlRequestHeaders tested;
+  tested.Append("a: 1");
+  tested.Append("b: 2");
+  EXPECT_THAT(AsVector(tested.get()), ElementsAre("a: 1", "b: 2"));
+}
+
+TEST(CurlWrappersTest, RequestHeadersSharedOnly) {
+  auto shared = std::make_shared<CurlSharedHeaders const>(
+      std::vector<std::string>{"s: 1", "s: 2"});
+  CurlRequestHeaders tested;
+  tested.SetShared(shared);
+  EXPECT_EQ(shared->get(), tested.get());
+}
+
+TEST(CurlWrappersTest, RequestHeadersLocalAndShared) {
+  auto shared = std::make_shared<CurlSharedHeaders const>(
+      std::vector<std::string>{"s: 1", "s: 2"});
+  {
+    CurlRequestHeaders tested;
+    tested.Append("a: 1");
+    tested.SetShared(shared);
+    tested.Append("b: 2");
+    EXPECT_THAT(AsVector(tested.get()),
+                ElementsAre("a: 1", "b: 2", "s: 1", "s: 2"));
+
+    CurlRequestHeaders other;
+    other.SetShared(shared);
+    other.Append("c: 3");
+    EXPECT_THAT(AsVector(other.get()), ElementsAre("c: 3", "s: 1", "s: 2"));
+  }
+  // Releasing the requests does not modify (or release) the shared headers.
+  EXPECT_THAT(AsVector(shared->get()), ElementsAre("s: 1", "s: 2"));
+}
+
+TEST(CurlWrappersTest, RequestHeadersMove) {
+  auto shared = std::make_shared<CurlSharedHeaders const>(
+      std::vector<std::string>{"s: 1"});
+  CurlRequestHeaders source;
+  source.SetShared(shared);
+  source.Append("a: 1");
+  auto const* list = source.get();
+
+  CurlRequestHeaders tested(std::move(source));
+  EXPECT_EQ(list, tested.get());
+  EXPECT_THAT(AsVector(tested.get()), ElementsAre("a: 1", "s: 1"));
+
+  CurlRequestHeaders assigned;
+  assigned.Append("b: 2");
+  assigned = std::move(tested);
+  EXPECT_EQ(list, assigned.get());
+  EXPECT_THAT(AsVector(assigned.get()), ElementsAre("a: 1", "s: 1"));
+  EXPECT_THAT(AsVector(shared->get()), ElementsAre("s: 1"));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
@@ -0,0 +1,147 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/download_journal.h"
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// The first line in the journal, it identifies the format. GCS object names
+// cannot contain newlines, so a simple line-oriented format is enough.
+char const kJournalHeader[] = "gcs-download-journal-v1";
+
+Status InvalidJournal(std::string const& journal_name,
+                      std::string const& what) {
+  return Status(StatusCode::kInvalidArgument,
+                "invalid download journal " + journal_name + ": " + what);
+}
+
+template <typename T>
+bool ParseField(std::string const& value, T& result) {
+  std::istringstream is(value);
+  is >> result;
+  return !is.fail() && is.eof();
+}
+}  // namespace
+
+bool operator==(DownloadJournal const& lhs, DownloadJournal const& rhs) {
+  return lhs.bucket_name == rhs.bucket_name &&
+         lhs.object_name == rhs.object_name &&
+         lhs.generation == rhs.generation &&
+         lhs.committed_bytes == rhs.committed_bytes &&
+         lhs.crc32c == rhs.crc32c && lhs.received_crc32c == rhs.received_crc32c;
+}
+
+std::ostream& operator<<(std::ostream& os, DownloadJournal const& rhs) {
+  return os << "DownloadJournal={bucket_name=" << rhs.bucket_name
+            << ", object_name=" << rhs.object_name
+            << ", generation=" << rhs.generation
+            << ", committed_bytes=" << rhs.committed_bytes
+            << ", crc32c=" << rhs.crc32c
+            << ", received_crc32c=" << rhs.received_crc32c << "}";
+}
+
+std::string DownloadJournalName(std::string const& file_name) {
+  return file_name + ".gcs-download";
+}
+
+StatusOr<DownloadJournal> ReadDownloadJournal(std::string const& journal_name) {
+  std::ifstream is(journal_name);
+  if (!is.is_open()) {
+    return Status(StatusCode::kNotFound,
+                  "cannot open download journal " + journal_name);
+  }
+  std::string line;
+  if (!std::getline(is, line) || line != kJournalHeader) {
+    return InvalidJournal(journal_name, "missing header");
+  }
+  std::map<std::string, std::string> fields;
+  while (std::getline(is, line)) {
+    auto const pos = line.find('=');
+    if (pos == std::string::npos) {
+      return InvalidJournal(journal_name, "malformed line <" + line + ">");
+    }
+    fields[line.substr(0, pos)] = line.substr(pos + 1);
+  }
+  for (auto const* key :
+       {"bucket", "object", "generation", "committed", "crc32c",
+        "received-crc32c"}) {
+    if (fields.count(key) == 0) {
+      return InvalidJournal(journal_name, std::string("missing ") + key);
+    }
+  }
+  DownloadJournal journal;
+  journal.bucket_name = fields["bucket"];
+  journal.object_name = fields["object"];
+  journal.received_crc32c = fields["received-crc32c"];
+  if (!ParseField(fields["generation"], journal.generation) ||
+      !ParseField(fields["committed"], journal.committed_bytes) ||
+      !ParseField(fields["crc32c"], journal.crc32c)) {
+    return InvalidJournal(journal_name, "malformed numeric field");
+  }
+  return journal;
+}
+
+Status WriteDownloadJournal(std::string const& journal_name,
+                            DownloadJournal const& journal) {
+  auto const tmp_name = journal_name + ".tmp";
+  {
+    std::ofstream os(tmp_name, std::ios::trunc);
+    os << kJournalHeader << "\n"
+       << "bucket=" << journal.bucket_name << "\n"
+       << "object=" << journal.object_name << "\n"
+       << "generation=" << journal.generation << "\n"
+       << "committed=" << journal.committed_bytes << "\n"
+       << "crc32c=" << journal.crc32c << "\n"
+       << "received-crc32c=" << journal.received_crc32c << "\n";
+    os.close();
+    if (!os) {
+      return Status(StatusCode::kUnknown,
+                    "cannot write download journal " + tmp_name);
+    }
+  }
+  // On Windows `std::rename()` fails if the destination exists.
+#ifdef _WIN32
+  (void)std::remove(journal_name.c_str());
+#endif  // _WIN32
+  if (std::rename(tmp_name.c_str(), journal_name.c_str()) != 0) {
+    return Status(StatusCode::kUnknown,
+                  "cannot rename download journal " + tmp_name + " to " +
+                      journal_name);
+  }
+  return Status();
+}
+
+Status RemoveDownloadJournal(std::string const& journal_name) {
+  if (std::remove(journal_name.c_str()) != 0 && errno != ENOENT) {
+    return Status(StatusCode::kUnknown,
+                  "cannot remove download journal " + journal_name);
+  }
+  return Status();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
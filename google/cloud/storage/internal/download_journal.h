@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_JOURNAL_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_JOURNAL_H
+
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * The progress of a resumable `Client::DownloadToFile()` operation.
+ *
+ * The journal is stored next to the destination file, and it is updated
+ * periodically as the download makes progress. If the download is interrupted,
+ * even by a crash of the application, the next `DownloadToFile()` call for the
+ * same object and file continues from `committed_bytes`.
+ */
+struct DownloadJournal {
+  std::string bucket_name;
+  std::string object_name;
+  /// The generation of the object, or `0` if it is not known.
+  std::int64_t generation = 0;
+  /// The number of bytes already in the destination file.
+  std::uint64_t committed_bytes = 0;
+  /// The CRC32C checksum of the first `committed_bytes` of the object.
+  std::uint32_t crc32c = 0;
+  /**
+   * The CRC32C checksum of the full object, as reported by the service.
+   *
+   * Saved because the service may not report it when reading part of an
+   * object. Empty if it is not known.
+   */
+  std::string received_crc32c;
+};
+
+bool operator==(DownloadJournal const& lhs, DownloadJournal const& rhs);
+inline bool operator!=(DownloadJournal const& lhs, DownloadJournal const& rhs) {
+  return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, DownloadJournal const& rhs);
+
+/// The name of the journal used to download into @p file_name.
+std::string DownloadJournalName(std::string const& file_name);
+
+/// Read a journal, returns `kNotFound` if the file does not exist.
+StatusOr<DownloadJournal> ReadDownloadJournal(std::string const& journal_name);
+
+/**
+ * Write a journal.
+ *
+ * The journal is written to a temporary file and then renamed, so a crash
+ * never leaves a partially written journal behind.
+ */
+Status WriteDownloadJournal(std::string const& journal_name,
+                            DownloadJournal const& journal);
+
+/// Remove a journal, it is not an error if the journal does not exist.
+Status RemoveDownloadJournal(std::string const& journal_name);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_DOWNLOAD_JOURNAL_H
@@ -0,0 +1,85 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/download_journal.h"
+#include "google/cloud/storage/testing/random_names.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <fstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+std::string TempJournalName() {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  return DownloadJournalName(::testing::TempDir() +
+                             testing::MakeRandomFileName(generator));
+}
+
+TEST(DownloadJournalTest, RoundTrip) {
+  auto const name = TempJournalName();
+  DownloadJournal const expected{"test-bucket", "path/to/test object.txt",
+                                 1234567890123456789LL, 17179869184ULL,
+                                 0xFFFFFFFFU, "ImIEBA=="};
+  ASSERT_STATUS_OK(WriteDownloadJournal(name, expected));
+  auto actual = ReadDownloadJournal(name);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+
+  // Overwriting an existing journal works too.
+  auto updated = expected;
+  updated.committed_bytes += 1024;
+  updated.crc32c = 42;
+  updated.received_crc32c.clear();
+  ASSERT_STATUS_OK(WriteDownloadJournal(name, updated));
+  actual = ReadDownloadJournal(name);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(updated, *actual);
+
+  ASSERT_STATUS_OK(RemoveDownloadJournal(name));
+  EXPECT_EQ(StatusCode::kNotFound, ReadDownloadJournal(name).status().code());
+  // Removing a missing journal is not an error.
+  EXPECT_STATUS_OK(RemoveDownloadJournal(name));
+}
+
+TEST(DownloadJournalTest, Invalid) {
+  auto const name = TempJournalName();
+  for (std::string contents : {
+           "",
+           "not-a-journal\n",
+           "gcs-download-journal-v1\nbucket=b\n",
+           "gcs-download-journal-v1\nbucket=b\nobject=o\ngeneration=1\n"
+           "committed=not-a-number\ncrc32c=0\n",
+           "gcs-download-journal-v1\nbucket=b\nobject=o\ngeneration=1\n"
+           "committed=1\ncrc32c=0\ngarbage\n",
+       }) {
+    SCOPED_TRACE("Testing with <" + contents + ">");
+    std::ofstream(name) << contents;
+    auto actual = ReadDownloadJournal(name);
+    EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+  }
+  ASSERT_STATUS_OK(RemoveDownloadJournal(name));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
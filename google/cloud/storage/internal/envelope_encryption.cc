@@ -0,0 +1,665 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/envelope_encryption.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+constexpr std::size_t EnvelopeEncryptionHeader::kMaxSize;
+constexpr std::size_t EnvelopeEncryptionHeader::kNoncePrefixSize;
+constexpr std::size_t ChunkCipher::kKeySize;
+constexpr std::size_t ChunkCipher::kTagSize;
+
+namespace {
+char const kMagic[] = "GCSCSE01";
+auto constexpr kMagicSize = sizeof(kMagic) - 1;
+// The magic string, the header size, the chunk size, the nonce prefix, and the
+// wrapped key size.
+auto constexpr kFixedHeaderSize =
+    kMagicSize + 4 + 4 + EnvelopeEncryptionHeader::kNoncePrefixSize + 4;
+// Larger chunks are rejected when parsing a header, as they would require
+// unreasonably large buffers to decrypt.
+auto constexpr kMaxChunkSize = 64 * 1024 * 1024ULL;
+// The nonce contains the chunk index as a 32-bit number.
+auto constexpr kMaxChunkCount = 1ULL << 32;
+
+void AppendBigEndian(std::string& buffer, std::uint64_t value,
+                     std::size_t size) {
+  for (std::size_t i = size; i != 0; --i) {
+    buffer.push_back(static_cast<char>((value >> (8 * (i - 1))) & 0xFF));
+  }
+}
+
+std::uint32_t ReadBigEndian32(char const* data) {
+  std::uint32_t value = 0;
+  for (std::size_t i = 0; i != 4; ++i) {
+    value = (value << 8) | static_cast<unsigned char>(data[i]);
+  }
+  return value;
+}
+
+unsigned char const* AsBytes(char const* data) {
+  return reinterpret_cast<unsigned char const*>(data);
+}
+
+std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>
+GetCipherCtx() {
+  return std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)>(
+      EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+}
+
+Status CipherError(char const* where, std::uint64_t index) {
+  std::ostringstream os;
+  os << "Permanent error in " << where << "(): OpenSSL error for chunk "
+     << index;
+  return Status(StatusCode::kInternal, std::move(os).str());
+}
+
+/**
+ * Run @p function over the range [0, @p count) using up to @p thread_count
+ * threads.
+ *
+ * The range is split in contiguous blocks, one per thread, and the calling
+ * thread processes the first block. Returns the first error, if any.
+ */
+Status RunInParallel(
+    std::uint64_t count, std::size_t thread_count,
+    std::function<Status(std::uint64_t, std::uint64_t)> const& function) {
+  auto const tasks = (std::max<std::uint64_t>)(
+      1, (std::min<std::uint64_t>)(thread_count, count));
+  if (tasks == 1) return function(0, count);
+  auto const block = (count + tasks - 1) / tasks;
+  std::vector<std::future<Status>> pending;
+  for (auto begin = block; begin < count; begin += block) {
+    pending.push_back(std::async(std::launch::async, function, begin,
+                                 (std::min)(count, begin + block)));
+  }
+  auto status = function(0, block);
+  for (auto& p : pending) {
+    auto s = p.get();
+    if (status.ok()) status = std::move(s);
+  }
+  return status;
+}
+}  // namespace
+
+StatusOr<std::string> SerializeEnvelopeEncryptionHeader(
+    EnvelopeEncryptionHeader const& header) {
+  auto const size = kFixedHeaderSize + header.wrapped_key.size();
+  if (size > EnvelopeEncryptionHeader::kMaxSize) {
+    std::ostringstream os;
+    os << __func__ << "(): the wrapped key is too large ("
+       << header.wrapped_key.size() << " bytes)";
+    return Status(StatusCode::kInvalidArgument, std::move(os).str());
+  }
+  if (header.nonce_prefix.size() !=
+      EnvelopeEncryptionHeader::kNoncePrefixSize) {
+    return Status(StatusCode::kInvalidArgument,
+                  std::string(__func__) + "(): invalid nonce prefix size");
+  }
+  std::string result(kMagic, kMagicSize);
+  AppendBigEndian(result, size, 4);
+  AppendBigEndian(result, header.chunk_size, 4);
+  result += header.nonce_prefix;
+  AppendBigEndian(result, header.wrapped_key.size(), 4);
+  result += header.wrapped_key;
+  return result;
+}
+
+StatusOr<std::pair<EnvelopeEncryptionHeader, std::size_t>>
+ParseEnvelopeEncryptionHeader(std::string const& data) {
+  auto invalid = [](char const* what) {
+    return Status(StatusCode::kInvalidArgument,
+                  std::string("ParseEnvelopeEncryptionHeader(): ") + what);
+  };
+  if (data.size() < kMagicSize || data.compare(0, kMagicSize, kMagic) != 0) {
+    return invalid("not a client-side encrypted object");
+  }
+  if (data.size() < kFixedHeaderSize) return invalid("truncated header");
+  char const* p = data.data() + kMagicSize;
+  auto const size = ReadBigEndian32(p);
+  p += 4;
+  EnvelopeEncryptionHeader header;
+  header.chunk_size = ReadBigEndian32(p);
+  p += 4;
+  header.nonce_prefix.assign(p, EnvelopeEncryptionHeader::kNoncePrefixSize);
+  p += EnvelopeEncryptionHeader::kNoncePrefixSize;
+  auto const wrapped_key_size = ReadBigEndian32(p);
+  p += 4;
+  if (header.chunk_size == 0 || header.chunk_size > kMaxChunkSize) {
+    return invalid("invalid chunk size");
+  }
+  if (size > EnvelopeEncryptionHeader::kMaxSize ||
+      size != kFixedHeaderSize + wrapped_key_size) {
+    return invalid("invalid header size");
+  }
+  if (data.size() < size) return invalid("truncated header");
+  header.wrapped_key.assign(p, wrapped_key_size);
+  return std::make_pair(std::move(header), std::size_t{size});
+}
+
+std::uint64_t EnvelopeEncryptedSize(std::size_t header_size,
+                                    std::size_t chunk_size,
+                                    std::uint64_t plaintext_size) {
+  return header_size +
+         plaintext_size / chunk_size * (chunk_size + ChunkCipher::kTagSize) +
+         plaintext_size % chunk_size + ChunkCipher::kTagSize;
+}
+
+ChunkCipher::ChunkCipher(std::string key, std::string nonce_prefix,
+                         std::string header)
+    : key_(std::move(key)),
+      nonce_prefix_(std::move(nonce_prefix)),
+      header_(std::move(header)) {}
+
+Status ChunkCipher::Seal(std::uint64_t index, bool last, char const* data,
+                         std::size_t size, char* out) const {
+  if (index >= kMaxChunkCount) {
+    return Status(StatusCode::kInvalidArgument,
+                  "ChunkCipher::Seal(): too many chunks in the object");
+  }
+  auto ctx = GetCipherCtx();
+  if (!ctx) return CipherError(__func__, index);
+  auto const nonce = Nonce(index);
+  auto const suffix = AssociatedDataSuffix(index, last);
+  auto* output = reinterpret_cast<unsigned char*>(out);
+  int len = 0;
+  if (EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr,
+                         nullptr) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN,
+                          static_cast<int>(nonce.size()), nullptr) != 1 ||
+      EVP_EncryptInit_ex(ctx.get(), nullptr, nullptr, AsBytes(key_.data()),
+                         AsBytes(nonce.data())) != 1 ||
+      EVP_EncryptUpdate(ctx.get(), nullptr, &len, AsBytes(header_.data()),
+                        static_cast<int>(header_.size())) != 1 ||
+      EVP_EncryptUpdate(ctx.get(), nullptr, &len, AsBytes(suffix.data()),
+                        static_cast<int>(suffix.size())) != 1) {
+    return CipherError(__func__, index);
+  }
+  len = 0;
+  if (size != 0 && EVP_EncryptUpdate(ctx.get(), output, &len, AsBytes(data),
+                                     static_cast<int>(size)) != 1) {
+    return CipherError(__func__, index);
+  }
+  int final_len = 0;
+  if (EVP_EncryptFinal_ex(ctx.get(), output + len, &final_len) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG,
+                          static_cast<int>(kTagSize), output + size) != 1) {
+    return CipherError(__func__, index);
+  }
+  return Status();
+}
+
+Status ChunkCipher::Open(std::uint64_t index, bool last, char const* data,
+                         std::size_t size, char* out) const {
+  auto data_loss = [index](char const* what) {
+    std::ostringstream os;
+    os << "ChunkCipher::Open(): " << what << " in chunk " << index;
+    return Status(StatusCode::kDataLoss, std::move(os).str());
+  };
+  if (size < kTagSize) return data_loss("truncated data");
+  if (index >= kMaxChunkCount) return data_loss("invalid chunk index");
+  auto const payload_size = size - kTagSize;
+  unsigned char tag[kTagSize];
+  std::memcpy(tag, data + payload_size, kTagSize);
+
+  auto ctx = GetCipherCtx();
+  if (!ctx) return CipherError(__func__, index);
+  auto const nonce = Nonce(index);
+  auto const suffix = AssociatedDataSuffix(index, last);
+  auto* output = reinterpret_cast<unsigned char*>(out);
+  int len = 0;
+  if (EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, nullptr,
+                         nullptr) != 1 ||
+      EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN,
+                          static_cast<int>(nonce.size()), nullptr) != 1 ||
+      EVP_DecryptInit_ex(ctx.get(), nullptr, nullptr, AsBytes(key_.data()),
+                         AsBytes(nonce.data())) != 1 ||
+      EVP_DecryptUpdate(ctx.get(), nullptr, &len, AsBytes(header_.data()),
+                        static_cast<int>(header_.size())) != 1 ||
+      EVP_DecryptUpdate(ctx.get(), nullptr, &len, AsBytes(suffix.data()),
+                        static_cast<int>(suffix.size())) != 1) {
+    return CipherError(__func__, index);
+  }
+  len = 0;
+  if (payload_size != 0 &&
+      EVP_DecryptUpdate(ctx.get(), output, &len, AsBytes(data),
+                        static_cast<int>(payload_size)) != 1) {
+    return CipherError(__func__, index);
+  }
+  if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG,
+                          static_cast<int>(kTagSize), tag) != 1) {
+    return CipherError(__func__, index);
+  }
+  int final_len = 0;
+  if (EVP_DecryptFinal_ex(ctx.get(), output + len, &final_len) != 1) {
+    return data_loss("authentication failure");
+  }
+  return Status();
+}
+
+StatusOr<std::string> ChunkCipher::SealChunks(std::uint64_t first_index,
+                                              std::string const& data,
+                                              std::size_t chunk_size,
+                                              bool includes_last,
+                                              std::size_t thread_count) const {
+  if (!includes_last && data.size() % chunk_size != 0) {
+    return Status(StatusCode::kInternal,
+                  "ChunkCipher::SealChunks(): partial chunk in the data");
+  }
+  auto const count = data.size() / chunk_size + (includes_last ? 1 : 0);
+  std::string result(data.size() + count * kTagSize, '\0');
+  auto status = RunInParallel(
+      count, thread_count, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i != end; ++i) {
+          auto const offset = i * chunk_size;
+          auto const size = (std::min)(chunk_size, data.size() - offset);
+          auto s = Seal(first_index + i, includes_last && i + 1 == count,
+                        data.data() + offset, size,
+                        &result[0] + offset + i * kTagSize);
+          if (!s.ok()) return s;
+        }
+        return Status();
+      });
+  if (!status.ok()) return status;
+  return result;
+}
+
+StatusOr<std::string> ChunkCipher::OpenChunks(std::uint64_t first_index,
+                                              std::string const& data,
+                                              std::size_t chunk_size,
+                                              bool includes_last,
+                                              std::size_t thread_count) const {
+  auto const sealed_size = chunk_size + kTagSize;
+  auto const tail = data.size() % sealed_size;
+  if (includes_last ? tail < kTagSize : tail != 0) {
+    return Status(StatusCode::kDataLoss,
+                  "ChunkCipher::OpenChunks(): truncated encrypted data");
+  }
+  auto const count = data.size() / sealed_size + (includes_last ? 1 : 0);
+  std::string result(data.size() - count * kTagSize, '\0');
+  auto status = RunInParallel(
+      count, thread_count, [&](std::uint64_t begin, std::uint64_t end) {
+        for (auto i = begin; i != end; ++i) {
+          auto const offset = i * sealed_size;
+          auto const size = (std::min)(sealed_size, data.size() - offset);
+          auto s = Open(first_index + i, includes_last && i + 1 == count,
+                        data.data() + offset, size,
+                        &result[0] + i * chunk_size);
+          if (!s.ok()) return s;
+        }
+        return Status();
+      });
+  if (!status.ok()) return status;
+  return result;
+}
+
+std::string ChunkCipher::Nonce(std::uint64_t index) const {
+  auto nonce = nonce_prefix_;
+  AppendBigEndian(nonce, index, 4);
+  return nonce;
+}
+
+std::string ChunkCipher::AssociatedDataSuffix(std::uint64_t index,
+                                              bool last) const {
+  std::string suffix;
+  AppendBigEndian(suffix, index, 8);
+  suffix.push_back(last ? '\1' : '\0');
+  return suffix;
+}
+
+StatusOr<std::pair<std::string, std::string>> CreateEnvelopeDataKey() {
+  std::string key(ChunkCipher::kKeySize, '\0');
+  std::string nonce_prefix(EnvelopeEncryptionHeader::kNoncePrefixSize, '\0');
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(&key[0]),
+                 static_cast<int>(key.size())) != 1 ||
+      RAND_bytes(reinterpret_cast<unsigned char*>(&nonce_prefix[0]),
+                 static_cast<int>(nonce_prefix.size())) != 1) {
+    return Status(StatusCode::kInternal,
+                  "CreateEnvelopeDataKey(): cannot generate random data key");
+  }
+  return std::make_pair(std::move(key), std::move(nonce_prefix));
+}
+
+EncryptingUploadSession::EncryptingUploadSession(
+    std::unique_ptr<ResumableUploadSession> session, std::string header,
+    ChunkCipher cipher, std::size_t chunk_size, std::size_t thread_count)
+    : session_(std::move(session)),
+      cipher_(std::move(cipher)),
+      chunk_size_(chunk_size),
+      thread_count_(thread_count),
+      ciphertext_(std::move(header)) {}
+
+EncryptingUploadSession::~EncryptingUploadSession() {
+  // The background encryption uses the members of this object.
+  if (sealing_.valid()) sealing_.wait();
+}
+
+StatusOr<ResumableUploadResponse> EncryptingUploadSession::UploadChunk(
+    ConstBufferSequence const& buffers) {
+  for (auto const& b : buffers) plaintext_.append(b.data(), b.size());
+  accepted_ += TotalBytes(buffers);
+  auto status = WaitForSealing();
+  if (!status.ok()) return status;
+
+  auto const ready = plaintext_.size() / chunk_size_ * chunk_size_;
+  if (ready != 0) {
+    auto const first_index = next_index_;
+    next_index_ += ready / chunk_size_;
+    sealing_ = std::async(
+        std::launch::async,
+        [this, first_index](std::string const& data) {
+          return cipher_.SealChunks(first_index, data, chunk_size_, false,
+                                    thread_count_);
+        },
+        plaintext_.substr(0, ready));
+    plaintext_.erase(0, ready);
+  }
+  return UploadSealed();
+}
+
+StatusOr<ResumableUploadResponse> EncryptingUploadSession::UploadFinalChunk(
+    ConstBufferSequence const& buffers, std::uint64_t /*upload_size*/) {
+  // The size of the plaintext is known at this point, the size of the
+  // ciphertext is computed below.
+  for (auto const& b : buffers) plaintext_.append(b.data(), b.size());
+  accepted_ += TotalBytes(buffers);
+  auto status = WaitForSealing();
+  if (!status.ok()) return status;
+
+  auto sealed = cipher_.SealChunks(next_index_, plaintext_, chunk_size_, true,
+                                   thread_count_);
+  if (!sealed) return std::move(sealed).status();
+  next_index_ += plaintext_.size() / chunk_size_ + 1;
+  plaintext_.clear();
+  ciphertext_ += *sealed;
+
+  auto const upload_size = uploaded_ + ciphertext_.size();
+  auto response = session_->UploadFinalChunk(
+      {ConstBuffer(ciphertext_.data(), ciphertext_.size())}, upload_size);
+  if (response) {
+    uploaded_ = upload_size;
+    ciphertext_.clear();
+  }
+  return response;
+}
+
+StatusOr<ResumableUploadResponse> EncryptingUploadSession::ResetSession() {
+  return session_->ResetSession();
+}
+
+std::string const& EncryptingUploadSession::session_id() const {
+  return session_->session_id();
+}
+
+bool EncryptingUploadSession::done() const { return session_->done(); }
+
+StatusOr<ResumableUploadResponse> const&
+EncryptingUploadSession::last_response() const {
+  return session_->last_response();
+}
+
+Status EncryptingUploadSession::WaitForSealing() {
+  if (!sealing_.valid()) return Status();
+  auto sealed = sealing_.get();
+  if (!sealed) return std::move(sealed).status();
+  ciphertext_ += *sealed;
+  return Status();
+}
+
+StatusOr<ResumableUploadResponse> EncryptingUploadSession::UploadSealed() {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto const size = ciphertext_.size() / quantum * quantum;
+  if (size == 0) {
+    // Not enough data to upload yet, the data is buffered until the next call.
+    return ResumableUploadResponse{session_->session_id(), uploaded_, {},
+                                   ResumableUploadResponse::kInProgress, {}};
+  }
+  auto response =
+      session_->UploadChunk({ConstBuffer(ciphertext_.data(), size)});
+  if (!response) return response;
+  uploaded_ += size;
+  ciphertext_.erase(0, size);
+  return response;
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> DecryptingObjectReadSource::Create(
+    ObjectReadSourceFactory const& open, ReadObjectRangeRequest const& request,
+    UnwrapKeyFunction const& unwrap, std::size_t thread_count) {
+  if (request.HasOption<ReadLast>()) {
+    return Status(StatusCode::kInvalidArgument,
+                  "DecryptingObjectReadSource::Create(): ReadLast is not "
+                  "supported for client-side encrypted objects");
+  }
+
+  // Download the header, which is at most `kMaxSize` bytes.
+  auto header_request = request;
+  header_request.set_option(ReadFromOffset());
+  header_request.set_option(ReadRange(
+      0, static_cast<std::int64_t>(EnvelopeEncryptionHeader::kMaxSize)));
+  auto header_source = open(header_request);
+  if (!header_source) return std::move(header_source).status();
+  std::string data;
+  std::multimap<std::string, std::string> headers;
+  std::vector<char> buffer(EnvelopeEncryptionHeader::kMaxSize);
+  for (;;) {
+    auto result = (*header_source)->Read(buffer.data(), buffer.size());
+    if (!result) return std::move(result).status();
+    data.append(buffer.data(), result->bytes_received);
+    headers.insert(result->response.headers.begin(),
+                   result->response.headers.end());
+    if (result->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+      return AsStatus(result->response);
+    }
+    if (result->response.status_code != HttpStatusCode::kContinue) break;
+  }
+  auto parsed = ParseEnvelopeEncryptionHeader(data);
+  if (!parsed) return std::move(parsed).status();
+  auto const& header = parsed->first;
+  auto const header_size = parsed->second;
+  auto key = unwrap(header.wrapped_key);
+  if (!key) return std::move(key).status();
+  if (key->size() != ChunkCipher::kKeySize) {
+    return Status(
+        StatusCode::kInvalidArgument,
+        "DecryptingObjectReadSource::Create(): invalid data key size");
+  }
+  ChunkCipher cipher(*std::move(key), header.nonce_prefix,
+                     data.substr(0, header_size));
+
+  // Download the chunks that contain the requested range, from the same
+  // generation as the header.
+  std::uint64_t const chunk_size = header.chunk_size;
+  auto const sealed_size = chunk_size + ChunkCipher::kTagSize;
+  auto const begin = static_cast<std::uint64_t>(request.StartingByte());
+  auto const first_index = begin / chunk_size;
+  absl::optional<std::uint64_t> limit;
+  auto chunks_request = request;
+  chunks_request.set_option(ReadFromOffset());
+  chunks_request.set_option(ReadRange());
+  if (!request.HasOption<Generation>()) {
+    auto g = headers.find("x-goog-generation");
+    if (g != headers.end()) {
+      chunks_request.set_option(Generation(std::stoll(g->second)));
+    }
+  }
+  auto const chunks_begin = header_size + first_index * sealed_size;
+  if (request.HasOption<ReadRange>()) {
+    auto const end = request.GetOption<ReadRange>().value().end;
+    if (end <= static_cast<std::int64_t>(begin)) {
+      return std::unique_ptr<ObjectReadSource>(new DecryptingObjectReadSource(
+          nullptr, std::move(cipher), chunk_size, first_index, 0, 0,
+          thread_count));
+    }
+    limit = static_cast<std::uint64_t>(end) - begin;
+    auto const last_index = (static_cast<std::uint64_t>(end) - 1) / chunk_size;
+    chunks_request.set_option(
+        ReadRange(static_cast<std::int64_t>(chunks_begin),
+                  static_cast<std::int64_t>(header_size +
+                                            (last_index + 1) * sealed_size)));
+  } else if (chunks_begin != 0) {
+    chunks_request.set_option(
+        ReadFromOffset(static_cast<std::int64_t>(chunks_begin)));
+  }
+  auto source = open(chunks_request);
+  if (!source) return std::move(source).status();
+  return std::unique_ptr<ObjectReadSource>(new DecryptingObjectReadSource(
+      *std::move(source), std::move(cipher), chunk_size, first_index,
+      static_cast<std::size_t>(begin % chunk_size), limit, thread_count));
+}
+
+DecryptingObjectReadSource::DecryptingObjectReadSource(
+    std::unique_ptr<ObjectReadSource> source, ChunkCipher cipher,
+    std::size_t chunk_size, std::uint64_t first_index, std::size_t skip,
+    absl::optional<std::uint64_t> limit, std::size_t thread_count)
+    : source_(std::move(source)),
+      cipher_(std::move(cipher)),
+      chunk_size_(chunk_size),
+      next_index_(first_index),
+      skip_(skip),
+      limit_(limit),
+      thread_count_((std::max<std::size_t>)(1, thread_count)),
+      finished_(!source_) {}
+
+bool DecryptingObjectReadSource::IsOpen() const {
+  return plaintext_offset_ < plaintext_.size() || !finished_;
+}
+
+StatusOr<HttpResponse> DecryptingObjectReadSource::Close() {
+  finished_ = true;
+  plaintext_.clear();
+  plaintext_offset_ = 0;
+  if (!source_ || !source_->IsOpen()) return final_response_;
+  return source_->Close();
+}
+
+StatusOr<ReadSourceResult> DecryptingObjectReadSource::Read(char* buf,
+                                                            std::size_t n) {
+  // Like the other sources, only return a short read at the end of the
+  // download.
+  std::size_t count = 0;
+  while (count < n) {
+    if (plaintext_offset_ == plaintext_.size()) {
+      if (finished_) break;
+      auto status = Refill();
+      if (!status.ok()) return status;
+      continue;
+    }
+    auto const size =
+        (std::min)(n - count, plaintext_.size() - plaintext_offset_);
+    std::copy(plaintext_.data() + plaintext_offset_,
+              plaintext_.data() + plaintext_offset_ + size, buf + count);
+    plaintext_offset_ += size;
+    count += size;
+  }
+
+  ReadSourceResult result{count,
+                          HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+  if (!IsOpen()) result.response = final_response_;
+  result.response.headers = std::move(headers_);
+  headers_.clear();
+  return result;
+}
+
+Status DecryptingObjectReadSource::Refill() {
+  // Download enough chunks to keep all the threads busy.
+  auto const sealed_size = chunk_size_ + ChunkCipher::kTagSize;
+  auto const batch_size = sealed_size * thread_count_;
+  bool eof = false;
+  while (ciphertext_.size() < batch_size) {
+    auto const offset = ciphertext_.size();
+    ciphertext_.resize(batch_size);
+    auto result = source_->Read(&ciphertext_[offset], batch_size - offset);
+    if (!result) {
+      ciphertext_.resize(offset);
+      return std::move(result).status();
+    }
+    ciphertext_.resize(offset + result->bytes_received);
+    // The checksums of the ciphertext are meaningless for the plaintext, the
+    // authentication tags already detect any corruption.
+    for (auto const& kv : result->response.headers) {
+      if (kv.first != "x-goog-hash") headers_.emplace(kv.first, kv.second);
+    }
+    if (result->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+      return AsStatus(result->response);
+    }
+    if (result->response.status_code != HttpStatusCode::kContinue) {
+      eof = true;
+      final_response_ = std::move(result->response);
+      final_response_.headers.clear();
+      break;
+    }
+  }
+
+  // A complete sealed chunk is never the last chunk of the object, the last
+  // chunk is always shorter. Any partial chunk stays in the buffer until the
+  // download completes.
+  auto const tail = ciphertext_.size() % sealed_size;
+  auto const includes_last = eof && tail != 0;
+  auto const size =
+      includes_last ? ciphertext_.size() : ciphertext_.size() - tail;
+  auto sealed = std::move(ciphertext_);
+  ciphertext_ = sealed.substr(size);
+  sealed.resize(size);
+  auto opened = cipher_.OpenChunks(next_index_, sealed, chunk_size_,
+                                   includes_last, thread_count_);
+  if (!opened) return std::move(opened).status();
+  next_index_ += size / sealed_size + (includes_last ? 1 : 0);
+
+  plaintext_ = *std::move(opened);
+  plaintext_offset_ = (std::min)(skip_, plaintext_.size());
+  skip_ -= plaintext_offset_;
+  if (limit_) {
+    auto const available = plaintext_.size() - plaintext_offset_;
+    if (available >= *limit_) {
+      plaintext_.resize(plaintext_offset_ + static_cast<std::size_t>(*limit_));
+      limit_ = 0;
+    } else {
+      *limit_ -= available;
+    }
+  }
+  if (limit_ && *limit_ == 0) {
+    // All the requested data is available, there is no need to wait for the
+    // download to complete.
+    finished_ = true;
+    if (!eof) (void)source_->Close();
+    return Status();
+  }
+  if (eof) {
+    finished_ = true;
+    // The download ended at a chunk boundary, without the last chunk.
+    if (!includes_last) {
+      return Status(StatusCode::kDataLoss,
+                    "DecryptingObjectReadSource::Refill(): the encrypted "
+                    "object is truncated");
+    }
+  }
+  return Status();
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
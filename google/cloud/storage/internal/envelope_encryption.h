@@ -0,0 +1,261 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ENVELOPE_ENCRYPTION_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ENVELOPE_ENCRYPTION_H
+
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include "google/cloud/storage/internal/object_streambuf.h"
+#include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status_or.h"
+#include "absl/types/optional.h"
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * The header stored at the beginning of each client-side encrypted object.
+ *
+ * Encrypted objects start with this header, followed by the plaintext split in
+ * chunks of `chunk_size` bytes, each sealed independently with AES-256-GCM.
+ * Each sealed chunk is the ciphertext followed by a 16-byte tag, so the chunks
+ * are at fixed offsets and can be decrypted in parallel, or in any order.
+ *
+ * The last chunk is always shorter than `chunk_size`, it is empty if the
+ * plaintext size is a multiple of `chunk_size`. The nonce for each chunk is
+ * `nonce_prefix` followed by the chunk index, and the associated data is the
+ * full header, the chunk index, and a flag set only for the last chunk. That
+ * detects reordered, truncated or extended objects, as well as changes to the
+ * header.
+ *
+ * The serialized header is:
+ * - the magic string `GCSCSE01`
+ * - the total header size (4 bytes, big-endian)
+ * - `chunk_size` (4 bytes, big-endian)
+ * - `nonce_prefix` (8 bytes)
+ * - the wrapped key size (4 bytes, big-endian)
+ * - `wrapped_key`
+ */
+struct EnvelopeEncryptionHeader {
+  static constexpr std::size_t kMaxSize = 4096;
+  static constexpr std::size_t kNoncePrefixSize = 8;
+
+  std::uint32_t chunk_size = 0;
+  std::string nonce_prefix;
+  std::string wrapped_key;
+};
+
+/// Serialize @p header, fails if the wrapped key is too large.
+StatusOr<std::string> SerializeEnvelopeEncryptionHeader(
+    EnvelopeEncryptionHeader const& header);
+
+/**
+ * Parse the header at the beginning of @p data.
+ *
+ * On success also returns the size of the header, which is where the first
+ * chunk starts.
+ */
+StatusOr<std::pair<EnvelopeEncryptionHeader, std::size_t>>
+ParseEnvelopeEncryptionHeader(std::string const& data);
+
+/// The size of an encrypted object with @p plaintext_size bytes of data.
+std::uint64_t EnvelopeEncryptedSize(std::size_t header_size,
+                                    std::size_t chunk_size,
+                                    std::uint64_t plaintext_size);
+
+/// Seals and opens the chunks of an encrypted object with AES-256-GCM.
+class ChunkCipher {
+ public:
+  static constexpr std::size_t kKeySize = 32;
+  static constexpr std::size_t kTagSize = 16;
+
+  /**
+   * Creates a cipher for the chunks of one object.
+   *
+   * @param key the data key, must be `kKeySize` bytes.
+   * @param nonce_prefix the first bytes of each nonce.
+   * @param header the serialized header, it is part of the associated data of
+   *     each chunk.
+   */
+  ChunkCipher(std::string key, std::string nonce_prefix, std::string header);
+
+  /// Encrypt @p size bytes from @p data into @p out, which needs room for the
+  /// ciphertext and the tag.
+  Status Seal(std::uint64_t index, bool last, char const* data,
+              std::size_t size, char* out) const;
+
+  /// Decrypt a sealed chunk of @p size bytes (including the tag) from @p data.
+  Status Open(std::uint64_t index, bool last, char const* data,
+              std::size_t size, char* out) const;
+
+  /**
+   * Seal a sequence of chunks, using up to @p thread_count threads.
+   *
+   * The data is split in chunks of @p chunk_size bytes, the first chunk has
+   * index @p first_index. If @p includes_last is true, the last chunk is sealed
+   * as the last chunk of the object, in which case it must be shorter than
+   * @p chunk_size (maybe empty). Otherwise @p size must be a multiple of
+   * @p chunk_size.
+   */
+  StatusOr<std::string> SealChunks(std::uint64_t first_index,
+                                   std::string const& data,
+                                   std::size_t chunk_size, bool includes_last,
+                                   std::size_t thread_count) const;
+
+  /**
+   * Open a sequence of sealed chunks, using up to @p thread_count threads.
+   *
+   * The @p data consists of sealed chunks of `chunk_size + kTagSize` bytes, if
+   * @p includes_last is true, the last sealed chunk is the (shorter) last chunk
+   * of the object.
+   */
+  StatusOr<std::string> OpenChunks(std::uint64_t first_index,
+                                   std::string const& data,
+                                   std::size_t chunk_size, bool includes_last,
+                                   std::size_t thread_count) const;
+
+ private:
+  std::string Nonce(std::uint64_t index) const;
+  std::string AssociatedDataSuffix(std::uint64_t index, bool last) const;
+
+  std::string key_;
+  std::string nonce_prefix_;
+  std::string header_;
+};
+
+/// Generates a new random data key and nonce prefix.
+StatusOr<std::pair<std::string, std::string>> CreateEnvelopeDataKey();
+
+/**
+ * Encrypts the data of an upload before it reaches the upload session.
+ *
+ * This decorator plugs under `ObjectWriteStreambuf`: the streambuf sees a
+ * session that accepts plaintext, and reports progress in plaintext bytes,
+ * while the wrapped session receives the header and the sealed chunks.
+ *
+ * Each call to `UploadChunk()` starts sealing the complete chunks in the new
+ * data on a background thread (which uses more threads to seal the chunks in
+ * parallel), and uploads the data sealed by the previous call while the
+ * encryption runs. The ciphertext is uploaded in multiples of the upload
+ * quantum, any leftover bytes are sent in the next call.
+ *
+ * Encrypted uploads cannot be resumed in a different process, the plaintext
+ * offsets reported by the session do not map to committed ciphertext bytes.
+ */
+class EncryptingUploadSession : public ResumableUploadSession {
+ public:
+  EncryptingUploadSession(std::unique_ptr<ResumableUploadSession> session,
+                          std::string header, ChunkCipher cipher,
+                          std::size_t chunk_size, std::size_t thread_count);
+  ~EncryptingUploadSession() override;
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> ResetSession() override;
+  std::uint64_t next_expected_byte() const override { return accepted_; }
+  std::string const& session_id() const override;
+  bool done() const override;
+  StatusOr<ResumableUploadResponse> const& last_response() const override;
+
+ private:
+  /// Wait for the pending encryption (if any) and queue its ciphertext.
+  Status WaitForSealing();
+  /// Upload the ciphertext, in multiples of the upload quantum.
+  StatusOr<ResumableUploadResponse> UploadSealed();
+
+  std::unique_ptr<ResumableUploadSession> session_;
+  ChunkCipher cipher_;
+  std::size_t chunk_size_;
+  std::size_t thread_count_;
+  std::string plaintext_;
+  std::string ciphertext_;
+  std::future<StatusOr<std::string>> sealing_;
+  std::uint64_t next_index_ = 0;
+  std::uint64_t accepted_ = 0;
+  std::uint64_t uploaded_ = 0;
+};
+
+/// Unwraps the data key of an encrypted object.
+using UnwrapKeyFunction =
+    std::function<StatusOr<std::string>(std::string const&)>;
+
+/**
+ * Decrypts a client-side encrypted object.
+ *
+ * This source plugs under `ObjectReadStreambuf`: it is created for a
+ * plaintext request, with `ReadFromOffset()` and `ReadRange()` in plaintext
+ * offsets, and uses @p open to download the header and the sealed chunks
+ * covering that range. The chunks are decrypted in batches of @p thread_count
+ * chunks, in parallel.
+ *
+ * The source removes the checksum headers of the ciphertext download, the
+ * data integrity is verified by the authentication tag of each chunk.
+ */
+class DecryptingObjectReadSource : public ObjectReadSource {
+ public:
+  static StatusOr<std::unique_ptr<ObjectReadSource>> Create(
+      ObjectReadSourceFactory const& open,
+      ReadObjectRangeRequest const& request, UnwrapKeyFunction const& unwrap,
+      std::size_t thread_count);
+
+  bool IsOpen() const override;
+  StatusOr<HttpResponse> Close() override;
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+
+ private:
+  DecryptingObjectReadSource(std::unique_ptr<ObjectReadSource> source,
+                             ChunkCipher cipher, std::size_t chunk_size,
+                             std::uint64_t first_index, std::size_t skip,
+                             absl::optional<std::uint64_t> limit,
+                             std::size_t thread_count);
+
+  /// Download and decrypt the next batch of chunks.
+  Status Refill();
+
+  std::unique_ptr<ObjectReadSource> source_;
+  ChunkCipher cipher_;
+  std::size_t chunk_size_;
+  std::uint64_t next_index_;
+  std::size_t skip_;
+  absl::optional<std::uint64_t> limit_;
+  std::size_t thread_count_;
+  std::string ciphertext_;
+  std::string plaintext_;
+  std::size_t plaintext_offset_ = 0;
+  std::multimap<std::string, std::string> headers_;
+  bool finished_ = false;
+  HttpResponse final_response_{HttpStatusCode::kOk, {}, {}};
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_ENVELOPE_ENCRYPTION_H
@@ -0,0 +1,487 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/envelope_encryption.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/random_names.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Invoke;
+using ::testing::ReturnRef;
+
+std::size_t const kChunkSize = 4096;
+
+std::string MakeData(std::size_t size) {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  return testing::MakeRandomData(generator, size);
+}
+
+EnvelopeEncryptionHeader TestHeader() {
+  EnvelopeEncryptionHeader header;
+  header.chunk_size = kChunkSize;
+  header.nonce_prefix = "01234567";
+  header.wrapped_key = "test-wrapped-key";
+  return header;
+}
+
+ChunkCipher TestCipher(std::string const& header) {
+  return ChunkCipher(std::string(ChunkCipher::kKeySize, 'k'), "01234567",
+                     header);
+}
+
+/// Serves the contents of an object, honoring the range in the request.
+class StringReadSource : public ObjectReadSource {
+ public:
+  StringReadSource(std::string data, std::size_t max_read)
+      : data_(std::move(data)), max_read_(max_read) {}
+
+  bool IsOpen() const override { return open_; }
+  StatusOr<HttpResponse> Close() override {
+    open_ = false;
+    return HttpResponse{HttpStatusCode::kOk, {}, {}};
+  }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const count = (std::min)({n, max_read_, data_.size() - offset_});
+    std::copy(data_.data() + offset_, data_.data() + offset_ + count, buf);
+    offset_ += count;
+    ReadSourceResult result{count,
+                            HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+    if (first_read_) {
+      result.response.headers.emplace("x-goog-generation", "42");
+      result.response.headers.emplace("x-goog-hash", "md5=invalid");
+      first_read_ = false;
+    }
+    if (offset_ == data_.size()) {
+      open_ = false;
+      result.response.status_code = HttpStatusCode::kOk;
+    }
+    return result;
+  }
+
+ private:
+  std::string data_;
+  std::size_t max_read_;
+  std::size_t offset_ = 0;
+  bool open_ = true;
+  bool first_read_ = true;
+};
+
+/// Returns a factory to read @p object, and records each request.
+ObjectReadSourceFactory MakeFactory(
+    std::string object, std::vector<ReadObjectRangeRequest>& requests) {
+  return [object, &requests](ReadObjectRangeRequest const& r)
+             -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+    requests.push_back(r);
+    auto const begin = static_cast<std::size_t>(r.StartingByte());
+    if (begin >= object.size()) {
+      return Status(StatusCode::kOutOfRange, "past the end");
+    }
+    auto end = object.size();
+    if (r.HasOption<ReadRange>()) {
+      end = (std::min)(
+          end, static_cast<std::size_t>(r.GetOption<ReadRange>().value().end));
+    }
+    return std::unique_ptr<ObjectReadSource>(
+        new StringReadSource(object.substr(begin, end - begin), 1000));
+  };
+}
+
+/// Read all the data from @p source.
+StatusOr<std::string> ReadAll(ObjectReadSource& source) {
+  std::string result;
+  std::vector<char> buffer(3000);
+  while (source.IsOpen()) {
+    auto r = source.Read(buffer.data(), buffer.size());
+    if (!r) return std::move(r).status();
+    EXPECT_EQ(0, r->response.headers.count("x-goog-hash"));
+    result.append(buffer.data(), r->bytes_received);
+  }
+  return result;
+}
+
+/// Create an encrypted object with @p plaintext.
+std::string EncryptObject(std::string const& plaintext) {
+  auto header = SerializeEnvelopeEncryptionHeader(TestHeader());
+  EXPECT_STATUS_OK(header);
+  auto sealed =
+      TestCipher(*header).SealChunks(0, plaintext, kChunkSize, true, 4);
+  EXPECT_STATUS_OK(sealed);
+  return *header + *sealed;
+}
+
+StatusOr<std::string> UnwrapTestKey(std::string const& wrapped) {
+  EXPECT_EQ("test-wrapped-key", wrapped);
+  return std::string(ChunkCipher::kKeySize, 'k');
+}
+
+TEST(EnvelopeEncryptionTest, HeaderRoundTrip) {
+  auto serialized = SerializeEnvelopeEncryptionHeader(TestHeader());
+  ASSERT_STATUS_OK(serialized);
+  EXPECT_EQ("GCSCSE01", serialized->substr(0, 8));
+
+  auto parsed = ParseEnvelopeEncryptionHeader(*serialized + "chunk data");
+  ASSERT_STATUS_OK(parsed);
+  EXPECT_EQ(serialized->size(), parsed->second);
+  EXPECT_EQ(kChunkSize, parsed->first.chunk_size);
+  EXPECT_EQ("01234567", parsed->first.nonce_prefix);
+  EXPECT_EQ("test-wrapped-key", parsed->first.wrapped_key);
+}
+
+TEST(EnvelopeEncryptionTest, HeaderErrors) {
+  auto header = TestHeader();
+  header.wrapped_key = std::string(EnvelopeEncryptionHeader::kMaxSize, 'w');
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            SerializeEnvelopeEncryptionHeader(header).status().code());
+
+  auto serialized = SerializeEnvelopeEncryptionHeader(TestHeader());
+  ASSERT_STATUS_OK(serialized);
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            ParseEnvelopeEncryptionHeader("plaintext").status().code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            ParseEnvelopeEncryptionHeader(serialized->substr(0, 20))
+                .status()
+                .code());
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            ParseEnvelopeEncryptionHeader(
+                serialized->substr(0, serialized->size() - 1))
+                .status()
+                .code());
+  auto zero_chunk = *serialized;
+  zero_chunk.replace(12, 4, std::string(4, '\0'));
+  EXPECT_EQ(StatusCode::kInvalidArgument,
+            ParseEnvelopeEncryptionHeader(zero_chunk).status().code());
+}
+
+TEST(EnvelopeEncryptionTest, EncryptedSize) {
+  auto const tag = ChunkCipher::kTagSize;
+  EXPECT_EQ(100 + tag, EnvelopeEncryptedSize(100, kChunkSize, 0));
+  EXPECT_EQ(100 + 10 + tag, EnvelopeEncryptedSize(100, kChunkSize, 10));
+  EXPECT_EQ(100 + kChunkSize + 2 * tag,
+            EnvelopeEncryptedSize(100, kChunkSize, kChunkSize));
+  EXPECT_EQ(100 + 2 * kChunkSize + 1 + 3 * tag,
+            EnvelopeEncryptedSize(100, kChunkSize, 2 * kChunkSize + 1));
+}
+
+TEST(EnvelopeEncryptionTest, SealOpenRoundTrip) {
+  auto const cipher = TestCipher("test-header");
+  for (auto size : {std::size_t{0}, std::size_t{1}, kChunkSize - 1, kChunkSize,
+                    7 * kChunkSize + 3, 16 * kChunkSize}) {
+    SCOPED_TRACE("Testing with size=" + std::to_string(size));
+    auto const plaintext = MakeData(size);
+    auto sealed = cipher.SealChunks(0, plaintext, kChunkSize, true, 4);
+    ASSERT_STATUS_OK(sealed);
+    EXPECT_EQ(EnvelopeEncryptedSize(0, kChunkSize, size), sealed->size());
+    auto opened = cipher.OpenChunks(0, *sealed, kChunkSize, true, 3);
+    ASSERT_STATUS_OK(opened);
+    EXPECT_EQ(plaintext, *opened);
+  }
+}
+
+TEST(EnvelopeEncryptionTest, SealInBatches) {
+  auto const cipher = TestCipher("test-header");
+  auto const plaintext = MakeData(5 * kChunkSize + 17);
+  auto const expected = cipher.SealChunks(0, plaintext, kChunkSize, true, 1);
+  ASSERT_STATUS_OK(expected);
+
+  auto first =
+      cipher.SealChunks(0, plaintext.substr(0, 3 * kChunkSize), kChunkSize,
+                        false, 2);
+  ASSERT_STATUS_OK(first);
+  auto last = cipher.SealChunks(3, plaintext.substr(3 * kChunkSize),
+                                kChunkSize, true, 2);
+  ASSERT_STATUS_OK(last);
+  EXPECT_EQ(*expected, *first + *last);
+
+  auto partial =
+      cipher.SealChunks(0, plaintext.substr(0, 10), kChunkSize, false, 2);
+  EXPECT_EQ(StatusCode::kInternal, partial.status().code());
+}
+
+TEST(EnvelopeEncryptionTest, DetectsModifications) {
+  auto const cipher = TestCipher("test-header");
+  auto const plaintext = MakeData(3 * kChunkSize + 100);
+  auto sealed = cipher.SealChunks(0, plaintext, kChunkSize, true, 4);
+  ASSERT_STATUS_OK(sealed);
+  auto const sealed_size = kChunkSize + ChunkCipher::kTagSize;
+
+  auto flipped = *sealed;
+  flipped[sealed_size + 10] ^= 0x01;
+  EXPECT_EQ(StatusCode::kDataLoss,
+            cipher.OpenChunks(0, flipped, kChunkSize, true, 4).status().code());
+
+  // Swap the first two chunks.
+  auto swapped = sealed->substr(sealed_size, sealed_size) +
+                 sealed->substr(0, sealed_size) +
+                 sealed->substr(2 * sealed_size);
+  EXPECT_EQ(StatusCode::kDataLoss,
+            cipher.OpenChunks(0, swapped, kChunkSize, true, 4).status().code());
+
+  // Drop the last chunk, the new last chunk is not marked as such.
+  auto truncated = sealed->substr(0, 2 * sealed_size);
+  EXPECT_EQ(
+      StatusCode::kDataLoss,
+      cipher.OpenChunks(0, truncated, kChunkSize, true, 4).status().code());
+  EXPECT_STATUS_OK(cipher.OpenChunks(0, truncated, kChunkSize, false, 4));
+
+  // A different header invalidates all the chunks.
+  auto const other = TestCipher("other-header");
+  EXPECT_EQ(StatusCode::kDataLoss,
+            other.OpenChunks(0, *sealed, kChunkSize, true, 4).status().code());
+}
+
+TEST(EnvelopeEncryptionTest, CreateDataKey) {
+  auto a = CreateEnvelopeDataKey();
+  ASSERT_STATUS_OK(a);
+  auto b = CreateEnvelopeDataKey();
+  ASSERT_STATUS_OK(b);
+  EXPECT_EQ(ChunkCipher::kKeySize, a->first.size());
+  EXPECT_EQ(EnvelopeEncryptionHeader::kNoncePrefixSize, a->second.size());
+  EXPECT_NE(a->first, b->first);
+}
+
+TEST(EnvelopeEncryptionTest, EncryptingUploadSession) {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto header = SerializeEnvelopeEncryptionHeader(TestHeader());
+  ASSERT_STATUS_OK(header);
+
+  std::string uploaded;
+  std::string const session_id = "test-session-id";
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, session_id()).WillRepeatedly(ReturnRef(session_id));
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillRepeatedly(Invoke([&](ConstBufferSequence const& buffers) {
+        auto const size = TotalBytes(buffers);
+        EXPECT_EQ(0, size % quantum);
+        for (auto const& b : buffers) uploaded.append(b.data(), b.size());
+        return make_status_or(ResumableUploadResponse{
+            session_id, uploaded.size() - 1, {},
+            ResumableUploadResponse::kInProgress, {}});
+      }));
+  EXPECT_CALL(*mock, UploadFinalChunk(_, _))
+      .WillOnce(Invoke(
+          [&](ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+            for (auto const& b : buffers) uploaded.append(b.data(), b.size());
+            EXPECT_EQ(uploaded.size(), upload_size);
+            return make_status_or(ResumableUploadResponse{
+                session_id, upload_size - 1, {},
+                ResumableUploadResponse::kDone, {}});
+          }));
+
+  EncryptingUploadSession tested(std::move(mock), *header, TestCipher(*header),
+                                 kChunkSize, 4);
+  auto const plaintext = MakeData(5 * quantum + 1234);
+  for (std::size_t offset = 0; offset + quantum <= plaintext.size();
+       offset += quantum) {
+    auto response =
+        tested.UploadChunk({ConstBuffer(plaintext.data() + offset, quantum)});
+    ASSERT_STATUS_OK(response);
+    EXPECT_EQ(offset + quantum, tested.next_expected_byte());
+  }
+  auto response = tested.UploadFinalChunk(
+      {ConstBuffer(plaintext.data() + 5 * quantum, 1234)}, plaintext.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(plaintext.size(), tested.next_expected_byte());
+  EXPECT_EQ(EnvelopeEncryptedSize(header->size(), kChunkSize, plaintext.size()),
+            uploaded.size());
+  EXPECT_EQ(EncryptObject(plaintext), uploaded);
+}
+
+TEST(EnvelopeEncryptionTest, EncryptingUploadSessionError) {
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  auto header = SerializeEnvelopeEncryptionHeader(TestHeader());
+  ASSERT_STATUS_OK(header);
+  std::string const session_id = "test-session-id";
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, session_id()).WillRepeatedly(ReturnRef(session_id));
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillOnce(Invoke([](ConstBufferSequence const&) {
+        return StatusOr<ResumableUploadResponse>(PermanentError());
+      }));
+  EncryptingUploadSession tested(std::move(mock), *header, TestCipher(*header),
+                                 kChunkSize, 4);
+  auto const plaintext = MakeData(2 * quantum);
+  // The first call only starts the encryption, there is nothing to upload.
+  auto response = tested.UploadChunk({ConstBuffer(plaintext.data(), quantum)});
+  ASSERT_STATUS_OK(response);
+  response =
+      tested.UploadChunk({ConstBuffer(plaintext.data() + quantum, quantum)});
+  EXPECT_EQ(PermanentError().code(), response.status().code());
+}
+
+TEST(EnvelopeEncryptionTest, DecryptFullObject) {
+  for (auto size : {std::size_t{0}, std::size_t{10}, kChunkSize,
+                    10 * kChunkSize + 7}) {
+    SCOPED_TRACE("Testing with size=" + std::to_string(size));
+    auto const plaintext = MakeData(size);
+    std::vector<ReadObjectRangeRequest> requests;
+    auto source = DecryptingObjectReadSource::Create(
+        MakeFactory(EncryptObject(plaintext), requests),
+        ReadObjectRangeRequest("test-bucket", "test-object"), UnwrapTestKey,
+        4);
+    ASSERT_STATUS_OK(source);
+    auto actual = ReadAll(**source);
+    ASSERT_STATUS_OK(actual);
+    EXPECT_EQ(plaintext, *actual);
+
+    // The chunks are read from the same generation as the header.
+    ASSERT_EQ(2, requests.size());
+    EXPECT_FALSE(requests[0].HasOption<Generation>());
+    EXPECT_EQ(42, requests[1].GetOption<Generation>().value());
+  }
+}
+
+TEST(EnvelopeEncryptionTest, DecryptRanges) {
+  auto const plaintext = MakeData(10 * kChunkSize + 7);
+  auto const object = EncryptObject(plaintext);
+  std::vector<ReadObjectRangeRequest> requests;
+  auto factory = MakeFactory(object, requests);
+  struct {
+    std::int64_t begin;
+    std::int64_t end;
+  } cases[] = {
+      {0, 1},
+      {5, 100},
+      {kChunkSize - 1, kChunkSize + 1},
+      {kChunkSize, 2 * kChunkSize},
+      {3 * kChunkSize + 9, 7 * kChunkSize + 11},
+      {10 * kChunkSize, 10 * kChunkSize + 7},
+      {9 * kChunkSize, 20 * kChunkSize},
+  };
+  for (auto const& c : cases) {
+    SCOPED_TRACE("Testing with [" + std::to_string(c.begin) + "," +
+                 std::to_string(c.end) + ")");
+    auto source = DecryptingObjectReadSource::Create(
+        factory,
+        ReadObjectRangeRequest("test-bucket", "test-object")
+            .set_option(ReadRange(c.begin, c.end)),
+        UnwrapTestKey, 3);
+    ASSERT_STATUS_OK(source);
+    auto actual = ReadAll(**source);
+    ASSERT_STATUS_OK(actual);
+    auto const end = (std::min<std::size_t>)(c.end, plaintext.size());
+    EXPECT_EQ(plaintext.substr(c.begin, end - c.begin), *actual);
+  }
+
+  for (std::size_t offset : {std::size_t{1}, kChunkSize, 5 * kChunkSize + 3,
+                             plaintext.size()}) {
+    SCOPED_TRACE("Testing with offset=" + std::to_string(offset));
+    auto source = DecryptingObjectReadSource::Create(
+        factory,
+        ReadObjectRangeRequest("test-bucket", "test-object")
+            .set_option(ReadFromOffset(offset)),
+        UnwrapTestKey, 3);
+    ASSERT_STATUS_OK(source);
+    auto actual = ReadAll(**source);
+    ASSERT_STATUS_OK(actual);
+    EXPECT_EQ(plaintext.substr(offset), *actual);
+  }
+
+  // Only the chunks containing the range are downloaded.
+  requests.clear();
+  auto source = DecryptingObjectReadSource::Create(
+      factory,
+      ReadObjectRangeRequest("test-bucket", "test-object")
+          .set_option(ReadRange(2 * kChunkSize + 1, 3 * kChunkSize)),
+      UnwrapTestKey, 3);
+  ASSERT_STATUS_OK(source);
+  ASSERT_EQ(2, requests.size());
+  auto const header_size =
+      SerializeEnvelopeEncryptionHeader(TestHeader()).value().size();
+  auto const sealed_size = kChunkSize + ChunkCipher::kTagSize;
+  auto const range = requests[1].GetOption<ReadRange>().value();
+  EXPECT_EQ(header_size + 2 * sealed_size, range.begin);
+  EXPECT_EQ(header_size + 3 * sealed_size, range.end);
+}
+
+TEST(EnvelopeEncryptionTest, DecryptTruncated) {
+  auto const plaintext = MakeData(4 * kChunkSize);
+  auto const object = EncryptObject(plaintext);
+  auto const sealed_size = kChunkSize + ChunkCipher::kTagSize;
+  // Truncate at a chunk boundary, and in the middle of a chunk.
+  for (auto drop : {ChunkCipher::kTagSize, sealed_size + ChunkCipher::kTagSize,
+                    std::size_t{100}}) {
+    SCOPED_TRACE("Testing with drop=" + std::to_string(drop));
+    std::vector<ReadObjectRangeRequest> requests;
+    auto source = DecryptingObjectReadSource::Create(
+        MakeFactory(object.substr(0, object.size() - drop), requests),
+        ReadObjectRangeRequest("test-bucket", "test-object"), UnwrapTestKey,
+        2);
+    ASSERT_STATUS_OK(source);
+    auto actual = ReadAll(**source);
+    EXPECT_EQ(StatusCode::kDataLoss, actual.status().code());
+  }
+}
+
+TEST(EnvelopeEncryptionTest, DecryptErrors) {
+  std::vector<ReadObjectRangeRequest> requests;
+  auto not_encrypted = DecryptingObjectReadSource::Create(
+      MakeFactory(MakeData(1000), requests),
+      ReadObjectRangeRequest("test-bucket", "test-object"), UnwrapTestKey, 2);
+  EXPECT_EQ(StatusCode::kInvalidArgument, not_encrypted.status().code());
+
+  auto const object = EncryptObject(MakeData(1000));
+  auto unwrap_error = DecryptingObjectReadSource::Create(
+      MakeFactory(object, requests),
+      ReadObjectRangeRequest("test-bucket", "test-object"),
+      [](std::string const&) -> StatusOr<std::string> {
+        return PermanentError();
+      },
+      2);
+  EXPECT_EQ(PermanentError().code(), unwrap_error.status().code());
+
+  auto bad_key = DecryptingObjectReadSource::Create(
+      MakeFactory(object, requests),
+      ReadObjectRangeRequest("test-bucket", "test-object"),
+      [](std::string const&) -> StatusOr<std::string> {
+        return std::string(ChunkCipher::kKeySize, 'x');
+      },
+      2);
+  ASSERT_STATUS_OK(bad_key);
+  EXPECT_EQ(StatusCode::kDataLoss, ReadAll(**bad_key).status().code());
+
+  auto read_last = DecryptingObjectReadSource::Create(
+      MakeFactory(object, requests),
+      ReadObjectRangeRequest("test-bucket", "test-object")
+          .set_option(ReadLast(10)),
+      UnwrapTestKey, 2);
+  EXPECT_EQ(StatusCode::kInvalidArgument, read_last.status().code());
+
+  auto open_error = DecryptingObjectReadSource::Create(
+      [](ReadObjectRangeRequest const&)
+          -> StatusOr<std::unique_ptr<ObjectReadSource>> {
+        return PermanentError();
+      },
+      ReadObjectRangeRequest("test-bucket", "test-object"), UnwrapTestKey, 2);
+  EXPECT_EQ(PermanentError().code(), open_error.status().code());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
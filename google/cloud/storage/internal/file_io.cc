@@ -0,0 +1,298 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/file_io.h"
+#include "absl/memory/memory.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+#ifdef _WIN32
+using OffsetType = __int64;
+
+int OpenFile(std::string const& file_name, int flags) {
+  return ::_open(file_name.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+int CloseFile(int fd) { return ::_close(fd); }
+bool IsSeekable(int fd) {
+  struct _stat64 st;
+  return ::_fstat64(fd, &st) == 0 && (st.st_mode & _S_IFREG) != 0;
+}
+std::int64_t ReadAt(int fd, char* data, std::size_t size, OffsetType offset,
+                    bool seekable) {
+  if (seekable && ::_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+  return ::_read(fd, data, static_cast<unsigned>(size));
+}
+std::int64_t WriteAt(int fd, char const* data, std::size_t size,
+                     OffsetType offset, bool seekable) {
+  if (seekable && ::_lseeki64(fd, offset, SEEK_SET) < 0) return -1;
+  return ::_write(fd, data, static_cast<unsigned>(size));
+}
+int const kReadFlags = _O_RDONLY;
+int const kWriteFlags = _O_WRONLY | _O_CREAT;
+int const kTruncateFlag = _O_TRUNC;
+int TruncateFile(int fd, std::uint64_t size) {
+  return ::_chsize_s(fd, static_cast<OffsetType>(size));
+}
+#else
+using OffsetType = off_t;
+
+int OpenFile(std::string const& file_name, int flags) {
+  return ::open(file_name.c_str(), flags, 0666);
+}
+int CloseFile(int fd) { return ::close(fd); }
+bool IsSeekable(int fd) {
+  struct stat st;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+  return ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+}
+std::int64_t ReadAt(int fd, char* data, std::size_t size, OffsetType offset,
+                    bool seekable) {
+  if (!seekable) return ::read(fd, data, size);
+  return ::pread(fd, data, size, offset);
+}
+std::int64_t WriteAt(int fd, char const* data, std::size_t size,
+                     OffsetType offset, bool seekable) {
+  if (!seekable) return ::write(fd, data, size);
+  return ::pwrite(fd, data, size, offset);
+}
+int const kReadFlags = O_RDONLY | O_CLOEXEC;
+int const kWriteFlags = O_WRONLY | O_CREAT | O_CLOEXEC;
+int const kTruncateFlag = O_TRUNC;
+int TruncateFile(int fd, std::uint64_t size) {
+  return ::ftruncate(fd, static_cast<OffsetType>(size));
+}
+#endif  // _WIN32
+
+class BlockingFileWriter : public FileWriter {
+ public:
+  BlockingFileWriter(std::string file_name, int fd, std::size_t buffer_size,
+                     std::uint64_t offset)
+      : file_name_(std::move(file_name)),
+        fd_(fd),
+        seekable_(IsSeekable(fd)),
+        buffer_(buffer_size),
+        offset_(offset) {}
+
+  ~BlockingFileWriter() override { (void)Close(); }
+
+  Status Write(char const* data, std::size_t size) override {
+    if (!status_.ok()) return status_;
+    // Coalesce small writes in the buffer, but write large blocks directly,
+    // there is no reason to copy them.
+    if (fill_ + size <= buffer_.size()) {
+      std::memcpy(buffer_.data() + fill_, data, size);
+      fill_ += size;
+      if (fill_ == buffer_.size()) return Flush();
+      return status_;
+    }
+    auto status = Flush();
+    if (!status.ok()) return status;
+    if (size < buffer_.size()) return Write(data, size);
+    return WriteAll(data, size);
+  }
+
+  Status Flush() override {
+    auto const fill = fill_;
+    fill_ = 0;
+    return WriteAll(buffer_.data(), fill);
+  }
+
+  Status Close() override {
+    if (fd_ < 0) return status_;
+    auto status = Flush();
+    if (CloseFile(fd_) != 0 && status.ok()) {
+      status_ = FileIoError(errno, "close()", file_name_);
+    }
+    fd_ = -1;
+    return status_;
+  }
+
+ private:
+  Status WriteAll(char const* data, std::size_t size) {
+    while (status_.ok() && size != 0) {
+      auto const n =
+          WriteAt(fd_, data, size, static_cast<OffsetType>(offset_), seekable_);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) return status_ = FileIoError(errno, "write()", file_name_);
+      data += n;
+      size -= static_cast<std::size_t>(n);
+      offset_ += static_cast<std::uint64_t>(n);
+    }
+    return status_;
+  }
+
+  std::string file_name_;
+  int fd_;
+  bool seekable_;
+  std::vector<char> buffer_;
+  std::size_t fill_ = 0;
+  std::uint64_t offset_ = 0;
+  Status status_;
+};
+
+class BlockingFileReader : public FileReader {
+ public:
+  BlockingFileReader(std::string file_name, int fd)
+      : file_name_(std::move(file_name)), fd_(fd), seekable_(IsSeekable(fd)) {}
+
+  ~BlockingFileReader() override { CloseFile(fd_); }
+
+  StatusOr<std::size_t> Read(char* data, std::size_t size) override {
+    std::size_t total = 0;
+    while (total != size) {
+      auto const n = ReadAt(fd_, data + total, size - total,
+                            static_cast<OffsetType>(offset_), seekable_);
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0) return FileIoError(errno, "read()", file_name_);
+      if (n == 0) break;
+      total += static_cast<std::size_t>(n);
+      offset_ += static_cast<std::uint64_t>(n);
+    }
+    return total;
+  }
+
+  Status Seek(std::uint64_t offset) override {
+    if (seekable_) {
+      offset_ = offset;
+      return Status();
+    }
+    // Non-seekable files can only skip forward, by discarding data.
+    if (offset < offset_) {
+      return Status(StatusCode::kInvalidArgument,
+                    "cannot seek backwards in non-seekable file " + file_name_);
+    }
+    std::vector<char> discard(64 * 1024);
+    while (offset_ != offset) {
+      auto const count = static_cast<std::size_t>(
+          (std::min)(offset - offset_, std::uint64_t{discard.size()}));
+      auto n = Read(discard.data(), count);
+      if (!n) return std::move(n).status();
+      if (*n < count) {
+        return Status(StatusCode::kOutOfRange,
+                      "seek past the end of file " + file_name_);
+      }
+    }
+    return Status();
+  }
+
+  std::uint64_t offset() const override { return offset_; }
+
+ private:
+  std::string file_name_;
+  int fd_;
+  bool seekable_;
+  std::uint64_t offset_ = 0;
+};
+
+class BlockingFileIoBackend : public FileIoBackend {
+ public:
+  explicit BlockingFileIoBackend(FileIoConfig config) : config_(config) {}
+
+  StatusOr<std::unique_ptr<FileWriter>> OpenForWrite(
+      std::string const& file_name, std::uint64_t offset) override {
+    auto const fd =
+        OpenFile(file_name, kWriteFlags | (offset == 0 ? kTruncateFlag : 0));
+    if (fd < 0) return FileIoError(errno, "open()", file_name);
+    if (offset != 0) {
+      // Only regular files can be truncated and written at an offset.
+      auto const error = !IsSeekable(fd)                  ? ESPIPE
+                         : TruncateFile(fd, offset) != 0 ? errno
+                                                          : 0;
+      if (error != 0) {
+        CloseFile(fd);
+        return FileIoError(error, "ftruncate()", file_name);
+      }
+    }
+    return std::unique_ptr<FileWriter>(absl::make_unique<BlockingFileWriter>(
+        file_name, fd, config_.buffer_size, offset));
+  }
+
+  StatusOr<std::unique_ptr<FileReader>> OpenForRead(
+      std::string const& file_name, std::uint64_t offset) override {
+    auto const fd = OpenFile(file_name, kReadFlags);
+    if (fd < 0) return FileIoError(errno, "open()", file_name);
+    auto reader = absl::make_unique<BlockingFileReader>(file_name, fd);
+    auto status = reader->Seek(offset);
+    if (!status.ok()) return status;
+    return std::unique_ptr<FileReader>(std::move(reader));
+  }
+
+ private:
+  FileIoConfig config_;
+};
+
+}  // namespace
+
+std::shared_ptr<FileIoBackend> CreateBlockingFileIoBackend(
+    FileIoConfig config) {
+  return std::make_shared<BlockingFileIoBackend>(config);
+}
+
+std::shared_ptr<FileIoBackend> CreateFileIoBackend(
+    FileIoOptions const& options) {
+  FileIoConfig config;
+  config.buffer_size = options.buffer_size();
+  config.queue_depth = options.queue_depth();
+  config.direct_io = options.direct_io();
+  if (options.enable_io_uring() && IoUringAvailable()) {
+    return CreateIoUringFileIoBackend(config);
+  }
+  return CreateBlockingFileIoBackend(config);
+}
+
+Status FileIoError(int errnum, char const* where,
+                   std::string const& file_name) {
+  auto code = StatusCode::kUnknown;
+  switch (errnum) {
+    case ENOENT:
+      code = StatusCode::kNotFound;
+      break;
+    case EACCES:
+    case EPERM:
+      code = StatusCode::kPermissionDenied;
+      break;
+    case ENOSPC:
+      code = StatusCode::kResourceExhausted;
+      break;
+    case EISDIR:
+    case EINVAL:
+      code = StatusCode::kInvalidArgument;
+      break;
+    default:
+      break;
+  }
+  return Status(code, std::string(where) + " failed for " + file_name + ": " +
+                          std::strerror(errnum));
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
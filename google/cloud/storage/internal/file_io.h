@@ -0,0 +1,165 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FILE_IO_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FILE_IO_H
+
+#include "google/cloud/storage/client_options.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/// Configure the buffers used by a `FileIoBackend`.
+struct FileIoConfig {
+  /// The size of each I/O buffer. Rounded up to a multiple of 4KiB.
+  std::size_t buffer_size = 1024 * 1024;
+
+  /// The maximum number of buffers with I/O operations in flight.
+  std::size_t queue_depth = 4;
+
+  /**
+   * Bypass the page cache (`O_DIRECT`) if the backend and file system support
+   * it. Backends that cannot use direct I/O silently ignore this option.
+   */
+  bool direct_io = false;
+};
+
+/**
+ * Write a file sequentially, as used by `Client::DownloadToFile()`.
+ *
+ * Implementations may copy the data and write it asynchronously, therefore
+ * errors may be reported by a later `Write()` call or by `Close()`.
+ */
+class FileWriter {
+ public:
+  virtual ~FileWriter() = default;
+
+  /// Append @p size bytes to the file.
+  virtual Status Write(char const* data, std::size_t size) = 0;
+
+  /**
+   * Wait until all the data passed to `Write()` is written to the file.
+   *
+   * After this function returns successfully the data survives a crash of the
+   * process, though not necessarily a crash of the operating system.
+   */
+  virtual Status Flush() = 0;
+
+  /// Wait for any pending writes and close the file.
+  virtual Status Close() = 0;
+};
+
+/**
+ * Read a file sequentially, as used by `Client::UploadFile()`.
+ *
+ * Implementations may read ahead of the current position.
+ */
+class FileReader {
+ public:
+  virtual ~FileReader() = default;
+
+  /**
+   * Read up to @p size bytes into @p data.
+   *
+   * Returns the number of bytes read, which is smaller than @p size only at
+   * the end of the file.
+   */
+  virtual StatusOr<std::size_t> Read(char* data, std::size_t size) = 0;
+
+  /// Move the read position to @p offset bytes from the start of the file.
+  virtual Status Seek(std::uint64_t offset) = 0;
+
+  /// The current read position.
+  virtual std::uint64_t offset() const = 0;
+};
+
+/**
+ * Create readers and writers for the files used in uploads and downloads.
+ *
+ * Applications can configure the backend used by `storage::Client` via
+ * `ClientOptions::set_file_io_options()`.
+ */
+class FileIoBackend {
+ public:
+  virtual ~FileIoBackend() = default;
+
+  /**
+   * Create @p file_name if needed and return a writer starting at @p offset.
+   *
+   * The file is truncated to @p offset bytes. Only regular files support
+   * values other than `0`.
+   */
+  virtual StatusOr<std::unique_ptr<FileWriter>> OpenForWrite(
+      std::string const& file_name, std::uint64_t offset) = 0;
+
+  /// Open @p file_name and return a reader starting at @p offset.
+  virtual StatusOr<std::unique_ptr<FileReader>> OpenForRead(
+      std::string const& file_name, std::uint64_t offset) = 0;
+};
+
+/**
+ * A backend using blocking `pread(2)` and `pwrite(2)` calls.
+ *
+ * Small writes are coalesced into a buffer of `config.buffer_size` bytes. This
+ * backend works with any file type, including pipes and other non-seekable
+ * files.
+ */
+std::shared_ptr<FileIoBackend> CreateBlockingFileIoBackend(
+    FileIoConfig config = {});
+
+/**
+ * A backend using `io_uring(7)` to overlap file I/O with network I/O.
+ *
+ * Each reader or writer uses its own ring with `config.queue_depth` buffers,
+ * registered with the kernel to avoid per-operation page mapping. Writes are
+ * copied to a free buffer and submitted in batches, readers keep up to
+ * `config.queue_depth` reads in flight ahead of the current position.
+ *
+ * If `io_uring` is not available, either at compile-time or at run-time, or
+ * the file is not a regular file, the backend falls back to the blocking
+ * implementation.
+ */
+std::shared_ptr<FileIoBackend> CreateIoUringFileIoBackend(
+    FileIoConfig config = {});
+
+/// Return true if `io_uring` can be used in this process.
+bool IoUringAvailable();
+
+/**
+ * The backend used by `storage::Client` for the given @p options.
+ *
+ * This is the blocking backend unless the application enables `io_uring`.
+ */
+std::shared_ptr<FileIoBackend> CreateFileIoBackend(
+    FileIoOptions const& options);
+
+/// Create a `Status` from an `errno` value.
+Status FileIoError(int errnum, char const* where, std::string const& file_name);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_FILE_IO_H
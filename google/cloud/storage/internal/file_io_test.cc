@@ -0,0 +1,215 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/file_io.h"
+#include "google/cloud/storage/testing/random_names.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <fstream>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::TempFile;
+
+enum class BackendType { kBlocking, kIoUring, kIoUringDirect };
+
+std::shared_ptr<FileIoBackend> MakeBackend(BackendType type) {
+  // Use small buffers so the tests exercise several buffers in flight.
+  FileIoConfig config;
+  config.buffer_size = 8 * 1024;
+  config.queue_depth = 3;
+  switch (type) {
+    case BackendType::kBlocking:
+      return CreateBlockingFileIoBackend(config);
+    case BackendType::kIoUring:
+      return CreateIoUringFileIoBackend(config);
+    case BackendType::kIoUringDirect:
+      config.direct_io = true;
+      return CreateIoUringFileIoBackend(config);
+  }
+  return nullptr;
+}
+
+std::string RandomData(google::cloud::internal::DefaultPRNG& generator,
+                       std::size_t size) {
+  return google::cloud::internal::Sample(
+      generator, static_cast<int>(size),
+      "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+}
+
+std::string ReadWithStream(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>(is), {}};
+}
+
+class FileIoTest : public ::testing::TestWithParam<BackendType> {
+ protected:
+  google::cloud::internal::DefaultPRNG generator_ =
+      google::cloud::internal::MakeDefaultPRNG();
+};
+
+TEST_P(FileIoTest, WriteVariousSizes) {
+  auto backend = MakeBackend(GetParam());
+  for (std::size_t size : {0, 1, 4095, 4096, 8191, 8192, 8193, 100000}) {
+    SCOPED_TRACE("Testing with size=" + std::to_string(size));
+    TempFile file("");
+    auto const expected = RandomData(generator_, size);
+    auto writer = backend->OpenForWrite(file.name(), 0);
+    ASSERT_STATUS_OK(writer);
+    // Write the data in irregular pieces to exercise the buffering.
+    std::uniform_int_distribution<std::size_t> piece(1, 20000);
+    for (std::size_t offset = 0; offset < expected.size();) {
+      auto n = (std::min)(piece(generator_), expected.size() - offset);
+      ASSERT_STATUS_OK((*writer)->Write(expected.data() + offset, n));
+      offset += n;
+    }
+    ASSERT_STATUS_OK((*writer)->Close());
+    EXPECT_EQ(expected, ReadWithStream(file.name()));
+  }
+}
+
+TEST_P(FileIoTest, ReadVariousSizes) {
+  auto backend = MakeBackend(GetParam());
+  for (std::size_t size : {0, 1, 4095, 4096, 8191, 8192, 8193, 100000}) {
+    SCOPED_TRACE("Testing with size=" + std::to_string(size));
+    auto const expected = RandomData(generator_, size);
+    TempFile file(expected);
+    auto reader = backend->OpenForRead(file.name(), 0);
+    ASSERT_STATUS_OK(reader);
+    std::string actual;
+    std::uniform_int_distribution<std::size_t> piece(1, 20000);
+    for (;;) {
+      std::vector<char> buffer(piece(generator_));
+      auto n = (*reader)->Read(buffer.data(), buffer.size());
+      ASSERT_STATUS_OK(n);
+      actual.append(buffer.data(), *n);
+      if (*n < buffer.size()) break;
+    }
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(size, (*reader)->offset());
+  }
+}
+
+TEST_P(FileIoTest, ReadFromOffsetAndSeek) {
+  auto backend = MakeBackend(GetParam());
+  auto const contents = RandomData(generator_, 50000);
+  TempFile file(contents);
+
+  auto reader = backend->OpenForRead(file.name(), 12345);
+  ASSERT_STATUS_OK(reader);
+  EXPECT_EQ(12345, (*reader)->offset());
+  std::vector<char> buffer(1000);
+  auto n = (*reader)->Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ(contents.substr(12345, 1000), std::string(buffer.data(), *n));
+
+  // Seek backwards, discarding any read-ahead data.
+  ASSERT_STATUS_OK((*reader)->Seek(10));
+  n = (*reader)->Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ(contents.substr(10, 1000), std::string(buffer.data(), *n));
+
+  // Seek forward, close to the end of the file.
+  ASSERT_STATUS_OK((*reader)->Seek(49500));
+  n = (*reader)->Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(n);
+  EXPECT_EQ(contents.substr(49500), std::string(buffer.data(), *n));
+  EXPECT_EQ(50000, (*reader)->offset());
+}
+
+TEST_P(FileIoTest, WriteAtOffsetAndFlush) {
+  auto backend = MakeBackend(GetParam());
+  auto const contents = RandomData(generator_, 50000);
+  auto const data = RandomData(generator_, 30000);
+  for (std::uint64_t offset : {4096, 12345}) {
+    SCOPED_TRACE("Testing with offset=" + std::to_string(offset));
+    TempFile file(contents);
+    auto writer = backend->OpenForWrite(file.name(), offset);
+    ASSERT_STATUS_OK(writer);
+    auto const expected = contents.substr(0, offset) + data;
+    ASSERT_STATUS_OK((*writer)->Write(data.data(), 10000));
+    ASSERT_STATUS_OK((*writer)->Flush());
+    // The data is in the file before it is closed, any data past the new
+    // data was discarded.
+    EXPECT_EQ(expected.substr(0, offset + 10000),
+              ReadWithStream(file.name()).substr(0, offset + 10000));
+    EXPECT_LE(ReadWithStream(file.name()).size(), offset + 12288);
+    ASSERT_STATUS_OK((*writer)->Write(data.data() + 10000, 20000));
+    ASSERT_STATUS_OK((*writer)->Close());
+    EXPECT_EQ(expected, ReadWithStream(file.name()));
+  }
+}
+
+TEST_P(FileIoTest, OpenMissingFile) {
+  auto backend = MakeBackend(GetParam());
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  auto const file_name = ::testing::TempDir() + "missing-directory/" +
+                         testing::MakeRandomFileName(generator);
+  auto reader = backend->OpenForRead(file_name, 0);
+  ASSERT_FALSE(reader);
+  EXPECT_EQ(StatusCode::kNotFound, reader.status().code());
+  EXPECT_THAT(reader.status().message(), ::testing::HasSubstr(file_name));
+
+  auto writer = backend->OpenForWrite(file_name, 0);
+  ASSERT_FALSE(writer);
+  EXPECT_EQ(StatusCode::kNotFound, writer.status().code());
+}
+
+TEST_P(FileIoTest, DestructorFlushes) {
+  auto backend = MakeBackend(GetParam());
+  auto const expected = RandomData(generator_, 30000);
+  TempFile file("");
+  {
+    auto writer = backend->OpenForWrite(file.name(), 0);
+    ASSERT_STATUS_OK(writer);
+    ASSERT_STATUS_OK((*writer)->Write(expected.data(), expected.size()));
+  }
+  EXPECT_EQ(expected, ReadWithStream(file.name()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Blocking, FileIoTest,
+                         ::testing::Values(BackendType::kBlocking));
+INSTANTIATE_TEST_SUITE_P(IoUring, FileIoTest,
+                         ::testing::Values(BackendType::kIoUring,
+                                           BackendType::kIoUringDirect));
+
+TEST(FileIoErrorTest, MapsErrno) {
+  EXPECT_EQ(StatusCode::kNotFound, FileIoError(ENOENT, "open()", "f").code());
+  EXPECT_EQ(StatusCode::kPermissionDenied,
+            FileIoError(EACCES, "open()", "f").code());
+  EXPECT_EQ(StatusCode::kResourceExhausted,
+            FileIoError(ENOSPC, "write()", "f").code());
+  EXPECT_EQ(StatusCode::kUnknown, FileIoError(EIO, "read()", "f").code());
+}
+
+TEST(FileIoBackendTest, CreateFromOptions) {
+  EXPECT_NE(nullptr, CreateFileIoBackend(FileIoOptions{}));
+  EXPECT_NE(nullptr,
+            CreateFileIoBackend(FileIoOptions{}.set_enable_io_uring(true)));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -346,6 +346,25 @@ StatusOr<EmptyResponse> GrpcClient::DeleteResumableUpload(
   return Status(StatusCode::kUnimplemented, __func__);
 }
 
+StatusOr<CreateMultipartUploadResponse> GrpcClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const&) {
+  return Status(StatusCode::kUnimplemented, __func__);
+}
+
+StatusOr<UploadPartResponse> GrpcClient::UploadPart(UploadPartRequest const&) {
+  return Status(StatusCode::kUnimplemented, __func__);
+}
+
+StatusOr<CompleteMultipartUploadResponse> GrpcClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const&) {
+  return Status(StatusCode::kUnimplemented, __func__);
+}
+
+StatusOr<EmptyResponse> GrpcClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const&) {
+  return Status(StatusCode::kUnimplemented, __func__);
+}
+
 StatusOr<ListBucketAclResponse> GrpcClient::ListBucketAcl(
     ListBucketAclRequest const&) {
   return Status(StatusCode::kUnimplemented, __func__);
@@ -1459,7 +1478,7 @@ google::storage::v1::GetObjectMediaRequest GrpcClient::ToProto(
     auto const offset = request.GetOption<ReadFromOffset>().value();
     if (offset > r.read_offset()) {
       if (r.read_limit() > 0) {
-        r.set_read_limit(offset - r.read_offset());
+        r.set_read_limit(r.read_limit() - (offset - r.read_offset()));
       }
       r.set_read_offset(offset);
     }
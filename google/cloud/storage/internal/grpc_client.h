@@ -104,6 +104,14 @@ class GrpcClient : public RawClient,
       std::string const& upload_url) override;
   StatusOr<EmptyResponse> DeleteResumableUpload(
       DeleteResumableUploadRequest const& request) override;
+  StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) override;
+  StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) override;
+  StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) override;
+  StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -22,6 +22,20 @@ namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+namespace {
+google::protobuf::ArenaOptions MakeArenaOptions(char* block, std::size_t size) {
+  google::protobuf::ArenaOptions options;
+  options.initial_block = block;
+  options.initial_block_size = size;
+  return options;
+}
+}  // namespace
+
+GrpcObjectReadSource::GrpcObjectReadSource(StreamMaker const& maker)
+    : stream_(maker(context_)),
+      arena_(MakeArenaOptions(arena_block_.data(), arena_block_.size())),
+      response_(google::protobuf::Arena::CreateMessage<
+                google::storage::v1::GetObjectMediaResponse>(&arena_)) {}
 
 GrpcObjectReadSource::~GrpcObjectReadSource() {
   // clang-tidy is complaining about code in the gRPC implementation. It seems
@@ -57,32 +71,32 @@ StatusOr<ReadSourceResult> GrpcObjectReadSource::Read(char* buf,
                                                       std::size_t n) {
   std::multimap<std::string, std::string> headers;
   std::size_t offset = 0;
-  auto update_buf = [&offset, buf, n](std::string source) {
-    if (source.empty()) {
-      return source;
-    }
-    auto const nbytes = std::min(n - offset, source.size());
-    std::copy(source.data(), source.data() + nbytes, buf + offset);
+  // Copy the data in `response_` not returned by previous calls.
+  auto update_buf = [this, &offset, buf, n] {
+    auto const& content = response_->checksummed_data().content();
+    auto const nbytes = (std::min)(n - offset, content.size() - spill_offset_);
+    std::copy(content.data() + spill_offset_,
+              content.data() + spill_offset_ + nbytes, buf + offset);
     offset += nbytes;
-    source.erase(0, nbytes);
-    return source;
+    spill_offset_ += nbytes;
   };
 
-  spill_ = update_buf(std::move(spill_));
+  update_buf();
 
   while (offset < n && stream_) {
-    google::storage::v1::GetObjectMediaResponse response;
-    bool success = stream_->Read(&response);
+    // All the data in `response_` has been consumed, release its memory
+    // before receiving the next message.
+    arena_.Reset();
+    response_ = google::protobuf::Arena::CreateMessage<
+        google::storage::v1::GetObjectMediaResponse>(&arena_);
+    spill_offset_ = 0;
+    bool success = stream_->Read(response_);
 
-    // The google.storage.v1.Storage documentation says this field can be empty.
-    if (response.has_checksummed_data()) {
-      spill_ =
-          update_buf(std::string(  // Sometimes protobuf bytes are not strings
-              std::move(
-                  *response.mutable_checksummed_data()->mutable_content())));
-    }
-    if (response.has_object_checksums()) {
-      auto const& checksums = response.object_checksums();
+    // The google.storage.v1.Storage documentation says this field can be empty,
+    // in that case `content()` is empty too.
+    update_buf();
+    if (response_->has_object_checksums()) {
+      auto const& checksums = response_->object_checksums();
       if (checksums.has_crc32c()) {
         headers.emplace("x-goog-hash", "crc32c=" + GrpcClient::Crc32cFromProto(
                                                        checksums.crc32c()));
@@ -17,7 +17,10 @@
 
 #include "google/cloud/storage/internal/object_read_source.h"
 #include "google/cloud/storage/version.h"
+#include <google/protobuf/arena.h>
 #include <google/storage/v1/storage.grpc.pb.h>
+#include <array>
+#include <cstddef>
 #include <functional>
 
 namespace google {
@@ -41,8 +44,7 @@ using StreamMaker = std::function<std::unique_ptr<grpc::ClientReaderInterface<
  */
 class GrpcObjectReadSource : public ObjectReadSource {
  public:
-  explicit GrpcObjectReadSource(StreamMaker const& maker)
-      : stream_(maker(context_)) {}
+  explicit GrpcObjectReadSource(StreamMaker const& maker);
 
   ~GrpcObjectReadSource() override;
 
@@ -64,9 +66,18 @@ class GrpcObjectReadSource : public ObjectReadSource {
       grpc::ClientReaderInterface<google::storage::v1::GetObjectMediaResponse>>
       stream_;
 
+  // Each message in the stream is received into a new `response_` allocated
+  // in `arena_`. The arena is reset before receiving each message, and its
+  // memory comes from `arena_block_`, so receiving a message only allocates
+  // memory for the object data.
+  alignas(std::max_align_t) std::array<char, 1024> arena_block_;
+  google::protobuf::Arena arena_;
+  google::storage::v1::GetObjectMediaResponse* response_;
+
   // In some cases the gRPC response may contain more data than the buffer
-  // provided by the application. This buffer stores any excess results.
-  std::string spill_;
+  // provided by the application. The excess data is returned from `response_`
+  // in the next `Read()` call, starting at this offset.
+  std::size_t spill_offset_ = 0;
 
   // The status of the request.
   google::cloud::Status status_;
@@ -0,0 +1,180 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/grpc_object_read_source.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::int64_t> allocation_count{0};
+}  // namespace
+
+// Count all the memory allocations in the program, the benchmarks below report
+// the allocations for each MiB downloaded.
+void* operator new(std::size_t size) {
+  ++allocation_count;
+  auto* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) std::abort();
+  return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+// This benchmark measures the memory allocations and CPU time to read an
+// object using `GrpcObjectReadSource`. The `Legacy` variant reproduces the
+// previous implementation, which received each message in a heap-allocated
+// response, and copied any excess data to a separate buffer.
+//
+// The stream is simulated, each message is received by clearing the response
+// and then assigning the contents, like the gRPC deserialization code would.
+
+namespace storage_proto = ::google::storage::v1;
+
+auto constexpr kMiB = 1024 * 1024;
+auto constexpr kObjectSize = 32 * kMiB;
+// The service sends at most 2MiB in each message.
+auto constexpr kMessageSize = 2 * kMiB;
+
+class FakeMediaReader
+    : public grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse> {
+ public:
+  explicit FakeMediaReader(std::string const& contents)
+      : contents_(contents) {}
+
+  void WaitForInitialMetadata() override {}
+  grpc::Status Finish() override { return grpc::Status::OK; }
+  bool NextMessageSize(std::uint32_t* sz) override {
+    *sz = kMessageSize;
+    return remaining_ != 0;
+  }
+  bool Read(storage_proto::GetObjectMediaResponse* response) override {
+    if (remaining_ == 0) return false;
+    response->Clear();
+    response->mutable_checksummed_data()->mutable_content()->assign(contents_);
+    remaining_ -= contents_.size();
+    return true;
+  }
+
+ private:
+  std::string const& contents_;
+  std::size_t remaining_ = kObjectSize;
+};
+
+std::string const& MessageContents() {
+  static auto const* const kContents = new std::string(kMessageSize, 'A');
+  return *kContents;
+}
+
+/// The implementation of `GrpcObjectReadSource::Read()` before arenas.
+class LegacyReadSource {
+ public:
+  explicit LegacyReadSource(StreamMaker const& maker)
+      : stream_(maker(context_)) {}
+
+  std::size_t Read(char* buf, std::size_t n) {
+    std::size_t offset = 0;
+    auto update_buf = [&offset, buf, n](std::string source) {
+      if (source.empty()) return source;
+      auto const nbytes = (std::min)(n - offset, source.size());
+      std::copy(source.data(), source.data() + nbytes, buf + offset);
+      offset += nbytes;
+      source.erase(0, nbytes);
+      return source;
+    };
+    spill_ = update_buf(std::move(spill_));
+    while (offset < n && stream_) {
+      storage_proto::GetObjectMediaResponse response;
+      bool success = stream_->Read(&response);
+      if (response.has_checksummed_data()) {
+        spill_ = update_buf(std::string(
+            std::move(*response.mutable_checksummed_data()->mutable_content())));
+      }
+      if (!success) {
+        (void)stream_->Finish();
+        stream_ = nullptr;
+      }
+    }
+    return offset;
+  }
+
+ private:
+  grpc::ClientContext context_;
+  std::unique_ptr<
+      grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse>>
+      stream_;
+  std::string spill_;
+};
+
+StreamMaker MakeFakeStream() {
+  return [](grpc::ClientContext&) {
+    return std::unique_ptr<
+        grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse>>(
+        new FakeMediaReader(MessageContents()));
+  };
+}
+
+void ReportAllocations(benchmark::State& state, std::int64_t allocations) {
+  auto const mib =
+      static_cast<double>(state.iterations()) * kObjectSize / kMiB;
+  state.counters["allocations/MiB"] = static_cast<double>(allocations) / mib;
+  state.SetBytesProcessed(state.iterations() * kObjectSize);
+}
+
+void BM_GrpcObjectReadSource(benchmark::State& state) {
+  std::vector<char> buffer(static_cast<std::size_t>(state.range(0)));
+  auto const start = allocation_count.load();
+  for (auto _ : state) {
+    GrpcObjectReadSource source(MakeFakeStream());
+    for (;;) {
+      auto r = source.Read(buffer.data(), buffer.size());
+      if (!r || r->bytes_received == 0) break;
+      benchmark::DoNotOptimize(buffer.data());
+    }
+  }
+  ReportAllocations(state, allocation_count.load() - start);
+}
+BENCHMARK(BM_GrpcObjectReadSource)->RangeMultiplier(8)->Range(16 * 1024, kMiB);
+
+void BM_GrpcObjectReadSourceLegacy(benchmark::State& state) {
+  std::vector<char> buffer(static_cast<std::size_t>(state.range(0)));
+  auto const start = allocation_count.load();
+  for (auto _ : state) {
+    LegacyReadSource source(MakeFakeStream());
+    while (source.Read(buffer.data(), buffer.size()) != 0) {
+      benchmark::DoNotOptimize(buffer.data());
+    }
+  }
+  ReportAllocations(state, allocation_count.load() - start);
+}
+BENCHMARK(BM_GrpcObjectReadSourceLegacy)
+    ->RangeMultiplier(8)
+    ->Range(16 * 1024, kMiB);
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
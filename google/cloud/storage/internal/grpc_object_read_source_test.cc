@@ -363,6 +363,42 @@ TEST(GrpcObjectReadSource, HandleExtraRead) {
   EXPECT_EQ(200, status->status_code);
 }
 
+TEST(GrpcObjectReadSource, SpillAcrossMessages) {
+  auto mock = absl::make_unique<MockMediaReader>();
+  int count = 0;
+  auto reader = [&count](storage_proto::GetObjectMediaResponse* response) {
+    // Each message must be received into an empty response.
+    EXPECT_FALSE(response->has_checksummed_data());
+    ++count;
+    response->mutable_checksummed_data()->set_content("0123456789");
+    return true;
+  };
+  EXPECT_CALL(*mock, Read(_))
+      .WillOnce(reader)
+      .WillOnce(reader)
+      .WillOnce(reader)
+      .WillOnce(Return(false));
+  EXPECT_CALL(*mock, Finish()).WillOnce(Return(grpc::Status::OK));
+  GrpcObjectReadSource tested([&mock](grpc::ClientContext&) {
+    return std::unique_ptr<
+        grpc::ClientReaderInterface<storage_proto::GetObjectMediaResponse>>(
+        mock.release());
+  });
+  std::vector<char> buffer(25);
+  auto response = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(25, response->bytes_received);
+  EXPECT_EQ("0123456789012345678901234",
+            std::string(buffer.data(), response->bytes_received));
+
+  response = tested.Read(buffer.data(), buffer.size());
+  ASSERT_STATUS_OK(response);
+  EXPECT_EQ(5, response->bytes_received);
+  EXPECT_EQ("56789", std::string(buffer.data(), response->bytes_received));
+
+  EXPECT_EQ(3, count);
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
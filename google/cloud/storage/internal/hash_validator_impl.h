@@ -53,6 +53,9 @@ class Crc32cHashValidator : public HashValidator {
  public:
   Crc32cHashValidator() = default;
 
+  /// Continue a checksum computed for a prefix of the data.
+  explicit Crc32cHashValidator(std::uint32_t current) : current_(current) {}
+
   Crc32cHashValidator(Crc32cHashValidator const&) = delete;
   Crc32cHashValidator& operator=(Crc32cHashValidator const&) = delete;
 
@@ -62,6 +65,12 @@ class Crc32cHashValidator : public HashValidator {
   void ProcessHeader(std::string const& key, std::string const& value) override;
   Result Finish() && override;
 
+  /// The checksum of the data received so far.
+  std::uint32_t current() const { return current_; }
+
+  /// The checksum reported by the service, empty if not known.
+  std::string const& received_hash() const { return received_hash_; }
+
  private:
   std::uint32_t current_{0};
   std::string received_hash_;
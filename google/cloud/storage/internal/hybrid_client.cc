@@ -14,6 +14,8 @@
 
 #include "google/cloud/storage/internal/hybrid_client.h"
 #include "google/cloud/storage/internal/grpc_resumable_upload_session_url.h"
+#include "absl/memory/memory.h"
+#include <chrono>
 
 namespace google {
 namespace cloud {
@@ -21,9 +23,121 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 
+namespace {
+
+using ::google::cloud::storage_experimental::RoutedOperation;
+using ::google::cloud::storage_experimental::Transport;
+using ::google::cloud::storage_experimental::TransportRoutingPolicy;
+using Clock = std::chrono::steady_clock;
+
+std::chrono::microseconds ElapsedSince(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                               start);
+}
+
+/// The number of bytes requested in a download, or -1 if not known.
+std::int64_t ExpectedReadSize(ReadObjectRangeRequest const& request) {
+  if (request.HasOption<ReadRange>()) {
+    auto const range = request.GetOption<ReadRange>().value();
+    return range.end - range.begin;
+  }
+  if (request.HasOption<ReadLast>()) {
+    return request.GetOption<ReadLast>().value();
+  }
+  return -1;
+}
+
+/**
+ * Reports the throughput of a download to the routing policy.
+ *
+ * Downloads that reach the end of the data are reported as successful, and
+ * downloads that fail as errors. The application may close or destroy the
+ * stream before the end of the data, such downloads are reported with the
+ * throughput observed until then, so a transport that is too slow for the
+ * application still counts against it. Streams closed before any call to
+ * `Read()` are not reported, there is no throughput to report.
+ *
+ * The elapsed time includes only the call to `ReadObject()` and the calls to
+ * `Read()`, and not the time the application spends processing the data.
+ */
+class RoutedObjectReadSource : public ObjectReadSource {
+ public:
+  RoutedObjectReadSource(std::unique_ptr<ObjectReadSource> child,
+                         std::shared_ptr<TransportRoutingPolicy> policy,
+                         std::int64_t size, Transport transport,
+                         Clock::time_point start)
+      : child_(std::move(child)),
+        policy_(std::move(policy)),
+        size_(size),
+        transport_(transport),
+        elapsed_(ElapsedSince(start)) {}
+  ~RoutedObjectReadSource() override { ReportAbandoned(); }
+
+  bool IsOpen() const override { return child_->IsOpen(); }
+
+  StatusOr<HttpResponse> Close() override {
+    auto response = child_->Close();
+    if (!response) {
+      Report(false);
+    } else {
+      ReportAbandoned();
+    }
+    return response;
+  }
+
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const start = Clock::now();
+    auto result = child_->Read(buf, n);
+    elapsed_ += ElapsedSince(start);
+    has_read_ = true;
+    if (!result) {
+      Report(false);
+      return result;
+    }
+    bytes_ += static_cast<std::int64_t>(result->bytes_received);
+    if (result->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+      Report(false);
+    } else if (!child_->IsOpen()) {
+      Report(true);
+    }
+    return result;
+  }
+
+ private:
+  void Report(bool success) {
+    if (reported_) return;
+    reported_ = true;
+    policy_->Record(RoutedOperation::kReadObject, size_, transport_, bytes_,
+                    elapsed_, success);
+  }
+
+  /// Reports a download closed before the end of the data.
+  void ReportAbandoned() {
+    if (has_read_) Report(true);
+    reported_ = true;
+  }
+
+  std::unique_ptr<ObjectReadSource> child_;
+  std::shared_ptr<TransportRoutingPolicy> policy_;
+  std::int64_t size_;
+  Transport transport_;
+  std::chrono::microseconds elapsed_;
+  std::int64_t bytes_ = 0;
+  bool has_read_ = false;
+  bool reported_ = false;
+};
+
+}  // namespace
+
 HybridClient::HybridClient(ClientOptions options)
+    : HybridClient(std::move(options), nullptr) {}
+
+HybridClient::HybridClient(
+    ClientOptions options,
+    std::shared_ptr<TransportRoutingPolicy> routing_policy)
     : grpc_(std::make_shared<GrpcClient>(options)),
-      curl_(CurlClient::Create(std::move(options))) {}
+      curl_(CurlClient::Create(std::move(options))),
+      routing_policy_(std::move(routing_policy)) {}
 
 ClientOptions const& HybridClient::client_options() const {
   return curl_->client_options();
@@ -92,7 +206,15 @@ StatusOr<BucketMetadata> HybridClient::LockBucketRetentionPolicy(
 
 StatusOr<ObjectMetadata> HybridClient::InsertObjectMedia(
     InsertObjectMediaRequest const& request) {
-  return grpc_->InsertObjectMedia(request);
+  if (!routing_policy_) return grpc_->InsertObjectMedia(request);
+  auto const size = static_cast<std::int64_t>(request.contents().size());
+  auto const transport =
+      routing_policy_->Choose(RoutedOperation::kInsertObjectMedia, size);
+  auto const start = Clock::now();
+  auto result = Select(transport).InsertObjectMedia(request);
+  routing_policy_->Record(RoutedOperation::kInsertObjectMedia, size, transport,
+                          size, ElapsedSince(start), result.ok());
+  return result;
 }
 
 StatusOr<ObjectMetadata> HybridClient::CopyObject(
@@ -107,7 +229,20 @@ StatusOr<ObjectMetadata> HybridClient::GetObjectMetadata(
 
 StatusOr<std::unique_ptr<ObjectReadSource>> HybridClient::ReadObject(
     ReadObjectRangeRequest const& request) {
-  return grpc_->ReadObject(request);
+  if (!routing_policy_) return grpc_->ReadObject(request);
+  auto const size = ExpectedReadSize(request);
+  auto const transport =
+      routing_policy_->Choose(RoutedOperation::kReadObject, size);
+  auto const start = Clock::now();
+  auto source = Select(transport).ReadObject(request);
+  if (!source) {
+    routing_policy_->Record(RoutedOperation::kReadObject, size, transport, 0,
+                            ElapsedSince(start), false);
+    return source;
+  }
+  return std::unique_ptr<ObjectReadSource>(
+      absl::make_unique<RoutedObjectReadSource>(
+          *std::move(source), routing_policy_, size, transport, start));
 }
 
 StatusOr<ListObjectsResponse> HybridClient::ListObjects(
@@ -161,6 +296,26 @@ StatusOr<EmptyResponse> HybridClient::DeleteResumableUpload(
   return curl_->DeleteResumableUpload(request);
 }
 
+StatusOr<CreateMultipartUploadResponse> HybridClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  return curl_->CreateMultipartUpload(request);
+}
+
+StatusOr<UploadPartResponse> HybridClient::UploadPart(
+    UploadPartRequest const& request) {
+  return curl_->UploadPart(request);
+}
+
+StatusOr<CompleteMultipartUploadResponse> HybridClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  return curl_->CompleteMultipartUpload(request);
+}
+
+StatusOr<EmptyResponse> HybridClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  return curl_->AbortMultipartUpload(request);
+}
+
 StatusOr<ListBucketAclResponse> HybridClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   return curl_->ListBucketAcl(request);
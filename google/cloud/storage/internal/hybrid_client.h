@@ -18,6 +18,7 @@
 #include "google/cloud/storage/internal/curl_client.h"
 #include "google/cloud/storage/internal/grpc_client.h"
 #include "google/cloud/storage/internal/raw_client.h"
+#include "google/cloud/storage/transport_routing_policy.h"
 #include "google/cloud/storage/version.h"
 
 namespace google {
@@ -26,9 +27,20 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
 
+/**
+ * A `RawClient` that uses gRPC for media operations and JSON for metadata.
+ *
+ * By default `InsertObjectMedia()` and `ReadObject()` always use gRPC. If the
+ * client is created with a `TransportRoutingPolicy` these operations are
+ * routed to the transport with the best observed throughput instead.
+ */
 class HybridClient : public RawClient {
  public:
   explicit HybridClient(ClientOptions options);
+  HybridClient(
+      ClientOptions options,
+      std::shared_ptr<storage_experimental::TransportRoutingPolicy>
+          routing_policy);
   ~HybridClient() override = default;
 
   ClientOptions const& client_options() const override;
@@ -83,6 +95,14 @@ class HybridClient : public RawClient {
       std::string const& upload_id) override;
   StatusOr<EmptyResponse> DeleteResumableUpload(
       DeleteResumableUploadRequest const& request) override;
+  StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) override;
+  StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) override;
+  StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) override;
+  StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
@@ -143,9 +163,22 @@ class HybridClient : public RawClient {
   StatusOr<EmptyResponse> DeleteNotification(
       DeleteNotificationRequest const&) override;
 
+  /// The routing policy for media operations, `nullptr` if routing is static.
+  std::shared_ptr<storage_experimental::TransportRoutingPolicy> const&
+  routing_policy() const {
+    return routing_policy_;
+  }
+
  private:
+  RawClient& Select(storage_experimental::Transport transport) {
+    if (transport == storage_experimental::Transport::kGrpc) return *grpc_;
+    return *curl_;
+  }
+
   std::shared_ptr<GrpcClient> grpc_;
   std::shared_ptr<CurlClient> curl_;
+  std::shared_ptr<storage_experimental::TransportRoutingPolicy>
+      routing_policy_;
 };
 
 }  // namespace internal
@@ -0,0 +1,774 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/file_io.h"
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register)
+#define GOOGLE_CLOUD_CPP_STORAGE_HAVE_IO_URING 1
+#endif
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // __linux__ && __has_include
+
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_IO_URING
+#include "absl/memory/memory.h"
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <vector>
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_IO_URING
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+#if GOOGLE_CLOUD_CPP_STORAGE_HAVE_IO_URING
+namespace {
+
+/// The alignment required for `O_DIRECT` buffers, offsets, and sizes.
+std::size_t constexpr kDirectIoAlignment = 4096;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+std::size_t AlignDown(std::size_t value, std::size_t alignment) {
+  return value / alignment * alignment;
+}
+
+/**
+ * The number of consecutive `io_uring_enter(2)` failures tolerated while
+ * waiting for in-flight operations.
+ *
+ * Most failures (`EAGAIN`, `EBUSY`) are transient, after this many we assume
+ * the ring is unusable.
+ */
+int constexpr kMaxDrainFailures = 16;
+
+/**
+ * A minimal wrapper around the `io_uring` system calls.
+ *
+ * We use the system calls directly instead of `liburing` to avoid a new
+ * dependency. The ring is used by a single thread, the only synchronization
+ * needed is with the kernel, via acquire/release operations on the ring
+ * indices.
+ */
+class IoUring {
+ public:
+  static StatusOr<std::unique_ptr<IoUring>> Create(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    auto const fd = static_cast<int>(
+        ::syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) return FileIoError(errno, "io_uring_setup()", "ring");
+    auto ring = std::unique_ptr<IoUring>(new IoUring(fd));
+    auto status = ring->Map(params);
+    if (!status.ok()) return status;
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      ::munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_size_);
+    ::close(fd_);
+  }
+
+  IoUring(IoUring const&) = delete;
+  IoUring& operator=(IoUring const&) = delete;
+
+  /// Register @p buffers, returns false if the kernel rejects them.
+  bool RegisterBuffers(std::vector<iovec> const& buffers) {
+    return ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                     buffers.data(),
+                     static_cast<unsigned>(buffers.size())) == 0;
+  }
+
+  /// Return a zeroed submission queue entry, or nullptr if the queue is full.
+  io_uring_sqe* GetSqe() {
+    auto const head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= sq_entries_) return nullptr;
+    auto const index = sqe_tail_ & *sq_mask_;
+    auto* sqe = &sqes_[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    ++pending_;
+    return sqe;
+  }
+
+  /// Submit all pending entries, and wait for @p min_complete completions.
+  Status Enter(unsigned min_complete) {
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    if (pending_ == 0 && min_complete == 0) return Status();
+    for (;;) {
+      auto const flags = min_complete == 0 ? 0U : IORING_ENTER_GETEVENTS;
+      auto const r = ::syscall(__NR_io_uring_enter, fd_, pending_,
+                               min_complete, flags, nullptr, 0);
+      if (r < 0 && errno == EINTR) continue;
+      if (r < 0) return FileIoError(errno, "io_uring_enter()", "ring");
+      pending_ -= static_cast<unsigned>(r);
+      return Status();
+    }
+  }
+
+  /// Call @p f(user_data, result) for each available completion.
+  template <typename Functor>
+  void ForEachCompletion(Functor&& f) {
+    auto head = *cq_head_;
+    auto const tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      auto const& cqe = cqes_[head & *cq_mask_];
+      f(cqe.user_data, cqe.res);
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+ private:
+  explicit IoUring(int fd) : fd_(fd) {}
+
+  Status Map(io_uring_params const& p) {
+    sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool const single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = (std::max)(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) return FileIoError(errno, "mmap()", "ring");
+    cq_ring_ = single_mmap
+                   ? sq_ring_
+                   : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return FileIoError(errno, "mmap()", "ring");
+    sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+    auto* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) return FileIoError(errno, "mmap()", "ring");
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sq = static_cast<char*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_entries_ = p.sq_entries;
+    sqe_tail_ = *sq_tail_;
+
+    auto* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return Status();
+  }
+
+  int fd_;
+  void* sq_ring_ = MAP_FAILED;
+  std::size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  std::size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+  std::size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned sq_entries_ = 0;
+  unsigned sqe_tail_ = 0;
+  unsigned pending_ = 0;
+
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+};
+
+/// A fixed set of aligned buffers, optionally registered with a ring.
+class RingBuffers {
+ public:
+  RingBuffers(IoUring& ring, std::size_t count, std::size_t size)
+      : size_(AlignUp(size, kDirectIoAlignment)) {
+    void* memory = nullptr;
+    if (::posix_memalign(&memory, kDirectIoAlignment, count * size_) != 0) {
+      return;
+    }
+    memory_.reset(static_cast<char*>(memory));
+    iovecs_.resize(count);
+    for (std::size_t i = 0; i != count; ++i) {
+      iovecs_[i].iov_base = memory_.get() + i * size_;
+      iovecs_[i].iov_len = size_;
+    }
+    // Registering the buffers saves mapping the pages on every operation, but
+    // may fail if the buffers exceed RLIMIT_MEMLOCK. In that case we just use
+    // plain vectored I/O.
+    registered_ = ring.RegisterBuffers(iovecs_);
+  }
+
+  bool ok() const { return memory_ != nullptr; }
+  std::size_t size() const { return size_; }
+
+  /**
+   * Release the memory without freeing it.
+   *
+   * Used when the kernel may still own some of the buffers, writing to freed
+   * (and possibly reused) memory is far worse than a leak.
+   */
+  void Leak() { (void)memory_.release(); }
+
+  std::size_t count() const { return iovecs_.size(); }
+  char* data(std::size_t i) const {
+    return static_cast<char*>(iovecs_[i].iov_base);
+  }
+
+  /// Prepare @p sqe to read or write @p length bytes from buffer @p i.
+  void Prepare(io_uring_sqe* sqe, bool write, int fd, std::size_t i,
+               std::size_t start, std::size_t length, std::uint64_t offset) {
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->user_data = i;
+    if (registered_) {
+      sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+      sqe->addr = reinterpret_cast<std::uintptr_t>(data(i) + start);
+      sqe->len = static_cast<std::uint32_t>(length);
+      sqe->buf_index = static_cast<std::uint16_t>(i);
+      return;
+    }
+    // The iovec must remain valid until the operation completes.
+    scratch_.resize(count());
+    scratch_[i].iov_base = data(i) + start;
+    scratch_[i].iov_len = length;
+    sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->addr = reinterpret_cast<std::uintptr_t>(&scratch_[i]);
+    sqe->len = 1;
+  }
+
+ private:
+  struct FreeDeleter {
+    void operator()(char* p) const { std::free(p); }
+  };
+
+  std::size_t size_;
+  std::unique_ptr<char, FreeDeleter> memory_;
+  std::vector<iovec> iovecs_;
+  std::vector<iovec> scratch_;
+  bool registered_ = false;
+};
+
+/// Open @p file_name, trying `O_DIRECT` first if requested.
+int OpenFile(std::string const& file_name, int flags, bool& direct_io) {
+  if (direct_io) {
+    auto const fd = ::open(file_name.c_str(), flags | O_DIRECT, 0666);
+    // Some file systems (e.g. tmpfs) do not support O_DIRECT.
+    if (fd >= 0 || errno != EINVAL) return fd;
+    direct_io = false;
+  }
+  return ::open(file_name.c_str(), flags, 0666);
+}
+
+class IoUringFileWriter : public FileWriter {
+ public:
+  IoUringFileWriter(std::string file_name, int fd, bool direct_io,
+                    std::unique_ptr<IoUring> ring, std::size_t queue_depth,
+                    std::size_t buffer_size, std::uint64_t offset)
+      : file_name_(std::move(file_name)),
+        fd_(fd),
+        direct_io_(direct_io),
+        ring_(std::move(ring)),
+        buffers_(*ring_, queue_depth, buffer_size),
+        slots_(queue_depth),
+        offset_(offset) {
+    for (std::size_t i = 0; i != queue_depth; ++i) free_.push_back(i);
+  }
+
+  ~IoUringFileWriter() override { (void)Close(); }
+
+  bool ok() const { return buffers_.ok(); }
+
+  Status Write(char const* data, std::size_t size) override {
+    while (status_.ok() && size != 0) {
+      if (!has_current_) {
+        auto status = AcquireBuffer();
+        if (!status.ok()) return status;
+      }
+      auto const n = (std::min)(size, buffers_.size() - fill_);
+      std::memcpy(buffers_.data(current_) + fill_, data, n);
+      fill_ += n;
+      data += n;
+      size -= n;
+      if (fill_ == buffers_.size()) QueueCurrent(fill_);
+    }
+    // Submit any full buffers in a single system call, without waiting.
+    (void)Submit(0);
+    return status_;
+  }
+
+  Status Flush() override {
+    if (fd_ < 0) return status_;
+    auto const partial = has_current_ && fill_ != 0;
+    if (partial) {
+      // Write the partial buffer, but keep using it: the next writes fill the
+      // rest of the buffer, and then the buffer is written again at the same
+      // offset.
+      auto length = fill_;
+      if (direct_io_) {
+        length = AlignUp(fill_, kDirectIoAlignment);
+        std::memset(buffers_.data(current_) + fill_, 0, length - fill_);
+      }
+      slots_[current_] = Slot{offset_, length, 0};
+      ++in_flight_;
+      Prepare(current_);
+    }
+    Drain();
+    // The completion returned the current buffer to the free list, unless the
+    // ring failed before the write completed.
+    if (partial) {
+      auto f = std::find(free_.begin(), free_.end(), current_);
+      if (f != free_.end()) free_.erase(f);
+    }
+    return status_;
+  }
+
+  Status Close() override {
+    if (fd_ < 0) return status_;
+    auto const logical_size = offset_ + fill_;
+    if (has_current_) {
+      auto length = fill_;
+      if (direct_io_) {
+        // O_DIRECT requires aligned writes, pad the last block and truncate
+        // the file to its actual size after all the writes complete.
+        length = AlignUp(fill_, kDirectIoAlignment);
+        std::memset(buffers_.data(current_) + fill_, 0, length - fill_);
+      }
+      QueueCurrent(length);
+    }
+    Drain();
+    if (status_.ok() && direct_io_ &&
+        ::ftruncate(fd_, static_cast<off_t>(logical_size)) != 0) {
+      status_ = FileIoError(errno, "ftruncate()", file_name_);
+    }
+    if (::close(fd_) != 0 && status_.ok()) {
+      status_ = FileIoError(errno, "close()", file_name_);
+    }
+    fd_ = -1;
+    return status_;
+  }
+
+ private:
+  struct Slot {
+    std::uint64_t offset;
+    std::size_t length;
+    std::size_t done;
+  };
+
+  Status AcquireBuffer() {
+    while (free_.empty()) {
+      auto status = Submit(1);
+      if (!status.ok()) return status;
+    }
+    if (!status_.ok()) return status_;
+    current_ = free_.back();
+    free_.pop_back();
+    has_current_ = true;
+    fill_ = 0;
+    return Status();
+  }
+
+  void QueueCurrent(std::size_t length) {
+    slots_[current_] = Slot{offset_, length, 0};
+    offset_ += fill_;
+    has_current_ = false;
+    fill_ = 0;
+    ++in_flight_;
+    Prepare(current_);
+  }
+
+  void Prepare(std::size_t i) {
+    auto const& slot = slots_[i];
+    // There is one ring entry per buffer, this cannot fail.
+    auto* sqe = ring_->GetSqe();
+    buffers_.Prepare(sqe, true, fd_, i, slot.done, slot.length - slot.done,
+                     slot.offset + slot.done);
+  }
+
+  /// Submit pending operations, returns an error only if the ring fails.
+  Status Submit(unsigned min_complete) {
+    auto status = ring_->Enter(min_complete);
+    // Even if the ring reports an error some operations may have completed.
+    ring_->ForEachCompletion([this](std::uint64_t i, std::int32_t result) {
+      OnCompletion(static_cast<std::size_t>(i), result);
+    });
+    if (!status.ok() && status_.ok()) status_ = status;
+    return status;
+  }
+
+  /**
+   * Wait for all the in-flight writes.
+   *
+   * The kernel owns the buffers until each operation completes. If the ring
+   * fails we cannot know when that happens, and the buffers are leaked.
+   */
+  void Drain() {
+    int failures = 0;
+    while (in_flight_ != 0 && failures != kMaxDrainFailures) {
+      failures = Submit(1).ok() ? 0 : failures + 1;
+    }
+    if (in_flight_ != 0) buffers_.Leak();
+  }
+
+  void OnCompletion(std::size_t i, std::int32_t result) {
+    auto& slot = slots_[i];
+    auto const start = slot.done;
+    if (result > 0) {
+      slot.done += static_cast<std::size_t>(result);
+      // O_DIRECT requires aligned offsets, after a partial write we rewrite
+      // the last partial block.
+      if (slot.done != slot.length && direct_io_) {
+        slot.done = AlignDown(slot.done, kDirectIoAlignment);
+      }
+    }
+    if (slot.done != slot.length && status_.ok()) {
+      if (result > 0 && slot.done != start) {
+        // A partial write, submit the remaining data.
+        Prepare(i);
+        return;
+      }
+      status_ = result < 0 ? FileIoError(-result, "write()", file_name_)
+                           : Status(StatusCode::kUnknown,
+                                    "short write() for " + file_name_);
+    }
+    --in_flight_;
+    free_.push_back(i);
+  }
+
+  std::string file_name_;
+  int fd_;
+  bool direct_io_;
+  std::unique_ptr<IoUring> ring_;
+  RingBuffers buffers_;
+  std::vector<Slot> slots_;
+  std::vector<std::size_t> free_;
+  std::size_t current_ = 0;
+  bool has_current_ = false;
+  std::size_t fill_ = 0;
+  std::uint64_t offset_ = 0;
+  std::size_t in_flight_ = 0;
+  Status status_;
+};
+
+class IoUringFileReader : public FileReader {
+ public:
+  IoUringFileReader(std::string file_name, int fd, bool direct_io,
+                    std::uint64_t file_size, std::unique_ptr<IoUring> ring,
+                    std::size_t queue_depth, std::size_t buffer_size)
+      : file_name_(std::move(file_name)),
+        fd_(fd),
+        alignment_(direct_io ? kDirectIoAlignment : 1),
+        file_size_(file_size),
+        ring_(std::move(ring)),
+        buffers_(*ring_, queue_depth, buffer_size),
+        slots_(queue_depth) {
+    for (std::size_t i = 0; i != queue_depth; ++i) free_.push_back(i);
+  }
+
+  ~IoUringFileReader() override {
+    Drain();
+    ::close(fd_);
+  }
+
+  bool ok() const { return buffers_.ok(); }
+
+  StatusOr<std::size_t> Read(char* data, std::size_t size) override {
+    std::size_t total = 0;
+    while (total != size) {
+      if (!has_current_) {
+        auto status = NextBuffer();
+        if (!status.ok()) return status;
+        if (!has_current_) break;  // end of file
+      }
+      auto const& slot = slots_[current_];
+      auto const n = (std::min)(size - total, slot.done - position_);
+      std::memcpy(data + total, buffers_.data(current_) + position_, n);
+      total += n;
+      position_ += n;
+      offset_ += n;
+      if (position_ == slot.done) {
+        has_current_ = false;
+        free_.push_back(current_);
+      }
+    }
+    return total;
+  }
+
+  Status Seek(std::uint64_t offset) override {
+    Drain();
+    offset_ = offset;
+    next_read_ = offset / alignment_ * alignment_;
+    skip_ = static_cast<std::size_t>(offset - next_read_);
+    return status_;
+  }
+
+  std::uint64_t offset() const override { return offset_; }
+
+ private:
+  struct Slot {
+    std::uint64_t offset;
+    std::size_t length;
+    std::size_t done;
+    bool ready;
+  };
+
+  /// Start reads for all the free buffers, in file order.
+  Status Refill() {
+    while (status_.ok() && !free_.empty() && next_read_ < file_size_) {
+      auto const i = free_.back();
+      free_.pop_back();
+      slots_[i] = Slot{next_read_, buffers_.size(), 0, false};
+      next_read_ += buffers_.size();
+      in_order_.push_back(i);
+      Prepare(i);
+    }
+    (void)Submit(0);
+    return status_;
+  }
+
+  /// Wait until the next buffer, in file order, is ready.
+  Status NextBuffer() {
+    auto status = Refill();
+    if (!status.ok()) return status;
+    if (in_order_.empty()) return status_;
+    auto const i = in_order_.front();
+    while (!slots_[i].ready) {
+      status = Submit(1);
+      if (!status.ok()) return status;
+    }
+    if (!status_.ok()) return status_;
+    in_order_.pop_front();
+    if (slots_[i].done <= skip_) {
+      // Only possible if the file was truncated while we read it.
+      free_.push_back(i);
+      file_size_ = slots_[i].offset + slots_[i].done;
+      return status_;
+    }
+    current_ = i;
+    has_current_ = true;
+    position_ = skip_;
+    skip_ = 0;
+    // Reading the next buffers can proceed while the application consumes
+    // this one.
+    return Refill();
+  }
+
+  void Prepare(std::size_t i) {
+    auto const& slot = slots_[i];
+    auto* sqe = ring_->GetSqe();
+    buffers_.Prepare(sqe, false, fd_, i, slot.done, slot.length - slot.done,
+                     slot.offset + slot.done);
+    ++in_flight_;
+  }
+
+  /// Submit pending operations, returns an error only if the ring fails.
+  Status Submit(unsigned min_complete) {
+    auto status = ring_->Enter(min_complete);
+    // Even if the ring reports an error some operations may have completed.
+    ring_->ForEachCompletion([this](std::uint64_t i, std::int32_t result) {
+      OnCompletion(static_cast<std::size_t>(i), result);
+    });
+    if (!status.ok() && status_.ok()) status_ = status;
+    return status;
+  }
+
+  void OnCompletion(std::size_t i, std::int32_t result) {
+    --in_flight_;
+    auto& slot = slots_[i];
+    if (result < 0) {
+      if (status_.ok()) status_ = FileIoError(-result, "read()", file_name_);
+      slot.ready = true;
+      return;
+    }
+    auto const start = slot.done;
+    slot.done += static_cast<std::size_t>(result);
+    if (result != 0 && slot.done != slot.length &&
+        slot.offset + slot.done < file_size_) {
+      // A partial read before the end of file, read the rest. O_DIRECT
+      // requires aligned offsets, so we read the last partial block again.
+      slot.done = AlignDown(slot.done, static_cast<std::size_t>(alignment_));
+      if (slot.done != start) {
+        Prepare(i);
+        return;
+      }
+      if (status_.ok()) {
+        status_ =
+            Status(StatusCode::kUnknown, "short read() for " + file_name_);
+      }
+    }
+    slot.ready = true;
+  }
+
+  /**
+   * Wait for any in-flight reads and discard all the buffers.
+   *
+   * The kernel owns the buffers until each operation completes. If the ring
+   * fails we cannot know when that happens, and the buffers are leaked.
+   */
+  void Drain() {
+    int failures = 0;
+    while (in_flight_ != 0 && failures != kMaxDrainFailures) {
+      failures = Submit(1).ok() ? 0 : failures + 1;
+    }
+    if (in_flight_ != 0) {
+      buffers_.Leak();
+      return;
+    }
+    for (auto i : in_order_) free_.push_back(i);
+    in_order_.clear();
+    if (has_current_) free_.push_back(current_);
+    has_current_ = false;
+  }
+
+  std::string file_name_;
+  int fd_;
+  std::uint64_t alignment_;
+  std::uint64_t file_size_;
+  std::unique_ptr<IoUring> ring_;
+  RingBuffers buffers_;
+  std::vector<Slot> slots_;
+  std::vector<std::size_t> free_;
+  std::deque<std::size_t> in_order_;
+  std::size_t current_ = 0;
+  bool has_current_ = false;
+  std::size_t position_ = 0;
+  std::size_t skip_ = 0;
+  std::uint64_t offset_ = 0;
+  std::uint64_t next_read_ = 0;
+  std::size_t in_flight_ = 0;
+  Status status_;
+};
+
+class IoUringFileIoBackend : public FileIoBackend {
+ public:
+  explicit IoUringFileIoBackend(FileIoConfig config)
+      : config_(config), fallback_(CreateBlockingFileIoBackend(config)) {
+    config_.queue_depth = (std::max)(config_.queue_depth, std::size_t{1});
+    config_.buffer_size = AlignUp(config_.buffer_size, kDirectIoAlignment);
+  }
+
+  StatusOr<std::unique_ptr<FileWriter>> OpenForWrite(
+      std::string const& file_name, std::uint64_t offset) override {
+    auto ring = IoUring::Create(static_cast<unsigned>(config_.queue_depth));
+    if (!ring) return fallback_->OpenForWrite(file_name, offset);
+    // O_DIRECT requires aligned writes, all the buffers are aligned, but the
+    // starting offset may not be.
+    auto direct_io = config_.direct_io && offset % kDirectIoAlignment == 0;
+    auto const fd = OpenFile(
+        file_name, O_WRONLY | O_CREAT | (offset == 0 ? O_TRUNC : 0) | O_CLOEXEC,
+        direct_io);
+    if (fd < 0) return FileIoError(errno, "open()", file_name);
+    struct stat st;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      ::close(fd);
+      return fallback_->OpenForWrite(file_name, offset);
+    }
+    if (offset != 0 && ::ftruncate(fd, static_cast<off_t>(offset)) != 0) {
+      auto status = FileIoError(errno, "ftruncate()", file_name);
+      ::close(fd);
+      return status;
+    }
+    auto writer = absl::make_unique<IoUringFileWriter>(
+        file_name, fd, direct_io, *std::move(ring), config_.queue_depth,
+        config_.buffer_size, offset);
+    if (!writer->ok()) {
+      return Status(StatusCode::kResourceExhausted,
+                    "cannot allocate I/O buffers for " + file_name);
+    }
+    return std::unique_ptr<FileWriter>(std::move(writer));
+  }
+
+  StatusOr<std::unique_ptr<FileReader>> OpenForRead(
+      std::string const& file_name, std::uint64_t offset) override {
+    auto ring = IoUring::Create(static_cast<unsigned>(config_.queue_depth));
+    if (!ring) return fallback_->OpenForRead(file_name, offset);
+    auto direct_io = config_.direct_io;
+    auto const fd = OpenFile(file_name, O_RDONLY | O_CLOEXEC, direct_io);
+    if (fd < 0) return FileIoError(errno, "open()", file_name);
+    struct stat st;  // NOLINT(cppcoreguidelines-pro-type-member-init)
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      // Pipes and other special files do not support reads at arbitrary
+      // offsets.
+      ::close(fd);
+      return fallback_->OpenForRead(file_name, offset);
+    }
+    auto reader = absl::make_unique<IoUringFileReader>(
+        file_name, fd, direct_io, static_cast<std::uint64_t>(st.st_size),
+        *std::move(ring), config_.queue_depth, config_.buffer_size);
+    if (!reader->ok()) {
+      return Status(StatusCode::kResourceExhausted,
+                    "cannot allocate I/O buffers for " + file_name);
+    }
+    auto status = reader->Seek(offset);
+    if (!status.ok()) return status;
+    return std::unique_ptr<FileReader>(std::move(reader));
+  }
+
+ private:
+  FileIoConfig config_;
+  std::shared_ptr<FileIoBackend> fallback_;
+};
+
+}  // namespace
+
+std::shared_ptr<FileIoBackend> CreateIoUringFileIoBackend(
+    FileIoConfig config) {
+  return std::make_shared<IoUringFileIoBackend>(config);
+}
+
+bool IoUringAvailable() {
+  // The system call may be missing (old kernels) or blocked (seccomp
+  // filters), the only reliable test is to try it.
+  static bool const kAvailable = IoUring::Create(1).ok();
+  return kAvailable;
+}
+
+#else
+
+std::shared_ptr<FileIoBackend> CreateIoUringFileIoBackend(
+    FileIoConfig config) {
+  return CreateBlockingFileIoBackend(config);
+}
+
+bool IoUringAvailable() { return false; }
+
+#endif  // GOOGLE_CLOUD_CPP_STORAGE_HAVE_IO_URING
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
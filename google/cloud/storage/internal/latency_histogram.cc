@@ -0,0 +1,124 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/latency_histogram.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+// Define the static constexpr members, these are odr-used in some places.
+int constexpr LatencyHistogram::kSubBucketBits;
+std::size_t constexpr LatencyHistogram::kSubBucketCount;
+int constexpr LatencyHistogram::kMaxExponent;
+std::size_t constexpr LatencyHistogram::kBucketCount;
+std::size_t constexpr LatencyHistogram::kStripeCount;
+
+namespace {
+int MostSignificantBit(std::uint64_t value) {
+  int msb = 0;
+  while (value >>= 1) ++msb;
+  return msb;
+}
+}  // namespace
+
+LatencyHistogram::Stripe::Stripe() : sum(0) {
+  for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto& s : stripes_) s.store(nullptr, std::memory_order_relaxed);
+}
+
+LatencyHistogram::~LatencyHistogram() {
+  for (auto& s : stripes_) delete s.load();
+}
+
+void LatencyHistogram::Record(std::chrono::microseconds value) {
+  auto const v = static_cast<std::uint64_t>(
+      (std::max)(value.count(), std::chrono::microseconds::rep(0)));
+  auto& stripe = GetStripe();
+  stripe.buckets[BucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+  stripe.sum.fetch_add(v, std::memory_order_relaxed);
+}
+
+std::vector<std::uint64_t> LatencyHistogram::Counts() const {
+  std::vector<std::uint64_t> counts(kBucketCount);
+  for (auto const& s : stripes_) {
+    auto const* stripe = s.load(std::memory_order_acquire);
+    if (stripe == nullptr) continue;
+    for (std::size_t i = 0; i != kBucketCount; ++i) {
+      counts[i] += stripe->buckets[i].load(std::memory_order_relaxed);
+    }
+  }
+  return counts;
+}
+
+std::chrono::microseconds LatencyHistogram::Sum() const {
+  std::uint64_t sum = 0;
+  for (auto const& s : stripes_) {
+    auto const* stripe = s.load(std::memory_order_acquire);
+    if (stripe == nullptr) continue;
+    sum += stripe->sum.load(std::memory_order_relaxed);
+  }
+  return std::chrono::microseconds(
+      static_cast<std::chrono::microseconds::rep>(sum));
+}
+
+std::size_t LatencyHistogram::BucketIndex(std::uint64_t value) {
+  // Values below 2 * kSubBucketCount map directly to their own bucket.
+  if (value < 2 * kSubBucketCount) return static_cast<std::size_t>(value);
+  auto const msb = MostSignificantBit(value);
+  if (msb >= kMaxExponent) return kBucketCount - 1;
+  auto const shift = msb - kSubBucketBits;
+  auto const sub_bucket = (value >> shift) - kSubBucketCount;
+  return static_cast<std::size_t>(msb - kSubBucketBits + 1) * kSubBucketCount +
+         static_cast<std::size_t>(sub_bucket);
+}
+
+std::uint64_t LatencyHistogram::BucketLowerBound(std::size_t index) {
+  if (index < 2 * kSubBucketCount) return index;
+  auto const msb =
+      static_cast<int>(index / kSubBucketCount) + kSubBucketBits - 1;
+  auto const sub_bucket = index % kSubBucketCount;
+  return (kSubBucketCount + sub_bucket) << (msb - kSubBucketBits);
+}
+
+LatencyHistogram::Stripe& LatencyHistogram::GetStripe() {
+  auto const index =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) % kStripeCount;
+  auto& slot = stripes_[index];
+  auto* stripe = slot.load(std::memory_order_acquire);
+  if (stripe != nullptr) return *stripe;
+  // Lazily allocate the stripe, if another thread wins the race we discard our
+  // copy and use theirs.
+  auto* created = new Stripe;
+  if (slot.compare_exchange_strong(stripe, created,
+                                   std::memory_order_acq_rel)) {
+    return *created;
+  }
+  delete created;
+  return *stripe;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
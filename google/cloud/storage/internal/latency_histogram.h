@@ -0,0 +1,91 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_LATENCY_HISTOGRAM_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_LATENCY_HISTOGRAM_H
+
+#include "google/cloud/storage/version.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * A lock-free histogram for latency measurements.
+ *
+ * The histogram uses log-linear buckets, similar to HdrHistogram: values below
+ * 32 microseconds get their own bucket, and each power of two above that is
+ * split into 16 sub-buckets. The relative error for any recorded value is
+ * therefore at most 1/16. Values larger than about 71 minutes are recorded in
+ * the last bucket.
+ *
+ * To avoid contention between threads the counters are split into stripes,
+ * each thread updates the stripe selected by hashing its thread id. Stripes
+ * are allocated the first time they are used, so histograms that never record
+ * any values are cheap.
+ */
+class LatencyHistogram {
+ public:
+  static int constexpr kSubBucketBits = 4;
+  static std::size_t constexpr kSubBucketCount = 1U << kSubBucketBits;
+  static int constexpr kMaxExponent = 32;
+  static std::size_t constexpr kBucketCount =
+      (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount;
+  static std::size_t constexpr kStripeCount = 8;
+
+  LatencyHistogram();
+  ~LatencyHistogram();
+
+  LatencyHistogram(LatencyHistogram const&) = delete;
+  LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+  void Record(std::chrono::microseconds value);
+
+  /// Returns the counts for each bucket, added across all the stripes.
+  std::vector<std::uint64_t> Counts() const;
+
+  /// Returns the sum of all the recorded values.
+  std::chrono::microseconds Sum() const;
+
+  /// Returns the bucket used to record @p value (in microseconds).
+  static std::size_t BucketIndex(std::uint64_t value);
+
+  /// Returns the smallest value (in microseconds) recorded in bucket @p index.
+  static std::uint64_t BucketLowerBound(std::size_t index);
+
+ private:
+  struct Stripe {
+    Stripe();
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets;
+    std::atomic<std::uint64_t> sum;
+  };
+
+  Stripe& GetStripe();
+
+  std::array<std::atomic<Stripe*>, kStripeCount> stripes_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_LATENCY_HISTOGRAM_H
@@ -0,0 +1,100 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/latency_histogram.h"
+#include <gmock/gmock.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using std::chrono::microseconds;
+
+TEST(LatencyHistogramTest, SmallValuesHaveTheirOwnBucket) {
+  for (std::uint64_t v = 0; v != 32; ++v) {
+    EXPECT_EQ(v, LatencyHistogram::BucketIndex(v));
+    EXPECT_EQ(v, LatencyHistogram::BucketLowerBound(v));
+  }
+}
+
+TEST(LatencyHistogramTest, BucketsAreMonotonic) {
+  for (std::size_t i = 1; i != LatencyHistogram::kBucketCount; ++i) {
+    EXPECT_LT(LatencyHistogram::BucketLowerBound(i - 1),
+              LatencyHistogram::BucketLowerBound(i))
+        << "i=" << i;
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(
+                     LatencyHistogram::BucketLowerBound(i)));
+  }
+}
+
+TEST(LatencyHistogramTest, RelativeErrorIsBounded) {
+  for (std::uint64_t v : {33U, 100U, 1000U, 12345U, 1000000U, 987654321U}) {
+    auto const lb =
+        LatencyHistogram::BucketLowerBound(LatencyHistogram::BucketIndex(v));
+    EXPECT_LE(lb, v);
+    EXPECT_LE(v - lb, v / LatencyHistogram::kSubBucketCount) << "v=" << v;
+  }
+}
+
+TEST(LatencyHistogramTest, LargeValuesAreClamped) {
+  EXPECT_EQ(LatencyHistogram::kBucketCount - 1,
+            LatencyHistogram::BucketIndex(std::uint64_t{1} << 40));
+}
+
+TEST(LatencyHistogramTest, Record) {
+  LatencyHistogram histogram;
+  histogram.Record(microseconds(10));
+  histogram.Record(microseconds(10));
+  histogram.Record(microseconds(1000));
+  histogram.Record(microseconds(-5));
+
+  auto const counts = histogram.Counts();
+  ASSERT_EQ(LatencyHistogram::kBucketCount, counts.size());
+  EXPECT_EQ(1, counts[0]);
+  EXPECT_EQ(2, counts[10]);
+  EXPECT_EQ(1, counts[LatencyHistogram::BucketIndex(1000)]);
+  EXPECT_EQ(microseconds(1020), histogram.Sum());
+}
+
+TEST(LatencyHistogramTest, RecordFromManyThreads) {
+  auto constexpr kThreads = 16;
+  auto constexpr kIterations = 1000;
+  LatencyHistogram histogram;
+  std::vector<std::thread> tasks;
+  for (int i = 0; i != kThreads; ++i) {
+    tasks.emplace_back([&histogram] {
+      for (int j = 0; j != kIterations; ++j) {
+        histogram.Record(microseconds(j));
+      }
+    });
+  }
+  for (auto& t : tasks) t.join();
+  auto const counts = histogram.Counts();
+  auto const total =
+      std::accumulate(counts.begin(), counts.end(), std::uint64_t{0});
+  EXPECT_EQ(kThreads * kIterations, total);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -225,6 +225,30 @@ StatusOr<EmptyResponse> LoggingClient::DeleteResumableUpload(
                   __func__);
 }
 
+StatusOr<CreateMultipartUploadResponse> LoggingClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  return MakeCall(*client_, &RawClient::CreateMultipartUpload, request,
+                  __func__);
+}
+
+StatusOr<UploadPartResponse> LoggingClient::UploadPart(
+    UploadPartRequest const& request) {
+  return MakeCall(*client_, &RawClient::UploadPart, request, __func__);
+}
+
+StatusOr<CompleteMultipartUploadResponse>
+LoggingClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  return MakeCall(*client_, &RawClient::CompleteMultipartUpload, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> LoggingClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  return MakeCall(*client_, &RawClient::AbortMultipartUpload, request,
+                  __func__);
+}
+
 StatusOr<ListBucketAclResponse> LoggingClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   return MakeCall(*client_, &RawClient::ListBucketAcl, request, __func__);
@@ -81,6 +81,14 @@ class LoggingClient : public RawClient {
       std::string const& request) override;
   StatusOr<EmptyResponse> DeleteResumableUpload(
       DeleteResumableUploadRequest const& request) override;
+  StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) override;
+  StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) override;
+  StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) override;
+  StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) override;
 
   StatusOr<ListBucketAclResponse> ListBucketAcl(
       ListBucketAclRequest const& request) override;
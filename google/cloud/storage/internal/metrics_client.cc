@@ -0,0 +1,510 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metrics_client.h"
+#include "absl/memory/memory.h"
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+namespace {
+
+std::chrono::microseconds ElapsedSince(
+    std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+}
+
+void RecordUpload(OperationMetrics& m,
+                  std::chrono::steady_clock::time_point start,
+                  std::size_t bytes, Status const& status) {
+  auto const elapsed = ElapsedSince(start);
+  m.RecordCall(elapsed, status);
+  m.transfer_time_us.fetch_add(static_cast<std::uint64_t>(elapsed.count()),
+                               std::memory_order_relaxed);
+  if (status.ok()) {
+    m.bytes_uploaded.fetch_add(bytes, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+MetricsClient::MetricsClient(std::shared_ptr<RawClient> client,
+                             std::shared_ptr<ClientMetrics> metrics,
+                             Layer layer)
+    : client_(std::move(client)), metrics_(std::move(metrics)), layer_(layer) {}
+
+ClientOptions const& MetricsClient::client_options() const {
+  return client_->client_options();
+}
+
+template <typename MemberFunction>
+typename raw_client_wrapper_utils::Signature<MemberFunction>::ReturnType
+MetricsClient::MakeCall(MetricsOperation op, MemberFunction function,
+                        typename raw_client_wrapper_utils::Signature<
+                            MemberFunction>::RequestType const& request) {
+  auto& m = metrics_->operation(op);
+  if (layer_ == Layer::kAttempt) {
+    m.RecordAttempt();
+    return (client_.get()->*function)(request);
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto response = (client_.get()->*function)(request);
+  m.RecordCall(ElapsedSince(start), response.status());
+  return response;
+}
+
+std::unique_ptr<ResumableUploadSession> MetricsClient::Wrap(
+    std::unique_ptr<ResumableUploadSession> session) {
+  return absl::make_unique<MetricsResumableUploadSession>(std::move(session),
+                                                          metrics_, layer_);
+}
+
+StatusOr<ListBucketsResponse> MetricsClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return MakeCall(MetricsOperation::kListBuckets, &RawClient::ListBuckets,
+                  request);
+}
+
+StatusOr<BucketMetadata> MetricsClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateBucket, &RawClient::CreateBucket,
+                  request);
+}
+
+StatusOr<BucketMetadata> MetricsClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return MakeCall(MetricsOperation::kGetBucketMetadata,
+                  &RawClient::GetBucketMetadata, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteBucket, &RawClient::DeleteBucket,
+                  request);
+}
+
+StatusOr<BucketMetadata> MetricsClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateBucket, &RawClient::UpdateBucket,
+                  request);
+}
+
+StatusOr<BucketMetadata> MetricsClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return MakeCall(MetricsOperation::kPatchBucket, &RawClient::PatchBucket,
+                  request);
+}
+
+StatusOr<IamPolicy> MetricsClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return MakeCall(MetricsOperation::kGetBucketIamPolicy,
+                  &RawClient::GetBucketIamPolicy, request);
+}
+
+StatusOr<NativeIamPolicy> MetricsClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return MakeCall(MetricsOperation::kGetNativeBucketIamPolicy,
+                  &RawClient::GetNativeBucketIamPolicy, request);
+}
+
+StatusOr<IamPolicy> MetricsClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return MakeCall(MetricsOperation::kSetBucketIamPolicy,
+                  &RawClient::SetBucketIamPolicy, request);
+}
+
+StatusOr<NativeIamPolicy> MetricsClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return MakeCall(MetricsOperation::kSetNativeBucketIamPolicy,
+                  &RawClient::SetNativeBucketIamPolicy, request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+MetricsClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return MakeCall(MetricsOperation::kTestBucketIamPermissions,
+                  &RawClient::TestBucketIamPermissions, request);
+}
+
+StatusOr<BucketMetadata> MetricsClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return MakeCall(MetricsOperation::kLockBucketRetentionPolicy,
+                  &RawClient::LockBucketRetentionPolicy, request);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  auto result = MakeCall(MetricsOperation::kInsertObjectMedia,
+                         &RawClient::InsertObjectMedia, request);
+  if (result && layer_ == Layer::kOperation) {
+    metrics_->operation(MetricsOperation::kInsertObjectMedia)
+        .bytes_uploaded.fetch_add(request.contents().size(),
+                                  std::memory_order_relaxed);
+  }
+  return result;
+}
+
+StatusOr<ObjectMetadata> MetricsClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kCopyObject, &RawClient::CopyObject,
+                  request);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return MakeCall(MetricsOperation::kGetObjectMetadata,
+                  &RawClient::GetObjectMetadata, request);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> MetricsClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  auto const start = std::chrono::steady_clock::now();
+  auto result =
+      MakeCall(MetricsOperation::kReadObject, &RawClient::ReadObject, request);
+  if (!result || layer_ != Layer::kOperation) return result;
+  return std::unique_ptr<ObjectReadSource>(
+      absl::make_unique<MetricsObjectReadSource>(*std::move(result), metrics_,
+                                                 start));
+}
+
+StatusOr<ListObjectsResponse> MetricsClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return MakeCall(MetricsOperation::kListObjects, &RawClient::ListObjects,
+                  request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteObject, &RawClient::DeleteObject,
+                  request);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateObject, &RawClient::UpdateObject,
+                  request);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kPatchObject, &RawClient::PatchObject,
+                  request);
+}
+
+StatusOr<ObjectMetadata> MetricsClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kComposeObject, &RawClient::ComposeObject,
+                  request);
+}
+
+StatusOr<RewriteObjectResponse> MetricsClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  return MakeCall(MetricsOperation::kRewriteObject, &RawClient::RewriteObject,
+                  request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetricsClient::CreateResumableSession(ResumableUploadRequest const& request) {
+  auto result = MakeCall(MetricsOperation::kCreateResumableSession,
+                         &RawClient::CreateResumableSession, request);
+  if (!result) return result;
+  return Wrap(*std::move(result));
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+MetricsClient::RestoreResumableSession(std::string const& request) {
+  auto result = MakeCall(MetricsOperation::kRestoreResumableSession,
+                         &RawClient::RestoreResumableSession, request);
+  if (!result) return result;
+  return Wrap(*std::move(result));
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteResumableUpload(
+    DeleteResumableUploadRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteResumableUpload,
+                  &RawClient::DeleteResumableUpload, request);
+}
+
+StatusOr<CreateMultipartUploadResponse> MetricsClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateMultipartUpload,
+                  &RawClient::CreateMultipartUpload, request);
+}
+
+StatusOr<UploadPartResponse> MetricsClient::UploadPart(
+    UploadPartRequest const& request) {
+  auto result =
+      MakeCall(MetricsOperation::kUploadPart, &RawClient::UploadPart, request);
+  if (result && layer_ == Layer::kOperation) {
+    metrics_->operation(MetricsOperation::kUploadPart)
+        .bytes_uploaded.fetch_add(request.payload().size(),
+                                  std::memory_order_relaxed);
+  }
+  return result;
+}
+
+StatusOr<CompleteMultipartUploadResponse>
+MetricsClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  return MakeCall(MetricsOperation::kCompleteMultipartUpload,
+                  &RawClient::CompleteMultipartUpload, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  return MakeCall(MetricsOperation::kAbortMultipartUpload,
+                  &RawClient::AbortMultipartUpload, request);
+}
+
+StatusOr<ListBucketAclResponse> MetricsClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kListBucketAcl, &RawClient::ListBucketAcl,
+                  request);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kGetBucketAcl, &RawClient::GetBucketAcl,
+                  request);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateBucketAcl,
+                  &RawClient::CreateBucketAcl, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteBucketAcl,
+                  &RawClient::DeleteBucketAcl, request);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateBucketAcl,
+                  &RawClient::UpdateBucketAcl, request);
+}
+
+StatusOr<BucketAccessControl> MetricsClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return MakeCall(MetricsOperation::kPatchBucketAcl, &RawClient::PatchBucketAcl,
+                  request);
+}
+
+StatusOr<ListObjectAclResponse> MetricsClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kListObjectAcl, &RawClient::ListObjectAcl,
+                  request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateObjectAcl,
+                  &RawClient::CreateObjectAcl, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteObjectAcl,
+                  &RawClient::DeleteObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kGetObjectAcl, &RawClient::GetObjectAcl,
+                  request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateObjectAcl,
+                  &RawClient::UpdateObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kPatchObjectAcl, &RawClient::PatchObjectAcl,
+                  request);
+}
+
+StatusOr<ListDefaultObjectAclResponse> MetricsClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kListDefaultObjectAcl,
+                  &RawClient::ListDefaultObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateDefaultObjectAcl,
+                  &RawClient::CreateDefaultObjectAcl, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteDefaultObjectAcl,
+                  &RawClient::DeleteDefaultObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kGetDefaultObjectAcl,
+                  &RawClient::GetDefaultObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateDefaultObjectAcl,
+                  &RawClient::UpdateDefaultObjectAcl, request);
+}
+
+StatusOr<ObjectAccessControl> MetricsClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return MakeCall(MetricsOperation::kPatchDefaultObjectAcl,
+                  &RawClient::PatchDefaultObjectAcl, request);
+}
+
+StatusOr<ServiceAccount> MetricsClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return MakeCall(MetricsOperation::kGetServiceAccount,
+                  &RawClient::GetServiceAccount, request);
+}
+
+StatusOr<ListHmacKeysResponse> MetricsClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return MakeCall(MetricsOperation::kListHmacKeys, &RawClient::ListHmacKeys,
+                  request);
+}
+
+StatusOr<CreateHmacKeyResponse> MetricsClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateHmacKey, &RawClient::CreateHmacKey,
+                  request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteHmacKey, &RawClient::DeleteHmacKey,
+                  request);
+}
+
+StatusOr<HmacKeyMetadata> MetricsClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return MakeCall(MetricsOperation::kGetHmacKey, &RawClient::GetHmacKey,
+                  request);
+}
+
+StatusOr<HmacKeyMetadata> MetricsClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return MakeCall(MetricsOperation::kUpdateHmacKey, &RawClient::UpdateHmacKey,
+                  request);
+}
+
+StatusOr<SignBlobResponse> MetricsClient::SignBlob(
+    SignBlobRequest const& request) {
+  return MakeCall(MetricsOperation::kSignBlob, &RawClient::SignBlob, request);
+}
+
+StatusOr<ListNotificationsResponse> MetricsClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return MakeCall(MetricsOperation::kListNotifications,
+                  &RawClient::ListNotifications, request);
+}
+
+StatusOr<NotificationMetadata> MetricsClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return MakeCall(MetricsOperation::kCreateNotification,
+                  &RawClient::CreateNotification, request);
+}
+
+StatusOr<NotificationMetadata> MetricsClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return MakeCall(MetricsOperation::kGetNotification,
+                  &RawClient::GetNotification, request);
+}
+
+StatusOr<EmptyResponse> MetricsClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return MakeCall(MetricsOperation::kDeleteNotification,
+                  &RawClient::DeleteNotification, request);
+}
+
+MetricsObjectReadSource::MetricsObjectReadSource(
+    std::unique_ptr<ObjectReadSource> child,
+    std::shared_ptr<ClientMetrics> metrics,
+    std::chrono::steady_clock::time_point start)
+    : child_(std::move(child)), metrics_(std::move(metrics)), start_(start) {}
+
+StatusOr<ReadSourceResult> MetricsObjectReadSource::Read(char* buf,
+                                                         std::size_t n) {
+  auto& m = metrics_->operation(MetricsOperation::kReadObject);
+  auto const start = std::chrono::steady_clock::now();
+  auto result = child_->Read(buf, n);
+  auto const now = std::chrono::steady_clock::now();
+  m.transfer_time_us.fetch_add(
+      static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(now - start)
+              .count()),
+      std::memory_order_relaxed);
+  if (!result) {
+    // The stream was opened successfully, but the download failed.
+    m.RecordError(result.status());
+    return result;
+  }
+  m.bytes_downloaded.fetch_add(result->bytes_received,
+                               std::memory_order_relaxed);
+  if (!received_first_byte_ && result->bytes_received != 0) {
+    received_first_byte_ = true;
+    m.time_to_first_byte.Record(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - start_));
+  }
+  return result;
+}
+
+StatusOr<ResumableUploadResponse> MetricsResumableUploadSession::UploadChunk(
+    ConstBufferSequence const& buffers) {
+  auto& m = metrics_->operation(MetricsOperation::kUploadChunk);
+  if (layer_ == MetricsClient::Layer::kAttempt) {
+    m.RecordAttempt();
+    return session_->UploadChunk(buffers);
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto result = session_->UploadChunk(buffers);
+  RecordUpload(m, start, TotalBytes(buffers), result.status());
+  return result;
+}
+
+StatusOr<ResumableUploadResponse>
+MetricsResumableUploadSession::UploadFinalChunk(
+    ConstBufferSequence const& buffers, std::uint64_t upload_size) {
+  auto& m = metrics_->operation(MetricsOperation::kUploadChunk);
+  if (layer_ == MetricsClient::Layer::kAttempt) {
+    m.RecordAttempt();
+    return session_->UploadFinalChunk(buffers, upload_size);
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto result = session_->UploadFinalChunk(buffers, upload_size);
+  RecordUpload(m, start, TotalBytes(buffers), result.status());
+  return result;
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
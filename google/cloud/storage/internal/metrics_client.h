@@ -0,0 +1,256 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METRICS_CLIENT_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METRICS_CLIENT_H
+
+#include "google/cloud/storage/client_metrics.h"
+#include "google/cloud/storage/internal/raw_client.h"
+#include "google/cloud/storage/internal/raw_client_wrapper_utils.h"
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <memory>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * A decorator for `RawClient` that records latency and throughput metrics.
+ *
+ * The client library installs two instances of this decorator, one above the
+ * `RetryClient` to record the latency of each call as seen by the application,
+ * and one below the `RetryClient` to count the attempts to complete each call.
+ * The difference between attempts and calls is the number of retries.
+ *
+ * The operation layer also wraps any `ObjectReadSource` and
+ * `ResumableUploadSession` it returns, so the metrics include the time to first
+ * byte, and the bytes and time spent in streaming downloads and uploads. The
+ * attempt layer wraps the `ResumableUploadSession` too, as each chunk is
+ * retried independently.
+ */
+class MetricsClient : public RawClient {
+ public:
+  enum class Layer { kOperation, kAttempt };
+
+  MetricsClient(std::shared_ptr<RawClient> client,
+                std::shared_ptr<ClientMetrics> metrics, Layer layer);
+  ~MetricsClient() override = default;
+
+  ClientOptions const& client_options() const override;
+
+  StatusOr<ListBucketsResponse> ListBuckets(
+      ListBucketsRequest const& request) override;
+  StatusOr<BucketMetadata> CreateBucket(
+      CreateBucketRequest const& request) override;
+  StatusOr<BucketMetadata> GetBucketMetadata(
+      GetBucketMetadataRequest const& request) override;
+  StatusOr<EmptyResponse> DeleteBucket(DeleteBucketRequest const&) override;
+  StatusOr<BucketMetadata> UpdateBucket(
+      UpdateBucketRequest const& request) override;
+  StatusOr<BucketMetadata> PatchBucket(
+      PatchBucketRequest const& request) override;
+  StatusOr<IamPolicy> GetBucketIamPolicy(
+      GetBucketIamPolicyRequest const& request) override;
+  StatusOr<NativeIamPolicy> GetNativeBucketIamPolicy(
+      GetBucketIamPolicyRequest const& request) override;
+  StatusOr<IamPolicy> SetBucketIamPolicy(
+      SetBucketIamPolicyRequest const& request) override;
+  StatusOr<NativeIamPolicy> SetNativeBucketIamPolicy(
+      SetNativeBucketIamPolicyRequest const& request) override;
+  StatusOr<TestBucketIamPermissionsResponse> TestBucketIamPermissions(
+      TestBucketIamPermissionsRequest const& request) override;
+  StatusOr<BucketMetadata> LockBucketRetentionPolicy(
+      LockBucketRetentionPolicyRequest const& request) override;
+
+  StatusOr<ObjectMetadata> InsertObjectMedia(
+      InsertObjectMediaRequest const& request) override;
+  StatusOr<ObjectMetadata> CopyObject(
+      CopyObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> GetObjectMetadata(
+      GetObjectMetadataRequest const& request) override;
+  StatusOr<std::unique_ptr<ObjectReadSource>> ReadObject(
+      ReadObjectRangeRequest const&) override;
+  StatusOr<ListObjectsResponse> ListObjects(ListObjectsRequest const&) override;
+  StatusOr<EmptyResponse> DeleteObject(DeleteObjectRequest const&) override;
+  StatusOr<ObjectMetadata> UpdateObject(
+      UpdateObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> PatchObject(
+      PatchObjectRequest const& request) override;
+  StatusOr<ObjectMetadata> ComposeObject(
+      ComposeObjectRequest const& request) override;
+  StatusOr<RewriteObjectResponse> RewriteObject(
+      RewriteObjectRequest const&) override;
+  StatusOr<std::unique_ptr<ResumableUploadSession>> CreateResumableSession(
+      ResumableUploadRequest const& request) override;
+  StatusOr<std::unique_ptr<ResumableUploadSession>> RestoreResumableSession(
+      std::string const& request) override;
+  StatusOr<EmptyResponse> DeleteResumableUpload(
+      DeleteResumableUploadRequest const& request) override;
+  StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) override;
+  StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) override;
+  StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) override;
+  StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) override;
+
+  StatusOr<ListBucketAclResponse> ListBucketAcl(
+      ListBucketAclRequest const& request) override;
+  StatusOr<BucketAccessControl> CreateBucketAcl(
+      CreateBucketAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteBucketAcl(
+      DeleteBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> GetBucketAcl(
+      GetBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> UpdateBucketAcl(
+      UpdateBucketAclRequest const&) override;
+  StatusOr<BucketAccessControl> PatchBucketAcl(
+      PatchBucketAclRequest const&) override;
+
+  StatusOr<ListObjectAclResponse> ListObjectAcl(
+      ListObjectAclRequest const& request) override;
+  StatusOr<ObjectAccessControl> CreateObjectAcl(
+      CreateObjectAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteObjectAcl(
+      DeleteObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> GetObjectAcl(
+      GetObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> UpdateObjectAcl(
+      UpdateObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> PatchObjectAcl(
+      PatchObjectAclRequest const&) override;
+
+  StatusOr<ListDefaultObjectAclResponse> ListDefaultObjectAcl(
+      ListDefaultObjectAclRequest const& request) override;
+  StatusOr<ObjectAccessControl> CreateDefaultObjectAcl(
+      CreateDefaultObjectAclRequest const&) override;
+  StatusOr<EmptyResponse> DeleteDefaultObjectAcl(
+      DeleteDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> GetDefaultObjectAcl(
+      GetDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> UpdateDefaultObjectAcl(
+      UpdateDefaultObjectAclRequest const&) override;
+  StatusOr<ObjectAccessControl> PatchDefaultObjectAcl(
+      PatchDefaultObjectAclRequest const&) override;
+
+  StatusOr<ServiceAccount> GetServiceAccount(
+      GetProjectServiceAccountRequest const&) override;
+  StatusOr<ListHmacKeysResponse> ListHmacKeys(
+      ListHmacKeysRequest const&) override;
+  StatusOr<CreateHmacKeyResponse> CreateHmacKey(
+      CreateHmacKeyRequest const&) override;
+  StatusOr<EmptyResponse> DeleteHmacKey(DeleteHmacKeyRequest const&) override;
+  StatusOr<HmacKeyMetadata> GetHmacKey(GetHmacKeyRequest const&) override;
+  StatusOr<HmacKeyMetadata> UpdateHmacKey(UpdateHmacKeyRequest const&) override;
+  StatusOr<SignBlobResponse> SignBlob(SignBlobRequest const&) override;
+
+  StatusOr<ListNotificationsResponse> ListNotifications(
+      ListNotificationsRequest const&) override;
+  StatusOr<NotificationMetadata> CreateNotification(
+      CreateNotificationRequest const&) override;
+  StatusOr<NotificationMetadata> GetNotification(
+      GetNotificationRequest const&) override;
+  StatusOr<EmptyResponse> DeleteNotification(
+      DeleteNotificationRequest const&) override;
+
+  std::shared_ptr<RawClient> client() const { return client_; }
+  std::shared_ptr<ClientMetrics> metrics() const { return metrics_; }
+  Layer layer() const { return layer_; }
+
+ private:
+  template <typename MemberFunction>
+  typename raw_client_wrapper_utils::Signature<MemberFunction>::ReturnType
+  MakeCall(MetricsOperation op, MemberFunction function,
+           typename raw_client_wrapper_utils::Signature<
+               MemberFunction>::RequestType const& request);
+
+  std::unique_ptr<ResumableUploadSession> Wrap(
+      std::unique_ptr<ResumableUploadSession> session);
+
+  std::shared_ptr<RawClient> client_;
+  std::shared_ptr<ClientMetrics> metrics_;
+  Layer layer_;
+};
+
+/**
+ * A decorator for `ObjectReadSource` that records download metrics.
+ */
+class MetricsObjectReadSource : public ObjectReadSource {
+ public:
+  MetricsObjectReadSource(std::unique_ptr<ObjectReadSource> child,
+                          std::shared_ptr<ClientMetrics> metrics,
+                          std::chrono::steady_clock::time_point start);
+  ~MetricsObjectReadSource() override = default;
+
+  bool IsOpen() const override { return child_->IsOpen(); }
+  StatusOr<HttpResponse> Close() override { return child_->Close(); }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override;
+
+ private:
+  std::unique_ptr<ObjectReadSource> child_;
+  std::shared_ptr<ClientMetrics> metrics_;
+  std::chrono::steady_clock::time_point start_;
+  bool received_first_byte_ = false;
+};
+
+/**
+ * A decorator for `ResumableUploadSession` that records upload metrics.
+ *
+ * Like `MetricsClient`, in the operation layer this records the latency and
+ * bytes of each chunk, and in the attempt layer it only counts the attempts to
+ * upload each chunk.
+ */
+class MetricsResumableUploadSession : public ResumableUploadSession {
+ public:
+  MetricsResumableUploadSession(std::unique_ptr<ResumableUploadSession> session,
+                                std::shared_ptr<ClientMetrics> metrics,
+                                MetricsClient::Layer layer)
+      : session_(std::move(session)),
+        metrics_(std::move(metrics)),
+        layer_(layer) {}
+
+  StatusOr<ResumableUploadResponse> UploadChunk(
+      ConstBufferSequence const& buffers) override;
+  StatusOr<ResumableUploadResponse> UploadFinalChunk(
+      ConstBufferSequence const& buffers, std::uint64_t upload_size) override;
+  StatusOr<ResumableUploadResponse> ResetSession() override {
+    return session_->ResetSession();
+  }
+  std::uint64_t next_expected_byte() const override {
+    return session_->next_expected_byte();
+  }
+  std::string const& session_id() const override {
+    return session_->session_id();
+  }
+  StatusOr<ResumableUploadResponse> const& last_response() const override {
+    return session_->last_response();
+  }
+  bool done() const override { return session_->done(); }
+
+ private:
+  std::unique_ptr<ResumableUploadSession> session_;
+  std::shared_ptr<ClientMetrics> metrics_;
+  MetricsClient::Layer layer_;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_METRICS_CLIENT_H
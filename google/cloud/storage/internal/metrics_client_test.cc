@@ -0,0 +1,236 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/metrics_client.h"
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/oauth2/anonymous_credentials.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "absl/memory/memory.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::google::cloud::storage::testing::canonical_errors::TransientError;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+TEST(MetricsClientTest, OperationLayer) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(ObjectMetadata()))
+      .WillOnce(Return(PermanentError()));
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kOperation);
+
+  GetObjectMetadataRequest const request("test-bucket", "test-object");
+  EXPECT_STATUS_OK(client.GetObjectMetadata(request));
+  EXPECT_FALSE(client.GetObjectMetadata(request));
+
+  auto const s = metrics->Snapshot(MetricsOperation::kGetObjectMetadata);
+  EXPECT_EQ(2, s.calls);
+  EXPECT_EQ(0, s.attempts);
+  EXPECT_EQ(2, s.latency.count());
+  EXPECT_THAT(s.errors, ElementsAre(Pair(PermanentError().code(), 1)));
+}
+
+TEST(MetricsClientTest, AttemptLayer) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .WillOnce(Return(TransientError()))
+      .WillOnce(Return(EmptyResponse{}));
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kAttempt);
+
+  DeleteObjectRequest const request("test-bucket", "test-object");
+  EXPECT_FALSE(client.DeleteObject(request));
+  EXPECT_STATUS_OK(client.DeleteObject(request));
+
+  auto const s = metrics->Snapshot(MetricsOperation::kDeleteObject);
+  EXPECT_EQ(0, s.calls);
+  EXPECT_EQ(2, s.attempts);
+  EXPECT_EQ(0, s.latency.count());
+  EXPECT_THAT(s.errors, IsEmpty());
+}
+
+TEST(MetricsClientTest, InsertObjectMediaBytes) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, InsertObjectMedia(_)).WillOnce(Return(ObjectMetadata()));
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kOperation);
+
+  EXPECT_STATUS_OK(client.InsertObjectMedia(InsertObjectMediaRequest(
+      "test-bucket", "test-object", std::string(1024, 'A'))));
+  auto const s = metrics->Snapshot(MetricsOperation::kInsertObjectMedia);
+  EXPECT_EQ(1024, s.bytes_uploaded);
+}
+
+TEST(MetricsClientTest, ReadObjectStream) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, ReadObject(_)).WillOnce([](ReadObjectRangeRequest const&) {
+    auto source = absl::make_unique<testing::MockObjectReadSource>();
+    EXPECT_CALL(*source, Read(_, _))
+        .WillOnce(Return(ReadSourceResult{0, {}}))
+        .WillOnce(Return(ReadSourceResult{1024, {}}))
+        .WillOnce(Return(ReadSourceResult{512, {}}));
+    return StatusOr<std::unique_ptr<ObjectReadSource>>(std::move(source));
+  });
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kOperation);
+
+  auto source =
+      client.ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  std::vector<char> buffer(2048);
+  for (int i = 0; i != 3; ++i) {
+    ASSERT_STATUS_OK((*source)->Read(buffer.data(), buffer.size()));
+  }
+
+  auto const s = metrics->Snapshot(MetricsOperation::kReadObject);
+  EXPECT_EQ(1, s.calls);
+  EXPECT_EQ(1536, s.bytes_downloaded);
+  EXPECT_EQ(1, s.time_to_first_byte.count());
+}
+
+TEST(MetricsClientTest, ReadObjectStreamError) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, ReadObject(_)).WillOnce([](ReadObjectRangeRequest const&) {
+    auto source = absl::make_unique<testing::MockObjectReadSource>();
+    EXPECT_CALL(*source, Read(_, _))
+        .WillOnce(Return(ReadSourceResult{1024, {}}))
+        .WillOnce(Return(PermanentError()));
+    return StatusOr<std::unique_ptr<ObjectReadSource>>(std::move(source));
+  });
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kOperation);
+
+  auto source =
+      client.ReadObject(ReadObjectRangeRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(source);
+  std::vector<char> buffer(2048);
+  ASSERT_STATUS_OK((*source)->Read(buffer.data(), buffer.size()));
+  EXPECT_FALSE((*source)->Read(buffer.data(), buffer.size()));
+
+  auto const s = metrics->Snapshot(MetricsOperation::kReadObject);
+  EXPECT_EQ(1, s.calls);
+  EXPECT_EQ(1024, s.bytes_downloaded);
+  EXPECT_THAT(s.errors, ElementsAre(Pair(PermanentError().code(), 1)));
+}
+
+TEST(MetricsClientTest, ResumableUploadChunks) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, CreateResumableSession(_))
+      .WillOnce([](ResumableUploadRequest const&) {
+        auto session = absl::make_unique<testing::MockResumableUploadSession>();
+        EXPECT_CALL(*session, UploadChunk(_))
+            .WillOnce(Return(ResumableUploadResponse{
+                "", 1023, {}, ResumableUploadResponse::kInProgress, {}}));
+        EXPECT_CALL(*session, UploadFinalChunk(_, _))
+            .WillOnce(Return(TransientError()));
+        return StatusOr<std::unique_ptr<ResumableUploadSession>>(
+            std::move(session));
+      });
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kOperation);
+
+  auto session = client.CreateResumableSession(
+      ResumableUploadRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(session);
+  std::string const payload(1024, 'A');
+  EXPECT_STATUS_OK((*session)->UploadChunk({{payload}}));
+  EXPECT_FALSE((*session)->UploadFinalChunk({{payload}}, 2048));
+
+  auto const s = metrics->Snapshot(MetricsOperation::kUploadChunk);
+  EXPECT_EQ(2, s.calls);
+  EXPECT_EQ(1024, s.bytes_uploaded);
+  EXPECT_THAT(s.errors, ElementsAre(Pair(TransientError().code(), 1)));
+}
+
+TEST(MetricsClientTest, AttemptLayerUploadChunks) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, CreateResumableSession(_))
+      .WillOnce([](ResumableUploadRequest const&) {
+        auto session = absl::make_unique<testing::MockResumableUploadSession>();
+        EXPECT_CALL(*session, UploadChunk(_))
+            .WillOnce(Return(TransientError()))
+            .WillOnce(Return(ResumableUploadResponse{
+                "", 1023, {}, ResumableUploadResponse::kInProgress, {}}));
+        EXPECT_CALL(*session, UploadFinalChunk(_, _))
+            .WillOnce(Return(ResumableUploadResponse{
+                "", 2047, {}, ResumableUploadResponse::kDone, {}}));
+        return StatusOr<std::unique_ptr<ResumableUploadSession>>(
+            std::move(session));
+      });
+  auto metrics = std::make_shared<ClientMetrics>();
+  MetricsClient client(mock, metrics, MetricsClient::Layer::kAttempt);
+
+  auto session = client.CreateResumableSession(
+      ResumableUploadRequest("test-bucket", "test-object"));
+  ASSERT_STATUS_OK(session);
+  std::string const payload(1024, 'A');
+  EXPECT_FALSE((*session)->UploadChunk({{payload}}));
+  EXPECT_STATUS_OK((*session)->UploadChunk({{payload}}));
+  EXPECT_STATUS_OK((*session)->UploadFinalChunk({{payload}}, 2048));
+
+  // The attempt layer only counts attempts, the operation layer records the
+  // calls, bytes, and errors.
+  auto const s = metrics->Snapshot(MetricsOperation::kUploadChunk);
+  EXPECT_EQ(3, s.attempts);
+  EXPECT_EQ(0, s.calls);
+  EXPECT_EQ(0, s.bytes_uploaded);
+}
+
+TEST(MetricsClientTest, ClientCountsRetries) {
+  auto metrics = std::make_shared<ClientMetrics>();
+  auto const options = ClientOptions(oauth2::CreateAnonymousCredentials())
+                           .set_client_metrics(metrics);
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, client_options()).WillRepeatedly(ReturnRef(options));
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce(Return(TransientError()))
+      .WillOnce(Return(TransientError()))
+      .WillOnce(Return(ObjectMetadata()));
+
+  Client client{std::shared_ptr<RawClient>(mock),
+                LimitedErrorCountRetryPolicy(3),
+                ExponentialBackoffPolicy(std::chrono::milliseconds(1),
+                                         std::chrono::milliseconds(1), 2.0)};
+  EXPECT_STATUS_OK(client.GetObjectMetadata("test-bucket", "test-object"));
+
+  auto const snapshot = metrics->Snapshot();
+  ASSERT_EQ(1, snapshot.size());
+  EXPECT_EQ("GetObjectMetadata", snapshot[0].operation);
+  EXPECT_EQ(1, snapshot[0].calls);
+  EXPECT_EQ(3, snapshot[0].attempts);
+  EXPECT_EQ(2, snapshot[0].retries());
+  EXPECT_THAT(snapshot[0].errors, IsEmpty());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -17,6 +17,8 @@
 #include "google/cloud/storage/object_stream.h"
 #include "google/cloud/log.h"
 #include "absl/memory/memory.h"
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 
 namespace google {
@@ -24,24 +26,54 @@ namespace cloud {
 namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 namespace internal {
+namespace {
+/// The source used after seeking to the end of the object (or range).
+class ObjectReadEndSource : public ObjectReadSource {
+ public:
+  bool IsOpen() const override { return false; }
+  StatusOr<HttpResponse> Close() override {
+    return HttpResponse{HttpStatusCode::kOk, {}, {}};
+  }
+  StatusOr<ReadSourceResult> Read(char*, std::size_t) override {
+    return ReadSourceResult{0, HttpResponse{HttpStatusCode::kOk, {}, {}}};
+  }
+};
+}  // namespace
+
+std::streamoff constexpr ObjectReadStreambuf::kMaxSkipOnSeek;
+
 ObjectReadStreambuf::ObjectReadStreambuf(
     ReadObjectRangeRequest const& request,
-    std::unique_ptr<ObjectReadSource> source, std::streamoff pos_in_stream)
-    : source_(std::move(source)), source_pos_(pos_in_stream) {
+    std::unique_ptr<ObjectReadSource> source, std::streamoff pos_in_stream,
+    ObjectReadSourceFactory reopen)
+    : request_(request),
+      reopen_(std::move(reopen)),
+      source_(std::move(source)),
+      source_pos_(pos_in_stream) {
   hash_validator_ = CreateHashValidator(request);
+  if (request.HasOption<ReadRange>()) {
+    auto const range = request.GetOption<ReadRange>().value();
+    range_begin_ = range.begin;
+    range_end_ = range.end;
+  }
 }
 
 ObjectReadStreambuf::ObjectReadStreambuf(ReadObjectRangeRequest const& request,
                                          Status status)
-    : source_(new ObjectReadErrorSource(status)), source_pos_(-1) {
+    : request_(request),
+      source_(new ObjectReadErrorSource(status)),
+      source_pos_(-1) {
   // TODO(coryan) - revisit this, we probably do not need the validator.
   hash_validator_ = CreateHashValidator(request);
   status_ = std::move(status);
 }
 
-bool ObjectReadStreambuf::IsOpen() const { return source_->IsOpen(); }
+bool ObjectReadStreambuf::IsOpen() const {
+  return reopen_pending_ || source_->IsOpen();
+}
 
 void ObjectReadStreambuf::Close() {
+  reopen_pending_ = false;
   auto response = source_->Close();
   if (!response.ok()) {
     ReportError(std::move(response).status());
@@ -49,6 +81,8 @@ void ObjectReadStreambuf::Close() {
 }
 
 StatusOr<ObjectReadStreambuf::int_type> ObjectReadStreambuf::Peek() {
+  auto status = Reopen();
+  if (!status.ok()) return status;
   if (!IsOpen()) {
     // The stream is closed, reading from a closed stream can happen if there is
     // no object to read from, or the object is empty. In that case just setup
@@ -189,6 +223,11 @@ std::streamsize ObjectReadStreambuf::xsgetn(char* s, std::streamsize count) {
     return run_validator_if_closed(Status());
   }
 
+  auto status = Reopen();
+  if (!status.ok()) return run_validator_if_closed(std::move(status));
+  // The get area is exhausted, and the data below is read directly into the
+  // application buffer. Reset the get area so it always ends at `source_pos_`.
+  setg(nullptr, nullptr, nullptr);
   StatusOr<ReadSourceResult> read_result =
       source_->Read(s + offset, static_cast<std::size_t>(count - offset));
   // If there was an error set the internal state, but we still return the
@@ -242,14 +281,22 @@ void ObjectReadStreambuf::SetEmptyRegion() {
   current_ios_buffer_.clear();
   current_ios_buffer_.push_back('\0');
   char* data = &current_ios_buffer_[0];
-  setg(data, data + 1, data + 1);
+  setg(data + 1, data + 1, data + 1);
 }
 
 ObjectWriteStreambuf::ObjectWriteStreambuf(
     std::unique_ptr<ResumableUploadSession> upload_session,
     std::size_t max_buffer_size, std::unique_ptr<HashValidator> hash_validator)
+    : ObjectWriteStreambuf(std::move(upload_session),
+                           UploadChunkSizer(max_buffer_size),
+                           std::move(hash_validator)) {}
+
+ObjectWriteStreambuf::ObjectWriteStreambuf(
+    std::unique_ptr<ResumableUploadSession> upload_session,
+    UploadChunkSizer chunk_sizer, std::unique_ptr<HashValidator> hash_validator)
     : upload_session_(std::move(upload_session)),
-      max_buffer_size_(UploadChunkRequest::RoundUpToQuantum(max_buffer_size)),
+      chunk_sizer_(chunk_sizer),
+      max_buffer_size_(chunk_sizer_.chunk_size()),
       hash_validator_(std::move(hash_validator)),
       last_response_(ResumableUploadResponse{
           {}, 0, {}, ResumableUploadResponse::kInProgress, {}}) {
@@ -265,24 +312,128 @@ ObjectWriteStreambuf::ObjectWriteStreambuf(
 }
 
 ObjectReadStreambuf::pos_type ObjectReadStreambuf::seekpos(
-    pos_type /*pos*/, std::ios_base::openmode /*which*/) {
-  // TODO(4013): Implement proper seeking.
-  return -1;
+    pos_type pos, std::ios_base::openmode which) {
+  return seekoff(off_type(pos), std::ios_base::beg, which);
 }
 
 ObjectReadStreambuf::pos_type ObjectReadStreambuf::seekoff(
     off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
-  // TODO(4013): Implement proper seeking.
-  // Seeking is non-trivial because the hash validator and `source_` have to be
-  // recreated in the general case, which doesn't fit the current code
-  // organization.  We can, however, at least implement the bare minimum of this
-  // function allowing `tellg()` to work.
-  if (which == std::ios_base::in && dir == std::ios_base::cur && off == 0) {
-    return source_pos_ - in_avail();
+  if (which != std::ios_base::in) return -1;
+  auto const current = source_pos_ - (egptr() - gptr());
+  // This is how `tellg()` is implemented, it works even if there is an error.
+  if (dir == std::ios_base::cur && off == 0) return current;
+  if (!status_.ok()) return -1;
+  switch (dir) {
+    case std::ios_base::beg:
+      return Seek(off);
+    case std::ios_base::cur:
+      return Seek(current + off);
+    case std::ios_base::end:
+      // The size of the object is unknown, unless we are reading a range.
+      if (!range_end_) return -1;
+      return Seek(*range_end_ + off);
+    default:
+      break;
   }
   return -1;
 }
 
+ObjectReadStreambuf::pos_type ObjectReadStreambuf::Seek(std::streamoff target) {
+  if (target < range_begin_ || (range_end_ && target > *range_end_)) {
+    return -1;
+  }
+  // The get area always ends at `source_pos_`, if the target is in the get
+  // area we just need to move `gptr()`.
+  if (!reopen_pending_ && target <= source_pos_ &&
+      target >= source_pos_ - (egptr() - eback())) {
+    setg(eback(), egptr() - (source_pos_ - target), egptr());
+    return target;
+  }
+  // Short forward seeks are cheaper if we read and discard the data.
+  if (!reopen_pending_ && target > source_pos_ &&
+      target - source_pos_ <= kMaxSkipOnSeek && source_->IsOpen()) {
+    auto status = Skip(target - source_pos_);
+    if (!status.ok()) {
+      status_ = std::move(status);
+      return -1;
+    }
+    // The download may end before `target`, in that case we fallback to
+    // starting a new download.
+    if (source_pos_ == target) return target;
+  }
+  // We do not know the object size when using `ReadLast`, so we cannot
+  // compute the offset for a new download.
+  if (!reopen_ || request_.HasOption<ReadLast>()) return -1;
+  if (!reopen_pending_) {
+    (void)source_->Close();
+    source_ = absl::make_unique<ObjectReadEndSource>();
+    reopen_pending_ = true;
+  }
+  source_pos_ = target;
+  current_ios_buffer_.clear();
+  setg(nullptr, nullptr, nullptr);
+  return target;
+}
+
+Status ObjectReadStreambuf::Skip(std::streamoff count) {
+  // Any data in the get area is before `source_pos_`, so it is discarded too.
+  auto constexpr kMaxSkipRead = 128 * 1024;
+  current_ios_buffer_.resize(
+      static_cast<std::size_t>((std::min)(count, std::streamoff{kMaxSkipRead})));
+  setg(nullptr, nullptr, nullptr);
+  while (count > 0 && source_->IsOpen()) {
+    auto const n = static_cast<std::size_t>(
+        (std::min)(count, std::streamoff{kMaxSkipRead}));
+    auto read_result = source_->Read(current_ios_buffer_.data(), n);
+    if (!read_result) return std::move(read_result).status();
+    // The data is discarded, but it is still part of the download checksum.
+    hash_validator_->Update(current_ios_buffer_.data(),
+                            read_result->bytes_received);
+    source_pos_ += read_result->bytes_received;
+    count -= read_result->bytes_received;
+    for (auto const& kv : read_result->response.headers) {
+      hash_validator_->ProcessHeader(kv.first, kv.second);
+      headers_.emplace(kv.first, kv.second);
+    }
+    if (read_result->response.status_code >= HttpStatusCode::kMinNotSuccess) {
+      return AsStatus(read_result->response);
+    }
+    if (read_result->bytes_received == 0) break;
+  }
+  current_ios_buffer_.clear();
+  return Status();
+}
+
+Status ObjectReadStreambuf::Reopen() {
+  if (!reopen_pending_) return Status();
+  reopen_pending_ = false;
+  // Pin the new download to the generation of the original download, the
+  // object may have been replaced since then.
+  if (!request_.HasOption<Generation>()) {
+    auto g = headers_.find("x-goog-generation");
+    if (g != headers_.end()) {
+      request_.set_option(Generation(std::stoll(g->second)));
+    }
+  }
+  headers_.clear();
+  hash_validator_result_ = HashValidator::Result{};
+  hash_validator_ = absl::make_unique<NullHashValidator>();
+  if (range_end_ && source_pos_ >= *range_end_) return Status();
+
+  auto request = request_;
+  request.set_option(ReadFromOffset(source_pos_));
+  auto source = reopen_(request);
+  if (!source) {
+    // Seeking past the end of the object is not an error, reading from that
+    // position simply returns EOF.
+    if (source.status().code() == StatusCode::kOutOfRange) return Status();
+    return std::move(source).status();
+  }
+  hash_validator_ = CreateHashValidator(request);
+  source_ = *std::move(source);
+  return Status();
+}
+
 StatusOr<ResumableUploadResponse> ObjectWriteStreambuf::Close() {
   FlushFinal();
   return last_response_;
@@ -391,9 +542,13 @@ void ObjectWriteStreambuf::FlushRoundChunk(ConstBufferSequence buffers) {
   // buffer.
   auto first_buffered_byte = upload_session_->next_expected_byte();
   auto expected_next_byte = upload_session_->next_expected_byte() + actual_size;
+  auto const start = std::chrono::steady_clock::now();
   last_response_ = upload_session_->UploadChunk(payload);
 
   if (last_response_) {
+    chunk_sizer_.Update(actual_size,
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            std::chrono::steady_clock::now() - start));
     // Reset the internal buffer and copy any trailing bytes from `buffers` to
     // it.
     auto* pbeg = current_ios_buffer_.data();
@@ -403,6 +558,17 @@ void ObjectWriteStreambuf::FlushRoundChunk(ConstBufferSequence buffers) {
       std::copy(b.begin(), b.end(), pptr());
       pbump(static_cast<int>(b.size()));
     }
+    // The trailing bytes are less than one quantum, so they always fit in the
+    // buffer after it is resized for the next chunk.
+    if (chunk_sizer_.chunk_size() != max_buffer_size_) {
+      auto const trailing = put_area_size();
+      max_buffer_size_ = chunk_sizer_.chunk_size();
+      current_ios_buffer_.resize(max_buffer_size_);
+      current_ios_buffer_.shrink_to_fit();
+      pbeg = current_ios_buffer_.data();
+      setp(pbeg, pbeg + current_ios_buffer_.size());
+      pbump(static_cast<int>(trailing));
+    }
 
     // We cannot use the last committed byte in `last_response_` because when
     // using X-Upload-Content-Length GCS returns 0 when the upload completed
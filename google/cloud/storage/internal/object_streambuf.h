@@ -18,9 +18,13 @@
 #include "google/cloud/storage/internal/hash_validator.h"
 #include "google/cloud/storage/internal/http_response.h"
 #include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/internal/object_requests.h"
 #include "google/cloud/storage/internal/resumable_upload_session.h"
+#include "google/cloud/storage/internal/upload_chunk_sizer.h"
 #include "google/cloud/storage/version.h"
 #include "google/cloud/status_or.h"
+#include "absl/types/optional.h"
+#include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -32,18 +36,38 @@ namespace storage {
 inline namespace STORAGE_CLIENT_NS {
 class ObjectMetadata;
 namespace internal {
+/// Creates a new `ObjectReadSource`, used to re-open a download after a seek.
+using ObjectReadSourceFactory =
+    std::function<StatusOr<std::unique_ptr<ObjectReadSource>>(
+        ReadObjectRangeRequest const&)>;
+
 /**
  * Defines a compilation barrier for libcurl.
  *
  * We do not want to expose the libcurl objects through `ObjectReadStream`,
  * this class abstracts away the implementation so applications are not impacted
  * by the implementation details.
+ *
+ * The stream positions are offsets in the object, except for downloads using
+ * `ReadLast`, where they are relative to the start of the download. Seeking
+ * within the data already received, or forward by at most `kMaxSkipOnSeek`
+ * bytes, reuses the current download. Other seeks close the download, and a
+ * new one is created (using @p reopen) on the next read. The new download
+ * starts at the new position, is pinned to the generation of the original
+ * download, and keeps the bounds of any `ReadRange` option. Because the new
+ * download does not cover the full object its hashes are not validated, and
+ * `received_hash()` and `computed_hash()` return empty strings.
  */
 class ObjectReadStreambuf : public std::basic_streambuf<char> {
  public:
+  /// Seeking forward by at most this many bytes discards the data instead of
+  /// starting a new download.
+  static std::streamoff constexpr kMaxSkipOnSeek = 1024 * 1024;
+
   ObjectReadStreambuf(ReadObjectRangeRequest const& request,
                       std::unique_ptr<ObjectReadSource> source,
-                      std::streamoff pos_in_stream);
+                      std::streamoff pos_in_stream,
+                      ObjectReadSourceFactory reopen = {});
 
   /// Create a streambuf in a permanent error status.
   ObjectReadStreambuf(ReadObjectRangeRequest const& request, Status status);
@@ -76,12 +100,20 @@ class ObjectReadStreambuf : public std::basic_streambuf<char> {
   int_type ReportError(Status status);
   void SetEmptyRegion();
   StatusOr<int_type> Peek();
+  pos_type Seek(std::streamoff target);
+  Status Skip(std::streamoff count);
+  Status Reopen();
 
   int_type underflow() override;
   std::streamsize xsgetn(char* s, std::streamsize count) override;
 
+  ReadObjectRangeRequest request_;
+  ObjectReadSourceFactory reopen_;
   std::unique_ptr<ObjectReadSource> source_;
   std::streamoff source_pos_;
+  std::streamoff range_begin_ = 0;
+  absl::optional<std::streamoff> range_end_;
+  bool reopen_pending_ = false;
   std::vector<char> current_ios_buffer_;
   std::unique_ptr<HashValidator> hash_validator_;
   HashValidator::Result hash_validator_result_;
@@ -104,6 +136,11 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
                        std::size_t max_buffer_size,
                        std::unique_ptr<HashValidator> hash_validator);
 
+  /// Uploads the data in chunks of the size computed by @p chunk_sizer.
+  ObjectWriteStreambuf(std::unique_ptr<ResumableUploadSession> upload_session,
+                       UploadChunkSizer chunk_sizer,
+                       std::unique_ptr<HashValidator> hash_validator);
+
   ~ObjectWriteStreambuf() override = default;
 
   ObjectWriteStreambuf(ObjectWriteStreambuf&& rhs) noexcept = delete;
@@ -155,6 +192,7 @@ class ObjectWriteStreambuf : public std::basic_streambuf<char> {
   std::unique_ptr<ResumableUploadSession> upload_session_;
 
   std::vector<char> current_ios_buffer_;
+  UploadChunkSizer chunk_sizer_;
   std::size_t max_buffer_size_;
 
   std::unique_ptr<HashValidator> hash_validator_;
@@ -20,6 +20,8 @@
 #include "google/cloud/testing_util/status_matchers.h"
 #include "absl/memory/memory.h"
 #include <gmock/gmock.h>
+#include <chrono>
+#include <thread>
 
 namespace google {
 namespace cloud {
@@ -238,6 +240,48 @@ TEST(ObjectWriteStreambufTest, FlushAfterFullQuantum) {
   EXPECT_STATUS_OK(response);
 }
 
+/// @test Verify that adaptive chunk sizes grow while the throughput improves.
+TEST(ObjectWriteStreambufTest, AdaptiveChunkSize) {
+  auto mock = absl::make_unique<testing::MockResumableUploadSession>();
+  EXPECT_CALL(*mock, done).WillRepeatedly(Return(false));
+
+  auto const quantum = UploadChunkRequest::kChunkSizeQuantum;
+  std::vector<std::size_t> sizes;
+  std::size_t next_byte = 0;
+  EXPECT_CALL(*mock, UploadChunk(_))
+      .WillRepeatedly([&](ConstBufferSequence const& p) {
+        // Simulate a high latency connection, larger chunks are faster.
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        sizes.push_back(TotalBytes(p));
+        next_byte += TotalBytes(p);
+        return make_status_or(ResumableUploadResponse{
+            "", next_byte - 1, {}, ResumableUploadResponse::kInProgress, {}});
+      });
+  EXPECT_CALL(*mock, UploadFinalChunk(_, _))
+      .WillOnce([&](ConstBufferSequence const& p, std::uint64_t s) {
+        EXPECT_EQ(0, TotalBytes(p));
+        EXPECT_EQ(15 * quantum, s);
+        return make_status_or(ResumableUploadResponse{
+            "{}", s - 1, {}, ResumableUploadResponse::kDone, {}});
+      });
+  EXPECT_CALL(*mock, next_expected_byte()).WillRepeatedly([&]() {
+    return next_byte;
+  });
+
+  ObjectWriteStreambuf streambuf(std::move(mock),
+                                 UploadChunkSizer::Adaptive(8 * quantum),
+                                 absl::make_unique<NullHashValidator>());
+
+  std::string const block(quantum / 4, '*');
+  for (int i = 0; i != 15 * 4; ++i) {
+    streambuf.sputn(block.data(), block.size());
+  }
+  auto response = streambuf.Close();
+  EXPECT_STATUS_OK(response);
+  EXPECT_THAT(sizes,
+              ElementsAre(quantum, 2 * quantum, 4 * quantum, 8 * quantum));
+}
+
 /// @test Verify that a stream flushes when adding one character at a time.
 TEST(ObjectWriteStreambufTest, OverflowFlushAtFullQuantum) {
   auto mock = absl::make_unique<testing::MockResumableUploadSession>();
@@ -699,9 +743,11 @@ TEST(ObjectReadStreambufTest, WrongSeek) {
   EXPECT_TRUE(!!stream);
   EXPECT_EQ(10, stream.tellg());
   EXPECT_FALSE(stream.fail());
+  // Seeking to the current position is always possible.
   stream.seekg(10);
-  EXPECT_TRUE(stream.fail());
-  stream.clear();
+  EXPECT_FALSE(stream.fail());
+  EXPECT_EQ(10, stream.tellg());
+  // Without a factory to re-open the download, other seeks fail.
   stream.seekg(-1, std::ios_base::cur);
   EXPECT_TRUE(stream.fail());
   stream.clear();
@@ -712,6 +758,175 @@ TEST(ObjectReadStreambufTest, WrongSeek) {
   EXPECT_TRUE(stream.fail());
 }
 
+/// A fake download where each byte is the offset in the object modulo 128.
+class FakeObjectReadSource : public ObjectReadSource {
+ public:
+  FakeObjectReadSource(std::int64_t offset, std::int64_t end)
+      : offset_(offset), end_(end) {}
+
+  bool IsOpen() const override { return offset_ < end_; }
+  StatusOr<HttpResponse> Close() override {
+    offset_ = end_;
+    return HttpResponse{HttpStatusCode::kOk, {}, {}};
+  }
+  StatusOr<ReadSourceResult> Read(char* buf, std::size_t n) override {
+    auto const count = (std::min)(static_cast<std::int64_t>(n), end_ - offset_);
+    for (std::int64_t i = 0; i != count; ++i) {
+      buf[i] = static_cast<char>((offset_ + i) % 128);
+    }
+    offset_ += count;
+    ReadSourceResult result{static_cast<std::size_t>(count),
+                            HttpResponse{HttpStatusCode::kContinue, {}, {}}};
+    result.response.headers.emplace("x-goog-generation", "1234");
+    if (offset_ == end_) result.response.status_code = HttpStatusCode::kOk;
+    return result;
+  }
+
+ private:
+  std::int64_t offset_;
+  std::int64_t end_;
+};
+
+std::int64_t constexpr kFakeObjectSize = 4 * 1024 * 1024;
+
+char ExpectedAt(std::int64_t offset) {
+  return static_cast<char>(offset % 128);
+}
+
+/// Read @p n bytes from @p stream, and verify they match the fake object.
+void CheckRead(std::istream& stream, std::int64_t offset, std::size_t n) {
+  std::vector<char> actual(n);
+  stream.read(actual.data(), actual.size());
+  ASSERT_EQ(n, static_cast<std::size_t>(stream.gcount()));
+  for (std::size_t i = 0; i != n; ++i) {
+    ASSERT_EQ(ExpectedAt(offset + i), actual[i]) << "i=" << i;
+  }
+  EXPECT_EQ(offset + static_cast<std::int64_t>(n), stream.tellg());
+}
+
+TEST(ObjectReadStreambufTest, SeekWithinBuffer) {
+  ObjectReadStreambuf buf(
+      ReadObjectRangeRequest{},
+      absl::make_unique<FakeObjectReadSource>(0, kFakeObjectSize), 0,
+      [](ReadObjectRangeRequest const&) {
+        ADD_FAILURE() << "unexpected re-open";
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(
+            Status(StatusCode::kInternal, "unexpected"));
+      });
+  std::istream stream(&buf);
+  EXPECT_EQ(ExpectedAt(0), stream.peek());
+  CheckRead(stream, 0, 1000);
+  stream.seekg(500);
+  CheckRead(stream, 500, 100);
+  stream.seekg(-200, std::ios_base::cur);
+  CheckRead(stream, 400, 100);
+  stream.seekg(10000);
+  CheckRead(stream, 10000, 100);
+}
+
+TEST(ObjectReadStreambufTest, SeekForwardSkipsData) {
+  ObjectReadStreambuf buf(
+      ReadObjectRangeRequest{},
+      absl::make_unique<FakeObjectReadSource>(0, kFakeObjectSize), 0,
+      [](ReadObjectRangeRequest const&) {
+        ADD_FAILURE() << "unexpected re-open";
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(
+            Status(StatusCode::kInternal, "unexpected"));
+      });
+  std::istream stream(&buf);
+  CheckRead(stream, 0, 1000);
+  auto const target = 1000 + ObjectReadStreambuf::kMaxSkipOnSeek;
+  stream.seekg(target);
+  EXPECT_EQ(target, stream.tellg());
+  CheckRead(stream, target, 300 * 1024);
+  EXPECT_TRUE(buf.IsOpen());
+}
+
+TEST(ObjectReadStreambufTest, SeekReopens) {
+  std::vector<ReadObjectRangeRequest> requests;
+  ObjectReadStreambuf buf(
+      ReadObjectRangeRequest("test-bucket", "test-object"),
+      absl::make_unique<FakeObjectReadSource>(0, kFakeObjectSize), 0,
+      [&requests](ReadObjectRangeRequest const& r) {
+        requests.push_back(r);
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(
+            absl::make_unique<FakeObjectReadSource>(r.StartingByte(),
+                                                    kFakeObjectSize));
+      });
+  std::istream stream(&buf);
+  CheckRead(stream, 0, 1000);
+
+  // Seek far ahead, the download is re-opened lazily.
+  auto const target = 1000 + 2 * ObjectReadStreambuf::kMaxSkipOnSeek;
+  stream.seekg(target);
+  EXPECT_EQ(target, stream.tellg());
+  stream.seekg(target + 10);
+  EXPECT_TRUE(requests.empty());
+  CheckRead(stream, target + 10, 1000);
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ(target + 10, requests[0].GetOption<ReadFromOffset>().value());
+  EXPECT_EQ(1234, requests[0].GetOption<Generation>().value());
+
+  // Seek backwards, outside the data received.
+  stream.seekg(20);
+  CheckRead(stream, 20, 1000);
+  ASSERT_EQ(2, requests.size());
+  EXPECT_EQ(20, requests[1].GetOption<ReadFromOffset>().value());
+  EXPECT_EQ(1234, requests[1].GetOption<Generation>().value());
+
+  // Seek past the end, the download returns EOF.
+  stream.seekg(kFakeObjectSize);
+  EXPECT_EQ(kFakeObjectSize, stream.tellg());
+  EXPECT_EQ(std::char_traits<char>::eof(), stream.get());
+  EXPECT_TRUE(stream.eof());
+  EXPECT_STATUS_OK(buf.status());
+  // The re-opened downloads do not cover the full object, so the hashes are
+  // not validated.
+  EXPECT_EQ("", buf.received_hash());
+  EXPECT_EQ("", buf.computed_hash());
+}
+
+TEST(ObjectReadStreambufTest, SeekKeepsRange) {
+  std::vector<ReadObjectRangeRequest> requests;
+  ReadObjectRangeRequest request("test-bucket", "test-object");
+  request.set_option(ReadRange(1000, 2000));
+  ObjectReadStreambuf buf(
+      request, absl::make_unique<FakeObjectReadSource>(1000, 2000), 1000,
+      [&requests](ReadObjectRangeRequest const& r) {
+        requests.push_back(r);
+        return StatusOr<std::unique_ptr<ObjectReadSource>>(
+            absl::make_unique<FakeObjectReadSource>(
+                r.StartingByte(), r.GetOption<ReadRange>().value().end));
+      });
+  std::istream stream(&buf);
+  EXPECT_EQ(1000, stream.tellg());
+  CheckRead(stream, 1000, 1000);
+
+  // The download is closed, the data must be downloaded again.
+  stream.seekg(1500);
+  CheckRead(stream, 1500, 500);
+  ASSERT_EQ(1, requests.size());
+  EXPECT_EQ(1500, requests[0].StartingByte());
+  EXPECT_EQ(2000, requests[0].GetOption<ReadRange>().value().end);
+
+  stream.seekg(-100, std::ios_base::end);
+  CheckRead(stream, 1900, 100);
+
+  // Seeking to the end of the range does not need a download.
+  stream.seekg(0, std::ios_base::end);
+  EXPECT_EQ(2000, stream.tellg());
+  EXPECT_EQ(std::char_traits<char>::eof(), stream.get());
+  EXPECT_EQ(2, requests.size());
+  stream.clear();
+
+  // Seeking outside the range fails.
+  stream.seekg(999);
+  EXPECT_TRUE(stream.fail());
+  stream.clear();
+  stream.seekg(2001);
+  EXPECT_TRUE(stream.fail());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace STORAGE_CLIENT_NS
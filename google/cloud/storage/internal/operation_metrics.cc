@@ -0,0 +1,50 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/operation_metrics.h"
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+OperationMetrics::OperationMetrics()
+    : calls(0),
+      attempts(0),
+      bytes_uploaded(0),
+      bytes_downloaded(0),
+      transfer_time_us(0) {
+  for (auto& e : errors) e.store(0, std::memory_order_relaxed);
+}
+
+void OperationMetrics::RecordCall(std::chrono::microseconds elapsed,
+                                  Status const& status) {
+  calls.fetch_add(1, std::memory_order_relaxed);
+  latency.Record(elapsed);
+  RecordError(status);
+}
+
+void OperationMetrics::RecordError(Status const& status) {
+  if (status.ok()) return;
+  auto const code = static_cast<std::size_t>(status.code());
+  if (code >= errors.size()) return;
+  errors[code].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,68 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OPERATION_METRICS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OPERATION_METRICS_H
+
+#include "google/cloud/storage/internal/latency_histogram.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/status.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * The metrics for a single operation.
+ *
+ * All the counters are updated without locks, the values in a snapshot may be
+ * slightly inconsistent with each other if the snapshot is taken while the
+ * counters are being updated.
+ */
+struct OperationMetrics {
+  OperationMetrics();
+
+  /// Records the completion of a call that took @p elapsed.
+  void RecordCall(std::chrono::microseconds elapsed, Status const& status);
+
+  /// Records a failed call, or a call that failed after it returned.
+  void RecordError(Status const& status);
+
+  /// Records a single attempt to complete a call.
+  void RecordAttempt() { attempts.fetch_add(1, std::memory_order_relaxed); }
+
+  LatencyHistogram latency;
+  LatencyHistogram time_to_first_byte;
+  std::atomic<std::uint64_t> calls;
+  std::atomic<std::uint64_t> attempts;
+  std::atomic<std::uint64_t> bytes_uploaded;
+  std::atomic<std::uint64_t> bytes_downloaded;
+  std::atomic<std::uint64_t> transfer_time_us;
+  std::array<std::atomic<std::uint64_t>,
+             static_cast<std::size_t>(StatusCode::kUnauthenticated) + 1>
+      errors;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_OPERATION_METRICS_H
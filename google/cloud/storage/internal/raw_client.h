@@ -31,6 +31,7 @@
 #include "google/cloud/storage/internal/resumable_upload_session.h"
 #include "google/cloud/storage/internal/service_account_requests.h"
 #include "google/cloud/storage/internal/sign_blob_requests.h"
+#include "google/cloud/storage/internal/xml_multipart_upload_requests.h"
 #include "google/cloud/storage/oauth2/credentials.h"
 #include "google/cloud/storage/object_metadata.h"
 #include "google/cloud/storage/service_account.h"
@@ -104,6 +105,18 @@ class RawClient {
       DeleteResumableUploadRequest const& request) = 0;
   //@}
 
+  //@{
+  /// @name XML API multipart uploads.
+  virtual StatusOr<CreateMultipartUploadResponse> CreateMultipartUpload(
+      CreateMultipartUploadRequest const& request) = 0;
+  virtual StatusOr<UploadPartResponse> UploadPart(
+      UploadPartRequest const& request) = 0;
+  virtual StatusOr<CompleteMultipartUploadResponse> CompleteMultipartUpload(
+      CompleteMultipartUploadRequest const& request) = 0;
+  virtual StatusOr<EmptyResponse> AbortMultipartUpload(
+      AbortMultipartUploadRequest const& request) = 0;
+  //@}
+
   //@{
   /// @name BucketAccessControls resource operations
   virtual StatusOr<ListBucketAclResponse> ListBucketAcl(
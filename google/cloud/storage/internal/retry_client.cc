@@ -420,6 +420,46 @@ StatusOr<EmptyResponse> RetryClient::DeleteResumableUpload(
                   __func__);
 }
 
+StatusOr<CreateMultipartUploadResponse> RetryClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+  // Like resumable upload sessions, retrying may leave behind an unused upload
+  // id, which is harmless.
+  return MakeCall(*retry_policy, *backoff_policy, Idempotency::kIdempotent,
+                  *client_, &RawClient::CreateMultipartUpload, request,
+                  __func__);
+}
+
+StatusOr<UploadPartResponse> RetryClient::UploadPart(
+    UploadPartRequest const& request) {
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+  // Uploading the same part again simply replaces it.
+  return MakeCall(*retry_policy, *backoff_policy, Idempotency::kIdempotent,
+                  *client_, &RawClient::UploadPart, request, __func__);
+}
+
+StatusOr<CompleteMultipartUploadResponse> RetryClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+  // If the first attempt succeeds but the response is lost, a retry fails
+  // because the upload no longer exists.
+  return MakeCall(*retry_policy, *backoff_policy, Idempotency::kNonIdempotent,
+                  *client_, &RawClient::CompleteMultipartUpload, request,
+                  __func__);
+}
+
+StatusOr<EmptyResponse> RetryClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  auto retry_policy = retry_policy_prototype_->clone();
+  auto backoff_policy = backoff_policy_prototype_->clone();
+  return MakeCall(*retry_policy, *backoff_policy, Idempotency::kIdempotent,
+                  *client_, &RawClient::AbortMultipartUpload, request,
+                  __func__);
+}
+
 StatusOr<ListBucketAclResponse> RetryClient::ListBucketAcl(
     ListBucketAclRequest const& request) {
   auto retry_policy = retry_policy_prototype_->clone();
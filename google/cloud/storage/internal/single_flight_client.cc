@@ -0,0 +1,395 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/single_flight_client.h"
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+namespace {
+/**
+ * Computes the key used to detect identical requests.
+ *
+ * The streaming operator for requests includes all the parameters and every
+ * option set in the request, so two requests with the same key are
+ * indistinguishable to the service.
+ */
+template <typename Request>
+std::string CoalescingKey(Request const& request) {
+  std::ostringstream os;
+  os << request;
+  return std::move(os).str();
+}
+}  // namespace
+
+SingleFlightClient::SingleFlightClient(std::shared_ptr<RawClient> client)
+    : client_(std::move(client)) {}
+
+template <typename T, typename Functor>
+T SingleFlightClient::Coalesce(InFlightMap<T>& in_flight,
+                               std::string const& key, Functor&& call) {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto i = in_flight.find(key);
+  if (i != in_flight.end()) {
+    // Hold a reference, the leader removes the entry from the map before
+    // notifying the waiters.
+    auto state = i->second;
+    state->cv.wait(lk, [&state] { return state->result.has_value(); });
+    return *state->result;
+  }
+  auto state = std::make_shared<InFlight<T>>();
+  in_flight.emplace(key, state);
+  lk.unlock();
+
+  // Remove the entry and wake up the waiters even if `call()` throws,
+  // otherwise they would wait forever.
+  class Completion {
+   public:
+    Completion(std::mutex& mu, InFlightMap<T>& in_flight,
+               std::string const& key, std::shared_ptr<InFlight<T>> state)
+        : mu_(mu), in_flight_(in_flight), key_(key), state_(std::move(state)) {}
+    ~Completion() {
+      std::unique_lock<std::mutex> lk(mu_);
+      state_->result = result ? *std::move(result)
+                              : T(Status(StatusCode::kUnknown,
+                                         "coalesced request raised an "
+                                         "exception"));
+      in_flight_.erase(key_);
+      lk.unlock();
+      state_->cv.notify_all();
+    }
+
+    absl::optional<T> result;
+
+   private:
+    std::mutex& mu_;
+    InFlightMap<T>& in_flight_;
+    std::string const& key_;
+    std::shared_ptr<InFlight<T>> state_;
+  } completion(mu_, in_flight, key, std::move(state));
+  completion.result = call();
+  return *completion.result;
+}
+
+ClientOptions const& SingleFlightClient::client_options() const {
+  return client_->client_options();
+}
+
+StatusOr<BucketMetadata> SingleFlightClient::GetBucketMetadata(
+    GetBucketMetadataRequest const& request) {
+  return Coalesce(bucket_metadata_, CoalescingKey(request), [this, &request] {
+    return client_->GetBucketMetadata(request);
+  });
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::GetObjectMetadata(
+    GetObjectMetadataRequest const& request) {
+  return Coalesce(object_metadata_, CoalescingKey(request), [this, &request] {
+    return client_->GetObjectMetadata(request);
+  });
+}
+
+StatusOr<ListBucketsResponse> SingleFlightClient::ListBuckets(
+    ListBucketsRequest const& request) {
+  return client_->ListBuckets(request);
+}
+
+StatusOr<BucketMetadata> SingleFlightClient::CreateBucket(
+    CreateBucketRequest const& request) {
+  return client_->CreateBucket(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteBucket(
+    DeleteBucketRequest const& request) {
+  return client_->DeleteBucket(request);
+}
+
+StatusOr<BucketMetadata> SingleFlightClient::UpdateBucket(
+    UpdateBucketRequest const& request) {
+  return client_->UpdateBucket(request);
+}
+
+StatusOr<BucketMetadata> SingleFlightClient::PatchBucket(
+    PatchBucketRequest const& request) {
+  return client_->PatchBucket(request);
+}
+
+StatusOr<IamPolicy> SingleFlightClient::GetBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> SingleFlightClient::GetNativeBucketIamPolicy(
+    GetBucketIamPolicyRequest const& request) {
+  return client_->GetNativeBucketIamPolicy(request);
+}
+
+StatusOr<IamPolicy> SingleFlightClient::SetBucketIamPolicy(
+    SetBucketIamPolicyRequest const& request) {
+  return client_->SetBucketIamPolicy(request);
+}
+
+StatusOr<NativeIamPolicy> SingleFlightClient::SetNativeBucketIamPolicy(
+    SetNativeBucketIamPolicyRequest const& request) {
+  return client_->SetNativeBucketIamPolicy(request);
+}
+
+StatusOr<TestBucketIamPermissionsResponse>
+SingleFlightClient::TestBucketIamPermissions(
+    TestBucketIamPermissionsRequest const& request) {
+  return client_->TestBucketIamPermissions(request);
+}
+
+StatusOr<BucketMetadata> SingleFlightClient::LockBucketRetentionPolicy(
+    LockBucketRetentionPolicyRequest const& request) {
+  return client_->LockBucketRetentionPolicy(request);
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::InsertObjectMedia(
+    InsertObjectMediaRequest const& request) {
+  return client_->InsertObjectMedia(request);
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::CopyObject(
+    CopyObjectRequest const& request) {
+  return client_->CopyObject(request);
+}
+
+StatusOr<std::unique_ptr<ObjectReadSource>> SingleFlightClient::ReadObject(
+    ReadObjectRangeRequest const& request) {
+  return client_->ReadObject(request);
+}
+
+StatusOr<ListObjectsResponse> SingleFlightClient::ListObjects(
+    ListObjectsRequest const& request) {
+  return client_->ListObjects(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteObject(
+    DeleteObjectRequest const& request) {
+  return client_->DeleteObject(request);
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::UpdateObject(
+    UpdateObjectRequest const& request) {
+  return client_->UpdateObject(request);
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::PatchObject(
+    PatchObjectRequest const& request) {
+  return client_->PatchObject(request);
+}
+
+StatusOr<ObjectMetadata> SingleFlightClient::ComposeObject(
+    ComposeObjectRequest const& request) {
+  return client_->ComposeObject(request);
+}
+
+StatusOr<RewriteObjectResponse> SingleFlightClient::RewriteObject(
+    RewriteObjectRequest const& request) {
+  return client_->RewriteObject(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+SingleFlightClient::CreateResumableSession(
+    ResumableUploadRequest const& request) {
+  return client_->CreateResumableSession(request);
+}
+
+StatusOr<std::unique_ptr<ResumableUploadSession>>
+SingleFlightClient::RestoreResumableSession(std::string const& request) {
+  return client_->RestoreResumableSession(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteResumableUpload(
+    DeleteResumableUploadRequest const& request) {
+  return client_->DeleteResumableUpload(request);
+}
+
+StatusOr<CreateMultipartUploadResponse>
+SingleFlightClient::CreateMultipartUpload(
+    CreateMultipartUploadRequest const& request) {
+  return client_->CreateMultipartUpload(request);
+}
+
+StatusOr<UploadPartResponse> SingleFlightClient::UploadPart(
+    UploadPartRequest const& request) {
+  return client_->UploadPart(request);
+}
+
+StatusOr<CompleteMultipartUploadResponse>
+SingleFlightClient::CompleteMultipartUpload(
+    CompleteMultipartUploadRequest const& request) {
+  return client_->CompleteMultipartUpload(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::AbortMultipartUpload(
+    AbortMultipartUploadRequest const& request) {
+  return client_->AbortMultipartUpload(request);
+}
+
+StatusOr<ListBucketAclResponse> SingleFlightClient::ListBucketAcl(
+    ListBucketAclRequest const& request) {
+  return client_->ListBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> SingleFlightClient::CreateBucketAcl(
+    CreateBucketAclRequest const& request) {
+  return client_->CreateBucketAcl(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteBucketAcl(
+    DeleteBucketAclRequest const& request) {
+  return client_->DeleteBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> SingleFlightClient::GetBucketAcl(
+    GetBucketAclRequest const& request) {
+  return client_->GetBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> SingleFlightClient::UpdateBucketAcl(
+    UpdateBucketAclRequest const& request) {
+  return client_->UpdateBucketAcl(request);
+}
+
+StatusOr<BucketAccessControl> SingleFlightClient::PatchBucketAcl(
+    PatchBucketAclRequest const& request) {
+  return client_->PatchBucketAcl(request);
+}
+
+StatusOr<ListObjectAclResponse> SingleFlightClient::ListObjectAcl(
+    ListObjectAclRequest const& request) {
+  return client_->ListObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::CreateObjectAcl(
+    CreateObjectAclRequest const& request) {
+  return client_->CreateObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteObjectAcl(
+    DeleteObjectAclRequest const& request) {
+  return client_->DeleteObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::GetObjectAcl(
+    GetObjectAclRequest const& request) {
+  return client_->GetObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::UpdateObjectAcl(
+    UpdateObjectAclRequest const& request) {
+  return client_->UpdateObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::PatchObjectAcl(
+    PatchObjectAclRequest const& request) {
+  return client_->PatchObjectAcl(request);
+}
+
+StatusOr<ListDefaultObjectAclResponse> SingleFlightClient::ListDefaultObjectAcl(
+    ListDefaultObjectAclRequest const& request) {
+  return client_->ListDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::CreateDefaultObjectAcl(
+    CreateDefaultObjectAclRequest const& request) {
+  return client_->CreateDefaultObjectAcl(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteDefaultObjectAcl(
+    DeleteDefaultObjectAclRequest const& request) {
+  return client_->DeleteDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::GetDefaultObjectAcl(
+    GetDefaultObjectAclRequest const& request) {
+  return client_->GetDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::UpdateDefaultObjectAcl(
+    UpdateDefaultObjectAclRequest const& request) {
+  return client_->UpdateDefaultObjectAcl(request);
+}
+
+StatusOr<ObjectAccessControl> SingleFlightClient::PatchDefaultObjectAcl(
+    PatchDefaultObjectAclRequest const& request) {
+  return client_->PatchDefaultObjectAcl(request);
+}
+
+StatusOr<ServiceAccount> SingleFlightClient::GetServiceAccount(
+    GetProjectServiceAccountRequest const& request) {
+  return client_->GetServiceAccount(request);
+}
+
+StatusOr<ListHmacKeysResponse> SingleFlightClient::ListHmacKeys(
+    ListHmacKeysRequest const& request) {
+  return client_->ListHmacKeys(request);
+}
+
+StatusOr<CreateHmacKeyResponse> SingleFlightClient::CreateHmacKey(
+    CreateHmacKeyRequest const& request) {
+  return client_->CreateHmacKey(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteHmacKey(
+    DeleteHmacKeyRequest const& request) {
+  return client_->DeleteHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> SingleFlightClient::GetHmacKey(
+    GetHmacKeyRequest const& request) {
+  return client_->GetHmacKey(request);
+}
+
+StatusOr<HmacKeyMetadata> SingleFlightClient::UpdateHmacKey(
+    UpdateHmacKeyRequest const& request) {
+  return client_->UpdateHmacKey(request);
+}
+
+StatusOr<SignBlobResponse> SingleFlightClient::SignBlob(
+    SignBlobRequest const& request) {
+  return client_->SignBlob(request);
+}
+
+StatusOr<ListNotificationsResponse> SingleFlightClient::ListNotifications(
+    ListNotificationsRequest const& request) {
+  return client_->ListNotifications(request);
+}
+
+StatusOr<NotificationMetadata> SingleFlightClient::CreateNotification(
+    CreateNotificationRequest const& request) {
+  return client_->CreateNotification(request);
+}
+
+StatusOr<NotificationMetadata> SingleFlightClient::GetNotification(
+    GetNotificationRequest const& request) {
+  return client_->GetNotification(request);
+}
+
+StatusOr<EmptyResponse> SingleFlightClient::DeleteNotification(
+    DeleteNotificationRequest const& request) {
+  return client_->DeleteNotification(request);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
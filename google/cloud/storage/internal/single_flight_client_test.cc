@@ -0,0 +1,210 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/single_flight_client.h"
+#include "google/cloud/storage/internal/object_metadata_parser.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::Return;
+
+ObjectMetadata MakeObjectMetadata(std::string const& name) {
+  return internal::ObjectMetadataParser::FromString(
+             R"""({"bucket": "test-bucket", "name": ")""" + name +
+             R"""(", "generation": 42})""")
+      .value();
+}
+
+/// @test Verify concurrent identical requests share a single call.
+TEST(SingleFlightClientTest, ConcurrentIdenticalRequests) {
+  auto const expected = MakeObjectMetadata("test-object");
+  auto mock = std::make_shared<testing::MockClient>();
+  std::promise<void> leader_started;
+  std::promise<void> release;
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce([&](GetObjectMetadataRequest const&) {
+        leader_started.set_value();
+        release.get_future().wait();
+        return make_status_or(expected);
+      });
+  SingleFlightClient client(mock);
+
+  GetObjectMetadataRequest const request("test-bucket", "test-object");
+  auto leader = std::async(std::launch::async,
+                           [&] { return client.GetObjectMetadata(request); });
+  leader_started.get_future().wait();
+
+  int const follower_count = 8;
+  std::atomic<int> started{0};
+  std::vector<std::future<StatusOr<ObjectMetadata>>> followers;
+  for (int i = 0; i != follower_count; ++i) {
+    followers.push_back(std::async(std::launch::async, [&] {
+      ++started;
+      return client.GetObjectMetadata(request);
+    }));
+  }
+  while (started.load() != follower_count) std::this_thread::yield();
+  // Give the followers a chance to block on the in-flight request.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.set_value();
+
+  auto actual = leader.get();
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+  for (auto& f : followers) {
+    actual = f.get();
+    ASSERT_STATUS_OK(actual);
+    EXPECT_EQ(expected, *actual);
+  }
+}
+
+/// @test Verify errors are shared with all the waiting callers.
+TEST(SingleFlightClientTest, SharedError) {
+  auto mock = std::make_shared<testing::MockClient>();
+  std::promise<void> leader_started;
+  std::promise<void> release;
+  EXPECT_CALL(*mock, GetBucketMetadata(_))
+      .WillOnce([&](GetBucketMetadataRequest const&) {
+        leader_started.set_value();
+        release.get_future().wait();
+        return StatusOr<BucketMetadata>(PermanentError());
+      });
+  SingleFlightClient client(mock);
+
+  GetBucketMetadataRequest const request("test-bucket");
+  auto leader = std::async(std::launch::async,
+                           [&] { return client.GetBucketMetadata(request); });
+  leader_started.get_future().wait();
+  std::atomic<bool> started{false};
+  auto follower = std::async(std::launch::async, [&] {
+    started = true;
+    return client.GetBucketMetadata(request);
+  });
+  while (!started.load()) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.set_value();
+
+  EXPECT_EQ(PermanentError().code(), leader.get().status().code());
+  EXPECT_EQ(PermanentError().code(), follower.get().status().code());
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+/// @test Verify waiting callers are released if the leader's call throws.
+TEST(SingleFlightClientTest, LeaderThrows) {
+  auto mock = std::make_shared<testing::MockClient>();
+  std::promise<void> leader_started;
+  std::promise<void> release;
+  EXPECT_CALL(*mock, GetBucketMetadata(_))
+      .WillOnce([&](GetBucketMetadataRequest const&)
+                    -> StatusOr<BucketMetadata> {
+        leader_started.set_value();
+        release.get_future().wait();
+        throw std::runtime_error("uh-oh");
+      })
+      // The follower may arrive after the leader completes.
+      .WillRepeatedly(Return(PermanentError()));
+  SingleFlightClient client(mock);
+
+  GetBucketMetadataRequest const request("test-bucket");
+  auto leader = std::async(std::launch::async,
+                           [&] { return client.GetBucketMetadata(request); });
+  leader_started.get_future().wait();
+  std::atomic<bool> started{false};
+  auto follower = std::async(std::launch::async, [&] {
+    started = true;
+    return client.GetBucketMetadata(request);
+  });
+  while (!started.load()) std::this_thread::yield();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.set_value();
+
+  EXPECT_THROW(leader.get(), std::runtime_error);
+  EXPECT_FALSE(follower.get().ok());
+  // The failed request is no longer in flight.
+  EXPECT_EQ(PermanentError().code(),
+            client.GetBucketMetadata(request).status().code());
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+/// @test Verify requests that differ in any option are not coalesced.
+TEST(SingleFlightClientTest, DifferentRequests) {
+  auto mock = std::make_shared<testing::MockClient>();
+  std::promise<void> leader_started;
+  std::promise<void> release;
+  EXPECT_CALL(*mock, GetObjectMetadata(_))
+      .WillOnce([&](GetObjectMetadataRequest const& r) {
+        leader_started.set_value();
+        release.get_future().wait();
+        return make_status_or(MakeObjectMetadata(r.object_name()));
+      })
+      .WillOnce([&](GetObjectMetadataRequest const& r) {
+        release.set_value();
+        return make_status_or(MakeObjectMetadata(r.object_name()));
+      })
+      .WillOnce([&](GetObjectMetadataRequest const& r) {
+        return make_status_or(MakeObjectMetadata(r.object_name()));
+      });
+  SingleFlightClient client(mock);
+
+  GetObjectMetadataRequest const r1("test-bucket", "test-object");
+  auto leader = std::async(std::launch::async,
+                           [&] { return client.GetObjectMetadata(r1); });
+  leader_started.get_future().wait();
+
+  // A different generation is a different request, it does not wait for the
+  // in-flight request, and in fact unblocks it.
+  GetObjectMetadataRequest r2("test-bucket", "test-object");
+  r2.set_option(Generation(7));
+  EXPECT_STATUS_OK(client.GetObjectMetadata(r2));
+  ASSERT_STATUS_OK(leader.get());
+
+  // Once the first request completes a new call is made.
+  EXPECT_STATUS_OK(client.GetObjectMetadata(r1));
+}
+
+/// @test Verify other operations are forwarded without coalescing.
+TEST(SingleFlightClientTest, ForwardsOtherOperations) {
+  auto mock = std::make_shared<testing::MockClient>();
+  EXPECT_CALL(*mock, DeleteObject(_))
+      .WillOnce(Return(EmptyResponse{}))
+      .WillOnce(Return(PermanentError()));
+  SingleFlightClient client(mock);
+
+  DeleteObjectRequest const request("test-bucket", "test-object");
+  EXPECT_STATUS_OK(client.DeleteObject(request));
+  EXPECT_FALSE(client.DeleteObject(request));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,80 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_chunk_sizer.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+double constexpr UploadChunkSizer::kGrowthThreshold;
+double constexpr UploadChunkSizer::kShrinkThreshold;
+
+UploadChunkSizer::UploadChunkSizer(std::size_t chunk_size)
+    : UploadChunkSizer(chunk_size, chunk_size, false) {}
+
+UploadChunkSizer UploadChunkSizer::Adaptive(std::size_t max_chunk_size) {
+  // GCS rejects empty chunks, so the chunks are at least one quantum.
+  auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+  return UploadChunkSizer(kQuantum, (std::max)(kQuantum, max_chunk_size), true);
+}
+
+UploadChunkSizer::UploadChunkSizer(std::size_t chunk_size,
+                                   std::size_t max_chunk_size, bool adaptive)
+    : chunk_size_(UploadChunkRequest::RoundUpToQuantum(chunk_size)),
+      max_chunk_size_(UploadChunkRequest::RoundUpToQuantum(max_chunk_size)),
+      previous_chunk_size_(chunk_size_),
+      adaptive_(adaptive),
+      growing_(adaptive) {}
+
+void UploadChunkSizer::Update(std::size_t bytes,
+                              std::chrono::microseconds elapsed) {
+  if (!adaptive_ || bytes == 0) return;
+  auto const throughput = static_cast<double>(bytes) /
+                          static_cast<double>((std::max)(
+                              elapsed, std::chrono::microseconds(1))
+                              .count());
+  auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+
+  if (throughput < best_throughput_ * kShrinkThreshold) {
+    chunk_size_ = (std::max)(kQuantum, chunk_size_ / 2 / kQuantum * kQuantum);
+    best_throughput_ = throughput;
+    growing_ = true;
+    return;
+  }
+  if (growing_ && throughput < best_throughput_ * kGrowthThreshold) {
+    // The larger chunk did not improve the throughput, the previous chunk was
+    // already larger than the bandwidth-delay product and uses less memory.
+    growing_ = false;
+    chunk_size_ = previous_chunk_size_;
+  }
+  best_throughput_ = (std::max)(best_throughput_, throughput);
+  if (!growing_) return;
+  if (chunk_size_ >= max_chunk_size_) {
+    growing_ = false;
+    return;
+  }
+  previous_chunk_size_ = chunk_size_;
+  chunk_size_ = (std::min)(max_chunk_size_, 2 * chunk_size_);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,85 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZER_H
+
+#include "google/cloud/storage/version.h"
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+
+/**
+ * Computes the size of the chunks in a resumable upload.
+ *
+ * With a fixed chunk size all the chunks have the same size, this is the
+ * default behavior.
+ *
+ * In adaptive mode the first chunk is the minimum size accepted by GCS
+ * (256KiB). After each chunk is uploaded the application reports the bytes
+ * uploaded and the time it took. The chunk size doubles while the measured
+ * throughput keeps improving. Each request pays a round-trip, so larger chunks
+ * are faster until the chunk is larger than the bandwidth-delay product of the
+ * connection. Once the throughput stops improving the sizer returns to the
+ * previous (smaller) chunk size and stops growing.
+ * A chunk that takes much longer than expected (for example because it was
+ * retried) halves the chunk size, and the growth starts again. The chunk size
+ * is always a multiple of 256KiB and never exceeds the configured maximum,
+ * which caps the memory used by the upload buffers.
+ */
+class UploadChunkSizer {
+ public:
+  /// Creates a sizer that always returns @p chunk_size, rounded up to 256KiB.
+  explicit UploadChunkSizer(std::size_t chunk_size);
+
+  /// Creates a sizer that adapts the chunk size up to @p max_chunk_size.
+  static UploadChunkSizer Adaptive(std::size_t max_chunk_size);
+
+  /// The size for the next chunk.
+  std::size_t chunk_size() const { return chunk_size_; }
+
+  /// Reports that @p bytes were uploaded in @p elapsed time.
+  void Update(std::size_t bytes, std::chrono::microseconds elapsed);
+
+  /// Grow the chunk while the throughput improves by at least this ratio.
+  static double constexpr kGrowthThreshold = 1.1;
+
+  /// Shrink the chunk if the throughput is below this ratio of the best.
+  static double constexpr kShrinkThreshold = 0.5;
+
+ private:
+  UploadChunkSizer(std::size_t chunk_size, std::size_t max_chunk_size,
+                   bool adaptive);
+
+  std::size_t chunk_size_;
+  std::size_t max_chunk_size_;
+  std::size_t previous_chunk_size_;
+  bool adaptive_;
+  bool growing_;
+  // The best throughput (in bytes per microsecond) at the current chunk size.
+  double best_throughput_ = 0;
+};
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_UPLOAD_CHUNK_SIZER_H
@@ -0,0 +1,101 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/upload_chunk_sizer.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+auto constexpr kQuantum = UploadChunkRequest::kChunkSizeQuantum;
+
+/// Simulate a connection with a fixed round-trip and bandwidth.
+std::chrono::microseconds UploadTime(std::size_t bytes) {
+  // 50ms round-trip, 100 bytes/us (100MB/s).
+  return std::chrono::microseconds(50000 + bytes / 100);
+}
+
+TEST(UploadChunkSizer, Fixed) {
+  UploadChunkSizer tested(3 * kQuantum - 1);
+  EXPECT_EQ(3 * kQuantum, tested.chunk_size());
+  tested.Update(tested.chunk_size(), std::chrono::microseconds(1));
+  EXPECT_EQ(3 * kQuantum, tested.chunk_size());
+  tested.Update(tested.chunk_size(), std::chrono::seconds(100));
+  EXPECT_EQ(3 * kQuantum, tested.chunk_size());
+}
+
+TEST(UploadChunkSizer, AdaptiveGrowsUntilMax) {
+  auto tested = UploadChunkSizer::Adaptive(8 * kQuantum);
+  EXPECT_EQ(kQuantum, tested.chunk_size());
+  std::vector<std::size_t> sizes;
+  for (int i = 0; i != 5; ++i) {
+    tested.Update(tested.chunk_size(), UploadTime(tested.chunk_size()));
+    sizes.push_back(tested.chunk_size());
+  }
+  EXPECT_THAT(sizes, ::testing::ElementsAre(2 * kQuantum, 4 * kQuantum,
+                                            8 * kQuantum, 8 * kQuantum,
+                                            8 * kQuantum));
+}
+
+TEST(UploadChunkSizer, AdaptiveStopsWhenThroughputIsFlat) {
+  auto tested = UploadChunkSizer::Adaptive(1024 * kQuantum);
+  for (int i = 0; i != 20; ++i) {
+    tested.Update(tested.chunk_size(), UploadTime(tested.chunk_size()));
+  }
+  // With a 50ms round-trip and 100MB/s the bandwidth-delay product is 5MB,
+  // each doubling of the chunk size improves the throughput by more than 10%
+  // until the chunk is several times larger than that.
+  auto const final_size = tested.chunk_size();
+  EXPECT_LT(final_size, 1024 * kQuantum);
+  EXPECT_GE(final_size, 5 * 1000 * 1000);
+  tested.Update(final_size, UploadTime(final_size));
+  EXPECT_EQ(final_size, tested.chunk_size());
+}
+
+TEST(UploadChunkSizer, AdaptiveShrinksOnSlowChunk) {
+  auto tested = UploadChunkSizer::Adaptive(8 * kQuantum);
+  for (int i = 0; i != 4; ++i) {
+    tested.Update(tested.chunk_size(), UploadTime(tested.chunk_size()));
+  }
+  ASSERT_EQ(8 * kQuantum, tested.chunk_size());
+
+  // A chunk that was retried takes (at least) twice as long.
+  auto const size = tested.chunk_size();
+  tested.Update(size, std::chrono::microseconds(3 * UploadTime(size).count()));
+  EXPECT_EQ(4 * kQuantum, tested.chunk_size());
+
+  // Once the upload is healthy again the chunk grows back.
+  tested.Update(tested.chunk_size(), UploadTime(tested.chunk_size()));
+  EXPECT_EQ(8 * kQuantum, tested.chunk_size());
+}
+
+TEST(UploadChunkSizer, AdaptiveNeverBelowQuantum) {
+  auto tested = UploadChunkSizer::Adaptive(0);
+  EXPECT_EQ(kQuantum, tested.chunk_size());
+  tested.Update(kQuantum, std::chrono::microseconds(10));
+  tested.Update(kQuantum, std::chrono::seconds(10));
+  EXPECT_EQ(kQuantum, tested.chunk_size());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,196 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/xml_multipart_upload_requests.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+struct XmlEntity {
+  char const* name;
+  char value;
+};
+
+std::string XmlUnescape(std::string const& value) {
+  static XmlEntity const kEntities[] = {
+      {"&lt;", '<'},   {"&gt;", '>'},   {"&quot;", '"'},
+      {"&apos;", '\''}, {"&amp;", '&'},
+  };
+  std::string result;
+  result.reserve(value.size());
+  std::size_t i = 0;
+  while (i != value.size()) {
+    if (value[i] != '&') {
+      result.push_back(value[i++]);
+      continue;
+    }
+    auto const* e = std::find_if(
+        std::begin(kEntities), std::end(kEntities), [&](XmlEntity const& x) {
+          return value.compare(i, std::strlen(x.name), x.name) == 0;
+        });
+    if (e == std::end(kEntities)) {
+      result.push_back(value[i++]);
+      continue;
+    }
+    result.push_back(e->value);
+    i += std::strlen(e->name);
+  }
+  return result;
+}
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os,
+                         CreateMultipartUploadRequest const& r) {
+  os << "CreateMultipartUploadRequest={bucket_name=" << r.bucket_name()
+     << ", object_name=" << r.object_name();
+  r.DumpOptions(os, ", ");
+  return os << "}";
+}
+
+StatusOr<CreateMultipartUploadResponse>
+CreateMultipartUploadResponse::FromHttpResponse(std::string const& payload) {
+  auto upload_id = XmlElementText(payload, "UploadId");
+  if (!upload_id) return std::move(upload_id).status();
+  return CreateMultipartUploadResponse{*std::move(upload_id)};
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         CreateMultipartUploadResponse const& r) {
+  return os << "CreateMultipartUploadResponse={upload_id=" << r.upload_id
+            << "}";
+}
+
+std::ostream& operator<<(std::ostream& os, UploadPartRequest const& r) {
+  os << "UploadPartRequest={bucket_name=" << r.bucket_name()
+     << ", object_name=" << r.object_name() << ", upload_id=" << r.upload_id()
+     << ", part_number=" << r.part_number()
+     << ", payload.size()=" << r.payload().size();
+  r.DumpOptions(os, ", ");
+  return os << "}";
+}
+
+StatusOr<UploadPartResponse> UploadPartResponse::FromHttpResponse(
+    HttpResponse const& response) {
+  auto e = response.headers.find("etag");
+  if (e == response.headers.end()) {
+    return Status(StatusCode::kInternal,
+                  "missing ETag header in UploadPart response");
+  }
+  return UploadPartResponse{e->second};
+}
+
+std::ostream& operator<<(std::ostream& os, UploadPartResponse const& r) {
+  return os << "UploadPartResponse={etag=" << r.etag << "}";
+}
+
+std::string CompleteMultipartUploadRequest::xml_payload() const {
+  std::string payload = "<CompleteMultipartUpload>";
+  for (auto const& p : parts_) {
+    payload += "<Part><PartNumber>";
+    payload += std::to_string(p.first);
+    payload += "</PartNumber><ETag>";
+    payload += XmlEscape(p.second);
+    payload += "</ETag></Part>";
+  }
+  payload += "</CompleteMultipartUpload>";
+  return payload;
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         CompleteMultipartUploadRequest const& r) {
+  os << "CompleteMultipartUploadRequest={bucket_name=" << r.bucket_name()
+     << ", object_name=" << r.object_name() << ", upload_id=" << r.upload_id()
+     << ", parts={";
+  char const* sep = "";
+  for (auto const& p : r.parts()) {
+    os << sep << p.first << ": " << p.second;
+    sep = ", ";
+  }
+  os << "}";
+  r.DumpOptions(os, ", ");
+  return os << "}";
+}
+
+StatusOr<CompleteMultipartUploadResponse>
+CompleteMultipartUploadResponse::FromHttpResponse(std::string const& payload) {
+  auto etag = XmlElementText(payload, "ETag");
+  if (!etag) return std::move(etag).status();
+  return CompleteMultipartUploadResponse{*std::move(etag)};
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         CompleteMultipartUploadResponse const& r) {
+  return os << "CompleteMultipartUploadResponse={etag=" << r.etag << "}";
+}
+
+std::ostream& operator<<(std::ostream& os,
+                         AbortMultipartUploadRequest const& r) {
+  os << "AbortMultipartUploadRequest={bucket_name=" << r.bucket_name()
+     << ", object_name=" << r.object_name() << ", upload_id=" << r.upload_id();
+  r.DumpOptions(os, ", ");
+  return os << "}";
+}
+
+std::string XmlEscape(std::string const& value) {
+  std::string result;
+  result.reserve(value.size());
+  for (auto c : value) {
+    switch (c) {
+      case '&':
+        result += "&amp;";
+        break;
+      case '<':
+        result += "&lt;";
+        break;
+      case '>':
+        result += "&gt;";
+        break;
+      default:
+        result.push_back(c);
+        break;
+    }
+  }
+  return result;
+}
+
+StatusOr<std::string> XmlElementText(std::string const& document,
+                                     std::string const& element) {
+  auto const open = "<" + element + ">";
+  auto const close = "</" + element + ">";
+  auto begin = document.find(open);
+  if (begin == std::string::npos) {
+    return Status(StatusCode::kInternal,
+                  "missing <" + element + "> element in XML response");
+  }
+  begin += open.size();
+  auto const end = document.find(close, begin);
+  if (end == std::string::npos) {
+    return Status(StatusCode::kInternal,
+                  "unterminated <" + element + "> element in XML response");
+  }
+  return XmlUnescape(document.substr(begin, end - begin));
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,185 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_XML_MULTIPART_UPLOAD_REQUESTS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_XML_MULTIPART_UPLOAD_REQUESTS_H
+
+#include "google/cloud/storage/hashing_options.h"
+#include "google/cloud/storage/internal/generic_object_request.h"
+#include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/storage/well_known_parameters.h"
+#include "google/cloud/status_or.h"
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+/**
+ * Starts an upload using the XML API multipart upload protocol.
+ *
+ * The XML API multipart protocol uploads the object in parts, which can be
+ * sent in parallel and in any order, and then assembles them with a single
+ * request. Unlike parallel uploads based on `ComposeObject()` it does not
+ * create any temporary objects.
+ *
+ * @see https://cloud.google.com/storage/docs/multipart-uploads
+ */
+class CreateMultipartUploadRequest
+    : public GenericObjectRequest<CreateMultipartUploadRequest,
+                                  ContentEncoding, ContentType, EncryptionKey,
+                                  IfGenerationMatch, IfMetagenerationMatch,
+                                  KmsKeyName, PredefinedAcl, UserProject> {
+ public:
+  using GenericObjectRequest::GenericObjectRequest;
+};
+
+std::ostream& operator<<(std::ostream& os,
+                         CreateMultipartUploadRequest const& r);
+
+struct CreateMultipartUploadResponse {
+  static StatusOr<CreateMultipartUploadResponse> FromHttpResponse(
+      std::string const& payload);
+
+  std::string upload_id;
+};
+
+std::ostream& operator<<(std::ostream& os,
+                         CreateMultipartUploadResponse const& r);
+
+/**
+ * Uploads one part of a XML API multipart upload.
+ *
+ * Uploading a part with the same number as a previous part replaces it.
+ */
+class UploadPartRequest
+    : public GenericObjectRequest<UploadPartRequest, DisableMD5Hash,
+                                  EncryptionKey, UserProject> {
+ public:
+  UploadPartRequest() = default;
+  UploadPartRequest(std::string bucket_name, std::string object_name,
+                    std::string upload_id, std::uint32_t part_number,
+                    std::string payload)
+      : GenericObjectRequest(std::move(bucket_name), std::move(object_name)),
+        upload_id_(std::move(upload_id)),
+        part_number_(part_number),
+        payload_(std::move(payload)) {}
+
+  std::string const& upload_id() const { return upload_id_; }
+  std::uint32_t part_number() const { return part_number_; }
+  std::string const& payload() const { return payload_; }
+
+ private:
+  std::string upload_id_;
+  std::uint32_t part_number_ = 0;
+  std::string payload_;
+};
+
+std::ostream& operator<<(std::ostream& os, UploadPartRequest const& r);
+
+struct UploadPartResponse {
+  static StatusOr<UploadPartResponse> FromHttpResponse(
+      HttpResponse const& response);
+
+  std::string etag;
+};
+
+std::ostream& operator<<(std::ostream& os, UploadPartResponse const& r);
+
+/**
+ * Assembles the parts of a XML API multipart upload into the final object.
+ */
+class CompleteMultipartUploadRequest
+    : public GenericObjectRequest<CompleteMultipartUploadRequest,
+                                  EncryptionKey, UserProject> {
+ public:
+  CompleteMultipartUploadRequest() = default;
+  CompleteMultipartUploadRequest(std::string bucket_name,
+                                 std::string object_name, std::string upload_id,
+                                 std::map<std::uint32_t, std::string> parts)
+      : GenericObjectRequest(std::move(bucket_name), std::move(object_name)),
+        upload_id_(std::move(upload_id)),
+        parts_(std::move(parts)) {}
+
+  std::string const& upload_id() const { return upload_id_; }
+  /// The ETag of each part, indexed by part number.
+  std::map<std::uint32_t, std::string> const& parts() const { return parts_; }
+
+  /// The XML document sent in the request body.
+  std::string xml_payload() const;
+
+ private:
+  std::string upload_id_;
+  std::map<std::uint32_t, std::string> parts_;
+};
+
+std::ostream& operator<<(std::ostream& os,
+                         CompleteMultipartUploadRequest const& r);
+
+struct CompleteMultipartUploadResponse {
+  static StatusOr<CompleteMultipartUploadResponse> FromHttpResponse(
+      std::string const& payload);
+
+  std::string etag;
+};
+
+std::ostream& operator<<(std::ostream& os,
+                         CompleteMultipartUploadResponse const& r);
+
+/**
+ * Cancels a XML API multipart upload and deletes any uploaded parts.
+ */
+class AbortMultipartUploadRequest
+    : public GenericObjectRequest<AbortMultipartUploadRequest, UserProject> {
+ public:
+  AbortMultipartUploadRequest() = default;
+  AbortMultipartUploadRequest(std::string bucket_name, std::string object_name,
+                              std::string upload_id)
+      : GenericObjectRequest(std::move(bucket_name), std::move(object_name)),
+        upload_id_(std::move(upload_id)) {}
+
+  std::string const& upload_id() const { return upload_id_; }
+
+ private:
+  std::string upload_id_;
+};
+
+std::ostream& operator<<(std::ostream& os,
+                         AbortMultipartUploadRequest const& r);
+
+/// Escapes the characters with special meaning in XML element contents.
+std::string XmlEscape(std::string const& value);
+
+/**
+ * Returns the contents of the first @p element in @p document.
+ *
+ * The XML API responses are small documents with a fixed structure, this
+ * function extracts the value of the (unique) elements we need without a
+ * general purpose XML parser.
+ */
+StatusOr<std::string> XmlElementText(std::string const& document,
+                                     std::string const& element);
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_INTERNAL_XML_MULTIPART_UPLOAD_REQUESTS_H
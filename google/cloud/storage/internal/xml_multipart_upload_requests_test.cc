@@ -0,0 +1,142 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/internal/xml_multipart_upload_requests.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(XmlMultipartUploadRequestsTest, CreateMultipartUpload) {
+  CreateMultipartUploadRequest request("test-bucket", "test-object");
+  request.set_multiple_options(ContentType("text/plain"),
+                               UserProject("test-project"));
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("test-bucket"));
+  EXPECT_THAT(os.str(), HasSubstr("test-object"));
+  EXPECT_THAT(os.str(), HasSubstr("text/plain"));
+  EXPECT_THAT(os.str(), HasSubstr("userProject=test-project"));
+}
+
+TEST(XmlMultipartUploadRequestsTest, CreateMultipartUploadResponse) {
+  auto actual = CreateMultipartUploadResponse::FromHttpResponse(R"xml(
+<?xml version="1.0" encoding="UTF-8"?>
+<InitiateMultipartUploadResult xmlns="http://s3.amazonaws.com/doc/2006-03-01/">
+  <Bucket>test-bucket</Bucket>
+  <Key>test-object</Key>
+  <UploadId>VXBsb2FkIElE&amp;more</UploadId>
+</InitiateMultipartUploadResult>)xml");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("VXBsb2FkIElE&more", actual->upload_id);
+
+  std::ostringstream os;
+  os << *actual;
+  EXPECT_THAT(os.str(), HasSubstr("upload_id=VXBsb2FkIElE&more"));
+
+  auto missing = CreateMultipartUploadResponse::FromHttpResponse(
+      "<InitiateMultipartUploadResult></InitiateMultipartUploadResult>");
+  EXPECT_EQ(StatusCode::kInternal, missing.status().code());
+}
+
+TEST(XmlMultipartUploadRequestsTest, UploadPart) {
+  UploadPartRequest request("test-bucket", "test-object", "test-upload-id", 7,
+                            "0123456789");
+  request.set_option(DisableMD5Hash(true));
+  EXPECT_EQ("test-upload-id", request.upload_id());
+  EXPECT_EQ(7, request.part_number());
+  EXPECT_EQ("0123456789", request.payload());
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("upload_id=test-upload-id"));
+  EXPECT_THAT(os.str(), HasSubstr("part_number=7"));
+  EXPECT_THAT(os.str(), HasSubstr("payload.size()=10"));
+}
+
+TEST(XmlMultipartUploadRequestsTest, UploadPartResponse) {
+  HttpResponse response{200, "", {{"etag", "\"abc123\""}}};
+  auto actual = UploadPartResponse::FromHttpResponse(response);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("\"abc123\"", actual->etag);
+
+  auto missing =
+      UploadPartResponse::FromHttpResponse(HttpResponse{200, "", {}});
+  EXPECT_EQ(StatusCode::kInternal, missing.status().code());
+}
+
+TEST(XmlMultipartUploadRequestsTest, CompleteMultipartUpload) {
+  CompleteMultipartUploadRequest request(
+      "test-bucket", "test-object", "test-upload-id",
+      {{2, "\"etag-2\""}, {1, "\"etag-1\""}, {10, "<&>"}});
+  EXPECT_EQ(
+      "<CompleteMultipartUpload>"
+      "<Part><PartNumber>1</PartNumber><ETag>\"etag-1\"</ETag></Part>"
+      "<Part><PartNumber>2</PartNumber><ETag>\"etag-2\"</ETag></Part>"
+      "<Part><PartNumber>10</PartNumber><ETag>&lt;&amp;&gt;</ETag></Part>"
+      "</CompleteMultipartUpload>",
+      request.xml_payload());
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("upload_id=test-upload-id"));
+  EXPECT_THAT(os.str(), HasSubstr("1: \"etag-1\", 2: \"etag-2\""));
+}
+
+TEST(XmlMultipartUploadRequestsTest, CompleteMultipartUploadResponse) {
+  auto actual = CompleteMultipartUploadResponse::FromHttpResponse(R"xml(
+<?xml version="1.0" encoding="UTF-8"?>
+<CompleteMultipartUploadResult>
+  <Location>http://test-bucket.storage.googleapis.com/test-object</Location>
+  <Bucket>test-bucket</Bucket>
+  <Key>test-object</Key>
+  <ETag>&quot;7fc8-1&quot;</ETag>
+</CompleteMultipartUploadResult>)xml");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("\"7fc8-1\"", actual->etag);
+
+  auto unterminated =
+      CompleteMultipartUploadResponse::FromHttpResponse("<ETag>abc");
+  EXPECT_EQ(StatusCode::kInternal, unterminated.status().code());
+}
+
+TEST(XmlMultipartUploadRequestsTest, AbortMultipartUpload) {
+  AbortMultipartUploadRequest request("test-bucket", "test-object",
+                                      "test-upload-id");
+  std::ostringstream os;
+  os << request;
+  EXPECT_THAT(os.str(), HasSubstr("AbortMultipartUploadRequest={"));
+  EXPECT_THAT(os.str(), HasSubstr("upload_id=test-upload-id"));
+}
+
+TEST(XmlMultipartUploadRequestsTest, XmlEscape) {
+  EXPECT_EQ("abc", XmlEscape("abc"));
+  EXPECT_EQ("a&lt;b&gt;c&amp;d", XmlEscape("a<b>c&d"));
+  auto actual = XmlElementText("<E>" + XmlEscape("a<b>c&d") + "</E>", "E");
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ("a<b>c&d", *actual);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,395 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/multipart_upload.h"
+#include "google/cloud/storage/internal/file_io.h"
+#include "google/cloud/internal/filesystem.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+// The first line in the state file, it identifies the format. GCS object names
+// and ETags cannot contain newlines, so a line-oriented format is enough.
+char const kStateHeader[] = "gcs-multipart-upload-v1";
+
+// The XML API rejects uploads with more parts.
+std::uint64_t constexpr kMaxParts = 10000;
+
+Status InvalidState(std::string const& state_file, std::string const& what) {
+  return Status(StatusCode::kInvalidArgument,
+                "invalid multipart upload state " + state_file + ": " + what);
+}
+
+template <typename T>
+bool ParseField(std::string const& value, T& result) {
+  std::istringstream is(value);
+  is >> result;
+  return !is.fail() && is.eof();
+}
+
+std::uint64_t DivCeil(std::uint64_t dividend, std::uint64_t divisor) {
+  return (dividend + divisor - 1) / divisor;
+}
+
+/// Uploads the missing parts of a multipart upload using several threads.
+class PartUploader {
+ public:
+  PartUploader(RawClient& client, std::shared_ptr<FileIoBackend> backend,
+               std::string const& file_name,
+               CreateMultipartUploadRequest const& request,
+               std::string const& state_file, MultipartUploadState& state)
+      : client_(client),
+        backend_(std::move(backend)),
+        file_name_(file_name),
+        request_(request),
+        state_file_(state_file),
+        state_(state) {
+    auto const part_count =
+        (std::max<std::uint64_t>)(1, DivCeil(state_.file_size,
+                                             state_.part_size));
+    for (std::uint64_t p = 1; p <= part_count; ++p) {
+      auto const part = static_cast<std::uint32_t>(p);
+      if (state_.parts.count(part) == 0) pending_.push_back(part);
+    }
+  }
+
+  Status Run(std::size_t max_streams) {
+    auto const count = (std::min)(max_streams, pending_.size());
+    std::vector<std::thread> workers;
+    workers.reserve(count);
+    for (std::size_t i = 0; i != count; ++i) {
+      workers.emplace_back([this] { Worker(); });
+    }
+    for (auto& w : workers) w.join();
+    return status_;
+  }
+
+ private:
+  void Worker() {
+    auto reader = backend_->OpenForRead(file_name_, 0);
+    if (!reader) {
+      OnError(std::move(reader).status());
+      return;
+    }
+    for (;;) {
+      std::uint32_t part;
+      {
+        std::lock_guard<std::mutex> lk(mu_);
+        if (!status_.ok() || next_ == pending_.size()) return;
+        part = pending_[next_++];
+      }
+      auto etag = UploadPart(**reader, part);
+      if (!etag) {
+        OnError(std::move(etag).status());
+        return;
+      }
+      std::lock_guard<std::mutex> lk(mu_);
+      state_.parts[part] = *std::move(etag);
+      if (state_file_.empty()) continue;
+      auto status = WriteMultipartUploadState(state_file_, state_);
+      if (!status.ok() && status_.ok()) status_ = std::move(status);
+    }
+  }
+
+  StatusOr<std::string> UploadPart(FileReader& reader, std::uint32_t part) {
+    auto const offset = (part - 1) * state_.part_size;
+    auto const size = static_cast<std::size_t>(
+        (std::min)(state_.part_size, state_.file_size - offset));
+    auto status = reader.Seek(offset);
+    if (!status.ok()) return status;
+    std::string payload(size, '\0');
+    std::size_t filled = 0;
+    while (filled != size) {
+      auto n = reader.Read(&payload[filled], size - filled);
+      if (!n) return std::move(n).status();
+      if (*n == 0) {
+        return Status(StatusCode::kFailedPrecondition,
+                      "file " + file_name_ + " is shorter than expected (" +
+                          std::to_string(state_.file_size) + " bytes)");
+      }
+      filled += *n;
+    }
+
+    UploadPartRequest upload(state_.bucket_name, state_.object_name,
+                             state_.upload_id, part, std::move(payload));
+    if (request_.HasOption<EncryptionKey>()) {
+      upload.set_option(request_.GetOption<EncryptionKey>());
+    }
+    if (request_.HasOption<UserProject>()) {
+      upload.set_option(request_.GetOption<UserProject>());
+    }
+    auto response = client_.UploadPart(upload);
+    if (!response) return std::move(response).status();
+    return std::move(response->etag);
+  }
+
+  void OnError(Status status) {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (status_.ok()) status_ = std::move(status);
+  }
+
+  RawClient& client_;
+  std::shared_ptr<FileIoBackend> backend_;
+  std::string const& file_name_;
+  CreateMultipartUploadRequest const& request_;
+  std::string const& state_file_;
+  std::vector<std::uint32_t> pending_;
+
+  std::mutex mu_;
+  MultipartUploadState& state_;
+  std::size_t next_ = 0;
+  Status status_;
+};
+
+template <typename Request>
+void CopyCommonOptions(CreateMultipartUploadRequest const& source,
+                       Request& destination) {
+  if (source.HasOption<UserProject>()) {
+    destination.set_option(source.GetOption<UserProject>());
+  }
+}
+}  // namespace
+
+bool operator==(MultipartUploadState const& lhs,
+                MultipartUploadState const& rhs) {
+  return lhs.bucket_name == rhs.bucket_name &&
+         lhs.object_name == rhs.object_name &&
+         lhs.upload_id == rhs.upload_id && lhs.file_size == rhs.file_size &&
+         lhs.file_mtime == rhs.file_mtime && lhs.part_size == rhs.part_size &&
+         lhs.parts == rhs.parts;
+}
+
+std::ostream& operator<<(std::ostream& os, MultipartUploadState const& rhs) {
+  os << "MultipartUploadState={bucket_name=" << rhs.bucket_name
+     << ", object_name=" << rhs.object_name << ", upload_id=" << rhs.upload_id
+     << ", file_size=" << rhs.file_size << ", file_mtime=" << rhs.file_mtime
+     << ", part_size=" << rhs.part_size
+     << ", parts={";
+  char const* sep = "";
+  for (auto const& p : rhs.parts) {
+    os << sep << p.first << ": " << p.second;
+    sep = ", ";
+  }
+  return os << "}}";
+}
+
+StatusOr<MultipartUploadState> ReadMultipartUploadState(
+    std::string const& state_file) {
+  std::ifstream is(state_file);
+  if (!is.is_open()) {
+    return Status(StatusCode::kNotFound,
+                  "cannot open multipart upload state " + state_file);
+  }
+  std::string line;
+  if (!std::getline(is, line) || line != kStateHeader) {
+    return InvalidState(state_file, "missing header");
+  }
+  std::map<std::string, std::string> fields;
+  MultipartUploadState state;
+  while (std::getline(is, line)) {
+    auto const pos = line.find('=');
+    if (pos == std::string::npos) {
+      return InvalidState(state_file, "malformed line <" + line + ">");
+    }
+    auto key = line.substr(0, pos);
+    auto value = line.substr(pos + 1);
+    if (key != "part") {
+      fields[std::move(key)] = std::move(value);
+      continue;
+    }
+    // Each part is recorded as `part=<number> <etag>`.
+    auto const space = value.find(' ');
+    std::uint32_t number;
+    if (space == std::string::npos ||
+        !ParseField(value.substr(0, space), number) || number == 0) {
+      return InvalidState(state_file, "malformed part <" + value + ">");
+    }
+    state.parts[number] = value.substr(space + 1);
+  }
+  for (auto const* key : {"bucket", "object", "upload-id", "file-size",
+                           "file-mtime", "part-size"}) {
+    if (fields.count(key) == 0) {
+      return InvalidState(state_file, std::string("missing ") + key);
+    }
+  }
+  state.bucket_name = fields["bucket"];
+  state.object_name = fields["object"];
+  state.upload_id = fields["upload-id"];
+  if (!ParseField(fields["file-size"], state.file_size) ||
+      !ParseField(fields["file-mtime"], state.file_mtime) ||
+      !ParseField(fields["part-size"], state.part_size) ||
+      state.part_size == 0) {
+    return InvalidState(state_file, "malformed numeric field");
+  }
+  return state;
+}
+
+Status WriteMultipartUploadState(std::string const& state_file,
+                                 MultipartUploadState const& state) {
+  auto const tmp_name = state_file + ".tmp";
+  {
+    std::ofstream os(tmp_name, std::ios::trunc);
+    os << kStateHeader << "\n"
+       << "bucket=" << state.bucket_name << "\n"
+       << "object=" << state.object_name << "\n"
+       << "upload-id=" << state.upload_id << "\n"
+       << "file-size=" << state.file_size << "\n"
+       << "file-mtime=" << state.file_mtime << "\n"
+       << "part-size=" << state.part_size << "\n";
+    for (auto const& p : state.parts) {
+      os << "part=" << p.first << " " << p.second << "\n";
+    }
+    os.close();
+    if (!os) {
+      return Status(StatusCode::kUnknown,
+                    "cannot write multipart upload state " + tmp_name);
+    }
+  }
+  // On Windows `std::rename()` fails if the destination exists.
+#ifdef _WIN32
+  (void)std::remove(state_file.c_str());
+#endif  // _WIN32
+  if (std::rename(tmp_name.c_str(), state_file.c_str()) != 0) {
+    return Status(StatusCode::kUnknown,
+                  "cannot rename multipart upload state " + tmp_name + " to " +
+                      state_file);
+  }
+  return Status();
+}
+
+Status RemoveMultipartUploadState(std::string const& state_file) {
+  if (std::remove(state_file.c_str()) != 0 && errno != ENOENT) {
+    return Status(StatusCode::kUnknown,
+                  "cannot remove multipart upload state " + state_file);
+  }
+  return Status();
+}
+
+std::uint64_t MultipartUploadPartSizeFor(std::uint64_t file_size,
+                                         std::uint64_t requested) {
+  auto const part_size =
+      (std::max<std::uint64_t>)(kMinMultipartUploadPartSize, requested);
+  if (DivCeil(file_size, part_size) <= kMaxParts) return part_size;
+  return DivCeil(file_size, kMaxParts);
+}
+
+StatusOr<ObjectMetadata> MultipartUploadFileImpl(
+    RawClient& client, std::string const& file_name,
+    CreateMultipartUploadRequest const& request,
+    MultipartUploadConfig const& config) {
+  std::error_code size_err;
+  auto const file_size =
+      google::cloud::internal::file_size(file_name, size_err);
+  if (size_err) return Status(StatusCode::kNotFound, size_err.message());
+  std::error_code mtime_err;
+  auto const mtime =
+      google::cloud::internal::last_write_time(file_name, mtime_err);
+  if (mtime_err) return Status(StatusCode::kNotFound, mtime_err.message());
+  auto const file_mtime = static_cast<std::int64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(mtime.time_since_epoch())
+          .count());
+
+  bool const resumable = !config.state_file.empty();
+  MultipartUploadState state;
+  if (resumable) {
+    auto saved = ReadMultipartUploadState(config.state_file);
+    if (saved) {
+      if (saved->bucket_name != request.bucket_name() ||
+          saved->object_name != request.object_name() ||
+          saved->file_size != file_size || saved->file_mtime != file_mtime) {
+        std::ostringstream os;
+        os << "multipart upload state " << config.state_file
+           << " does not match the upload of " << file_name << " to gs://"
+           << request.bucket_name() << "/" << request.object_name() << ": "
+           << *saved;
+        return Status(StatusCode::kFailedPrecondition, std::move(os).str());
+      }
+      state = *std::move(saved);
+    } else if (saved.status().code() != StatusCode::kNotFound) {
+      return std::move(saved).status();
+    }
+  }
+
+  auto abort = [&] {
+    if (resumable) return;
+    AbortMultipartUploadRequest r(state.bucket_name, state.object_name,
+                                  state.upload_id);
+    CopyCommonOptions(request, r);
+    // Best effort, the original error is more interesting to the caller.
+    (void)client.AbortMultipartUpload(r);
+  };
+
+  if (state.upload_id.empty()) {
+    auto created = client.CreateMultipartUpload(request);
+    if (!created) return std::move(created).status();
+    state.bucket_name = request.bucket_name();
+    state.object_name = request.object_name();
+    state.upload_id = std::move(created->upload_id);
+    state.file_size = file_size;
+    state.file_mtime = file_mtime;
+    state.part_size = MultipartUploadPartSizeFor(file_size, config.part_size);
+    if (resumable) {
+      auto status = WriteMultipartUploadState(config.state_file, state);
+      if (!status.ok()) return status;
+    }
+  }
+
+  auto backend =
+      CreateFileIoBackend(client.client_options().file_io_options());
+  PartUploader uploader(client, std::move(backend), file_name, request,
+                        config.state_file, state);
+  auto status = uploader.Run(config.max_streams);
+  if (!status.ok()) {
+    abort();
+    return status;
+  }
+
+  CompleteMultipartUploadRequest complete(state.bucket_name, state.object_name,
+                                          state.upload_id, state.parts);
+  if (request.HasOption<EncryptionKey>()) {
+    complete.set_option(request.GetOption<EncryptionKey>());
+  }
+  CopyCommonOptions(request, complete);
+  auto completed = client.CompleteMultipartUpload(complete);
+  if (!completed) {
+    abort();
+    return std::move(completed).status();
+  }
+  // The object exists at this point, a stale state file is harmless: the
+  // service rejects any attempt to reuse the upload id.
+  if (resumable) (void)RemoveMultipartUploadState(config.state_file);
+
+  GetObjectMetadataRequest get(state.bucket_name, state.object_name);
+  CopyCommonOptions(request, get);
+  return client.GetObjectMetadata(get);
+}
+
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,221 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_MULTIPART_UPLOAD_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_MULTIPART_UPLOAD_H
+
+#include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/tuple_filter.h"
+#include "google/cloud/storage/internal/xml_multipart_upload_requests.h"
+#include "google/cloud/storage/parallel_upload.h"
+#include "google/cloud/storage/version.h"
+#include "google/cloud/internal/tuple.h"
+#include "google/cloud/status_or.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+/**
+ * A parameter type indicating the part size for `MultipartUploadFile()`.
+ *
+ * All parts, except the last one, have this size. The XML API requires parts
+ * of at least 5MiB, and limits uploads to 10,000 parts, the part size is
+ * increased if needed to meet these limits.
+ */
+class MultipartUploadPartSize {
+ public:
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  MultipartUploadPartSize(std::uintmax_t value) : value_(value) {}
+  std::uintmax_t value() const { return value_; }
+
+ private:
+  std::uintmax_t value_;
+};
+
+/**
+ * A parameter type to make `MultipartUploadFile()` resumable.
+ *
+ * With this option `MultipartUploadFile()` records the upload id and the
+ * parts already uploaded in the given file. If the upload fails, even if the
+ * application crashes, calling `MultipartUploadFile()` again with the same
+ * state file only uploads the missing parts. The file is removed when the
+ * upload completes successfully.
+ *
+ * The state file records the size and modification time of the uploaded file,
+ * the upload fails if the file changed since the state file was created.
+ */
+class MultipartUploadStateFile {
+ public:
+  explicit MultipartUploadStateFile(std::string value)
+      : value_(std::move(value)) {}
+  std::string const& value() const { return value_; }
+
+ private:
+  std::string value_;
+};
+
+namespace internal {
+
+/// The XML API rejects parts smaller than this, except for the last part.
+std::uint64_t constexpr kMinMultipartUploadPartSize = 5 * 1024 * 1024;
+
+/// The persistent state of a resumable `MultipartUploadFile()` operation.
+struct MultipartUploadState {
+  std::string bucket_name;
+  std::string object_name;
+  std::string upload_id;
+  std::uint64_t file_size = 0;
+  /// The modification time of the file, in seconds since the epoch.
+  std::int64_t file_mtime = 0;
+  std::uint64_t part_size = 0;
+  /// The ETag of each part already uploaded, indexed by part number.
+  std::map<std::uint32_t, std::string> parts;
+};
+
+bool operator==(MultipartUploadState const& lhs,
+                MultipartUploadState const& rhs);
+inline bool operator!=(MultipartUploadState const& lhs,
+                       MultipartUploadState const& rhs) {
+  return !(lhs == rhs);
+}
+
+std::ostream& operator<<(std::ostream& os, MultipartUploadState const& rhs);
+
+/// Read a state file, returns `kNotFound` if the file does not exist.
+StatusOr<MultipartUploadState> ReadMultipartUploadState(
+    std::string const& state_file);
+
+/**
+ * Write a state file.
+ *
+ * The state is written to a temporary file and then renamed, so a crash never
+ * leaves a partially written state behind.
+ */
+Status WriteMultipartUploadState(std::string const& state_file,
+                                 MultipartUploadState const& state);
+
+/// Remove a state file, it is not an error if the file does not exist.
+Status RemoveMultipartUploadState(std::string const& state_file);
+
+/// Returns the part size used to upload @p file_size bytes.
+std::uint64_t MultipartUploadPartSizeFor(std::uint64_t file_size,
+                                         std::uint64_t requested);
+
+/// The configuration for `MultipartUploadFileImpl()`.
+struct MultipartUploadConfig {
+  std::size_t max_streams;
+  std::uint64_t part_size;
+  /// The name of the state file, empty if the upload is not resumable.
+  std::string state_file;
+};
+
+/// The implementation of `storage::MultipartUploadFile()`.
+StatusOr<ObjectMetadata> MultipartUploadFileImpl(
+    RawClient& client, std::string const& file_name,
+    CreateMultipartUploadRequest const& request,
+    MultipartUploadConfig const& config);
+
+/// Helper functor to set the options in a `CreateMultipartUploadRequest`.
+struct SetMultipartUploadOptionsApplyHelper {
+  template <typename... Options>
+  void operator()(Options&&... options) const {
+    request.set_multiple_options(std::forward<Options>(options)...);
+  }
+
+  CreateMultipartUploadRequest& request;
+};
+
+}  // namespace internal
+
+/**
+ * Upload a file using the XML API multipart upload protocol.
+ *
+ * The file is split in parts, which are uploaded concurrently, and then
+ * assembled into the destination object with a single request. Unlike
+ * `ParallelUploadFile()` this function does not create any temporary objects,
+ * and each part is protected by a MD5 hash.
+ *
+ * If the upload fails the parts already uploaded are deleted, unless the
+ * `MultipartUploadStateFile` option is used. In that case the state file
+ * records the progress of the upload, and calling this function again with the
+ * same file and options resumes the upload.
+ *
+ * @param client the client on which to perform the operation.
+ * @param file_name the path to the file to be uploaded
+ * @param bucket_name the name of the bucket that will contain the object.
+ * @param object_name the uploaded object name.
+ * @param options a list of optional query parameters and/or request headers.
+ *     Valid types for this operation include `ContentEncoding`, `ContentType`,
+ *     `EncryptionKey`, `IfGenerationMatch`, `IfMetagenerationMatch`,
+ *     `KmsKeyName`, `MaxStreams`, `MultipartUploadPartSize`,
+ *     `MultipartUploadStateFile`, `PredefinedAcl`, and `UserProject`.
+ *
+ * @return the metadata of the object created by the upload.
+ *
+ * @par Idempotency
+ * This operation is not idempotent. While each request performed by this
+ * function is retried based on the client policies, the operation itself stops
+ * on the first request that fails.
+ */
+template <typename... Options>
+StatusOr<ObjectMetadata> MultipartUploadFile(Client client,
+                                             std::string const& file_name,
+                                             std::string bucket_name,
+                                             std::string object_name,
+                                             Options&&... options) {
+  using internal::ExtractFirstOccurenceOfType;
+  using internal::NotAmong;
+  using internal::StaticTupleFilter;
+  // Up to 8 parts of 32MiB are uploaded at a time, this keeps the memory usage
+  // bounded, while using enough connections to saturate most networks.
+  MaxStreams const default_max_streams(8);
+  MultipartUploadPartSize const default_part_size(32 * 1024 * 1024);
+
+  auto const all = std::tie(options...);
+  internal::MultipartUploadConfig config;
+  config.max_streams = (std::max<std::size_t>)(
+      1, ExtractFirstOccurenceOfType<MaxStreams>(all)
+             .value_or(default_max_streams)
+             .value());
+  config.part_size = ExtractFirstOccurenceOfType<MultipartUploadPartSize>(all)
+                         .value_or(default_part_size)
+                         .value();
+  auto state_file = ExtractFirstOccurenceOfType<MultipartUploadStateFile>(all);
+  if (state_file) config.state_file = state_file->value();
+
+  internal::CreateMultipartUploadRequest request(std::move(bucket_name),
+                                                 std::move(object_name));
+  google::cloud::internal::apply(
+      internal::SetMultipartUploadOptionsApplyHelper{request},
+      StaticTupleFilter<NotAmong<MaxStreams, MultipartUploadPartSize,
+                                 MultipartUploadStateFile>::TPred>(all));
+  return internal::MultipartUploadFileImpl(*client.raw_client(), file_name,
+                                           request, config);
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_MULTIPART_UPLOAD_H
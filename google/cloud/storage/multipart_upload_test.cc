@@ -0,0 +1,324 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/multipart_upload.h"
+#include "google/cloud/storage/internal/object_metadata_parser.h"
+#include "google/cloud/storage/retry_policy.h"
+#include "google/cloud/storage/testing/canonical_errors.h"
+#include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/random_names.h"
+#include "google/cloud/storage/testing/temp_file.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+namespace storage {
+inline namespace STORAGE_CLIENT_NS {
+namespace internal {
+namespace {
+
+using ::google::cloud::storage::testing::canonical_errors::PermanentError;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::Return;
+using ::testing::ReturnRef;
+
+std::string const kBucketName = "test-bucket";
+std::string const kObjectName = "test-object";
+std::string const kUploadId = "test-upload-id";
+
+ObjectMetadata MockObject() {
+  auto metadata = internal::ObjectMetadataParser::FromJson(nlohmann::json{
+      {"bucket", kBucketName}, {"name", kObjectName}, {"generation", 42}});
+  EXPECT_STATUS_OK(metadata);
+  return *metadata;
+}
+
+std::string TempStateFile() {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  return ::testing::TempDir() + testing::MakeRandomFileName(generator) +
+         ".multipart";
+}
+
+StatusOr<CreateMultipartUploadResponse> Created() {
+  return CreateMultipartUploadResponse{kUploadId};
+}
+
+std::string PartETag(std::uint32_t part) {
+  return "\"etag-" + std::to_string(part) + "\"";
+}
+
+auto constexpr kPartSize = kMinMultipartUploadPartSize;
+std::string const kPart1(kPartSize, 'a');
+std::string const kPart2(kPartSize, 'b');
+std::string const kPart3 = "cc";
+std::string const kContents = kPart1 + kPart2 + kPart3;
+
+class MultipartUploadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    mock_ = std::make_shared<testing::MockClient>();
+    EXPECT_CALL(*mock_, client_options())
+        .WillRepeatedly(ReturnRef(client_options_));
+    client_.reset(new Client{std::shared_ptr<internal::RawClient>(mock_),
+                             LimitedErrorCountRetryPolicy(2)});
+  }
+
+  /// Capture the payload of each part, fail the parts in @p failures.
+  void ExpectUploadParts(std::map<std::uint32_t, Status> failures = {}) {
+    EXPECT_CALL(*mock_, UploadPart(_))
+        .WillRepeatedly([this, failures](UploadPartRequest const& r)
+                            -> StatusOr<UploadPartResponse> {
+          EXPECT_EQ(kBucketName, r.bucket_name());
+          EXPECT_EQ(kObjectName, r.object_name());
+          EXPECT_EQ(kUploadId, r.upload_id());
+          auto f = failures.find(r.part_number());
+          if (f != failures.end()) return f->second;
+          std::lock_guard<std::mutex> lk(mu_);
+          parts_[r.part_number()] = r.payload();
+          return UploadPartResponse{PartETag(r.part_number())};
+        });
+  }
+
+  std::map<std::uint32_t, std::string> uploaded_parts() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return parts_;
+  }
+
+  ClientOptions client_options_ =
+      ClientOptions(oauth2::CreateAnonymousCredentials());
+  std::shared_ptr<testing::MockClient> mock_;
+  std::unique_ptr<Client> client_;
+  std::mutex mu_;
+  std::map<std::uint32_t, std::string> parts_;
+};
+
+TEST_F(MultipartUploadTest, Success) {
+  testing::TempFile temp_file(kContents);
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_))
+      .WillOnce([](CreateMultipartUploadRequest const& r) {
+        EXPECT_EQ(kBucketName, r.bucket_name());
+        EXPECT_EQ(kObjectName, r.object_name());
+        EXPECT_EQ("text/plain", r.GetOption<ContentType>().value_or(""));
+        EXPECT_EQ("test-project", r.GetOption<UserProject>().value_or(""));
+        return make_status_or(CreateMultipartUploadResponse{kUploadId});
+      });
+  ExpectUploadParts();
+  EXPECT_CALL(*mock_, CompleteMultipartUpload(_))
+      .WillOnce([](CompleteMultipartUploadRequest const& r) {
+        EXPECT_EQ(kUploadId, r.upload_id());
+        EXPECT_EQ("test-project", r.GetOption<UserProject>().value_or(""));
+        EXPECT_THAT(r.parts(), ElementsAre(Pair(1, PartETag(1)),
+                                           Pair(2, PartETag(2)),
+                                           Pair(3, PartETag(3))));
+        return make_status_or(CompleteMultipartUploadResponse{"\"final\""});
+      });
+  EXPECT_CALL(*mock_, AbortMultipartUpload(_)).Times(0);
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce([](GetObjectMetadataRequest const& r) {
+        EXPECT_EQ(kObjectName, r.object_name());
+        EXPECT_EQ("test-project", r.GetOption<UserProject>().value_or(""));
+        return make_status_or(MockObject());
+      });
+
+  auto actual = MultipartUploadFile(
+      *client_, temp_file.name(), kBucketName, kObjectName,
+      MultipartUploadPartSize(kPartSize), MaxStreams(2),
+      ContentType("text/plain"), UserProject("test-project"));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(kObjectName, actual->name());
+  EXPECT_EQ(42, actual->generation());
+  EXPECT_THAT(uploaded_parts(),
+              ElementsAre(Pair(1, kPart1), Pair(2, kPart2), Pair(3, kPart3)));
+}
+
+TEST_F(MultipartUploadTest, EmptyFile) {
+  testing::TempFile temp_file("");
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_)).WillOnce(Return(Created()));
+  ExpectUploadParts();
+  EXPECT_CALL(*mock_, CompleteMultipartUpload(_))
+      .WillOnce(Return(make_status_or(CompleteMultipartUploadResponse{})));
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(MockObject())));
+
+  auto actual = MultipartUploadFile(*client_, temp_file.name(), kBucketName,
+                                    kObjectName);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_THAT(uploaded_parts(), ElementsAre(Pair(1, "")));
+}
+
+/// @test Without a state file a failed upload is aborted.
+TEST_F(MultipartUploadTest, AbortOnFailure) {
+  testing::TempFile temp_file(kContents);
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_)).WillOnce(Return(Created()));
+  ExpectUploadParts({{2, PermanentError()}});
+  EXPECT_CALL(*mock_, CompleteMultipartUpload(_)).Times(0);
+  EXPECT_CALL(*mock_, AbortMultipartUpload(_))
+      .WillOnce([](AbortMultipartUploadRequest const& r) {
+        EXPECT_EQ(kUploadId, r.upload_id());
+        return make_status_or(EmptyResponse{});
+      });
+
+  auto actual =
+      MultipartUploadFile(*client_, temp_file.name(), kBucketName, kObjectName,
+                          MultipartUploadPartSize(kPartSize), MaxStreams(1));
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+}
+
+/// @test With a state file a failed upload can be resumed.
+TEST_F(MultipartUploadTest, Resume) {
+  testing::TempFile temp_file(kContents);
+  auto const state_file = TempStateFile();
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_)).WillOnce(Return(Created()));
+  EXPECT_CALL(*mock_, AbortMultipartUpload(_)).Times(0);
+  ExpectUploadParts({{2, PermanentError()}});
+
+  auto actual = MultipartUploadFile(
+      *client_, temp_file.name(), kBucketName, kObjectName,
+      MultipartUploadPartSize(kPartSize), MaxStreams(1),
+      MultipartUploadStateFile(state_file));
+  EXPECT_EQ(PermanentError().code(), actual.status().code());
+  EXPECT_THAT(uploaded_parts(), ElementsAre(Pair(1, kPart1)));
+
+  auto state = ReadMultipartUploadState(state_file);
+  ASSERT_STATUS_OK(state);
+  EXPECT_EQ(kUploadId, state->upload_id);
+  EXPECT_EQ(kContents.size(), state->file_size);
+  EXPECT_NE(0, state->file_mtime);
+  EXPECT_EQ(kPartSize, state->part_size);
+  EXPECT_THAT(state->parts, ElementsAre(Pair(1, PartETag(1))));
+
+  // The second attempt reuses the upload and only uploads the missing parts,
+  // even if the part size changes.
+  parts_.clear();
+  ExpectUploadParts();
+  EXPECT_CALL(*mock_, CompleteMultipartUpload(_))
+      .WillOnce([](CompleteMultipartUploadRequest const& r) {
+        EXPECT_THAT(r.parts(), ElementsAre(Pair(1, PartETag(1)),
+                                           Pair(2, PartETag(2)),
+                                           Pair(3, PartETag(3))));
+        return make_status_or(CompleteMultipartUploadResponse{});
+      });
+  EXPECT_CALL(*mock_, GetObjectMetadata(_))
+      .WillOnce(Return(make_status_or(MockObject())));
+
+  actual = MultipartUploadFile(
+      *client_, temp_file.name(), kBucketName, kObjectName,
+      MultipartUploadPartSize(2 * kPartSize),
+      MultipartUploadStateFile(state_file));
+  ASSERT_STATUS_OK(actual);
+  EXPECT_THAT(uploaded_parts(), ElementsAre(Pair(2, kPart2), Pair(3, kPart3)));
+  EXPECT_EQ(StatusCode::kNotFound,
+            ReadMultipartUploadState(state_file).status().code());
+}
+
+TEST_F(MultipartUploadTest, StateFileMismatch) {
+  testing::TempFile temp_file("abcdefgh");
+  auto const state_file = TempStateFile();
+  MultipartUploadState state{
+      kBucketName, "other-object", kUploadId, 8, 0, kPartSize, {}};
+  ASSERT_STATUS_OK(WriteMultipartUploadState(state_file, state));
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_)).Times(0);
+
+  auto actual =
+      MultipartUploadFile(*client_, temp_file.name(), kBucketName, kObjectName,
+                          MultipartUploadStateFile(state_file));
+  EXPECT_EQ(StatusCode::kFailedPrecondition, actual.status().code());
+  ASSERT_STATUS_OK(RemoveMultipartUploadState(state_file));
+}
+
+/// @test A file modified after the state file was created is not resumed.
+TEST_F(MultipartUploadTest, StateFileModifiedFile) {
+  testing::TempFile temp_file("abcdefgh");
+  auto const state_file = TempStateFile();
+  // Same size, but a different modification time.
+  MultipartUploadState state{
+      kBucketName, kObjectName, kUploadId, 8, 1, kPartSize, {}};
+  ASSERT_STATUS_OK(WriteMultipartUploadState(state_file, state));
+  EXPECT_CALL(*mock_, CreateMultipartUpload(_)).Times(0);
+  EXPECT_CALL(*mock_, UploadPart(_)).Times(0);
+
+  auto actual =
+      MultipartUploadFile(*client_, temp_file.name(), kBucketName, kObjectName,
+                          MultipartUploadStateFile(state_file));
+  EXPECT_EQ(StatusCode::kFailedPrecondition, actual.status().code());
+  ASSERT_STATUS_OK(RemoveMultipartUploadState(state_file));
+}
+
+TEST(MultipartUploadStateTest, RoundTrip) {
+  auto const name = TempStateFile();
+  MultipartUploadState const expected{kBucketName,
+                                      "path/to/test object.txt",
+                                      kUploadId,
+                                      17179869184ULL,
+                                      1602979200,
+                                      33554432ULL,
+                                      {{1, "\"a b\""}, {512, "\"c\""}}};
+  ASSERT_STATUS_OK(WriteMultipartUploadState(name, expected));
+  auto actual = ReadMultipartUploadState(name);
+  ASSERT_STATUS_OK(actual);
+  EXPECT_EQ(expected, *actual);
+
+  ASSERT_STATUS_OK(RemoveMultipartUploadState(name));
+  EXPECT_EQ(StatusCode::kNotFound,
+            ReadMultipartUploadState(name).status().code());
+  EXPECT_STATUS_OK(RemoveMultipartUploadState(name));
+}
+
+TEST(MultipartUploadStateTest, Invalid) {
+  auto const name = TempStateFile();
+  for (std::string contents : {
+           "",
+           "not-a-state\n",
+           "gcs-multipart-upload-v1\nbucket=b\n",
+           "gcs-multipart-upload-v1\nbucket=b\nobject=o\nupload-id=u\n"
+           "file-size=8\nfile-mtime=0\npart-size=0\n",
+           "gcs-multipart-upload-v1\nbucket=b\nobject=o\nupload-id=u\n"
+           "file-size=8\nfile-mtime=x\npart-size=3\n",
+           "gcs-multipart-upload-v1\nbucket=b\nobject=o\nupload-id=u\n"
+           "file-size=8\nfile-mtime=0\npart-size=3\npart=x etag\n",
+           "gcs-multipart-upload-v1\nbucket=b\nobject=o\nupload-id=u\n"
+           "file-size=8\nfile-mtime=0\npart-size=3\ngarbage\n",
+       }) {
+    SCOPED_TRACE("Testing with <" + contents + ">");
+    std::ofstream(name) << contents;
+    auto actual = ReadMultipartUploadState(name);
+    EXPECT_EQ(StatusCode::kInvalidArgument, actual.status().code());
+  }
+  ASSERT_STATUS_OK(RemoveMultipartUploadState(name));
+}
+
+TEST(MultipartUploadStateTest, PartSize) {
+  // At least 5MiB per part.
+  EXPECT_EQ(kPartSize, MultipartUploadPartSizeFor(100, 0));
+  EXPECT_EQ(kPartSize, MultipartUploadPartSizeFor(100, 1024));
+  auto const size = 2 * kPartSize;
+  EXPECT_EQ(size, MultipartUploadPartSizeFor(100, size));
+  EXPECT_EQ(size, MultipartUploadPartSizeFor(10000 * size, size));
+  // At most 10,000 parts.
+  EXPECT_EQ(size + 1, MultipartUploadPartSizeFor(10000 * size + 1, size));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage
+}  // namespace cloud
+}  // namespace google
@@ -47,6 +47,18 @@ class HashMismatchError : public std::ios_base::failure {
 
 /**
  * Defines a `std::basic_istream<char>` to read from a GCS Object.
+ *
+ * The stream supports `seekg()`, the positions are offsets in the object. Short
+ * forward seeks reuse the current download, other seeks start a new download
+ * (for the same object generation) on the next read. Streams created with a
+ * `ReadRange` option cannot seek outside that range. Streams created with a
+ * `ReadLast` option can only seek forward.
+ *
+ * @warning A seek that starts a new download disables the checksum and hash
+ *     validation for the rest of the stream, as GCS only reports the hashes
+ *     of the full object. After such a seek `received_hash()` and
+ *     `computed_hash()` are empty, and data corruption is not detected.
+ *     Seeks that reuse the current download do not affect the validation.
  */
 class ObjectReadStream : public std::basic_istream<char> {
  public:
@@ -137,6 +149,7 @@ class ObjectReadStream : public std::basic_istream<char> {
    * irrelevant, for example:
    *   - When reading only a portion of a blob the hash of that portion is
    *     irrelevant, note that GCS only reports the hashes for the full blob.
+   *   - After a `seekg()` that starts a new download, the values are empty.
    *   - The application may disable the CRC32C and/or the MD5 hash computation.
    *
    * The string has the same format as the value returned by `received_hash()`.
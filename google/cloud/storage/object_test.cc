@@ -13,14 +13,20 @@
 // limitations under the License.
 
 #include "google/cloud/storage/client.h"
+#include "google/cloud/storage/internal/download_journal.h"
 #include "google/cloud/storage/internal/object_metadata_parser.h"
 #include "google/cloud/storage/oauth2/google_credentials.h"
 #include "google/cloud/storage/retry_policy.h"
 #include "google/cloud/storage/testing/canonical_errors.h"
 #include "google/cloud/storage/testing/mock_client.h"
+#include "google/cloud/storage/testing/random_names.h"
 #include "google/cloud/storage/testing/retry_tests.h"
+#include "google/cloud/internal/random.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include <gmock/gmock.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 
 namespace google {
 namespace cloud {
@@ -421,6 +427,187 @@ TEST_F(ObjectTest, ReadObjectPermanentFailure) {
   EXPECT_THAT(status.message(), HasSubstr("ReadObject"));
 }
 
+/// A fake download, returns `data`, optionally failing after `fail_at` bytes.
+class FakeDownloadSource : public internal::ObjectReadSource {
+ public:
+  FakeDownloadSource(std::string data, std::int64_t generation,
+                     std::string const& crc32c, std::size_t fail_at)
+      : data_(std::move(data)), fail_at_(fail_at) {
+    headers_.emplace("x-goog-generation", std::to_string(generation));
+    headers_.emplace("x-goog-hash", "crc32c=" + crc32c);
+  }
+
+  bool IsOpen() const override { return offset_ < data_.size(); }
+  StatusOr<internal::HttpResponse> Close() override {
+    return internal::HttpResponse{200, {}, {}};
+  }
+  StatusOr<internal::ReadSourceResult> Read(char* buf, std::size_t n) override {
+    if (offset_ == fail_at_ && offset_ < data_.size()) return PermanentError();
+    n = (std::min)(n, (std::min)(data_.size(), fail_at_) - offset_);
+    std::copy(data_.data() + offset_, data_.data() + offset_ + n, buf);
+    offset_ += n;
+    return internal::ReadSourceResult{
+        n, internal::HttpResponse{offset_ == data_.size() ? 200 : 100, {},
+                                  headers_}};
+  }
+
+ private:
+  std::string data_;
+  std::size_t fail_at_;
+  std::size_t offset_ = 0;
+  std::multimap<std::string, std::string> headers_;
+};
+
+std::string ReadFile(std::string const& file_name) {
+  std::ifstream is(file_name, std::ios::binary);
+  return std::string{std::istreambuf_iterator<char>(is), {}};
+}
+
+std::string DownloadFileName() {
+  auto generator = google::cloud::internal::MakeDefaultPRNG();
+  return ::testing::TempDir() + testing::MakeRandomFileName(generator);
+}
+
+TEST_F(ObjectTest, DownloadToFileResumable) {
+  std::string const data(3000, 'x');
+  auto const crc32c = ComputeCrc32cChecksum(data);
+  auto const file_name = DownloadFileName();
+  auto const journal_name = internal::DownloadJournalName(file_name);
+  client_options_.SetDownloadBufferSize(128);
+
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_FALSE(r.HasOption<ReadFromOffset>());
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data, 42, crc32c, 1000)));
+      })
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        auto const offset =
+            static_cast<std::size_t>(r.GetOption<ReadFromOffset>().value_or(0));
+        EXPECT_LT(0, offset);
+        EXPECT_GE(1000, offset);
+        EXPECT_EQ(42, r.GetOption<IfGenerationMatch>().value_or(0));
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data.substr(offset), 42, crc32c,
+                                   data.size())));
+      });
+
+  auto status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                        file_name, ResumableDownload(true));
+  EXPECT_EQ(StatusCode::kNotFound, status.code());
+  // The data received before the error is in the file, and recorded in the
+  // journal.
+  auto journal = internal::ReadDownloadJournal(journal_name);
+  ASSERT_STATUS_OK(journal);
+  EXPECT_EQ(42, journal->generation);
+  EXPECT_LT(0, journal->committed_bytes);
+  EXPECT_EQ(crc32c, journal->received_crc32c);
+  EXPECT_EQ(data.substr(0, journal->committed_bytes), ReadFile(file_name));
+
+  status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                   file_name, ResumableDownload(true));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(data, ReadFile(file_name));
+  EXPECT_EQ(StatusCode::kNotFound,
+            internal::ReadDownloadJournal(journal_name).status().code());
+  std::remove(file_name.c_str());
+}
+
+TEST_F(ObjectTest, DownloadToFileResumableGenerationChanged) {
+  std::string const old_data(3000, 'x');
+  std::string const data(2000, 'y');
+  auto const crc32c = ComputeCrc32cChecksum(data);
+  auto const file_name = DownloadFileName();
+  auto const journal_name = internal::DownloadJournalName(file_name);
+  std::ofstream(file_name) << old_data.substr(0, 1000);
+  ASSERT_STATUS_OK(internal::WriteDownloadJournal(
+      journal_name,
+      internal::DownloadJournal{"test-bucket-name", "test-object-name", 42,
+                                1000, 0, ComputeCrc32cChecksum(old_data)}));
+
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_EQ(1000, r.GetOption<ReadFromOffset>().value_or(0));
+        EXPECT_EQ(42, r.GetOption<IfGenerationMatch>().value_or(0));
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data.substr(1000), 43, crc32c,
+                                   data.size())));
+      })
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_FALSE(r.HasOption<ReadFromOffset>());
+        EXPECT_FALSE(r.HasOption<IfGenerationMatch>());
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data, 43, crc32c, data.size())));
+      });
+
+  auto status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                        file_name, ResumableDownload(true));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(data, ReadFile(file_name));
+  std::remove(file_name.c_str());
+}
+
+TEST_F(ObjectTest, DownloadToFileResumablePreconditionFailed) {
+  std::string const old_data(3000, 'x');
+  std::string const data(2000, 'y');
+  auto const crc32c = ComputeCrc32cChecksum(data);
+  auto const file_name = DownloadFileName();
+  auto const journal_name = internal::DownloadJournalName(file_name);
+  std::ofstream(file_name) << old_data.substr(0, 1000);
+  ASSERT_STATUS_OK(internal::WriteDownloadJournal(
+      journal_name,
+      internal::DownloadJournal{"test-bucket-name", "test-object-name", 42,
+                                1000, 0, ComputeCrc32cChecksum(old_data)}));
+
+  // The service rejects the resumed download because the object changed.
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_EQ(1000, r.GetOption<ReadFromOffset>().value_or(0));
+        EXPECT_EQ(42, r.GetOption<IfGenerationMatch>().value_or(0));
+        return StatusOr<std::unique_ptr<internal::ObjectReadSource>>(
+            Status(StatusCode::kFailedPrecondition, "generation mismatch"));
+      })
+      .WillOnce([&](internal::ReadObjectRangeRequest const& r) {
+        EXPECT_FALSE(r.HasOption<ReadFromOffset>());
+        EXPECT_FALSE(r.HasOption<IfGenerationMatch>());
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data, 43, crc32c, data.size())));
+      });
+
+  auto status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                        file_name, ResumableDownload(true));
+  ASSERT_STATUS_OK(status);
+  EXPECT_EQ(data, ReadFile(file_name));
+  std::remove(file_name.c_str());
+}
+
+TEST_F(ObjectTest, DownloadToFileResumableChecksumMismatch) {
+  std::string const data(2000, 'x');
+  auto const file_name = DownloadFileName();
+  auto const journal_name = internal::DownloadJournalName(file_name);
+
+  EXPECT_CALL(*mock_, ReadObject(_))
+      .WillOnce([&](internal::ReadObjectRangeRequest const&) {
+        return make_status_or(std::unique_ptr<internal::ObjectReadSource>(
+            new FakeDownloadSource(data, 42, ComputeCrc32cChecksum("bad"),
+                                   data.size())));
+      });
+
+  auto status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                        file_name, ResumableDownload(true));
+  EXPECT_EQ(StatusCode::kDataLoss, status.code());
+  EXPECT_EQ(StatusCode::kNotFound,
+            internal::ReadDownloadJournal(journal_name).status().code());
+  std::remove(file_name.c_str());
+}
+
+TEST_F(ObjectTest, DownloadToFileResumableInvalidOptions) {
+  auto status = client_->DownloadToFile("test-bucket-name", "test-object-name",
+                                        DownloadFileName(),
+                                        ResumableDownload(true), ReadLast(10));
+  EXPECT_EQ(StatusCode::kInvalidArgument, status.code());
+}
+
 ObjectMetadata CreateObject(int index) {
   std::string id = "object-" + std::to_string(index);
   std::string name = id;
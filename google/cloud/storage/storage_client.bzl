@@ -20,7 +20,9 @@ storage_client_hdrs = [
     "bucket_access_control.h",
     "bucket_metadata.h",
     "client.h",
+    "client_metrics.h",
     "client_options.h",
+    "client_side_encryption.h",
     "download_options.h",
     "hashing_options.h",
     "hmac_key_metadata.h",
@@ -44,10 +46,14 @@ storage_client_hdrs = [
     "internal/curl_handle_factory.h",
     "internal/curl_request.h",
     "internal/curl_request_builder.h",
+    "internal/curl_request_template.h",
     "internal/curl_resumable_upload_session.h",
     "internal/curl_wrappers.h",
     "internal/default_object_acl_requests.h",
+    "internal/download_journal.h",
     "internal/empty_response.h",
+    "internal/envelope_encryption.h",
+    "internal/file_io.h",
     "internal/generate_message_boundary.h",
     "internal/generic_object_request.h",
     "internal/generic_request.h",
@@ -56,10 +62,12 @@ storage_client_hdrs = [
     "internal/hmac_key_metadata_parser.h",
     "internal/hmac_key_requests.h",
     "internal/http_response.h",
+    "internal/latency_histogram.h",
     "internal/lifecycle_rule_parser.h",
     "internal/logging_client.h",
     "internal/logging_resumable_upload_session.h",
     "internal/metadata_parser.h",
+    "internal/metrics_client.h",
     "internal/notification_metadata_parser.h",
     "internal/notification_requests.h",
     "internal/object_access_control_parser.h",
@@ -69,6 +77,7 @@ storage_client_hdrs = [
     "internal/object_requests.h",
     "internal/object_streambuf.h",
     "internal/openssl_util.h",
+    "internal/operation_metrics.h",
     "internal/parameter_pack_validation.h",
     "internal/patch_builder.h",
     "internal/policy_document_request.h",
@@ -83,12 +92,16 @@ storage_client_hdrs = [
     "internal/sha256_hash.h",
     "internal/sign_blob_requests.h",
     "internal/signed_url_requests.h",
+    "internal/single_flight_client.h",
     "internal/tuple_filter.h",
+    "internal/upload_chunk_sizer.h",
+    "internal/xml_multipart_upload_requests.h",
     "lifecycle_rule.h",
     "list_buckets_reader.h",
     "list_hmac_keys_reader.h",
     "list_objects_and_prefixes_reader.h",
     "list_objects_reader.h",
+    "multipart_upload.h",
     "notification_event_type.h",
     "notification_metadata.h",
     "notification_payload_format.h",
@@ -123,7 +136,9 @@ storage_client_srcs = [
     "bucket_access_control.cc",
     "bucket_metadata.cc",
     "client.cc",
+    "client_metrics.cc",
     "client_options.cc",
+    "client_side_encryption.cc",
     "hashing_options.cc",
     "hmac_key_metadata.cc",
     "iam_policy.cc",
@@ -142,19 +157,26 @@ storage_client_srcs = [
     "internal/curl_handle_factory.cc",
     "internal/curl_request.cc",
     "internal/curl_request_builder.cc",
+    "internal/curl_request_template.cc",
     "internal/curl_resumable_upload_session.cc",
     "internal/curl_wrappers.cc",
     "internal/default_object_acl_requests.cc",
+    "internal/download_journal.cc",
     "internal/empty_response.cc",
+    "internal/envelope_encryption.cc",
+    "internal/file_io.cc",
     "internal/hash_validator.cc",
     "internal/hash_validator_impl.cc",
     "internal/hmac_key_metadata_parser.cc",
     "internal/hmac_key_requests.cc",
     "internal/http_response.cc",
+    "internal/io_uring_file_io.cc",
+    "internal/latency_histogram.cc",
     "internal/lifecycle_rule_parser.cc",
     "internal/logging_client.cc",
     "internal/logging_resumable_upload_session.cc",
     "internal/metadata_parser.cc",
+    "internal/metrics_client.cc",
     "internal/notification_metadata_parser.cc",
     "internal/notification_requests.cc",
     "internal/object_access_control_parser.cc",
@@ -163,6 +185,7 @@ storage_client_srcs = [
     "internal/object_requests.cc",
     "internal/object_streambuf.cc",
     "internal/openssl_util.cc",
+    "internal/operation_metrics.cc",
     "internal/patch_builder.cc",
     "internal/policy_document_request.cc",
     "internal/resumable_upload_session.cc",
@@ -174,10 +197,14 @@ storage_client_srcs = [
     "internal/sha256_hash.cc",
     "internal/sign_blob_requests.cc",
     "internal/signed_url_requests.cc",
+    "internal/single_flight_client.cc",
+    "internal/upload_chunk_sizer.cc",
+    "internal/xml_multipart_upload_requests.cc",
     "lifecycle_rule.cc",
     "list_buckets_reader.cc",
     "list_hmac_keys_reader.cc",
     "list_objects_reader.cc",
+    "multipart_upload.cc",
     "notification_metadata.cc",
     "oauth2/anonymous_credentials.cc",
     "oauth2/authorized_user_credentials.cc",
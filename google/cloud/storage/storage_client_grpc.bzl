@@ -23,6 +23,7 @@ storage_client_grpc_hdrs = [
     "internal/grpc_resumable_upload_session.h",
     "internal/grpc_resumable_upload_session_url.h",
     "internal/hybrid_client.h",
+    "transport_routing_policy.h",
 ]
 
 storage_client_grpc_srcs = [
@@ -32,4 +33,5 @@ storage_client_grpc_srcs = [
     "internal/grpc_resumable_upload_session.cc",
     "internal/grpc_resumable_upload_session_url.cc",
     "internal/hybrid_client.cc",
+    "transport_routing_policy.cc",
 ]
@@ -25,4 +25,5 @@ storage_client_grpc_unit_tests = [
     "internal/grpc_object_read_source_test.cc",
     "internal/grpc_resumable_upload_session_test.cc",
     "internal/grpc_resumable_upload_session_url_test.cc",
+    "transport_routing_policy_test.cc",
 ]
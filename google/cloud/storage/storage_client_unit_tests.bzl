@@ -22,11 +22,13 @@ storage_client_unit_tests = [
     "bucket_test.cc",
     "client_bucket_acl_test.cc",
     "client_default_object_acl_test.cc",
+    "client_metrics_test.cc",
     "client_notifications_test.cc",
     "client_object_acl_test.cc",
     "client_object_copy_test.cc",
     "client_options_test.cc",
     "client_service_account_test.cc",
+    "client_side_encryption_test.cc",
     "client_sign_policy_document_test.cc",
     "client_sign_url_test.cc",
     "client_test.cc",
@@ -45,6 +47,7 @@ storage_client_unit_tests = [
     "internal/curl_client_test.cc",
     "internal/curl_handle_factory_test.cc",
     "internal/curl_handle_test.cc",
+    "internal/curl_request_template_test.cc",
     "internal/curl_resumable_upload_session_test.cc",
     "internal/curl_wrappers_disable_sigpipe_handler_test.cc",
     "internal/curl_wrappers_enable_sigpipe_handler_test.cc",
@@ -53,14 +56,19 @@ storage_client_unit_tests = [
     "internal/curl_wrappers_locking_enabled_test.cc",
     "internal/curl_wrappers_test.cc",
     "internal/default_object_acl_requests_test.cc",
+    "internal/download_journal_test.cc",
+    "internal/envelope_encryption_test.cc",
+    "internal/file_io_test.cc",
     "internal/generate_message_boundary_test.cc",
     "internal/generic_request_test.cc",
     "internal/hash_validator_test.cc",
     "internal/hmac_key_requests_test.cc",
     "internal/http_response_test.cc",
+    "internal/latency_histogram_test.cc",
     "internal/logging_client_test.cc",
     "internal/logging_resumable_upload_session_test.cc",
     "internal/metadata_parser_test.cc",
+    "internal/metrics_client_test.cc",
     "internal/notification_requests_test.cc",
     "internal/object_acl_requests_test.cc",
     "internal/object_requests_test.cc",
@@ -77,12 +85,16 @@ storage_client_unit_tests = [
     "internal/sha256_hash_test.cc",
     "internal/sign_blob_requests_test.cc",
     "internal/signed_url_requests_test.cc",
+    "internal/single_flight_client_test.cc",
     "internal/tuple_filter_test.cc",
+    "internal/upload_chunk_sizer_test.cc",
+    "internal/xml_multipart_upload_requests_test.cc",
     "lifecycle_rule_test.cc",
     "list_buckets_reader_test.cc",
     "list_hmac_keys_reader_test.cc",
     "list_objects_and_prefixes_reader_test.cc",
     "list_objects_reader_test.cc",
+    "multipart_upload_test.cc",
     "notification_metadata_test.cc",
     "oauth2/anonymous_credentials_test.cc",
     "oauth2/authorized_user_credentials_test.cc",
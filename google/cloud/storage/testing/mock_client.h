@@ -89,6 +89,17 @@ class MockClient : public google::cloud::storage::internal::RawClient {
   MOCK_METHOD1(DeleteResumableUpload,
                StatusOr<internal::EmptyResponse>(
                    internal::DeleteResumableUploadRequest const&));
+  MOCK_METHOD1(CreateMultipartUpload,
+               StatusOr<internal::CreateMultipartUploadResponse>(
+                   internal::CreateMultipartUploadRequest const&));
+  MOCK_METHOD1(UploadPart, StatusOr<internal::UploadPartResponse>(
+                               internal::UploadPartRequest const&));
+  MOCK_METHOD1(CompleteMultipartUpload,
+               StatusOr<internal::CompleteMultipartUploadResponse>(
+                   internal::CompleteMultipartUploadRequest const&));
+  MOCK_METHOD1(AbortMultipartUpload,
+               StatusOr<internal::EmptyResponse>(
+                   internal::AbortMultipartUploadRequest const&));
 
   MOCK_METHOD1(ListBucketAcl, StatusOr<internal::ListBucketAclResponse>(
                                   internal::ListBucketAclRequest const&));
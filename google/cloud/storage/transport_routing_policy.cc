@@ -0,0 +1,174 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/transport_routing_policy.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace google {
+namespace cloud {
+namespace storage_experimental {
+inline namespace STORAGE_CLIENT_NS {
+
+constexpr std::size_t TransportRoutingPolicy::kSizeBucketCount;
+constexpr std::size_t TransportRoutingPolicy::kUnknownSizeBucket;
+constexpr std::size_t TransportRoutingPolicy::kOperationCount;
+constexpr std::size_t TransportRoutingPolicy::kTransportCount;
+
+namespace {
+// The upper bound (exclusive) of each size bucket, the last bucket is open.
+constexpr std::int64_t kSizeBucketBounds[] = {
+    64 * 1024,          // 64KiB
+    1024 * 1024,        // 1MiB
+    16 * 1024 * 1024,   // 16MiB
+    256 * 1024 * 1024,  // 256MiB
+};
+static_assert(sizeof(kSizeBucketBounds) / sizeof(kSizeBucketBounds[0]) + 1 ==
+                  TransportRoutingPolicy::kSizeBucketCount,
+              "mismatched size bucket count");
+
+Transport Other(Transport t) {
+  return t == Transport::kGrpc ? Transport::kJson : Transport::kGrpc;
+}
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, Transport rhs) {
+  switch (rhs) {
+    case Transport::kJson:
+      return os << "JSON";
+    case Transport::kGrpc:
+      return os << "gRPC";
+  }
+  return os << "[invalid]";
+}
+
+std::ostream& operator<<(std::ostream& os, RoutedOperation rhs) {
+  switch (rhs) {
+    case RoutedOperation::kInsertObjectMedia:
+      return os << "InsertObjectMedia";
+    case RoutedOperation::kReadObject:
+      return os << "ReadObject";
+  }
+  return os << "[invalid]";
+}
+
+std::ostream& operator<<(std::ostream& os, TransportRoutingStats const& rhs) {
+  return os << "operation=" << rhs.operation
+            << ", size_bucket=" << rhs.size_bucket
+            << ", transport=" << rhs.transport << ", calls=" << rhs.calls
+            << ", explorations=" << rhs.explorations
+            << ", errors=" << rhs.errors << ", samples=" << rhs.samples
+            << ", latency=" << rhs.latency.count() << "us"
+            << ", throughput=" << rhs.throughput << "B/s";
+}
+
+TransportRoutingPolicy::TransportRoutingPolicy(double exploration_rate,
+                                               double smoothing)
+    : exploration_rate_((std::max)(0.0, (std::min)(exploration_rate, 1.0))),
+      smoothing_((std::max)(0.01, (std::min)(smoothing, 1.0))),
+      generator_(google::cloud::internal::MakeDefaultPRNG()) {}
+
+std::size_t TransportRoutingPolicy::SizeBucket(std::int64_t size) {
+  if (size < 0) return kUnknownSizeBucket;
+  auto const* const end = std::end(kSizeBucketBounds);
+  auto const* const i =
+      std::upper_bound(std::begin(kSizeBucketBounds), end, size);
+  return static_cast<std::size_t>(i - std::begin(kSizeBucketBounds));
+}
+
+Transport TransportRoutingPolicy::Choose(RoutedOperation op,
+                                         std::int64_t size) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto& bucket = GetBucket(op, size);
+  auto& grpc = bucket[static_cast<std::size_t>(Transport::kGrpc)];
+  auto& json = bucket[static_cast<std::size_t>(Transport::kJson)];
+
+  // Until both transports have samples there is nothing to compare, send the
+  // call to the one without any samples, and to gRPC if neither has them.
+  // Calls in progress count too, otherwise a burst of concurrent calls would
+  // all go to the same transport.
+  auto select = [&bucket](Transport t, bool exploration) {
+    auto& e = bucket[static_cast<std::size_t>(t)];
+    ++e.calls;
+    if (exploration) ++e.explorations;
+    return t;
+  };
+  if (grpc.calls == 0) return select(Transport::kGrpc, false);
+  if (json.calls == 0) return select(Transport::kJson, false);
+  if (grpc.samples == 0 || json.samples == 0) {
+    auto const t =
+        grpc.calls <= json.calls ? Transport::kGrpc : Transport::kJson;
+    return select(t, false);
+  }
+
+  auto const best =
+      grpc.throughput >= json.throughput ? Transport::kGrpc : Transport::kJson;
+  if (exploration_rate_ > 0 &&
+      std::uniform_real_distribution<double>(0, 1)(generator_) <
+          exploration_rate_) {
+    return select(Other(best), true);
+  }
+  return select(best, false);
+}
+
+void TransportRoutingPolicy::Record(RoutedOperation op, std::int64_t size,
+                                    Transport transport, std::int64_t bytes,
+                                    std::chrono::microseconds elapsed,
+                                    bool success) {
+  // Avoid divisions by zero for very fast calls.
+  auto const us = (std::max)(elapsed, std::chrono::microseconds(1)).count();
+  auto const throughput =
+      success ? static_cast<double>(bytes) * 1.0E6 / static_cast<double>(us)
+              : 0.0;
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto& e = GetBucket(op, size)[static_cast<std::size_t>(transport)];
+  if (!success) ++e.errors;
+  if (e.samples++ == 0) {
+    e.latency_us = static_cast<double>(us);
+    e.throughput = throughput;
+    return;
+  }
+  e.latency_us += smoothing_ * (static_cast<double>(us) - e.latency_us);
+  e.throughput += smoothing_ * (throughput - e.throughput);
+}
+
+std::vector<TransportRoutingStats> TransportRoutingPolicy::Snapshot() const {
+  std::vector<TransportRoutingStats> result;
+  std::lock_guard<std::mutex> lk(mu_);
+  for (std::size_t op = 0; op != kOperationCount; ++op) {
+    for (std::size_t b = 0; b != buckets_[op].size(); ++b) {
+      for (std::size_t t = 0; t != kTransportCount; ++t) {
+        auto const& e = buckets_[op][b][t];
+        result.push_back(TransportRoutingStats{
+            static_cast<RoutedOperation>(op), b, static_cast<Transport>(t),
+            e.calls, e.explorations, e.errors, e.samples,
+            std::chrono::microseconds(static_cast<std::int64_t>(e.latency_us)),
+            e.throughput});
+      }
+    }
+  }
+  return result;
+}
+
+TransportRoutingPolicy::Bucket& TransportRoutingPolicy::GetBucket(
+    RoutedOperation op, std::int64_t size) {
+  return buckets_[static_cast<std::size_t>(op)][SizeBucket(size)];
+}
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage_experimental
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,159 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TRANSPORT_ROUTING_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TRANSPORT_ROUTING_POLICY_H
+
+#include "google/cloud/storage/version.h"
+#include "google/cloud/internal/random.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+namespace storage_experimental {
+inline namespace STORAGE_CLIENT_NS {
+
+/// The transports used by the clients created with `DefaultGrpcClient()`.
+enum class Transport { kJson, kGrpc };
+
+/// The operations that can be routed to either transport.
+enum class RoutedOperation { kInsertObjectMedia, kReadObject };
+
+std::ostream& operator<<(std::ostream& os, Transport rhs);
+std::ostream& operator<<(std::ostream& os, RoutedOperation rhs);
+
+/// The observed performance of a transport for one operation and size bucket.
+struct TransportRoutingStats {
+  RoutedOperation operation;
+  /// The index of the size bucket, see `TransportRoutingPolicy::SizeBucket()`.
+  std::size_t size_bucket;
+  Transport transport;
+  /// The number of calls routed to this transport.
+  std::int64_t calls;
+  /// The number of calls routed to this transport to explore.
+  std::int64_t explorations;
+  /// The number of calls that completed with an error.
+  std::int64_t errors;
+  /// The number of calls used to compute the averages.
+  std::int64_t samples;
+  /// The exponentially weighted moving average of the latency.
+  std::chrono::microseconds latency;
+  /// The exponentially weighted moving average of the throughput in bytes/s.
+  double throughput;
+};
+
+std::ostream& operator<<(std::ostream& os, TransportRoutingStats const& rhs);
+
+/**
+ * Routes each operation to the transport with the best observed throughput.
+ *
+ * The policy keeps an exponentially weighted moving average (EWMA) of the
+ * latency and throughput of each transport, separately for each operation and
+ * for several ranges of object sizes. Each call is routed to the transport
+ * with the highest average throughput in its size range. Transports without
+ * any samples are tried first, and a fraction of the calls (the exploration
+ * rate) are routed to the other transport, so the policy can detect changes in
+ * the relative performance of the transports.
+ *
+ * Failed calls are recorded as samples with zero throughput, which steers the
+ * traffic away from a transport that is failing. Downloads abandoned by the
+ * application are recorded with the throughput observed until they were
+ * closed.
+ *
+ * Applications enable adaptive routing by passing a policy to
+ * `DefaultGrpcClient()`, and can call `Snapshot()` at any time to export the
+ * statistics to their monitoring system. A single policy may be shared by
+ * several clients.
+ *
+ * This class is thread-safe.
+ *
+ * @warning this is an experimental feature, and subject to change without
+ *     notice.
+ */
+class TransportRoutingPolicy {
+ public:
+  /// The number of size buckets for calls where the size is known.
+  static constexpr std::size_t kSizeBucketCount = 5;
+  /// The size bucket used when the size is not known in advance.
+  static constexpr std::size_t kUnknownSizeBucket = kSizeBucketCount;
+
+  /**
+   * Creates a new policy.
+   *
+   * @param exploration_rate the fraction of calls routed to the transport that
+   *     is not the current best, must be in the `[0, 1]` range.
+   * @param smoothing the weight of new samples in the moving averages, must be
+   *     in the `(0, 1]` range.
+   */
+  explicit TransportRoutingPolicy(double exploration_rate = 0.05,
+                                  double smoothing = 0.2);
+
+  /// Returns the size bucket for @p size, negative values mean unknown.
+  static std::size_t SizeBucket(std::int64_t size);
+
+  /// Selects the transport for a call of @p op transferring @p size bytes.
+  Transport Choose(RoutedOperation op, std::int64_t size);
+
+  /**
+   * Records the result of a call.
+   *
+   * @param op the operation.
+   * @param size the size used in the call to `Choose()`.
+   * @param transport the transport used for the call.
+   * @param bytes the number of bytes transferred.
+   * @param elapsed the duration of the call.
+   * @param success false if the call completed with an error.
+   */
+  void Record(RoutedOperation op, std::int64_t size, Transport transport,
+              std::int64_t bytes, std::chrono::microseconds elapsed,
+              bool success);
+
+  /// Returns the statistics for all the operations, buckets and transports.
+  std::vector<TransportRoutingStats> Snapshot() const;
+
+ private:
+  static constexpr std::size_t kOperationCount = 2;
+  static constexpr std::size_t kTransportCount = 2;
+
+  struct Entry {
+    std::int64_t calls = 0;
+    std::int64_t explorations = 0;
+    std::int64_t errors = 0;
+    std::int64_t samples = 0;
+    double latency_us = 0;
+    double throughput = 0;
+  };
+  using Bucket = std::array<Entry, kTransportCount>;
+
+  Bucket& GetBucket(RoutedOperation op, std::int64_t size);
+
+  double const exploration_rate_;
+  double const smoothing_;
+  mutable std::mutex mu_;
+  google::cloud::internal::DefaultPRNG generator_;
+  std::array<std::array<Bucket, kSizeBucketCount + 1>, kOperationCount>
+      buckets_;
+};
+
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage_experimental
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STORAGE_TRANSPORT_ROUTING_POLICY_H
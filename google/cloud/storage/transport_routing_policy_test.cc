@@ -0,0 +1,167 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/storage/transport_routing_policy.h"
+#include <gmock/gmock.h>
+#include <sstream>
+
+namespace google {
+namespace cloud {
+namespace storage_experimental {
+inline namespace STORAGE_CLIENT_NS {
+namespace {
+
+using ::testing::HasSubstr;
+using std::chrono::microseconds;
+
+auto constexpr kMiB = 1024 * 1024;
+auto constexpr kInsert = RoutedOperation::kInsertObjectMedia;
+auto constexpr kRead = RoutedOperation::kReadObject;
+
+TransportRoutingStats FindStats(TransportRoutingPolicy const& policy,
+                                RoutedOperation op, std::int64_t size,
+                                Transport transport) {
+  auto const bucket = TransportRoutingPolicy::SizeBucket(size);
+  for (auto const& s : policy.Snapshot()) {
+    if (s.operation == op && s.size_bucket == bucket &&
+        s.transport == transport) {
+      return s;
+    }
+  }
+  ADD_FAILURE() << "missing stats for " << op << ", " << size << ", "
+                << transport;
+  return {};
+}
+
+/// Make the first two calls, without exploration, so each transport has one
+/// sample. Each call transfers 1MiB.
+void Prime(TransportRoutingPolicy& policy, RoutedOperation op,
+           std::int64_t size, microseconds grpc, microseconds json) {
+  ASSERT_EQ(Transport::kGrpc, policy.Choose(op, size));
+  ASSERT_EQ(Transport::kJson, policy.Choose(op, size));
+  policy.Record(op, size, Transport::kGrpc, kMiB, grpc, true);
+  policy.Record(op, size, Transport::kJson, kMiB, json, true);
+}
+
+TEST(TransportRoutingPolicyTest, SizeBucket) {
+  EXPECT_EQ(TransportRoutingPolicy::kUnknownSizeBucket,
+            TransportRoutingPolicy::SizeBucket(-1));
+  EXPECT_EQ(0, TransportRoutingPolicy::SizeBucket(0));
+  EXPECT_EQ(0, TransportRoutingPolicy::SizeBucket(64 * 1024 - 1));
+  EXPECT_EQ(1, TransportRoutingPolicy::SizeBucket(64 * 1024));
+  EXPECT_EQ(2, TransportRoutingPolicy::SizeBucket(kMiB));
+  EXPECT_EQ(3, TransportRoutingPolicy::SizeBucket(16 * kMiB));
+  EXPECT_EQ(4, TransportRoutingPolicy::SizeBucket(256 * kMiB));
+  EXPECT_EQ(4, TransportRoutingPolicy::SizeBucket(std::int64_t{1} << 40));
+}
+
+/// @test Verify both transports are tried before any comparison is made.
+TEST(TransportRoutingPolicyTest, TriesEachTransport) {
+  TransportRoutingPolicy policy(0.0);
+  EXPECT_EQ(Transport::kGrpc, policy.Choose(kInsert, kMiB));
+  EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, kMiB));
+  // Without samples the calls are balanced between the transports.
+  EXPECT_EQ(Transport::kGrpc, policy.Choose(kInsert, kMiB));
+  EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, kMiB));
+  // Other operations, and other size buckets, are independent.
+  EXPECT_EQ(Transport::kGrpc, policy.Choose(kRead, kMiB));
+  EXPECT_EQ(Transport::kGrpc, policy.Choose(kInsert, 1024));
+}
+
+/// @test Verify calls are routed to the transport with the best throughput.
+TEST(TransportRoutingPolicyTest, RoutesToFaster) {
+  TransportRoutingPolicy policy(0.0);
+  Prime(policy, kInsert, kMiB, microseconds(1000), microseconds(4000));
+  for (int i = 0; i != 10; ++i) {
+    EXPECT_EQ(Transport::kGrpc, policy.Choose(kInsert, kMiB));
+  }
+  // JSON is faster for small objects.
+  Prime(policy, kInsert, 1024, microseconds(800), microseconds(200));
+  for (int i = 0; i != 10; ++i) {
+    EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, 1024));
+  }
+}
+
+/// @test Verify the policy adapts when the performance changes.
+TEST(TransportRoutingPolicyTest, AdaptsToChanges) {
+  TransportRoutingPolicy policy(0.0, 0.5);
+  Prime(policy, kRead, -1, microseconds(1000), microseconds(2000));
+  EXPECT_EQ(Transport::kGrpc, policy.Choose(kRead, -1));
+
+  // gRPC becomes much slower.
+  for (int i = 0; i != 4; ++i) {
+    policy.Record(kRead, -1, Transport::kGrpc, kMiB, microseconds(10000),
+                  true);
+  }
+  EXPECT_EQ(Transport::kJson, policy.Choose(kRead, -1));
+
+  auto const grpc = FindStats(policy, kRead, -1, Transport::kGrpc);
+  EXPECT_EQ(2, grpc.calls);
+  EXPECT_EQ(5, grpc.samples);
+  EXPECT_LT(grpc.throughput, kMiB * 1.0E6 / 2000);
+  EXPECT_GT(grpc.latency, microseconds(2000));
+}
+
+/// @test Verify failing calls steer traffic away from a transport.
+TEST(TransportRoutingPolicyTest, ErrorsCountAsZeroThroughput) {
+  TransportRoutingPolicy policy(0.0, 0.5);
+  Prime(policy, kInsert, kMiB, microseconds(1000), microseconds(2000));
+  for (int i = 0; i != 3; ++i) {
+    policy.Record(kInsert, kMiB, Transport::kGrpc, 0, microseconds(100),
+                  false);
+  }
+  EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, kMiB));
+  auto const grpc = FindStats(policy, kInsert, kMiB, Transport::kGrpc);
+  EXPECT_EQ(3, grpc.errors);
+}
+
+/// @test Verify exploration routes calls to the slower transport.
+TEST(TransportRoutingPolicyTest, Exploration) {
+  TransportRoutingPolicy policy(1.0);
+  Prime(policy, kInsert, kMiB, microseconds(1000), microseconds(2000));
+  EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, kMiB));
+  EXPECT_EQ(Transport::kJson, policy.Choose(kInsert, kMiB));
+
+  auto const json = FindStats(policy, kInsert, kMiB, Transport::kJson);
+  EXPECT_EQ(3, json.calls);
+  EXPECT_EQ(2, json.explorations);
+}
+
+TEST(TransportRoutingPolicyTest, Snapshot) {
+  TransportRoutingPolicy policy;
+  // One entry for each operation, size bucket (plus unknown) and transport.
+  EXPECT_EQ(2 * (TransportRoutingPolicy::kSizeBucketCount + 1) * 2,
+            policy.Snapshot().size());
+
+  Prime(policy, kInsert, kMiB, microseconds(1000), microseconds(2000));
+  auto const grpc = FindStats(policy, kInsert, kMiB, Transport::kGrpc);
+  EXPECT_EQ(1, grpc.calls);
+  EXPECT_EQ(0, grpc.explorations);
+  EXPECT_EQ(0, grpc.errors);
+  EXPECT_EQ(1, grpc.samples);
+  EXPECT_EQ(microseconds(1000), grpc.latency);
+  EXPECT_DOUBLE_EQ(kMiB * 1.0E3, grpc.throughput);
+
+  std::ostringstream os;
+  os << grpc;
+  EXPECT_THAT(os.str(), HasSubstr("operation=InsertObjectMedia"));
+  EXPECT_THAT(os.str(), HasSubstr("transport=gRPC"));
+  EXPECT_THAT(os.str(), HasSubstr("samples=1"));
+}
+
+}  // namespace
+}  // namespace STORAGE_CLIENT_NS
+}  // namespace storage_experimental
+}  // namespace cloud
+}  // namespace google